@@ -16,6 +16,10 @@ class TestAccess<BehaviourStore> {
 public:
 	static void clearActiveBehavioursArray(BehaviourStore& store) { store.clearActiveBehavioursArray(); }
 
+	static ErrorCodesGeneral removeBehaviour(BehaviourStore& store, uint8_t index) {
+		return store.removeBehaviour(index);
+	}
+
 	static void replaceBehaviour(uint8_t index, SwitchBehaviour* s ) {
 		auto eventdata = s->serialized();
 		eventdata.insert(std::begin(eventdata), index);
@@ -31,7 +35,7 @@ public:
 		// TODO: only prints switch behaviours for now.  implement twilight.
 		out << "{" << std::endl;
 		for (auto i{0}; i < BehaviourStore::MaxBehaviours; i++) {
-			if (auto switchBehaviour = dynamic_cast<SwitchBehaviour*>(store.activeBehaviours[i])) {
+			if (auto switchBehaviour = store.getSwitchBehaviour(i)) {
 				if (switchBehaviour->isValid(currentTime, currentPresence)) {
 					out << i << ": " << *switchBehaviour << std::endl;
 				}
@@ -45,7 +49,7 @@ public:
 		// TODO: only prints switch behaviours for now.  implement twilight.
 		out << "{" << std::endl;
 		for (auto i{0}; i < BehaviourStore::MaxBehaviours; i++) {
-			if (auto switchBehaviour = dynamic_cast<SwitchBehaviour*>(store.activeBehaviours[i])) {
+			if (auto switchBehaviour = store.getSwitchBehaviour(i)) {
 				out << i << ": " << *switchBehaviour << std::endl;
 			}
 		}
@@ -0,0 +1,43 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <test/cs_TestAccess.h>
+#include <util/cs_CoroutineScheduler.h>
+
+template <>
+class TestAccess<CoroutineScheduler> {
+public:
+	/**
+	 * Executes the coroutines that are due, like the timer does when it expires.
+	 */
+	static void run() { CoroutineScheduler::getInstance().run(); }
+
+	/**
+	 * Returns the number of RTC ticks until the first deadline, or 0xFFFFFFFF when nothing is scheduled.
+	 */
+	static uint32_t ticksUntilNextDeadline() {
+		CoroutineScheduler& scheduler = CoroutineScheduler::getInstance();
+		if (scheduler._heapSize == 0) {
+			return 0xFFFFFFFF;
+		}
+		scheduler.updateNow();
+		return scheduler.ticksUntilFirstDeadline();
+	}
+
+	/**
+	 * Returns the number of RTC ticks until the timer has to wake up, or 0xFFFFFFFF when nothing is scheduled.
+	 */
+	static uint32_t ticksUntilWakeUp() {
+		CoroutineScheduler& scheduler = CoroutineScheduler::getInstance();
+		if (scheduler._heapSize == 0) {
+			return 0xFFFFFFFF;
+		}
+		scheduler.updateNow();
+		return scheduler.ticksUntilWakeUp();
+	}
+};
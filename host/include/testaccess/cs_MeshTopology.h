@@ -0,0 +1,38 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <localisation/cs_MeshTopology.h>
+#include <test/cs_TestAccess.h>
+
+template <>
+class TestAccess<MeshTopology> {
+public:
+	static constexpr uint8_t INDEX_NOT_FOUND = MeshTopology::INDEX_NOT_FOUND;
+
+	static uint8_t quantiseRssi(int8_t rssi) { return MeshTopology::quantiseRssi(rssi); }
+
+	static int8_t dequantiseRssi(uint8_t quantisedRssi) { return MeshTopology::dequantiseRssi(quantisedRssi); }
+
+	static uint8_t find(MeshTopology& topology, stone_id_t id) { return topology.find(id); }
+
+	static stone_id_t getNeighbourId(MeshTopology& topology, uint8_t index) { return topology._neighbours[index].id; }
+
+	static uint8_t getNeighbourCount(MeshTopology& topology) { return topology._neighbourCount; }
+
+	static uint8_t getLastSeenSecondsAgo(MeshTopology& topology, uint8_t index) {
+		return topology.getLastSeenSecondsAgo(index);
+	}
+
+	static uint16_t getLinkCount(MeshTopology& topology) { return topology._linkCount; }
+
+	static bool sendDigest(MeshTopology& topology, bool refresh) { return topology.sendDigest(refresh); }
+
+	static void tickSecond(MeshTopology& topology) { topology.onTickSecond(); }
+
+	static cs_ret_code_t sendMatrixToUart(MeshTopology& topology) { return topology.sendMatrixToUart(); }
+};
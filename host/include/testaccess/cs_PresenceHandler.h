@@ -0,0 +1,35 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <presence/cs_PresenceHandler.h>
+#include <test/cs_TestAccess.h>
+
+template <>
+class TestAccess<PresenceHandler> {
+public:
+	static void tickSecond(PresenceHandler& presenceHandler) { presenceHandler.tickSecond(); }
+
+	/**
+	 * Returns the bitmask of occupied locations, by scanning all records.
+	 */
+	static uint64_t scanOccupiedLocations(PresenceHandler& presenceHandler) {
+		PresenceStateDescription presence;
+		for (auto& record : presenceHandler._store) {
+			if (record.isValid()) {
+				presence.setLocation(record.profileLocation.location);
+			}
+		}
+		return presence.getBitmask();
+	}
+
+	static uint16_t validRecordCount(PresenceHandler& presenceHandler) {
+		return presenceHandler._store.countIf([](auto& record) { return record.isValid(); });
+	}
+
+	static uint8_t maxRecords() { return PresenceHandler::MAX_RECORDS; }
+};
@@ -0,0 +1,31 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <storage/cs_State.h>
+#include <test/cs_TestAccess.h>
+
+template <>
+class TestAccess<State> {
+public:
+	/**
+	 * Loses everything that's only in RAM, like a reset does, and loads the values from storage again like init().
+	 *
+	 * The values in RAM are not freed: the mock storage doesn't copy them, so they are what's in flash.
+	 */
+	static void reboot(State& state) {
+		state._ram_data_register.clear();
+		state._idsCache.clear();
+		state._store_queue.clear();
+		state._journal.clear();
+		state._journalFlushTicks     = 0;
+		state._startedWritingToFlash = false;
+		state.preload();
+		state.replayJournal();
+		state.updateTickRequest();
+	}
+};
@@ -41,4 +41,8 @@ public:
 	std::optional<uint8_t> getOverrideState() {
 		return _switchAggregator._overrideState;
 	}
+
+	std::optional<uint8_t> getAggregatedState() {
+		return _switchAggregator._aggregatedState;
+	}
 };
@@ -6,6 +6,7 @@
  */
 #pragma once
 
+#include <drivers/cs_RTC.h>
 #include <test/cs_TestAccess.h>
 #include <time/cs_SystemTime.h>
 
@@ -0,0 +1,21 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <behaviour/cs_TwilightHandler.h>
+#include <test/cs_TestAccess.h>
+
+template <>
+class TestAccess<TwilightHandler> {
+public:
+	/**
+	 * Sets up the handler without init(), so that it doesn't listen to events.
+	 */
+	static void setup(TwilightHandler& twilightHandler, BehaviourStore* behaviourStore) {
+		twilightHandler._behaviourStore = behaviourStore;
+	}
+};
@@ -0,0 +1,455 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <behaviour/cs_BehaviourHandler.h>
+#include <behaviour/cs_BehaviourStore.h>
+#include <behaviour/cs_ExtendedSwitchBehaviour.h>
+#include <behaviour/cs_TwilightBehaviour.h>
+#include <behaviour/cs_TwilightHandler.h>
+#include <boards/cs_HostBoardFullyFeatured.h>
+#include <common/cs_Component.h>
+#include <presence/cs_PresenceHandler.h>
+#include <storage/cs_State.h>
+#include <switch/cs_SwitchAggregator.h>
+#include <testaccess/cs_BehaviourHandler.h>
+#include <testaccess/cs_SwitchAggregator.h>
+#include <testaccess/cs_SystemTime.h>
+#include <testaccess/cs_TwilightHandler.h>
+#include <util/cs_Math.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+/**
+ * Harness that simulates a crownstone with a full set of behaviours, second by second, over a long period.
+ *
+ * Time, sun times and presence are generated, and fed to the firmware components: SystemTime, PresenceHandler,
+ * BehaviourStore and SwitchAggregator with its behaviour and twilight handlers.
+ * Every simulated second, the state of the switch aggregator is compared with a reference model: behaviour and
+ * twilight handlers that evaluate all behaviours every second.
+ *
+ * Time is fast-forwarded via the mocked RTC, so a simulated second doesn't take a real second.
+ */
+
+constexpr uint32_t SIMULATION_SECONDS_PER_DAY = 24 * 60 * 60;
+
+/**
+ * Returns sun times for the given day of the year, roughly those of the Netherlands.
+ */
+sun_time_t syntheticSunTimes(uint16_t dayOfYear, bool daylightSavingTime) {
+	constexpr double PI          = 3.14159265358979;
+	// Day length varies between 7:40 and 16:30 hours, longest at the summer solstice.
+	double dayLengthS            = (12.1 + 4.4 * std::sin(2 * PI * (dayOfYear - 80) / 365.0)) * 3600;
+	uint32_t solarNoonS          = 12 * 3600 + 40 * 60 + (daylightSavingTime ? 3600 : 0);
+	return sun_time_t{
+			.sunrise = static_cast<uint32_t>(solarNoonS - dayLengthS / 2),
+			.sunset  = static_cast<uint32_t>(solarNoonS + dayLengthS / 2)};
+}
+
+struct presence_trace_config_t {
+	uint8_t userCount             = 3;
+
+	// Users move between rooms 1 to roomCount.
+	uint8_t roomCount             = 6;
+
+	// Room in which users are at night.
+	uint8_t bedroom               = 1;
+	uint8_t sleepHour             = 23;
+	uint8_t wakeHour              = 7;
+
+	// Average time a user stays in a room during the day.
+	uint32_t meanStaySeconds      = 20 * 60;
+
+	// Chance that a user leaves the sphere, instead of moving to another room, during the day.
+	uint8_t awayPercentage        = 25;
+
+	// Max interval between presence reports of a user, should be less than the presence timeout.
+	uint8_t reportIntervalSeconds = 4;
+
+	uint32_t seed                 = 1;
+};
+
+/**
+ * Generates presence reports of users that move between rooms, sleep at night, and leave the sphere every now and then.
+ */
+class PresenceTraceGenerator {
+public:
+	PresenceTraceGenerator(const presence_trace_config_t& config)
+			: _config(config), _random(config.seed), _users(config.userCount) {}
+
+	/**
+	 * Adds the presence reports of this second to the given list.
+	 */
+	void tickSecond(Time localTime, std::vector<PresenceHandler::ProfileLocation>& reports) {
+		for (uint8_t profile = 0; profile < _users.size(); ++profile) {
+			user_t& user = _users[profile];
+			if (user.secondsUntilMove == 0) {
+				move(user, localTime);
+			}
+			user.secondsUntilMove--;
+
+			if (user.location == AWAY) {
+				continue;
+			}
+			if (user.secondsUntilReport == 0) {
+				reports.push_back(PresenceHandler::ProfileLocation{.profile = profile, .location = user.location});
+				user.secondsUntilReport = randomInt(1, _config.reportIntervalSeconds);
+			}
+			user.secondsUntilReport--;
+		}
+	}
+
+private:
+	static constexpr uint8_t AWAY = 0;
+
+	struct user_t {
+		uint8_t location           = AWAY;
+		uint32_t secondsUntilMove  = 0;
+		uint8_t secondsUntilReport = 0;
+	};
+
+	presence_trace_config_t _config;
+	std::mt19937 _random;
+	std::vector<user_t> _users;
+
+	uint32_t randomInt(uint32_t min, uint32_t max) {
+		return std::uniform_int_distribution<uint32_t>(min, max)(_random);
+	}
+
+	void move(user_t& user, Time localTime) {
+		uint32_t timeOfDay = localTime.timeOfDay();
+		uint32_t sleepS    = _config.sleepHour * 3600;
+		uint32_t wakeS     = _config.wakeHour * 3600;
+		bool asleep        = (timeOfDay >= sleepS || timeOfDay < wakeS);
+
+		if (asleep) {
+			user.location         = _config.bedroom;
+			// Sleep until some time after the wake hour.
+			uint32_t untilWakeS   = CsMath::mod(static_cast<int32_t>(wakeS - timeOfDay), SIMULATION_SECONDS_PER_DAY);
+			user.secondsUntilMove = untilWakeS + randomInt(1, 3600);
+			return;
+		}
+
+		if (randomInt(1, 100) <= _config.awayPercentage) {
+			user.location = AWAY;
+		}
+		else {
+			user.location = randomInt(1, _config.roomCount);
+		}
+		user.secondsUntilMove = randomInt(1, 2 * _config.meanStaySeconds);
+	}
+};
+
+/**
+ * Fills the store with a random mix of behaviour types, with presence conditions on the rooms of the trace.
+ */
+void fillRandomBehaviours(BehaviourStore& store, uint8_t roomCount, uint32_t seed) {
+	using Condition = PresencePredicate::Condition;
+	std::mt19937 random(seed);
+	auto randomInt = [&](uint32_t min, uint32_t max) {
+		return std::uniform_int_distribution<uint32_t>(min, max)(random);
+	};
+	auto randomTimeOfDay = [&]() {
+		switch (randomInt(0, 3)) {
+			case 0: return TimeOfDay(TimeOfDay::BaseTime::Sunrise, static_cast<int32_t>(randomInt(0, 7200)) - 3600);
+			case 1: return TimeOfDay(TimeOfDay::BaseTime::Sunset, static_cast<int32_t>(randomInt(0, 7200)) - 3600);
+			default: return TimeOfDay(randomInt(0, 23), randomInt(0, 3) * 15, 0);
+		}
+	};
+	auto randomPresenceCondition = [&]() {
+		Condition conditions[] = {
+				Condition::VacuouslyTrue,
+				Condition::AnyoneInSelectedRooms,
+				Condition::NooneInSelectedRooms,
+				Condition::AnyoneInSphere,
+				Condition::NooneInSphere};
+		Condition condition = conditions[randomInt(0, 4)];
+		// Rooms are bits 1 to roomCount.
+		uint64_t rooms      = randomInt(1, (1 << roomCount) - 1) << 1;
+		uint32_t timeOut    = randomInt(0, 3) * 5 * 60;
+		return PresenceCondition(PresencePredicate(condition, PresenceStateDescription(rooms)), timeOut);
+	};
+	auto randomSwitchBehaviour = [&]() {
+		uint8_t intensity = randomInt(0, 10) * 10;
+		uint8_t days      = randomInt(1, 0x7F);
+		TimeOfDay from    = randomTimeOfDay();
+		TimeOfDay until   = randomTimeOfDay();
+		return SwitchBehaviour(intensity, 0, days, from, until, randomPresenceCondition());
+	};
+
+	for (uint8_t index = 0; index < BehaviourStore::MaxBehaviours; ++index) {
+		uint32_t type = randomInt(0, 9);
+		if (type < 6) {
+			store.replaceBehaviour(index, randomSwitchBehaviour());
+		}
+		else if (type < 8) {
+			SwitchBehaviour switchBehaviour = randomSwitchBehaviour();
+			store.replaceBehaviour(index, ExtendedSwitchBehaviour(switchBehaviour, randomPresenceCondition()));
+		}
+		else {
+			uint8_t intensity = randomInt(1, 9) * 10;
+			TimeOfDay from    = randomTimeOfDay();
+			TimeOfDay until   = randomTimeOfDay();
+			store.replaceBehaviour(index, TwilightBehaviour(intensity, 0, 0x7F, from, until));
+		}
+	}
+}
+
+struct simulation_config_t {
+	uint16_t days                = 365;
+
+	// Thursday January 1 2026, 00:00 local time.
+	uint32_t startTime           = 1767225600;
+
+	// Days of the year at which the clock is moved forward (at 02:00) and back (at 03:00).
+	bool daylightSavingTime      = true;
+	uint16_t daylightSavingStart = 87;
+	uint16_t daylightSavingEnd   = 297;
+
+	uint32_t behaviourSeed       = 1;
+	presence_trace_config_t presence;
+};
+
+struct simulation_result_t {
+	uint32_t simulatedDays      = 0;
+	uint32_t presenceReports    = 0;
+
+	// Number of times the aggregated switch value changed, and the number of those that turned it on or off.
+	uint32_t actuations         = 0;
+	uint32_t onOffActuations    = 0;
+
+	// Number of seconds at which the switch aggregator disagreed with the reference model.
+	uint32_t disagreements      = 0;
+
+	// CPU time spent by the firmware components and the reference model, in us per simulated day.
+	double firmwareUsPerDay     = 0;
+	double firmwareUsPerDayMax  = 0;
+	double referenceUsPerDay    = 0;
+};
+
+/**
+ * Reference model: behaviour and twilight handlers that evaluate all behaviours every second, and at every
+ * presence mutation, like the firmware handlers would without skipping evaluations.
+ *
+ * It evaluates at the same moment as the switch aggregator: at the EVT_TICK_SECOND at which the posix time changes.
+ * That is before the presence handler times out presence at the same event, so that both see the same presence.
+ */
+class ReferenceModel : public EventListener {
+public:
+	// The reference model has its own copy of the behaviours, as evaluation changes their runtime state.
+	BehaviourStore _store;
+	BehaviourHandler _behaviourHandler;
+	TwilightHandler _twilightHandler;
+
+	// CPU time spent evaluating.
+	std::chrono::steady_clock::duration _duration{};
+
+	void handleEvent(event_t& event) override {
+		switch (event.type) {
+			case CS_TYPE::EVT_TICK_SECOND: {
+				uint32_t timestamp = SystemTime::posix();
+				if (timestamp == _lastTimestamp) {
+					return;
+				}
+				_lastTimestamp = timestamp;
+				evaluate();
+				break;
+			}
+			case CS_TYPE::EVT_PRESENCE_MUTATION: {
+				// Like the handlers of the firmware: some behaviours depend on the number of evaluations.
+				evaluate();
+				break;
+			}
+			default: break;
+		}
+	}
+
+private:
+	uint32_t _lastTimestamp = 0;
+
+	void evaluate() {
+		auto start = std::chrono::steady_clock::now();
+		_behaviourHandler.invalidate();
+		_behaviourHandler.update();
+		_twilightHandler.invalidate();
+		_twilightHandler.update();
+		_duration += std::chrono::steady_clock::now() - start;
+	}
+};
+
+/**
+ * The firmware components, wired up like in Crownstone.
+ */
+class SimulatedCrownstone : public Component {
+public:
+	SwitchAggregator _switchAggregator;
+	BehaviourStore _behaviourStore;
+	PresenceHandler _presenceHandler;
+	SystemTime _systemTime;
+
+	std::vector<Component*> getChildren() override {
+		return {&_switchAggregator, &_behaviourStore, &_presenceHandler};
+	}
+};
+
+class BehaviourSimulation {
+public:
+	BehaviourSimulation(const simulation_config_t& config) : _config(config), _presenceTrace(config.presence) {}
+
+	simulation_result_t run() {
+		setup();
+
+		TestAccess<SwitchAggregator> switchAggregator(_crownstone._switchAggregator);
+		std::optional<uint8_t> expectedState = switchAggregator.getAggregatedState();
+		std::optional<uint8_t> previousState = expectedState;
+		std::vector<PresenceHandler::ProfileLocation> reports;
+		std::chrono::steady_clock::duration dayDuration{};
+		std::chrono::steady_clock::duration firmwareDuration{};
+		std::chrono::steady_clock::duration firmwareDurationMax{};
+		uint32_t tickCount = 0;
+
+		for (uint32_t second = 0; second < _config.days * SIMULATION_SECONDS_PER_DAY; ++second) {
+			uint32_t secondOfDay = second % SIMULATION_SECONDS_PER_DAY;
+			uint16_t day         = second / SIMULATION_SECONDS_PER_DAY;
+			if (secondOfDay == 3 * 3600) {
+				// The app sets the sun times once in a while.
+				SystemTime::setSunTimes(syntheticSunTimes(day, _daylightSavingTime), false);
+				_reference._store.updateCachedTimes();
+			}
+			updateDaylightSavingTime(day, secondOfDay);
+
+			reports.clear();
+			_presenceTrace.tickSecond(SystemTime::now(), reports);
+			_result.presenceReports += reports.size();
+
+			auto start                                         = std::chrono::steady_clock::now();
+			std::chrono::steady_clock::duration referenceStart = _reference._duration;
+			for (auto report : reports) {
+				_crownstone._presenceHandler.registerPresence(report);
+			}
+			RTC::offsetMs(1000);
+			TestAccess<SystemTime>::tick(nullptr);
+			TestAccess<SystemTime>::tick(nullptr);
+			tickCount += 1000 / TICK_INTERVAL_MS;
+			event_t tickEvent(CS_TYPE::EVT_TICK, &tickCount, sizeof(tickCount));
+			tickEvent.dispatch();
+			dayDuration += std::chrono::steady_clock::now() - start - (_reference._duration - referenceStart);
+
+			std::optional<uint8_t> behaviourValue = _reference._behaviourHandler.getValue();
+			std::optional<uint8_t> twilightValue  = _reference._twilightHandler.getValue();
+			if (behaviourValue) {
+				// Like SwitchAggregator::aggregatedBehaviourIntensity(), else the previous value is kept.
+				expectedState = twilightValue ? CsMath::min(*behaviourValue, *twilightValue) : *behaviourValue;
+			}
+
+			std::optional<uint8_t> state = switchAggregator.getAggregatedState();
+			if (state != expectedState) {
+				if (_result.disagreements < 10) {
+					std::cout << "Disagreement at day " << day << " " << secondOfDay << "s: state "
+							  << +state.value_or(255) << ", expected " << +expectedState.value_or(255) << std::endl;
+				}
+				_result.disagreements++;
+			}
+			if (state != previousState) {
+				_result.actuations++;
+				if (state.value_or(0) == 0 || previousState.value_or(0) == 0) {
+					_result.onOffActuations++;
+				}
+				previousState = state;
+			}
+
+			if (secondOfDay == SIMULATION_SECONDS_PER_DAY - 1) {
+				firmwareDuration += dayDuration;
+				firmwareDurationMax = std::max(firmwareDurationMax, dayDuration);
+				dayDuration         = {};
+				_result.simulatedDays++;
+			}
+		}
+
+		auto toUs = [](std::chrono::steady_clock::duration d) {
+			return std::chrono::duration<double, std::micro>(d).count();
+		};
+		uint32_t days               = CsMath::max(_result.simulatedDays, 1u);
+		_result.firmwareUsPerDay    = toUs(firmwareDuration) / days;
+		_result.firmwareUsPerDayMax = toUs(firmwareDurationMax);
+		_result.referenceUsPerDay   = toUs(_reference._duration) / days;
+		return _result;
+	}
+
+private:
+	simulation_config_t _config;
+	simulation_result_t _result;
+	PresenceTraceGenerator _presenceTrace;
+	SimulatedCrownstone _crownstone;
+	ReferenceModel _reference;
+
+	bool _daylightSavingTime = false;
+
+	void setup() {
+		boards_config_t board;
+		::init(&board);
+		asHostFullyFeatured(&board);
+		Storage::getInstance().init();
+		State::getInstance().init(&board);
+
+		uint8_t dimmingAllowed = 1;
+		State::getInstance().set(CS_TYPE::CONFIG_DIMMING_ALLOWED, &dimmingAllowed, sizeof(dimmingAllowed));
+		uint8_t switchLocked = 0;
+		State::getInstance().set(CS_TYPE::CONFIG_SWITCH_LOCKED, &switchLocked, sizeof(switchLocked));
+		uint8_t switchState = 0;
+		State::getInstance().set(CS_TYPE::STATE_SWITCH_STATE, &switchState, sizeof(switchState));
+		TYPIFY(STATE_OPERATION_MODE) mode = static_cast<uint8_t>(OperationMode::OPERATION_MODE_NORMAL);
+		State::getInstance().set(CS_TYPE::STATE_OPERATION_MODE, &mode, sizeof(mode));
+		// A load is connected, so that the dimmer check after boot finds the dimmer working, and doesn't turn the relay
+		// on instead.
+		TYPIFY(STATE_POWER_USAGE) powerUsage = 60000;
+		State::getInstance().set(CS_TYPE::STATE_POWER_USAGE, &powerUsage, sizeof(powerUsage));
+
+		RTC::freeze();
+		_crownstone._systemTime.init();
+		TestAccess<SystemTime>::setTime(Time(_config.startTime));
+		SystemTime::setSunTimes(syntheticSunTimes(0, false), false);
+
+		_crownstone.parentAllChildren();
+		_crownstone._switchAggregator.init(board);
+		_crownstone._switchAggregator.switchPowered();
+		_crownstone._behaviourStore.init();
+		_crownstone._behaviourStore.listen();
+		// Like the switch aggregator, the reference model gets the tick before the presence handler.
+		_reference.listen();
+		_crownstone._presenceHandler.init();
+
+		// Start without override, so that the switch follows the behaviours.
+		TestAccess<SwitchAggregator>(_crownstone._switchAggregator).setOverrideState({});
+
+		fillRandomBehaviours(_crownstone._behaviourStore, _config.presence.roomCount, _config.behaviourSeed);
+		fillRandomBehaviours(_reference._store, _config.presence.roomCount, _config.behaviourSeed);
+		TestAccess<BehaviourHandler>::setup(
+				_reference._behaviourHandler, &_crownstone._presenceHandler, &_reference._store);
+		TestAccess<TwilightHandler>::setup(_reference._twilightHandler, &_reference._store);
+	}
+
+	void updateDaylightSavingTime(uint16_t day, uint32_t secondOfDay) {
+		if (!_config.daylightSavingTime) {
+			return;
+		}
+		if (!_daylightSavingTime && day == _config.daylightSavingStart && secondOfDay == 2 * 3600) {
+			_daylightSavingTime = true;
+			TestAccess<SystemTime>::setTime(Time(SystemTime::posix() + 3600));
+		}
+		if (_daylightSavingTime && day == _config.daylightSavingEnd && secondOfDay == 2 * 3600) {
+			// At 03:00 local time.
+			_daylightSavingTime = false;
+			TestAccess<SystemTime>::setTime(Time(SystemTime::posix() - 3600));
+		}
+	}
+};
@@ -0,0 +1,228 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <dfu/cs_DeltaPatch.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * Creates a delta patch, in the format of cs_DeltaPatch.h.
+ *
+ * Only used on the host, to create the patch between two firmware releases, so it uses a greedy search over a hash
+ * chain of the base image, and doesn't care about RAM.
+ *
+ * Consecutive firmware versions mostly differ by shifted code: the same instructions, with different addresses. So
+ * a copy that continues at the base cursor is preferred, as it only costs 2 bytes. A copy from elsewhere in the base
+ * image is only used when it gains enough to pay for its offset.
+ */
+class DeltaPatchEncoder {
+public:
+	/**
+	 * @param[in] pageSize        Page size of the flash the patch will be applied to.
+	 * @param[in] maxChainLength  Maximum number of base positions with the same hash to look at for a copy.
+	 */
+	DeltaPatchEncoder(uint16_t pageSize = 4096, uint32_t maxChainLength = 64)
+			: _pageSize(pageSize), _maxChainLength(maxChainLength) {}
+
+	/**
+	 * Create a patch in both page orders, and return the smallest.
+	 */
+	std::vector<uint8_t> encode(const std::vector<uint8_t>& base, const std::vector<uint8_t>& target) {
+		std::vector<uint8_t> forward  = encode(base, target, false);
+		std::vector<uint8_t> backward = encode(base, target, true);
+		return backward.size() < forward.size() ? backward : forward;
+	}
+
+	/**
+	 * Create a patch in the given page order.
+	 */
+	std::vector<uint8_t> encode(const std::vector<uint8_t>& base, const std::vector<uint8_t>& target, bool backward) {
+		buildHashChain(base);
+
+		cs_delta_patch_header_t header = {};
+		header.magic                   = CS_DELTA_PATCH_MAGIC;
+		header.version                 = CS_DELTA_PATCH_VERSION;
+		header.flags                   = backward ? CS_DELTA_PATCH_FLAG_BACKWARD : 0;
+		header.pageSize                = _pageSize;
+		header.baseSize                = base.size();
+		header.baseCrc                 = deltaPatchCrc32(base.data(), base.size(), 0);
+		header.targetSize              = target.size();
+		header.targetCrc               = deltaPatchCrc32(target.data(), target.size(), 0);
+
+		std::vector<uint8_t> output(sizeof(header));
+		uint32_t cursor    = 0;
+		uint32_t pageCount = (target.size() + _pageSize - 1) / _pageSize;
+		for (uint32_t i = 0; i < pageCount; ++i) {
+			uint32_t page      = backward ? pageCount - 1 - i : i;
+			uint32_t pageStart = page * _pageSize;
+			uint32_t pageEnd   = std::min<uint32_t>(pageStart + _pageSize, target.size());
+			encodePage(base, target, page, pageStart, pageEnd, backward, cursor, output);
+			header.outputCrc = deltaPatchCrc32(target.data() + pageStart, pageEnd - pageStart, header.outputCrc);
+		}
+
+		memcpy(output.data(), &header, sizeof(header));
+		return output;
+	}
+
+private:
+	static constexpr uint32_t HASH_BITS         = 16;
+	static constexpr uint32_t HASH_SIZE         = 1 << HASH_BITS;
+	static constexpr uint32_t HASH_LENGTH       = 4;
+
+	//! A copy should save at least this many bytes compared to literals.
+	static constexpr uint32_t MIN_COPY_GAIN     = 2;
+
+	uint16_t _pageSize;
+	uint32_t _maxChainLength;
+	std::vector<int32_t> _head;
+	std::vector<int32_t> _previous;
+
+	static uint32_t hash(const std::vector<uint8_t>& data, uint32_t position) {
+		uint32_t value = data[position] | (data[position + 1] << 8) | (data[position + 2] << 16)
+						 | (data[position + 3] << 24);
+		return (value * 2654435761u) >> (32 - HASH_BITS);
+	}
+
+	void buildHashChain(const std::vector<uint8_t>& base) {
+		_head.assign(HASH_SIZE, -1);
+		_previous.assign(base.size(), -1);
+		for (uint32_t position = 0; position + HASH_LENGTH <= base.size(); ++position) {
+			uint32_t h          = hash(base, position);
+			_previous[position] = _head[h];
+			_head[h]            = position;
+		}
+	}
+
+	static uint32_t varintSize(uint32_t value) {
+		uint32_t size = 1;
+		while (value >= 0x80) {
+			value >>= 7;
+			size++;
+		}
+		return size;
+	}
+
+	static void writeVarint(uint32_t value, std::vector<uint8_t>& output) {
+		while (value >= 0x80) {
+			output.push_back(0x80 | (value & 0x7F));
+			value >>= 7;
+		}
+		output.push_back(value);
+	}
+
+	static uint32_t zigzag(uint32_t offset, uint32_t cursor) {
+		int32_t delta = static_cast<int32_t>(offset - cursor);
+		return (static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31);
+	}
+
+	static uint32_t copyCost(uint32_t offset, uint32_t length, uint32_t cursor) {
+		uint32_t cost = 1 + varintSize(zigzag(offset, cursor));
+		if (length >= CS_DELTA_PATCH_MAX_LITERAL_LENGTH) {
+			cost += varintSize(length - CS_DELTA_PATCH_MAX_LITERAL_LENGTH);
+		}
+		return cost;
+	}
+
+	/**
+	 * Get the length of a copy from the base image at offset, that the decoder can still read while producing the
+	 * given page.
+	 */
+	uint32_t getCopyLength(
+			const std::vector<uint8_t>& base,
+			const std::vector<uint8_t>& target,
+			uint32_t page,
+			bool backward,
+			uint32_t offset,
+			uint32_t position,
+			uint32_t positionEnd) const {
+		uint32_t baseEnd = base.size();
+		if (backward) {
+			baseEnd = std::min<uint32_t>(baseEnd, (page + 1) * _pageSize);
+		}
+		else if (offset < page * _pageSize) {
+			return 0;
+		}
+		uint32_t length = 0;
+		while (offset + length < baseEnd && position + length < positionEnd
+			   && base[offset + length] == target[position + length]) {
+			length++;
+		}
+		return length;
+	}
+
+	void encodePage(
+			const std::vector<uint8_t>& base,
+			const std::vector<uint8_t>& target,
+			uint32_t page,
+			uint32_t pageStart,
+			uint32_t pageEnd,
+			bool backward,
+			uint32_t& cursor,
+			std::vector<uint8_t>& output) {
+		std::vector<uint8_t> literals;
+		uint32_t position = pageStart;
+		while (position < pageEnd) {
+			// Copy that continues at the cursor.
+			uint32_t bestLength = 0;
+			uint32_t bestOffset = cursor;
+			int32_t bestGain    = 0;
+			if (cursor <= base.size()) {
+				bestLength = getCopyLength(base, target, page, backward, cursor, position, pageEnd);
+				bestGain   = bestLength - copyCost(cursor, bestLength, cursor);
+			}
+
+			// Copy from elsewhere in the base image.
+			if (position + HASH_LENGTH <= target.size()) {
+				uint32_t chainLength = 0;
+				for (int32_t candidate = _head[hash(target, position)]; candidate >= 0 && chainLength < _maxChainLength;
+					 candidate = _previous[candidate], ++chainLength) {
+					uint32_t length = getCopyLength(base, target, page, backward, candidate, position, pageEnd);
+					int32_t gain    = length - copyCost(candidate, length, cursor);
+					if (gain > bestGain) {
+						bestLength = length;
+						bestOffset = candidate;
+						bestGain   = gain;
+					}
+				}
+			}
+
+			if (bestGain < static_cast<int32_t>(MIN_COPY_GAIN)) {
+				literals.push_back(target[position]);
+				position++;
+				cursor++;
+				continue;
+			}
+
+			writeLiterals(literals, output);
+			uint32_t lengthBits = std::min<uint32_t>(bestLength, CS_DELTA_PATCH_MAX_LITERAL_LENGTH) - 1;
+			output.push_back(CS_DELTA_PATCH_TOKEN_COPY | lengthBits);
+			if (bestLength >= CS_DELTA_PATCH_MAX_LITERAL_LENGTH) {
+				writeVarint(bestLength - CS_DELTA_PATCH_MAX_LITERAL_LENGTH, output);
+			}
+			writeVarint(zigzag(bestOffset, cursor), output);
+			cursor = bestOffset + bestLength;
+			position += bestLength;
+		}
+		writeLiterals(literals, output);
+	}
+
+	static void writeLiterals(std::vector<uint8_t>& literals, std::vector<uint8_t>& output) {
+		uint32_t start = 0;
+		while (start < literals.size()) {
+			uint32_t length = std::min<uint32_t>(literals.size() - start, CS_DELTA_PATCH_MAX_LITERAL_LENGTH);
+			output.push_back(length - 1);
+			output.insert(output.end(), literals.begin() + start, literals.begin() + start + length);
+			start += length;
+		}
+		literals.clear();
+	}
+};
@@ -0,0 +1,109 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <util/cs_LzDecompressor.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Compresses data to the format of LzDecompressor.
+ *
+ * Only used on the host, for example to compress a microapp before upload, so it uses a greedy search over a hash
+ * chain, and doesn't care about RAM.
+ */
+class LzCompressor {
+public:
+	/**
+	 * @param[in] maxChainLength  Maximum number of earlier positions with the same hash to look at for a match.
+	 */
+	LzCompressor(uint32_t maxChainLength = 256) : _maxChainLength(maxChainLength) {}
+
+	std::vector<uint8_t> compress(const std::vector<uint8_t>& input) {
+		std::vector<uint8_t> output;
+		std::vector<int32_t> head(HASH_SIZE, -1);
+		std::vector<int32_t> previous(input.size(), -1);
+
+		uint32_t literalStart = 0;
+		uint32_t position     = 0;
+		while (position < input.size()) {
+			uint32_t matchLength   = 0;
+			uint32_t matchDistance = 0;
+			if (position + LZ_MIN_MATCH_LENGTH <= input.size()) {
+				uint32_t chainLength = 0;
+				for (int32_t candidate = head[hash(input, position)];
+					 candidate >= 0 && position - candidate <= LZ_MAX_MATCH_DISTANCE && chainLength < _maxChainLength;
+					 candidate = previous[candidate], ++chainLength) {
+					uint32_t length = 0;
+					while (length < LZ_MAX_MATCH_LENGTH && position + length < input.size()
+						   && input[candidate + length] == input[position + length]) {
+						length++;
+					}
+					if (length > matchLength) {
+						matchLength   = length;
+						matchDistance = position - candidate;
+					}
+				}
+			}
+
+			if (matchLength < LZ_MIN_MATCH_LENGTH) {
+				insert(input, position, head, previous);
+				position++;
+				continue;
+			}
+
+			writeLiterals(input, literalStart, position, output);
+			output.push_back(LZ_MATCH_FLAG | (matchLength - LZ_MIN_MATCH_LENGTH));
+			output.push_back(matchDistance & 0xFF);
+			output.push_back(matchDistance >> 8);
+			for (uint32_t i = 0; i < matchLength; ++i) {
+				insert(input, position + i, head, previous);
+			}
+			position += matchLength;
+			literalStart = position;
+		}
+		writeLiterals(input, literalStart, position, output);
+		return output;
+	}
+
+private:
+	static constexpr uint32_t HASH_BITS = 14;
+	static constexpr uint32_t HASH_SIZE = 1 << HASH_BITS;
+
+	uint32_t _maxChainLength;
+
+	static uint32_t hash(const std::vector<uint8_t>& input, uint32_t position) {
+		uint32_t value = input[position] | (input[position + 1] << 8) | (input[position + 2] << 16);
+		return (value * 2654435761u) >> (32 - HASH_BITS);
+	}
+
+	static void insert(
+			const std::vector<uint8_t>& input,
+			uint32_t position,
+			std::vector<int32_t>& head,
+			std::vector<int32_t>& previous) {
+		if (position + LZ_MIN_MATCH_LENGTH > input.size()) {
+			return;
+		}
+		uint32_t h         = hash(input, position);
+		previous[position] = head[h];
+		head[h]            = position;
+	}
+
+	static void writeLiterals(
+			const std::vector<uint8_t>& input, uint32_t start, uint32_t end, std::vector<uint8_t>& output) {
+		while (start < end) {
+			uint32_t length = std::min<uint32_t>(end - start, LZ_MAX_LITERAL_LENGTH);
+			output.push_back(length - 1);
+			output.insert(output.end(), input.begin() + start, input.begin() + start + length);
+			start += length;
+		}
+	}
+};
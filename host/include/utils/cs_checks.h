@@ -63,7 +63,7 @@ bool checkCase(
 		int expectedBehaviourIndex,
 		PresenceStateDescription presence,
 		int line) {
-	SwitchBehaviour* expected = dynamic_cast<SwitchBehaviour*>(_behaviourStore.getBehaviour(expectedBehaviourIndex));
+	SwitchBehaviour* expected = _behaviourStore.getSwitchBehaviour(expectedBehaviourIndex);
 
 	if (!checkCase(_behaviourHandler, _behaviourStore, expected, presence, line)) {
 		std::cout << "index: " << expectedBehaviourIndex << std::endl;
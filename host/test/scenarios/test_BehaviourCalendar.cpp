@@ -0,0 +1,236 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <behaviour/cs_BehaviourHandler.h>
+#include <behaviour/cs_BehaviourStore.h>
+#include <behaviour/cs_ExtendedSwitchBehaviour.h>
+#include <behaviour/cs_TwilightBehaviour.h>
+#include <behaviour/cs_TwilightHandler.h>
+#include <boards/cs_HostBoardFullyFeatured.h>
+#include <presence/cs_PresenceHandler.h>
+#include <storage/cs_State.h>
+#include <testaccess/cs_BehaviourHandler.h>
+#include <testaccess/cs_SystemTime.h>
+#include <testaccess/cs_TwilightHandler.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+constexpr uint32_t SECONDS_PER_DAY = 24 * 60 * 60;
+constexpr uint32_t DAYS            = 7;
+
+PresenceCondition presenceCondition(PresencePredicate::Condition condition, uint64_t rooms, uint32_t timeOut) {
+	return PresenceCondition(PresencePredicate(condition, PresenceStateDescription(rooms)), timeOut);
+}
+
+/**
+ * Fills the store with a mix of behaviours: sun based and overnight times, day masks,
+ * presence and absence with grace periods, extensions, and twilights.
+ */
+void setupBehaviourStore(BehaviourStore& store) {
+	using Condition = PresencePredicate::Condition;
+	uint8_t index   = 0;
+
+	store.replaceBehaviour(
+			index++,
+			SwitchBehaviour(
+					90,
+					0,
+					0b01111111,
+					TimeOfDay::Sunrise(),
+					TimeOfDay::Sunset(),
+					presenceCondition(Condition::AnyoneInSelectedRooms, 0b001, 5 * 60)));
+
+	store.replaceBehaviour(
+			index++,
+			SwitchBehaviour(
+					30,
+					0,
+					0b00111110,
+					TimeOfDay(7, 0, 0),
+					TimeOfDay(9, 30, 0),
+					presenceCondition(Condition::VacuouslyTrue, 0, 0)));
+
+	store.replaceBehaviour(
+			index++,
+			SwitchBehaviour(
+					10,
+					0,
+					0b01111111,
+					TimeOfDay(TimeOfDay::BaseTime::Sunset, 30 * 60),
+					TimeOfDay(23, 0, 0),
+					presenceCondition(Condition::NooneInSphere, 0, 2 * 60)));
+
+	store.replaceBehaviour(
+			index++,
+			ExtendedSwitchBehaviour(
+					SwitchBehaviour(
+							70,
+							0,
+							0b01010101,
+							TimeOfDay(20, 0, 0),
+							TimeOfDay(2, 0, 0),
+							presenceCondition(Condition::AnyoneInSphere, 0, 60)),
+					presenceCondition(Condition::AnyoneInSelectedRooms, 0b110, 10 * 60)));
+
+	// An extension that is less strict than the core presence condition.
+	store.replaceBehaviour(
+			index++,
+			ExtendedSwitchBehaviour(
+					SwitchBehaviour(
+							50,
+							0,
+							0b00101010,
+							TimeOfDay(12, 0, 0),
+							TimeOfDay(18, 0, 0),
+							presenceCondition(Condition::AnyoneInSelectedRooms, 0b001, 0)),
+					presenceCondition(Condition::AnyoneInSphere, 0, 5 * 60)));
+
+	store.replaceBehaviour(index++, TwilightBehaviour(40, 0, 0b01111111, TimeOfDay(22, 0, 0), TimeOfDay(6, 0, 0)));
+
+	store.replaceBehaviour(
+			index++,
+			TwilightBehaviour(60, 0, 0b00000011, TimeOfDay(TimeOfDay::BaseTime::Sunset, -3600), TimeOfDay(23, 30, 0)));
+}
+
+/**
+ * A user that moves between rooms, and leaves the sphere every now and then.
+ */
+class User {
+public:
+	void tickSecond(PresenceHandler& presenceHandler) {
+		if (_secondsUntilMove == 0) {
+			// Location 3 means: not in the sphere.
+			_location         = rand() % 4;
+			_secondsUntilMove = 1 + rand() % (90 * 60);
+		}
+		_secondsUntilMove--;
+
+		if (_location < 3 && rand() % 5 == 0) {
+			presenceHandler.registerPresence(PresenceHandler::ProfileLocation{.profile = 0, .location = _location});
+		}
+	}
+
+private:
+	uint8_t _location          = 3;
+	uint32_t _secondsUntilMove = 0;
+};
+
+void tickSecond(PresenceHandler& presenceHandler) {
+	RTC::offsetMs(1000);
+	TestAccess<SystemTime>::tick(nullptr);
+	TestAccess<SystemTime>::tick(nullptr);
+
+	TYPIFY(EVT_TICK_SECOND) uptime = SystemTime::up();
+	event_t secondEvent(CS_TYPE::EVT_TICK_SECOND, &uptime, sizeof(uptime));
+	presenceHandler.handleEvent(secondEvent);
+}
+
+/**
+ * Sweeps a week, second by second, and checks that a behaviour handler that only evaluates at the computed
+ * transition times gives the same result as one that evaluates every second.
+ */
+int main() {
+	boards_config_t board;
+	init(&board);
+	asHostFullyFeatured(&board);
+	Storage::getInstance().init();
+	State::getInstance().init(&board);
+
+	SystemTime systemTime;
+	systemTime.init();
+	TestAccess<SystemTime>::setTime(Time(DayOfWeek::Monday, 0, 0));
+	SystemTime::setSunTimes(sun_time_t{.sunrise = 7 * 3600, .sunset = 19 * 3600}, false);
+
+	PresenceHandler presenceHandler;
+	User user;
+
+	// The reference handlers evaluate every second, the calendar handlers only when needed.
+	BehaviourStore referenceStore;
+	BehaviourStore calendarStore;
+	BehaviourHandler referenceHandler;
+	BehaviourHandler calendarHandler;
+	TwilightHandler referenceTwilightHandler;
+	TwilightHandler calendarTwilightHandler;
+	TestAccess<BehaviourHandler>::setup(referenceHandler, &presenceHandler, &referenceStore);
+	TestAccess<BehaviourHandler>::setup(calendarHandler, &presenceHandler, &calendarStore);
+	TestAccess<TwilightHandler>::setup(referenceTwilightHandler, &referenceStore);
+	TestAccess<TwilightHandler>::setup(calendarTwilightHandler, &calendarStore);
+	setupBehaviourStore(referenceStore);
+	setupBehaviourStore(calendarStore);
+
+	std::chrono::steady_clock::duration referenceDuration{};
+	std::chrono::steady_clock::duration calendarDuration{};
+	uint32_t transitionCount             = 0;
+	std::optional<uint8_t> previousValue = {};
+
+	for (uint32_t second = 0; second < DAYS * SECONDS_PER_DAY; ++second) {
+		user.tickSecond(presenceHandler);
+		tickSecond(presenceHandler);
+
+		if (second % SECONDS_PER_DAY == 12 * 3600) {
+			// Sun times shift a bit every day.
+			uint32_t day = second / SECONDS_PER_DAY;
+			sun_time_t sunTime{.sunrise = 7 * 3600 - day * 120, .sunset = 19 * 3600 + day * 120};
+			SystemTime::setSunTimes(sunTime, false);
+			referenceStore.updateCachedTimes();
+			event_t sunTimeEvent(CS_TYPE::STATE_SUN_TIME, &sunTime, sizeof(sunTime));
+			calendarHandler.handleEvent(sunTimeEvent);
+			calendarTwilightHandler.handleEvent(sunTimeEvent);
+		}
+
+		if (second == 3 * SECONDS_PER_DAY + 21 * 3600) {
+			// Set the time back an hour.
+			uint32_t previousTime = SystemTime::posix();
+			TestAccess<SystemTime>::setTime(Time(previousTime - 3600));
+			event_t timeSetEvent(CS_TYPE::EVT_TIME_SET, &previousTime, sizeof(previousTime));
+			calendarHandler.handleEvent(timeSetEvent);
+			calendarTwilightHandler.handleEvent(timeSetEvent);
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		referenceHandler.invalidate();
+		referenceHandler.update();
+		referenceTwilightHandler.invalidate();
+		referenceTwilightHandler.update();
+		auto middle = std::chrono::steady_clock::now();
+		calendarHandler.update();
+		calendarTwilightHandler.update();
+		auto end = std::chrono::steady_clock::now();
+		referenceDuration += middle - start;
+		calendarDuration += end - middle;
+
+		auto referenceValue = referenceHandler.getValue();
+		auto calendarValue  = calendarHandler.getValue();
+		if (referenceValue != calendarValue
+			|| referenceTwilightHandler.getValue() != calendarTwilightHandler.getValue()) {
+			std::cout << "FAILED at second " << second << ": behaviour " << +referenceValue.value_or(255) << " vs "
+					  << +calendarValue.value_or(255) << ", twilight "
+					  << +referenceTwilightHandler.getValue().value_or(255) << " vs "
+					  << +calendarTwilightHandler.getValue().value_or(255) << std::endl;
+			return 1;
+		}
+		if (referenceValue != previousValue) {
+			transitionCount++;
+			previousValue = referenceValue;
+		}
+	}
+
+	std::cout << "Behaviour value changed " << transitionCount << " times in " << DAYS << " days" << std::endl;
+	std::cout << "Evaluating every second: "
+			  << std::chrono::duration_cast<std::chrono::milliseconds>(referenceDuration).count() << " ms" << std::endl;
+	std::cout << "Evaluating at transitions: "
+			  << std::chrono::duration_cast<std::chrono::milliseconds>(calendarDuration).count() << " ms" << std::endl;
+
+	// The sweep is only meaningful when the behaviours actually switch.
+	if (transitionCount < DAYS * 4) {
+		std::cout << "FAILED: too few transitions" << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -19,26 +19,24 @@
 #include <utils/date.h>
 
 
-SwitchBehaviour* getBehaviourPresent(PresencePredicate::Condition condition, bool multipleRooms = false){
+SwitchBehaviour getBehaviourPresent(PresencePredicate::Condition condition, bool multipleRooms = false){
     TestAccess<SwitchBehaviour> testAccessSwitchBehaviour;
 
 	testAccessSwitchBehaviour.intensity                              = 95;
 	testAccessSwitchBehaviour.presencecondition.predicate._condition = condition;
 	testAccessSwitchBehaviour.presencecondition.predicate._presence._bitmask =
 			multipleRooms ? roomBitmaskSingle() : roomBitmaskMulti();
-	auto switchBehaviourInRoom = new SwitchBehaviour(testAccessSwitchBehaviour.get());
-	return switchBehaviourInRoom;
+	return testAccessSwitchBehaviour.get();
 }
 
-SwitchBehaviour* getBehaviourNarrowTimesWithTrivialPresence() {
+SwitchBehaviour getBehaviourNarrowTimesWithTrivialPresence() {
 	TestAccess<SwitchBehaviour> testAccessSwitchBehaviour;
 
 	testAccessSwitchBehaviour.from                                   = TimeOfDay(11, 59, 0);
 	testAccessSwitchBehaviour.until                                  = TimeOfDay(12, 1, 0);
 	testAccessSwitchBehaviour.intensity                              = 1;
 	testAccessSwitchBehaviour.presencecondition.predicate._condition = PresencePredicate::Condition::VacuouslyTrue;
-	auto switchBehaviourPresenceIrrelevant = new SwitchBehaviour(testAccessSwitchBehaviour.get());
-	return switchBehaviourPresenceIrrelevant;
+	return testAccessSwitchBehaviour.get();
 }
 
 
@@ -55,12 +53,12 @@ struct TestBehaviours {
 	static constexpr int nooneInRoomMulti  = 7;
 
 	/**
-	 * this method allocates on the heap. no need to clean up, the behaviourstore will take
-	 * ownership and delete items properly.
+	 * the behaviourstore stores a copy of the returned behaviour.
 	 */
-	static SwitchBehaviour* makeTestSwitchBehaviour(int index) {
+	static SwitchBehaviour makeTestSwitchBehaviour(int index) {
 		switch (index) {
 			case verySpecific: return getBehaviourNarrowTimesWithTrivialPresence();
+			default:
 			case vacuouslyTrue: return getBehaviourPresent(PresencePredicate::Condition::VacuouslyTrue);
 			case anyoneInSphere: return getBehaviourPresent(PresencePredicate::Condition::AnyoneInSphere);
 			case nooneInSphere: return getBehaviourPresent(PresencePredicate::Condition::NooneInSphere);
@@ -69,7 +67,6 @@ struct TestBehaviours {
 			case anyoneInRoomMulti:
 				return getBehaviourPresent(PresencePredicate::Condition::AnyoneInSelectedRooms, true);
 			case nooneInRoomMulti: return getBehaviourPresent(PresencePredicate::Condition::NooneInSelectedRooms, true);
-			default: return nullptr;
 		}
 	}
 };
@@ -0,0 +1,119 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <behaviour/cs_BehaviourStore.h>
+#include <behaviour/cs_ExtendedSwitchBehaviour.h>
+#include <behaviour/cs_TwilightBehaviour.h>
+#include <boards/cs_HostBoardFullyFeatured.h>
+#include <storage/cs_State.h>
+#include <testaccess/cs_BehaviourStore.h>
+#include <util/cs_Hash.h>
+
+#include <cstdlib>
+#include <iostream>
+
+/**
+ * The master hash as it is defined on the wire: a Fletcher hash over the index and serialized behaviour,
+ * of all behaviours in order of index.
+ */
+uint32_t referenceMasterHash(BehaviourStore& store) {
+	uint32_t fletch = 0;
+	for (uint8_t i = 0; i < BehaviourStore::MaxBehaviours; i++) {
+		Behaviour* behaviour = store.getBehaviour(i);
+		if (behaviour) {
+			fletch = Fletcher(&i, sizeof(i), fletch);
+			fletch = Fletcher(behaviour->serialized().data(), behaviour->serializedSize(), fletch);
+		}
+	}
+	return fletch;
+}
+
+PresenceCondition randomPresenceCondition() {
+	return PresenceCondition(
+			PresencePredicate(
+					PresencePredicate::Condition::AnyoneInSelectedRooms, PresenceStateDescription(rand() % 0xFF)),
+			rand() % 600);
+}
+
+SwitchBehaviour randomSwitchBehaviour() {
+	return SwitchBehaviour(
+			rand() % 100,
+			0,
+			rand() % 0x7F,
+			TimeOfDay(rand() % 86400),
+			TimeOfDay(rand() % 86400),
+			randomPresenceCondition());
+}
+
+/**
+ * Randomly adds, replaces and removes behaviours of all types, and checks that the incrementally
+ * maintained master hash equals the hash over all behaviours, also when the pool of a type is full.
+ */
+int main() {
+	boards_config_t board;
+	init(&board);
+	asHostFullyFeatured(&board);
+	Storage::getInstance().init();
+	State::getInstance().init(&board);
+
+	srand(1);
+	BehaviourStore store;
+	if (store.getMasterHash() != 0) {
+		std::cout << "FAILED: hash of empty store is " << store.getMasterHash() << std::endl;
+		return 1;
+	}
+
+	int noSpaceCount = 0;
+	for (int step = 0; step < 1000; ++step) {
+		uint8_t index                = rand() % BehaviourStore::MaxBehaviours;
+		Behaviour* previousBehaviour = store.getBehaviour(index);
+		ErrorCodesGeneral retCode    = ERR_SUCCESS;
+		switch (rand() % 4) {
+			case 0: retCode = store.replaceBehaviour(index, randomSwitchBehaviour()); break;
+			case 1: {
+				retCode = store.replaceBehaviour(
+						index, ExtendedSwitchBehaviour(randomSwitchBehaviour(), randomPresenceCondition()));
+				break;
+			}
+			case 2: {
+				retCode = store.replaceBehaviour(
+						index, TwilightBehaviour(rand() % 100, 0, 0x7F, TimeOfDay(22, 0, 0), TimeOfDay(6, 0, 0)));
+				break;
+			}
+			default: TestAccess<BehaviourStore>::removeBehaviour(store, index); break;
+		}
+		// When the pool of a type is full, the behaviour at the index must be kept.
+		if (retCode == ERR_NO_SPACE) {
+			noSpaceCount++;
+			if (store.getBehaviour(index) != previousBehaviour) {
+				std::cout << "FAILED at step " << step << ": behaviour changed without space" << std::endl;
+				return 1;
+			}
+		}
+
+		TYPIFY(STATE_BEHAVIOUR_MASTER_HASH) storedHash;
+		State::getInstance().get(CS_TYPE::STATE_BEHAVIOUR_MASTER_HASH, &storedHash, sizeof(storedHash));
+		uint32_t expectedHash = referenceMasterHash(store);
+		if (store.getMasterHash() != expectedHash || storedHash != expectedHash) {
+			std::cout << "FAILED at step " << step << ": hash " << store.getMasterHash() << ", stored hash "
+					  << storedHash << ", expected " << expectedHash << std::endl;
+			return 1;
+		}
+	}
+
+	if (noSpaceCount == 0) {
+		std::cout << "FAILED: no pool got full" << std::endl;
+		return 1;
+	}
+
+	TestAccess<BehaviourStore>::clearActiveBehavioursArray(store);
+	if (store.getMasterHash() != 0) {
+		std::cout << "FAILED: hash of cleared store is " << store.getMasterHash() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,234 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <behaviour/cs_BehaviourConflictResolution.h>
+#include <behaviour/cs_BehaviourHandler.h>
+#include <behaviour/cs_BehaviourStore.h>
+#include <behaviour/cs_ExtendedSwitchBehaviour.h>
+#include <behaviour/cs_TwilightBehaviour.h>
+#include <boards/cs_HostBoardFullyFeatured.h>
+#include <presence/cs_PresenceHandler.h>
+#include <storage/cs_State.h>
+#include <testaccess/cs_BehaviourHandler.h>
+#include <testaccess/cs_SystemTime.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+constexpr uint32_t SECONDS_PER_WEEK = 7 * 24 * 60 * 60;
+constexpr int RESOLVE_COUNT         = 20000;
+
+// Allocation overhead per heap allocated behaviour, as used to be the case.
+constexpr size_t MALLOC_OVERHEAD    = 8;
+
+TimeOfDay randomTimeOfDay() {
+	switch (rand() % 4) {
+		case 0: return TimeOfDay(TimeOfDay::BaseTime::Sunrise, (rand() % 7200) - 3600);
+		case 1: return TimeOfDay(TimeOfDay::BaseTime::Sunset, (rand() % 7200) - 3600);
+		default: return TimeOfDay(rand() % 24, (rand() % 4) * 15, 0);
+	}
+}
+
+PresenceCondition randomPresenceCondition() {
+	using Condition        = PresencePredicate::Condition;
+	Condition conditions[] = {
+			Condition::VacuouslyTrue,
+			Condition::AnyoneInSelectedRooms,
+			Condition::NooneInSelectedRooms,
+			Condition::AnyoneInSphere,
+			Condition::NooneInSphere};
+	Condition condition    = conditions[rand() % 5];
+	uint64_t rooms         = 1 + rand() % 0xFF;
+	return PresenceCondition(PresencePredicate(condition, PresenceStateDescription(rooms)), 0);
+}
+
+SwitchBehaviour randomSwitchBehaviour() {
+	return SwitchBehaviour(
+			1 + rand() % 100, 0, 1 + rand() % 0x7F, randomTimeOfDay(), randomTimeOfDay(), randomPresenceCondition());
+}
+
+/**
+ * Fills the store with a random mix of all behaviour types, and returns the heap usage it would have had
+ * when every behaviour was allocated separately.
+ *
+ * The mix follows the pool sizes of the store: when the pool of the chosen type is full, the next type is tried.
+ */
+size_t setupBehaviourStore(BehaviourStore& store) {
+	size_t heapSize = 0;
+	for (uint8_t index = 0; index < BehaviourStore::MaxBehaviours; ++index) {
+		size_t choice = rand() % (BehaviourStore::MaxSwitchBehaviours + BehaviourStore::MaxExtendedBehaviours
+								  + BehaviourStore::MaxTwilightBehaviours);
+		int type      = 0;
+		if (choice >= BehaviourStore::MaxSwitchBehaviours) {
+			type = 1;
+		}
+		if (choice >= BehaviourStore::MaxSwitchBehaviours + BehaviourStore::MaxExtendedBehaviours) {
+			type = 2;
+		}
+		for (int attempt = 0; attempt < 3; ++attempt, type = (type + 1) % 3) {
+			ErrorCodesGeneral retCode;
+			size_t size;
+			switch (type) {
+				case 0: {
+					retCode = store.replaceBehaviour(index, randomSwitchBehaviour());
+					size    = sizeof(SwitchBehaviour);
+					break;
+				}
+				case 1: {
+					retCode = store.replaceBehaviour(
+							index, ExtendedSwitchBehaviour(randomSwitchBehaviour(), randomPresenceCondition()));
+					size = sizeof(ExtendedSwitchBehaviour);
+					break;
+				}
+				default: {
+					retCode = store.replaceBehaviour(
+							index, TwilightBehaviour(1 + rand() % 100, 0, 0x7F, randomTimeOfDay(), randomTimeOfDay()));
+					size = sizeof(TwilightBehaviour);
+					break;
+				}
+			}
+			if (retCode != ERR_NO_SPACE) {
+				heapSize += size + MALLOC_OVERHEAD;
+				break;
+			}
+		}
+	}
+	return heapSize;
+}
+
+/**
+ * Conflict resolution as it was done before the behaviours were stored by type:
+ * dynamic casts, and the presence predicates and times of day are compared on every evaluation.
+ */
+SwitchBehaviour* legacyResolveSwitchBehaviour(
+		BehaviourStore& store, Time currentTime, PresenceStateDescription currentPresence) {
+	SwitchBehaviour* currentBest = nullptr;
+	for (auto behaviour : store.getActiveBehaviours()) {
+		SwitchBehaviour* candidate = dynamic_cast<SwitchBehaviour*>(behaviour);
+		if (candidate == nullptr || !candidate->isValid(currentTime, currentPresence)) {
+			continue;
+		}
+		if (currentBest == nullptr) {
+			currentBest = candidate;
+			continue;
+		}
+
+		auto candidateCondition   = candidate->currentPresencePredicate();
+		auto currentBestCondition = currentBest->currentPresencePredicate();
+		if (PresenceIsMoreRelevant(candidateCondition, currentBestCondition)) {
+			currentBest = candidate;
+			continue;
+		}
+		if (PresenceIsMoreRelevant(currentBestCondition, candidateCondition)) {
+			continue;
+		}
+
+		int32_t candidateFrom    = static_cast<uint32_t>(candidate->from());
+		int32_t candidateUntil   = static_cast<uint32_t>(candidate->until());
+		int32_t currentBestFrom  = static_cast<uint32_t>(currentBest->from());
+		int32_t currentBestUntil = static_cast<uint32_t>(currentBest->until());
+		if (candidateFrom == currentBestFrom && candidateUntil == currentBestUntil) {
+			if (candidate->value() < currentBest->value()) {
+				currentBest = candidate;
+			}
+		}
+		else if (FromUntilIntervalIsMoreRelevantOrEqual(
+						 candidateFrom, candidateUntil, currentBestFrom, currentBestUntil, currentTime.timeOfDay())) {
+			currentBest = candidate;
+		}
+	}
+	return currentBest;
+}
+
+/**
+ * Returns the index of the behaviour in the store, or MaxBehaviours if it's not in the store.
+ */
+uint8_t indexOf(BehaviourStore& store, Behaviour* behaviour) {
+	for (uint8_t index = 0; index < BehaviourStore::MaxBehaviours; ++index) {
+		if (behaviour != nullptr && store.getActiveBehaviours()[index] == behaviour) {
+			return index;
+		}
+	}
+	return BehaviourStore::MaxBehaviours;
+}
+
+/**
+ * Resolves random times and presences with a full store, and checks that the tag dispatch with precomputed
+ * conflict keys gives the same result as the legacy resolution. Prints the RAM usage and the resolution times.
+ *
+ * Validating a behaviour changes its runtime values, and validating an extended switch behaviour twice at the same
+ * time doesn't always give the same result. So the legacy resolution gets its own, identical, store.
+ */
+int main() {
+	boards_config_t board;
+	init(&board);
+	asHostFullyFeatured(&board);
+	Storage::getInstance().init();
+	State::getInstance().init(&board);
+
+	SystemTime systemTime;
+	systemTime.init();
+	TestAccess<SystemTime>::setTime(Time(DayOfWeek::Monday, 0, 0));
+	SystemTime::setSunTimes(sun_time_t{.sunrise = 7 * 3600, .sunset = 19 * 3600}, false);
+
+	PresenceHandler presenceHandler;
+	BehaviourStore store;
+	BehaviourStore legacyStore;
+	BehaviourHandler handler;
+	TestAccess<BehaviourHandler>::setup(handler, &presenceHandler, &store);
+	srand(1);
+	setupBehaviourStore(legacyStore);
+	srand(1);
+	size_t heapSize = setupBehaviourStore(store);
+
+	size_t poolsSize         = sizeof(BehaviourStore::SwitchBehaviourPool)
+						+ sizeof(BehaviourStore::ExtendedSwitchBehaviourPool)
+						+ sizeof(BehaviourStore::TwilightBehaviourPool);
+	size_t slotsSize         = sizeof(ExtendedSwitchBehaviour) * BehaviourStore::MaxBehaviours;
+	size_t pointerTableSize  = sizeof(Behaviour*) * BehaviourStore::MaxBehaviours;
+	size_t heapWorstCaseSize = (sizeof(ExtendedSwitchBehaviour) + MALLOC_OVERHEAD) * BehaviourStore::MaxBehaviours;
+	std::cout << "Behaviour sizes: switch=" << sizeof(SwitchBehaviour)
+			  << " extended=" << sizeof(ExtendedSwitchBehaviour) << " twilight=" << sizeof(TwilightBehaviour)
+			  << std::endl;
+	std::cout << "Pools: " << poolsSize << " bytes static, a slot per index of the largest type: " << slotsSize
+			  << " bytes static, heap: " << heapSize << " bytes for this mix, " << heapWorstCaseSize
+			  << " bytes worst case, plus " << pointerTableSize << " bytes pointer table" << std::endl;
+
+	uint32_t startTime = Time(DayOfWeek::Monday, 0, 0).timestamp();
+	std::chrono::steady_clock::duration legacyDuration{};
+	std::chrono::steady_clock::duration duration{};
+	int resolvedCount = 0;
+
+	for (int i = 0; i < RESOLVE_COUNT; ++i) {
+		Time currentTime(startTime + rand() % SECONDS_PER_WEEK);
+		PresenceStateDescription presence(rand() % 0x100);
+
+		auto start                = std::chrono::steady_clock::now();
+		SwitchBehaviour* legacy   = legacyResolveSwitchBehaviour(legacyStore, currentTime, presence);
+		auto middle               = std::chrono::steady_clock::now();
+		SwitchBehaviour* resolved =
+				TestAccess<BehaviourHandler>::resolveSwitchBehaviour(handler, currentTime, presence);
+		auto end                  = std::chrono::steady_clock::now();
+		legacyDuration += middle - start;
+		duration += end - middle;
+
+		if (indexOf(legacyStore, legacy) != indexOf(store, resolved)) {
+			std::cout << "FAILED at " << currentTime.timestamp() << " presence " << presence.getBitmask() << std::endl;
+			return 1;
+		}
+		resolvedCount += (resolved != nullptr);
+	}
+
+	auto toUs = [](std::chrono::steady_clock::duration d) {
+		return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+	};
+	std::cout << resolvedCount << " of " << RESOLVE_COUNT << " resolved to a behaviour" << std::endl;
+	std::cout << "Legacy resolution: " << toUs(legacyDuration) << " us, tag dispatch: " << toUs(duration) << " us"
+			  << std::endl;
+	return 0;
+}
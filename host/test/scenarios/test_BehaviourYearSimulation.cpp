@@ -0,0 +1,46 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <utils/cs_BehaviourSimulation.h>
+
+#include <cstdlib>
+#include <iostream>
+
+/**
+ * Simulates a crownstone with 50 behaviours and a household of users for a year, and checks that the switch
+ * follows the reference model at every second.
+ *
+ * Usage: test_BehaviourYearSimulation [days]
+ */
+int main(int argc, char** argv) {
+	simulation_config_t config;
+	if (argc > 1) {
+		config.days = std::atoi(argv[1]);
+	}
+
+	BehaviourSimulation simulation(config);
+	simulation_result_t result = simulation.run();
+
+	std::cout << "Simulated " << result.simulatedDays << " days, " << result.presenceReports << " presence reports"
+			  << std::endl;
+	std::cout << "Switch actuations: " << result.actuations << ", of which on/off: " << result.onOffActuations
+			  << std::endl;
+	std::cout << "CPU per simulated day: " << result.firmwareUsPerDay << " us average, "
+			  << result.firmwareUsPerDayMax << " us max, reference model: " << result.referenceUsPerDay << " us"
+			  << std::endl;
+	std::cout << "Disagreements with the reference model: " << result.disagreements << std::endl;
+
+	if (result.disagreements != 0) {
+		return 1;
+	}
+	// The behaviours should actually do something.
+	if (result.onOffActuations == 0) {
+		std::cout << "FAILED: the switch never turned on or off" << std::endl;
+		return 1;
+	}
+	return 0;
+}
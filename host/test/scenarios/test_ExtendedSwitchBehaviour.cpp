@@ -0,0 +1,104 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <behaviour/cs_ExtendedSwitchBehaviour.h>
+#include <testaccess/cs_SystemTime.h>
+
+#include <iostream>
+
+const PresenceStateDescription nobody(0);
+const PresenceStateDescription inRoom1(0b010);
+const PresenceStateDescription inRoom2(0b100);
+
+PresenceCondition presenceCondition(PresencePredicate::Condition condition, uint64_t rooms, uint32_t timeOut) {
+	return PresenceCondition(PresencePredicate(condition, PresenceStateDescription(rooms)), timeOut);
+}
+
+ExtendedSwitchBehaviour makeBehaviour(PresenceCondition extensionCondition) {
+	using Condition = PresencePredicate::Condition;
+	return ExtendedSwitchBehaviour(
+			SwitchBehaviour(
+					80,
+					0,
+					0b01111111,
+					TimeOfDay(12, 0, 0),
+					TimeOfDay(13, 0, 0),
+					presenceCondition(Condition::AnyoneInSelectedRooms, 0b010, 0)),
+			extensionCondition);
+}
+
+bool check(ExtendedSwitchBehaviour& behaviour, PresenceStateDescription presence, bool expected, int line) {
+	bool result = behaviour.isValid(SystemTime::now(), presence);
+	if (result != expected) {
+		std::cout << "FAILED test at line: " << line << ", got " << result << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/**
+ * In the time slot, the core presence condition applies.
+ *
+ * The old code looked at the extension condition after a false result: with a vacuous extension, the result
+ * alternated between true and false at every call, so it depended on how often the behaviour was evaluated.
+ */
+bool testTimeSlot() {
+	TestAccess<SystemTime>::setTime(Time(DayOfWeek::Monday, 12, 30));
+	auto behaviour = makeBehaviour(presenceCondition(PresencePredicate::Condition::VacuouslyTrue, 0, 60));
+
+	// Old: true, false, true, false.
+	for (int i = 0; i < 4; ++i) {
+		if (!check(behaviour, nobody, false, __LINE__)) return false;
+	}
+
+	// Old: true, true.
+	if (!check(behaviour, inRoom1, true, __LINE__)) return false;
+	if (!check(behaviour, inRoom1, true, __LINE__)) return false;
+	return true;
+}
+
+/**
+ * The extension grace period includes the second of the last match of the extension condition.
+ *
+ * The old code excluded it: when the presence changed within the same second, the extension ended at once,
+ * regardless of its time out. Another call a second earlier would have kept the extension.
+ */
+bool testExtensionGracePeriod() {
+	TestAccess<SystemTime>::setTime(Time(DayOfWeek::Monday, 12, 59, 59));
+	auto behaviour =
+			makeBehaviour(presenceCondition(PresencePredicate::Condition::AnyoneInSelectedRooms, 0b110, 60));
+
+	if (!check(behaviour, inRoom1, true, __LINE__)) return false;
+
+	// After the time slot, the extension condition matches.
+	TestAccess<SystemTime>::fastForwardS(2);
+	if (!check(behaviour, inRoom2, true, __LINE__)) return false;
+
+	// Old: false, and the extension ended.
+	if (!check(behaviour, nobody, true, __LINE__)) return false;
+
+	TestAccess<SystemTime>::fastForwardS(60);
+	// Old: false.
+	if (!check(behaviour, nobody, true, __LINE__)) return false;
+	TestAccess<SystemTime>::fastForwardS(1);
+	if (!check(behaviour, nobody, false, __LINE__)) return false;
+	if (behaviour.extensionPeriodIsActive()) {
+		std::cout << "FAILED: extension still active" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+int main() {
+	SystemTime systemTime;
+	systemTime.init();
+
+	if (!testTimeSlot()) return 1;
+	if (!testExtensionGracePeriod()) return 1;
+	std::cout << std::endl << "ExtendedSwitchBehaviour OK" << std::endl;
+	return 0;
+}
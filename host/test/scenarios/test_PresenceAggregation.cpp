@@ -0,0 +1,96 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <boards/cs_HostBoardFullyFeatured.h>
+#include <presence/cs_PresenceHandler.h>
+#include <storage/cs_State.h>
+#include <testaccess/cs_PresenceHandler.h>
+#include <testaccess/cs_SystemTime.h>
+
+#include <cstdlib>
+#include <iostream>
+
+constexpr int SECONDS = 3600;
+
+bool checkPresence(PresenceHandler& presenceHandler, int second) {
+	uint64_t expected = TestAccess<PresenceHandler>::scanOccupiedLocations(presenceHandler);
+	auto presence     = presenceHandler.getCurrentPresenceDescription();
+	if (!presence || presence->getBitmask() != expected) {
+		std::cout << "FAILED at second " << second << ": expected " << expected << ", got "
+				  << (presence ? presence->getBitmask() : 0) << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Registers random profile locations at a varying rate, so that the store alternates between
+ * being empty and overflowing, and checks that the incrementally maintained presence equals
+ * the presence from a scan of all records.
+ */
+int main() {
+	boards_config_t board;
+	init(&board);
+	asHostFullyFeatured(&board);
+	Storage::getInstance().init();
+	State::getInstance().init(&board);
+
+	SystemTime systemTime;
+	systemTime.init();
+
+	srand(1);
+	PresenceHandler presenceHandler;
+
+	// Let the presence become certain.
+	while (!presenceHandler.getCurrentPresenceDescription()) {
+		RTC::offsetMs(1000);
+		TestAccess<SystemTime>::tick(nullptr);
+		TestAccess<SystemTime>::tick(nullptr);
+	}
+
+	bool overflowed = false;
+	for (int second = 0; second < SECONDS; ++second) {
+		// Alternate between quiet and busy periods of 5 minutes.
+		int registrations = ((second / 300) % 2) ? rand() % 40 : rand() % 2;
+		for (int i = 0; i < registrations; ++i) {
+			PresenceHandler::ProfileLocation profileLocation = {
+					.profile  = static_cast<uint8_t>(rand() % (PresenceHandler::ProfileLocation::MAX_PROFILE_ID + 1)),
+					.location = static_cast<uint8_t>(rand() % (PresenceHandler::ProfileLocation::MAX_LOCATION_ID + 1))};
+			presenceHandler.registerPresence(profileLocation);
+			if (!checkPresence(presenceHandler, second)) {
+				return 1;
+			}
+		}
+		uint16_t recordCount = TestAccess<PresenceHandler>::validRecordCount(presenceHandler);
+		if (recordCount == TestAccess<PresenceHandler>::maxRecords()) {
+			overflowed = true;
+		}
+
+		TestAccess<PresenceHandler>::tickSecond(presenceHandler);
+		if (!checkPresence(presenceHandler, second)) {
+			return 1;
+		}
+	}
+
+	if (!overflowed) {
+		std::cout << "FAILED: store never got full" << std::endl;
+		return 1;
+	}
+
+	// After the timeout, everyone should have left.
+	for (int second = 0; second < 0xFF; ++second) {
+		TestAccess<PresenceHandler>::tickSecond(presenceHandler);
+	}
+	if (!checkPresence(presenceHandler, SECONDS)) {
+		return 1;
+	}
+	if (presenceHandler.getCurrentPresenceDescription()->getBitmask() != 0) {
+		std::cout << "FAILED: presence did not time out" << std::endl;
+		return 1;
+	}
+	return 0;
+}
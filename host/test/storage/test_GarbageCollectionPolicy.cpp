@@ -0,0 +1,171 @@
+/**
+ * Simulates records being updated in flash pages like FDS does, and compares the number of writes that find the flash
+ * full, without and with the garbage collection policy.
+ *
+ * Without the policy, garbage is only collected after a write failed. With the policy, garbage is collected in idle
+ * periods, or when the free space gets low. Writes should then never find the flash full.
+ */
+
+#include <cfg/cs_Config.h>
+#include <storage/cs_GarbageCollectionPolicy.h>
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+constexpr uint32_t PAGE_COUNT         = 3;
+constexpr uint32_t PAGE_WORDS         = 1024;
+constexpr uint32_t HEADER_WORDS       = 3;
+constexpr uint32_t RECORD_COUNT       = 60;
+constexpr uint32_t MAX_RECORD_WORDS   = 40;
+constexpr int INTERVAL_COUNT          = 20000;
+constexpr int MAX_WRITES_PER_INTERVAL = 2;
+
+/**
+ * Flash pages, where records are appended to, and updated records leave dirty words behind.
+ */
+class FlashSimulation {
+public:
+	FlashSimulation() : _recordPage(RECORD_COUNT, -1), _recordWords(RECORD_COUNT, 0) {
+		for (auto& page : _pages) {
+			page = page_t();
+		}
+	}
+
+	/**
+	 * Returns false when the flash is full.
+	 */
+	bool write(uint32_t record, uint32_t dataWords) {
+		uint32_t words = dataWords + HEADER_WORDS;
+		for (uint32_t i = 0; i < PAGE_COUNT; ++i) {
+			if (PAGE_WORDS - _pages[i].writtenWords >= words) {
+				if (_recordPage[record] >= 0) {
+					_pages[_recordPage[record]].dirtyWords += _recordWords[record];
+				}
+				_pages[i].writtenWords += words;
+				_recordPage[record]  = i;
+				_recordWords[record] = words;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void collectGarbage() {
+		for (auto& page : _pages) {
+			page.writtenWords -= page.dirtyWords;
+			page.dirtyWords = 0;
+		}
+		_gcCount++;
+	}
+
+	storage_usage_t getUsage() const {
+		storage_usage_t usage;
+		usage.totalWords = PAGE_COUNT * PAGE_WORDS;
+		for (auto& page : _pages) {
+			usage.usedWords += page.writtenWords;
+			usage.freeableWords += page.dirtyWords;
+			if (PAGE_WORDS - page.writtenWords > usage.largestFreeWords) {
+				usage.largestFreeWords = PAGE_WORDS - page.writtenWords;
+			}
+		}
+		return usage;
+	}
+
+	int getGcCount() const { return _gcCount; }
+
+private:
+	struct page_t {
+		uint32_t writtenWords = 0;
+		uint32_t dirtyWords   = 0;
+	};
+
+	page_t _pages[PAGE_COUNT];
+	vector<int> _recordPage;
+	vector<uint32_t> _recordWords;
+	int _gcCount = 0;
+};
+
+void testPolicy() {
+	GarbageCollectionPolicy policy(25, 384, 160);
+	storage_usage_t usage;
+	usage.totalWords       = 3072;
+	usage.usedWords        = 3000;
+	usage.largestFreeWords = 50;
+
+	// Nothing to gain.
+	assert(!policy.shouldCollect(usage, true));
+
+	// Urgent.
+	usage.freeableWords = 100;
+	assert(policy.shouldCollect(usage, false));
+
+	// Low on free space, only when idle, and when enough can be reclaimed.
+	usage.largestFreeWords = 300;
+	assert(!policy.shouldCollect(usage, true));
+	usage.freeableWords = 200;
+	assert(!policy.shouldCollect(usage, false));
+	assert(policy.shouldCollect(usage, true));
+
+	// Plenty of free space, only when much can be reclaimed.
+	usage.largestFreeWords = 2000;
+	assert(!policy.shouldCollect(usage, true));
+	usage.freeableWords = 800;
+	assert(policy.shouldCollect(usage, true));
+	assert(!policy.shouldCollect(usage, false));
+}
+
+/**
+ * Returns the number of writes that found the flash full.
+ */
+int simulate(bool usePolicy, int& gcCount) {
+	GarbageCollectionPolicy policy(
+			STORAGE_GC_IDLE_FREEABLE_PERCENT, STORAGE_GC_IDLE_FREE_WORDS, STORAGE_GC_URGENT_FREE_WORDS);
+	FlashSimulation flash;
+	int flashFullCount = 0;
+	srand(1);
+
+	for (int interval = 0; interval < INTERVAL_COUNT; ++interval) {
+		// Connected most of the time during bursts of activity.
+		bool idle      = (interval / 50) % 4 == 0;
+		int writeCount = idle ? 0 : rand() % (MAX_WRITES_PER_INTERVAL + 1);
+		for (int i = 0; i < writeCount; ++i) {
+			uint32_t record = rand() % RECORD_COUNT;
+			uint32_t words  = 1 + record % MAX_RECORD_WORDS;
+			if (!flash.write(record, words)) {
+				// The write is retried after garbage collection.
+				flashFullCount++;
+				flash.collectGarbage();
+				bool success = flash.write(record, words);
+				assert(success);
+			}
+		}
+		if (usePolicy && policy.shouldCollect(flash.getUsage(), idle)) {
+			flash.collectGarbage();
+		}
+	}
+	gcCount = flash.getGcCount();
+	return flashFullCount;
+}
+
+int main() {
+	testPolicy();
+
+	int gcCountWithoutPolicy = 0;
+	int gcCountWithPolicy    = 0;
+	int fullWithoutPolicy    = simulate(false, gcCountWithoutPolicy);
+	int fullWithPolicy       = simulate(true, gcCountWithPolicy);
+
+	cout << "Writes that found the flash full without policy: " << fullWithoutPolicy
+		 << ", with policy: " << fullWithPolicy << endl;
+	cout << "Garbage collections without policy: " << gcCountWithoutPolicy
+		 << ", with policy: " << gcCountWithPolicy << endl;
+	assert(fullWithoutPolicy > 0);
+	assert(fullWithPolicy == 0);
+	// Garbage is not collected much more often, which would wear out the flash.
+	assert(gcCountWithPolicy < 2 * gcCountWithoutPolicy);
+	return 0;
+}
@@ -0,0 +1,222 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <boards/cs_HostBoardFullyFeatured.h>
+#include <drivers/cs_FlashEmulator.h>
+#include <storage/cs_State.h>
+#include <storage/cs_StateJournal.h>
+#include <testaccess/cs_State.h>
+
+/**
+ * Writes a value to storage directly, as if it was stored in flash before boot.
+ */
+void writeToStorage(Storage& storage, CS_TYPE type, cs_state_id_t id, void* value, size16_t size) {
+	size16_t allocatedSize = size;
+	cs_state_data_t data(type, id, storage.allocate(allocatedSize), size);
+	memcpy(data.value, value, size);
+	storage.write(data);
+}
+
+void writeJournalToStorage(
+		Storage& storage, cs_state_id_t id, uint32_t sequenceNumber, cs_state_data_t entries[], int count) {
+	TYPIFY(STATE_JOURNAL) record;
+	record.sequenceNumber = sequenceNumber;
+	record.size           = 0;
+	for (int i = 0; i < count; ++i) {
+		StateJournal::appendEntry(record, entries[i]);
+	}
+	writeToStorage(storage, CS_TYPE::STATE_JOURNAL, id, &record, sizeof(record));
+}
+
+void tick(State& state, uint32_t ms) {
+	static uint32_t tickCount = 0;
+	for (uint32_t i = 0; i < ms / TICK_INTERVAL_MS; ++i) {
+		tickCount++;
+		event_t tickEvent(CS_TYPE::EVT_TICK, &tickCount, sizeof(tickCount));
+		state.handleEvent(tickEvent);
+	}
+}
+
+uint8_t getSwitchState(State& state) {
+	TYPIFY(STATE_SWITCH_STATE) switchState;
+	cs_state_data_t data(CS_TYPE::STATE_SWITCH_STATE, reinterpret_cast<uint8_t*>(&switchState), sizeof(switchState));
+	state.get(data, PersistenceMode::RAM);
+	return switchState.asInt;
+}
+
+cs_ret_code_t setSwitchState(State& state, uint8_t value) {
+	TYPIFY(STATE_SWITCH_STATE) switchState;
+	switchState.asInt = value;
+	cs_state_data_t data(CS_TYPE::STATE_SWITCH_STATE, reinterpret_cast<uint8_t*>(&switchState), sizeof(switchState));
+	return state.set(data);
+}
+
+/**
+ * The mock storage doesn't copy the value, so get a pointer to it.
+ */
+uint8_t readSwitchStateFromStorage(Storage& storage) {
+	cs_state_data_t data(CS_TYPE::STATE_SWITCH_STATE, 0, nullptr, sizeof(TYPIFY(STATE_SWITCH_STATE)));
+	if (storage.read(data) != ERR_SUCCESS) {
+		return 0;
+	}
+	return reinterpret_cast<TYPIFY(STATE_SWITCH_STATE)*>(data.value)->asInt;
+}
+
+/**
+ * Count the journal records, without the compaction marker.
+ */
+int countJournalRecords(Storage& storage) {
+	int count = 0;
+	cs_state_id_t id;
+	cs_ret_code_t retCode = storage.findFirst(CS_TYPE::STATE_JOURNAL, id);
+	while (retCode == ERR_SUCCESS) {
+		if (id != StateJournal::COMPACTION_MARKER_ID) {
+			count++;
+		}
+		retCode = storage.findNext(CS_TYPE::STATE_JOURNAL, id);
+	}
+	return count;
+}
+
+int main() {
+	Storage& storage = Storage::getInstance();
+	State& state     = State::getInstance();
+
+	boards_config_t board;
+	init(&board);
+	asHostFullyFeatured(&board);
+
+	storage.init();
+
+	// The journal records are replayed in order of sequence number, not of id: the older record removes the value.
+	cs_state_data_t olderEntries[] = {cs_state_data_t(CS_TYPE::STATE_SWITCH_STATE, 0, nullptr, 0)};
+	writeJournalToStorage(storage, 1, 6, olderEntries, 1);
+
+	TYPIFY(STATE_SWITCH_STATE) newerSwitchState;
+	newerSwitchState.asInt         = 60;
+	cs_state_data_t newerEntries[] = {cs_state_data_t(
+			CS_TYPE::STATE_SWITCH_STATE, 0, reinterpret_cast<uint8_t*>(&newerSwitchState), sizeof(newerSwitchState))};
+	writeJournalToStorage(storage, 0, 7, newerEntries, 1);
+
+	// Preloads the stored values, and replays the journal.
+	state.init(&board);
+
+	if (getSwitchState(state) != 60) {
+		LOGw("switch state was not replayed: %u", getSwitchState(state));
+		return 1;
+	}
+	// The journal is compacted into normal records once writes are started.
+	state.startWritesToFlash();
+	tick(state, TICK_INTERVAL_MS);
+	if (countJournalRecords(storage) != 0) {
+		LOGw("journal was not compacted");
+		return 1;
+	}
+	if (readSwitchStateFromStorage(storage) != 60) {
+		LOGw("switch state was not compacted");
+		return 1;
+	}
+	// Changes within a flush interval end up in a single record.
+	FlashEmulator& flash = FlashEmulator::getInstance();
+	flash.resetStats();
+	for (uint8_t value = 1; value < STATE_JOURNAL_FLUSH_INTERVAL_MS / 1000; ++value) {
+		if (setSwitchState(state, value) != ERR_SUCCESS) {
+			LOGw("failed to set switch state");
+			return 1;
+		}
+		tick(state, 1000);
+	}
+	if (flash.getStats().recordWrites != 0) {
+		LOGw("switch state was written before the flush interval");
+		return 1;
+	}
+	tick(state, STATE_JOURNAL_FLUSH_INTERVAL_MS);
+	if (flash.getStats().recordWrites != 1 || countJournalRecords(storage) != 1) {
+		LOGw("expected a single journal record, got %u writes", flash.getStats().recordWrites);
+		return 1;
+	}
+
+	// A delayed switch state, as the switch sets it, is written as soon as it was without journal.
+	TYPIFY(STATE_SWITCH_STATE) delayedSwitchState;
+	delayedSwitchState.asInt = 99;
+	cs_state_data_t delayedData(
+			CS_TYPE::STATE_SWITCH_STATE,
+			reinterpret_cast<uint8_t*>(&delayedSwitchState),
+			sizeof(delayedSwitchState));
+	state.setDelayed(delayedData, SWITCH_DELAYED_STORE_MS / 1000);
+	flash.resetStats();
+	tick(state, SWITCH_DELAYED_STORE_MS + TICK_INTERVAL_MS);
+	if (flash.getStats().recordWrites != 1 || countJournalRecords(storage) != 2) {
+		LOGw("delayed switch state was not journaled in time, got %u writes", flash.getStats().recordWrites);
+		return 1;
+	}
+
+	// Once the journal is full, it is compacted again.
+	for (int i = 1; i <= STATE_JOURNAL_RECORD_COUNT - 1; ++i) {
+		setSwitchState(state, 10 + i);
+		tick(state, STATE_JOURNAL_FLUSH_INTERVAL_MS);
+	}
+	if (countJournalRecords(storage) != 0) {
+		LOGw("journal was not compacted when full");
+		return 1;
+	}
+	if (readSwitchStateFromStorage(storage) != 10 + STATE_JOURNAL_RECORD_COUNT - 1) {
+		LOGw("switch state was not compacted");
+		return 1;
+	}
+
+	// Power is cut after compaction wrote the values, but before it removed the journal records. The remaining
+	// records are older than the compacted values, and should not be replayed over them.
+	for (int i = 1; i <= STATE_JOURNAL_RECORD_COUNT; ++i) {
+		setSwitchState(state, 30 + i);
+		tick(state, STATE_JOURNAL_FLUSH_INTERVAL_MS);
+	}
+	if (countJournalRecords(storage) != STATE_JOURNAL_RECORD_COUNT) {
+		LOGw("expected a full journal");
+		return 1;
+	}
+	TYPIFY(STATE_JOURNAL) journal[STATE_JOURNAL_RECORD_COUNT];
+	for (cs_state_id_t id = 0; id < STATE_JOURNAL_RECORD_COUNT; ++id) {
+		cs_state_data_t data(CS_TYPE::STATE_JOURNAL, id, nullptr, sizeof(journal[id]));
+		if (storage.read(data) != ERR_SUCCESS) {
+			LOGw("journal record id=%u not found", id);
+			return 1;
+		}
+		memcpy(&journal[id], data.value, sizeof(journal[id]));
+	}
+	// Not flushed yet when the journal is compacted, so newer than any journal record.
+	setSwitchState(state, 50);
+	tick(state, STATE_JOURNAL_FLUSH_INTERVAL_MS);
+	if (countJournalRecords(storage) != 0 || readSwitchStateFromStorage(storage) != 50) {
+		LOGw("journal was not compacted when full");
+		return 1;
+	}
+	for (cs_state_id_t id = 0; id < STATE_JOURNAL_RECORD_COUNT; ++id) {
+		writeToStorage(storage, CS_TYPE::STATE_JOURNAL, id, &journal[id], sizeof(journal[id]));
+	}
+	TestAccess<State>::reboot(state);
+	if (getSwitchState(state) != 50) {
+		LOGw("compacted journal records were replayed: switch state=%u", getSwitchState(state));
+		return 1;
+	}
+	state.startWritesToFlash();
+	tick(state, TICK_INTERVAL_MS);
+	if (countJournalRecords(storage) != 0 || readSwitchStateFromStorage(storage) != 50) {
+		LOGw("compacted journal records were not removed");
+		return 1;
+	}
+
+	// Records written after compaction are replayed.
+	setSwitchState(state, 70);
+	tick(state, STATE_JOURNAL_FLUSH_INTERVAL_MS);
+	TestAccess<State>::reboot(state);
+	if (getSwitchState(state) != 70) {
+		LOGw("journal record after compaction was not replayed: switch state=%u", getSwitchState(state));
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,84 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <boards/cs_HostBoardFullyFeatured.h>
+#include <events/cs_EventDispatcher.h>
+#include <storage/cs_State.h>
+
+#include <algorithm>
+
+/**
+ * Writes a value to storage directly, as if it was stored in flash before boot.
+ */
+void writeToStorage(Storage& storage, CS_TYPE type, cs_state_id_t id, TYPIFY(CONFIG_IBEACON_TXPOWER) value) {
+	size16_t size = sizeof(value);
+	cs_state_data_t data(type, id, storage.allocate(size), sizeof(value));
+	memcpy(data.value, &value, sizeof(value));
+	storage.write(data);
+}
+
+int main() {
+	Storage& storage = Storage::getInstance();
+	State& state     = State::getInstance();
+
+	boards_config_t board;
+	init(&board);
+	asHostFullyFeatured(&board);
+
+	storage.init();
+
+	std::vector<cs_state_id_t> storedIds = {0, 2, 5};
+	for (auto id : storedIds) {
+		writeToStorage(storage, CS_TYPE::CONFIG_IBEACON_TXPOWER, id, -4 * id);
+	}
+
+	// Preloads the stored values.
+	state.init(&board);
+
+	// The ids are cached without iterating over storage again, which would still give the same ids.
+	std::vector<cs_state_id_t>* ids = nullptr;
+	if (state.getIds(CS_TYPE::CONFIG_IBEACON_TXPOWER, ids) != ERR_SUCCESS || ids == nullptr) {
+		LOGw("failed to get ids");
+		return 1;
+	}
+	if (ids->size() != storedIds.size()) {
+		LOGw("got %u ids, expected %u", ids->size(), storedIds.size());
+		return 1;
+	}
+	for (auto id : storedIds) {
+		if (std::find(ids->begin(), ids->end(), id) == ids->end()) {
+			LOGw("id %u is missing", id);
+			return 1;
+		}
+	}
+
+	for (auto id : storedIds) {
+		TYPIFY(CONFIG_IBEACON_TXPOWER) value = 0;
+		cs_state_data_t data(CS_TYPE::CONFIG_IBEACON_TXPOWER, id, reinterpret_cast<uint8_t*>(&value), sizeof(value));
+		if (state.get(data, PersistenceMode::RAM) != ERR_SUCCESS) {
+			LOGw("id %u was not preloaded", id);
+			return 1;
+		}
+		if (value != -4 * id) {
+			LOGw("id %u has value %i", id, value);
+			return 1;
+		}
+	}
+
+	// Values that are not stored, are still loaded at their first get.
+	TYPIFY(CONFIG_IBEACON_TXPOWER) value = 0;
+	cs_state_data_t data(CS_TYPE::CONFIG_IBEACON_TXPOWER, 1, reinterpret_cast<uint8_t*>(&value), sizeof(value));
+	if (state.get(data, PersistenceMode::RAM) != ERR_NOT_FOUND) {
+		LOGw("id 1 should not be in RAM");
+		return 1;
+	}
+	if (state.get(data) != ERR_SUCCESS) {
+		LOGw("failed to get default value");
+		return 1;
+	}
+	return 0;
+}
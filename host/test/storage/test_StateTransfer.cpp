@@ -0,0 +1,318 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <boards/cs_HostBoardFullyFeatured.h>
+#include <drivers/cs_FlashEmulator.h>
+#include <encryption/cs_KeysAndAccess.h>
+#include <storage/cs_State.h>
+#include <storage/cs_StateTransfer.h>
+#include <util/cs_Crc32.h>
+
+#include <cstring>
+#include <vector>
+
+/**
+ * Export the whole stream, in chunks of the given size.
+ */
+cs_ret_code_t exportStream(
+		uint16_t chunkSize,
+		EncryptionAccessLevel accessLevel,
+		std::vector<uint8_t>& stream,
+		state_stream_header_t& header,
+		uint16_t typeStart = 0,
+		uint16_t typeEnd   = 0xFFFF) {
+	StateTransfer& stateTransfer = StateTransfer::getInstance();
+	state_export_packet_t request;
+	request.typeStart = typeStart;
+	request.typeEnd   = typeEnd;
+	stream.clear();
+	std::vector<uint8_t> buf(chunkSize);
+	do {
+		request.offset = stream.size();
+		cs_data_t chunk(buf.data(), buf.size());
+		cs_ret_code_t retCode = stateTransfer.getExportChunk(request, accessLevel, header, chunk);
+		if (retCode != ERR_SUCCESS) {
+			return retCode;
+		}
+		if (header.offset != request.offset || (chunk.len == 0 && stream.size() != header.totalSize)) {
+			return ERR_UNSPECIFIED;
+		}
+		stream.insert(stream.end(), buf.begin(), buf.begin() + chunk.len);
+	} while (stream.size() < header.totalSize);
+	return ERR_SUCCESS;
+}
+
+/**
+ * Import the whole stream, in chunks of the given size.
+ */
+cs_ret_code_t importStream(uint16_t chunkSize, const std::vector<uint8_t>& stream, uint32_t crc) {
+	StateTransfer& stateTransfer = StateTransfer::getInstance();
+	state_stream_header_t header;
+	header.totalSize      = stream.size();
+	header.crc            = crc;
+	header.offset         = 0;
+	uint32_t receivedSize = 0;
+	cs_ret_code_t retCode;
+	do {
+		uint16_t size = std::min<uint32_t>(chunkSize, stream.size() - header.offset);
+		cs_const_data_t chunk(stream.data() + header.offset, size);
+		retCode       = stateTransfer.receiveImportChunk(header, chunk, ADMIN, receivedSize);
+		header.offset = receivedSize;
+	} while (retCode == ERR_SUCCESS && receivedSize < stream.size());
+	return retCode;
+}
+
+uint32_t getCrc(const std::vector<uint8_t>& stream) {
+	uint32_t crc = 0;
+	return crc32(stream.data(), stream.size(), &crc);
+}
+
+/**
+ * Get the records of a stream, as type, id, and value.
+ */
+bool parseStream(const std::vector<uint8_t>& stream, std::vector<std::pair<state_record_header_t, uint32_t>>& records) {
+	uint32_t offset = 0;
+	while (offset < stream.size()) {
+		state_record_header_t header;
+		if (stream.size() - offset < sizeof(header)) {
+			return false;
+		}
+		memcpy(&header, stream.data() + offset, sizeof(header));
+		offset += sizeof(header);
+		if (header.size > stream.size() - offset) {
+			return false;
+		}
+		records.push_back({header, offset});
+		offset += header.size;
+	}
+	return true;
+}
+
+void appendRecord(std::vector<uint8_t>& stream, CS_TYPE type, const void* value, uint8_t size) {
+	state_record_header_t header;
+	header.stateType = to_underlying_type(type);
+	header.stateId   = 0;
+	header.size      = size;
+	stream.insert(stream.end(), (const uint8_t*)&header, (const uint8_t*)&header + sizeof(header));
+	stream.insert(stream.end(), (const uint8_t*)value, (const uint8_t*)value + size);
+}
+
+int main() {
+	Storage& storage = Storage::getInstance();
+	State& state     = State::getInstance();
+
+	boards_config_t board;
+	init(&board);
+	asHostFullyFeatured(&board);
+
+	storage.init();
+	state.init(&board);
+	state.startWritesToFlash();
+
+	TYPIFY(CONFIG_TX_POWER) txPower     = -8;
+	TYPIFY(CONFIG_BOOT_DELAY) bootDelay = 1234;
+	const char name[]                   = "backup";
+	state.set(CS_TYPE::CONFIG_TX_POWER, &txPower, sizeof(txPower));
+	state.set(CS_TYPE::CONFIG_BOOT_DELAY, &bootDelay, sizeof(bootDelay));
+	state.set(CS_TYPE::CONFIG_NAME, (void*)name, strlen(name));
+
+	// The export is the same, no matter the chunk size.
+	std::vector<uint8_t> stream;
+	state_stream_header_t header;
+	if (exportStream(1000, ADMIN, stream, header) != ERR_SUCCESS) {
+		LOGw("export failed");
+		return 1;
+	}
+	std::vector<uint8_t> chunkedStream;
+	state_stream_header_t chunkedHeader;
+	if (exportStream(7, ADMIN, chunkedStream, chunkedHeader) != ERR_SUCCESS || chunkedStream != stream
+		|| chunkedHeader.crc != header.crc || header.crc != getCrc(stream)) {
+		LOGw("chunked export differs");
+		return 1;
+	}
+
+	// Only user settable persisted types, in order of type.
+	std::vector<std::pair<state_record_header_t, uint32_t>> records;
+	if (!parseStream(stream, records) || records.empty()) {
+		LOGw("invalid export stream");
+		return 1;
+	}
+	bool foundTxPower = false;
+	bool foundName    = false;
+	for (size_t i = 0; i < records.size(); ++i) {
+		state_record_header_t& record = records[i].first;
+		const uint8_t* value          = stream.data() + records[i].second;
+		if (i > 0 && record.stateType <= records[i - 1].first.stateType) {
+			LOGw("records not ordered by type");
+			return 1;
+		}
+		CS_TYPE type = toCsType(record.stateType);
+		if (getUserAccessLevelSet(type) == NO_ONE || DefaultLocation(type) != PersistenceMode::FLASH) {
+			LOGw("type %u should not be exported", record.stateType);
+			return 1;
+		}
+		if (type == CS_TYPE::CONFIG_TX_POWER) {
+			foundTxPower = record.size == sizeof(txPower) && memcmp(value, &txPower, sizeof(txPower)) == 0;
+		}
+		if (type == CS_TYPE::CONFIG_NAME) {
+			foundName = record.size == strlen(name) && memcmp(value, name, strlen(name)) == 0;
+		}
+	}
+	if (!foundTxPower || !foundName) {
+		LOGw("exported values are wrong");
+		return 1;
+	}
+
+	// Type range, and resuming at an offset.
+	std::vector<uint8_t> rangeStream;
+	uint16_t txPowerType = to_underlying_type(CS_TYPE::CONFIG_TX_POWER);
+	if (exportStream(100, ADMIN, rangeStream, header, txPowerType, txPowerType) != ERR_SUCCESS
+		|| rangeStream.size() != sizeof(state_record_header_t) + sizeof(txPower)) {
+		LOGw("type range not applied");
+		return 1;
+	}
+	state_export_packet_t request = {};
+	request.offset                = stream.size() / 2;
+	request.typeEnd               = 0xFFFF;
+	uint8_t buf[16];
+	cs_data_t chunk(buf, sizeof(buf));
+	if (StateTransfer::getInstance().getExportChunk(request, ADMIN, header, chunk) != ERR_SUCCESS
+		|| memcmp(buf, stream.data() + request.offset, chunk.len) != 0) {
+		LOGw("resumed chunk differs");
+		return 1;
+	}
+	request.offset = stream.size() + 1;
+	chunk          = cs_data_t(buf, sizeof(buf));
+	if (StateTransfer::getInstance().getExportChunk(request, ADMIN, header, chunk) != ERR_WRONG_PARAMETER) {
+		LOGw("offset beyond the end not rejected");
+		return 1;
+	}
+
+	// Change the values, then import the export again.
+	TYPIFY(CONFIG_TX_POWER) otherTxPower     = 4;
+	TYPIFY(CONFIG_BOOT_DELAY) otherBootDelay = 10;
+	state.set(CS_TYPE::CONFIG_TX_POWER, &otherTxPower, sizeof(otherTxPower));
+	state.set(CS_TYPE::CONFIG_BOOT_DELAY, &otherBootDelay, sizeof(otherBootDelay));
+	state.set(CS_TYPE::CONFIG_NAME, (void*)"other", 5);
+
+	// A corrupt stream sets nothing.
+	if (importStream(20, stream, getCrc(stream) + 1) != ERR_MISMATCH) {
+		LOGw("corrupt import not rejected");
+		return 1;
+	}
+	std::vector<uint8_t> invalidStream;
+	appendRecord(invalidStream, CS_TYPE::CONFIG_TX_POWER, &txPower, sizeof(txPower));
+	uint8_t key[ENCRYPTION_KEY_LENGTH] = {};
+	appendRecord(invalidStream, CS_TYPE::CONFIG_KEY_ADMIN, key, sizeof(key));
+	if (importStream(20, invalidStream, getCrc(invalidStream)) != ERR_NO_ACCESS) {
+		LOGw("import of a key not rejected");
+		return 1;
+	}
+	invalidStream.clear();
+	appendRecord(invalidStream, CS_TYPE::CONFIG_TX_POWER, &txPower, sizeof(txPower));
+	appendRecord(invalidStream, CS_TYPE::CONFIG_BOOT_DELAY, &bootDelay, 1);
+	if (importStream(20, invalidStream, getCrc(invalidStream)) != ERR_WRONG_PAYLOAD_LENGTH) {
+		LOGw("import of a wrong size not rejected");
+		return 1;
+	}
+	TYPIFY(CONFIG_TX_POWER) readTxPower;
+	state.get(CS_TYPE::CONFIG_TX_POWER, &readTxPower, sizeof(readTxPower));
+	if (readTxPower != otherTxPower) {
+		LOGw("invalid import was partly applied");
+		return 1;
+	}
+
+	// Chunks have to be sent in order, and the import can be resumed at the received size.
+	StateTransfer& stateTransfer = StateTransfer::getInstance();
+	header.totalSize             = stream.size();
+	header.crc                   = getCrc(stream);
+	header.offset                = 0;
+	uint32_t receivedSize        = 0;
+	if (stateTransfer.receiveImportChunk(header, cs_const_data_t(stream.data(), 10), ADMIN, receivedSize)
+				!= ERR_SUCCESS
+		|| receivedSize != 10) {
+		LOGw("first chunk not received");
+		return 1;
+	}
+	header.offset = 20;
+	if (stateTransfer.receiveImportChunk(header, cs_const_data_t(stream.data() + 20, 10), ADMIN, receivedSize)
+				!= ERR_WRONG_STATE
+		|| receivedSize != 10) {
+		LOGw("out of order chunk not rejected");
+		return 1;
+	}
+	header.offset = receivedSize;
+	if (stateTransfer.receiveImportChunk(
+				header, cs_const_data_t(stream.data() + 10, stream.size() - 10), ADMIN, receivedSize)
+				!= ERR_SUCCESS
+		|| receivedSize != stream.size()) {
+		LOGw("import failed");
+		return 1;
+	}
+	TYPIFY(CONFIG_BOOT_DELAY) readBootDelay;
+	char readName[MAX_STRING_STORAGE_SIZE + 1];
+	cs_state_data_t nameData(CS_TYPE::CONFIG_NAME, reinterpret_cast<uint8_t*>(readName), sizeof(readName));
+	state.get(CS_TYPE::CONFIG_TX_POWER, &readTxPower, sizeof(readTxPower));
+	state.get(CS_TYPE::CONFIG_BOOT_DELAY, &readBootDelay, sizeof(readBootDelay));
+	state.get(nameData);
+	if (readTxPower != txPower || readBootDelay != bootDelay || nameData.size != strlen(name)
+		|| memcmp(readName, name, strlen(name)) != 0) {
+		LOGw("import not applied");
+		return 1;
+	}
+
+	std::vector<uint8_t> largeStream(STATE_IMPORT_MAX_SIZE + 1);
+	if (importStream(20, largeStream, getCrc(largeStream)) != ERR_NO_SPACE) {
+		LOGw("too large import not rejected");
+		return 1;
+	}
+
+	// With encryption enabled, a member only gets the types a member can set.
+	TYPIFY(CONFIG_ENCRYPTION_ENABLED) encryptionEnabled = true;
+	state.set(CS_TYPE::CONFIG_ENCRYPTION_ENABLED, &encryptionEnabled, sizeof(encryptionEnabled));
+	KeysAndAccess::getInstance().init();
+	records.clear();
+	uint16_t behaviourSettingsType = to_underlying_type(CS_TYPE::STATE_BEHAVIOUR_SETTINGS);
+	if (exportStream(100, MEMBER, stream, header) != ERR_SUCCESS || !parseStream(stream, records)
+		|| records.size() != 1 || records[0].first.stateType != behaviourSettingsType) {
+		LOGw("member export should only contain the behaviour settings");
+		return 1;
+	}
+
+	// Fill the flash, so that a TX power can still be written, but a long name can't.
+	FlashEmulator& flash = FlashEmulator::getInstance();
+	uint16_t fillerKey   = 0xF000;
+	bool written         = true;
+	while (written) {
+		written = flash.write(fillerKey, 0, 1);
+		if (!written) {
+			flash.garbageCollect();
+			written = flash.write(fillerKey, 0, 1);
+		}
+		fillerKey++;
+	}
+	flash.remove(0xF000, 0);
+
+	// When a record can't be set, the records that were set before it get their previous value again.
+	TYPIFY(CONFIG_TX_POWER) importTxPower = 2;
+	const char longName[]                 = "a name that won't fit";
+	std::vector<uint8_t> failingStream;
+	appendRecord(failingStream, CS_TYPE::CONFIG_TX_POWER, &importTxPower, sizeof(importTxPower));
+	appendRecord(failingStream, CS_TYPE::CONFIG_NAME, longName, strlen(longName));
+	if (importStream(20, failingStream, getCrc(failingStream)) != ERR_NO_SPACE) {
+		LOGw("import should fail on a full flash");
+		return 1;
+	}
+	nameData = cs_state_data_t(CS_TYPE::CONFIG_NAME, reinterpret_cast<uint8_t*>(readName), sizeof(readName));
+	state.get(CS_TYPE::CONFIG_TX_POWER, &readTxPower, sizeof(readTxPower));
+	state.get(nameData);
+	if (readTxPower != txPower || nameData.size != strlen(name) || memcmp(readName, name, strlen(name)) != 0) {
+		LOGw("failed import was not rolled back");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,146 @@
+/**
+ * Adds, replaces and removes records in the storage index, in random order, and checks after each change that:
+ * - The entries are sorted by record key, then by file id.
+ * - Each record can be found, and holds the descriptor of the last added duplicate.
+ * - A removed record is only removed from the index when it is the indexed one.
+ * - Searching from the position of a record key visits all file ids of that key.
+ */
+
+#include <storage/cs_StorageIndex.h>
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <utility>
+
+using namespace std;
+
+/**
+ * Stand in for the FDS record descriptor.
+ */
+struct test_record_desc_t {
+	uint32_t record_id;
+};
+
+typedef StorageIndex<test_record_desc_t> Index;
+
+/**
+ * Reference for the index: record id of each (record key, file id).
+ */
+typedef map<pair<uint16_t, uint16_t>, uint32_t> Reference;
+
+void checkIndex(Index& index, const Reference& reference) {
+	assert(index.size() == reference.size());
+	uint16_t position = 0;
+	for (auto& item : reference) {
+		assert(index[position].recordKey == item.first.first);
+		assert(index[position].fileId == item.first.second);
+		assert(index[position].recordDesc.record_id == item.second);
+
+		auto entry = index.find(item.first.first, item.first.second);
+		assert(entry == &index[position]);
+		assert(index.getPosition(item.first.first, item.first.second) == position);
+		position++;
+	}
+}
+
+/**
+ * Checks that the entries from the position of a record key are the file ids of that key, as findNext() reads them.
+ */
+void checkSearch(Index& index, const Reference& reference, uint16_t recordKey) {
+	uint16_t position = index.getPosition(recordKey, 0);
+	auto item         = reference.lower_bound({recordKey, 0});
+	while (position < index.size() && index[position].recordKey == recordKey) {
+		assert(item != reference.end());
+		assert(item->first.first == recordKey);
+		assert(index[position].fileId == item->first.second);
+		position++;
+		item++;
+	}
+	assert(item == reference.end() || item->first.first != recordKey);
+}
+
+void testEmpty() {
+	Index index;
+	assert(index.size() == 0);
+	assert(index.find(1, 0) == nullptr);
+	assert(index.getPosition(1, 0) == 0);
+	index.remove(1, 0, 1);
+	index.removeFile(0);
+	assert(index.size() == 0);
+	cout << "Empty OK" << endl;
+}
+
+void testDuplicates() {
+	Index index;
+	index.add(5, 0, {1});
+	index.add(5, 0, {2});
+	assert(index.size() == 1);
+	assert(index.find(5, 0)->recordDesc.record_id == 2);
+
+	// Removing the earlier duplicate keeps the indexed record.
+	index.remove(5, 0, 1);
+	assert(index.find(5, 0) != nullptr);
+	index.remove(5, 0, 2);
+	assert(index.find(5, 0) == nullptr);
+	cout << "Duplicates OK" << endl;
+}
+
+void testRandom() {
+	Index index;
+	Reference reference;
+	uint32_t recordId = 1;
+	for (int i = 0; i < 20000; ++i) {
+		uint16_t recordKey = 1 + rand() % 20;
+		uint16_t fileId    = rand() % 8;
+		switch (rand() % 5) {
+			case 0:
+			case 1:
+			case 2: {
+				index.add(recordKey, fileId, {recordId});
+				reference[{recordKey, fileId}] = recordId;
+				recordId++;
+				break;
+			}
+			case 3: {
+				// Remove the indexed record, or an older one.
+				auto item = reference.find({recordKey, fileId});
+				if (item != reference.end() && rand() % 2) {
+					index.remove(recordKey, fileId, item->second);
+					reference.erase(item);
+				}
+				else {
+					index.remove(recordKey, fileId, 0);
+				}
+				break;
+			}
+			case 4: {
+				if (rand() % 20 == 0) {
+					index.removeFile(fileId);
+					for (auto item = reference.begin(); item != reference.end();) {
+						if (item->first.second == fileId) {
+							item = reference.erase(item);
+						}
+						else {
+							item++;
+						}
+					}
+				}
+				break;
+			}
+		}
+		checkIndex(index, reference);
+		checkSearch(index, reference, recordKey);
+	}
+	cout << "Random OK, records=" << index.size() << " heap=" << index.getHeapSize() << " B" << endl;
+	assert(index.getHeapSize() >= index.size() * sizeof(Index::entry_t));
+}
+
+int main() {
+	srand(1);
+	testEmpty();
+	testDuplicates();
+	testRandom();
+	return 0;
+}
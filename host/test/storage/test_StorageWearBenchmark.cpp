@@ -0,0 +1,218 @@
+/**
+ * Replays a month of typical state traffic, with the flash emulator underneath storage, to quantify write amplification
+ * and the projected flash lifetime, for the switch state delayed as the switch does, and for different throttle periods
+ * of the switch state.
+ *
+ * Traffic:
+ * - The switch state changes in sessions: a few changes within seconds, for example when dimming.
+ * - The sun time is received from the mesh every 10 minutes, and throttled as SystemTime does.
+ * - A few behaviour rules are edited every week.
+ *
+ * The energy counter is not part of the traffic, since it's not stored in flash.
+ *
+ * The switch state is journaled, so changes within a journal flush interval end up in a single record.
+ */
+
+#include <boards/cs_HostBoardFullyFeatured.h>
+#include <drivers/cs_FlashEmulator.h>
+#include <storage/cs_State.h>
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+constexpr uint32_t SECONDS_PER_DAY           = 24 * 3600;
+constexpr uint32_t SIMULATED_DAYS            = 30;
+constexpr uint32_t SWITCH_SESSIONS_PER_DAY   = 20;
+constexpr uint32_t MAX_CHANGES_PER_SESSION   = 6;
+constexpr uint32_t SUN_TIME_INTERVAL_SECONDS = 10 * 60;
+constexpr uint32_t BEHAVIOUR_EDITS_PER_WEEK  = 3;
+constexpr cs_state_id_t BEHAVIOUR_COUNT      = 10;
+
+struct benchmark_result_t {
+	flash_emulator_stats_t stats;
+	uint32_t maxPageErases;
+	double writeAmplification;
+	uint32_t flashFullCount;
+	uint32_t switchChangeCount;
+	uint32_t journalWriteCount;
+};
+
+class TrafficReplay {
+public:
+	TrafficReplay(State& state) : _state(state) {}
+
+	void tickSecond() {
+		for (uint32_t i = 0; i < 1000 / TICK_INTERVAL_MS; ++i) {
+			_tickCount++;
+			event_t tickEvent(CS_TYPE::EVT_TICK, &_tickCount, sizeof(_tickCount));
+			_state.handleEvent(tickEvent);
+		}
+		_upTime++;
+		event_t secondEvent(CS_TYPE::EVT_TICK_SECOND, &_upTime, sizeof(_upTime));
+		_state.handleEvent(secondEvent);
+	}
+
+	/**
+	 * @param[in] throttlePeriodSeconds   Throttle period, or 0 to delay the write like the switch does.
+	 */
+	void setSwitchState(uint32_t throttlePeriodSeconds) {
+		TYPIFY(STATE_SWITCH_STATE) switchState;
+		switchState.asInt = rand() % 101;
+		cs_state_data_t data(
+				CS_TYPE::STATE_SWITCH_STATE, 0, reinterpret_cast<uint8_t*>(&switchState), sizeof(switchState));
+		cs_ret_code_t retCode = (throttlePeriodSeconds == 0)
+										? _state.setDelayed(data, SWITCH_DELAYED_STORE_MS / 1000)
+										: _state.setThrottled(data, throttlePeriodSeconds);
+		assert(retCode == ERR_SUCCESS || retCode == ERR_SUCCESS_NO_CHANGE);
+		_switchChangeCount++;
+	}
+
+	void setSunTime() {
+		TYPIFY(STATE_SUN_TIME) sunTime;
+		sunTime.sunrise = 7 * 3600 + rand() % 60;
+		sunTime.sunset  = 19 * 3600 + rand() % 60;
+		cs_state_data_t data(CS_TYPE::STATE_SUN_TIME, 0, reinterpret_cast<uint8_t*>(&sunTime), sizeof(sunTime));
+		cs_ret_code_t retCode = _state.setThrottled(data, SUN_TIME_THROTTLE_PERIOD_SECONDS);
+		assert(retCode == ERR_SUCCESS || retCode == ERR_SUCCESS_NO_CHANGE);
+	}
+
+	void editBehaviour() {
+		size16_t size = TypeSize(CS_TYPE::STATE_BEHAVIOUR_RULE);
+		vector<uint8_t> rule(size);
+		for (auto& byte : rule) {
+			byte = rand();
+		}
+		cs_state_data_t data(CS_TYPE::STATE_BEHAVIOUR_RULE, rand() % BEHAVIOUR_COUNT, rule.data(), size);
+		cs_ret_code_t retCode = _state.set(data);
+		assert(retCode == ERR_SUCCESS || retCode == ERR_SUCCESS_NO_CHANGE);
+	}
+
+	benchmark_result_t run(uint32_t throttlePeriodSeconds) {
+		FlashEmulator& flash              = FlashEmulator::getInstance();
+		const storage_gc_stats_t& gcStats = Storage::getInstance().getGarbageCollectionStats();
+		uint32_t flashFullCountBefore     = gcStats.flashFullCount;
+		flash.resetStats();
+		_switchChangeCount = 0;
+		srand(1);
+
+		vector<uint32_t> pendingSwitchChanges;
+		for (uint32_t second = 0; second < SIMULATED_DAYS * SECONDS_PER_DAY; ++second) {
+			if (rand() % SECONDS_PER_DAY < SWITCH_SESSIONS_PER_DAY) {
+				uint32_t changeSecond = second;
+				for (uint32_t i = rand() % MAX_CHANGES_PER_SESSION; i < MAX_CHANGES_PER_SESSION; ++i) {
+					pendingSwitchChanges.push_back(changeSecond);
+					changeSecond += 1 + rand() % 4;
+				}
+			}
+			for (auto it = pendingSwitchChanges.begin(); it != pendingSwitchChanges.end();) {
+				if (*it == second) {
+					setSwitchState(throttlePeriodSeconds);
+					it = pendingSwitchChanges.erase(it);
+				}
+				else {
+					++it;
+				}
+			}
+			if (second % SUN_TIME_INTERVAL_SECONDS == 0) {
+				setSunTime();
+			}
+			if (rand() % (7 * SECONDS_PER_DAY) < BEHAVIOUR_EDITS_PER_WEEK) {
+				editBehaviour();
+			}
+			tickSecond();
+		}
+
+		benchmark_result_t result;
+		result.stats              = flash.getStats();
+		result.maxPageErases      = flash.getMaxPageEraseCount();
+		result.writeAmplification = flash.getWriteAmplification();
+		result.flashFullCount     = gcStats.flashFullCount - flashFullCountBefore;
+		result.switchChangeCount  = _switchChangeCount;
+		result.journalWriteCount  = flash.getRecordWriteCount(to_underlying_type(CS_TYPE::STATE_JOURNAL));
+
+		// Let throttled writes finish, so they don't end up in the next run.
+		for (uint32_t second = 0; second < SUN_TIME_THROTTLE_PERIOD_SECONDS; ++second) {
+			tickSecond();
+		}
+		return result;
+	}
+
+private:
+	State& _state;
+	uint32_t _tickCount         = 0;
+	uint32_t _upTime            = 0;
+	uint32_t _switchChangeCount = 0;
+};
+
+void printResult(const char* name, const benchmark_result_t& result) {
+	cout << name << ":"
+		 << " switch state changes=" << result.switchChangeCount
+		 << " record writes=" << result.stats.recordWrites << " (journal=" << result.journalWriteCount << ")"
+		 << " words written=" << result.stats.wordsWritten
+		 << " (moved by GC=" << result.stats.wordsMovedByGc << ")"
+		 << " write amplification=" << result.writeAmplification
+		 << " GC=" << result.stats.gcCount
+		 << " page erases=" << result.stats.pageErases
+		 << " max erases of a page=" << result.maxPageErases;
+	if (result.maxPageErases > 0) {
+		cout << " projected lifetime="
+			 << double(FlashEmulator::PAGE_ERASE_ENDURANCE) / result.maxPageErases * SIMULATED_DAYS / 365 << " years";
+	}
+	cout << endl;
+
+	// Garbage is collected before a write finds the flash full.
+	assert(result.flashFullCount == 0);
+	assert(result.writeAmplification >= 1);
+	assert(result.stats.recordWrites < result.switchChangeCount);
+
+	// The journal is written at most once per flush interval, and only when the switch state changed.
+	assert(result.journalWriteCount > 0);
+	assert(result.journalWriteCount <= SIMULATED_DAYS * SECONDS_PER_DAY / (STATE_JOURNAL_FLUSH_INTERVAL_MS / 1000));
+	assert(result.journalWriteCount <= result.switchChangeCount);
+}
+
+int main() {
+	boards_config_t board;
+	init(&board);
+	asHostFullyFeatured(&board);
+
+	Storage::getInstance().init();
+	State& state = State::getInstance();
+	state.init(&board);
+	state.startWritesToFlash();
+
+	TrafficReplay replay(state);
+
+	// The switch state as the switch stores it: delayed, which is batched by the journal only.
+	benchmark_result_t delayedResult = replay.run(0);
+	printResult("Switch state delayed", delayedResult);
+
+	// Most switch state changes don't lead to a write.
+	assert(2 * delayedResult.stats.recordWrites < delayedResult.switchChangeCount);
+
+	// Throttle periods shorter than the journal flush interval don't coalesce any further.
+	vector<uint32_t> throttlePeriods = {STATE_JOURNAL_FLUSH_INTERVAL_MS / 1000, 60, 600};
+	vector<benchmark_result_t> results;
+	for (auto period : throttlePeriods) {
+		benchmark_result_t result = replay.run(period);
+		results.push_back(result);
+		string name = "Switch state throttled at " + to_string(period) + " s";
+		printResult(name.c_str(), result);
+	}
+
+	for (size_t i = 1; i < results.size(); ++i) {
+		assert(results[i].stats.recordWrites < results[i - 1].stats.recordWrites);
+	}
+	assert(results.back().stats.pageErases < results.front().stats.pageErases);
+
+	// The journal batches the delayed switch state better than any of the throttle periods.
+	for (auto& result : results) {
+		assert(delayedResult.stats.recordWrites < result.stats.recordWrites);
+	}
+	return 0;
+}
@@ -0,0 +1,409 @@
+/**
+ * Downloads asset filters over the mesh from a simulated neighbour, and checks:
+ * - The sequence of chunk requests, and that filters with a matching CRC are skipped.
+ * - That the chunks served to other stones are the same as those of the neighbour.
+ * - That a lost chunk is requested again after a timeout.
+ * - That the download is given up after a number of retries, and that a stone that doesn't serve chunks is not
+ *   requested again, but informed of our version instead.
+ * - That a download with a master CRC mismatch is not committed.
+ */
+
+#include <boards/cs_HostBoardFullyFeatured.h>
+#include <common/cs_Component.h>
+#include <drivers/cs_RTC.h>
+#include <events/cs_EventDispatcher.h>
+#include <events/cs_EventListener.h>
+#include <localisation/cs_AssetFilterStore.h>
+#include <localisation/cs_AssetFilterSyncer.h>
+#include <mesh/cs_MeshMsgEvent.h>
+#include <storage/cs_State.h>
+#include <testaccess/cs_CoroutineScheduler.h>
+#include <util/cs_Crc32.h>
+
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <vector>
+
+using namespace std;
+
+typedef map<uint8_t, vector<uint8_t>> filter_set_t;
+
+constexpr uint32_t REQUEST_TIMEOUT_MS = AssetFilterSyncer::MESH_CHUNK_REQUEST_TIMEOUT_SECONDS * 1000;
+
+class MockCrownstone : public Component {
+public:
+	AssetFilterStore _store;
+	AssetFilterSyncer _syncer;
+
+	virtual std::vector<Component*> getChildren() override { return {&_store, &_syncer}; }
+};
+
+/**
+ * Keeps up the mesh messages that are sent.
+ */
+class MeshRecorder : public EventListener {
+public:
+	struct sent_msg_t {
+		cs_mesh_model_msg_type_t type;
+		stone_id_t targetId;
+		vector<uint8_t> payload;
+	};
+
+	vector<sent_msg_t> _sent;
+
+	void handleEvent(event_t& event) override {
+		if (event.type != CS_TYPE::CMD_SEND_MESH_MSG) {
+			return;
+		}
+		auto msg          = CS_TYPE_CAST(CMD_SEND_MESH_MSG, event.data);
+		stone_id_t target = (msg->idCount != 0) ? msg->targetIds[0] : 0;
+		_sent.push_back({msg->type, target, {msg->payload, msg->payload + msg->size}});
+		event.result.returnCode = ERR_SUCCESS;
+	}
+
+	/**
+	 * Returns the number of sent messages of given type, starting at the given index.
+	 */
+	int count(cs_mesh_model_msg_type_t type, size_t startIndex = 0) {
+		int result = 0;
+		for (size_t i = startIndex; i < _sent.size(); ++i) {
+			result += (_sent[i].type == type);
+		}
+		return result;
+	}
+};
+
+/**
+ * Exact match filter on MAC address, with the given number of items.
+ */
+vector<uint8_t> makeFilter(uint8_t itemCount, uint8_t firstItem) {
+	vector<uint8_t> data = {
+			static_cast<uint8_t>(AssetFilterType::ExactMatchFilter),
+			0,  // Flags
+			0,  // Profile ID
+			static_cast<uint8_t>(AssetFilterInputType::MacAddress),
+			static_cast<uint8_t>(AssetFilterOutputFormat::Mac),
+			itemCount,
+			MAC_ADDRESS_LEN};
+	for (uint8_t i = 0; i < itemCount; ++i) {
+		data.insert(data.end(), MAC_ADDRESS_LEN, firstItem + i);
+	}
+	return data;
+}
+
+uint32_t getFilterCrc(const vector<uint8_t>& filter) {
+	return crc32(filter.data(), filter.size(), nullptr);
+}
+
+uint32_t getMasterCrc(const filter_set_t& filters) {
+	uint32_t masterCrc = crc32(nullptr, 0);
+	for (auto& filter : filters) {
+		uint8_t filterId   = filter.first;
+		uint32_t filterCrc = getFilterCrc(filter.second);
+		masterCrc          = crc32(&filterId, sizeof(filterId), &masterCrc);
+		masterCrc          = crc32(reinterpret_cast<uint8_t*>(&filterCrc), sizeof(filterCrc), &masterCrc);
+	}
+	return masterCrc;
+}
+
+/**
+ * A neighbour with a master version, that serves chunks of its filters.
+ */
+struct Neighbour {
+	stone_id_t _id;
+	uint16_t _masterVersion;
+	filter_set_t _filters;
+
+	vector<uint8_t> getChunk(const cs_mesh_model_msg_asset_filter_chunk_request_t& request) {
+		cs_mesh_model_msg_asset_filter_chunk_header_t header = {};
+		header.protocol                                      = ASSET_FILTER_CMD_PROTOCOL_VERSION;
+		header.masterVersion                                 = _masterVersion;
+		header.filterId                                      = request.filterId;
+		header.chunkStartIndex                               = request.chunkStartIndex;
+		for (auto& filter : _filters) {
+			header.filterIdBitmask |= 1 << filter.first;
+		}
+		vector<uint8_t> chunk;
+		auto iter = _filters.lower_bound(request.filterId);
+		if (iter != _filters.end()) {
+			header.filterId  = iter->first;
+			header.totalSize = iter->second.size();
+			header.filterCrc = getFilterCrc(iter->second);
+			uint16_t size =
+					min<uint16_t>(MAX_MESH_ASSET_FILTER_CHUNK_SIZE, iter->second.size() - request.chunkStartIndex);
+			chunk.assign(iter->second.begin() + request.chunkStartIndex,
+						 iter->second.begin() + request.chunkStartIndex + size);
+		}
+		vector<uint8_t> msg(reinterpret_cast<uint8_t*>(&header), reinterpret_cast<uint8_t*>(&header) + sizeof(header));
+		msg.insert(msg.end(), chunk.begin(), chunk.end());
+		return msg;
+	}
+};
+
+cs_ret_code_t receiveMeshMsg(stone_id_t srcId, cs_mesh_model_msg_type_t type, vector<uint8_t> payload) {
+	MeshMsgEvent msg;
+	msg.type            = type;
+	msg.msg             = cs_data_t(payload.data(), payload.size());
+	msg.srcStoneId      = srcId;
+	msg.macAddressValid = false;
+	msg.rssi            = -50;
+	msg.channel         = 37;
+	msg.isMaybeRelayed  = false;
+	msg.isReply         = false;
+	event_t event(CS_TYPE::EVT_RECV_MESH_MSG, &msg, sizeof(msg));
+	event.dispatch();
+	return event.result.returnCode;
+}
+
+cs_ret_code_t receiveVersion(stone_id_t srcId, uint16_t masterVersion, uint32_t masterCrc) {
+	cs_mesh_model_msg_asset_filter_version_t packet = {
+			.protocol = ASSET_FILTER_CMD_PROTOCOL_VERSION, .masterVersion = masterVersion, .masterCrc = masterCrc};
+	auto data = reinterpret_cast<uint8_t*>(&packet);
+	return receiveMeshMsg(srcId, CS_MESH_MODEL_TYPE_ASSET_FILTER_VERSION, {data, data + sizeof(packet)});
+}
+
+cs_mesh_model_msg_asset_filter_chunk_request_t getRequest(const MeshRecorder::sent_msg_t& msg) {
+	assert(msg.type == CS_MESH_MODEL_TYPE_ASSET_FILTER_CHUNK_REQUEST);
+	assert(msg.payload.size() == sizeof(cs_mesh_model_msg_asset_filter_chunk_request_t));
+	cs_mesh_model_msg_asset_filter_chunk_request_t request;
+	memcpy(&request, msg.payload.data(), sizeof(request));
+	return request;
+}
+
+/**
+ * Lets time pass: runs the coroutines that are due, and dispatches EVT_TICK_SECOND every second.
+ */
+void passMs(uint32_t ms) {
+	static uint32_t upTimeMs = 0;
+	for (uint32_t i = 0; i < ms; ++i) {
+		RTC::offsetMs(1);
+		if (TestAccess<CoroutineScheduler>::ticksUntilNextDeadline() == 0) {
+			TestAccess<CoroutineScheduler>::run();
+		}
+		if (++upTimeMs % 1000 == 0) {
+			TYPIFY(EVT_TICK_SECOND) upTime = upTimeMs / 1000;
+			event_t event(CS_TYPE::EVT_TICK_SECOND, &upTime, sizeof(upTime));
+			event.dispatch();
+		}
+	}
+}
+
+/**
+ * Replies to the chunk requests sent to the neighbour, until there are no more requests.
+ * The first request for which dropRequest returns true is not replied to, as if it was lost.
+ *
+ * @return The requests that were replied to.
+ */
+template <class DropFunction>
+vector<cs_mesh_model_msg_asset_filter_chunk_request_t> serve(
+		Neighbour& neighbour, MeshRecorder& recorder, size_t& nextIndex, DropFunction dropRequest) {
+	vector<cs_mesh_model_msg_asset_filter_chunk_request_t> served;
+	bool dropped = false;
+	while (nextIndex < recorder._sent.size()) {
+		auto msg = recorder._sent[nextIndex++];
+		if (msg.type != CS_MESH_MODEL_TYPE_ASSET_FILTER_CHUNK_REQUEST || msg.targetId != neighbour._id) {
+			continue;
+		}
+		auto request = getRequest(msg);
+		assert(request.masterVersion == neighbour._masterVersion);
+		if (!dropped && dropRequest(request)) {
+			dropped = true;
+			continue;
+		}
+		served.push_back(request);
+		receiveMeshMsg(neighbour._id, CS_MESH_MODEL_TYPE_ASSET_FILTER_CHUNK, neighbour.getChunk(request));
+	}
+	return served;
+}
+
+vector<cs_mesh_model_msg_asset_filter_chunk_request_t> serve(
+		Neighbour& neighbour, MeshRecorder& recorder, size_t& nextIndex) {
+	return serve(neighbour, recorder, nextIndex, [](auto&) { return false; });
+}
+
+/**
+ * Set the filters of the store, like a central would.
+ */
+cs_ret_code_t setFilters(AssetFilterStore& store, const filter_set_t& filters, uint16_t masterVersion) {
+	while (store.getFilterCount() > 0) {
+		TYPIFY(CMD_REMOVE_FILTER) removeCmd = {
+				.protocolVersion = ASSET_FILTER_CMD_PROTOCOL_VERSION,
+				.filterId        = store.getFilter(0).runtimedata()->filterId};
+		event_t event(CS_TYPE::CMD_REMOVE_FILTER, &removeCmd, sizeof(removeCmd));
+		event.dispatch();
+	}
+	for (auto& filter : filters) {
+		vector<uint8_t> buf(sizeof(asset_filter_cmd_upload_filter_t) + filter.second.size());
+		auto uploadCmd             = reinterpret_cast<asset_filter_cmd_upload_filter_t*>(buf.data());
+		uploadCmd->protocolVersion = ASSET_FILTER_CMD_PROTOCOL_VERSION;
+		uploadCmd->filterId        = filter.first;
+		uploadCmd->chunkStartIndex = 0;
+		uploadCmd->totalSize       = filter.second.size();
+		uploadCmd->chunkSize       = filter.second.size();
+		memcpy(uploadCmd->chunk, filter.second.data(), filter.second.size());
+		event_t event(CS_TYPE::CMD_UPLOAD_FILTER, buf.data(), buf.size());
+		event.dispatch();
+		assert(event.result.returnCode == ERR_SUCCESS);
+	}
+	TYPIFY(CMD_COMMIT_FILTER_CHANGES) commitCmd = {
+			.protocolVersion = ASSET_FILTER_CMD_PROTOCOL_VERSION,
+			.masterVersion   = masterVersion,
+			.masterCrc       = getMasterCrc(filters)};
+	event_t event(CS_TYPE::CMD_COMMIT_FILTER_CHANGES, &commitCmd, sizeof(commitCmd));
+	event.dispatch();
+	return event.result.returnCode;
+}
+
+/**
+ * Check that the store has exactly the given filters.
+ */
+bool hasFilters(AssetFilterStore& store, const filter_set_t& filters) {
+	if (store.getFilterCount() != filters.size()) {
+		return false;
+	}
+	uint8_t index = 0;
+	for (auto& filter : filters) {
+		AssetFilter storedFilter = store.getFilter(index++);
+		if (storedFilter.runtimedata()->filterId != filter.first
+			|| storedFilter.runtimedata()->filterDataSize != filter.second.size()
+			|| memcmp(storedFilter.filterdata()._data, filter.second.data(), filter.second.size()) != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+int main() {
+	RTC::freeze();
+	MockCrownstone crownstone;
+	crownstone.parentAllChildren();
+	AssetFilterStore& store = crownstone._store;
+
+	boards_config_t board;
+	init(&board);
+	asHostFullyFeatured(&board);
+	Storage::getInstance().init();
+	State::getInstance().init(&board);
+	store.init();
+	crownstone._syncer.init();
+
+	MeshRecorder recorder;
+	recorder.listen();
+	size_t nextIndex = 0;
+
+	vector<uint8_t> filter0 = makeFilter(2, 0x10);
+	vector<uint8_t> filter1 = makeFilter(1, 0x20);
+	vector<uint8_t> filter2 = makeFilter(10, 0x30);
+	assert(setFilters(store, {{0, filter0}, {1, filter1}}, 1) == ERR_SUCCESS);
+
+	// Download: filter 0 is the same, filter 1 is removed, and filter 2 is new.
+	Neighbour neighbour = {7, 5, {{0, filter0}, {2, filter2}}};
+	receiveVersion(neighbour._id, neighbour._masterVersion, getMasterCrc(neighbour._filters));
+	auto served = serve(neighbour, recorder, nextIndex);
+	uint16_t filter2ChunkCount =
+			(filter2.size() + MAX_MESH_ASSET_FILTER_CHUNK_SIZE - 1) / MAX_MESH_ASSET_FILTER_CHUNK_SIZE;
+	assert(served.size() == 1u + filter2ChunkCount);
+	// The first chunk of filter 0 shows it has the same CRC, so the next request is for the next filter ID.
+	assert(served[0].filterId == 0 && served[0].chunkStartIndex == 0);
+	assert(served[1].filterId == 1 && served[1].chunkStartIndex == 0);
+	for (uint16_t i = 1; i < filter2ChunkCount; ++i) {
+		assert(served[1 + i].filterId == 2 && served[1 + i].chunkStartIndex == i * MAX_MESH_ASSET_FILTER_CHUNK_SIZE);
+	}
+	// The last chunk of filter 2 completes the download, no request for more filters is needed, since the filter ID
+	// bitmask shows there are none.
+	assert(served.back().filterId == 2);
+	assert(store.getMasterVersion() == 5);
+	assert(store.getMasterCrc() == getMasterCrc(neighbour._filters));
+	assert(hasFilters(store, neighbour._filters));
+	cout << "Downloaded " << served.size() << " chunks" << endl;
+
+	// We now serve the same chunks as the neighbour.
+	for (auto& request : served) {
+		auto data = reinterpret_cast<uint8_t*>(&request);
+		assert(receiveMeshMsg(9, CS_MESH_MODEL_TYPE_ASSET_FILTER_CHUNK_REQUEST, {data, data + sizeof(request)})
+			   == ERR_SUCCESS);
+		assert(recorder._sent.back().type == CS_MESH_MODEL_TYPE_ASSET_FILTER_CHUNK);
+		assert(recorder._sent.back().targetId == 9);
+		assert(recorder._sent.back().payload == neighbour.getChunk(request));
+	}
+	cs_mesh_model_msg_asset_filter_chunk_request_t otherVersionRequest = served[0];
+	otherVersionRequest.masterVersion                                  = 4;
+	auto data = reinterpret_cast<uint8_t*>(&otherVersionRequest);
+	size_t sentCount = recorder._sent.size();
+	assert(receiveMeshMsg(9, CS_MESH_MODEL_TYPE_ASSET_FILTER_CHUNK_REQUEST, {data, data + sizeof(otherVersionRequest)})
+		   == ERR_WRONG_STATE);
+	assert(recorder._sent.size() == sentCount);
+	nextIndex = recorder._sent.size();
+
+	// Lost chunk: the request is sent again after the timeout, and a late reply to an older request is ignored.
+	neighbour._masterVersion = 6;
+	neighbour._filters[2]    = makeFilter(9, 0x40);
+	receiveVersion(neighbour._id, neighbour._masterVersion, getMasterCrc(neighbour._filters));
+	cs_mesh_model_msg_asset_filter_chunk_request_t lostRequest;
+	served = serve(neighbour, recorder, nextIndex, [&](auto& request) {
+		lostRequest = request;
+		return request.chunkStartIndex != 0;
+	});
+	assert(store.getMasterVersion() != 6);
+	assert(lostRequest.filterId == 2 && lostRequest.chunkStartIndex == MAX_MESH_ASSET_FILTER_CHUNK_SIZE);
+	passMs(REQUEST_TIMEOUT_MS - 1);
+	assert(recorder.count(CS_MESH_MODEL_TYPE_ASSET_FILTER_CHUNK_REQUEST, nextIndex) == 0);
+	passMs(1);
+	assert(recorder.count(CS_MESH_MODEL_TYPE_ASSET_FILTER_CHUNK_REQUEST, nextIndex) == 1);
+	auto retriedRequest = getRequest(recorder._sent.back());
+	assert(retriedRequest.filterId == lostRequest.filterId);
+	assert(retriedRequest.chunkStartIndex == lostRequest.chunkStartIndex);
+	assert(receiveMeshMsg(neighbour._id, CS_MESH_MODEL_TYPE_ASSET_FILTER_CHUNK, neighbour.getChunk(served.back()))
+		   == ERR_WRONG_PARAMETER);
+	serve(neighbour, recorder, nextIndex);
+	assert(store.getMasterVersion() == 6);
+	assert(hasFilters(store, neighbour._filters));
+	cout << "Downloaded after a lost chunk" << endl;
+
+	// A neighbour that doesn't serve chunks: the download is given up after the retries.
+	Neighbour oldNeighbour = {8, 7, {{0, filter0}}};
+	for (uint8_t attempt = 0; attempt < AssetFilterSyncer::MESH_DOWNLOAD_MAX_ATTEMPTS; ++attempt) {
+		size_t startIndex = recorder._sent.size();
+		receiveVersion(oldNeighbour._id, oldNeighbour._masterVersion, getMasterCrc(oldNeighbour._filters));
+		passMs(REQUEST_TIMEOUT_MS * (AssetFilterSyncer::MESH_CHUNK_REQUEST_MAX_RETRIES + 2));
+		assert(recorder.count(CS_MESH_MODEL_TYPE_ASSET_FILTER_CHUNK_REQUEST, startIndex)
+			   == 1 + AssetFilterSyncer::MESH_CHUNK_REQUEST_MAX_RETRIES);
+	}
+	// Then it's no longer requested: it's sent our version instead, so that it connects to us.
+	nextIndex = recorder._sent.size();
+	receiveVersion(oldNeighbour._id, oldNeighbour._masterVersion, getMasterCrc(oldNeighbour._filters));
+	assert(recorder.count(CS_MESH_MODEL_TYPE_ASSET_FILTER_CHUNK_REQUEST, nextIndex) == 0);
+	assert(recorder.count(CS_MESH_MODEL_TYPE_ASSET_FILTER_VERSION, nextIndex) == 1);
+	assert(store.getMasterVersion() == 6);
+	cout << "Gave up downloading from a stone that doesn't serve chunks" << endl;
+
+	// Other stones are still downloaded from.
+	neighbour._masterVersion = 7;
+	neighbour._filters       = oldNeighbour._filters;
+	receiveVersion(neighbour._id, neighbour._masterVersion, getMasterCrc(neighbour._filters));
+	serve(neighbour, recorder, nextIndex);
+	assert(store.getMasterVersion() == 7);
+	assert(hasFilters(store, neighbour._filters));
+
+	// Master CRC mismatch: the downloaded filters are not committed.
+	neighbour._masterVersion = 8;
+	neighbour._filters[3]    = makeFilter(3, 0x50);
+	receiveVersion(neighbour._id, neighbour._masterVersion, getMasterCrc(neighbour._filters) + 1);
+	served = serve(neighbour, recorder, nextIndex);
+	assert(!served.empty());
+	assert(store.getMasterVersion() != 8);
+	assert(store.getMasterCrc() != getMasterCrc(neighbour._filters) + 1);
+	cout << "Rejected a download with a master CRC mismatch" << endl;
+
+	// Once the uncommitted filters time out, the download can be tried again.
+	passMs(AssetFilterStore::MODIFICATION_IN_PROGRESS_TIMEOUT_SECONDS * 1000);
+	receiveVersion(neighbour._id, neighbour._masterVersion, getMasterCrc(neighbour._filters));
+	serve(neighbour, recorder, nextIndex);
+	assert(store.getMasterVersion() == 8);
+	assert(hasFilters(store, neighbour._filters));
+
+	cout << "Done" << endl;
+	return 0;
+}
@@ -0,0 +1,126 @@
+/**
+ * Simulates a dense sphere, where every crownstone sees every asset,
+ * and checks that the asset reports of all crownstones together stay within the budget.
+ */
+
+#include <localisation/cs_AssetRateController.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+constexpr uint16_t TICK_INTERVAL_MS        = 100;
+constexpr uint16_t TICKS_PER_MINUTE        = 60 * 1000 / TICK_INTERVAL_MS;
+constexpr uint16_t BUDGET_PER_MINUTE       = 600;
+constexpr int STONE_COUNT                  = 20;
+constexpr int ASSET_COUNT                  = 30;
+constexpr int MINUTES                      = 20;
+
+// Max number of messages the mesh can handle per tick, more will result in a full queue.
+constexpr int MESH_CAPACITY_PER_TICK       = 4;
+
+struct asset_view_t {
+	int rssi;
+	int lastReportedRssi;
+	uint16_t throttleTicks;
+};
+
+int main() {
+	srand(1);
+
+	vector<AssetRateController> controllers;
+	for (int stone = 0; stone < STONE_COUNT; ++stone) {
+		controllers.emplace_back(BUDGET_PER_MINUTE, TICK_INTERVAL_MS);
+	}
+
+	// Half of the assets are moving, the other half is stable.
+	vector<vector<asset_view_t>> views(STONE_COUNT, vector<asset_view_t>(ASSET_COUNT, {-70, 0, 0}));
+
+	vector<int> reportsPerMinute(MINUTES, 0);
+	int movingReportCount = 0;
+	int stableReportCount = 0;
+
+	for (int tick = 0; tick < MINUTES * TICKS_PER_MINUTE; ++tick) {
+		vector<int> senders;
+		for (int stone = 0; stone < STONE_COUNT; ++stone) {
+			for (int asset = 0; asset < ASSET_COUNT; ++asset) {
+				auto& view   = views[stone][asset];
+				bool moving  = asset < ASSET_COUNT / 2;
+				// Every asset is scanned every tick.
+				view.rssi    = moving ? -50 - rand() % 40 : -70 - rand() % 3;
+				if (view.throttleTicks > 0) {
+					view.throttleTicks--;
+					continue;
+				}
+				uint8_t rssiDelta = abs(view.rssi - view.lastReportedRssi);
+				bool allowed      = controllers[stone].requestReport(rssiDelta, view.throttleTicks);
+				if (allowed) {
+					view.lastReportedRssi = view.rssi;
+					senders.push_back(stone);
+					moving ? movingReportCount++ : stableReportCount++;
+				}
+			}
+		}
+
+		int sentCount = 0;
+		for (size_t i = 0; i < senders.size(); ++i) {
+			bool queueFull = (static_cast<int>(i) >= MESH_CAPACITY_PER_TICK);
+			controllers[senders[i]].onReportSent(queueFull);
+			if (queueFull) {
+				continue;
+			}
+			sentCount++;
+			for (int stone = 0; stone < STONE_COUNT; ++stone) {
+				if (stone != senders[i]) {
+					controllers[stone].onReportReceived();
+				}
+			}
+		}
+		reportsPerMinute[tick / TICKS_PER_MINUTE] += sentCount;
+
+		for (auto& controller : controllers) {
+			controller.tick();
+		}
+	}
+
+	int total = 0;
+	for (int minute = 0; minute < MINUTES; ++minute) {
+		cout << "Minute " << minute << ": " << reportsPerMinute[minute] << " reports" << endl;
+		total += reportsPerMinute[minute];
+		// Skip the first minute, in which the controllers still have to converge.
+		if (minute > 0) {
+			assert(reportsPerMinute[minute] <= BUDGET_PER_MINUTE);
+		}
+	}
+	cout << "Average: " << total / MINUTES << " reports per minute, budget: " << BUDGET_PER_MINUTE << endl;
+	cout << "Moving asset reports: " << movingReportCount << ", stable asset reports: " << stableReportCount << endl;
+
+	// Use most of the budget.
+	assert(total / MINUTES >= BUDGET_PER_MINUTE / 2);
+
+	// Moving assets should get more reports than stable assets.
+	assert(movingReportCount > 2 * stableReportCount);
+
+	// Without asset reports, the controllers become steady, so they don't have to be ticked anymore.
+	int steadyTicks = 0;
+	for (auto& controller : controllers) {
+		int ticks = 0;
+		while (!controller.isSteady()) {
+			controller.tick();
+			ticks++;
+			assert(ticks < 10 * TICKS_PER_MINUTE);
+		}
+		steadyTicks = max(steadyTicks, ticks);
+	}
+	cout << "Steady after " << steadyTicks << " ticks without reports" << endl;
+
+	// A report makes a controller unsteady again.
+	uint16_t throttleTicks;
+	assert(controllers[0].requestReport(0, throttleTicks));
+	assert(!controllers[0].isSteady());
+	return 0;
+}
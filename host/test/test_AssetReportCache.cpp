@@ -0,0 +1,87 @@
+/**
+ * Checks that the asset report cache:
+ * - Recognises copies of a report, from the same reporter, until they expire.
+ * - Doesn't discard a new report with the same content, or reports without number.
+ * - Overwrites the oldest entry when full.
+ * - Counts hits and misses.
+ */
+
+#include <localisation/cs_AssetReportCache.h>
+
+#include <cassert>
+#include <iostream>
+
+using namespace std;
+
+cs_mesh_model_msg_asset_report_id_t makeReport(uint8_t assetId, uint8_t counter) {
+	cs_mesh_model_msg_asset_report_id_t report = {};
+	report.id                                  = asset_id_t{.data{assetId, 0, 0}};
+	report.rssi                                = -60;
+	report.channel                             = 1;
+	report.counter                             = counter;
+	return report;
+}
+
+/**
+ * Handles a report like the nearest crownstone tracker does.
+ *
+ * @return true when the report is handled, false when it is ignored as copy.
+ */
+bool receive(AssetReportCache& cache, const cs_mesh_model_msg_asset_report_id_t& report, stone_id_t reporter) {
+	bool duplicate = cache.contains(report, reporter);
+	cache.countLookup(duplicate);
+	if (duplicate) {
+		return false;
+	}
+	cache.add(report, reporter);
+	return true;
+}
+
+int main() {
+	AssetReportCache cache;
+	const AssetReportCache& constCache = cache;
+	assert(constCache.isEmpty());
+
+	// A copy is ignored, but not a copy from another reporter, or a new report with the same content.
+	auto report = makeReport(1, 10);
+	assert(!constCache.contains(report, 5));
+	assert(receive(cache, report, 5));
+	assert(constCache.contains(report, 5));
+	assert(!receive(cache, report, 5));
+	assert(!receive(cache, report, 5));
+	assert(receive(cache, report, 6));
+	assert(receive(cache, makeReport(1, 11), 5));
+	assert(receive(cache, makeReport(2, 10), 5));
+	assert(cache.getHitCount() == 2);
+	assert(cache.getMissCount() == 4);
+
+	// Reports without number are always handled.
+	auto unnumbered = makeReport(3, 0);
+	assert(receive(cache, unnumbered, 5));
+	assert(receive(cache, unnumbered, 5));
+	assert(cache.getHitCount() == 2);
+	assert(cache.getMissCount() == 6);
+
+	// Entries expire.
+	for (uint8_t i = 0; i < AssetReportCache::TIMEOUT_TICKS - 1; ++i) {
+		cache.onTick();
+	}
+	assert(cache.contains(report, 5));
+	assert(!cache.isEmpty());
+	cache.onTick();
+	assert(!cache.contains(report, 5));
+	assert(cache.isEmpty());
+	assert(receive(cache, report, 5));
+
+	// When full, the oldest entry is overwritten.
+	for (uint8_t i = 0; i < AssetReportCache::SIZE - 1; ++i) {
+		cache.add(makeReport(4, i + 1), 7);
+	}
+	assert(cache.contains(report, 5));
+	cache.add(makeReport(4, AssetReportCache::SIZE), 7);
+	assert(!cache.contains(report, 5));
+	assert(cache.contains(makeReport(4, 1), 7));
+
+	cout << "hits=" << cache.getHitCount() << " misses=" << cache.getMissCount() << endl;
+	return 0;
+}
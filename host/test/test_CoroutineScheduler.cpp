@@ -0,0 +1,264 @@
+/**
+ * Runs coroutines with the scheduler for longer than the RTC overflow period,
+ * and checks that they are executed at their deadlines.
+ *
+ * Then runs the periodic work of an idle crownstone, and compares the number of wake ups
+ * with the number of wake ups when every periodic has its own timer, with and without EVT_TICK requested.
+ */
+
+#include <drivers/cs_RTC.h>
+#include <events/cs_CompatibilityTick.h>
+#include <events/cs_EventListener.h>
+#include <testaccess/cs_CoroutineScheduler.h>
+#include <util/cs_Coroutine.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+
+// Longer than the RTC overflow period of 512 s.
+constexpr uint32_t DURATION_MS = 20 * 60 * 1000;
+
+uint32_t nowMs                 = 0;
+
+void testDeadlines() {
+	int fastCount = 0;
+	Coroutine fast([&]() {
+		fastCount++;
+		return Coroutine::delayMs(15);
+	});
+
+	int secondCount       = 0;
+	uint32_t lastSecondMs = 0;
+	Coroutine everySecond([&]() {
+		if (secondCount > 0) {
+			assert(nowMs - lastSecondMs == 1000);
+		}
+		lastSecondMs = nowMs;
+		secondCount++;
+		return Coroutine::delayS(1);
+	});
+
+	// Stops itself after 10 executions.
+	int stoppingCount = 0;
+	Coroutine stopping;
+	stopping.action = [&]() {
+		if (++stoppingCount == 10) {
+			stopping.stop();
+		}
+		return Coroutine::delayMs(250);
+	};
+
+	// Restarts itself with a different delay than it returns.
+	int restartingCount = 0;
+	Coroutine restarting;
+	restarting.action = [&]() {
+		restartingCount++;
+		restarting.start(500);
+		return Coroutine::delayMs(10);
+	};
+
+	fast.start();
+	everySecond.start(1000);
+	stopping.start();
+	restarting.start();
+
+	// Nothing is due before the first deadline.
+	assert(TestAccess<CoroutineScheduler>::ticksUntilNextDeadline() > 0);
+
+	uint32_t endMs = nowMs + DURATION_MS;
+	while (nowMs < endMs) {
+		nowMs++;
+		RTC::offsetMs(1);
+		if (TestAccess<CoroutineScheduler>::ticksUntilNextDeadline() == 0) {
+			TestAccess<CoroutineScheduler>::run();
+		}
+		assert(TestAccess<CoroutineScheduler>::ticksUntilNextDeadline() > 0);
+	}
+
+	cout << "fast=" << fastCount << " everySecond=" << secondCount << " stopping=" << stoppingCount
+		 << " restarting=" << restartingCount << endl;
+	// Deadlines are counted in RTC ticks, so a period of 15 ms is rounded to 492 ticks: 15.015 ms.
+	assert(abs(fastCount - static_cast<int>(DURATION_MS / 15)) <= static_cast<int>(DURATION_MS / 15 / 1000) + 1);
+	assert(secondCount == DURATION_MS / 1000);
+	assert(stoppingCount == 10);
+	assert(!stopping.isStarted());
+	assert(abs(restartingCount - static_cast<int>(DURATION_MS / 500)) <= 1);
+
+	fast.stop();
+	everySecond.stop();
+	restarting.stop();
+	assert(TestAccess<CoroutineScheduler>::ticksUntilNextDeadline() == 0xFFFFFFFF);
+}
+
+/**
+ * Counts down a number of ticks, and only requests EVT_TICK while counting down.
+ */
+class TickCountdown : public EventListener {
+public:
+	TickRequest tickRequest;
+	uint32_t countdown = 0;
+	uint32_t tickCount = 0;
+
+	void start(uint32_t ticks) {
+		countdown = ticks;
+		tickRequest.request();
+	}
+
+	void handleEvent(event_t& event) override {
+		if (event.type != CS_TYPE::EVT_TICK) {
+			return;
+		}
+		tickCount++;
+		if (countdown != 0 && --countdown == 0) {
+			tickRequest.release();
+		}
+	}
+};
+
+void runMs(uint32_t durationMs) {
+	uint32_t endMs = nowMs + durationMs;
+	while (nowMs < endMs) {
+		nowMs++;
+		RTC::offsetMs(1);
+		if (TestAccess<CoroutineScheduler>::ticksUntilWakeUp() == 0) {
+			TestAccess<CoroutineScheduler>::run();
+		}
+	}
+}
+
+/**
+ * The compatibility tick only runs while requested.
+ */
+void testCompatibilityTick() {
+	// Keep listening after this test, so that the listeners outlive the later EVT_TICK dispatches.
+	static TickCountdown first;
+	static TickCountdown second;
+	first.listen();
+	second.listen();
+
+	first.start(10);
+	second.start(20);
+	assert(CompatibilityTick::getInstance().getRequestCount() == 2);
+
+	// Ticks may be late by the allowed jitter, but not by a whole interval.
+	runMs(1000 + TICK_INTERVAL_MS / 2 + TICK_JITTER_MS);
+	assert(first.tickCount == 10);
+	assert(!first.tickRequest.isRequested());
+	assert(second.countdown == 10);
+
+	runMs(5000);
+	assert(second.tickCount == 20);
+	assert(CompatibilityTick::getInstance().getRequestCount() == 0);
+
+	// Nothing is scheduled anymore.
+	assert(TestAccess<CoroutineScheduler>::ticksUntilNextDeadline() == 0xFFFFFFFF);
+}
+
+struct periodic_t {
+	const char* name;
+	uint32_t periodMs;
+	uint32_t allowedJitterMs;
+};
+
+/**
+ * Periodic work of an idle crownstone: every coroutine that keeps running while nothing happens.
+ * Components with a countdown, like the asset store and the asset forwarder, stop their coroutine when idle.
+ */
+const periodic_t idlePeriodics[] = {
+		{"watchdog", 10000, 1000},
+		{"crownstone temperature", 500, 100},
+		{"crownstone load stats", 60000, 1000},
+		{"temperature guard", 100, 50},
+		{"system time", 500, 100},
+		{"time sync", 20 * 60 * 1000, 0},
+		{"mesh state", 50000, 0},
+		{"asset filter trickle", 5 * 60 * 1000, 0},
+};
+
+/**
+ * Runs the idle periodics, each with a different phase, and checks that they are executed within their jitter.
+ * Prints the number of wake ups per second, and the number when every periodic has its own timer.
+ *
+ * @param[in] requestTick    Request EVT_TICK during the run, as a component does while it counts down.
+ */
+void testIdleWakeUps(bool requestTick) {
+	constexpr size_t COUNT = sizeof(idlePeriodics) / sizeof(idlePeriodics[0]);
+	Coroutine coroutines[COUNT];
+	uint32_t lastExecutionMs[COUNT] = {};
+	uint32_t executionCount[COUNT]  = {};
+	uint32_t separateWakeUps        = 0;
+	uint32_t shortestPeriodMs       = DURATION_MS;
+	uint32_t unjitteredWakeUps      = 0;
+
+	for (size_t i = 0; i < COUNT; ++i) {
+		const periodic_t& periodic    = idlePeriodics[i];
+		shortestPeriodMs              = std::min(shortestPeriodMs, periodic.periodMs);
+		if (periodic.allowedJitterMs == 0) {
+			unjitteredWakeUps += DURATION_MS / periodic.periodMs + 1;
+		}
+		coroutines[i].allowedJitterMs = periodic.allowedJitterMs;
+		coroutines[i].action          = [&, i]() {
+			if (lastExecutionMs[i] != 0) {
+				// Executions may be late by the allowed jitter, but the next deadline is counted from the previous.
+				uint32_t intervalMs = nowMs - lastExecutionMs[i];
+				assert(intervalMs + idlePeriodics[i].allowedJitterMs + 1 >= idlePeriodics[i].periodMs);
+				assert(intervalMs <= idlePeriodics[i].periodMs + idlePeriodics[i].allowedJitterMs + 1);
+			}
+			lastExecutionMs[i] = nowMs;
+			executionCount[i]++;
+			return Coroutine::delayMs(idlePeriodics[i].periodMs);
+		};
+		// With a timer per periodic, every execution is a wake up.
+		separateWakeUps += DURATION_MS / periodic.periodMs;
+		coroutines[i].start(1 + rand() % periodic.periodMs);
+	}
+
+	TickRequest tickRequest;
+	if (requestTick) {
+		tickRequest.request();
+		separateWakeUps += DURATION_MS / TICK_INTERVAL_MS;
+	}
+
+	uint32_t startWakeUpCount = CoroutineScheduler::getInstance().getWakeUpCount();
+	runMs(DURATION_MS);
+	uint32_t wakeUps          = CoroutineScheduler::getInstance().getWakeUpCount() - startWakeUpCount;
+
+	double separatePerSecond  = 1000.0 * separateWakeUps / DURATION_MS;
+	double coalescedPerSecond = 1000.0 * wakeUps / DURATION_MS;
+	cout << (requestTick ? "Idle with EVT_TICK requested" : "Idle") << ": wake ups per second: separate timers="
+		 << separatePerSecond << " coalesced=" << coalescedPerSecond << endl;
+	assert(wakeUps < separateWakeUps);
+
+	// Without a request, the compatibility tick doesn't add wake ups.
+	// The periodics with jitter share the wake ups of the shortest, only those without jitter may need their own.
+	if (!requestTick) {
+		assert(wakeUps <= DURATION_MS / shortestPeriodMs + 1 + unjitteredWakeUps);
+	}
+
+	// Running late doesn't make the periodics drift: they're executed as often as without jitter.
+	// Allow for the rounding of the period to RTC ticks.
+	for (size_t i = 0; i < COUNT; ++i) {
+		uint32_t expectedCount = DURATION_MS / idlePeriodics[i].periodMs;
+		assert(executionCount[i] + 1 + expectedCount / 1000 >= expectedCount);
+		assert(executionCount[i] <= expectedCount + 1 + expectedCount / 1000);
+	}
+
+	tickRequest.release();
+	for (auto& coroutine : coroutines) {
+		coroutine.stop();
+	}
+}
+
+int main() {
+	srand(1);
+	RTC::freeze();
+	testDeadlines();
+	testCompatibilityTick();
+	testIdleWakeUps(false);
+	testIdleWakeUps(true);
+	return 0;
+}
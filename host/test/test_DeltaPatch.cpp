@@ -0,0 +1,329 @@
+/**
+ * Creates delta patches between consecutive firmware releases, applies them in place the way the bootloader does,
+ * and reports the patch sizes.
+ *
+ * The releases are taken from the factory images in this repository: the application is extracted from each image,
+ * using the bootloader settings page.
+ */
+
+#include <utils/cs_DeltaPatchEncoder.h>
+#include <utils/cs_LzCompressor.h>
+
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+const uint16_t PAGE_SIZE              = 4096;
+const uint32_t IMAGE_SIZE             = 0x80000;
+const uint32_t IMAGE_APP_ADDRESS      = 0x26000;
+const uint32_t IMAGE_SETTINGS_ADDRESS = 0x7F000;
+const uint32_t IMAGE_APP_MAX_LENGTH   = 0x45000;
+const uint32_t BANK_VALID_APP         = 0x01;
+
+struct release_t {
+	string name;
+	uint32_t version;
+	vector<uint8_t> app;
+};
+
+/**
+ * Layout of the start of the bootloader settings, see nrf_dfu_settings_t.
+ */
+struct __attribute__((packed)) bootloader_settings_t {
+	uint32_t crc;
+	uint32_t settingsVersion;
+	uint32_t appVersion;
+	uint32_t bootloaderVersion;
+	uint32_t bankLayout;
+	uint32_t bankCurrent;
+	uint32_t bank0ImageSize;
+	uint32_t bank0ImageCrc;
+	uint32_t bank0BankCode;
+};
+
+/**
+ * Reads an intel hex file into an image of the flash.
+ */
+bool readHex(const string& path, vector<uint8_t>& flash) {
+	ifstream file(path);
+	if (!file) {
+		return false;
+	}
+	flash.assign(IMAGE_SIZE, 0xFF);
+	uint32_t baseAddress = 0;
+	string line;
+	while (getline(file, line)) {
+		if (line.size() < 11 || line[0] != ':') {
+			continue;
+		}
+		vector<uint8_t> record;
+		for (size_t i = 1; i + 1 < line.size(); i += 2) {
+			record.push_back(stoi(line.substr(i, 2), nullptr, 16));
+		}
+		uint8_t size     = record[0];
+		uint16_t address = (record[1] << 8) | record[2];
+		uint8_t type     = record[3];
+		switch (type) {
+			case 0:
+				for (uint8_t i = 0; i < size; ++i) {
+					if (baseAddress + address + i < IMAGE_SIZE) {
+						flash[baseAddress + address + i] = record[4 + i];
+					}
+				}
+				break;
+			case 2: baseAddress = ((record[4] << 8) | record[5]) << 4; break;
+			case 4: baseAddress = ((record[4] << 8) | record[5]) << 16; break;
+		}
+	}
+	return true;
+}
+
+/**
+ * Gets the releases from the factory images, one per application version, sorted by version.
+ */
+vector<release_t> getReleases() {
+	string dir = filesystem::path(__FILE__).parent_path().string() + "/../../factory-images/hex";
+	vector<string> paths;
+	error_code error;
+	for (auto it = filesystem::recursive_directory_iterator(dir, error); !error && it != filesystem::end(it);
+		 it.increment(error)) {
+		// The first software of a device is a different build of a version that is also released separately.
+		if (it->path().filename() == "factory-image.hex" && it->path().parent_path().filename() != "software_0000") {
+			paths.push_back(it->path().string());
+		}
+	}
+	sort(paths.begin(), paths.end());
+
+	map<uint32_t, release_t> releases;
+	vector<uint8_t> flash;
+	for (auto& path : paths) {
+		if (!readHex(path, flash)) {
+			continue;
+		}
+		bootloader_settings_t settings;
+		memcpy(&settings, flash.data() + IMAGE_SETTINGS_ADDRESS, sizeof(settings));
+		if (settings.bank0BankCode != BANK_VALID_APP
+			|| settings.bank0ImageSize > IMAGE_SETTINGS_ADDRESS - IMAGE_APP_ADDRESS
+			|| releases.count(settings.appVersion)) {
+			continue;
+		}
+		auto start = flash.begin() + IMAGE_APP_ADDRESS;
+		vector<uint8_t> app(start, start + settings.bank0ImageSize);
+
+		// The CRC of the bootloader settings should match our CRC32.
+		assert(deltaPatchCrc32(app.data(), app.size(), 0) == settings.bank0ImageCrc);
+
+		string name = filesystem::relative(path, dir).parent_path().string();
+		releases[settings.appVersion] = {name, settings.appVersion, app};
+	}
+
+	vector<release_t> result;
+	for (auto& release : releases) {
+		result.push_back(release.second);
+	}
+	return result;
+}
+
+/**
+ * Applies a patch in place, like the bootloader: each page is produced in a RAM buffer, and then written over the
+ * base image.
+ *
+ * @param[in,out] flash         The base image, padded to whole pages. Will be overwritten with the target.
+ * @param[in] stopAfterPages    Stop after this many pages, to simulate a reset.
+ * @param[in,out] state         The state, to resume from. Initialized when it has no pages produced yet.
+ */
+DeltaPatchRetCode applyInPlace(
+		vector<uint8_t>& flash, const vector<uint8_t>& patch, cs_delta_patch_t& state, uint32_t stopAfterPages = -1) {
+	uint8_t buffer[PAGE_SIZE];
+	uint32_t pages = 0;
+	while (pages < stopAfterPages) {
+		uint32_t offset       = 0;
+		uint32_t size         = 0;
+		DeltaPatchRetCode ret = deltaPatchNextPage(&state, buffer, &offset, &size);
+		if (ret != DELTA_PATCH_SUCCESS) {
+			return ret;
+		}
+		assert(offset % PAGE_SIZE == 0 && offset + size <= flash.size());
+		memset(flash.data() + offset, 0xFF, PAGE_SIZE);
+		memcpy(flash.data() + offset, buffer, size);
+		pages++;
+	}
+	return DELTA_PATCH_SUCCESS;
+}
+
+/**
+ * Decodes all pages without writing them, and checks the output CRC, like the bootloader does before it overwrites
+ * anything.
+ */
+bool dryRun(const vector<uint8_t>& base, const vector<uint8_t>& patch) {
+	cs_delta_patch_t state;
+	if (deltaPatchInit(&state, patch.data(), patch.size(), base.data(), PAGE_SIZE) != DELTA_PATCH_SUCCESS
+		|| deltaPatchVerifyBase(&state, base.size()) != DELTA_PATCH_SUCCESS) {
+		return false;
+	}
+	uint8_t buffer[PAGE_SIZE];
+	uint32_t crc = 0;
+	while (true) {
+		uint32_t offset       = 0;
+		uint32_t size         = 0;
+		DeltaPatchRetCode ret = deltaPatchNextPage(&state, buffer, &offset, &size);
+		if (ret == DELTA_PATCH_DONE) {
+			return crc == state.header.outputCrc;
+		}
+		if (ret != DELTA_PATCH_SUCCESS) {
+			return false;
+		}
+		crc = deltaPatchCrc32(buffer, size, crc);
+	}
+}
+
+vector<uint8_t> getFlash(const vector<uint8_t>& base, const vector<uint8_t>& target) {
+	size_t size = max(base.size(), target.size());
+	vector<uint8_t> flash((size + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE, 0xFF);
+	memcpy(flash.data(), base.data(), base.size());
+	return flash;
+}
+
+uint32_t alignToPage(uint32_t size) {
+	return (size + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+}
+
+/**
+ * Whether the bootloader has room to apply the patch: the patch is received after the base, and moved to after the
+ * target, with a journal page at the end of the application area.
+ */
+bool fitsInApplicationArea(uint32_t baseSize, uint32_t targetSize, uint32_t patchSize) {
+	uint32_t patchEnd = max(alignToPage(baseSize), alignToPage(targetSize)) + alignToPage(patchSize);
+	return patchEnd + PAGE_SIZE <= IMAGE_APP_MAX_LENGTH;
+}
+
+/**
+ * Patches base to target in place, in one go, and after a reset halfway.
+ */
+void testPatch(const vector<uint8_t>& base, const vector<uint8_t>& target, const vector<uint8_t>& patch) {
+	assert(dryRun(base, patch));
+
+	vector<uint8_t> flash = getFlash(base, target);
+	cs_delta_patch_t state;
+	assert(deltaPatchInit(&state, patch.data(), patch.size(), flash.data(), PAGE_SIZE) == DELTA_PATCH_SUCCESS);
+	assert(deltaPatchVerifyBase(&state, base.size()) == DELTA_PATCH_SUCCESS);
+	assert(applyInPlace(flash, patch, state) == DELTA_PATCH_DONE);
+	assert(equal(target.begin(), target.end(), flash.begin()));
+
+	// Reset halfway: only the progress is kept.
+	flash = getFlash(base, target);
+	assert(deltaPatchInit(&state, patch.data(), patch.size(), flash.data(), PAGE_SIZE) == DELTA_PATCH_SUCCESS);
+	assert(applyInPlace(flash, patch, state, state.pageCount / 2) == DELTA_PATCH_SUCCESS);
+	cs_delta_patch_t resumed;
+	assert(deltaPatchInit(&resumed, patch.data(), patch.size(), flash.data(), PAGE_SIZE) == DELTA_PATCH_SUCCESS);
+	resumed.outputPageCount = state.outputPageCount;
+	resumed.patchOffset     = state.patchOffset;
+	resumed.baseCursor      = state.baseCursor;
+	assert(applyInPlace(flash, patch, resumed) == DELTA_PATCH_DONE);
+	assert(equal(target.begin(), target.end(), flash.begin()));
+	assert(deltaPatchCrc32(flash.data(), target.size(), 0) == resumed.header.targetCrc);
+}
+
+/**
+ * Generates a base and target that differ like consecutive firmware: the target has code inserted, some changed
+ * words, and the code after the insert is shifted.
+ */
+void getSyntheticPair(vector<uint8_t>& base, vector<uint8_t>& target) {
+	srand(1);
+	base.clear();
+	for (uint32_t i = 0; i < 40000; ++i) {
+		uint16_t instructions[] = {0x4B00, 0x681B, 0x2B00, 0xD000, 0x2200, 0x0020, 0xF000, 0x6863, 0x3301};
+		uint16_t instruction    = instructions[rand() % 9] | (rand() % 4);
+		base.push_back(instruction & 0xFF);
+		base.push_back(instruction >> 8);
+	}
+	target = base;
+	target.insert(target.begin() + 30000, base.begin() + 1000, base.begin() + 1700);
+	for (uint32_t i = 0; i < 200; ++i) {
+		target[rand() % target.size()] = rand();
+	}
+	target.erase(target.begin() + 70000, target.begin() + 70100);
+}
+
+int main() {
+	DeltaPatchEncoder encoder(PAGE_SIZE);
+
+	vector<uint8_t> base;
+	vector<uint8_t> target;
+	getSyntheticPair(base, target);
+	for (bool backward : {false, true}) {
+		testPatch(base, target, encoder.encode(base, target, backward));
+		testPatch(target, base, encoder.encode(target, base, backward));
+	}
+	vector<uint8_t> patch = encoder.encode(base, target);
+	assert(patch.size() < target.size() / 10);
+
+	// Patch to an identical and to an empty image.
+	testPatch(base, base, encoder.encode(base, base));
+	testPatch(base, vector<uint8_t>(), encoder.encode(base, vector<uint8_t>()));
+
+	// The wrong base is rejected.
+	cs_delta_patch_t state;
+	assert(deltaPatchInit(&state, patch.data(), patch.size(), target.data(), PAGE_SIZE) == DELTA_PATCH_SUCCESS);
+	assert(deltaPatchVerifyBase(&state, target.size()) == DELTA_PATCH_BASE_MISMATCH);
+
+	// A patch for another page size is rejected.
+	assert(deltaPatchInit(&state, patch.data(), patch.size(), base.data(), 1024) == DELTA_PATCH_INVALID_HEADER);
+
+	// A corrupt patch is detected before anything is written.
+	for (uint32_t i = sizeof(cs_delta_patch_header_t); i < patch.size(); i += 97) {
+		vector<uint8_t> corrupt = patch;
+		corrupt[i] ^= 0x5A;
+		assert(!dryRun(base, corrupt));
+	}
+
+	// A truncated patch too.
+	vector<uint8_t> truncated(patch.begin(), patch.end() - 1);
+	assert(!dryRun(base, truncated));
+
+	vector<release_t> releases = getReleases();
+	cout << "Found " << releases.size() << " releases" << endl;
+	if (releases.size() < 2) {
+		return 0;
+	}
+
+	cout << setw(8) << "from" << setw(8) << "to" << setw(10) << "size" << setw(12) << "compressed" << setw(10)
+		 << "delta" << setw(8) << "ratio" << setw(10) << "order" << "  fits" << endl;
+	LzCompressor compressor;
+	uint32_t totalSize  = 0;
+	uint32_t totalDelta = 0;
+	for (size_t i = 1; i < releases.size(); ++i) {
+		auto& from              = releases[i - 1];
+		auto& to                = releases[i];
+		patch                   = encoder.encode(from.app, to.app);
+		uint32_t compressedSize = compressor.compress(to.app).size();
+		testPatch(from.app, to.app, patch);
+
+		cs_delta_patch_header_t header;
+		memcpy(&header, patch.data(), sizeof(header));
+		cout << setw(8) << from.version << setw(8) << to.version << setw(10) << to.app.size() << setw(12)
+			 << compressedSize << setw(10) << patch.size() << setw(8) << fixed << setprecision(2)
+			 << double(patch.size()) / to.app.size() << setw(10)
+			 << (header.flags & CS_DELTA_PATCH_FLAG_BACKWARD ? "backward" : "forward") << "  "
+			 << (fitsInApplicationArea(from.app.size(), to.app.size(), patch.size()) ? "yes" : "no") << endl;
+		totalSize += to.app.size();
+		totalDelta += patch.size();
+
+		// The patch is only for its own base.
+		vector<uint8_t> flash = getFlash(to.app, to.app);
+		assert(deltaPatchInit(&state, patch.data(), patch.size(), flash.data(), PAGE_SIZE) == DELTA_PATCH_SUCCESS);
+		assert(deltaPatchVerifyBase(&state, to.app.size()) == DELTA_PATCH_BASE_MISMATCH);
+	}
+	cout << "Total: size=" << totalSize << " delta=" << totalDelta << " ratio=" << double(totalDelta) / totalSize
+		 << endl;
+	assert(totalDelta < totalSize);
+	return 0;
+}
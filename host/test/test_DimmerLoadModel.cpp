@@ -0,0 +1,144 @@
+/**
+ * Dims random loads to random intensities, and compares the number of changes that exceed the softfuse threshold
+ * without prediction, and with the learned load model.
+ *
+ * With prediction, only changes to an intensity where the load is unknown can exceed the threshold.
+ * Those are left to the safe switch, which turns on the relay when the measured current gets close to the threshold.
+ */
+
+#include <switch/cs_DimmerLoadModel.h>
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+
+constexpr int32_t THRESHOLD_MILLI_AMP = 1000;
+constexpr int32_t LIMIT_MILLI_AMP     = THRESHOLD_MILLI_AMP * 90 / 100;
+constexpr uint8_t SOFT_ON_SPEED       = 8;
+constexpr int LOAD_COUNT              = 1000;
+constexpr int CHANGES_PER_LOAD        = 50;
+
+/**
+ * RMS current of a phase cut dimmed load: a resistive part, and a part that draws a constant current (LED driver).
+ */
+struct load_t {
+	int32_t fullMilliAmp;
+	float resistivePart;
+
+	int32_t current(uint8_t intensity) const {
+		float fraction = intensity / 100.0f;
+		float current  = resistivePart * sqrt(fraction) + (1 - resistivePart) * (intensity > 0 ? 1.0f : 0.0f) * 0.3f
+						+ (1 - resistivePart) * 0.7f * fraction;
+		return fullMilliAmp * current;
+	}
+};
+
+/**
+ * Measured current, with some noise.
+ */
+int32_t measure(const load_t& load, uint8_t intensity) {
+	return load.current(intensity) * (0.97f + (rand() % 60) / 1000.0f);
+}
+
+void testPrediction() {
+	DimmerLoadModel model;
+	assert(model.predict(50) == DimmerLoadModel::CURRENT_UNKNOWN);
+	assert(model.predict(0) == 0);
+	assert(model.getStepSize(50, LIMIT_MILLI_AMP, SOFT_ON_SPEED) == SOFT_ON_SPEED);
+
+	model.learn(20, 200);
+	model.learn(60, 400);
+	assert(model.predict(20) == 200);
+	assert(model.predict(40) == 300);
+	// Extrapolated proportionally above the highest point.
+	assert(model.predict(90) == 600);
+	// Not extrapolated below the lowest point.
+	assert(model.predict(10) == 200);
+
+	// Repeated measurements at the same intensity are averaged.
+	for (int i = 0; i < 20; ++i) {
+		model.learn(60, 480);
+	}
+	assert(abs(model.predict(60) - 480) <= 4);
+
+	// A measurement at another intensity in the same band replaces the point.
+	model.learn(62, 500);
+	assert(model.predict(62) == 500);
+
+	// More headroom gives larger steps.
+	assert(model.getStepSize(20, LIMIT_MILLI_AMP, SOFT_ON_SPEED) > SOFT_ON_SPEED);
+	assert(model.getStepSize(90, LIMIT_MILLI_AMP, SOFT_ON_SPEED) == SOFT_ON_SPEED);
+
+	model.clear();
+	assert(model.predict(50) == DimmerLoadModel::CURRENT_UNKNOWN);
+}
+
+/**
+ * Returns the number of fade updates it takes to go from one intensity to another.
+ */
+int settleUpdates(uint8_t from, uint8_t to, uint8_t stepSize) {
+	int diff = abs(to - from);
+	return (diff + stepSize - 1) / stepSize;
+}
+
+void testTrips() {
+	int exceededWithoutModel = 0;
+	int exceededWithModel    = 0;
+	int rejected             = 0;
+	int dimmedCount          = 0;
+	long softOnUpdates       = 0;
+	long updates             = 0;
+
+	for (int i = 0; i < LOAD_COUNT; ++i) {
+		load_t load{200 + rand() % 1800, (rand() % 100) / 100.0f};
+		DimmerLoadModel model;
+
+		// Without prediction, the softfuse is triggered once, after which dimming is disabled.
+		for (int change = 0; change < CHANGES_PER_LOAD; ++change) {
+			uint8_t target = 1 + rand() % 100;
+			if (load.current(target) > THRESHOLD_MILLI_AMP) {
+				exceededWithoutModel++;
+				break;
+			}
+		}
+
+		uint8_t intensity = 0;
+		for (int change = 0; change < CHANGES_PER_LOAD; ++change) {
+			uint8_t target = 1 + rand() % 100;
+			if (model.predict(target) > LIMIT_MILLI_AMP) {
+				// The relay is turned on instead.
+				rejected++;
+				continue;
+			}
+			uint8_t stepSize = model.getStepSize(target, LIMIT_MILLI_AMP, SOFT_ON_SPEED);
+			assert(stepSize >= SOFT_ON_SPEED && stepSize <= 100);
+			softOnUpdates += settleUpdates(intensity, target, SOFT_ON_SPEED);
+			updates += settleUpdates(intensity, target, stepSize);
+			dimmedCount++;
+			intensity = target;
+			if (load.current(target) > THRESHOLD_MILLI_AMP) {
+				exceededWithModel++;
+				break;
+			}
+			model.learn(target, measure(load, target));
+		}
+	}
+
+	cout << "Loads that exceeded the threshold without prediction: " << exceededWithoutModel
+		 << ", with prediction: " << exceededWithModel
+		 << " (" << rejected << " changes done with the relay instead)" << endl;
+	cout << "Fade updates per change with soft on speed: " << double(softOnUpdates) / dimmedCount
+		 << ", with predicted step size: " << double(updates) / dimmedCount << endl;
+	assert(exceededWithModel * 2 < exceededWithoutModel);
+	assert(updates < softOnUpdates);
+}
+
+int main() {
+	srand(1);
+	testPrediction();
+	testTrips();
+	return 0;
+}
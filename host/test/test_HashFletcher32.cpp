@@ -61,6 +61,18 @@ int main() {
 		return -1;
 	}
 
+	// combined computation, also with odd lengths:
+	for (size_t split = 0; split <= sizeof(test3); split += 2) {
+		for (size_t len = split; len <= sizeof(test3); ++len) {
+			uint32_t fletch_head = Fletcher(test3, split);
+			uint32_t fletch_tail = Fletcher(test3 + split, len - split);
+			if (FletcherCombine(fletch_head, fletch_tail, len - split) != Fletcher(test3, len)) {
+				LOGe("Fletcher test combine broken, split=%u len=%u", split, len);
+				return -1;
+			}
+		}
+	}
+
 	fflush(stdout);
 
 	return 0;
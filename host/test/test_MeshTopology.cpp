@@ -0,0 +1,333 @@
+/**
+ * Feeds mesh messages to the mesh topology, and checks:
+ * - The RSSI quantisation.
+ * - That a digest is only sent when the RSSI changed enough, and when a neighbour is lost.
+ * - That the old neighbour RSSI message is only sent while a crownstone with older firmware is heard, and that the
+ *   old message of a crownstone that sends the digest is ignored.
+ * - That the hash index finds all neighbours, also with colliding IDs, and after neighbours are removed.
+ * - That the neighbours keep their timeout when others are removed from the list.
+ * - That the received links are kept, and that the full topology can be sent over UART.
+ */
+
+#include <boards/cs_HostBoardFullyFeatured.h>
+#include <events/cs_EventDispatcher.h>
+#include <events/cs_EventListener.h>
+#include <mesh/cs_MeshMsgEvent.h>
+#include <storage/cs_State.h>
+#include <testaccess/cs_MeshTopology.h>
+#include <uart/cs_UartHandler.h>
+
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+using Access = TestAccess<MeshTopology>;
+
+/**
+ * Keeps up the mesh messages that are sent.
+ */
+class MeshRecorder : public EventListener {
+public:
+	struct sent_msg_t {
+		cs_mesh_model_msg_type_t type;
+		vector<uint8_t> payload;
+	};
+
+	vector<sent_msg_t> _sent;
+
+	void handleEvent(event_t& event) override {
+		if (event.type != CS_TYPE::CMD_SEND_MESH_MSG) {
+			return;
+		}
+		auto msg = CS_TYPE_CAST(CMD_SEND_MESH_MSG, event.data);
+		_sent.push_back({msg->type, {msg->payload, msg->payload + msg->size}});
+		event.result.returnCode = ERR_SUCCESS;
+	}
+
+	int count(cs_mesh_model_msg_type_t type) {
+		int result = 0;
+		for (auto& msg : _sent) {
+			result += (msg.type == type);
+		}
+		return result;
+	}
+
+	/**
+	 * Returns the last sent digest that has a link with given neighbour ID.
+	 */
+	bool getLastLink(stone_id_t neighbourId, cs_mesh_model_neighbour_rssi_link_t& link) {
+		for (auto iter = _sent.rbegin(); iter != _sent.rend(); ++iter) {
+			if (iter->type != CS_MESH_MODEL_TYPE_NEIGHBOUR_RSSI_DIGEST) {
+				continue;
+			}
+			assert(iter->payload.size() == sizeof(cs_mesh_model_msg_neighbour_rssi_digest_t));
+			cs_mesh_model_msg_neighbour_rssi_digest_t digest;
+			memcpy(&digest, iter->payload.data(), sizeof(digest));
+			for (auto& digestLink : digest.links) {
+				if (digestLink.neighbourId == neighbourId) {
+					link = digestLink;
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+};
+
+void receiveMeshMsg(stone_id_t srcId, int8_t rssi, cs_mesh_model_msg_type_t type, vector<uint8_t> payload) {
+	MeshMsgEvent msg;
+	msg.type            = type;
+	msg.msg             = cs_data_t(payload.data(), payload.size());
+	msg.srcStoneId      = srcId;
+	msg.macAddressValid = false;
+	msg.rssi            = rssi;
+	msg.channel         = 37;
+	msg.isMaybeRelayed  = false;
+	msg.isReply         = false;
+	event_t event(CS_TYPE::EVT_RECV_MESH_MSG, &msg, sizeof(msg));
+	event.dispatch();
+}
+
+void receiveNoop(stone_id_t srcId, int8_t rssi) {
+	receiveMeshMsg(srcId, rssi, CS_MESH_MODEL_TYPE_CMD_NOOP, {});
+}
+
+/**
+ * Receive a digest, relayed, from the given stone.
+ */
+void receiveDigest(stone_id_t srcId, stone_id_t neighbourId0, uint8_t rssi0, stone_id_t neighbourId1, uint8_t rssi1) {
+	cs_mesh_model_msg_neighbour_rssi_digest_t digest = {};
+	digest.links[0].neighbourId                      = neighbourId0;
+	digest.links[0].rssi.channel37                   = rssi0;
+	digest.links[1].neighbourId                      = neighbourId1;
+	digest.links[1].rssi.channel37                   = rssi1;
+	auto data = reinterpret_cast<uint8_t*>(&digest);
+	receiveMeshMsg(srcId, -90, CS_MESH_MODEL_TYPE_NEIGHBOUR_RSSI_DIGEST, {data, data + sizeof(digest)});
+}
+
+void tickSeconds(MeshTopology& topology, uint16_t seconds) {
+	for (uint16_t i = 0; i < seconds; ++i) {
+		Access::tickSecond(topology);
+	}
+}
+
+void testQuantisation() {
+	assert(Access::quantiseRssi(0) == 0);
+	assert(Access::dequantiseRssi(0) == 0);
+	assert(Access::quantiseRssi(MeshTopology::RSSI_QUANTISATION_MIN) == 1);
+	assert(Access::quantiseRssi(-127) == 1);
+	assert(Access::quantiseRssi(-1) == 31);
+	for (int rssi = MeshTopology::RSSI_QUANTISATION_MIN; rssi < -10; ++rssi) {
+		uint8_t quantised = Access::quantiseRssi(rssi);
+		assert(quantised >= 1 && quantised <= 31);
+		int8_t dequantised = Access::dequantiseRssi(quantised);
+		assert(dequantised <= rssi && rssi - dequantised < MeshTopology::RSSI_QUANTISATION_STEP);
+	}
+	cout << "Quantisation OK" << endl;
+}
+
+void testDigest(MeshTopology& topology, MeshRecorder& recorder) {
+	cs_mesh_model_neighbour_rssi_link_t link;
+
+	// A new neighbour is sent.
+	receiveNoop(3, -60);
+	assert(Access::sendDigest(topology, false));
+	assert(recorder.getLastLink(3, link));
+	assert(link.rssi.channel37 == Access::quantiseRssi(-60));
+	assert(link.rssi.channel38 == 0 && link.rssi.channel39 == 0);
+
+	// Nothing changed.
+	assert(!Access::sendDigest(topology, false));
+
+	// A change of 1 step is not sent, a change of DIGEST_RSSI_THRESHOLD steps is.
+	receiveNoop(3, -60 + MeshTopology::RSSI_QUANTISATION_STEP);
+	assert(!Access::sendDigest(topology, false));
+	int8_t changedRssi = -60 + MeshTopology::DIGEST_RSSI_THRESHOLD * MeshTopology::RSSI_QUANTISATION_STEP;
+	receiveNoop(3, changedRssi);
+	assert(Access::sendDigest(topology, false));
+	assert(recorder.getLastLink(3, link));
+	assert(link.rssi.channel37 == Access::quantiseRssi(changedRssi));
+
+	// The old message is not sent while no crownstone with older firmware is heard.
+	tickSeconds(topology, MeshTopology::SEND_INTERVAL_SECONDS_PER_NEIGHBOUR_FAST);
+	assert(recorder.count(CS_MESH_MODEL_TYPE_NEIGHBOUR_RSSI) == 0);
+	cout << "Digest OK" << endl;
+}
+
+void receiveLegacy(stone_id_t srcId, stone_id_t neighbourId) {
+	cs_mesh_model_msg_neighbour_rssi_t legacy = {
+			.type               = 0,
+			.neighbourId        = neighbourId,
+			.rssiChannel37      = -70,
+			.rssiChannel38      = 0,
+			.rssiChannel39      = 0,
+			.lastSeenSecondsAgo = 0,
+			.counter            = 0};
+	auto data = reinterpret_cast<uint8_t*>(&legacy);
+	receiveMeshMsg(srcId, -90, CS_MESH_MODEL_TYPE_NEIGHBOUR_RSSI, {data, data + sizeof(legacy)});
+}
+
+void testLegacy(MeshTopology& topology, MeshRecorder& recorder) {
+	receiveNoop(3, -60);
+
+	// The old message of a crownstone that sends the digest is ignored, the digest has the same links.
+	uint16_t linkCount = Access::getLinkCount(topology);
+	receiveDigest(20, 21, 10, 22, 10);
+	assert(Access::getLinkCount(topology) == linkCount + 2);
+	receiveLegacy(20, 23);
+	assert(Access::getLinkCount(topology) == linkCount + 2);
+	tickSeconds(topology, MeshTopology::SEND_INTERVAL_SECONDS_PER_NEIGHBOUR_FAST);
+	assert(recorder.count(CS_MESH_MODEL_TYPE_NEIGHBOUR_RSSI) == 0);
+
+	// A crownstone with older firmware: its link is kept, and the old message is sent.
+	receiveLegacy(30, 31);
+	assert(Access::getLinkCount(topology) == linkCount + 3);
+	tickSeconds(topology, MeshTopology::SEND_INTERVAL_SECONDS_PER_NEIGHBOUR_FAST);
+	int legacyCount = recorder.count(CS_MESH_MODEL_TYPE_NEIGHBOUR_RSSI);
+	assert(legacyCount > 0);
+
+	// Until it isn't heard for a while.
+	for (int minute = 0; minute < MeshTopology::LEGACY_TIMEOUT_MINUTES; ++minute) {
+		receiveNoop(3, -60);
+		tickSeconds(topology, 60);
+	}
+	legacyCount = recorder.count(CS_MESH_MODEL_TYPE_NEIGHBOUR_RSSI);
+	receiveNoop(3, -60);
+	tickSeconds(topology, MeshTopology::SEND_INTERVAL_SECONDS_PER_NEIGHBOUR_FAST);
+	assert(recorder.count(CS_MESH_MODEL_TYPE_NEIGHBOUR_RSSI) == legacyCount);
+	cout << "Legacy OK" << endl;
+}
+
+void testRemoval(MeshTopology& topology, MeshRecorder& recorder) {
+	cs_mesh_model_neighbour_rssi_link_t link;
+
+	// A lost neighbour is sent with empty RSSI.
+	tickSeconds(topology, MeshTopology::TIMEOUT_SECONDS);
+	assert(Access::getNeighbourCount(topology) == 0);
+	assert(recorder.getLastLink(3, link));
+	assert(link.rssi.channel37 == 0 && link.rssi.channel38 == 0 && link.rssi.channel39 == 0);
+	cout << "Removal OK" << endl;
+}
+
+void testIndex(MeshTopology& topology) {
+	// Bucket of ID 1 + NEIGHBOUR_INDEX_SIZE collides with that of ID 1.
+	vector<stone_id_t> ids;
+	for (stone_id_t id = 1; id < MeshTopology::MAX_NEIGHBOURS; ++id) {
+		ids.push_back(id);
+	}
+	ids.push_back(129);
+	for (auto id : ids) {
+		receiveNoop(id, -70);
+	}
+	assert(Access::getNeighbourCount(topology) == MeshTopology::MAX_NEIGHBOURS);
+
+	// The list is full.
+	receiveNoop(200, -70);
+	assert(Access::find(topology, 200) == Access::INDEX_NOT_FOUND);
+
+	for (auto id : ids) {
+		uint8_t index = Access::find(topology, id);
+		assert(index != Access::INDEX_NOT_FOUND);
+		assert(Access::getNeighbourId(topology, index) == id);
+	}
+
+	// Let the odd IDs time out, except for 129.
+	tickSeconds(topology, MeshTopology::TIMEOUT_SECONDS - 1);
+	for (auto id : ids) {
+		if (id % 2 == 0 || id == 129) {
+			receiveNoop(id, -70);
+		}
+	}
+	tickSeconds(topology, 1);
+	for (auto id : ids) {
+		uint8_t index = Access::find(topology, id);
+		if (id % 2 == 0 || id == 129) {
+			assert(index != Access::INDEX_NOT_FOUND);
+			assert(Access::getNeighbourId(topology, index) == id);
+		}
+		else {
+			assert(index == Access::INDEX_NOT_FOUND);
+		}
+	}
+	cout << "Index OK" << endl;
+}
+
+void testLinks(MeshTopology& topology) {
+	uint16_t linkCount = Access::getLinkCount(topology);
+
+	receiveDigest(100, 101, 10, 102, 10);
+	assert(Access::getLinkCount(topology) == linkCount + 2);
+
+	// Same link is updated, a lost link is removed.
+	receiveDigest(100, 101, 12, 102, 0);
+	assert(Access::getLinkCount(topology) == linkCount + 1);
+
+	// The old message is kept as well.
+	receiveLegacy(110, 111);
+	assert(Access::getLinkCount(topology) == linkCount + 2);
+
+	// The topology doesn't fit in a single UART message.
+	for (stone_id_t id = 150; id < 200; ++id) {
+		receiveDigest(id, id + 1, 10, id + 2, 10);
+	}
+	uint16_t totalLinkCount = Access::getNeighbourCount(topology) + Access::getLinkCount(topology);
+	assert(totalLinkCount * sizeof(mesh_topology_link_uart_t) > UART_TX_MAX_PAYLOAD_SIZE);
+	assert(Access::sendMatrixToUart(topology) == ERR_SUCCESS);
+	cout << "Links OK" << endl;
+}
+
+void testTimeoutAfterRemoval(MeshTopology& topology) {
+	tickSeconds(topology, MeshTopology::TIMEOUT_SECONDS);
+	assert(Access::getNeighbourCount(topology) == 0);
+
+	// IDs 11 to 20 are last seen 10 seconds later, and are moved to the front of the list when 1 to 10 time out.
+	for (stone_id_t id = 1; id <= 20; ++id) {
+		receiveNoop(id, -70);
+	}
+	tickSeconds(topology, 10);
+	for (stone_id_t id = 11; id <= 20; ++id) {
+		receiveNoop(id, -70);
+	}
+	assert(Access::getLastSeenSecondsAgo(topology, Access::find(topology, 1)) == 10);
+	assert(Access::getLastSeenSecondsAgo(topology, Access::find(topology, 11)) == 0);
+
+	for (uint16_t second = 1; second <= MeshTopology::TIMEOUT_SECONDS; ++second) {
+		tickSeconds(topology, 1);
+		for (stone_id_t id = 1; id <= 20; ++id) {
+			uint16_t secondsLeft = (id <= 10) ? MeshTopology::TIMEOUT_SECONDS - 10 : MeshTopology::TIMEOUT_SECONDS;
+			bool found           = Access::find(topology, id) != Access::INDEX_NOT_FOUND;
+			assert(found == (second < secondsLeft));
+		}
+	}
+	assert(Access::getNeighbourCount(topology) == 0);
+	cout << "Timeout after removal OK" << endl;
+}
+
+int main() {
+	boards_config_t board;
+	init(&board);
+	asHostFullyFeatured(&board);
+	Storage::getInstance().init();
+	State::getInstance().init(&board);
+
+	TYPIFY(CONFIG_CROWNSTONE_ID) myId = 250;
+	State::getInstance().set(CS_TYPE::CONFIG_CROWNSTONE_ID, &myId, sizeof(myId));
+
+	MeshTopology topology;
+	assert(topology.init() == ERR_SUCCESS);
+
+	MeshRecorder recorder;
+	recorder.listen();
+
+	testQuantisation();
+	testDigest(topology, recorder);
+	testLegacy(topology, recorder);
+	testRemoval(topology, recorder);
+	testIndex(topology);
+	testLinks(topology);
+	testTimeoutAfterRemoval(topology);
+	return 0;
+}
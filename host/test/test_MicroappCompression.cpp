@@ -0,0 +1,207 @@
+/**
+ * Round-trips a corpus of microapps through LzCompressor and LzDecompressor, the way a compressed upload is
+ * decompressed into flash, and reports the compression ratios.
+ *
+ * The corpus consists of generated microapps: Thumb-like code with literal pools and strings. Microapp binaries can
+ * be added to the corpus by passing their paths as arguments.
+ */
+
+#include <protocol/cs_MicroappPackets.h>
+#include <utils/cs_LzCompressor.h>
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+struct corpus_item_t {
+	string name;
+	vector<uint8_t> binary;
+};
+
+void appendHalfWord(vector<uint8_t>& binary, uint16_t value) {
+	binary.push_back(value & 0xFF);
+	binary.push_back(value >> 8);
+}
+
+void appendWord(vector<uint8_t>& binary, uint32_t value) {
+	appendHalfWord(binary, value & 0xFFFF);
+	appendHalfWord(binary, value >> 16);
+}
+
+/**
+ * Generates a binary that looks like a microapp.
+ *
+ * Compiled code repeats itself: the same instruction sequences show up all over the binary, with some differences in
+ * registers, immediates and branch offsets. So the functions are made of a set of instruction sequences, each with
+ * a random variation, followed by a literal pool. The binary ends with some strings.
+ */
+vector<uint8_t> generateMicroapp(uint32_t functionCount, uint32_t seed) {
+	srand(seed);
+	vector<uint8_t> binary(sizeof(microapp_binary_header_t), 0);
+	const char* strings[] = {"Setup done", "Loop %u", "Presence changed: %i", "Switch to %u%%", "Temperature=%i"};
+
+	// Instruction sequences, the last instruction gets a random variation.
+	vector<vector<uint16_t>> sequences = {
+			{0x4B00, 0x681B, 0x2B00, 0xD000},  // ldr r3, [pc]; ldr r3, [r3]; cmp r3, #0; beq
+			{0x2200, 0x2100, 0x0020, 0xF000},  // movs r2, #0; movs r1, #0; movs r0, r4; bl
+			{0x6863, 0x3301, 0x6063, 0x2000},  // ldr r3, [r4, #4]; adds r3, #1; str r3, [r4, #4]; movs r0, #imm
+			{0x0028, 0xF000},                  // movs r0, r5; bl
+			{0x4A00, 0x6813, 0x6000},          // ldr r2, [pc]; ldr r3, [r2]; str
+			{0x2800, 0xD100},                  // cmp r0, #0; bne
+			{0x0003, 0x0011, 0x4800},          // movs r3, r0; movs r1, r2; ldr r0, [pc]
+			{0xE000},                          // b
+	};
+
+	for (uint32_t function = 0; function < functionCount; ++function) {
+		appendHalfWord(binary, 0xB570);  // push {r4-r6, lr}
+		appendHalfWord(binary, 0x0004);  // movs r4, r0
+		uint32_t sequenceCount = 2 + rand() % 10;
+		for (uint32_t i = 0; i < sequenceCount; ++i) {
+			auto& sequence = sequences[rand() % sequences.size()];
+			for (size_t j = 0; j + 1 < sequence.size(); ++j) {
+				appendHalfWord(binary, sequence[j]);
+			}
+			if (sequence.back() == 0xF000) {
+				// bl: the offset depends on the location of the call.
+				appendHalfWord(binary, 0xF000 | (rand() % 0x800));
+				appendHalfWord(binary, 0xF800 | (rand() % 0x800));
+			}
+			else {
+				appendHalfWord(binary, sequence.back() | (rand() % 16));
+			}
+		}
+		appendHalfWord(binary, 0xBD70);  // pop {r4-r6, pc}
+		while (binary.size() % 4 != 0) {
+			appendHalfWord(binary, 0x46C0);  // nop
+		}
+
+		// Literal pool: addresses of RAM, flash and peripherals.
+		uint32_t literalCount = rand() % 3;
+		for (uint32_t i = 0; i < literalCount; ++i) {
+			uint32_t bases[] = {0x20000000, 0x00070000, 0x40000000};
+			appendWord(binary, bases[rand() % 3] + 4 * (rand() % 64));
+		}
+	}
+
+	for (auto str : strings) {
+		binary.insert(binary.end(), str, str + strlen(str) + 1);
+	}
+	while (binary.size() % 4 != 0) {
+		binary.push_back(0);
+	}
+
+	// The checksums are not filled in: they don't matter for compression.
+	microapp_binary_header_t header = {};
+	header.sdkVersionMajor          = MICROAPP_SDK_MAJOR;
+	header.sdkVersionMinor          = MICROAPP_SDK_MINOR;
+	header.size                     = binary.size();
+	header.startOffset              = sizeof(header);
+	memcpy(binary.data(), &header, sizeof(header));
+	return binary;
+}
+
+/**
+ * Decompresses like a compressed upload: the compressed data comes in chunks, and the output is flushed to flash
+ * whenever the output buffer is full.
+ */
+vector<uint8_t> decompressLikeUpload(const vector<uint8_t>& compressed, uint16_t chunkSize, size_t flashSize) {
+	vector<uint8_t> flash(flashSize, 0xFF);
+	uint8_t buffer[MICROAPP_UPLOAD_MAX_CHUNK_SIZE];
+	LzDecompressor decompressor;
+	decompressor.init(flash.data(), buffer, sizeof(buffer));
+
+	auto flush = [&]() {
+		assert(decompressor.getFlushedSize() + decompressor.getBufferedSize() <= flash.size());
+		memcpy(flash.data() + decompressor.getFlushedSize(), buffer, decompressor.getBufferedSize());
+		decompressor.onBufferFlushed();
+	};
+
+	for (uint32_t offset = 0; offset < compressed.size(); offset += chunkSize) {
+		uint16_t size = std::min<uint32_t>(chunkSize, compressed.size() - offset);
+		uint16_t done = 0;
+		while (done < size) {
+			uint16_t consumed     = 0;
+			cs_ret_code_t retCode = decompressor.decompress(compressed.data() + offset + done, size - done, consumed);
+			done += consumed;
+			if (retCode == ERR_BUFFER_TOO_SMALL) {
+				flush();
+				continue;
+			}
+			assert(retCode == ERR_SUCCESS);
+		}
+	}
+	// The input may end with a match that didn't fit in the buffer.
+	uint16_t consumed = 0;
+	while (decompressor.decompress(nullptr, 0, consumed) == ERR_BUFFER_TOO_SMALL) {
+		flush();
+	}
+	flush();
+	assert(!decompressor.isInToken());
+
+	flash.resize(decompressor.getFlushedSize());
+	return flash;
+}
+
+vector<uint8_t> readFile(const string& path) {
+	ifstream file(path, ios::binary);
+	if (!file) {
+		cout << "Failed to open " << path << endl;
+		exit(1);
+	}
+	return vector<uint8_t>(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+}
+
+int main(int argc, char* argv[]) {
+	vector<corpus_item_t> corpus;
+	corpus.push_back({"small", generateMicroapp(20, 1)});
+	corpus.push_back({"medium", generateMicroapp(100, 2)});
+	corpus.push_back({"large", generateMicroapp(250, 3)});
+	corpus.push_back({"empty", vector<uint8_t>()});
+	corpus.push_back({"erased", vector<uint8_t>(4096, 0xFF)});
+	for (int i = 1; i < argc; ++i) {
+		corpus.push_back({argv[i], readFile(argv[i])});
+	}
+
+	LzCompressor compressor;
+	uint32_t totalSize           = 0;
+	uint32_t totalCompressedSize = 0;
+	for (auto& item : corpus) {
+		vector<uint8_t> compressed = compressor.compress(item.binary);
+		uint16_t chunkSize         = MICROAPP_UPLOAD_MAX_CHUNK_SIZE;
+		for (auto size : {chunkSize, uint16_t(1), uint16_t(7)}) {
+			if (decompressLikeUpload(compressed, size, item.binary.size()) != item.binary) {
+				cout << "Round trip of " << item.name << " failed with chunk size " << size << endl;
+				return 1;
+			}
+		}
+		totalSize += item.binary.size();
+		totalCompressedSize += compressed.size();
+		cout << item.name << ": size=" << item.binary.size() << " compressed=" << compressed.size();
+		if (!item.binary.empty()) {
+			cout << " ratio=" << double(compressed.size()) / item.binary.size();
+		}
+		cout << endl;
+	}
+	cout << "Total: size=" << totalSize << " compressed=" << totalCompressedSize
+		 << " ratio=" << double(totalCompressedSize) / totalSize << endl;
+
+	// Code should compress, and erased flash should compress well.
+	assert(totalCompressedSize < totalSize);
+	assert(compressor.compress(vector<uint8_t>(4096, 0xFF)).size() < 128);
+
+	// A match before the start of the output is rejected.
+	uint8_t invalid[] = {0, 'a', LZ_MATCH_FLAG, 2, 0};
+	uint8_t buffer[16];
+	LzDecompressor decompressor;
+	decompressor.init(nullptr, buffer, sizeof(buffer));
+	uint16_t consumed = 0;
+	assert(decompressor.decompress(invalid, sizeof(invalid), consumed) == ERR_INVALID_MESSAGE);
+	return 0;
+}
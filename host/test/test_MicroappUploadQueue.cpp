@@ -0,0 +1,369 @@
+/**
+ * Uploads microapps through MicroappUploadQueue to a simulated flash, and checks that chunks only get written to
+ * erased flash, and that the flash ends up with the app.
+ *
+ * Then compares the upload time with the way it used to be: remove erases all pages of the app, and the result of
+ * each chunk waits until the chunk is written. The flash timing is the nRF52 datasheet maximum, the BLE client sends
+ * the next chunk at the connection event after the one with the result.
+ */
+
+#include <microapp/cs_MicroappUploadQueue.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+constexpr uint32_t WORD_WRITE_US = 41;
+constexpr uint32_t PAGE_ERASE_US = 85000;
+
+/**
+ * Executes flash operations one after the other, like fstorage does.
+ */
+class SimulatedFlash : public MicroappUploadFlash {
+public:
+	static constexpr uint8_t QUEUE_SIZE = 4;
+
+	vector<uint8_t> content             = vector<uint8_t>(MICROAPP_MAX_SIZE, 0);
+
+	/**
+	 * Queue to report done operations to, or nullptr to report the result of every operation.
+	 */
+	MicroappUploadQueue* uploadQueue    = nullptr;
+
+	/**
+	 * Offset of the write that fails, or -1.
+	 */
+	int failingWriteOffset              = -1;
+
+	uint64_t nowUs                      = 0;
+
+	bool isPageErased(uint8_t page) override {
+		auto begin = content.begin() + page * CS_FLASH_PAGE_SIZE;
+		return all_of(begin, begin + CS_FLASH_PAGE_SIZE, [](uint8_t byte) { return byte == 0xFF; });
+	}
+
+	cs_ret_code_t queueErase(uint8_t page) override { return queueErasePages(page, 1); }
+
+	cs_ret_code_t queueErasePages(uint8_t page, uint8_t pageCount) {
+		return push({true, (uint16_t)(page * CS_FLASH_PAGE_SIZE), nullptr, (uint16_t)(pageCount * CS_FLASH_PAGE_SIZE)});
+	}
+
+	cs_ret_code_t queueWrite(uint16_t offset, const uint8_t* data, uint16_t size) override {
+		return push({false, offset, data, size});
+	}
+
+	size_t getQueueSize() const { return _operations.size(); }
+
+	/**
+	 * Execute the operations that are done by given time.
+	 */
+	void runUntil(uint64_t timeUs) {
+		while (!_operations.empty() && _operations.front().doneUs <= timeUs) {
+			complete();
+		}
+		nowUs = max(nowUs, timeUs);
+	}
+
+	/**
+	 * Execute operations until there is a result.
+	 *
+	 * @return true when there is a result.
+	 */
+	bool runUntilResult() {
+		while (!_hasResult && !_operations.empty()) {
+			complete();
+		}
+		return _hasResult;
+	}
+
+	cs_ret_code_t takeResult(uint64_t& resultUs) {
+		assert(_hasResult);
+		_hasResult = false;
+		resultUs   = _resultUs;
+		return _result;
+	}
+
+private:
+	struct operation_t {
+		bool erase;
+		uint16_t offset;
+		const uint8_t* data;
+		uint16_t size;
+		uint64_t doneUs;
+	};
+
+	deque<operation_t> _operations;
+	bool _hasResult       = false;
+	cs_ret_code_t _result = ERR_SUCCESS;
+	uint64_t _resultUs    = 0;
+
+	uint64_t getDurationUs(const operation_t& operation) {
+		if (operation.erase) {
+			return operation.size / CS_FLASH_PAGE_SIZE * PAGE_ERASE_US;
+		}
+		return operation.size / 4 * WORD_WRITE_US;
+	}
+
+	cs_ret_code_t push(operation_t operation) {
+		if (_operations.size() == QUEUE_SIZE) {
+			return ERR_BUSY;
+		}
+		if (_operations.empty()) {
+			operation.doneUs = nowUs + getDurationUs(operation);
+		}
+		_operations.push_back(operation);
+		return ERR_SUCCESS;
+	}
+
+	void complete() {
+		operation_t operation = _operations.front();
+		_operations.pop_front();
+		nowUs                = max(nowUs, operation.doneUs);
+		cs_ret_code_t result = ERR_SUCCESS;
+		if (operation.erase) {
+			memset(content.data() + operation.offset, 0xFF, operation.size);
+		}
+		else if (operation.offset == failingWriteOffset) {
+			result = ERR_WRITE_NOT_ALLOWED;
+		}
+		else {
+			for (uint16_t i = 0; i < operation.size; ++i) {
+				// Flash can only be written when erased.
+				assert(content[operation.offset + i] == 0xFF);
+				content[operation.offset + i] = operation.data[i];
+			}
+		}
+		if (!_operations.empty()) {
+			_operations.front().doneUs = nowUs + getDurationUs(_operations.front());
+		}
+
+		if (uploadQueue != nullptr) {
+			result = operation.erase ? uploadQueue->onEraseDone(result) : uploadQueue->onWriteDone(result);
+		}
+		if (result != ERR_WAIT_FOR_SUCCESS) {
+			assert(!_hasResult);
+			_hasResult = true;
+			_result    = result;
+			_resultUs  = nowUs;
+		}
+	}
+};
+
+/**
+ * Generates a binary of given size, with the size in the header set to headerSize.
+ */
+vector<uint8_t> generateMicroapp(uint16_t size, uint32_t seed, uint16_t headerSize) {
+	srand(seed);
+	vector<uint8_t> binary(size);
+	for (auto& byte : binary) {
+		byte = rand() % 256;
+	}
+	microapp_binary_header_t* header = reinterpret_cast<microapp_binary_header_t*>(binary.data());
+	header->size                     = headerSize;
+	return binary;
+}
+
+uint16_t getChunkSize(const vector<uint8_t>& binary, uint16_t offset) {
+	return min<size_t>(MICROAPP_UPLOAD_MAX_CHUNK_SIZE, binary.size() - offset);
+}
+
+/**
+ * Write a chunk the way the command handler does: from a buffer that's reused by the next command.
+ */
+cs_ret_code_t writeChunk(MicroappUploadQueue& queue, const vector<uint8_t>& binary, uint16_t offset) {
+	static uint8_t commandBuffer[MICROAPP_UPLOAD_MAX_CHUNK_SIZE];
+	uint16_t size = getChunkSize(binary, offset);
+	memcpy(commandBuffer, binary.data() + offset, size);
+	cs_ret_code_t result = queue.writeChunk(offset, commandBuffer, size);
+	memset(commandBuffer, 0xAA, sizeof(commandBuffer));
+	return result;
+}
+
+/**
+ * Returns the time of the connection event after given time.
+ */
+uint64_t getNextConnectionEventUs(uint64_t timeUs, uint64_t intervalUs) {
+	return (timeUs / intervalUs + 1) * intervalUs;
+}
+
+struct upload_time_t {
+	uint64_t removeUs;
+	uint64_t totalUs;
+	uint32_t busyCount;
+};
+
+/**
+ * Remove the app that's in flash, then upload the binary.
+ *
+ * @param[in] queued     Whether to upload via the upload queue, or the way it used to be.
+ */
+upload_time_t removeAndUpload(const vector<uint8_t>& binary, uint64_t intervalUs, bool queued) {
+	SimulatedFlash flash;
+	MicroappUploadQueue queue(flash);
+	upload_time_t time = {};
+
+	// Remove.
+	if (queued) {
+		if (!flash.isPageErased(0)) {
+			assert(flash.queueErase(0) == ERR_SUCCESS);
+		}
+	}
+	else {
+		assert(flash.queueErasePages(0, MICROAPP_MAX_SIZE / CS_FLASH_PAGE_SIZE) == ERR_SUCCESS);
+	}
+	uint64_t resultUs = 0;
+	assert(flash.runUntilResult());
+	assert(flash.takeResult(resultUs) == ERR_SUCCESS);
+	time.removeUs   = getNextConnectionEventUs(resultUs, intervalUs);
+	uint64_t sendUs = getNextConnectionEventUs(time.removeUs, intervalUs);
+
+	// Upload.
+	flash.uploadQueue = queued ? &queue : nullptr;
+	if (queued) {
+		assert(queue.start() == ERR_SUCCESS);
+	}
+	uint16_t offset = 0;
+	while (offset < binary.size()) {
+		flash.runUntil(sendUs);
+		cs_ret_code_t result = ERR_SUCCESS;
+		if (queued) {
+			result = writeChunk(queue, binary, offset);
+		}
+		else {
+			result = flash.queueWrite(offset, binary.data() + offset, getChunkSize(binary, offset));
+			assert(result == ERR_SUCCESS);
+			result = ERR_WAIT_FOR_SUCCESS;
+		}
+		resultUs = sendUs;
+		if (result == ERR_WAIT_FOR_SUCCESS) {
+			assert(flash.runUntilResult());
+			result = flash.takeResult(resultUs);
+		}
+		switch (result) {
+			case ERR_SUCCESS: offset += getChunkSize(binary, offset); break;
+			case ERR_BUSY: time.busyCount++; break;
+			default: assert(false);
+		}
+		time.totalUs = getNextConnectionEventUs(resultUs, intervalUs);
+		sendUs       = getNextConnectionEventUs(time.totalUs, intervalUs);
+	}
+
+	// The result of the last chunk is only returned when everything is written, so the app can be validated.
+	assert(flash.getQueueSize() == 0);
+	assert(queue.getQueuedOperationCount() == 0);
+	assert(equal(binary.begin(), binary.end(), flash.content.begin()));
+	return time;
+}
+
+void testUploadTimes() {
+	cout << "App size (B)  Interval (ms)  Before: remove + upload (ms)  After: remove + upload (ms)  Resends" << endl;
+	for (uint16_t appSize : {(uint16_t)2048, (uint16_t)(MICROAPP_MAX_SIZE / 2 + 100), MICROAPP_MAX_SIZE}) {
+		vector<uint8_t> binary = generateMicroapp(appSize, appSize, appSize);
+		for (uint64_t intervalUs : {7500, 15000, 30000}) {
+			upload_time_t before = removeAndUpload(binary, intervalUs, false);
+			upload_time_t after  = removeAndUpload(binary, intervalUs, true);
+			cout << appSize << "  " << intervalUs / 1000.0 << "  " << before.removeUs / 1000 << " + "
+				 << (before.totalUs - before.removeUs) / 1000 << " = " << before.totalUs / 1000 << "  "
+				 << after.removeUs / 1000 << " + " << (after.totalUs - after.removeUs) / 1000 << " = "
+				 << after.totalUs / 1000 << "  " << after.busyCount << endl;
+			assert(after.totalUs < before.totalUs);
+		}
+	}
+}
+
+void testWritesOnlyToErasedFlash() {
+	SimulatedFlash flash;
+	MicroappUploadQueue queue(flash);
+	flash.uploadQueue = &queue;
+
+	// Page 0 still has the previous app.
+	assert(queue.start() == ERR_WRITE_DISABLED);
+	assert(!queue.isNextChunk(0));
+
+	// Only the header page is erased by a remove, the other pages are erased while uploading.
+	memset(flash.content.data(), 0xFF, CS_FLASH_PAGE_SIZE);
+	assert(queue.start() == ERR_SUCCESS);
+	vector<uint8_t> binary = generateMicroapp(MICROAPP_MAX_SIZE, 1, MICROAPP_MAX_SIZE);
+	assert(writeChunk(queue, binary, 256) == ERR_WRONG_STATE);
+	uint16_t offset = 0;
+	while (offset < binary.size()) {
+		cs_ret_code_t result = writeChunk(queue, binary, offset);
+		if (result == ERR_WAIT_FOR_SUCCESS) {
+			// A next chunk has to wait for the result.
+			assert(writeChunk(queue, binary, offset + getChunkSize(binary, offset)) == ERR_BUSY);
+			uint64_t resultUs = 0;
+			assert(flash.runUntilResult());
+			result = flash.takeResult(resultUs);
+		}
+		if (result == ERR_BUSY) {
+			// The flash queue is full, try again later.
+			flash.runUntil(flash.nowUs + PAGE_ERASE_US);
+			continue;
+		}
+		assert(result == ERR_SUCCESS);
+		offset += getChunkSize(binary, offset);
+	}
+	assert(equal(binary.begin(), binary.end(), flash.content.begin()));
+}
+
+void testUnknownSize() {
+	SimulatedFlash flash;
+	MicroappUploadQueue queue(flash);
+	flash.uploadQueue = &queue;
+	memset(flash.content.data(), 0xFF, CS_FLASH_PAGE_SIZE);
+	assert(queue.start() == ERR_SUCCESS);
+
+	// Without a valid size in the header, every chunk waits until it's written.
+	vector<uint8_t> binary = generateMicroapp(CS_FLASH_PAGE_SIZE + 512, 2, 0);
+	for (uint16_t offset = 0; offset < binary.size(); offset += MICROAPP_UPLOAD_MAX_CHUNK_SIZE) {
+		assert(writeChunk(queue, binary, offset) == ERR_WAIT_FOR_SUCCESS);
+		uint64_t resultUs = 0;
+		assert(flash.runUntilResult());
+		assert(flash.takeResult(resultUs) == ERR_SUCCESS);
+		assert(queue.getQueuedOperationCount() == 0);
+	}
+	assert(equal(binary.begin(), binary.end(), flash.content.begin()));
+}
+
+void testDeferredError() {
+	SimulatedFlash flash;
+	MicroappUploadQueue queue(flash);
+	flash.uploadQueue = &queue;
+	memset(flash.content.data(), 0xFF, flash.content.size());
+	flash.failingWriteOffset = 256;
+	assert(queue.start() == ERR_SUCCESS);
+
+	vector<uint8_t> binary = generateMicroapp(512, 3, 512);
+	assert(writeChunk(queue, binary, 0) == ERR_SUCCESS);
+	assert(writeChunk(queue, binary, 256) == ERR_WAIT_FOR_SUCCESS);
+
+	// The last chunk waits for all writes, so the failed write is its result.
+	uint64_t resultUs = 0;
+	assert(flash.runUntilResult());
+	assert(flash.takeResult(resultUs) == ERR_WRITE_NOT_ALLOWED);
+	assert(!queue.isNextChunk(512));
+
+	// A failure without pending result is returned by the next chunk.
+	memset(flash.content.data(), 0xFF, flash.content.size());
+	flash.failingWriteOffset = 0;
+	assert(queue.start() == ERR_SUCCESS);
+	assert(writeChunk(queue, binary, 0) == ERR_SUCCESS);
+	flash.runUntil(flash.nowUs + PAGE_ERASE_US);
+	assert(!flash.runUntilResult());
+	assert(writeChunk(queue, binary, 256) == ERR_WRITE_NOT_ALLOWED);
+	assert(!queue.isNextChunk(256));
+}
+
+int main() {
+	testWritesOnlyToErasedFlash();
+	testUnknownSize();
+	testDeferredError();
+	testUploadTimes();
+	return 0;
+}
@@ -1,10 +1,193 @@
+/**
+ * Simulates nodes with drifting clocks, that synchronize to a root clock via sync messages,
+ * like SystemTime does, and checks how well they stay in sync.
+ */
+
+#include <time/cs_ClockDriftEstimator.h>
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
+#include <vector>
+
+using namespace std;
+
+constexpr uint32_t BASE_SYNC_PERIOD_MS        = 20 * 60 * 1000;
+constexpr uint8_t MAX_SYNC_PERIOD_SHIFT       = 1;
+constexpr uint32_t TIME_UPDATE_PERIOD_MS      = 60 * 1000;
+constexpr uint32_t STEP_MS                    = 1000;
+
+// Start the local clocks just before overflow.
+constexpr uint32_t LOCAL_START_MS             = 0xFFFFFFFF - 60 * 60 * 1000;
+constexpr uint64_t ROOT_START_MS              = 1600000000ULL * 1000;
+
+struct node_t {
+	// How much faster the local clock goes than the root clock, in ppm.
+	double driftPpm;
+	bool correctDrift;
+
+	ClockDriftEstimator estimator;
+
+	// Like SystemTime: the root time at the last update, and the local time of the last update.
+	uint64_t rootMs;
+	uint32_t localMsOfLastUpdate;
+
+	uint64_t maxErrorMs = 0;
+
+	uint32_t localMs(uint64_t trueMs) const {
+		double elapsedMs = (trueMs - ROOT_START_MS) * (1.0 + driftPpm / 1e6);
+		return LOCAL_START_MS + static_cast<uint32_t>(static_cast<uint64_t>(elapsedMs));
+	}
+
+	// Like SystemTime::onTimeSyncMessageReceive().
+	void onSyncMessage(uint64_t stampMs, uint64_t trueMs) {
+		uint32_t local = localMs(trueMs);
+		if (correctDrift) {
+			estimator.addSample(local, stampMs);
+		}
+		rootMs              = stampMs;
+		localMsOfLastUpdate = local;
+		estimator.clearRemainder();
+	}
+
+	// Like SystemTime::updateRootTimeStamp().
+	void update(uint64_t trueMs) {
+		uint32_t local      = localMs(trueMs);
+		rootMs += estimator.advance(local - localMsOfLastUpdate);
+		localMsOfLastUpdate = local;
+	}
+
+	// Like SystemTime::getSynchronizedStamp().
+	uint64_t getSynchronizedMs(uint64_t trueMs) const {
+		return rootMs + estimator.correct(localMs(trueMs) - localMsOfLastUpdate);
+	}
+};
+
+/**
+ * Runs a scenario, returns the max error of all nodes, after the given settle time.
+ *
+ * @param[in] latencyJitterMs      Max random latency of sync messages.
+ * @param[in] adaptivePeriod       Whether the root lengthens the sync period.
+ */
+uint64_t runScenario(
+		vector<double> driftsPpm,
+		bool correctDrift,
+		uint32_t latencyJitterMs,
+		bool adaptivePeriod,
+		uint32_t durationMs,
+		uint32_t settleMs,
+		int& syncMessageCount) {
+	vector<node_t> nodes;
+	for (auto drift : driftsPpm) {
+		node_t node;
+		node.driftPpm            = drift;
+		node.correctDrift        = correctDrift;
+		node.rootMs              = ROOT_START_MS;
+		node.localMsOfLastUpdate = node.localMs(ROOT_START_MS);
+		nodes.push_back(node);
+	}
 
-//#include <time/cs_SystemTime.h>
+	uint8_t periodShift          = 0;
+	int messagesAtShift          = 0;
+	uint64_t nextSyncMs          = ROOT_START_MS;
+	syncMessageCount             = 0;
+
+	for (uint64_t trueMs = ROOT_START_MS; trueMs < ROOT_START_MS + durationMs; trueMs += STEP_MS) {
+		if (trueMs >= nextSyncMs) {
+			// The root sends its time, nodes receive it after some latency.
+			syncMessageCount++;
+			for (auto& node : nodes) {
+				uint64_t latencyMs = latencyJitterMs ? rand() % (latencyJitterMs + 1) : 0;
+				node.onSyncMessage(trueMs - latencyMs, trueMs);
+			}
+			if (adaptivePeriod && periodShift < MAX_SYNC_PERIOD_SHIFT
+				&& ++messagesAtShift >= ClockDriftEstimator::MIN_SAMPLE_COUNT) {
+				periodShift++;
+				messagesAtShift = 0;
+			}
+			nextSyncMs += BASE_SYNC_PERIOD_MS << periodShift;
+		}
+
+		for (auto& node : nodes) {
+			if (node.localMs(trueMs) - node.localMsOfLastUpdate >= TIME_UPDATE_PERIOD_MS) {
+				node.update(trueMs);
+			}
+			if (trueMs - ROOT_START_MS < settleMs) {
+				continue;
+			}
+			uint64_t syncedMs = node.getSynchronizedMs(trueMs);
+			uint64_t errorMs  = (syncedMs > trueMs) ? syncedMs - trueMs : trueMs - syncedMs;
+			if (errorMs > node.maxErrorMs) {
+				node.maxErrorMs = errorMs;
+			}
+		}
+	}
+
+	uint64_t maxErrorMs = 0;
+	for (auto& node : nodes) {
+		if (node.maxErrorMs > maxErrorMs) {
+			maxErrorMs = node.maxErrorMs;
+		}
+	}
+	return maxErrorMs;
+}
+
+void testMultiNodeDrift() {
+	// Typical crystal drift, and one node running on the RC oscillator.
+	vector<double> driftsPpm = {-40, -20, -5, 0, 3, 10, 25, 50, -250, 250};
+	constexpr uint32_t DAY_MS    = 24 * 60 * 60 * 1000;
+	// Let the drift estimates converge first.
+	constexpr uint32_t SETTLE_MS = 6 * 60 * 60 * 1000;
+	int fixedCount;
+	int adaptiveCount;
+
+	uint64_t fixedErrorMs = runScenario(driftsPpm, false, 0, false, DAY_MS, SETTLE_MS, fixedCount);
+	cout << "Without drift correction, fixed period: max error " << fixedErrorMs << " ms, " << fixedCount
+		 << " sync messages" << endl;
+
+	uint64_t correctedErrorMs = runScenario(driftsPpm, true, 0, true, DAY_MS, SETTLE_MS, adaptiveCount);
+	cout << "With drift correction, adaptive period: max error " << correctedErrorMs << " ms, " << adaptiveCount
+		 << " sync messages" << endl;
+
+	// The stamps and local clocks have ms resolution, both round down, so the nodes should stay within 2 ms of the
+	// root clock.
+	assert(correctedErrorMs <= 2);
+	assert(fixedErrorMs > 100);
+	assert(adaptiveCount * 3 < fixedCount * 2);
+
+	uint64_t jitterErrorMs = runScenario(driftsPpm, true, 5, true, DAY_MS, SETTLE_MS, adaptiveCount);
+	cout << "With drift correction and 5 ms latency jitter: max error " << jitterErrorMs << " ms" << endl;
+
+	// The error is dominated by the latency of the last sync message.
+	assert(jitterErrorMs <= 5 + 2);
+}
+
+void testJump() {
+	ClockDriftEstimator estimator;
+	uint32_t localMs = 0;
+	uint64_t rootMs  = ROOT_START_MS;
+	for (int i = 0; i < ClockDriftEstimator::SAMPLE_COUNT; ++i) {
+		estimator.addSample(localMs, rootMs);
+		localMs += BASE_SYNC_PERIOD_MS;
+		rootMs += BASE_SYNC_PERIOD_MS + 20;
+	}
+	cout << "Drift estimate: " << estimator.getDriftPpb() << " ppb" << endl;
+	assert(estimator.getSampleCount() == ClockDriftEstimator::SAMPLE_COUNT);
+	assert(abs(estimator.getDriftPpb() - 16667) <= 1);
+
+	// The root clock jumps: all samples should be discarded.
+	estimator.addSample(localMs, rootMs + 60 * 1000);
+	assert(estimator.getSampleCount() == 1);
+	assert(estimator.getDriftPpb() == 0);
+	assert(estimator.correct(1000) == 1000);
+}
 
 int main() {
 	std::cout << "SystemTimeSync" << std::endl;
 
-	//	SystemTime t1; // TODO
+	srand(1);
+	testMultiNodeDrift();
+	testJump();
 	return 0;
 }
@@ -0,0 +1,84 @@
+/**
+ * Stores the time stamp like a soft reset does, simulates the reboot, and checks that:
+ * - The restored time includes the duration of the reboot.
+ * - The restored time keeps advancing.
+ * - A stamp without valid version is not restored.
+ */
+
+#include <boards/cs_HostBoardFullyFeatured.h>
+#include <storage/cs_State.h>
+#include <testaccess/cs_SystemTime.h>
+
+#include <cassert>
+#include <iostream>
+
+using namespace std;
+
+constexpr uint32_t START_TIME_S   = 1600000000;
+constexpr uint32_t RTC_STARTUP_MS = 1500;
+
+uint64_t toMs(const high_resolution_time_stamp_t& stamp) {
+	return static_cast<uint64_t>(stamp.posix_s) * 1000 + stamp.posix_ms;
+}
+
+/**
+ * The RTC restarts from 0 at a soft reset, and counts the time since the firmware started.
+ */
+void reboot(uint32_t startupMs) {
+	RTC::offsetMs(-static_cast<int>(RTC::ticksToMs(RTC::getCount())));
+	RTC::offsetMs(startupMs);
+}
+
+void testRestore() {
+	TestAccess<SystemTime>::setTime(Time(START_TIME_S));
+	TestAccess<SystemTime>::fastForwardS(10);
+
+	// Like storeWarmBootData(), just before the reset.
+	RTC::offsetMs(250);
+	high_resolution_time_stamp_t stored = SystemTime::getSynchronizedStamp();
+	assert(stored.posix_s == START_TIME_S + 10);
+	assert(stored.version >= 1);
+
+	reboot(RTC_STARTUP_MS);
+	SystemTime::restoreTime(stored);
+
+	uint64_t expectedMs = toMs(stored) + RTC_STARTUP_MS + WARM_BOOT_BOOTLOADER_DURATION_MS;
+	uint64_t restoredMs = toMs(SystemTime::getSynchronizedStamp());
+	cout << "stored=" << toMs(stored) << " restored=" << restoredMs << " expected=" << expectedMs << endl;
+	// Allow for rounding of the RTC ticks.
+	assert(restoredMs + 2 >= expectedMs && restoredMs <= expectedMs + 2);
+	assert(SystemTime::posix() == restoredMs / 1000);
+
+	TestAccess<SystemTime>::fastForwardS(5);
+	cout << endl;
+	uint64_t advancedMs = toMs(SystemTime::getSynchronizedStamp());
+	assert(advancedMs + 2 >= restoredMs + 5000 && advancedMs <= restoredMs + 5000 + 2);
+	assert(SystemTime::posix() >= START_TIME_S + 10 + 5 + RTC_STARTUP_MS / 1000);
+	cout << "Restore OK" << endl;
+}
+
+void testInvalid() {
+	uint32_t before = SystemTime::posix();
+	high_resolution_time_stamp_t stamp;
+	stamp.posix_s = START_TIME_S;
+	stamp.version = 0;
+	SystemTime::restoreTime(stamp);
+	assert(SystemTime::posix() == before);
+	cout << "Invalid OK" << endl;
+}
+
+int main() {
+	boards_config_t board;
+	init(&board);
+	asHostFullyFeatured(&board);
+	Storage::getInstance().init();
+	State::getInstance().init(&board);
+
+	RTC::freeze();
+	SystemTime systemTime;
+	systemTime.init();
+
+	testRestore();
+	testInvalid();
+	return 0;
+}
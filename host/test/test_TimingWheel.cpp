@@ -0,0 +1,149 @@
+/**
+ * Checks that the timing wheel expires timers at the same tick as a countdown per record would,
+ * and compares the cost per tick of both, for a growing number of records.
+ */
+
+#include <util/cs_TimingWheel.h>
+
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+constexpr uint8_t MAX_TIMERS = 254;
+
+/**
+ * The way components used to keep up timeouts: a countdown per record, decremented every tick.
+ */
+struct countdown_record_t {
+	uint32_t countdown = 0;
+	int expiredCount   = 0;
+};
+
+uint32_t randomDelay() {
+	switch (rand() % 4) {
+		case 0: return rand() % 20;
+		case 1: return rand() % 300;
+		case 2: return rand() % 10000;
+		default: return rand() % 100000;
+	}
+}
+
+void testMatchesCountdowns() {
+	TimingWheel<MAX_TIMERS> wheel;
+	vector<countdown_record_t> records(MAX_TIMERS);
+	vector<int> expiredCount(MAX_TIMERS, 0);
+
+	for (uint32_t tick = 0; tick < 1000000; ++tick) {
+		// Randomly schedule, reschedule and cancel timers.
+		if (rand() % 4 == 0) {
+			uint8_t index = rand() % MAX_TIMERS;
+			if (rand() % 5 == 0) {
+				wheel.cancel(index);
+				records[index].countdown = 0;
+			}
+			else {
+				uint32_t delay = randomDelay();
+				wheel.schedule(index, delay);
+				records[index].countdown = (delay == 0) ? 1 : delay;
+			}
+		}
+
+		for (uint8_t i = 0; i < MAX_TIMERS; ++i) {
+			auto& record = records[i];
+			if (record.countdown != 0 && --record.countdown == 0) {
+				record.expiredCount++;
+			}
+		}
+
+		wheel.tick([&](uint8_t index) {
+			assert(!wheel.isScheduled(index));
+			expiredCount[index]++;
+		});
+
+		bool empty = true;
+		for (uint8_t i = 0; i < MAX_TIMERS; ++i) {
+			assert(wheel.remaining(i) == records[i].countdown);
+			assert(wheel.isScheduled(i) == (records[i].countdown != 0));
+			assert(expiredCount[i] == records[i].expiredCount);
+			empty = empty && (records[i].countdown == 0);
+		}
+		assert(wheel.isEmpty() == empty);
+	}
+}
+
+void testRescheduleOnExpire() {
+	TimingWheel<1> wheel;
+	int expiredCount = 0;
+	wheel.schedule(0, 5);
+	for (int tick = 0; tick < 5000; ++tick) {
+		wheel.tick([&](uint8_t index) {
+			expiredCount++;
+			wheel.schedule(index, 5);
+		});
+	}
+	assert(expiredCount == 1000);
+}
+
+/**
+ * Records that are refreshed before they time out, like presence records and assets that keep being seen.
+ * Returns the time per tick in ns of the countdowns and the timing wheel.
+ */
+void benchmark(uint8_t recordCount, double& countdownNs, double& wheelNs) {
+	constexpr uint32_t TICKS         = 200000;
+	constexpr uint32_t TIMEOUT_TICKS = 250;
+	TimingWheel<MAX_TIMERS> wheel;
+	vector<countdown_record_t> records(recordCount);
+	for (uint8_t i = 0; i < recordCount; ++i) {
+		records[i].countdown = TIMEOUT_TICKS;
+		wheel.schedule(i, TIMEOUT_TICKS);
+	}
+
+	// Refresh some records every tick, so that some time out now and then.
+	vector<uint8_t> refreshes(TICKS);
+	for (auto& refresh : refreshes) {
+		refresh = rand() % recordCount;
+	}
+
+	int countdownExpiredCount = 0;
+	auto start                = chrono::steady_clock::now();
+	for (uint32_t tick = 0; tick < TICKS; ++tick) {
+		records[refreshes[tick]].countdown = TIMEOUT_TICKS;
+		for (auto& record : records) {
+			if (record.countdown != 0 && --record.countdown == 0) {
+				countdownExpiredCount++;
+			}
+		}
+	}
+	auto middle          = chrono::steady_clock::now();
+
+	int wheelExpiredCount = 0;
+	for (uint32_t tick = 0; tick < TICKS; ++tick) {
+		wheel.schedule(refreshes[tick], TIMEOUT_TICKS);
+		wheel.tick([&](uint8_t) { wheelExpiredCount++; });
+	}
+	auto end = chrono::steady_clock::now();
+
+	assert(countdownExpiredCount == wheelExpiredCount);
+	countdownNs = chrono::duration<double, nano>(middle - start).count() / TICKS;
+	wheelNs     = chrono::duration<double, nano>(end - middle).count() / TICKS;
+}
+
+int main() {
+	srand(1);
+	testMatchesCountdowns();
+	testRescheduleOnExpire();
+
+	cout << "records  countdown ns/tick  wheel ns/tick" << endl;
+	for (uint8_t recordCount : {8, 16, 32, 64, 128, 254}) {
+		double countdownNs;
+		double wheelNs;
+		benchmark(recordCount, countdownNs, wheelNs);
+		cout << int(recordCount) << "  " << countdownNs << "  " << wheelNs << endl;
+	}
+	return 0;
+}
@@ -0,0 +1,78 @@
+/**
+ * Creates a delta patch from the installed application to a new application, for a delta firmware update.
+ *
+ * Usage: delta_patch <base.bin> <target.bin> <patch.bin>
+ *
+ * The patch is applied again, in place, to verify it results in the target.
+ * The patch has to be packaged like a normal application update: the bootloader recognizes it by its header.
+ */
+
+#include <utils/cs_DeltaPatchEncoder.h>
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+using namespace std;
+
+bool readFile(const char* path, vector<uint8_t>& data) {
+	ifstream file(path, ios::binary);
+	if (!file) {
+		cout << "Failed to open " << path << endl;
+		return false;
+	}
+	data.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+	return true;
+}
+
+int main(int argc, char* argv[]) {
+	if (argc != 4) {
+		cout << "Usage: " << argv[0] << " <base.bin> <target.bin> <patch.bin>" << endl;
+		return 1;
+	}
+
+	vector<uint8_t> base;
+	vector<uint8_t> target;
+	if (!readFile(argv[1], base) || !readFile(argv[2], target)) {
+		return 1;
+	}
+
+	DeltaPatchEncoder encoder;
+	vector<uint8_t> patch = encoder.encode(base, target);
+
+	// Verify, like the bootloader: page by page, over the base.
+	const uint16_t pageSize = 4096;
+	vector<uint8_t> flash(max(base.size(), target.size()) + pageSize, 0xFF);
+	copy(base.begin(), base.end(), flash.begin());
+	cs_delta_patch_t state;
+	if (deltaPatchInit(&state, patch.data(), patch.size(), flash.data(), pageSize) != DELTA_PATCH_SUCCESS
+		|| deltaPatchVerifyBase(&state, base.size()) != DELTA_PATCH_SUCCESS) {
+		cout << "Failed to verify patch" << endl;
+		return 1;
+	}
+	vector<uint8_t> page(pageSize);
+	uint32_t offset = 0;
+	uint32_t size   = 0;
+	DeltaPatchRetCode retCode;
+	while ((retCode = deltaPatchNextPage(&state, page.data(), &offset, &size)) == DELTA_PATCH_SUCCESS) {
+		copy(page.begin(), page.begin() + size, flash.begin() + offset);
+	}
+	if (retCode != DELTA_PATCH_DONE || !equal(target.begin(), target.end(), flash.begin())) {
+		cout << "Patched base differs from target" << endl;
+		return 1;
+	}
+
+	ofstream outputFile(argv[3], ios::binary);
+	outputFile.write(reinterpret_cast<const char*>(patch.data()), patch.size());
+	if (!outputFile) {
+		cout << "Failed to write " << argv[3] << endl;
+		return 1;
+	}
+	cout << "base=" << base.size() << " target=" << target.size() << " patch=" << patch.size();
+	if (!target.empty()) {
+		cout << " ratio=" << double(patch.size()) / target.size();
+	}
+	cout << endl;
+	return 0;
+}
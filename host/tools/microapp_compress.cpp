@@ -0,0 +1,70 @@
+/**
+ * Compresses a microapp binary, for a compressed upload.
+ *
+ * Usage: microapp_compress <input.bin> <output.bin>
+ *
+ * The output is decompressed again, to verify it results in the input.
+ */
+
+#include <utils/cs_LzCompressor.h>
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+	if (argc != 3) {
+		cout << "Usage: " << argv[0] << " <input.bin> <output.bin>" << endl;
+		return 1;
+	}
+
+	ifstream inputFile(argv[1], ios::binary);
+	if (!inputFile) {
+		cout << "Failed to open " << argv[1] << endl;
+		return 1;
+	}
+	vector<uint8_t> input((istreambuf_iterator<char>(inputFile)), istreambuf_iterator<char>());
+	if (input.size() > UINT16_MAX) {
+		// The size field in the microapp header is 16 bit.
+		cout << "Input too large: " << input.size() << endl;
+		return 1;
+	}
+
+	LzCompressor compressor;
+	vector<uint8_t> output = compressor.compress(input);
+
+	// Verify, with a buffer that is large enough to hold all output.
+	vector<uint8_t> decompressed(input.size());
+	LzDecompressor decompressor;
+	decompressor.init(decompressed.data(), decompressed.data(), decompressed.size());
+	uint32_t consumedSize = 0;
+	while (consumedSize < output.size()) {
+		uint16_t size     = std::min<size_t>(output.size() - consumedSize, UINT16_MAX);
+		uint16_t consumed = 0;
+		if (decompressor.decompress(output.data() + consumedSize, size, consumed) != ERR_SUCCESS) {
+			cout << "Failed to decompress" << endl;
+			return 1;
+		}
+		consumedSize += consumed;
+	}
+	if (decompressed != input || decompressor.isInToken()) {
+		cout << "Decompressed output differs from input" << endl;
+		return 1;
+	}
+
+	ofstream outputFile(argv[2], ios::binary);
+	outputFile.write(reinterpret_cast<const char*>(output.data()), output.size());
+	if (!outputFile) {
+		cout << "Failed to write " << argv[2] << endl;
+		return 1;
+	}
+	cout << "size=" << input.size() << " compressed=" << output.size();
+	if (!input.empty()) {
+		cout << " ratio=" << double(output.size()) / input.size();
+	}
+	cout << endl;
+	return 0;
+}
@@ -0,0 +1,133 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <storage/cs_GarbageCollectionPolicy.h>
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+struct flash_emulator_stats_t {
+	//! Number of records written on request, so not by garbage collection.
+	uint32_t recordWrites   = 0;
+	//! Number of words of data requested to be written, excluding headers.
+	uint32_t dataWords      = 0;
+	//! Number of words programmed: record headers and data, page tags, and records moved by garbage collection.
+	uint32_t wordsWritten   = 0;
+	uint32_t wordsMovedByGc = 0;
+	uint32_t gcCount        = 0;
+	uint32_t pageErases     = 0;
+};
+
+/**
+ * Emulates how FDS lays out records in flash pages, to measure flash wear on host.
+ *
+ * Only the layout is emulated, the data itself is not stored.
+ * Each page starts with a page tag. Records are appended to the first data page with enough space, and consist of a
+ * header and the data. When a record is updated, the new version is written, and the old version is marked as
+ * deleted, which programs a word of its header. Garbage collection copies the valid records of each page with deleted
+ * records to the swap page, after which the page is erased and becomes the new swap page.
+ */
+class FlashEmulator {
+public:
+	static constexpr uint16_t PAGE_TAG_WORDS      = 2;
+	static constexpr uint16_t RECORD_HEADER_WORDS = 3;
+
+	/**
+	 * Typical number of times a page can be erased, for the nRF52.
+	 */
+	static constexpr uint32_t PAGE_ERASE_ENDURANCE = 10000;
+
+	static FlashEmulator& getInstance() {
+		static FlashEmulator instance;
+		return instance;
+	}
+
+	/**
+	 * @param[in] pageCount       Number of pages, including the swap page. Same as CS_FDS_VIRTUAL_PAGES by default.
+	 * @param[in] pageWords       Number of words per page. Same as CS_FDS_VIRTUAL_PAGE_SIZE by default.
+	 */
+	FlashEmulator(uint16_t pageCount = 4, uint16_t pageWords = 1024);
+
+	/**
+	 * Erase all pages. The erases are counted, the other stats are kept.
+	 */
+	void eraseAll();
+
+	/**
+	 * Write a record, and mark the previous version of the record as deleted.
+	 *
+	 * @return False when there is no page with enough space.
+	 */
+	bool write(uint16_t recordKey, uint16_t fileId, uint16_t dataWords);
+
+	/**
+	 * Mark a record as deleted. Does nothing when the record doesn't exist.
+	 */
+	void remove(uint16_t recordKey, uint16_t fileId);
+
+	void garbageCollect();
+
+	storage_usage_t getUsage() const;
+
+	const flash_emulator_stats_t& getStats() const { return _stats; }
+
+	void resetStats();
+
+	/**
+	 * Get the number of records with given record key written on request, since the stats were reset.
+	 */
+	uint32_t getRecordWriteCount(uint16_t recordKey) const;
+
+	/**
+	 * Get the number of times the most erased page has been erased.
+	 */
+	uint32_t getMaxPageEraseCount() const;
+
+	/**
+	 * Words written per word of data that was requested to be written.
+	 */
+	double getWriteAmplification() const;
+
+private:
+	struct emulated_record_t {
+		uint16_t recordKey;
+		uint16_t fileId;
+		uint16_t words;
+		bool valid;
+	};
+
+	struct emulated_page_t {
+		std::vector<emulated_record_t> records;
+		uint16_t writtenWords = 0;
+		uint16_t dirtyWords   = 0;
+		uint32_t eraseCount   = 0;
+	};
+
+	uint16_t _pageWords;
+
+	/**
+	 * Physical pages, one of them is the swap page.
+	 */
+	std::vector<emulated_page_t> _pages;
+
+	uint16_t _swapPage = 0;
+
+	flash_emulator_stats_t _stats;
+
+	std::map<uint16_t, uint32_t> _recordWritesPerKey;
+
+	void erase(emulated_page_t& page);
+
+	/**
+	 * Program the page tag of an erased page.
+	 */
+	void writePageTag(emulated_page_t& page);
+
+	void markDeleted(emulated_page_t& page, emulated_record_t& record);
+};
@@ -0,0 +1,143 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <drivers/cs_FlashEmulator.h>
+
+FlashEmulator::FlashEmulator(uint16_t pageCount, uint16_t pageWords) : _pageWords(pageWords), _pages(pageCount) {
+	eraseAll();
+	resetStats();
+}
+
+void FlashEmulator::eraseAll() {
+	for (auto& page : _pages) {
+		erase(page);
+	}
+	_swapPage = 0;
+	for (uint16_t i = 0; i < _pages.size(); ++i) {
+		if (i != _swapPage) {
+			writePageTag(_pages[i]);
+		}
+	}
+}
+
+bool FlashEmulator::write(uint16_t recordKey, uint16_t fileId, uint16_t dataWords) {
+	uint16_t words = RECORD_HEADER_WORDS + dataWords;
+	for (uint16_t i = 0; i < _pages.size(); ++i) {
+		emulated_page_t& page = _pages[i];
+		if (i == _swapPage || _pageWords - page.writtenWords < words) {
+			continue;
+		}
+		// FDS deletes the previous version after the new version has been written, but the layout ends up the same.
+		remove(recordKey, fileId);
+		page.records.push_back(emulated_record_t{recordKey, fileId, words, true});
+		page.writtenWords += words;
+		_stats.wordsWritten += words;
+		_stats.recordWrites++;
+		_recordWritesPerKey[recordKey]++;
+		_stats.dataWords += dataWords;
+		return true;
+	}
+	return false;
+}
+
+void FlashEmulator::remove(uint16_t recordKey, uint16_t fileId) {
+	for (auto& page : _pages) {
+		for (auto& record : page.records) {
+			if (record.valid && record.recordKey == recordKey && record.fileId == fileId) {
+				markDeleted(page, record);
+			}
+		}
+	}
+}
+
+void FlashEmulator::garbageCollect() {
+	_stats.gcCount++;
+	for (uint16_t i = 0; i < _pages.size(); ++i) {
+		emulated_page_t& page = _pages[i];
+		if (i == _swapPage || page.dirtyWords == 0) {
+			continue;
+		}
+		emulated_page_t& swap = _pages[_swapPage];
+		writePageTag(swap);
+		for (auto& record : page.records) {
+			if (record.valid) {
+				swap.records.push_back(record);
+				swap.writtenWords += record.words;
+				_stats.wordsWritten += record.words;
+				_stats.wordsMovedByGc += record.words;
+			}
+		}
+		erase(page);
+		_swapPage = i;
+	}
+}
+
+storage_usage_t FlashEmulator::getUsage() const {
+	storage_usage_t usage;
+	usage.totalWords = (_pages.size() - 1) * (_pageWords - PAGE_TAG_WORDS);
+	for (uint16_t i = 0; i < _pages.size(); ++i) {
+		if (i == _swapPage) {
+			continue;
+		}
+		const emulated_page_t& page = _pages[i];
+		usage.usedWords += page.writtenWords - PAGE_TAG_WORDS;
+		usage.freeableWords += page.dirtyWords;
+		if (static_cast<uint32_t>(_pageWords - page.writtenWords) > usage.largestFreeWords) {
+			usage.largestFreeWords = _pageWords - page.writtenWords;
+		}
+	}
+	return usage;
+}
+
+uint32_t FlashEmulator::getRecordWriteCount(uint16_t recordKey) const {
+	auto iter = _recordWritesPerKey.find(recordKey);
+	return iter == _recordWritesPerKey.end() ? 0 : iter->second;
+}
+
+void FlashEmulator::resetStats() {
+	_stats = flash_emulator_stats_t();
+	_recordWritesPerKey.clear();
+	for (auto& page : _pages) {
+		page.eraseCount = 0;
+	}
+}
+
+uint32_t FlashEmulator::getMaxPageEraseCount() const {
+	uint32_t maxCount = 0;
+	for (auto& page : _pages) {
+		if (page.eraseCount > maxCount) {
+			maxCount = page.eraseCount;
+		}
+	}
+	return maxCount;
+}
+
+double FlashEmulator::getWriteAmplification() const {
+	if (_stats.dataWords == 0) {
+		return 0;
+	}
+	return static_cast<double>(_stats.wordsWritten) / _stats.dataWords;
+}
+
+void FlashEmulator::erase(emulated_page_t& page) {
+	page.records.clear();
+	page.writtenWords = 0;
+	page.dirtyWords   = 0;
+	page.eraseCount++;
+	_stats.pageErases++;
+}
+
+void FlashEmulator::writePageTag(emulated_page_t& page) {
+	page.writtenWords = PAGE_TAG_WORDS;
+	_stats.wordsWritten += PAGE_TAG_WORDS;
+}
+
+void FlashEmulator::markDeleted(emulated_page_t& page, emulated_record_t& record) {
+	record.valid = false;
+	page.dirtyWords += record.words;
+	_stats.wordsWritten++;
+}
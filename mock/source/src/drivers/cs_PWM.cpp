@@ -12,6 +12,7 @@
 PWM::PWM() : _initialized(false), _started(false), _startOnZeroCrossing(false) {}
 
 uint32_t PWM::init(const pwm_config_t& config) {
+    _config      = config;
     _initialized = true;
     return ERR_SUCCESS;
 }
@@ -41,7 +42,11 @@ uint8_t PWM::getValue(uint8_t channel) {
 
     return 0xff;
 }
-void PWM::onPeriodEnd() {}
+
+pwm_stats_t PWM::getStats() {
+    pwm_stats_t stats = {};
+    return stats;
+}
 
 void PWM::onZeroCrossingInterrupt() {
     assert(_initialized, "not initialized");
@@ -13,21 +13,32 @@ uint32_t nsToTicks(uint64_t ns) {
 	return static_cast<uint32_t>((ns * RTC_CLOCK_FREQ) / 1000000000) % MAX_RTC_COUNTER_VAL;
 }
 
-int RTC::_offsetMs = 0;
+static auto startTime = std::chrono::high_resolution_clock::now();
+
+int64_t RTC::_offsetMs = 0;
+bool RTC::_frozen      = false;
 
 void RTC::offsetMs(int ms) {
 	_offsetMs += ms;
 }
 
+void RTC::freeze() {
+	if (!_frozen) {
+		auto passed = std::chrono::high_resolution_clock::now() - startTime;
+		_offsetMs += std::chrono::duration_cast<std::chrono::milliseconds>(passed).count();
+		_frozen = true;
+	}
+}
+
 void RTC::start() {
 	getCount();
 }
 
 uint32_t RTC::getCount() {
-	static auto starttime = std::chrono::high_resolution_clock::now();
-
-	auto now = std::chrono::high_resolution_clock::now();
-	auto diff = now - starttime + std::chrono::milliseconds(_offsetMs);
+	std::chrono::high_resolution_clock::duration diff = std::chrono::milliseconds(_offsetMs);
+	if (!_frozen) {
+		diff += std::chrono::high_resolution_clock::now() - startTime;
+	}
 	auto rtcDuration = std::chrono::duration_cast<
 			std::chrono::duration<long int, std::ratio<1, RTC_CLOCK_FREQ>>
 		>(diff);
@@ -6,6 +6,7 @@
  */
 
 #include <common/cs_Types.h>
+#include <drivers/cs_FlashEmulator.h>
 #include <drivers/cs_Storage.h>
 #include <events/cs_Event.h>
 #include <logging/cs_Logger.h>
@@ -54,6 +55,23 @@ auto NOT_FOUND() {
  */
 auto lastFound = NOT_FOUND();
 
+/**
+ * To emulate findNextOfAnyType. An index, since reads in between change lastFound.
+ */
+size_t nextOfAnyType = 0;
+
+/**
+ * Emulates the layout in flash, to account for flash wear. The state id is used as file id.
+ */
+bool emulateWrite(const cs_state_data_t& data) {
+	uint16_t dataWords = (data.size + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+	return FlashEmulator::getInstance().write(to_underlying_type(data.type), data.id, dataWords);
+}
+
+void emulateRemove(const cs_state_data_t& data) {
+	FlashEmulator::getInstance().remove(to_underlying_type(data.type), data.id);
+}
+
 /**
  * Implements removal for the different matching predicates.
  */
@@ -66,6 +84,11 @@ cs_ret_code_t _remove(Storage& s, P predicate){
 		return ERR_BUSY;
 	}
 
+	for (auto& data : _storage) {
+		if (predicate(data)) {
+			emulateRemove(data);
+		}
+	}
 	int eraseCount = eraseIf(_storage, predicate);
 
 	if(eraseCount == 0) {
@@ -190,6 +213,15 @@ cs_ret_code_t Storage::write(const cs_state_data_t& data) {
 		return ERR_NOT_INITIALIZED;
 	}
 
+	if (!emulateWrite(data)) {
+		// Like the real storage, garbage is collected when a write finds the flash full.
+		_gcStats.flashFullCount++;
+		garbageCollect();
+		if (!emulateWrite(data)) {
+			return ERR_NO_SPACE;
+		}
+	}
+
 	int removeCount = eraseIf(_storage, equalTo(data));
 	if(removeCount) {
 		LOGd("removed %u old entrie(s)", removeCount);
@@ -203,6 +235,7 @@ cs_ret_code_t Storage::write(const cs_state_data_t& data) {
 
 cs_ret_code_t Storage::eraseAllPages() {
 	_storage.clear();
+	FlashEmulator::getInstance().eraseAll();
 	return ERR_SUCCESS;
 }
 
@@ -237,6 +270,21 @@ cs_ret_code_t Storage::findNext(CS_TYPE type, cs_state_id_t& id) {
 	return _findFrom(type, id, searchFrom);
 }
 
+cs_ret_code_t Storage::findFirstOfAnyType(CS_TYPE& type, cs_state_id_t& id) {
+	nextOfAnyType = 0;
+	return findNextOfAnyType(type, id);
+}
+
+cs_ret_code_t Storage::findNextOfAnyType(CS_TYPE& type, cs_state_id_t& id) {
+	if (nextOfAnyType >= _storage.size()) {
+		return ERR_NOT_FOUND;
+	}
+	type = _storage[nextOfAnyType].type;
+	id = _storage[nextOfAnyType].id;
+	nextOfAnyType++;
+	return ERR_SUCCESS;
+}
+
 cs_ret_code_t Storage::remove(CS_TYPE type, cs_state_id_t id) {
 	return _remove(*this, matchIdType(id, type));
 }
@@ -277,7 +325,7 @@ cs_ret_code_t Storage::readNext(cs_state_data_t& data) {
 
 	auto searchFrom = lastFound;
 	searchFrom++;
-	return _readFrom(*this, data, std::begin(_storage));
+	return _readFrom(*this, data, searchFrom);
 }
 
 cs_ret_code_t Storage::readV3ResetCounter(cs_state_data_t& data) {
@@ -359,7 +407,23 @@ void Storage::setErrorCallback(cs_storage_error_callback_t callback) {
 }
 
 cs_ret_code_t Storage::garbageCollect() {
-	// TODO: not implemented
+	// Garbage collection is instant, so no event is sent.
+	FlashEmulator::getInstance().garbageCollect();
+	_gcStats.count++;
+	return ERR_SUCCESS;
+}
+
+cs_ret_code_t Storage::garbageCollectIfNeeded(bool idle) {
+	storage_usage_t usage;
+	getUsage(usage);
+	if (!_gcPolicy.shouldCollect(usage, idle)) {
+		return ERR_NOT_AVAILABLE;
+	}
+	return garbageCollect();
+}
+
+cs_ret_code_t Storage::getUsage(storage_usage_t& usage) {
+	usage = FlashEmulator::getInstance().getUsage();
 	return ERR_SUCCESS;
 }
 
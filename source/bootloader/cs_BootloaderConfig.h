@@ -27,3 +27,10 @@ extern const uint8_t g_BOOTLOADER_VERSION_PATCH;
 extern const uint8_t g_BOOTLOADER_VERSION_PRERELEASE;
 
 extern const uint8_t g_BOOTLOADER_BUILD_TYPE;
+
+/*
+ * The application area, see cs_MemoryLayout.h.
+ */
+extern const uint32_t g_APPLICATION_START_ADDRESS;
+
+extern const uint32_t g_APPLICATION_MAX_LENGTH;
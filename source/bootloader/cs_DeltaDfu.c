@@ -0,0 +1,436 @@
+/**
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include "cs_DeltaDfu.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "cs_BootloaderConfig.h"
+#include "dfu/cs_DeltaPatch.h"
+#include "nrf_bootloader_wdt.h"
+#include "nrf_dfu_flash.h"
+#include "nrf_dfu_settings.h"
+#include "nrf_dfu_types.h"
+#include "nrf_dfu_utils.h"
+#include "nrf_log.h"
+#include "nrf_log_ctrl.h"
+
+/*
+ * Layout of the application area while a delta update is applied:
+ *
+ * | base / target | patch (bank 1) | ... | work copy of the patch | ... | journal | scratch (p2p dfu page)
+ *
+ * The target is written over the base, and may grow into bank 1. So the patch is first moved up, to right after the
+ * target. The move is done from the last page to the first, so that it can overlap with bank 1.
+ *
+ * Each target page is first written to the scratch page, then a journal entry is written, and only then the target
+ * page is written. After a reset, the last target page can thus always be restored from the scratch page.
+ */
+
+#define DELTA_DFU_ENTRY_START 0x01
+#define DELTA_DFU_ENTRY_MOVE 0x02
+#define DELTA_DFU_ENTRY_PAGE 0x03
+
+typedef struct {
+	uint32_t type;
+	union {
+		struct {
+			uint32_t patchAddress;
+			uint32_t workAddress;
+			uint32_t patchSize;
+			// CRC32 of the patch, to check the work copy.
+			uint32_t patchCrc;
+		} start;
+		struct {
+			// Number of pages moved so far, starting at the last page.
+			uint32_t movedPageCount;
+		} move;
+		struct {
+			// Progress of the patch, after producing this page.
+			uint32_t outputPageCount;
+			uint32_t patchOffset;
+			uint32_t baseCursor;
+			uint32_t targetOffset;
+			uint32_t size;
+			uint32_t pageCrc;
+		} page;
+	} data;
+	// CRC32 of the fields above.
+	uint32_t crc;
+} delta_dfu_entry_t;
+
+/*
+ * There is at most 1 entry per moved page and per target page. Since the work copy and the target both have to fit
+ * in the application area, this always fits in the journal page.
+ */
+#define DELTA_DFU_JOURNAL_MAX_ENTRIES (CODE_PAGE_SIZE / sizeof(delta_dfu_entry_t))
+
+//! Buffer to produce a target page in.
+static uint8_t m_page_buffer[CODE_PAGE_SIZE] __attribute__((aligned(4)));
+
+static uint32_t alignToPage(uint32_t size) {
+	return (size + CODE_PAGE_SIZE - 1) / CODE_PAGE_SIZE * CODE_PAGE_SIZE;
+}
+
+static uint32_t getJournalAddress(void) {
+	return g_APPLICATION_START_ADDRESS + g_APPLICATION_MAX_LENGTH - CODE_PAGE_SIZE;
+}
+
+static uint32_t getScratchAddress(void) {
+	return g_APPLICATION_START_ADDRESS + g_APPLICATION_MAX_LENGTH;
+}
+
+static const delta_dfu_entry_t* getJournal(void) {
+	return (const delta_dfu_entry_t*)getJournalAddress();
+}
+
+static uint32_t getEntryCrc(const delta_dfu_entry_t* entry) {
+	return deltaPatchCrc32((const uint8_t*)entry, offsetof(delta_dfu_entry_t, crc), 0);
+}
+
+static bool isEntryValid(const delta_dfu_entry_t* entry) {
+	return entry->crc == getEntryCrc(entry);
+}
+
+static bool isEntryErased(const delta_dfu_entry_t* entry) {
+	const uint32_t* words = (const uint32_t*)entry;
+	for (uint32_t i = 0; i < sizeof(*entry) / sizeof(uint32_t); ++i) {
+		if (words[i] != 0xFFFFFFFF) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Get the number of written entries in the journal.
+ *
+ * An entry that was being written during a reset is invalid, and will be skipped.
+ *
+ * @return 0 when there is no journal: the first entry is not a valid start entry.
+ */
+static uint32_t getJournalSize(void) {
+	const delta_dfu_entry_t* journal = getJournal();
+	if (!isEntryValid(&journal[0]) || journal[0].type != DELTA_DFU_ENTRY_START) {
+		return 0;
+	}
+	uint32_t size = 1;
+	while (size < DELTA_DFU_JOURNAL_MAX_ENTRIES && !isEntryErased(&journal[size])) {
+		size++;
+	}
+	return size;
+}
+
+static const delta_dfu_entry_t* findLastEntry(uint32_t type, uint32_t journalSize) {
+	const delta_dfu_entry_t* journal = getJournal();
+	for (uint32_t i = journalSize; i > 0; --i) {
+		if (journal[i - 1].type == type && isEntryValid(&journal[i - 1])) {
+			return &journal[i - 1];
+		}
+	}
+	return NULL;
+}
+
+static bool appendEntry(delta_dfu_entry_t* entry, uint32_t* journalSize) {
+	if (*journalSize >= DELTA_DFU_JOURNAL_MAX_ENTRIES) {
+		return false;
+	}
+	entry->crc       = getEntryCrc(entry);
+	uint32_t address = getJournalAddress() + *journalSize * sizeof(*entry);
+	if (nrf_dfu_flash_store(address, entry, sizeof(*entry), NULL) != NRF_SUCCESS) {
+		return false;
+	}
+	(*journalSize)++;
+	return true;
+}
+
+/**
+ * Erase a page and write data to it.
+ *
+ * The flash is written per word, so data is read up to a multiple of 4 bytes.
+ */
+static bool writePage(uint32_t address, const void* data, uint32_t size) {
+	uint32_t alignedSize = (size + 3) & ~3u;
+	return nrf_dfu_flash_erase(address, 1, NULL) == NRF_SUCCESS
+		   && nrf_dfu_flash_store(address, data, alignedSize, NULL) == NRF_SUCCESS;
+}
+
+/**
+ * Check whether a delta update has been received in bank 1.
+ */
+static bool isDeltaUpdatePending(void) {
+	if (s_dfu_settings.bank_1.bank_code != NRF_DFU_BANK_VALID_APP
+		|| s_dfu_settings.bank_1.image_size < sizeof(cs_delta_patch_header_t)) {
+		return false;
+	}
+	return *(const uint32_t*)s_dfu_settings.progress.update_start_address == CS_DELTA_PATCH_MAGIC;
+}
+
+/**
+ * Decode all pages without writing them, and check the output CRC.
+ */
+static bool verifyPatch(cs_delta_patch_t state) {
+	uint32_t crc    = 0;
+	uint32_t offset = 0;
+	uint32_t size   = 0;
+	enum DeltaPatchRetCode retCode;
+	while ((retCode = deltaPatchNextPage(&state, m_page_buffer, &offset, &size)) == DELTA_PATCH_SUCCESS) {
+		crc = deltaPatchCrc32(m_page_buffer, size, crc);
+		nrf_bootloader_wdt_feed();
+	}
+	return retCode == DELTA_PATCH_DONE && crc == state.header.outputCrc;
+}
+
+/**
+ * Check whether the received delta update can be applied, and start the journal.
+ *
+ * Nothing has been overwritten when this fails.
+ */
+static bool startDeltaUpdate(uint32_t* journalSize) {
+	uint32_t baseAddress  = nrf_dfu_bank0_start_addr();
+	uint32_t baseSize     = s_dfu_settings.bank_0.image_size;
+	uint32_t patchAddress = s_dfu_settings.progress.update_start_address;
+	uint32_t patchSize    = s_dfu_settings.bank_1.image_size;
+
+	if (s_dfu_settings.bank_0.bank_code != NRF_DFU_BANK_VALID_APP) {
+		NRF_LOG_WARNING("Delta update without valid app");
+		return false;
+	}
+	if (patchAddress < baseAddress + alignToPage(baseSize)) {
+		// The patch didn't fit in bank 1, and has been written over the application.
+		NRF_LOG_WARNING("Delta update received in bank 0");
+		nrf_dfu_bank_invalidate(&s_dfu_settings.bank_0);
+		return false;
+	}
+
+	cs_delta_patch_t state;
+	if (deltaPatchInit(&state, (const uint8_t*)patchAddress, patchSize, (const uint8_t*)baseAddress, CODE_PAGE_SIZE)
+		!= DELTA_PATCH_SUCCESS) {
+		NRF_LOG_WARNING("Invalid delta patch header");
+		return false;
+	}
+	if (deltaPatchVerifyBase(&state, baseSize) != DELTA_PATCH_SUCCESS) {
+		NRF_LOG_WARNING("Delta patch is for another app");
+		return false;
+	}
+
+	// The work copy goes right after the target, unless the patch is already there.
+	uint32_t workAddress = baseAddress + alignToPage(state.header.targetSize);
+	if (workAddress < patchAddress) {
+		workAddress = patchAddress;
+	}
+	if (workAddress + alignToPage(patchSize) > getJournalAddress()) {
+		NRF_LOG_WARNING("Delta update doesn't fit");
+		return false;
+	}
+
+	if (!verifyPatch(state)) {
+		NRF_LOG_WARNING("Invalid delta patch");
+		return false;
+	}
+
+	if (nrf_dfu_flash_erase(getJournalAddress(), 1, NULL) != NRF_SUCCESS) {
+		return false;
+	}
+	delta_dfu_entry_t entry       = {0};
+	entry.type                    = DELTA_DFU_ENTRY_START;
+	entry.data.start.patchAddress = patchAddress;
+	entry.data.start.workAddress  = workAddress;
+	entry.data.start.patchSize    = patchSize;
+	entry.data.start.patchCrc     = deltaPatchCrc32((const uint8_t*)patchAddress, patchSize, 0);
+	*journalSize                  = 0;
+	return appendEntry(&entry, journalSize);
+}
+
+/**
+ * Move the patch to the work copy, from the last page to the first.
+ *
+ * A page is only overwritten after it has been moved itself, so the move can be repeated from the last journal
+ * entry.
+ */
+static bool movePatch(const delta_dfu_entry_t* start, uint32_t* journalSize) {
+	uint32_t pageCount             = alignToPage(start->data.start.patchSize) / CODE_PAGE_SIZE;
+	uint32_t movedPageCount        = 0;
+	const delta_dfu_entry_t* moved = findLastEntry(DELTA_DFU_ENTRY_MOVE, *journalSize);
+	if (moved != NULL) {
+		movedPageCount = moved->data.move.movedPageCount;
+	}
+	if (start->data.start.workAddress == start->data.start.patchAddress
+		|| findLastEntry(DELTA_DFU_ENTRY_PAGE, *journalSize) != NULL) {
+		movedPageCount = pageCount;
+	}
+
+	for (uint32_t i = movedPageCount; i < pageCount; ++i) {
+		uint32_t offset = (pageCount - 1 - i) * CODE_PAGE_SIZE;
+		if (!writePage(
+					start->data.start.workAddress + offset,
+					(const void*)(start->data.start.patchAddress + offset),
+					CODE_PAGE_SIZE)) {
+			return false;
+		}
+		delta_dfu_entry_t entry        = {0};
+		entry.type                     = DELTA_DFU_ENTRY_MOVE;
+		entry.data.move.movedPageCount = i + 1;
+		if (!appendEntry(&entry, journalSize)) {
+			return false;
+		}
+		nrf_bootloader_wdt_feed();
+	}
+
+	const uint8_t* work = (const uint8_t*)start->data.start.workAddress;
+	return deltaPatchCrc32(work, start->data.start.patchSize, 0) == start->data.start.patchCrc;
+}
+
+/**
+ * Make sure the target page of a journal entry has been written, by restoring it from the scratch page if needed.
+ */
+static bool restorePage(const delta_dfu_entry_t* entry) {
+	uint32_t targetAddress = nrf_dfu_bank0_start_addr() + entry->data.page.targetOffset;
+	uint32_t size          = entry->data.page.size;
+	if (deltaPatchCrc32((const uint8_t*)targetAddress, size, 0) == entry->data.page.pageCrc) {
+		return true;
+	}
+	NRF_LOG_INFO("Restore page 0x%X", targetAddress);
+	const uint8_t* scratch = (const uint8_t*)getScratchAddress();
+	if (deltaPatchCrc32(scratch, size, 0) != entry->data.page.pageCrc) {
+		return false;
+	}
+	return writePage(targetAddress, scratch, size);
+}
+
+/**
+ * Write the target pages, resuming from the journal.
+ */
+static bool applyDeltaUpdate(uint32_t* journalSize, cs_delta_patch_header_t* header) {
+	const delta_dfu_entry_t* start = &getJournal()[0];
+	if (!movePatch(start, journalSize)) {
+		NRF_LOG_WARNING("Failed to move delta patch");
+		return false;
+	}
+
+	uint32_t baseAddress = nrf_dfu_bank0_start_addr();
+	cs_delta_patch_t state;
+	if (deltaPatchInit(
+				&state,
+				(const uint8_t*)start->data.start.workAddress,
+				start->data.start.patchSize,
+				(const uint8_t*)baseAddress,
+				CODE_PAGE_SIZE)
+		!= DELTA_PATCH_SUCCESS) {
+		return false;
+	}
+
+	const delta_dfu_entry_t* last = findLastEntry(DELTA_DFU_ENTRY_PAGE, *journalSize);
+	if (last != NULL) {
+		if (!restorePage(last)) {
+			NRF_LOG_WARNING("Failed to restore page");
+			return false;
+		}
+		state.outputPageCount = last->data.page.outputPageCount;
+		state.patchOffset     = last->data.page.patchOffset;
+		state.baseCursor      = last->data.page.baseCursor;
+	}
+
+	uint32_t offset = 0;
+	uint32_t size   = 0;
+	enum DeltaPatchRetCode retCode;
+	while ((retCode = deltaPatchNextPage(&state, m_page_buffer, &offset, &size)) == DELTA_PATCH_SUCCESS) {
+		memset(m_page_buffer + size, 0xFF, CODE_PAGE_SIZE - size);
+		delta_dfu_entry_t entry         = {0};
+		entry.type                      = DELTA_DFU_ENTRY_PAGE;
+		entry.data.page.outputPageCount = state.outputPageCount;
+		entry.data.page.patchOffset     = state.patchOffset;
+		entry.data.page.baseCursor      = state.baseCursor;
+		entry.data.page.targetOffset    = offset;
+		entry.data.page.size            = size;
+		entry.data.page.pageCrc         = deltaPatchCrc32(m_page_buffer, size, 0);
+		if (!writePage(getScratchAddress(), m_page_buffer, size) || !appendEntry(&entry, journalSize)
+			|| !writePage(baseAddress + offset, m_page_buffer, size)) {
+			NRF_LOG_WARNING("Failed to write page 0x%X", baseAddress + offset);
+			return false;
+		}
+		nrf_bootloader_wdt_feed();
+	}
+	if (retCode != DELTA_PATCH_DONE) {
+		NRF_LOG_WARNING("Invalid delta patch data");
+		return false;
+	}
+
+	*header = state.header;
+	return deltaPatchCrc32((const uint8_t*)baseAddress, header->targetSize, 0) == header->targetCrc;
+}
+
+/**
+ * Discard the delta update.
+ *
+ * When the application has been (partly) overwritten already, it's invalidated too, so that a full image can be sent.
+ */
+static void failDeltaUpdate(uint32_t journalSize) {
+	nrf_dfu_bank_invalidate(&s_dfu_settings.bank_1);
+	if (findLastEntry(DELTA_DFU_ENTRY_PAGE, journalSize) != NULL) {
+		NRF_LOG_ERROR("Delta update failed, app is invalidated");
+		nrf_dfu_bank_invalidate(&s_dfu_settings.bank_0);
+	}
+	NRF_LOG_FLUSH();
+	UNUSED_RETURN_VALUE(nrf_dfu_settings_write_and_backup(NULL));
+	if (journalSize > 0) {
+		UNUSED_RETURN_VALUE(nrf_dfu_flash_erase(getJournalAddress(), 1, NULL));
+	}
+}
+
+static void finishDeltaUpdate(const cs_delta_patch_header_t* header) {
+	s_dfu_settings.bank_0.image_size = header->targetSize;
+	s_dfu_settings.bank_0.image_crc  = header->targetCrc;
+	s_dfu_settings.bank_0.bank_code  = NRF_DFU_BANK_VALID_APP;
+
+	// The boot validation from the init packet is of the patch, not of the app.
+	s_dfu_settings.boot_validation_app.type = VALIDATE_CRC;
+	memcpy(s_dfu_settings.boot_validation_app.bytes, &header->targetCrc, sizeof(header->targetCrc));
+
+	nrf_dfu_bank_invalidate(&s_dfu_settings.bank_1);
+	memset(&s_dfu_settings.progress, 0, sizeof(s_dfu_settings.progress));
+	s_dfu_settings.write_offset = 0;
+	UNUSED_RETURN_VALUE(nrf_dfu_settings_write_and_backup(NULL));
+
+	// Only erase the journal once the settings are written: until then, a reset resumes and finishes again.
+	UNUSED_RETURN_VALUE(nrf_dfu_flash_erase(getJournalAddress(), 1, NULL));
+}
+
+nrf_bootloader_fw_activation_result_t deltaDfuActivate(void) {
+	uint32_t journalSize = getJournalSize();
+	if (journalSize > 0 && s_dfu_settings.bank_1.bank_code != NRF_DFU_BANK_VALID_APP) {
+		// The delta update has been finished or discarded, but the journal was not erased yet.
+		UNUSED_RETURN_VALUE(nrf_dfu_flash_erase(getJournalAddress(), 1, NULL));
+		journalSize = 0;
+	}
+	if (journalSize == 0) {
+		if (!isDeltaUpdatePending()) {
+			return ACTIVATION_NONE;
+		}
+		NRF_LOG_INFO("Start delta update");
+		NRF_LOG_FLUSH();
+		if (!startDeltaUpdate(&journalSize)) {
+			failDeltaUpdate(journalSize);
+			return ACTIVATION_NONE;
+		}
+	}
+	else {
+		NRF_LOG_INFO("Resume delta update");
+		NRF_LOG_FLUSH();
+	}
+
+	cs_delta_patch_header_t header;
+	if (!applyDeltaUpdate(&journalSize, &header)) {
+		failDeltaUpdate(journalSize);
+		return ACTIVATION_NONE;
+	}
+	finishDeltaUpdate(&header);
+	NRF_LOG_INFO("Delta update done");
+	NRF_LOG_FLUSH();
+	return ACTIVATION_SUCCESS;
+}
@@ -0,0 +1,25 @@
+/**
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include "nrf_bootloader_fw_activation.h"
+
+/**
+ * Apply a delta update, if one has been received, or resume applying it after a reset.
+ *
+ * A delta update is received like a normal application update, in bank 1, but its image is a delta patch (see
+ * dfu/cs_DeltaPatch.h) against the installed application. The patch is applied in place, page by page, with a
+ * journal in the last page of the application area, so that it can be resumed after a reset.
+ *
+ * When the patch does not fit, or is not for the installed application, it's discarded before anything is
+ * overwritten, so the installed application keeps running. When applying fails after that, the application is
+ * invalidated, so that the bootloader stays in DFU mode, and a full image can be sent.
+ *
+ * @return ACTIVATION_SUCCESS     The delta update has been applied.
+ * @return ACTIVATION_NONE        There was no delta update, or it has been discarded.
+ */
+nrf_bootloader_fw_activation_result_t deltaDfuActivate(void);
@@ -43,6 +43,7 @@
 #include "boards.h"
 #include "compiler_abstraction.h"
 #include "cs_BootloaderConfig.h"
+#include "cs_DeltaDfu.h"
 #include "ipc/cs_IpcRamData.h"
 #include "nrf.h"
 #include "nrf_bootloader_app_start.h"
@@ -419,8 +420,12 @@ ret_code_t nrf_bootloader_init(nrf_dfu_observer_t observer) {
 	}
 #endif
 
-	// Check if an update needs to be activated and activate it.
-	activation_result = nrf_bootloader_fw_activate();
+	// A delta update is applied by us, any other update is activated by the SDK.
+	activation_result = deltaDfuActivate();
+	if (activation_result == ACTIVATION_NONE) {
+		// Check if an update needs to be activated and activate it.
+		activation_result = nrf_bootloader_fw_activate();
+	}
 
 	switch (activation_result) {
 		case ACTIVATION_NONE:
@@ -6,6 +6,7 @@ message(STATUS "crownstone platform mock source files appended to FOLDER_SOURCE"
 
 list(APPEND FOLDER_SOURCE "${CMAKE_BLUENET_SOURCE_DIR_MOCK}/util/cs_BleError.c")
 
+LIST(APPEND FOLDER_SOURCE "${CMAKE_BLUENET_SOURCE_DIR_MOCK}/drivers/cs_FlashEmulator.cpp")
 LIST(APPEND FOLDER_SOURCE "${CMAKE_BLUENET_SOURCE_DIR_MOCK}/drivers/cs_PWM.cpp")
 LIST(APPEND FOLDER_SOURCE "${CMAKE_BLUENET_SOURCE_DIR_MOCK}/drivers/cs_Relay.cpp")
 LIST(APPEND FOLDER_SOURCE "${CMAKE_BLUENET_SOURCE_DIR_MOCK}/drivers/cs_RNG.cpp")
@@ -14,3 +15,6 @@ LIST(APPEND FOLDER_SOURCE "${CMAKE_BLUENET_SOURCE_DIR_MOCK}/drivers/cs_Serial.cp
 LIST(APPEND FOLDER_SOURCE "${CMAKE_BLUENET_SOURCE_DIR_MOCK}/drivers/cs_Storage.cpp")
 list(APPEND FOLDER_SOURCE "${CMAKE_BLUENET_SOURCE_DIR_MOCK}/drivers/cs_Uicr.c")
 LIST(APPEND FOLDER_SOURCE "${CMAKE_BLUENET_SOURCE_DIR_MOCK}/drivers/cs_PWM.cpp")
+
+# Part of the bootloader, built on host for the delta patch test and tool.
+LIST(APPEND FOLDER_SOURCE "${SOURCE_DIR}/../shared/dfu/cs_DeltaPatch.c")
@@ -8,10 +8,33 @@ LIST(APPEND TEST_SOURCE_FILES "test_InterleavedBuffer.cpp")
 LIST(APPEND TEST_SOURCE_FILES "test_HashFletcher32.cpp")
 LIST(APPEND TEST_SOURCE_FILES "test_BitmaskVarSize.cpp")
 LIST(APPEND TEST_SOURCE_FILES "test_SystemTimeSync.cpp")
+LIST(APPEND TEST_SOURCE_FILES "test_SystemTimeWarmBoot.cpp")
 LIST(APPEND TEST_SOURCE_FILES "test_EventDispatcher.cpp")
 LIST(APPEND TEST_SOURCE_FILES "test_BoardMap.cpp")
+LIST(APPEND TEST_SOURCE_FILES "test_AssetRateController.cpp")
+LIST(APPEND TEST_SOURCE_FILES "test_AssetReportCache.cpp")
+LIST(APPEND TEST_SOURCE_FILES "test_AssetFilterSyncer.cpp")
+LIST(APPEND TEST_SOURCE_FILES "test_MeshTopology.cpp")
+LIST(APPEND TEST_SOURCE_FILES "test_TimingWheel.cpp")
+LIST(APPEND TEST_SOURCE_FILES "test_CoroutineScheduler.cpp")
+LIST(APPEND TEST_SOURCE_FILES "test_DimmerLoadModel.cpp")
+LIST(APPEND TEST_SOURCE_FILES "test_MicroappCompression.cpp")
+LIST(APPEND TEST_SOURCE_FILES "test_MicroappUploadQueue.cpp")
+LIST(APPEND TEST_SOURCE_FILES "test_DeltaPatch.cpp")
 LIST(APPEND TEST_SOURCE_FILES "scenarios/test_ReleaseOverrideOnBehaviourUpdate.cpp")
 LIST(APPEND TEST_SOURCE_FILES "scenarios/test_BehaviourConflictWithPresence.cpp")
+LIST(APPEND TEST_SOURCE_FILES "scenarios/test_BehaviourCalendar.cpp")
+LIST(APPEND TEST_SOURCE_FILES "scenarios/test_ExtendedSwitchBehaviour.cpp")
+LIST(APPEND TEST_SOURCE_FILES "scenarios/test_BehaviourResolutionBenchmark.cpp")
+LIST(APPEND TEST_SOURCE_FILES "scenarios/test_BehaviourMasterHash.cpp")
+LIST(APPEND TEST_SOURCE_FILES "scenarios/test_BehaviourYearSimulation.cpp")
+LIST(APPEND TEST_SOURCE_FILES "scenarios/test_PresenceAggregation.cpp")
 LIST(APPEND TEST_SOURCE_FILES "storage/test_StorageWrite.cpp")
 LIST(APPEND TEST_SOURCE_FILES "storage/test_StateSetGet.cpp")
 LIST(APPEND TEST_SOURCE_FILES "storage/test_StorageEvents.cpp")
+LIST(APPEND TEST_SOURCE_FILES "storage/test_StatePreload.cpp")
+LIST(APPEND TEST_SOURCE_FILES "storage/test_StateJournal.cpp")
+LIST(APPEND TEST_SOURCE_FILES "storage/test_StateTransfer.cpp")
+LIST(APPEND TEST_SOURCE_FILES "storage/test_GarbageCollectionPolicy.cpp")
+LIST(APPEND TEST_SOURCE_FILES "storage/test_StorageWearBenchmark.cpp")
+LIST(APPEND TEST_SOURCE_FILES "storage/test_StorageIndex.cpp")
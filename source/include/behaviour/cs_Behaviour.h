@@ -30,6 +30,10 @@ protected:
 	TimeOfDay behaviourAppliesFrom  = TimeOfDay::Midnight();
 	TimeOfDay behaviourAppliesUntil = TimeOfDay::Midnight();
 
+	// from() and until() in seconds since midnight, see updateCachedTimes().
+	uint32_t cachedFromSeconds      = 0;
+	uint32_t cachedUntilSeconds     = 0;
+
 public:
 	virtual ~Behaviour() = default;  // (to prevent object slicing from leaking memory.)
 
@@ -64,6 +68,12 @@ public:
 	 **/
 	bool isValid(Time currenttime);
 
+	/**
+	 * Returns the number of seconds after which the outcome of isValid(Time), or of the conflict resolution, may
+	 * change: the time until the next from, from + 1 s, until, or midnight boundary. At most a day.
+	 */
+	uint32_t secondsUntilNextBoundary(Time currentTime);
+
 	virtual bool requiresPresence() { return false; }
 	virtual bool requiresAbsence() { return false; }
 
@@ -83,4 +93,16 @@ public:
 	 * Returns until (excl.) which time on this behaviour applies.
 	 */
 	TimeOfDay until() const;
+
+	/**
+	 * Converts from() and until() to seconds since midnight, and caches the result.
+	 * Converting sunrise or sunset based times requires a state lookup, so the conflict resolution uses the
+	 * cached values instead.
+	 *
+	 * To be called when the behaviour is stored, and when the sun times changed.
+	 */
+	void updateCachedTimes();
+
+	uint32_t cachedFrom() const { return cachedFromSeconds; }
+	uint32_t cachedUntil() const { return cachedUntilSeconds; }
 };
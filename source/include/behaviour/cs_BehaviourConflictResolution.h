@@ -1,7 +1,15 @@
+#pragma once
+
 #include <behaviour/cs_Behaviour.h>
 #include <presence/cs_PresencePredicate.h>
 #include <time/cs_Time.h>
 
+/**
+ * Returns the relevance of a presence predicate, higher is more relevant.
+ * Comparing ranks gives the same result as PresenceIsMoreRelevant, so it can be precomputed.
+ */
+uint16_t PresenceRelevanceRank(PresencePredicate predicate);
+
 /**
  * Returns true if lhs is strictly more relevant than rhs.
  *  - VacuouslyTrue is least relevant.
@@ -20,12 +28,12 @@ bool FromUntilIntervalIsMoreRelevantOrEqual(
 		int32_t lhs_from, int32_t lhs_until, int32_t rhs_from, int32_t rhs_until, int32_t current_tod);
 
 /**
- * Wrapper for raw int32_t values.
+ * Wrapper for the cached from and until values of the behaviours.
  */
 bool FromUntilIntervalIsMoreRelevantOrEqual(Behaviour* lhs, Behaviour* rhs, Time currentTime);
 
 /**
  * Returns false if either of lhs and rhs is nullptr, else
- * returns true iff both from() and until() values match.
+ * returns true iff both cached from and until values match.
  */
 bool FromUntilIntervalIsEqual(Behaviour* lhs, Behaviour* rhs);
@@ -33,6 +33,8 @@ public:
 	 * - EVT_PRESENCE_MUTATION
 	 * - EVT_BEHAVIOURSTORE_MUTATION
 	 * - STATE_BEHAVIOUR_SETTINGS
+	 * - STATE_SUN_TIME
+	 * - EVT_TIME_SET
 	 * - CMD_GET_BEHAVIOUR_DEBUG
 	 */
 	virtual void handleEvent(event_t& evt);
@@ -41,12 +43,23 @@ public:
 	 * Acquires the current time and presence information.
 	 * Checks and updates the currentIntendedState by looping over the active behaviours.
 	 *
+	 * The behaviours are only evaluated when the outcome may have changed: when the presence changed,
+	 * or when the next evaluation time, computed at the previous evaluation, has been reached.
+	 *
 	 * If isActive is false, or _presenceHandler is nullptr, this method has no effect.
 	 *
 	 * Returns true.
 	 */
 	bool update();
 
+	/**
+	 * Makes the next call to update() evaluate the behaviours.
+	 *
+	 * To be called when anything changed that the next evaluation time doesn't take into account,
+	 * like the stored behaviours, the settings, the sun times, or the time.
+	 */
+	void invalidate();
+
 	/**
 	 * Returns currentIntendedState variable and updates the previousIntendedState
 	 * to currentIntendedState to match previousIntendedState.
@@ -64,13 +77,13 @@ public:
 	bool requiresAbsence(Time t);
 
 	/**
-	 * Checks if the given behaviour is valid. I.e. its presence clause and time constraints are met.
+	 * Checks if the behaviour at given index is valid. I.e. its presence clause and time constraints are met.
 	 *
 	 * Presence and time are obtained from PresenceHandler and SystemTime for this check.
 	 *
 	 * @see Behaviour::isValid.
 	 */
-	bool validateBehaviour(Behaviour* behaviour) const;
+	bool validateBehaviour(uint8_t index) const;
 
 private:
 	/**
@@ -109,6 +122,35 @@ private:
 	 */
 	std::optional<behaviour_settings_t> _receivedBehaviourSettings = {};
 
+	// -----------------------------------------------------------------------
+	// ------------------------- evaluation calendar -------------------------
+	// -----------------------------------------------------------------------
+
+	/**
+	 * Whether the next evaluation time is valid.
+	 */
+	bool _evaluationScheduled                                      = false;
+
+	/**
+	 * Presence and time at the last evaluation.
+	 */
+	PresenceStateDescription _evaluatedPresence;
+	uint32_t _evaluatedTimestamp                                   = 0;
+
+	/**
+	 * The behaviours have to be evaluated again when either of these times is reached.
+	 * The posix time is used for time of day boundaries, the up time for presence grace periods.
+	 */
+	uint32_t _nextEvaluationTimestamp                              = 0;
+	uint32_t _nextEvaluationUpTime                                 = 0;
+
+	/**
+	 * Up time and time of the last skipped evaluation, if any since the last evaluation.
+	 */
+	bool _skippedEvaluation                                        = false;
+	uint32_t _lastSkippedUpTime                                    = 0;
+	Time _lastSkippedTime                                          = 0;
+
 	// -----------------------------------------------------------------------
 	// --------------------------- private methods ---------------------------
 	// -----------------------------------------------------------------------
@@ -142,18 +184,35 @@ private:
 	void handleGetBehaviourDebug(event_t& evt);
 
 	/**
-	 * @return      Switch behaviour if the behaviour is a valid switch behaviour, and active at this time/presence.
+	 * Returns true when the behaviours have to be evaluated at given time and presence.
+	 */
+	bool evaluationIsDue(uint32_t upTime, Time currentTime, PresenceStateDescription currentPresence) const;
+
+	/**
+	 * Computes the next time at which the outcome of the evaluation may change.
+	 * To be called right after an evaluation.
+	 */
+	void scheduleNextEvaluation(uint32_t upTime, Time currentTime, PresenceStateDescription currentPresence);
+
+	/**
+	 * Brings the runtime values of the behaviours up to date with the last skipped evaluation.
+	 */
+	void fastForwardBehaviours();
+
+	/**
+	 * @return      Switch behaviour if the behaviour at given index is a switch behaviour, and active at this
+	 *              time/presence.
 	 * @return      nullptr otherwise.
 	 */
 	SwitchBehaviour* validateSwitchBehaviour(
-			Behaviour* behaviour, Time currentTime, PresenceStateDescription currentPresence) const;
+			uint8_t index, Time currentTime, PresenceStateDescription currentPresence) const;
 
 	/**
-	 * @return      Twilight behaviour if the behaviour is a valid twilight behaviour, and active at this time/presence.
+	 * @return      Twilight behaviour if the behaviour at given index is a twilight behaviour, and active at this time.
 	 * @return      nullptr otherwise.
 	 */
 	TwilightBehaviour* validateTwilightBehaviour(
-			Behaviour* behaviour, Time currentTime, PresenceStateDescription currentPresence) const;
+			uint8_t index, Time currentTime, PresenceStateDescription currentPresence) const;
 
 	// -----------------------------------------------------------------------
 	// --------------------------- synchronization ---------------------------
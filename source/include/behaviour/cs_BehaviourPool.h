@@ -0,0 +1,83 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+/**
+ * Fixed number of places for behaviours of a single type, stored contiguously without heap allocation.
+ *
+ * Only the places in use hold a constructed behaviour.
+ */
+template <class BehaviourType, size_t Size>
+class BehaviourPool {
+	static_assert(Size <= 64, "The places in use are kept in a 64 bit mask.");
+
+public:
+	BehaviourPool() = default;
+
+	BehaviourPool(const BehaviourPool&) = delete;
+	BehaviourPool& operator=(const BehaviourPool&) = delete;
+
+	~BehaviourPool() {
+		for (size_t i = 0; i < Size; ++i) {
+			if (isUsed(i)) {
+				at(i)->~BehaviourType();
+			}
+		}
+	}
+
+	/**
+	 * Construct a behaviour in a free place.
+	 *
+	 * @return      The constructed behaviour.
+	 * @return      nullptr when all places are in use.
+	 */
+	template <class... Args>
+	BehaviourType* emplace(Args&&... args) {
+		for (size_t i = 0; i < Size; ++i) {
+			if (!isUsed(i)) {
+				_used |= (1ULL << i);
+				return new (&_places[i]) BehaviourType(std::forward<Args>(args)...);
+			}
+		}
+		return nullptr;
+	}
+
+	/**
+	 * Destruct a behaviour that was returned by emplace(), and free its place.
+	 */
+	void erase(BehaviourType* behaviour) {
+		size_t i = reinterpret_cast<place_t*>(behaviour) - _places;
+		behaviour->~BehaviourType();
+		_used &= ~(1ULL << i);
+	}
+
+	bool isFull() const { return _used == AllUsed; }
+
+private:
+	struct alignas(BehaviourType) place_t {
+		uint8_t data[sizeof(BehaviourType)];
+	};
+
+	static constexpr uint64_t AllUsed = (Size == 64) ? ~0ULL : (1ULL << (Size % 64)) - 1;
+
+	place_t _places[Size];
+
+	/**
+	 * Bitmask of places that hold a behaviour.
+	 */
+	uint64_t _used = 0;
+
+	bool isUsed(size_t i) const { return _used & (1ULL << i); }
+
+	BehaviourType* at(size_t i) { return std::launder(reinterpret_cast<BehaviourType*>(&_places[i])); }
+};
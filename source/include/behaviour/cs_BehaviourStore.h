@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <behaviour/cs_BehaviourPool.h>
 #include <behaviour/cs_ExtendedSwitchBehaviour.h>
 #include <behaviour/cs_SwitchBehaviour.h>
 #include <behaviour/cs_TwilightBehaviour.h>
@@ -21,6 +22,13 @@
 
 /**
  * Keeps track of the behaviours that are active on this crownstone.
+ *
+ * The behaviours are stored by value, in a pool per type, so no heap allocation is needed.
+ * The type of a behaviour determines its pool, so that no RTTI is needed to get the type of a behaviour.
+ *
+ * RAM on the nRF52: the pools take 32 * 64 B + 12 * 112 B + 12 * 24 B = 3680 B of static RAM, whether they are used
+ * or not. With a slot per index that fits any type, this was 50 * 112 B = 5600 B. A store can thus hold at most
+ * 12 extended switch behaviours, or 12 twilights. Most behaviours are switch behaviours.
  */
 class BehaviourStore : public EventListener, public Component {
 	friend class TestAccess<BehaviourStore>;
@@ -28,8 +36,47 @@ class BehaviourStore : public EventListener, public Component {
 public:
 	static constexpr size_t MaxBehaviours = 50;
 
+	/**
+	 * Max number of behaviours per type.
+	 */
+	static constexpr size_t MaxSwitchBehaviours   = 32;
+	static constexpr size_t MaxExtendedBehaviours = 12;
+	static constexpr size_t MaxTwilightBehaviours = 12;
+
+	typedef BehaviourPool<SwitchBehaviour, MaxSwitchBehaviours> SwitchBehaviourPool;
+	typedef BehaviourPool<ExtendedSwitchBehaviour, MaxExtendedBehaviours> ExtendedSwitchBehaviourPool;
+	typedef BehaviourPool<TwilightBehaviour, MaxTwilightBehaviours> TwilightBehaviourPool;
+
 private:
-	std::array<Behaviour*, MaxBehaviours> activeBehaviours = {};
+	SwitchBehaviourPool switchBehaviours;
+	ExtendedSwitchBehaviourPool extendedSwitchBehaviours;
+	TwilightBehaviourPool twilightBehaviours;
+
+	/**
+	 * Pointers to the behaviours in the pools, nullptr for empty indices.
+	 */
+	std::array<Behaviour*, MaxBehaviours> activeBehaviours         = {};
+
+	/**
+	 * Number of leaves of the hash tree: MaxBehaviours, rounded up to a power of 2.
+	 */
+	static constexpr size_t HashTreeLeaves                         = 64;
+	static_assert(HashTreeLeaves >= MaxBehaviours, "Every behaviour needs a leaf.");
+
+	/**
+	 * Segment tree of partial hashes, see updateMasterHash().
+	 *
+	 * Node 1 is the root, the children of node i are 2i and 2i+1, and the leaf of index i is node HashTreeLeaves + i.
+	 * A leaf holds the Fletcher hash of the index and serialized behaviour, or 0 when there is no behaviour.
+	 * Any other node holds the hash of the data of its children, in order of index.
+	 * The root thus holds the master hash.
+	 */
+	std::array<uint32_t, 2 * HashTreeLeaves> hashTree              = {};
+
+	/**
+	 * Number of 16 bit words hashed by each node of the hash tree.
+	 */
+	std::array<uint16_t, 2 * HashTreeLeaves> hashTreeWordCount     = {};
 
 public:
 	// delete copy and move constructor to prevent double deletions etc.
@@ -46,8 +93,8 @@ public:
 	/*****************************
 	 * NOTE: to loop over a specific type of behaviours simply do:
 	 *
-	 * for(auto b : getActiveBehaviours()){
-	 *   if(auto switchbehave = dynamic_cast<SwitchBehaviour*>(b)){
+	 * for (uint8_t i = 0; i < MaxBehaviours; ++i) {
+	 *   if (auto switchbehave = getSwitchBehaviour(i)) {
 	 *     // work with switchbehave
 	 *   }
 	 * }
@@ -62,25 +109,44 @@ public:
 	virtual ~BehaviourStore();
 
 	/**
-	 * Add behaviour to the ActiveBehaviours if there is space.
-	 * If null, nothing happens.
-	 *
-	 * The object pointed to by `behaviour` must to be allocated on the heap.
-	 * Its lifetime will be managed by BehaviourStore and  will be destroyed and deleted
-	 * if/when necessary, for example when replaceBehaviour is called.
+	 * Add a copy of the behaviour to the ActiveBehaviours if there is space.
 	 */
-	ErrorCodesGeneral addBehaviour(Behaviour* behaviour);
+	ErrorCodesGeneral addBehaviour(const Behaviour& behaviour);
 
 	/**
-	 * Add behaviour to the ActiveBehaviours if there is space.
-	 * If null, previous behaviour will be deleted.
-	 * This method takes ownership over the allocated resource
-	 * (removeBehaviour may delete it.)
+	 * Replace the behaviour at given index by a copy of the given behaviour.
 	 */
-	ErrorCodesGeneral replaceBehaviour(uint8_t index, Behaviour* behaviour);
+	ErrorCodesGeneral replaceBehaviour(uint8_t index, const Behaviour& behaviour);
 
 	Behaviour* getBehaviour(uint8_t index);
 
+	/**
+	 * Get the hash over all behaviours.
+	 */
+	uint32_t getMasterHash() const { return hashTree[1]; }
+
+	/**
+	 * Returns the switch behaviour at given index, including extended switch behaviours.
+	 * Returns nullptr when there is no switch behaviour at given index.
+	 */
+	SwitchBehaviour* getSwitchBehaviour(uint8_t index);
+
+	/**
+	 * Returns the extended switch behaviour at given index, or nullptr.
+	 */
+	ExtendedSwitchBehaviour* getExtendedSwitchBehaviour(uint8_t index);
+
+	/**
+	 * Returns the twilight behaviour at given index, or nullptr.
+	 */
+	TwilightBehaviour* getTwilightBehaviour(uint8_t index);
+
+	/**
+	 * Updates the cached times of all behaviours.
+	 * To be called when the sun times changed.
+	 */
+	void updateCachedTimes();
+
 	/**
 	 * returns MaxBehaviours if not found.
 	 */
@@ -113,12 +179,16 @@ private:
 	void clearActiveBehavioursArray();
 
 	/**
-	 * Calculate the hash over all behaviours.
+	 * To be called when the behaviour at given index changed.
+	 *
+	 * Only the hash of that behaviour is recalculated, and the partial hashes on the path to the root of the
+	 * hash tree are combined again: O(log MaxBehaviours).
+	 * The result is the same as a Fletcher hash over the index and serialized behaviour of each behaviour in order.
 	 */
-	uint32_t calculateMasterHash();
+	void updateMasterHash(uint8_t index);
 
 	/**
-	 * Calculate master hash and store it in State.
+	 * Store the master hash in State.
 	 */
 	void storeMasterHash();
 
@@ -152,17 +222,36 @@ private:
 	void storeUpdate(uint8_t index, Behaviour* behaviour);
 
 	/**
-	 * Heap allocate an instance of given type from the buffer.
+	 * Construct an instance of given type from the buffer, in the pool of that type.
 	 *
 	 * Notes:
 	 *  - If bufSize is less than the WireFormat::size for the given type, a default constructed behaviour
-	 *    is allocated.
-	 *  - The index is not checked for preexisting data. That must be deleted before using this function.
+	 *    is constructed.
+	 *
+	 * Returns nullptr for unknown types, or when the pool is full.
+	 */
+	Behaviour* allocateBehaviour(SwitchBehaviour::Type type, uint8_t* buf, cs_buffer_size_t bufSize);
+
+	/**
+	 * Copy the behaviour to the pool of its type.
+	 *
+	 * Returns nullptr for unknown types, or when the pool is full.
+	 */
+	Behaviour* allocateBehaviour(const Behaviour& behaviour);
+
+	/**
+	 * Destruct the behaviour at given index, and free its place in the pool.
+	 * Does not touch the persisted values or the master hash.
+	 */
+	void freeBehaviour(uint8_t index);
+
+	/**
+	 * Whether a behaviour of given type can be put at given index, after removing the behaviour at that index.
 	 */
-	Behaviour* allocateBehaviour(uint8_t index, SwitchBehaviour::Type type, uint8_t* buf, cs_buffer_size_t bufSize);
+	bool hasSpace(SwitchBehaviour::Type type, uint8_t index);
 
 	/**
-	 * Assign it to activateBehaviour[index] and print it.
+	 * Assign it to activateBehaviour[index], update its cached times, and print it.
 	 */
 	void assignBehaviour(uint8_t index, Behaviour* behaviour);
 
@@ -183,7 +272,7 @@ private:
 	// checks intermediate state of handleReplaceBehaviour for consistency.
 	ErrorCodesGeneral replaceParameterValidation(event_t& evt, uint8_t index, SwitchBehaviour::Type type);
 
-	// loads the behaviours from state into the 'activeBehaviours' array.
+	// loads the behaviours from state into the pools.
 	// BehaviourType must match BehaviourCsType.
 	template <class BehaviourType>
 	void LoadBehavioursFromMemory(CS_TYPE BehaviourCsType);
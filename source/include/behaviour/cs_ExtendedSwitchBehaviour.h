@@ -46,6 +46,8 @@ public:
 	// it assumes that extensionIsActive is up to date.
 	virtual PresencePredicate currentPresencePredicate() override;
 
+	virtual uint16_t currentPresenceRank() override;
+
 	// See SwitchBehaviour for more elaborate explanation why this is necessary.
 	using SwitchBehaviour::isValid;
 
@@ -55,12 +57,23 @@ public:
 	 **/
 	virtual bool isValid(Time currenttime, PresenceStateDescription currentpresence);
 
+	/**
+	 * Returns the posix time at which the extension grace period may end, if it is running.
+	 */
+	std::optional<uint32_t> extensionGracePeriodEnd();
+
+	virtual void fastForward(uint32_t upTime, Time currentTime) override;
+
 	virtual void print();
 
 	bool extensionPeriodIsActive() { return extensionIsActive; }
 
 private:
-	PresenceCondition extensionCondition;
+	// The small fields are put first, so that they fill the padding at the end of SwitchBehaviour.
+	// This keeps the size of a behaviour slot in the BehaviourStore down.
+
+	// Precomputed relevance rank of the extension condition.
+	uint16_t extensionPresenceRank;
 
 	/**
 	 * extensionIsActive will be set to true when at the end of the core behaviour
@@ -75,5 +88,11 @@ private:
 	 * be reset to false as soon as the PresenceCondition evaluates to false.
 	 */
 	bool extensionIsActive                            = false;
+
+	// Whether the last call to isValid() updated prevExtensionIsValidTimeStamp.
+	bool prevExtensionIsValidTimeStampUpdated         = false;
+
+	PresenceCondition extensionCondition;
+
 	std::optional<Time> prevExtensionIsValidTimeStamp = {};
 };
@@ -60,6 +60,11 @@ public:
 	virtual bool requiresAbsence() override;
 	virtual PresencePredicate currentPresencePredicate();
 
+	/**
+	 * Returns the relevance rank of currentPresencePredicate(), see PresenceRelevanceRank().
+	 */
+	virtual uint16_t currentPresenceRank() { return presenceRank; }
+
 	/**
 	 * Does the behaviour apply to the current situation?
 	 * If from() == until() the behaviour isValid all day.
@@ -78,10 +83,38 @@ public:
 	// reintroduces the function name in this class's scope.
 	using Behaviour::isValid;
 
+	/**
+	 * Returns the up time at which the presence grace period may end, if it is running.
+	 * While the presence condition is met, the grace period is extended at every call to isValid(), so it isn't
+	 * running.
+	 */
+	std::optional<uint32_t> gracePeriodEnd();
+
+	/**
+	 * Updates the runtime values as if isValid() was called again at given time,
+	 * with the same outcome as the last call.
+	 *
+	 * Used to skip calls to isValid() while its outcome can't change.
+	 */
+	virtual void fastForward(uint32_t upTime, Time currentTime);
+
 protected:
 	// (serialized field)
 	PresenceCondition presenceCondition;
 
+	// Precomputed relevance rank of the presence condition.
+	uint16_t presenceRank;
+
+	// Whether the last call to isValid() updated prevInRoomTimeStamp.
+	bool prevInRoomTimeStampUpdated = false;
+
+	/**
+	 * Implementation of isValid(PresenceStateDescription), with given predicate instead of currentPresencePredicate().
+	 *
+	 * The grace period is still that of presenceCondition.
+	 */
+	bool presenceIsValid(PresenceStateDescription currentpresence, PresencePredicate predicate);
+
 private:
 	// unserialized fields (runtime values)
 	std::optional<uint32_t> prevInRoomTimeStamp = {};  // when was the last call to _isValid that returned true?
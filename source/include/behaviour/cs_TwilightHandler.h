@@ -10,11 +10,14 @@
 #include <common/cs_Component.h>
 #include <events/cs_EventListener.h>
 #include <presence/cs_PresenceDescription.h>
+#include <test/cs_TestAccess.h>
 #include <time/cs_Time.h>
 
 #include <optional>
 
 class TwilightHandler : public EventListener, public Component {
+	friend class TestAccess<TwilightHandler>;
+
 public:
 	/**
 	 * Initialize this class:
@@ -32,6 +35,8 @@ public:
 	 * - EVT_PRESENCE_MUTATION
 	 * - EVT_BEHAVIOURSTORE_MUTATION
 	 * - STATE_BEHAVIOUR_SETTINGS
+	 * - STATE_SUN_TIME
+	 * - EVT_TIME_SET
 	 */
 	void handleEvent(event_t& evt) override;
 
@@ -41,11 +46,19 @@ public:
 	 * and if the intendedState differs from previousIntendedState
 	 * dispatch an event to communicate a state update.
 	 *
+	 * The behaviours are only evaluated when the next evaluation time, computed at the previous evaluation,
+	 * has been reached.
+	 *
 	 * if time is not valid, aborts method execution and returns false.
 	 * returns true when value was updated, false else.
 	 */
 	bool update();
 
+	/**
+	 * Makes the next call to update() evaluate the behaviours.
+	 */
+	void invalidate();
+
 	/**
 	 * Returns currentIntendedState.
 	 */
@@ -73,4 +86,20 @@ private:
 	 * cached reference to the behaviour store. (obtained at init)
 	 */
 	BehaviourStore* _behaviourStore              = nullptr;
+
+	/**
+	 * Whether _nextEvaluationTimestamp is valid.
+	 */
+	bool _evaluationScheduled                    = false;
+
+	/**
+	 * Time of the last evaluation, and the time at which the behaviours have to be evaluated again.
+	 */
+	uint32_t _evaluatedTimestamp                 = 0;
+	uint32_t _nextEvaluationTimestamp            = 0;
+
+	/**
+	 * Computes the next time at which the outcome of the evaluation may change.
+	 */
+	void scheduleNextEvaluation(Time currentTime);
 };
@@ -14,6 +14,7 @@
 #include <cfg/cs_Config.h>
 #include <cfg/cs_StaticConfig.h>
 #include <events/cs_EventListener.h>
+#include <util/cs_Coroutine.h>
 
 #include <cstdint>
 
@@ -126,8 +127,8 @@ private:
 	// Whether we should be advertising.
 	bool _wantAdvertising         = false;
 
-	// Whether to start advertising on next tick.
-	bool _startOnNextTick         = false;
+	// Starts advertising again a moment after a connection, see onConnect().
+	Coroutine _restartRoutine;
 
 	// Advertisement handle for softdevice. Set by first call to: sd_ble_gap_adv_set_configure().
 	uint8_t _advHandle            = BLE_GAP_ADV_SET_HANDLE_NOT_SET;
@@ -300,7 +301,7 @@ private:
 
 	void onConnectOutgoing();
 
-	void onTick();
+	void onRestart();
 
 	void printAdvertisement();
 };
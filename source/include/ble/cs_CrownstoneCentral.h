@@ -9,6 +9,7 @@
 
 #include <ble/cs_UUID.h>
 #include <events/cs_EventListener.h>
+#include <util/cs_Coroutine.h>
 
 /**
  * Class to connect to another crownstone, and write control commands.
@@ -167,9 +168,9 @@ private:
 	uint16_t _timeoutMs;
 
 	/**
-	 * A countdown until timeout.
+	 * Calls onTimeout() once, when the timeout expires.
 	 */
-	uint16_t _timeoutCountDown = 0;
+	Coroutine _timeoutRoutine;
 
 	/**
 	 * Reset connection variables.
@@ -16,6 +16,7 @@
 #include <events/cs_EventListener.h>
 #include <processing/cs_ExternalStates.h>
 #include <storage/cs_State.h>
+#include <util/cs_Coroutine.h>
 
 class ServiceData : EventListener {
 
@@ -136,13 +137,14 @@ private:
 	//! Cache timestamp of first error
 	uint32_t _firstErrorTimestamp = 0;
 
-	uint32_t _sendStateCountdown  = MESH_SEND_STATE_INTERVAL_MS / TICK_INTERVAL_MS;
+	//! Sends the state over the mesh, every MESH_SEND_STATE_INTERVAL_MS plus a random variation.
+	Coroutine _sendMeshStateRoutine;
 
 	//! Cache the operation mode.
-	OperationMode _operationMode  = OperationMode::OPERATION_MODE_UNINITIALIZED;
+	OperationMode _operationMode = OperationMode::OPERATION_MODE_UNINITIALIZED;
 
 	//! Counter that keeps up the number of times that the advertisement has been updated.
-	uint32_t _updateCount         = 0;
+	uint32_t _updateCount        = 0;
 
 	ExternalStates _externalStates;
 
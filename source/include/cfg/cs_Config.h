@@ -188,6 +188,9 @@
 #define CURRENT_USAGE_THRESHOLD_DIMMER           (1000)  // Power usage threshold in mA at which the PWM should be turned off.
 #define CURRENT_THRESHOLD_CONSECUTIVE            100 // Number of consecutive times the current has to be above the threshold before triggering the softfuse.
 #define CURRENT_THRESHOLD_DIMMER_CONSECUTIVE     20  // Number of consecutive times the current has to be above the threshold before triggering the softfuse.
+#define CURRENT_MEASURED_EVENT_INTERVAL          5   // Dispatch the filtered current once every so many buffers.
+#define DIMMER_LOAD_SETTLE_TIME_MS               1000 // Time after the dimmer reached its intensity, before the measured current is used to learn the load.
+#define DIMMER_PREDICTED_CURRENT_MAX_PERCENT     90  // Max predicted current when dimming, as percentage of the dimmer softfuse threshold.
 
 
 #define SWITCHCRAFT_THRESHOLD                    (500000) // Threshold for switch recognition (float).
@@ -202,6 +205,13 @@ static const uint8_t DEFAULT_DIM_VALUE           = 40;
 
 #define SWITCH_DELAYED_STORE_MS                  (10 * 1000) // Timeout before storing the pwm switch value is stored.
 #define STATE_RETRY_STORE_DELAY_MS               200 // Time before retrying to store a varable to flash.
+#define STORAGE_GC_CHECK_INTERVAL_MS             (10 * 1000) // Interval at which garbage collection is considered.
+#define STORAGE_GC_IDLE_FREEABLE_PERCENT         25 // When idle, collect garbage when this percentage is freeable.
+#define STORAGE_GC_IDLE_FREE_WORDS               384 // When idle, collect garbage when less words are free on a page.
+#define STORAGE_GC_URGENT_FREE_WORDS             160 // Always collect garbage when less words are free on a page.
+#define STATE_JOURNAL_FLUSH_INTERVAL_MS          SWITCH_DELAYED_STORE_MS // Interval at which journaled changes are written.
+#define STATE_JOURNAL_RECORD_COUNT               8 // Number of journal records before they're compacted.
+#define STATE_IMPORT_MAX_SIZE                    1024 // Maximum size of a state import stream, see StateTransfer.
 #define MESH_SEND_TIME_INTERVAL_MS               (50 * 1000) // Interval at which the time is sent via the mesh.
 #define MESH_SEND_TIME_INTERVAL_MS_VARIATION     (20 * 1000) // Max amount that gets added to interval.
 #define MESH_SEND_STATE_INTERVAL_MS              (50 * 1000) // Interval at which the stone state is sent via the mesh.
@@ -209,6 +219,8 @@ static const uint8_t DEFAULT_DIM_VALUE           = 40;
 #define MESH_SYNC_RETRY_INTERVAL_MS              (2500)
 #define MESH_SYNC_GIVE_UP_MS                     (60 * 1000) // After some time, give up syncing.
 #define CS_MESH_DEFAULT_TTL                      10
+// Max number of asset reports per minute on the mesh, of all crownstones together.
+#define ASSET_MESH_BUDGET_MSGS_PER_MINUTE        600
 
 #define PWM_BOOT_DELAY_MS                        60000 // Delay after boot until pwm can be used. Has to be smaller than overflow time of RTC.
 #define DIMMER_BOOT_CHECK_DELAY_MS               5000  // Delay after boot until power measurement is checked to see if dimmer works.
@@ -266,12 +278,25 @@ static const uint8_t DEFAULT_DIM_VALUE           = 40;
 #define SUN_TIME_THROTTLE_PERIOD_SECONDS         (60*60*24) // Seconds to throttle writing the sun time to flash.
 
 #define CS_CLEAR_GPREGRET_COUNTER_TIMEOUT_S      60 // Seconds after boot to clear the GPREGRET reset counter.
+#define WARM_BOOT_BOOTLOADER_DURATION_MS         300 // Estimated time from a soft reset until the RTC starts again.
 
 /**
  * Interval in milliseconds at which tick events are dispatched.
  */
 #define TICK_INTERVAL_MS 100
 
+/**
+ * Time in milliseconds a tick event may be delayed, to share a wake up. The delay doesn't accumulate.
+ */
+#define TICK_JITTER_MS 50
+
+#define TEMPERATURE_STATE_INTERVAL_MS            500   // Interval at which the chip temperature is stored in state.
+#define TEMPERATURE_STATE_JITTER_MS              100   // Time the temperature update may be delayed, to share a wake up.
+#define LOAD_STATS_INTERVAL_MS                   60000 // Interval at which the load stats are logged.
+#define LOAD_STATS_JITTER_MS                     1000  // Time the load stats may be delayed, to share a wake up.
+#define WATCHDOG_KICK_INTERVAL_MS                10000 // Interval at which the watchdog is kicked.
+#define WATCHDOG_KICK_JITTER_MS                  1000  // Time the watchdog kick may be delayed, to share a wake up.
+
 #define CONFIG_POWER_ZERO_INVALID 0x7FFFFFFF
 
 #ifndef STATE_SWITCH_STATE_DEFAULT
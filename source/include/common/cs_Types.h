@@ -197,6 +197,8 @@ enum class CS_TYPE : uint16_t {
 	STATE_SWITCHCRAFT_DOUBLE_TAP_ENABLED       = 167,
 	STATE_DEFAULT_DIM_VALUE                    = 168,
 
+	STATE_JOURNAL                              = 169,
+
 	/*
 	 * Internal commands and events.
 	 * Start at Internal_Base.
@@ -230,6 +232,7 @@ enum class CS_TYPE : uint16_t {
 	EVT_DIMMER_POWERED =
 			InternalBasePower,  // Dimmer being powered is changed. Payload: true when powered, and ready to be used.
 	EVT_BROWNOUT_IMPENDING,     // Brownout is impending (low chip supply voltage).
+	EVT_CURRENT_MEASURED,       // Filtered RMS current was measured. Payload: current in mA.
 
 	// Errors
 	EVT_CURRENT_USAGE_ABOVE_THRESHOLD = InternalBaseErrors,  // Current usage goes over the threshold.
@@ -349,7 +352,8 @@ enum class CS_TYPE : uint16_t {
 	CMD_SET_IBEACON_CONFIG_ID,  // Set which ibeacon config id to use for advertising.
 	EVT_TIME_SET,  // Time is set or changed. WARNING: this event is only sent on set time command. Payload: previous
 				   // posix time
-	EVT_TICK,      // Sent about every TICK_INTERVAL_MS ms.
+	EVT_TICK,      // Sent about every TICK_INTERVAL_MS ms, while requested, see CompatibilityTick.
+	EVT_TICK_SECOND,  // Sent by SystemTime when the uptime increased by a second. Payload: uptime in seconds.
 
 	CMD_CONTROL_CMD,       // Handle a control command.
 	EVT_SESSION_DATA_SET,  // Session data and setup key are generated. Data pointer has to point to memory that stays
@@ -407,6 +411,7 @@ enum class CS_TYPE : uint16_t {
 	EVT_MESH_TOPO_MAC_RESULT,  // The resulting MAC address.
 	CMD_MESH_TOPO_RESET,       // Reset the stored mesh topology.
 	CMD_MESH_TOPO_GET_RSSI,    // Get the RSSI to a stoneId. The RSSI is set in the result.
+	CMD_MESH_TOPO_GET_MATRIX,  // Write all known RSSI between stones to UART, in one message.
 
 	EVT_TWI_INIT,    // TWI initialisation.
 	EVT_TWI_WRITE,   // TWI write.
@@ -466,6 +471,33 @@ struct __attribute__((packed)) cs_type_and_id_t {
 	cs_state_id_t id;
 };
 
+/**
+ * Number of bytes of a state journal record, that can be used for entries.
+ * Enough for an entry of each journaled type, while keeping the record small.
+ */
+static const uint8_t CS_STATE_JOURNAL_ENTRIES_SIZE = 19;
+
+/**
+ * Record of the state journal: a batch of state values. See StateJournal.
+ */
+struct __attribute__((packed)) cs_state_journal_t {
+	//! Records are replayed in order of sequence number.
+	uint32_t sequenceNumber;
+	//! Number of bytes of entries.
+	uint8_t size;
+	uint8_t entries[CS_STATE_JOURNAL_ENTRIES_SIZE];
+};
+
+/**
+ * Header of an entry of the state journal, followed by the value.
+ * An entry without value marks a removed value.
+ */
+struct __attribute__((packed)) cs_state_journal_entry_header_t {
+	uint16_t type;
+	cs_state_id_t id;
+	uint8_t size;
+};
+
 /*---------------------------------------------------------------------------------------------------------------------
  *
  *                                               Types
@@ -542,6 +574,7 @@ typedef ibeacon_config_id_packet_t TYPIFY(STATE_IBEACON_CONFIG_ID);
 typedef microapp_state_t TYPIFY(STATE_MICROAPP);
 typedef uint8_t TYPIFY(STATE_SOFT_ON_SPEED);
 typedef uint8_t TYPIFY(STATE_DEFAULT_DIM_VALUE);
+typedef cs_state_journal_t TYPIFY(STATE_JOURNAL);
 typedef uint8_t TYPIFY(STATE_HUB_MODE);
 typedef asset_filters_version_t TYPIFY(STATE_ASSET_FILTERS_VERSION);
 
@@ -574,6 +607,7 @@ typedef cs_ret_code_t TYPIFY(EVT_CS_CENTRAL_CONNECT_RESULT);
 typedef cs_central_write_result_t TYPIFY(EVT_CS_CENTRAL_READ_RESULT);
 typedef cs_central_write_result_t TYPIFY(EVT_CS_CENTRAL_WRITE_RESULT);
 typedef void TYPIFY(EVT_BROWNOUT_IMPENDING);
+typedef int32_t TYPIFY(EVT_CURRENT_MEASURED);
 typedef void TYPIFY(EVT_CHIP_TEMP_ABOVE_THRESHOLD);
 typedef void TYPIFY(EVT_CHIP_TEMP_OK);
 typedef reset_delayed_t TYPIFY(CMD_RESET_DELAYED);
@@ -638,6 +672,7 @@ typedef void TYPIFY(CMD_STORAGE_GARBAGE_COLLECT);
 typedef void TYPIFY(EVT_SWITCH_FORCED_OFF);
 typedef bool TYPIFY(CMD_LOCK_SWITCH);
 typedef uint32_t TYPIFY(EVT_TICK);
+typedef uint32_t TYPIFY(EVT_TICK_SECOND);
 typedef uint32_t TYPIFY(EVT_TIME_SET);
 typedef void TYPIFY(CMD_TOGGLE_ADC_VOLTAGE_VDD_REFERENCE_PIN);
 
@@ -708,6 +743,7 @@ typedef stone_id_t TYPIFY(CMD_MESH_TOPO_GET_MAC);
 typedef mesh_topo_mac_result_t TYPIFY(EVT_MESH_TOPO_MAC_RESULT);
 typedef void TYPIFY(CMD_MESH_TOPO_RESET);
 typedef stone_id_t TYPIFY(CMD_MESH_TOPO_GET_RSSI);
+typedef void TYPIFY(CMD_MESH_TOPO_GET_MATRIX);
 
 // TWI / I2C module
 typedef cs_twi_init_t TYPIFY(EVT_TWI_INIT);
@@ -14,6 +14,7 @@
 #include <ble/cs_Stack.h>
 #include <ble/cs_iBeacon.h>
 #include <cfg/cs_Boards.h>
+#include <events/cs_CompatibilityTick.h>
 #include <events/cs_EventListener.h>
 #include <localisation/cs_AssetFiltering.h>
 #include <localisation/cs_MeshTopology.h>
@@ -33,6 +34,7 @@
 #include <time/cs_SystemTime.h>
 #include <tracking/cs_TrackedDevices.h>
 #include <test/cs_TestAccess.h>
+#include <util/cs_Coroutine.h>
 
 #if BUILD_MESHING == 1
 #include <mesh/cs_Mesh.h>
@@ -117,7 +119,7 @@ public:
 	/**
 	 * Initialize Crownstone firmware. First drivers are initialized (log modules, storage modules, ADC conversion,
 	 * timers). Then everything is configured independent of the mode (everything that is common to whatever mode the
-	 * Crownstone runs on). A callback to the local staticTick function for a timer is set up. Then the mode of
+	 * Crownstone runs on). Then the mode of
 	 * operation is switched and the BLE services are initialized.
 	 */
 	void init(uint16_t step);
@@ -173,10 +175,6 @@ public:
 	 */
 	static void printLoadStats();
 
-	/** tick function called by app timer
-	 */
-	static void staticTick(Crownstone* ptr) { ptr->tick(); }
-
 protected:
 	std::vector<Component*> getChildren() override;
 
@@ -300,17 +298,10 @@ private:
 	 */
 	void switchMode(const OperationMode& mode);
 
-	/** tick function for crownstone to update/execute periodically
-	 */
 	/**
-	 * Operations that are not sensitive with respect to time and only need to be called at regular intervals.
-	 * TODO: describe function calls and why they are required.
-	 */
-	void tick();
-
-	/** schedule next execution of tick function
+	 * Kicks the watchdog, and updates the heap stats.
 	 */
-	void scheduleNextTick();
+	void kickWatchdog();
 
 	/** Increase reset counter. This will be stored in FLASH so it persists over reboots.
 	 */
@@ -369,6 +360,7 @@ private:
 
 #if BUILD_MEM_USAGE_TEST == 1
 	MemUsageTest _memTest;
+	TickRequest _memTestTickRequest;
 #endif
 
 #if BUILD_TWI == 1
@@ -379,9 +371,25 @@ private:
 	Gpio* _gpio = nullptr;
 #endif
 
-	app_timer_t _mainTimerData;
-	app_timer_id_t _mainTimerId;
-	TYPIFY(EVT_TICK) _tickCount = 0;
+	/**
+	 * Executes kickWatchdog() every WATCHDOG_KICK_INTERVAL_MS.
+	 */
+	Coroutine _watchdogRoutine;
+
+	/**
+	 * Stores the chip temperature in state every TEMPERATURE_STATE_INTERVAL_MS.
+	 */
+	Coroutine _temperatureRoutine;
+
+	/**
+	 * Logs the load stats every LOAD_STATS_INTERVAL_MS.
+	 */
+	Coroutine _loadStatsRoutine;
+
+	/**
+	 * Clears the GPREGRET reset counter once, CS_CLEAR_GPREGRET_COUNTER_TIMEOUT_S after boot.
+	 */
+	Coroutine _clearGpRegRetRoutine;
 
 	OperationMode _operationMode;
 	OperationMode _oldOperationMode = OperationMode::OPERATION_MODE_UNINITIALIZED;
@@ -399,6 +407,4 @@ private:
 	 * different than after a factory reset.
 	 */
 	bool _setStateValuesAfterStorageRecover = false;
-
-	bool _clearedGpRegRetCount              = false;
 };
@@ -40,6 +40,26 @@ public:
 	 */
 	bool set(uint8_t intensity, bool fade);
 
+	/**
+	 * Set dimmer intensity, fading with a given step size.
+	 *
+	 * @param[in] intensity       Intensity value to set: 0-100.
+	 * @param[in] fade            Whether to fade towards the new intensity. False will set it immediately.
+	 * @param[in] fadeStepSize    Intensity change per PWM update when fading: 1-100.
+	 * @return true on success.
+	 */
+	bool set(uint8_t intensity, bool fade, uint8_t fadeStepSize);
+
+	/**
+	 * Get the step size that is used to fade by default.
+	 */
+	uint8_t getSoftOnSpeed();
+
+	/**
+	 * Get the intensity the dimmer is at right now, which differs from the set intensity while fading.
+	 */
+	uint8_t getCurrentIntensity();
+
 	/**
 	 * Change the soft of speed.
 	 *
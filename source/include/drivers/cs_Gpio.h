@@ -9,6 +9,7 @@
 #include <ble/cs_Nordic.h>
 #include <cfg/cs_Boards.h>
 #include <cfg/cs_Config.h>
+#include <events/cs_CompatibilityTick.h>
 #include <events/cs_EventListener.h>
 
 #include <vector>
@@ -56,6 +57,12 @@ private:
 	//! Get regular ticks to send events
 	void tick();
 
+	//! Requested while any pin is configured to sense, so that tick() dispatches its events
+	TickRequest _tickRequest;
+
+	//! Request or release the tick, depending on whether any pin is configured to sense
+	void updateTickRequest();
+
 	//! Array of virtual pin info
 	pin_info_t _pins[TOTAL_PIN_COUNT];
 
@@ -11,6 +11,7 @@
 #include <modules/nrfx/hal/nrf_timer.h>
 #include <nrf_gpiote.h>
 
+#include <atomic>
 #include <cstdint>
 
 #include "ble/cs_Nordic.h"
@@ -29,6 +30,15 @@ typedef struct {
 	pwm_channel_config_t channels[CS_PWM_MAX_CHANNELS];
 } pwm_config_t;
 
+typedef struct {
+	//! Max time between the end of a period, and the start of the interrupt that updates the values.
+	uint32_t maxLatencyUs;
+	//! Number of periods in which a new duty cycle came too late: the timer already passed the new compare value.
+	uint32_t missedPeriodCount;
+	//! Number of values that were replaced by a newer value for the same channel, before being applied.
+	uint32_t coalescedCount;
+} pwm_stats_t;
+
 /** Pulse Wide Modulation class
  *
  * To turn on/off the power, as well as all intermediate stages, for example with dimming, the PWM class is used.
@@ -65,6 +75,11 @@ public:
 	 *
 	 * Each tick, the value will go towards target value by increasing or decreasing the actual value with 'speed'.
 	 *
+	 * The value is handed over to the interrupt at the end of the PWM period, which writes the compare values of all
+	 * channels at once, at the start of the next period. A value that is set before the previous value of the same
+	 * channel was handed over, replaces that previous value.
+	 * A value of 0 or 100 with speed 100 is applied at the end of the current period, without fading.
+	 *
 	 * @param[in] channel    Channel to set.
 	 * @param[in] value      Target value to set the channel to (0-100).
 	 * @param[in] speed      Speed at which to go to target value (1-100).
@@ -74,12 +89,8 @@ public:
 	//! Get current value of a specific channel.
 	uint8_t getValue(uint8_t channel);
 
-	/**
-	 * Function to be called on the end of the PWM period.
-	 *
-	 * Decoupled from interrupt.
-	 */
-	void onPeriodEnd();
+	//! Get the timing statistics of the value updates.
+	pwm_stats_t getStats();
 
 	//! Function to be called on a zero crossing interrupt.
 	void onZeroCrossingInterrupt();
@@ -122,15 +133,26 @@ private:
 	 */
 	void start();
 
+	/**
+	 * Take the values that were set since the previous period end, and apply those that should be set immediately.
+	 *
+	 * Called from the interrupt.
+	 */
+	void takeCommands();
+
 	/**
 	 * Check if the current value with the target value.
 	 *
 	 * If not equal, set the value.
+	 *
+	 * Called from the interrupt.
 	 */
 	void updateValues();
 
 	/**
 	 * Actually set the value in the peripheral.
+	 *
+	 * Called from the interrupt.
 	 */
 	void setValue(uint8_t channel, uint8_t newValue);
 
@@ -163,6 +185,28 @@ private:
 	//! Duty cycle values of the channels in ticks.
 	uint32_t _tickValues[CS_PWM_MAX_CHANNELS]        = {0};
 
+	//! Max timer counter value at the start of the interrupt.
+	uint32_t _maxLatencyTicks                        = 0;
+
+	//! Number of periods in which a compare value was written too late.
+	uint32_t _missedPeriodCount                      = 0;
+
+	//! Number of values that were replaced before being taken by the interrupt.
+	uint32_t _coalescedCount                         = 0;
+
+	//! Whether the transition channel is used in the current period.
+	bool _transitionChannelUsed                      = false;
+
+	static const uint32_t COMMAND_VALID              = 1 << 16;
+
+	/**
+	 * Values set by setValue(), to be taken by the interrupt, per channel.
+	 *
+	 * Packed as COMMAND_VALID | (stepSize << 8) | value, so that they can be handed over without locking.
+	 * 0 when there is no new value.
+	 */
+	std::atomic<uint32_t> _commands[CS_PWM_MAX_CHANNELS];
+
 	//! PPI channels to be used to trigger GPIOTE tasks from timer compare events. Turning the switch on.
 	nrf_ppi_channel_t _ppiChannelsOn[CS_PWM_MAX_CHANNELS];
 
@@ -206,6 +250,8 @@ private:
 	void writeCC(uint8_t channelIdx, uint32_t ticks);
 	//! Read CC of timer
 	uint32_t readCC(uint8_t channelIdx);
+	//! Capture and return the timer counter.
+	uint32_t captureCounter();
 
 	//! Enables the timer interrupt, to change the pwm value.
 	void enableInterrupt();
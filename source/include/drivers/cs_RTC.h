@@ -74,7 +74,14 @@ public:
 	 * allows for fast-forward/rewinding rtc time during tests.
 	 */
 	static void offsetMs(int ms);
-	static int _offsetMs;
+	static int64_t _offsetMs;
+
+	/**
+	 * Stops following the wall clock, so that only offsetMs() moves the rtc time.
+	 * Makes long simulations deterministic.
+	 */
+	static void freeze();
+	static bool _frozen;
 
 	/**
 	 * Acquires a start time to base the RTC tick values off of.
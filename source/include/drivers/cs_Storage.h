@@ -9,7 +9,9 @@
 #include <ble/cs_Nordic.h>
 #include <common/cs_Types.h>
 #include <components/libraries/fds/fds.h>
+#include <storage/cs_GarbageCollectionPolicy.h>
 #include <storage/cs_StateData.h>
+#include <storage/cs_StorageIndex.h>
 #include <util/cs_Utils.h>
 #include <test/cs_TestAccess.h>
 
@@ -23,6 +25,15 @@ enum cs_storage_operation_t {
 	CS_STORAGE_OP_GC,
 };
 
+struct storage_gc_stats_t {
+	//! Number of garbage collections that completed.
+	uint32_t count          = 0;
+	uint32_t lastDurationMs = 0;
+	uint32_t maxDurationMs  = 0;
+	//! Number of writes that failed because the flash was full.
+	uint32_t flashFullCount = 0;
+};
+
 typedef void (*cs_storage_error_callback_t)(cs_storage_operation_t operation, CS_TYPE type, cs_state_id_t id);
 
 /**
@@ -37,14 +48,20 @@ typedef void (*cs_storage_error_callback_t)(cs_storage_operation_t operation, CS
  *
  * CS_TYPE is used as record key.
  *
- * Garbage collection will be automatically started by this class when needed.
+ * Garbage collection will be automatically started by this class when a write fails because the flash is full.
+ * To avoid that, garbageCollectIfNeeded() should be called regularly, which starts garbage collection based on the
+ * flash usage, preferably when the device is idle.
  *
  * When a record is corrupted, most likely in case of power loss while writing, the CRC check will fail when opening a
  * file. In this case the record will be deleted (TODO).
  *
  * Only one record for each record key should exist. In case there are multiple (duplicates), they will be removed
  * (TODO). Since FDS always appends records, it is assumed that the last valid record should be kept. Checking for
- * duplicates is done for each write and each read.
+ * duplicates is done once, at init. When the last record can't be read, the earlier duplicates are searched for a valid
+ * one.
+ *
+ * To avoid iterating over all records in flash for each read and write, the record descriptors are kept in an index in
+ * RAM. The index is built at init, and kept up to date with the FDS events. See StorageIndex for the RAM it takes.
  *
  * Some operations will block other operations. For example, you can't write a record while performing garbage
  * collection. You can't write a record while it's already being written. This is what the "busy" functions are for.
@@ -110,6 +127,36 @@ public:
 	 */
 	cs_ret_code_t findNext(CS_TYPE type, cs_state_id_t& id);
 
+	/**
+	 * Find the first stored value, of any type.
+	 *
+	 * Values are found in order of type, then id.
+	 *
+	 * NOTE: you should complete or abort this findFirstOfAnyType() / findNextOfAnyType() before starting a new one.
+	 *
+	 * @param[out] type           Type of the found value.
+	 * @param[out] id             ID of the found value.
+	 *
+	 * @retval ERR_SUCCESS                  When successful.
+	 * @retval ERR_NOT_FOUND                When no value was found.
+	 * @retval ERR_BUSY                     When busy, try again later.
+	 */
+	cs_ret_code_t findFirstOfAnyType(CS_TYPE& type, cs_state_id_t& id);
+
+	/**
+	 * Find the next stored value, of any type.
+	 *
+	 * NOTE: must be called after findFirstOfAnyType(). Values may be read in between, but no other storage operations
+	 * should be done.
+	 *
+	 * @param[out] type           Type of the found value.
+	 * @param[out] id             ID of the found value.
+	 *
+	 * @retval ERR_SUCCESS                  When successful.
+	 * @retval ERR_NOT_FOUND                When there are no more values.
+	 */
+	cs_ret_code_t findNextOfAnyType(CS_TYPE& type, cs_state_id_t& id);
+
 	/**
 	 * Find and read stored value of given type and id.
 	 *
@@ -242,6 +289,31 @@ public:
 	 */
 	cs_ret_code_t garbageCollect();
 
+	/**
+	 * Start garbage collection when the flash usage asks for it.
+	 *
+	 * When the scheduler queue is quite full, the device is not considered idle.
+	 *
+	 * @param[in] idle            Whether the device is idle: no connections, and no pending writes.
+	 *
+	 * @retval ERR_SUCCESS                  When successfully started garbage collection.
+	 * @retval ERR_NOT_AVAILABLE            When garbage collection is not needed.
+	 * @retval ERR_BUSY                     When busy, try again later.
+	 */
+	cs_ret_code_t garbageCollectIfNeeded(bool idle);
+
+	/**
+	 * Get the flash usage.
+	 *
+	 * @param[out] usage          The flash usage.
+	 *
+	 * @retval ERR_SUCCESS                  When successful.
+	 * @retval ERR_NOT_INITIALIZED          When storage hasn't been initialized yet.
+	 */
+	cs_ret_code_t getUsage(storage_usage_t& usage);
+
+	const storage_gc_stats_t& getGarbageCollectionStats() { return _gcStats; }
+
 	/**
 	 * Erase all flash pages used by FDS.
 	 *
@@ -306,6 +378,16 @@ private:
 	bool _performingFactoryReset = false;
 	std::vector<uint16_t> _busyRecordKeys;
 
+	GarbageCollectionPolicy _gcPolicy{
+			STORAGE_GC_IDLE_FREEABLE_PERCENT, STORAGE_GC_IDLE_FREE_WORDS, STORAGE_GC_URGENT_FREE_WORDS};
+
+	storage_gc_stats_t _gcStats;
+
+	/**
+	 * RTC count at the start of the current garbage collection.
+	 */
+	uint32_t _gcStartCount  = 0;
+
 	/**
 	 * Next page to erase. Used by eraseAllPages().
 	 */
@@ -318,6 +400,19 @@ private:
 
 	CS_TYPE _eraseDoneEvent = CS_TYPE::CONFIG_DO_NOT_USE;
 
+	/**
+	 * Index of the valid records in flash.
+	 *
+	 * In case of duplicates, the last found record is indexed.
+	 * Records are moved by garbage collection, but FDS looks up the new location when a descriptor is used.
+	 */
+	StorageIndex<fds_record_desc_t> _index;
+
+	/**
+	 * Position in the index of the next value to be found by findNext() or readNext().
+	 */
+	uint16_t _searchPosition = 0;
+
 	/**
 	 * Find next fileId for given recordKey.
 	 */
@@ -328,12 +423,27 @@ private:
 	 */
 	cs_ret_code_t readNextInternal(uint16_t recordKey, uint16_t& fileId, uint8_t* buf, uint16_t size);
 
+	/**
+	 * Read the value of given recordKey and fileId.
+	 *
+	 * When the indexed record can't be read, an earlier duplicate is read instead, if there is a valid one.
+	 */
+	cs_ret_code_t readInternal(uint16_t recordKey, uint16_t fileId, uint8_t* buf, uint16_t size);
+
+	/**
+	 * Read the last valid record of given recordKey and fileId, by iterating over the records in flash.
+	 *
+	 * Skips the record with given record id. On success, the read record is indexed.
+	 */
+	cs_ret_code_t readDuplicate(uint16_t recordKey, uint16_t fileId, uint32_t skipRecordId, uint8_t* buf, uint16_t size);
+
 	/**
 	 * Read a record: copy data to buffer, and sets fileId.
 	 *
 	 * Only returns success when data has been copied to buffer.
+	 * The record descriptor is updated by FDS, when the record has been moved by garbage collection.
 	 */
-	cs_ret_code_t readRecord(fds_record_desc_t recordDesc, uint8_t* buf, uint16_t size, uint16_t& fileId);
+	cs_ret_code_t readRecord(fds_record_desc_t& recordDesc, uint8_t* buf, uint16_t size, uint16_t& fileId);
 
 	/** Write to persistent storage.
 	 */
@@ -389,6 +499,13 @@ private:
 
 	//	ret_code_t exists(cs_file_id_t fileId, uint16_t recordKey, bool & result);
 
+	/**
+	 * Build the index by iterating over all records in flash.
+	 *
+	 * Logs the duplicates it finds.
+	 */
+	void buildIndex();
+
 	/**
 	 * Check if a type of record exists and return the record descriptor.
 	 *
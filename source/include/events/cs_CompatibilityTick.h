@@ -0,0 +1,73 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <common/cs_Types.h>
+#include <util/cs_Coroutine.h>
+
+/**
+ * Dispatches EVT_TICK every TICK_INTERVAL_MS, for components that count ticks to measure time.
+ * A tick may be delayed by TICK_JITTER_MS, so that it shares a wake up with other coroutines.
+ *
+ * The tick only runs while at least one TickRequest is requested, so that a crownstone
+ * without such work doesn't have to wake up every TICK_INTERVAL_MS.
+ * Periodic work that has to be done anyway should be done by a Coroutine instead.
+ */
+class CompatibilityTick {
+public:
+	static CompatibilityTick& getInstance();
+
+	/**
+	 * Number of requests that keep the tick running.
+	 */
+	uint8_t getRequestCount() const { return _requestCount; }
+
+private:
+	friend class TickRequest;
+
+	CompatibilityTick();
+	CompatibilityTick(CompatibilityTick const&) = delete;
+	void operator=(CompatibilityTick const&)    = delete;
+
+	Coroutine _tickRoutine;
+	TYPIFY(EVT_TICK) _tickCount = 0;
+	uint8_t _requestCount       = 0;
+
+	void addRequest();
+	void removeRequest();
+	void tick();
+};
+
+/**
+ * Keeps the CompatibilityTick running while requested.
+ *
+ * A component that listens to EVT_TICK owns one, and requests it while it has something to count down.
+ */
+class TickRequest {
+public:
+	TickRequest() = default;
+	~TickRequest() { release(); }
+
+	TickRequest(const TickRequest&)            = delete;
+	TickRequest& operator=(const TickRequest&) = delete;
+
+	/**
+	 * Request EVT_TICK. Does nothing when already requested.
+	 */
+	void request();
+
+	/**
+	 * Release the request. Does nothing when not requested.
+	 * May be called while handling EVT_TICK.
+	 */
+	void release();
+
+	bool isRequested() const { return _requested; }
+
+private:
+	bool _requested = false;
+};
@@ -118,7 +118,7 @@ private:
 	/**
 	 * When this value is not 0, the filters are being modified.
 	 *
-	 * Reduced by 1 every tick.
+	 * Reduced by 1 every second.
 	 */
 	uint16_t _modificationInProgressCountdown = 0;
 
@@ -228,7 +228,7 @@ private:
 	 */
 	void handleGetFilterSummariesCommand(cs_result_t& result);
 
-	void onTick();
+	void onTickSecond();
 
 	// -------------------------------------------------------------
 	// ---------------------- Utility functions --------------------
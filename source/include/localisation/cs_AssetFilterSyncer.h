@@ -11,25 +11,52 @@
 #include <events/cs_EventListener.h>
 #include <localisation/cs_AssetFilterStore.h>
 #include <protocol/cs_Typedefs.h>
+#include <util/cs_Coroutine.h>
 
 /**
  * Class that takes care of synchronizing the asset filters between crownstones.
  *
- * - Regularly informs other crownstones of the master version and CRC.
- * - Will connect and update the asset filters of a crownstone with an older master version.
+ * - Informs neighbouring crownstones of the master version and CRC, using a trickle timer:
+ *   the interval doubles each time, up to the max interval, and is reset to the min interval on any inconsistency.
+ *   When enough neighbours advertised the same version during an interval, we don't send ours.
+ * - Will download the filters, chunk by chunk, over the mesh from a neighbour with a newer master version.
+ *   Filters that we already have, with the same CRC, are skipped after their first chunk.
+ * - Serves filter chunks to neighbours that request them.
+ * - Will connect and update the asset filters of a crownstone with an older master version,
+ *   when it keeps advertising an older version (for example because it doesn't support mesh download).
  */
 class AssetFilterSyncer : public EventListener, public Component {
 public:
 	/**
-	 * Interval at which the master version is broadcasted.
+	 * Min and max interval of the trickle timer that broadcasts the master version.
 	 */
 	constexpr static uint16_t VERSION_BROADCAST_NORMAL_INTERVAL_SECONDS = 5 * 60;
 	constexpr static uint16_t VERSION_BROADCAST_LOW_INTERVAL_SECONDS    = 1;
 
 	/**
-	 * How long the low interval will be used after setting it to low interval.
+	 * Don't send our version when we heard the same version this many times during the current interval.
 	 */
-	constexpr static uint16_t VERSION_BROADCAST_INTERVAL_RESET_SECONDS  = 60;
+	constexpr static uint8_t VERSION_BROADCAST_REDUNDANCY               = 2;
+
+	/**
+	 * Timeout of a chunk request, and how often we retry a chunk request before giving up the download.
+	 */
+	constexpr static uint16_t MESH_CHUNK_REQUEST_TIMEOUT_SECONDS        = 5;
+	constexpr static uint8_t MESH_CHUNK_REQUEST_MAX_RETRIES             = 3;
+
+	/**
+	 * After this many failed downloads in a row of the same version from the same stone, we stop downloading from it.
+	 * Instead, we inform it of our older version, so that it connects to us (for example because it doesn't support
+	 * mesh download).
+	 */
+	constexpr static uint8_t MESH_DOWNLOAD_MAX_ATTEMPTS                 = 2;
+
+	/**
+	 * After hearing an older version this many times in a row from the same stone, we connect to it instead.
+	 */
+	constexpr static uint8_t MESH_SYNC_FALLBACK_VERSION_COUNT           = 3;
+
+	AssetFilterSyncer();
 
 	/**
 	 * Init the class:
@@ -41,7 +68,16 @@ private:
 	/**
 	 * Async steps that are taken when synchronizing filters to another crownstone.
 	 */
-	enum class SyncStep { NONE, CONNECT, GET_FILTER_SUMMARIES, REMOVE_FILTERS, UPLOAD_FILTERS, COMMIT, DISCONNECT };
+	enum class SyncStep {
+		NONE,
+		CONNECT,
+		GET_FILTER_SUMMARIES,
+		REMOVE_FILTERS,
+		UPLOAD_FILTERS,
+		COMMIT,
+		DISCONNECT,
+		MESH_DOWNLOAD
+	};
 
 	/**
 	 * Results of comparing master version with another crownstone.
@@ -81,14 +117,57 @@ private:
 	uint8_t _filterRemoveCount;
 
 	/**
-	 * Countdown counter that keeps track when the send version interval should go back to normal again.
+	 * Trickle timer: current interval, time in the current interval at which to send our version,
+	 * whether that time has passed, and number of times we heard our own version this interval.
+	 */
+	uint32_t _trickleIntervalMs       = 0;
+	uint32_t _trickleSendAtMs         = 0;
+	bool _trickleSendAtPassed         = false;
+	uint8_t _trickleConsistentCount   = 0;
+
+	/**
+	 * Runs at the send time, and at the end of each trickle interval.
+	 */
+	Coroutine _trickleRoutine;
+
+	/**
+	 * Stone we download filters from over the mesh, and the master version and CRC we're downloading.
 	 */
-	uint16_t _sendVersionAtLowIntervalCountdown = 0;
+	stone_id_t _meshSourceId          = 0;
+	uint16_t _meshMasterVersion       = 0;
+	uint32_t _meshMasterCrc           = 0;
 
 	/**
-	 * Countdown counter that keeps track when to call sendVersion again.
+	 * Bitmask of filter IDs of the version we're downloading, only valid after the first chunk is received.
 	 */
-	uint16_t _sendVersionCountdown              = 0;
+	uint8_t _meshFilterIdBitmask      = 0;
+	bool _meshFilterIdBitmaskReceived = false;
+
+	/**
+	 * Filter ID and chunk start index we requested.
+	 * When the chunk start index is 0, any filter ID equal to or larger than the requested is accepted.
+	 */
+	uint8_t _meshFilterId             = 0;
+	uint16_t _meshChunkStartIndex     = 0;
+
+	/**
+	 * Times out the chunk request, and the number of retries done.
+	 */
+	Coroutine _meshRequestTimeoutRoutine;
+	uint8_t _meshRequestRetries       = 0;
+
+	/**
+	 * Stone and master version of the last failed download, and how many downloads of it failed in a row.
+	 */
+	stone_id_t _meshFailedSourceId    = 0;
+	uint16_t _meshFailedVersion       = 0;
+	uint8_t _meshFailedCount          = 0;
+
+	/**
+	 * Last stone that advertised an older version, and how often in a row it did so.
+	 */
+	stone_id_t _olderStoneId          = 0;
+	uint8_t _olderStoneVersionCount   = 0;
 
 	/**
 	 * Sends the master version and CRC over the mesh.
@@ -96,9 +175,14 @@ private:
 	void sendVersion(bool reliable);
 
 	/**
-	 * Send version at a low interval for some time.
+	 * Reset the trickle timer to the min interval, so that the version is sent soon.
+	 */
+	void resetTrickleTimer();
+
+	/**
+	 * Start a new trickle interval: picks a random moment in the second half of the interval to send our version.
 	 */
-	void sendVersionAtLowInterval();
+	void startTrickleInterval();
 
 	/**
 	 * Set the current step of the sync process.
@@ -134,6 +218,52 @@ private:
 	 */
 	void done();
 
+	/**
+	 * Start downloading the filters of given master version from a neighbour over the mesh.
+	 */
+	void startMeshDownload(stone_id_t stoneId, uint16_t masterVersion, uint32_t masterCrc);
+
+	/**
+	 * Request the chunk at _meshFilterId and _meshChunkStartIndex.
+	 */
+	void requestMeshChunk();
+
+	/**
+	 * Whether we already have the committed filter with given ID and CRC, so that it doesn't have to be downloaded.
+	 */
+	bool hasFilter(uint8_t filterId, uint32_t filterCrc);
+
+	/**
+	 * Remove the filters that are not part of the version we're downloading.
+	 */
+	void removeFiltersNotInMeshDownload();
+
+	/**
+	 * All filters are downloaded: commit them. The store checks the master CRC.
+	 */
+	void commitMeshDownload();
+
+	/**
+	 * Abort the download, and remember that it failed.
+	 */
+	void onMeshDownloadFailed();
+
+	/**
+	 * Handle a received chunk request: send the requested chunk to the requesting stone.
+	 */
+	cs_ret_code_t onMeshChunkRequest(stone_id_t stoneId, cs_mesh_model_msg_asset_filter_chunk_request_t& packet);
+
+	/**
+	 * Handle a received chunk.
+	 */
+	cs_ret_code_t onMeshChunk(stone_id_t stoneId, cs_data_t& payload);
+
+	/**
+	 * Upload a downloaded chunk to the store.
+	 */
+	cs_ret_code_t uploadMeshChunk(
+			const cs_mesh_model_msg_asset_filter_chunk_header_t& header, const uint8_t* chunk, uint16_t chunkSize);
+
 	/**
 	 * Handle a received version mesh message.
 	 */
@@ -153,9 +283,14 @@ private:
 	void onFilterSummaries(cs_data_t& payload);
 
 	/**
-	 * Handle the tick event.
+	 * Sends our version at the send time of the trickle interval, and starts the next interval at the end.
+	 */
+	void onTrickleTimer();
+
+	/**
+	 * Requests the chunk again, or gives up the download after too many retries.
 	 */
-	void onTick(uint32_t tickCount);
+	void onMeshRequestTimeout();
 
 public:
 	/**
@@ -10,8 +10,11 @@
 #include <common/cs_Component.h>
 #include <events/cs_EventListener.h>
 #include <localisation/cs_AssetHandler.h>
+#include <localisation/cs_AssetRateController.h>
 #include <localisation/cs_AssetRecord.h>
+#include <localisation/cs_AssetStore.h>
 #include <protocol/mesh/cs_MeshModelPackets.h>
+#include <util/cs_Coroutine.h>
 
 /**
  * AssetForwarder makes it possible for the AssetFiltering to merge mesh messages when
@@ -25,16 +28,20 @@
  * cancel your plans.
  *
  * By passing an asset_record along the flush() function will update the throttling counter.
+ *
+ * The rate at which messages are sent over the mesh, is controlled by the AssetRateController, which keeps the total
+ * asset traffic on the mesh within ASSET_MESH_BUDGET_MSGS_PER_MINUTE. Messages are always sent over UART.
  */
 class AssetForwarder : public EventListener, public Component {
 public:
-	static constexpr uint16_t MIN_THROTTLED_ADVERTISEMENT_PERIOD_MS = 1000;
+	AssetForwarder();
 
 	cs_ret_code_t init();
 
 	/**
 	 * Sends the mesh messages in the outbox and clears it.
 	 * Updates the records throttling counters.
+	 * Messages that exceed the rate of the AssetRateController are only sent over UART.
 	 *
 	 * Messages are sent over both Uart and Mesh
 	 */
@@ -66,15 +73,21 @@ public:
 	bool sendAssetIdToMesh(
 			asset_record_t* record, const scanned_device_t& asset, const asset_id_t& assetId, uint8_t filterBitmask);
 
-	/**
-	 * sets how many ticks will be added to records upon sending a message.
-	 */
-	void setThrottleCountdownBumpTicks(uint8_t ticks);
-
 private:
 	stone_id_t _myStoneId;
+	AssetStore* _assetStore = nullptr;
 
-	uint8_t _throttleCountdownBumpTicks = 0;
+	AssetRateController _rateController;
+
+	/**
+	 * Ticks the rate controller every TICK_INTERVAL_MS, until it's steady.
+	 */
+	Coroutine _rateControllerRoutine;
+
+	/**
+	 * Report number of the last sent asset ID report, 0 is skipped.
+	 */
+	uint8_t _reportCounter = 0;
 
 	struct outbox_msg_t {
 		asset_record_t* record;
@@ -107,9 +120,11 @@ private:
 	 * validates the message, then
 	 * update throttle
 	 * send over uart
+	 * request the rate controller
+	 * update mesh throttle
 	 * send over mesh
 	 *
-	 * returns true if message was valid
+	 * returns true if message was sent over the mesh
 	 */
 	bool dispatchOutboxMessage(outbox_msg_t& outMsg);
 
@@ -141,9 +156,15 @@ private:
 	void forwardAssetToUart(const cs_mesh_model_msg_asset_report_mac_t& assetMsg, stone_id_t seenByStoneId);
 	void forwardAssetToUart(const cs_mesh_model_msg_asset_report_id_t& assetMsg, stone_id_t seenByStoneId);
 
+	/**
+	 * Start ticking the rate controller, to be called after the rate controller was fed.
+	 */
+	void startRateController();
+
 public:
 	/**
 	 * Forwards relevant incoming mesh messages to UART.
+	 * Feeds the rate controller.
 	 */
 	virtual void handleEvent(event_t& event);
 };
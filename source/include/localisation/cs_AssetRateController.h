@@ -0,0 +1,161 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Limits the number of asset reports this crownstone sends over the mesh,
+ * so that the asset reports of all crownstones together stay within a budget.
+ *
+ * Every window, the total number of asset reports on the mesh (sent and received) is compared with the budget:
+ * - When over budget, or when the mesh queue was full, the send rate of this crownstone is halved.
+ * - Else, the send rate is increased by a fixed step.
+ * The send rate is enforced with a token bucket.
+ *
+ * Each asset report is followed by a throttle interval for that asset. This interval is increased when the token
+ * bucket runs empty, and slowly decreased when there are tokens to spare. Assets with a stable RSSI get a longer
+ * interval than moving assets.
+ *
+ * The budget is expressed in messages, as each asset report is a single unsegmented mesh message.
+ */
+class AssetRateController {
+public:
+	/**
+	 * Duration of a control window.
+	 */
+	static constexpr uint16_t WINDOW_TICKS                = 50;
+
+	/**
+	 * Minimum and maximum throttle interval after an asset report.
+	 *
+	 * The maximum is limited by the 8 bit throttle countdown of the asset records.
+	 */
+	static constexpr uint16_t MIN_REPORT_INTERVAL_TICKS   = 10;
+	static constexpr uint16_t MAX_REPORT_INTERVAL_TICKS   = 250;
+
+	/**
+	 * Step at which the throttle interval is decreased, each window.
+	 */
+	static constexpr uint16_t REPORT_INTERVAL_STEP_TICKS  = 5;
+
+	/**
+	 * Assets with an RSSI change smaller than this are considered stable.
+	 */
+	static constexpr uint8_t MOVING_RSSI_DELTA            = 6;
+
+	/**
+	 * The throttle interval of stable assets is multiplied by this factor.
+	 */
+	static constexpr uint8_t STABLE_INTERVAL_MULTIPLIER   = 4;
+
+	/**
+	 * Step at which the send rate is increased, in messages per window.
+	 */
+	static constexpr uint16_t RATE_INCREASE_STEP          = 1;
+
+	/**
+	 * Minimal send rate, in messages per window.
+	 */
+	static constexpr uint16_t MIN_RATE                    = 1;
+
+	/**
+	 * @param[in] budgetPerMinute      Maximum number of asset reports on the mesh per minute, of all crownstones.
+	 * @param[in] tickIntervalMs       Interval at which tick() is called.
+	 */
+	AssetRateController(uint16_t budgetPerMinute, uint16_t tickIntervalMs);
+
+	/**
+	 * Set the maximum number of asset reports on the mesh per minute, of all crownstones.
+	 */
+	void setBudget(uint16_t budgetPerMinute);
+
+	/**
+	 * Request to send a report for an asset.
+	 *
+	 * @param[in] rssiDelta            Absolute RSSI change since the last report of this asset.
+	 * @param[out] intervalTicks       Number of ticks the asset should be throttled after this call.
+	 *
+	 * @return true when the report may be sent.
+	 */
+	bool requestReport(uint8_t rssiDelta, uint16_t& intervalTicks);
+
+	/**
+	 * To be called with the result of sending an asset report over the mesh.
+	 *
+	 * @param[in] queueFull            True when the report couldn't be sent, because the mesh queue was full.
+	 */
+	void onReportSent(bool queueFull);
+
+	/**
+	 * To be called when an asset report of another crownstone is received via the mesh.
+	 */
+	void onReportReceived();
+
+	/**
+	 * To be called at a regular interval, while not steady.
+	 */
+	void tick();
+
+	/**
+	 * Whether calls to tick() would change nothing, until a report is requested, sent or received.
+	 *
+	 * This is the case when the token bucket is full, the send rate is at the budget,
+	 * the throttle interval is at its minimum, and nothing happened in the current window.
+	 */
+	bool isSteady() const;
+
+	/**
+	 * Current send rate, in messages per window.
+	 */
+	uint16_t getRate() const { return _rate; }
+
+	/**
+	 * Current throttle interval of moving assets.
+	 */
+	uint16_t getReportIntervalTicks() const { return _reportIntervalTicks; }
+
+private:
+	/**
+	 * Budget per window, of all crownstones together.
+	 */
+	uint16_t _budget;
+
+	/**
+	 * Length of a minute in ticks.
+	 */
+	uint16_t _ticksPerMinute;
+
+	/**
+	 * Allowed number of reports sent by this crownstone, per window.
+	 */
+	uint16_t _rate                  = 0;
+
+	/**
+	 * Token bucket, a single report costs WINDOW_TICKS tokens, each tick adds _rate tokens.
+	 */
+	uint32_t _tokens                = 0;
+
+	/**
+	 * Current throttle interval of moving assets.
+	 */
+	uint16_t _reportIntervalTicks   = MIN_REPORT_INTERVAL_TICKS;
+
+	uint16_t _windowTicks           = 0;
+
+	// Statistics of the current window.
+	uint16_t _windowSentCount       = 0;
+	uint16_t _windowReceivedCount   = 0;
+	uint16_t _windowDeniedCount     = 0;
+	bool _windowQueueFull           = false;
+
+	/**
+	 * Adjusts the rate and interval at the end of a window.
+	 */
+	void onWindowEnd();
+};
@@ -21,18 +21,16 @@ struct __attribute__((__packed__)) asset_record_t {
 	rssi_and_channel_t myRssi;
 
 	/**
-	 * Set to 0 each time this asset is scanned.
-	 * Increment at regular interval.
-	 *
-	 * Value of 0xFF marks the record invalid.
+	 * A valid record has a timeout scheduled in the AssetStore.
+	 * The AssetStore also keeps track of the time since the asset was last scanned, and of the throttling.
 	 */
-	uint8_t lastReceivedCounter = 0xFF;
+	bool valid              = false;
 
 	/**
-	 * When not 0, no mesh message should be sent for this asset.
-	 * Decrement at regular interval.
+	 * RSSI of the last report that was sent for this asset.
+	 * Used to determine whether the asset is moving.
 	 */
-	uint8_t throttlingCountdown = 0;
+	int8_t lastReportedRssi = 0;
 
 #if BUILD_CLOSEST_CROWNSTONE_TRACKER == 1
 	/**
@@ -54,14 +52,14 @@ struct __attribute__((__packed__)) asset_record_t {
 	 * Invalidate this record.
 	 */
 	void invalidate() {
-		lastReceivedCounter = 0xFF;
+		valid = false;
 	}
 
 	/**
 	 * Returns whether this record is valid.
 	 */
 	bool isValid() {
-		return lastReceivedCounter != 0xFF;
+		return valid;
 	}
 
 	asset_id_t id() {
@@ -71,28 +69,10 @@ struct __attribute__((__packed__)) asset_record_t {
 	// ------------- utility functions -------------
 
 	void empty() {
-		lastReceivedCounter = 0;
-		throttlingCountdown = 0;
+		valid            = true;
+		lastReportedRssi = 0;
 #if BUILD_CLOSEST_CROWNSTONE_TRACKER == 1
 		nearestStoneId = 0;
 #endif
 	}
-
-	bool isThrottled() {
-		return throttlingCountdown != 0;
-	}
-
-	void setThrottlingCountdown(uint8_t ticks) {
-		if (ticks >= 0xff) {
-			throttlingCountdown = 0xff - 1;
-		}
-		else {
-			throttlingCountdown = ticks;
-		}
-	}
-
-	void addThrottlingCountdown(uint8_t ticks) {
-		auto val = uint16_t(throttlingCountdown) + ticks;
-		setThrottlingCountdown(val);
-	}
 };
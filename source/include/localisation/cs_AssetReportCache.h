@@ -0,0 +1,82 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <protocol/cs_Typedefs.h>
+#include <protocol/mesh/cs_MeshModelPackets.h>
+
+#include <cstdint>
+
+/**
+ * Remembers recently handled asset ID reports, so that copies of a report can be ignored.
+ *
+ * The same report may arrive multiple times, via different relay paths. Copies have the same report number, while a
+ * new report with the same content has a different number. Reports without number (sent by older firmware) can't be
+ * told apart from copies, so they are never considered to be a copy.
+ *
+ * The number of lookups that found a copy (hits) and that didn't (misses) are counted.
+ */
+class AssetReportCache {
+public:
+	/**
+	 * Number of recent reports that are remembered.
+	 */
+	static constexpr uint8_t SIZE          = 16;
+
+	/**
+	 * Time a report is remembered.
+	 */
+	static constexpr uint8_t TIMEOUT_TICKS = 5;
+
+	/**
+	 * Whether a copy of the report was recently added.
+	 */
+	bool contains(const cs_mesh_model_msg_asset_report_id_t& report, stone_id_t reporter) const;
+
+	/**
+	 * Remember a handled report, overwriting the oldest entry.
+	 */
+	void add(const cs_mesh_model_msg_asset_report_id_t& report, stone_id_t reporter);
+
+	/**
+	 * Count the result of a lookup.
+	 */
+	void countLookup(bool hit);
+
+	/**
+	 * Expire entries, should be called every tick while not empty.
+	 */
+	void onTick();
+
+	/**
+	 * Whether all entries are expired.
+	 */
+	bool isEmpty() const;
+
+	uint32_t getHitCount() const { return _hitCount; }
+
+	uint32_t getMissCount() const { return _missCount; }
+
+private:
+	struct __attribute__((__packed__)) entry_t {
+		asset_id_t assetId;
+		stone_id_t reporterId;
+		//! Report number, as set by the reporter.
+		uint8_t counter;
+		//! Countdown until this entry expires, 0 when the entry is unused.
+		uint8_t ticksLeft;
+	};
+
+	entry_t _entries[SIZE] = {};
+
+	uint8_t _nextIndex     = 0;
+
+	uint32_t _hitCount     = 0;
+
+	uint32_t _missCount    = 0;
+};
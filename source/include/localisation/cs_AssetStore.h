@@ -11,6 +11,7 @@
 #include <localisation/cs_AssetRecord.h>
 #include <util/cs_Coroutine.h>
 #include <util/cs_Store.h>
+#include <util/cs_TimingWheel.h>
 
 class AssetStore : public EventListener, public Component {
 public:
@@ -24,15 +25,21 @@ public:
 	static constexpr uint8_t LAST_RECEIVED_TIMEOUT_THRESHOLD_S = 250;
 
 	/**
-	 * Interval at which the timeout counter is increased, should be 1 second.
+	 * Interval at which the timeouts tick, should be 1 second.
 	 */
 	static constexpr auto LAST_RECEIVED_COUNTER_PERIOD_MS      = 1000;
 
 	/**
-	 * Interval at which the throttle countdown is decreased.
+	 * Interval at which the throttling countdowns tick.
 	 */
 	static constexpr auto THROTTLE_COUNTER_PERIOD_MS           = 100;
 
+	/**
+	 * The timeouts don't have to be exact, so they may tick a bit late, together with other work.
+	 */
+	static constexpr auto LAST_RECEIVED_COUNTER_JITTER_MS      = 100;
+	static constexpr auto THROTTLE_COUNTER_JITTER_MS           = 50;
+
 	// ===================== public methods =====================
 
 	AssetStore();
@@ -43,7 +50,7 @@ public:
 	/**
 	 * Get or create a record for the given assetId.
 	 * Then update rssi values according to the incoming scan and
-	 * revert the lastReceivedCounter to 0.
+	 * restart the timeout of the record.
 	 *
 	 * Returns the adjusted record if found, else returns nullptr
 	 */
@@ -56,12 +63,42 @@ public:
 	asset_record_t* getRecord(const asset_id_t& id);
 
 	/**
-	 * Adds a value to the records' throttlingCountdownTicks.
-	 * This will ensure that the record.isThrottled() will be true
+	 * Returns the number of LAST_RECEIVED_COUNTER_PERIOD_MS periods since the asset of the record was last scanned.
+	 */
+	uint8_t getLastReceivedCounter(asset_record_t& record);
+
+	/**
+	 * Returns whether no report should be sent for the asset of the record, over UART or mesh.
+	 */
+	bool isThrottled(asset_record_t& record);
+
+	/**
+	 * Returns the number of THROTTLE_COUNTER_PERIOD_MS periods until the record is no longer throttled.
+	 */
+	uint16_t getThrottlingCountdown(asset_record_t& record);
+
+	/**
+	 * Adds a number of THROTTLE_COUNTER_PERIOD_MS periods to the throttling countdown of the record.
+	 */
+	void addThrottlingCountdown(asset_record_t& record, uint16_t ticks);
+
+	/**
+	 * Adds a value to the records' throttling countdown.
+	 * This will ensure that isThrottled(record) will be true
 	 * for (at least) timeToNextThrottleOpenMs.
 	 */
 	void addThrottlingBump(asset_record_t& record, uint16_t timeToNextThrottleOpenMs);
 
+	/**
+	 * Returns whether reports of the asset of the record should only be sent over UART, not over the mesh.
+	 */
+	bool isMeshThrottled(asset_record_t& record);
+
+	/**
+	 * Sets the mesh throttling countdown of the record, in THROTTLE_COUNTER_PERIOD_MS periods.
+	 */
+	void setMeshThrottlingCountdown(asset_record_t& record, uint16_t ticks);
+
 	/**
 	 * Convert ms to ticks, rounding fractional parts upwards.
 	 */
@@ -69,12 +106,33 @@ public:
 
 private:
 	// =================== private settings ===================
-	static constexpr auto MAX_RECORDS = 50u;
+	static constexpr auto MAX_RECORDS            = 50u;
+
+	/**
+	 * Maximum of the throttling countdowns.
+	 */
+	static constexpr uint16_t MAX_THROTTLE_TICKS = 0xFF - 1;
 
 	// =================== private variables ===================
 
 	Store<asset_record_t, MAX_RECORDS> _store;
 
+	/**
+	 * Times out the records, ticks every LAST_RECEIVED_COUNTER_PERIOD_MS.
+	 * The timer index is the index of the record in the store.
+	 */
+	TimingWheel<MAX_RECORDS> _timeouts;
+
+	/**
+	 * Throttling countdowns of the records, ticks every THROTTLE_COUNTER_PERIOD_MS.
+	 * The timer index is the index of the record in the store for the throttling countdown,
+	 * and MAX_RECORDS plus that index for the mesh throttling countdown.
+	 */
+	TimingWheel<2 * MAX_RECORDS> _throttles;
+
+	/**
+	 * Tick the timeouts and the throttling countdowns, while any is scheduled.
+	 */
 	Coroutine updateLastReceivedCounterRoutine;
 	Coroutine updateLastSentCounterRoutine;
 
@@ -88,12 +146,22 @@ private:
 	asset_record_t* getOrCreateRecord(const asset_id_t& id);
 
 	/**
-	 * Adds 1 to the update/sent counters of all valid records, until 0xff is reached.
+	 * Returns the index of a record in the store.
+	 */
+	uint8_t getIndex(asset_record_t& record);
+
+	/**
+	 * Schedules a throttling countdown, and starts ticking the throttling countdowns.
+	 */
+	void scheduleThrottling(uint8_t index, uint16_t ticks);
+
+	/**
+	 * Clears the throttling countdowns of the record at given index.
 	 */
-	void incrementLastReceivedCounters();
+	void clearThrottling(uint8_t index);
 
 	/**
-	 * Decrements throttlingCountdownTicks by 1of all valid records, until zero is reached.
+	 * Ticks the timeouts, and invalidates the records that timed out.
 	 */
-	void decrementThrottlingCounters();
+	void tickTimeouts();
 };
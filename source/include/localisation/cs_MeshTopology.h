@@ -7,8 +7,12 @@
 
 #pragma once
 
+#include <events/cs_CompatibilityTick.h>
 #include <events/cs_EventListener.h>
 #include <protocol/cs_MeshTopologyPackets.h>
+#include <protocol/mesh/cs_MeshModelPackets.h>
+#include <test/cs_TestAccess.h>
+#include <util/cs_TimingWheel.h>
 
 #include <cstdint>
 
@@ -20,9 +24,21 @@
  * Keeps track of the rssi distance of this crownstone to
  * the crownstones in its direct environment.
  *
+ * The neighbours are sent over the mesh as a digest with quantised RSSI.
+ * A digest is sent when the RSSI of a neighbour changed significantly, or when a neighbour is lost.
+ * Next to that, all neighbours are sent at a slow interval, so that missed messages are corrected.
+ *
+ * Crownstones with older firmware only know the old neighbour RSSI message. As long as such a crownstone is heard,
+ * each neighbour is also sent in the old message, at the old interval. The old messages of crownstones that send the
+ * digest are ignored, as the digest has the same links.
+ *
+ * When UART is enabled, the received digests are kept, so that the whole topology can be requested at once.
+ *
  * Several related commands are available over UART.
  */
 class MeshTopology: EventListener {
+	friend class TestAccess<MeshTopology>;
+
 	/**
 	 * Set this to true to make every crownstone in the sphere to send a noop message
 	 * on every tick, and make every crownstone respond with a neighbor message with that rssi.
@@ -45,10 +61,12 @@ public:
 	 *  - CMD_MESH_TOPO_GET_RSSI
 	 *  - CMD_MESH_TOPO_RESET
 	 *  - CMD_MESH_TOPO_GET_MAC
+	 *  - CMD_MESH_TOPO_GET_MATRIX
 	 *
 	 * Internal usage:
 	 *  - EVT_RECV_MESH_MSG
-	 *  - EVT_TICK
+	 *  - EVT_TICK_SECOND
+	 *  - EVT_TICK, only for TripwireResearch
 	 */
 	void handleEvent(event_t &evt);
 
@@ -78,7 +96,7 @@ public:
 	static constexpr uint8_t TIMEOUT_SECONDS                           = 3 * 60;
 
 	/**
-	 * Interval at which a mesh messages is sent for each neighbour.
+	 * Interval at which a mesh messages is sent for each neighbour, regardless of changes.
 	 */
 	static constexpr uint16_t SEND_INTERVAL_SECONDS_PER_NEIGHBOUR      = 5 * 60;
 	static constexpr uint16_t SEND_INTERVAL_SECONDS_PER_NEIGHBOUR_FAST = 10;
@@ -96,9 +114,58 @@ public:
 	 */
 	static constexpr uint16_t FAST_INTERVAL_TIMEOUT_SECONDS            = 5 * 60;
 
+	/**
+	 * Minimal change of the quantised RSSI of a neighbour, before it is sent again.
+	 */
+	static constexpr uint8_t DIGEST_RSSI_THRESHOLD                     = 2;
+
+	/**
+	 * Minimal interval between digests that are sent because of changes.
+	 */
+	static constexpr uint8_t DIGEST_DELTA_INTERVAL_SECONDS             = 2;
+
+	/**
+	 * RSSI range that can be sent in a digest: from RSSI_QUANTISATION_MIN, in steps of RSSI_QUANTISATION_STEP.
+	 */
+	static constexpr int8_t RSSI_QUANTISATION_MIN                      = -100;
+	static constexpr uint8_t RSSI_QUANTISATION_STEP                    = 3;
+
+	/**
+	 * Maximum number of lost neighbours that still have to be sent.
+	 */
+	static constexpr uint8_t MAX_PENDING_REMOVALS                      = 4;
+
+	/**
+	 * Maximum number of links between other crownstones that are kept.
+	 */
+	static constexpr uint16_t MAX_LINKS                                = 200;
+
+	/**
+	 * Time after last update, before a link between other crownstones is removed.
+	 *
+	 * Should be larger than SEND_INTERVAL_SECONDS_PER_NEIGHBOUR.
+	 */
+	static constexpr uint8_t LINK_TIMEOUT_MINUTES                      = 15;
+
+	/**
+	 * Time after the last old neighbour RSSI message of a crownstone that doesn't send the digest, before the old
+	 * message is no longer sent.
+	 *
+	 * Should be larger than SEND_INTERVAL_SECONDS_PER_NEIGHBOUR.
+	 */
+	static constexpr uint8_t LEGACY_TIMEOUT_MINUTES                    = 15;
 
 private:
-	static constexpr uint8_t INDEX_NOT_FOUND = 0xFF;
+	static constexpr uint8_t INDEX_NOT_FOUND      = 0xFF;
+
+	/**
+	 * Size of the hash index of the neighbours list.
+	 *
+	 * Must be a power of 2, and larger than MAX_NEIGHBOURS.
+	 */
+	static constexpr uint8_t NEIGHBOUR_INDEX_SIZE = 128;
+	static_assert((NEIGHBOUR_INDEX_SIZE & (NEIGHBOUR_INDEX_SIZE - 1)) == 0);
+	static_assert(NEIGHBOUR_INDEX_SIZE > MAX_NEIGHBOURS);
 
 	static constexpr int8_t RSSI_INIT        = 0;  // Should be in protocol
 
@@ -107,7 +174,18 @@ private:
 		int8_t rssiChannel37;
 		int8_t rssiChannel38;
 		int8_t rssiChannel39;
-		uint8_t lastSeenSecondsAgo;
+		// The quantised RSSI that was last sent over the mesh.
+		cs_mesh_model_quantised_rssi_t reportedRssi;
+	};
+
+	/**
+	 * RSSI between 2 other crownstones, as received via a digest.
+	 */
+	struct __attribute__((__packed__)) link_t {
+		stone_id_t receiverId;
+		stone_id_t senderId;
+		cs_mesh_model_quantised_rssi_t rssi;
+		uint8_t lastUpdateMinutesAgo;
 	};
 
 	// ---------------------------------------
@@ -129,6 +207,38 @@ private:
 	 */
 	uint8_t _neighbourCount       = 0;
 
+	/**
+	 * Times out the neighbours, ticks every second.
+	 * The timer index is the index of the neighbour in the list.
+	 */
+	TimingWheel<MAX_NEIGHBOURS> _timeouts;
+
+	/**
+	 * Only requested for TripwireResearch.
+	 */
+	TickRequest _tripwireTickRequest;
+
+	/**
+	 * Open addressing hash table: maps stone ID to index in the neighbours list, allocated on init.
+	 */
+	uint8_t* _neighbourIndex      = nullptr;
+
+	/**
+	 * Lost neighbours that still have to be sent via the mesh.
+	 */
+	stone_id_t _pendingRemovals[MAX_PENDING_REMOVALS];
+	uint8_t _pendingRemovalCount  = 0;
+
+	/**
+	 * Links between other crownstones, allocated when the first digest is received while UART is enabled.
+	 */
+	link_t* _links                = nullptr;
+
+	/**
+	 * Number of links in the list.
+	 */
+	uint16_t _linkCount           = 0;
+
 	/**
 	 * Next index of the neighbours list to send via the mesh.
 	 */
@@ -139,6 +249,37 @@ private:
 	 */
 	uint16_t _sendCountdown;
 
+	/**
+	 * Next index of the neighbours list to send via the old neighbour RSSI message.
+	 */
+	uint8_t _nextLegacySendIndex  = 0;
+
+	/**
+	 * Countdown in seconds until sending the next old neighbour RSSI message.
+	 */
+	uint16_t _sendLegacyCountdown;
+
+	/**
+	 * Minutes since an old neighbour RSSI message was received from a crownstone that doesn't send the digest.
+	 * Starts at LEGACY_TIMEOUT_MINUTES: the old message isn't sent until such a crownstone is heard.
+	 */
+	uint8_t _legacySenderMinutesAgo = LEGACY_TIMEOUT_MINUTES;
+
+	/**
+	 * Bitmask of the stone IDs that sent a digest.
+	 */
+	uint32_t _digestSenders[256 / 32] = {};
+
+	/**
+	 * Countdown in seconds until a digest with changes may be sent.
+	 */
+	uint8_t _sendDeltaCountdown = 0;
+
+	/**
+	 * Countdown in seconds until the next minute, used to age the links.
+	 */
+	uint8_t _minuteCountdown = 60;
+
 	/**
 	 * Countdown in seconds until sending the next no hop ping mesh message.
 	 */
@@ -173,16 +314,59 @@ private:
 	 */
 	void updateNeighbour(neighbour_node_t& node, stone_id_t id, int8_t rssi, uint8_t channel);
 
+	/**
+	 * Get the number of seconds since the neighbour at given index of the list was last seen.
+	 */
+	uint8_t getLastSeenSecondsAgo(uint8_t index);
+
+	/**
+	 * Remove the neighbours that timed out from the list, keeping the order of the others.
+	 * Timed out neighbours have ID 0.
+	 */
+	void removeTimedOutNeighbours();
+
 	/**
 	 * sets the three rssi values to RSSI_INIT
 	 */
 	void clearNeighbourRssi(neighbour_node_t& node);
 
 	/**
-	 * Find a neighbour in the list.
+	 * Find a neighbour in the list, using the hash index.
+	 *
+	 * @return Index in the list, or INDEX_NOT_FOUND.
 	 */
 	uint8_t find(stone_id_t id);
 
+	/**
+	 * Add the neighbour at given index of the list to the hash index.
+	 */
+	void addToIndex(uint8_t index);
+
+	/**
+	 * Rebuild the hash index from the list, required after removing neighbours.
+	 */
+	void rebuildIndex();
+
+	/**
+	 * Quantise an RSSI to 5 bits, 0 stays 0.
+	 */
+	static uint8_t quantiseRssi(int8_t rssi);
+
+	/**
+	 * Inverse of quantiseRssi().
+	 */
+	static int8_t dequantiseRssi(uint8_t quantisedRssi);
+
+	/**
+	 * Get the quantised RSSI of all channels of a neighbour.
+	 */
+	static cs_mesh_model_quantised_rssi_t getQuantisedRssi(const neighbour_node_t& node);
+
+	/**
+	 * Whether the RSSI of a neighbour changed significantly since it was last sent.
+	 */
+	static bool hasChanged(const neighbour_node_t& node);
+
 	/**
 	 * Get the RSSI of given stone ID and put it in the result buffer.
 	 */
@@ -194,9 +378,29 @@ private:
 	void sendNoop();
 
 	/**
-	 * Sends the RSSI of 1 neighbour over the mesh and UART.
+	 * Sends a digest of neighbours over the mesh and UART.
+	 *
+	 * Lost neighbours and neighbours with changed RSSI go first.
+	 * When refresh is true, the remaining space is filled with the next neighbours in the list.
+	 *
+	 * @return true when a digest was sent.
+	 */
+	bool sendDigest(bool refresh);
+
+	/**
+	 * Sends the RSSI of the next neighbour in the list over the mesh, in the old neighbour RSSI message.
+	 */
+	void sendLegacyNext();
+
+	/**
+	 * Whether a crownstone that doesn't send the digest was heard within LEGACY_TIMEOUT_MINUTES.
+	 */
+	bool legacyIsNeeded();
+
+	/**
+	 * Whether the given stone sent a digest.
 	 */
-	void sendNext();
+	bool isDigestSender(stone_id_t id);
 
 	/**
 	 * Sends a neighbour message for the given node over the mesh.
@@ -204,10 +408,27 @@ private:
 	 *
 	 * Returns the message struct for convenience.
 	 */
-	cs_mesh_model_msg_neighbour_rssi_t sendNeighbourMessageOverMesh(neighbour_node_t& node);
+	cs_mesh_model_msg_neighbour_rssi_t sendNeighbourMessageOverMesh(neighbour_node_t& node, uint8_t lastSeenSecondsAgo);
+
+	/**
+	 * Get a link of the full topology: our own neighbours first, then the links between other crownstones.
+	 *
+	 * @param[in] index      Index of the link, smaller than the number of neighbours plus links.
+	 */
+	mesh_topology_link_uart_t getUartLink(uint16_t index);
+
+	/**
+	 * Sends the RSSI of all known links over UART.
+	 *
+	 * The links are split over as many messages as needed to fit in UART_TX_MAX_PAYLOAD_SIZE.
+	 */
+	cs_ret_code_t sendMatrixToUart();
 
 	/**
 	 * Sends the RSSI to a neighbour over UART.
+	 *
+	 * Each received link is sent once: either from the digest, or from the old message of a crownstone that doesn't
+	 * send the digest.
 	 */
 	void sendRssiToUart(stone_id_t reveiverId, cs_mesh_model_msg_neighbour_rssi_t& packet);
 
@@ -217,11 +438,19 @@ private:
 
 	void onNeighbourRssi(stone_id_t id, cs_mesh_model_msg_neighbour_rssi_t& packet);
 
+	void onNeighbourRssiDigest(stone_id_t id, cs_mesh_model_msg_neighbour_rssi_digest_t& packet);
+
+	/**
+	 * Store a link between other crownstones, or remove it when the RSSI is empty.
+	 */
+	void updateLink(stone_id_t receiverId, const cs_mesh_model_neighbour_rssi_link_t& link);
+
 	cs_ret_code_t onStoneMacMsg(MeshMsgEvent& meshMsg);
 
 	/**
 	 * Handles mesh messages:
 	 *  - CS_MESH_MODEL_TYPE_NEIGHBOUR_RSSI
+	 *  - CS_MESH_MODEL_TYPE_NEIGHBOUR_RSSI_DIGEST
 	 *  - CS_MESH_MODEL_TYPE_STONE_MAC
 	 *
 	 *  Also calls `add` if .hops == 0, regarless of the packet type.
@@ -229,8 +458,10 @@ private:
 	void onMeshMsg(MeshMsgEvent& packet, cs_result_t& result);
 
 	/**
-	 * neighbors are removed from the list when their individual countdown expires.
+	 * neighbors are removed from the list when their timeout expires.
 	 * See TIMEOUT_SECONDS.
+	 *
+	 * Links are removed after LINK_TIMEOUT_MINUTES.
 	 */
 	void onTickSecond();
 
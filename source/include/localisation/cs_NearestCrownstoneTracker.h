@@ -8,9 +8,11 @@
 #pragma once
 
 #include <common/cs_Component.h>
+#include <events/cs_CompatibilityTick.h>
 #include <events/cs_EventListener.h>
 #include <localisation/cs_AssetHandler.h>
 #include <localisation/cs_AssetRecord.h>
+#include <localisation/cs_AssetReportCache.h>
 #include <localisation/cs_AssetStore.h>
 #include <localisation/cs_TrackableEvent.h>
 #include <protocol/cs_Typedefs.h>
@@ -40,6 +42,11 @@ class NearestCrownstoneTracker : public EventListener, public Component {
 
 	static constexpr auto FILTER_STRATEGY = FilterStrategy::TIME_OUT;
 
+	/**
+	 * Interval at which the cache hit rate is logged.
+	 */
+	static constexpr uint16_t REPORT_CACHE_LOG_INTERVAL_SECONDS     = 60;
+
 public:
 	/**
 	 * Caches CONFIG_CROWNSTONE_ID and AssetStore.
@@ -58,6 +65,16 @@ private:
 	stone_id_t _myStoneId;
 	AssetStore* _assetStore;
 
+	/**
+	 * Recently handled reports from other crownstones, to ignore copies that arrive via different relay paths.
+	 */
+	AssetReportCache _reportCache;
+
+	/**
+	 * Requested while the report cache has entries to expire.
+	 */
+	TickRequest _reportCacheTickRequest;
+
 	// -------------------------------------------
 	// ------------- Incoming events -------------
 	// -------------------------------------------
@@ -141,17 +158,28 @@ private:
 
 	/**
 	 * getRecord for assetId from assetStore and return it.
-	 * return nullptr if rec->lastReceivedCounter is above threshold.
+	 * return nullptr if its last received counter is above threshold.
 	 *
 	 * `this` must be init()-ialized.
 	 */
 	asset_record_t* getRecordFiltered(const asset_id_t& assetId);
 
+	/**
+	 * Expires cache entries.
+	 */
+	void onTick();
+
+	/**
+	 * Logs the cache statistics every now and then.
+	 */
+	void onTickSecond(uint32_t upTime);
+
 public:
 	/**
 	 * Handlers for:
-	 * EVT_ASSET_ACCEPTED
-	 * EVT_FILTERS_UPDATED
+	 * EVT_RECV_MESH_MSG
+	 * EVT_TICK
+	 * EVT_TICK_SECOND
 	 */
 	void handleEvent(event_t& evt);
 };
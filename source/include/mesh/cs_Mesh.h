@@ -20,6 +20,7 @@
 #include <mesh/cs_MeshMsgHandler.h>
 #include <mesh/cs_MeshMsgSender.h>
 #include <mesh/cs_MeshScanner.h>
+#include <util/cs_Coroutine.h>
 
 /**
  * Class that manages all mesh classes:
@@ -122,9 +123,18 @@ private:
 	BOOL _enabled                 = true;
 
 	// Sync request
-	bool _synced                  = false;
-	uint32_t _syncCountdown       = -1;
-	uint32_t _syncFailedCountdown = 0;
+	bool _synced = false;
+
+	//! Requests a sync every MESH_SYNC_RETRY_INTERVAL_MS, until synced.
+	Coroutine _syncRetryRoutine;
+
+	//! Gives up syncing, MESH_SYNC_GIVE_UP_MS after the sync started.
+	Coroutine _syncGiveUpRoutine;
+
+#if MESH_MODEL_TEST_MSG != 0
+	//! Sends a test message at a regular interval.
+	Coroutine _testMsgRoutine;
+#endif
 
 	/**
 	 * Dispatches an internal event to request what data this crownstone needs to receive
@@ -146,5 +156,7 @@ private:
 
 	void configureModels(dsm_handle_t appkeyHandle);
 
-	void onTick(uint32_t tickCount);
+	void onSyncRetry();
+
+	void onSyncGiveUp();
 };
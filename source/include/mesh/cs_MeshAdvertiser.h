@@ -9,6 +9,7 @@
 
 #include <ble/cs_iBeacon.h>
 #include <common/cs_Types.h>
+#include <events/cs_CompatibilityTick.h>
 #include <events/cs_EventListener.h>
 
 extern "C" {
@@ -73,6 +74,11 @@ private:
 	// Cache of previous time update.
 	uint32_t _lastTimestamp = 0;
 
+	/**
+	 * Requested while an ibeacon config entry is set, so that the time is polled every tick.
+	 */
+	TickRequest _tickRequest;
+
 	void updateIbeacon();
 
 	/**
@@ -88,4 +94,9 @@ private:
 
 	void setConfigEntry(uint8_t id, ibeacon_config_id_packet_t& config);
 	void clearConfigEntry(uint8_t id);
+
+	/**
+	 * Request or release the tick, depending on whether any ibeacon config entry is set.
+	 */
+	void updateTickRequest();
 };
@@ -10,6 +10,7 @@
 #include <mesh/cs_MeshCommon.h>
 #include <third/std/function.h>
 #include <util/cs_BitmaskVarSize.h>
+#include <util/cs_Coroutine.h>
 
 extern "C" {
 #include <access.h>
@@ -56,11 +57,6 @@ public:
 	 */
 	cs_ret_code_t remFromQueue(cs_mesh_model_msg_type_t type, uint16_t id);
 
-	/**
-	 * To be called at a regular interval.
-	 */
-	void tick(uint32_t tickCount);
-
 	/** Internal usage */
 	void handleMsg(const access_message_rx_t* accessMsg);
 
@@ -122,6 +118,11 @@ private:
 	 */
 	void remQueueItem(uint8_t index);
 
+	/**
+	 * Processes the queue every MESH_MODEL_ACKED_RETRY_INTERVAL_MS, while there is something to send.
+	 */
+	Coroutine _processQueueRoutine;
+
 	/**
 	 * Send messages from queue.
 	 */
@@ -9,6 +9,7 @@
 
 #include <mesh/cs_MeshCommon.h>
 #include <third/std/function.h>
+#include <util/cs_Coroutine.h>
 
 extern "C" {
 #include <access.h>
@@ -55,11 +56,6 @@ public:
 	 */
 	cs_ret_code_t remFromQueue(cs_mesh_model_msg_type_t type, uint16_t id);
 
-	/**
-	 * To be called at a regular interval.
-	 */
-	void tick(uint32_t tickCount);
-
 	/** Internal usage */
 	void handleMsg(const access_message_rx_t* accessMsg);
 
@@ -85,6 +81,11 @@ private:
 	 */
 	uint8_t _queueIndexNext = 0;
 
+	/**
+	 * Processes the queue every MESH_MODEL_QUEUE_PROCESS_INTERVAL_MS, while there is something to send.
+	 */
+	Coroutine _processQueueRoutine;
+
 	/**
 	 * Send messages from queue.
 	 */
@@ -48,6 +48,11 @@ struct MeshPacketTraits<CS_MESH_MODEL_TYPE_ASSET_FILTER_VERSION> {
 	using type = cs_mesh_model_msg_asset_filter_version_t;
 };
 
+template <>
+struct MeshPacketTraits<CS_MESH_MODEL_TYPE_ASSET_FILTER_CHUNK_REQUEST> {
+	using type = cs_mesh_model_msg_asset_filter_chunk_request_t;
+};
+
 template <>
 struct MeshPacketTraits<CS_MESH_MODEL_TYPE_ASSET_INFO_MAC> {
 	using type = cs_mesh_model_msg_asset_report_mac_t;
@@ -63,6 +68,11 @@ struct MeshPacketTraits<CS_MESH_MODEL_TYPE_NEIGHBOUR_RSSI> {
 	using type = cs_mesh_model_msg_neighbour_rssi_t;
 };
 
+template <>
+struct MeshPacketTraits<CS_MESH_MODEL_TYPE_NEIGHBOUR_RSSI_DIGEST> {
+	using type = cs_mesh_model_msg_neighbour_rssi_digest_t;
+};
+
 template <>
 struct MeshPacketTraits<CS_MESH_MODEL_TYPE_SET_BEHAVIOUR_SETTINGS> {
 	using type = behaviour_settings_t;
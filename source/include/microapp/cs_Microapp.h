@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <events/cs_CompatibilityTick.h>
 #include <events/cs_EventListener.h>
 #include <protocol/cs_MicroappPackets.h>
 
@@ -77,6 +78,11 @@ private:
 	 */
 	bool _factoryResetMode        = false;
 
+	/**
+	 * Requested while an app can run, or while the factory reset is in progress.
+	 */
+	TickRequest _tickRequest;
+
 	void loadApps();
 
 	void loadState(uint8_t index);
@@ -126,6 +132,11 @@ private:
 	 */
 	void tick();
 
+	/**
+	 * Request or release the tick, depending on whether there is anything to do in tick().
+	 */
+	void updateTickRequest();
+
 	/**
 	 * Handle control commands.
 	 */
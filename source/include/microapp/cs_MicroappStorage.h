@@ -2,14 +2,16 @@
 
 #include <ble/cs_Nordic.h>  // TODO: don't use nrf_fstorage_evt_t in header.
 #include <events/cs_EventListener.h>
+#include <microapp/cs_MicroappUploadQueue.h>
 #include <protocol/cs_MicroappPackets.h>
+#include <util/cs_LzDecompressor.h>
 
 constexpr uint8_t MICROAPP_STORAGE_BUF_SIZE = 32;
 
 /**
  * Class to store microapps on flash.
  */
-class MicroappStorage {
+class MicroappStorage : public MicroappUploadFlash {
 public:
 	static MicroappStorage& getInstance() {
 		static MicroappStorage instance;
@@ -37,16 +39,17 @@ public:
 	uint32_t getStartInstructionAddress(uint8_t appIndex);
 
 	/**
-	 * Checks if storage space of this microapp is erased.
+	 * Checks if the first page of the storage space of this microapp is erased.
+	 * That's where the header is, so without it there is no app. The other pages are erased during an upload.
 	 *
 	 * @param[in] appIndex   Index of the microapp, validity is not checked.
-	 * @return true                         Storage space of this app is erased, and thus ready to be written.
+	 * @return true                         This app is erased, and thus ready to be uploaded.
 	 */
 	bool isErased(uint8_t appIndex);
 
 	/**
 	 * Erases storage space of given app.
-	 * First checks if storage is already erased.
+	 * Only the pages that are not erased yet, up to the last page in use, are erased.
 	 *
 	 * @param[in] appIndex   Index of the microapp, validity is not checked.
 	 *
@@ -57,30 +60,72 @@ public:
 	 */
 	cs_ret_code_t erase(uint8_t appIndex);
 
+	/**
+	 * Erases the first page of the storage space of given app, which holds the header. This removes the app, while
+	 * the other pages are erased during the next upload, ahead of the chunks that are written to them.
+	 *
+	 * @param[in] appIndex   Index of the microapp, validity is not checked.
+	 *
+	 * @return ERR_SUCCESS                  The first page is already erased.
+	 * @return ERR_WAIT_FOR_SUCCESS         The first page will be erased, wait for CMD_RESOLVE_ASYNC_CONTROL_COMMAND.
+	 * @return ERR_BUSY                     Retry again later.
+	 */
+	cs_ret_code_t eraseHeader(uint8_t appIndex);
+
 	/**
 	 * Write a chunk to flash.
 	 *
+	 * The chunk is copied and queued by the upload queue, see MicroappUploadQueue. Chunks have to be written in
+	 * order, starting at offset 0.
+	 *
 	 * @param[in] appIndex   Index of the microapp, validity is not checked.
 	 * @param[in] offset     Offset of the data in bytes from the start of the app storage space.
-	 * @param[in] data       Pointer to the data to be written. Must remain valid until the write is finished.
+	 * @param[in] data       Pointer to the data to be written.
 	 * @param[in] size       Size of the data to be written, must be a multiple of 4.
 	 *
-	 * @return ERR_SUCCESS_NO_CHANGE        The data is already on flash.
+	 * @return ERR_SUCCESS                  The data is queued to be written to flash, the next chunk can be written.
 	 * @return ERR_WAIT_FOR_SUCCESS         The data will be written to flash, wait for
 	 * CMD_RESOLVE_ASYNC_CONTROL_COMMAND.
 	 * @return ERR_NO_SPACE                 Data would go outside the app storage space.
-	 * @return ERR_WRONG_PAYLOAD_LENGTH     Data size is not a multiple of 4.
-	 * @return ERR_WRITE_DISABLED           App storage space is not erased.
-	 * @return ERR_BUSY                     Another chunk is being written already.
+	 * @return ERR_WRONG_PAYLOAD_LENGTH     Data size is not a multiple of 4, or larger than
+	 * MICROAPP_UPLOAD_MAX_CHUNK_SIZE.
+	 * @return ERR_WRITE_DISABLED           The app is not erased.
+	 * @return ERR_WRONG_STATE              The offset is not the end of the previous chunk.
+	 * @return ERR_BUSY                     Retry again later.
+	 * @return Other                        Writing a previous chunk failed, the upload has to start over.
 	 */
 	cs_ret_code_t writeChunk(uint8_t appIndex, uint16_t offset, const uint8_t* data, uint16_t size);
 
+	/**
+	 * Write a chunk of a compressed binary to flash.
+	 *
+	 * The chunk is decompressed into the write buffer, which is written to flash each time it's full, and at the end
+	 * of the binary. The size of the binary is taken from the decompressed header.
+	 *
+	 * @param[in] appIndex   Index of the microapp, validity is not checked.
+	 * @param[in] offset     Offset of the data in bytes from the start of the compressed binary. Chunks have to be
+	 *                       written in order: a failed upload has to restart at offset 0.
+	 * @param[in] data       Pointer to the compressed data. Must remain valid until the result is resolved.
+	 * @param[in] size       Size of the compressed data.
+	 *
+	 * @return ERR_SUCCESS                  The chunk has been decompressed, without the need to write to flash.
+	 * @return ERR_WAIT_FOR_SUCCESS         The chunk will be decompressed to flash, wait for
+	 * CMD_RESOLVE_ASYNC_CONTROL_COMMAND.
+	 * @return ERR_WRONG_STATE              The offset is not the end of the previous chunk.
+	 * @return ERR_INVALID_MESSAGE          The data can't be decompressed.
+	 * @return ERR_NO_SPACE                 The decompressed binary doesn't fit in the app storage space.
+	 * @return ERR_WRITE_DISABLED           The app is not erased.
+	 * @return ERR_BUSY                     Another chunk is being written already.
+	 */
+	cs_ret_code_t writeCompressedChunk(uint8_t appIndex, uint16_t offset, const uint8_t* data, uint16_t size);
+
 	/**
 	 * Validate the overall binary, this goes through flash and checks it completely.
 	 * All flash write operations have to have finished before.
 	 *
 	 * @param[in] appIndex   Index of the microapp, validity is not checked.
 	 * @return ERR_SUCCESS                  The app binary header is valid, and the checksums match.
+	 * @return ERR_BUSY                     Chunks of an upload are still being written.
 	 */
 	cs_ret_code_t validateApp(uint8_t appIndex);
 
@@ -107,35 +152,100 @@ private:
 	bool _writing                           = false;
 
 	/**
-	 * The buffer is required to perform writes to flash, as the data has to
-	 * be aligned, and stay in memory until the write is done.
+	 * Decompressed data of a compressed upload, which is written to flash when full.
+	 * The data has to be aligned, and stay in memory until the write is done.
 	 */
-	__attribute__((aligned(4))) uint8_t _writeBuffer[MICROAPP_STORAGE_BUF_SIZE];
+	__attribute__((aligned(4))) uint8_t _writeBuffer[MICROAPP_UPLOAD_MAX_CHUNK_SIZE];
 
 	/**
-	 * When writing a chunk of data, it will be done in parts.
-	 * These variable are needed to know what to write where to.
+	 * Queues the chunks of an upload, see writeChunk().
 	 */
-	const uint8_t* _chunkData   = nullptr;
-	uint16_t _chunkSize         = 0;
-	uint16_t _chunkWritten      = 0;
-	uint32_t _chunkFlashAddress = 0;
+	MicroappUploadQueue _uploadQueue;
 
 	/**
-	 * Write the next part of a chunk.
-	 * Called first time from command, and every time when a flash write is done.
-	 *
-	 * @return ERR_SUCCESS                  Complete chunk has been written to flash.
-	 * @return ERR_WAIT_FOR_SUCCESS         The data will be written to flash.
+	 * App index of the upload in the upload queue.
+	 */
+	uint8_t _uploadAppIndex       = MICROAPP_INDEX_NONE;
+
+	/**
+	 * RTC count at the moment the first chunk of an upload was written, used to log the upload duration.
+	 */
+	uint32_t _uploadStartRtcCount = 0;
+
+	/**
+	 * Number of bytes written since the first chunk of an upload.
+	 */
+	uint32_t _uploadSize          = 0;
+
+	/**
+	 * Decompresses a compressed upload into the write buffer.
+	 */
+	LzDecompressor _decompressor;
+
+	/**
+	 * Whether the last chunk that was written is part of a compressed upload.
+	 */
+	bool _compressedUpload               = false;
+
+	/**
+	 * App index of the compressed upload.
+	 */
+	uint8_t _compressedAppIndex          = MICROAPP_INDEX_NONE;
+
+	/**
+	 * Offset in the compressed binary where the next chunk should start.
 	 */
-	cs_ret_code_t writeNextChunkPart();
+	uint16_t _compressedOffset           = 0;
 
 	/**
-	 * Write to flash.
+	 * Size of the decompressed binary, from its header. 0 when the header hasn't been decompressed yet.
+	 */
+	uint16_t _decompressedSize           = 0;
+
+	/**
+	 * Compressed data of the current chunk that has not been decompressed yet.
+	 */
+	const uint8_t* _compressedData       = nullptr;
+	uint16_t _compressedDataSize         = 0;
+
+	/**
+	 * Number of pages of the compressed upload, from the first page, that are erased, or have a queued erase.
+	 */
+	uint8_t _compressedErasedPageCount   = 0;
+
+	/**
+	 * Number of queued erases of the compressed upload, and the result of the first one that failed.
+	 */
+	uint8_t _compressedQueuedEraseCount  = 0;
+	cs_ret_code_t _compressedEraseResult = ERR_SUCCESS;
+
+	/**
+	 * Whether any flash operation is queued.
+	 */
+	bool isBusy();
+
+	/**
+	 * Erase the first pages of the storage space of given app.
+	 */
+	cs_ret_code_t erasePages(uint8_t appIndex, uint8_t pageCount);
+
+	/**
+	 * Queue a write to flash.
+	 *
+	 * @param[in] context    Passed to handleFileStorageEvent(), to tell which operation is done.
 	 *
 	 * @return ERR_SUCCESS                  The data will be written to flash.
 	 */
-	cs_ret_code_t write(uint32_t flashAddress, const uint8_t* data, uint16_t size);
+	cs_ret_code_t startWrite(uint32_t flashAddress, const uint8_t* data, uint16_t size, void* context);
+
+	/**
+	 * Queue the erase of a page.
+	 *
+	 * @param[in] context    Passed to handleFileStorageEvent(), to tell which operation is done.
+	 *
+	 * @return ERR_SUCCESS                  The page will be erased.
+	 */
+	cs_ret_code_t startErase(uint32_t flashAddress, uint8_t pageCount, void* context);
 
 	/**
 	 * Called when data has been written to flash.
@@ -143,10 +253,35 @@ private:
 	void onFlashWritten(cs_ret_code_t retCode);
 
 	/**
-	 * To be called when a chunk has been written (or when it failed to write).
-	 * Resets all variables.
+	 * Resolve the upload command with a result of the upload queue, unless that is ERR_WAIT_FOR_SUCCESS.
+	 */
+	void resolveUploadQueueResult(cs_ret_code_t retCode);
+
+	/**
+	 * Decompress the remaining data of the current compressed chunk, until the write buffer has to be written.
+	 *
+	 * @return ERR_SUCCESS                  All data has been decompressed.
+	 * @return ERR_WAIT_FOR_SUCCESS         The write buffer is being written to flash.
+	 */
+	cs_ret_code_t decompressChunk();
+
+	/**
+	 * Write the decompressed data in the write buffer to flash.
+	 */
+	cs_ret_code_t writeDecompressed();
+
+	/**
+	 * Make sure the pages of the compressed upload, up to and including given page, are erased or have a queued
+	 * erase. The erases are queued before the write that follows.
+	 */
+	cs_ret_code_t eraseCompressedPagesUpTo(uint8_t page);
+
+	/**
+	 * Implements MicroappUploadFlash, for the app in the upload queue.
 	 */
-	void resetChunkVars();
+	bool isPageErased(uint8_t page) override;
+	cs_ret_code_t queueErase(uint8_t page) override;
+	cs_ret_code_t queueWrite(uint16_t offset, const uint8_t* data, uint16_t size) override;
 
 	/**
 	 * Reads flash, and checks if it's erased.
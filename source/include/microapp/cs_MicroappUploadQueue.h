@@ -0,0 +1,184 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <protocol/cs_ErrorCodes.h>
+#include <protocol/cs_MicroappPackets.h>
+#include <protocol/cs_Typedefs.h>
+
+#include <cstdint>
+
+/**
+ * Flash operations on the storage space of the microapp that is being uploaded.
+ *
+ * Operations are queued, and executed in the order they were queued. When an operation is done, the implementation
+ * calls MicroappUploadQueue::onWriteDone() or MicroappUploadQueue::onEraseDone().
+ */
+class MicroappUploadFlash {
+public:
+	virtual ~MicroappUploadFlash() = default;
+
+	/**
+	 * Whether a page is erased. Only called for pages without queued operations.
+	 *
+	 * @param[in] page       Index of the page, from the start of the app storage space.
+	 */
+	virtual bool isPageErased(uint8_t page) = 0;
+
+	/**
+	 * Queue the erase of a page.
+	 *
+	 * @return ERR_SUCCESS                  The page will be erased.
+	 * @return ERR_BUSY                     The queue is full.
+	 */
+	virtual cs_ret_code_t queueErase(uint8_t page) = 0;
+
+	/**
+	 * Queue a write.
+	 *
+	 * @param[in] offset     Offset in bytes from the start of the app storage space.
+	 * @param[in] data       Word aligned data, that stays valid until the write is done.
+	 * @param[in] size       Size of the data, a multiple of 4.
+	 *
+	 * @return ERR_SUCCESS                  The data will be written.
+	 * @return ERR_BUSY                     The queue is full.
+	 */
+	virtual cs_ret_code_t queueWrite(uint16_t offset, const uint8_t* data, uint16_t size) = 0;
+};
+
+/**
+ * Queues the chunks of a microapp upload to be written to flash, so that the upload doesn't wait for the flash.
+ *
+ * - A chunk is copied to a chunk buffer and queued, after which the next chunk can be sent right away.
+ *   Only when all chunk buffers are in use, the result of a chunk waits until a buffer is free.
+ * - The upload starts with the first page erased: the app was removed. The other pages are erased during the upload.
+ *   Each time a chunk is queued, the erase of the next page is queued as well, so that it's done while the chunks
+ *   of the current page are sent.
+ * - The result of the last chunk, according to the size in the binary header, waits until all of it has been
+ *   written. So the app can be validated after that.
+ *
+ * Chunks have to be written in order. A failed flash operation is reported with the result of the next chunk, after
+ * which the upload has to start over.
+ */
+class MicroappUploadQueue {
+public:
+	/**
+	 * Number of chunks that can be queued. Each takes a buffer of MICROAPP_UPLOAD_MAX_CHUNK_SIZE.
+	 */
+	static constexpr uint8_t CHUNK_BUFFER_COUNT = 2;
+
+	MicroappUploadQueue(MicroappUploadFlash& flash);
+
+	/**
+	 * Start an upload.
+	 *
+	 * @return ERR_SUCCESS                  Chunks can be written, starting at offset 0.
+	 * @return ERR_BUSY                     Flash operations of a previous upload are still queued.
+	 * @return ERR_WRITE_DISABLED           The first page is not erased.
+	 */
+	cs_ret_code_t start();
+
+	/**
+	 * Stop the upload, for example because the app storage space is erased.
+	 * Queued operations are still counted.
+	 */
+	void stop();
+
+	/**
+	 * Whether a chunk can be written at given offset, with writeChunk().
+	 */
+	bool isNextChunk(uint16_t offset) const { return _started && offset == _nextOffset; }
+
+	/**
+	 * Queue a chunk to be written.
+	 *
+	 * @param[in] offset     Offset of the chunk in bytes from the start of the app storage space.
+	 * @param[in] data       Data of the chunk, which is copied.
+	 * @param[in] size       Size of the chunk, a multiple of 4, and at most MICROAPP_UPLOAD_MAX_CHUNK_SIZE.
+	 *
+	 * @return ERR_SUCCESS                  The chunk is queued, the next chunk can be written.
+	 * @return ERR_WAIT_FOR_SUCCESS         The chunk is queued, the result is returned by onWriteDone() or
+	 *                                      onEraseDone().
+	 * @return ERR_WRONG_STATE              Not the next chunk.
+	 * @return ERR_BUSY                     The result of the previous chunk is pending, or the flash queue is full.
+	 * @return ERR_WRONG_PAYLOAD_LENGTH     Invalid size.
+	 * @return ERR_NO_SPACE                 The chunk doesn't fit in the app storage space.
+	 * @return Other                        A previous flash operation failed, the upload is stopped.
+	 */
+	cs_ret_code_t writeChunk(uint16_t offset, const uint8_t* data, uint16_t size);
+
+	/**
+	 * To be called when a queued write is done.
+	 *
+	 * @return ERR_WAIT_FOR_SUCCESS         There is no pending result.
+	 * @return Other                        The pending result of the chunk that returned ERR_WAIT_FOR_SUCCESS.
+	 */
+	cs_ret_code_t onWriteDone(cs_ret_code_t result);
+
+	/**
+	 * To be called when a queued erase is done.
+	 *
+	 * @return ERR_WAIT_FOR_SUCCESS         There is no pending result.
+	 * @return Other                        The pending result of the chunk that returned ERR_WAIT_FOR_SUCCESS.
+	 */
+	cs_ret_code_t onEraseDone(cs_ret_code_t result);
+
+	/**
+	 * Number of queued flash operations that are not done yet.
+	 */
+	uint8_t getQueuedOperationCount() const { return _queuedOperationCount; }
+
+private:
+	enum class PendingResult : uint8_t {
+		NONE,
+		CHUNK_BUFFER_FREE,
+		ALL_DONE,
+	};
+
+	MicroappUploadFlash& _flash;
+
+	__attribute__((aligned(4))) uint8_t _chunkBuffers[CHUNK_BUFFER_COUNT][MICROAPP_UPLOAD_MAX_CHUNK_SIZE];
+
+	bool _started                 = false;
+	uint16_t _nextOffset          = 0;
+
+	/**
+	 * Size of the app, from the binary header. 0 when the header is invalid.
+	 */
+	uint16_t _appSize             = 0;
+
+	/**
+	 * Number of pages, from the first page, that are erased, or have a queued erase.
+	 */
+	uint8_t _erasedPageCount      = 0;
+
+	uint8_t _queuedOperationCount = 0;
+	uint8_t _queuedChunkCount     = 0;
+
+	/**
+	 * Buffer of the next chunk. The chunk buffers are used in turn.
+	 */
+	uint8_t _nextChunkBuffer      = 0;
+
+	/**
+	 * Result of the failed flash operation, that still has to be reported.
+	 */
+	cs_ret_code_t _flashResult    = ERR_SUCCESS;
+
+	PendingResult _pendingResult  = PendingResult::NONE;
+
+	/**
+	 * Make sure the pages up to and including given page are erased, or have a queued erase.
+	 *
+	 * @return ERR_SUCCESS                  The pages are erased, or will be erased before the next write.
+	 * @return ERR_BUSY                     The queue is full.
+	 */
+	cs_ret_code_t erasePagesUpTo(uint8_t page);
+
+	cs_ret_code_t onOperationDone(cs_ret_code_t result);
+};
@@ -26,11 +26,9 @@ public:
 	// return value: pointer to next empty val in outbuff.
 	// if max_size is 0, outbuff is not checked for nullptr,
 	// and no size check is performed. otherwise, both are validated.
-	virtual uint8_t* serialize(uint8_t* outbuff, size_t maxSize = 0);
+	uint8_t* serialize(uint8_t* outbuff, size_t maxSize = 0);
 
-	virtual size_t serializedSize() const;
-
-	virtual ~PresenceCondition() = default;
+	size_t serializedSize() const;
 
 	/**
 	 * Returns true if this condition is satisfied given the presence state.
@@ -10,7 +10,9 @@
 #include <events/cs_EventListener.h>
 #include <presence/cs_PresenceDescription.h>
 #include <time/cs_SystemTime.h>
+#include <test/cs_TestAccess.h>
 #include <util/cs_Store.h>
+#include <util/cs_TimingWheel.h>
 
 #include <optional>
 
@@ -20,6 +22,8 @@
  * Sends out throttled mesh messages when the location of a profile is received.
  */
 class PresenceHandler : public EventListener, public Component {
+	friend class TestAccess<PresenceHandler>;
+
 public:
 	struct __attribute__((__packed__)) ProfileLocation {
 		static const constexpr uint8_t MAX_LOCATION_ID = 63;
@@ -69,36 +73,30 @@ private:
 	/**
 	 * Maximum number of presence records that is kept up.
 	 *
-	 * Must be smaller than 0xFF.
+	 * Must be smaller than 0xFF, as it is also the max number of records per location.
 	 */
-	static const constexpr uint8_t MAX_RECORDS                                   = 20;
+	static const constexpr uint8_t MAX_RECORDS                                   = 50;
 
 	struct PresenceRecord {
 		ProfileLocation profileLocation;
 		/**
-		 * Used to determine when a record is timed out.
-		 * Decreases every seconds.
-		 * Starts at presence_time_out_s, when 0, it is timed out.
+		 * A valid record has a timeout scheduled in _timeouts.
 		 */
-		uint8_t timeoutCountdownSeconds;
+		bool valid;
 		/**
 		 * Used to determine whether to send a mesh message.
-		 * Decreases every seconds.
-		 * Starts at presence_mesh_send_throttle_seconds, when 0, a mesh message can be sent.
+		 * Second (of _timeouts, modulo 256) from which a mesh message can be sent.
+		 * Only compared while the record is valid, which means it was checked less than
+		 * PRESENCE_TIMEOUT_SECONDS ago, so it never differs more than 128 seconds from the current second.
 		 */
-		uint8_t meshSendCountdownSeconds;
+		uint8_t meshSendSecond;
 
-		PresenceRecord(
-				ProfileLocation profileLocation = {},
-				uint8_t timeoutSeconds          = PRESENCE_TIMEOUT_SECONDS,
-				uint8_t meshThrottleSeconds     = 0)
-				: profileLocation(profileLocation)
-				, timeoutCountdownSeconds(timeoutSeconds)
-				, meshSendCountdownSeconds(meshThrottleSeconds) {}
+		PresenceRecord(ProfileLocation profileLocation = {}, uint8_t meshSendSecond = 0)
+				: profileLocation(profileLocation), valid(true), meshSendSecond(meshSendSecond) {}
 
-		void invalidate() { timeoutCountdownSeconds = 0; }
+		void invalidate() { valid = false; }
 
-		bool isValid() { return timeoutCountdownSeconds != 0; }
+		bool isValid() { return valid; }
 
 		ProfileLocation id() { return profileLocation; }
 	};
@@ -108,6 +106,48 @@ private:
 	 */
 	Store<PresenceRecord, MAX_RECORDS> _store;
 
+	/**
+	 * Times out the presence records, ticks every second.
+	 * The timer index is the index of the record in the store.
+	 */
+	TimingWheel<MAX_RECORDS> _timeouts;
+
+	/**
+	 * Number of valid records per location.
+	 */
+	uint8_t _locationRecordCount[ProfileLocation::MAX_LOCATION_ID + 1] = {};
+
+	/**
+	 * Bitmask of locations with at least 1 valid record.
+	 * Kept up to date with the record counts, so that the presence description doesn't need a scan of the store.
+	 */
+	uint64_t _occupiedLocationsBitmask                                 = 0;
+
+	/**
+	 * To be called when a record of given location becomes valid.
+	 */
+	void addLocationRecord(uint8_t location);
+
+	/**
+	 * To be called when a valid record of given location times out, or is overwritten.
+	 */
+	void removeLocationRecord(uint8_t location);
+
+	/**
+	 * Invalidates all records and clears the location record counts.
+	 */
+	void clearRecords();
+
+	/**
+	 * Returns the index of a record in the store.
+	 */
+	uint8_t getIndex(PresenceRecord* record);
+
+	/**
+	 * Returns whether the mesh send throttle of a record has passed.
+	 */
+	bool isMeshSendAllowed(PresenceRecord* record);
+
 	/**
 	 * finds oldest record and default constructs its present record,
 	 * then returns the pointer to it.
@@ -162,7 +202,7 @@ private:
 	void dispatchPresenceMutationEvent(PresenceMutation mutation);
 
 	/**
-	 * To be called every second. Decreases timeoutCountdownSeconds of the records
+	 * To be called every second. Ticks the timeouts of the records
 	 * and dispatches exit-events when necessary.
 	 */
 	void tickSecond();
@@ -8,6 +8,7 @@
 #pragma once
 
 #include "common/cs_Types.h"
+#include "events/cs_CompatibilityTick.h"
 #include "events/cs_EventListener.h"
 #include "util/cs_Utils.h"
 
@@ -69,6 +70,9 @@ private:
 	command_adv_claim_t _claims[CMD_ADV_MAX_CLAIM_COUNT];
 	TYPIFY(CONFIG_SPHERE_ID) _sphereId = 0;
 
+	// Requested while a claim has to be timed out.
+	TickRequest _tickRequest;
+
 	void parseAdvertisement(scanned_device_t* scannedDevice);
 
 	// Return true when command payload is validated, and RC5 payload is decrypted.
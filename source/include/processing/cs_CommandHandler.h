@@ -11,6 +11,7 @@
 #include <cfg/cs_Boards.h>
 #include <common/cs_Types.h>
 #include <protocol/cs_CommandTypes.h>
+#include <util/cs_Coroutine.h>
 
 /**
  * Every command from an external device such as a smartphone goes through the CommandHandler.
@@ -79,11 +80,13 @@ private:
 
 		// Source of the command.
 		cmd_source_with_counter_t source;
-
-		// Number of ticks until timeout.
-		uint16_t timeoutCountdown;
 	} _awaitingCommandResult;
 
+	/**
+	 * Stops awaiting the result, ASYNC_COMMAND_TIMEOUT_MS after the command.
+	 */
+	Coroutine _asyncCommandTimeoutRoutine;
+
 	static const uint32_t ASYNC_COMMAND_TIMEOUT_MS = 10000;
 
 	EncryptionAccessLevel getRequiredAccessLevel(const CommandHandlerTypes type);
@@ -153,12 +156,18 @@ private:
 	void handleCmdHubData(cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t& result);
 	void handleCmdStateGet(cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t& result);
 	void handleCmdStateSet(cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t& result);
+	void handleCmdStateExport(cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t& result);
+	void handleCmdStateImport(cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t& result);
 	void handleCmdRegisterTrackedDevice(
 			cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t& result);
 	void handleCmdTrackedDeviceHeartbeat(
 			cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t& result);
 	void handleCmdGetUptime(cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t& result);
-	void handleCmdMicroappUpload(cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t& result);
+	void handleCmdMicroappUpload(
+			cs_data_t commandData,
+			const EncryptionAccessLevel accessLevel,
+			cs_result_t& result,
+			bool compressed = false);
 	void handleCmdMicroappMessage(cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t& result);
 
 	/**
@@ -48,9 +48,9 @@ public:
 	service_data_encrypted_t* getNextState();
 
 	/**
-	 * To be called every EVT_TICK.
+	 * To be called every EVT_TICK_SECOND.
 	 */
-	void tick(TYPIFY(EVT_TICK) tickCount);
+	void tickSecond();
 
 private:
 	cs_external_state_item_t* _states;
@@ -173,6 +173,7 @@ private:
 														 //! the median)
 	uint16_t _consecutiveDimmerOvercurrent = 0;
 	uint16_t _consecutiveOvercurrent       = 0;
+	uint8_t _currentMeasuredEventCountdown = CURRENT_MEASURED_EVENT_INTERVAL;
 
 	TYPIFY(CONFIG_SOFT_FUSE_CURRENT_THRESHOLD) _currentMilliAmpThreshold;  //! Current threshold from settings.
 	TYPIFY(CONFIG_SOFT_FUSE_CURRENT_THRESHOLD_DIMMER)
@@ -184,7 +185,7 @@ private:
 	uint32_t _lastSwitchOffTicks;                   //! RTC ticks when the switch was last turned off.
 	bool _lastSwitchOffTicksValid         = false;  //! Keep up whether the last switch off time is valid.
 	bool _dimmerFailureDetectionStarted   = false;  //! Keep up whether the IGBT failure detection has started yet.
-	uint32_t _calibratePowerZeroCountDown = 4000 / TICK_INTERVAL_MS;
+	uint32_t _calibratePowerZeroCountDown = 4;      //! Seconds until the power zero may be calibrated.
 
 	// Store the adc config, so that the actual adc config can be changed.
 	struct __attribute__((packed)) {
@@ -8,6 +8,7 @@
 
 #include <ble/cs_Nordic.h>
 #include <cfg/cs_AutoConfig.h>
+#include <events/cs_CompatibilityTick.h>
 #include <events/cs_EventListener.h>
 
 struct __attribute__((__packed__)) t2t_entry_t {
@@ -29,7 +30,7 @@ struct __attribute__((__packed__)) t2t_entry_t {
  * Determines whether a device is considered to be close. Implemented as a leaking bucket:
  * - A score per MAC address is kept up.
  * - Each received background advertisement with an RSSI above threshold, adds to the score.
- * - Each tick the score is decreased.
+ * - Each tick the score is decreased. Ticks are only requested while a score or the timeout is above 0.
  * - When going from below score threshold to above, a toggle is sent.
  * Makes sure there is some time between two toggles.
  * - Each time a toggle is sent, score additions will be blocked for a certain time.
@@ -86,6 +87,11 @@ private:
 	 */
 	uint8_t timeoutTicks        = (T2T_TIMEOUT_MS / TICK_INTERVAL_MS);
 
+	/**
+	 * Requested while a score or the timeout has to be counted down.
+	 */
+	TickRequest _tickRequest;
+
 	TapToToggle();
 
 	/**
@@ -17,9 +17,13 @@
 #include "events/cs_EventDispatcher.h"
 #include "events/cs_EventListener.h"
 #include "storage/cs_State.h"
+#include "util/cs_Coroutine.h"
 
 #define TEMPERATURE_UPDATE_FREQUENCY 10
 
+// The temperature changes slowly, so the check may be delayed a bit, to be combined with other wake ups.
+#define TEMPERATURE_UPDATE_ALLOWED_JITTER_MS 50
+
 /** Check if the temperature exceeds a certain threshold
  */
 class TemperatureGuard {
@@ -34,14 +38,10 @@ public:
 
 	void tick();
 
-	void scheduleNextTick();
-
 	void start();
 
 	void stop();
 
-	static void staticTick(TemperatureGuard* ptr) { ptr->tick(); }
-
 	void handleCompEvent(CompEvent_t event);
 
 private:
@@ -54,8 +54,7 @@ private:
 	//! This class is singleton, deny implementation
 	void operator=(TemperatureGuard const&);
 
-	app_timer_t _appTimerData;
-	app_timer_id_t _appTimerId;
+	Coroutine _tickRoutine;
 	TYPIFY(CONFIG_MAX_CHIP_TEMP) _maxChipTemp;
 	COMP* _comp;
 	CS_TYPE _lastChipTempEvent;
@@ -36,6 +36,7 @@ enum CommandHandlerTypes {
 	CTRL_CMD_SET_SUN_TIME             = 34,
 	CTRL_CMD_GET_TIME                 = 35,
 	CTRL_CMD_RESET_MESH_TOPOLOGY      = 36,
+	CTRL_CMD_GET_MESH_TOPOLOGY        = 37,
 
 	CTRL_CMD_ALLOW_DIMMING            = 40,
 	CTRL_CMD_LOCK_SWITCH              = 41,
@@ -71,8 +72,11 @@ enum CommandHandlerTypes {
 	CTRL_CMD_MICROAPP_ENABLE          = 94,
 	CTRL_CMD_MICROAPP_DISABLE         = 95,
 	CTRL_CMD_MICROAPP_MESSAGE         = 96,
+	CTRL_CMD_MICROAPP_UPLOAD_LZ       = 97,
 
 	CTRL_CMD_CLEAN_FLASH              = 100,
+	CTRL_CMD_STATE_EXPORT             = 101,
+	CTRL_CMD_STATE_IMPORT             = 102,
 
 	CTRL_CMD_FILTER_UPLOAD            = 110,
 	CTRL_CMD_FILTER_REMOVE            = 111,
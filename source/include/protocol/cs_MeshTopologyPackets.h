@@ -25,6 +25,26 @@ struct __attribute__((packed)) mesh_topology_neighbour_rssi_uart_t {
 	uint8_t msgNumber;           // Number that is increased by 1 for each message.
 };
 
+/**
+ * Header of a part of the full topology, sent over UART.
+ * Followed by linkCount times mesh_topology_link_uart_t.
+ */
+struct __attribute__((packed)) mesh_topology_matrix_header_uart_t {
+	uint8_t type = 0;
+	uint16_t totalLinkCount;  // Number of links in the full topology.
+	uint16_t firstLinkIndex;  // Index of the first link of this message in the full topology.
+	uint8_t linkCount;        // Number of links in this message.
+};
+
+struct __attribute__((packed)) mesh_topology_link_uart_t {
+	stone_id_t receiverId;
+	stone_id_t senderId;
+	int8_t rssiChannel37;
+	int8_t rssiChannel38;
+	int8_t rssiChannel39;
+	uint8_t lastUpdateMinutesAgo;  // How many minutes ago this link was last updated.
+};
+
 /**
  * Message format to be sent over uart.
  * This is the inflated counterpart of rssi_data_message_t.
@@ -152,6 +152,33 @@ struct __attribute__((__packed__)) state_packet_header_t {
 	uint8_t reserved = 0;
 };
 
+/**
+ * State export packet.
+ */
+struct __attribute__((__packed__)) state_export_packet_t {
+	uint32_t offset;
+	uint16_t typeStart;
+	uint16_t typeEnd;  // Inclusive.
+};
+
+/**
+ * Header of a chunk of a state export or import stream.
+ */
+struct __attribute__((__packed__)) state_stream_header_t {
+	uint32_t totalSize;
+	uint32_t crc;  // CRC-32 of the whole stream.
+	uint32_t offset;
+};
+
+/**
+ * Header of a record in a state export or import stream, followed by the value.
+ */
+struct __attribute__((__packed__)) state_record_header_t {
+	uint16_t stateType;
+	uint8_t stateId;
+	uint8_t size;
+};
+
 /**
  * Flags to determine how to send the mesh message.
  *
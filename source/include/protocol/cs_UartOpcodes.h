@@ -101,6 +101,7 @@ enum UartOpcodeTx {
 	UART_OPCODE_TX_NEIGHBOUR_RSSI = 10111,  // Payload: mesh_topology_neighbour_rssi_t
 	UART_OPCODE_TX_ASSET_INFO_ID =
 			10112,  // Payload: cs_asset_info_id_t. Info about an asset a Crownstone on the mesh has forwarded.
+	UART_OPCODE_TX_MESH_TOPOLOGY = 10113,  // Payload: mesh_topology_matrix_header_uart_t + mesh_topology_link_uart_t[]
 
 	UART_OPCODE_TX_LOG           = 10200,  // Debug logs, payload is in the form: [uart_msg_log_header_t,
 										   // [uart_msg_log_arg_header_t, data], [uart_msg_log_arg_header_t, data], ...]
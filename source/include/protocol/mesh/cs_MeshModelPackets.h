@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <cfg/cs_Config.h>
 #include <mesh/cs_MeshDefines.h>
 #include <protocol/cs_AssetFilterPackets.h>
 #include <protocol/cs_CmdSource.h>
@@ -85,15 +86,18 @@ enum cs_mesh_model_msg_type_t {
 	// 23 removed
 	CS_MESH_MODEL_TYPE_RSSI_DATA =
 			24,  // Payload: rssi_data_message_t                             Only used in MeshTopologyResearch
-	CS_MESH_MODEL_TYPE_STONE_MAC            = 25,  // Payload: cs_mesh_model_msg_stone_mac_t
-	CS_MESH_MODEL_TYPE_ASSET_FILTER_VERSION = 26,  // Payload: cs_mesh_model_msg_asset_filter_version_t
-	CS_MESH_MODEL_TYPE_ASSET_INFO_MAC       = 27,  // Payload: cs_mesh_model_msg_asset_report_mac_t
-	CS_MESH_MODEL_TYPE_NEIGHBOUR_RSSI       = 28,  // Payload: cs_mesh_model_msg_neighbour_rssi_t
-	CS_MESH_MODEL_TYPE_CTRL_CMD             = 29,  // Payload: cs_mesh_model_msg_ctrl_cmd_header_ext_t + payload
-	CS_MESH_MODEL_TYPE_ASSET_INFO_ID        = 30,  // Payload: cs_mesh_model_msg_asset_report_id_t
-
-	CS_MESH_MODEL_TYPE_MICROAPP             = 200,  // Payload: anything.
-	CS_MESH_MODEL_TYPE_UNKNOWN              = 255
+	CS_MESH_MODEL_TYPE_STONE_MAC                  = 25,  // Payload: cs_mesh_model_msg_stone_mac_t
+	CS_MESH_MODEL_TYPE_ASSET_FILTER_VERSION       = 26,  // Payload: cs_mesh_model_msg_asset_filter_version_t
+	CS_MESH_MODEL_TYPE_ASSET_INFO_MAC             = 27,  // Payload: cs_mesh_model_msg_asset_report_mac_t
+	CS_MESH_MODEL_TYPE_NEIGHBOUR_RSSI             = 28,  // Payload: cs_mesh_model_msg_neighbour_rssi_t
+	CS_MESH_MODEL_TYPE_CTRL_CMD                   = 29,  // Payload: cs_mesh_model_msg_ctrl_cmd_header_ext_t + payload
+	CS_MESH_MODEL_TYPE_ASSET_INFO_ID              = 30,  // Payload: cs_mesh_model_msg_asset_report_id_t
+	CS_MESH_MODEL_TYPE_ASSET_FILTER_CHUNK_REQUEST = 31,  // Payload: cs_mesh_model_msg_asset_filter_chunk_request_t
+	CS_MESH_MODEL_TYPE_ASSET_FILTER_CHUNK         = 32,  // Payload: cs_mesh_model_msg_asset_filter_chunk_header_t + data
+	CS_MESH_MODEL_TYPE_NEIGHBOUR_RSSI_DIGEST      = 33,  // Payload: cs_mesh_model_msg_neighbour_rssi_digest_t
+
+	CS_MESH_MODEL_TYPE_MICROAPP                   = 200,  // Payload: anything.
+	CS_MESH_MODEL_TYPE_UNKNOWN                    = 255
 };
 
 struct __attribute__((__packed__)) cs_mesh_model_msg_test_t {
@@ -210,11 +214,12 @@ struct __attribute__((__packed__)) cs_mesh_model_msg_result_header_t {
  * Packed version of time_sync_message_t.
  */
 struct __attribute__((__packed__)) cs_mesh_model_msg_time_sync_t {
-	uint32_t posix_s;        // Seconds since epoch.
-	uint16_t posix_ms : 10;  // Milliseconds passed since posix_s.
-	uint8_t version : 6;     // Synchronization version,
-	bool overrideRoot : 1;   // Whether this time overrides the root time.
-	uint8_t reserved : 7;    // @arend maybe use these bits to increase version size.
+	uint32_t posix_s;         // Seconds since epoch.
+	uint16_t posix_ms : 10;   // Milliseconds passed since posix_s.
+	uint8_t version : 6;      // Synchronization version,
+	bool overrideRoot : 1;    // Whether this time overrides the root time.
+	uint8_t periodShift : 2;  // Period between sync messages of the root clock, as shift of the base period.
+	uint8_t reserved : 5;     // @arend maybe use these bits to increase version size.
 };
 
 /**
@@ -240,7 +245,8 @@ struct __attribute__((__packed__)) cs_mesh_model_msg_asset_report_id_t {
 	union {
 		struct {
 			uint16_t channel : 2;
-			uint16_t reserved : 14;  // Must be 0 for now.
+			uint16_t reserved : 6;  // Must be 0 for now.
+			uint16_t counter : 8;   // Increased for each report sent by the reporter, 0 when unknown.
 		};
 		uint16_t asInt = 0;
 	};
@@ -311,6 +317,33 @@ struct __attribute__((__packed__)) cs_mesh_model_msg_neighbour_rssi_t {
 	//   uint8_t lastSeenSecondsAgo;
 };
 
+/**
+ * RSSI of a neighbour, quantised to 5 bits per channel.
+ *
+ * A value of 0 means there is no data for that channel.
+ */
+struct __attribute__((__packed__)) cs_mesh_model_quantised_rssi_t {
+	uint16_t channel37 : 5;
+	uint16_t channel38 : 5;
+	uint16_t channel39 : 5;
+	uint16_t reserved : 1;  // Reserved for future use, 0 for now.
+};
+
+struct __attribute__((__packed__)) cs_mesh_model_neighbour_rssi_link_t {
+	stone_id_t neighbourId;               // 0 when this entry is unused.
+	cs_mesh_model_quantised_rssi_t rssi;  // All 0 when the neighbour is no longer seen.
+};
+
+/**
+ * Number of links that fit in a single, unsegmented, digest message.
+ */
+static constexpr uint8_t MESH_NEIGHBOUR_RSSI_DIGEST_LINK_COUNT = 2;
+
+struct __attribute__((__packed__)) cs_mesh_model_msg_neighbour_rssi_digest_t {
+	uint8_t counter;  // Message counter, to identify package loss at the receiving node.
+	cs_mesh_model_neighbour_rssi_link_t links[MESH_NEIGHBOUR_RSSI_DIGEST_LINK_COUNT];
+};
+
 struct __attribute__((__packed__)) cs_mesh_model_msg_stone_mac_t {
 	uint8_t type;  // 0 = request, 1 = reply.
 	uint8_t connectionProtocol = CS_CONNECTION_PROTOCOL_VERSION;
@@ -322,3 +355,29 @@ struct __attribute__((__packed__)) cs_mesh_model_msg_asset_filter_version_t {
 	uint16_t masterVersion;
 	uint32_t masterCrc;
 };
+
+/**
+ * Request a chunk of the asset filters from a neighbour.
+ */
+struct __attribute__((__packed__)) cs_mesh_model_msg_asset_filter_chunk_request_t {
+	asset_filter_cmd_protocol_t protocol;
+	uint16_t masterVersion;    // Master version of the filters that are being downloaded.
+	uint8_t filterId;          // When chunk start index is 0: the first filter with an ID equal or larger is sent.
+	uint16_t chunkStartIndex;  // Start index in the filter data.
+};
+
+/**
+ * Header of a chunk of an asset filter, followed by the chunk data.
+ */
+struct __attribute__((__packed__)) cs_mesh_model_msg_asset_filter_chunk_header_t {
+	asset_filter_cmd_protocol_t protocol;
+	uint16_t masterVersion;    // Master version of the filters this chunk is part of.
+	uint8_t filterIdBitmask;   // Bitmask of all filter IDs of this master version: bit N is set for filter ID N.
+	uint8_t filterId;          // Filter ID of this chunk.
+	uint16_t totalSize;        // Size of the filter data, 0 when there is no filter with the requested ID or larger.
+	uint32_t filterCrc;        // CRC of the filter data.
+	uint16_t chunkStartIndex;  // Start index of this chunk in the filter data.
+};
+
+static constexpr uint8_t MAX_MESH_ASSET_FILTER_CHUNK_SIZE =
+		MAX_MESH_MSG_SIZE - MESH_HEADER_SIZE - sizeof(cs_mesh_model_msg_asset_filter_chunk_header_t);
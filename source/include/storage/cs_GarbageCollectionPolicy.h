@@ -0,0 +1,60 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Flash usage, as reported by FDS, in words of 4 bytes.
+ */
+struct storage_usage_t {
+	uint32_t totalWords       = 0;
+	uint32_t usedWords        = 0;
+	/**
+	 * Words used by deleted or updated records, which are reclaimed by garbage collection.
+	 */
+	uint32_t freeableWords    = 0;
+	/**
+	 * Largest number of words that can be written to a single page.
+	 */
+	uint32_t largestFreeWords = 0;
+};
+
+/**
+ * Decides when to start garbage collection, before a write fails because the flash is full.
+ *
+ * When idle, garbage is collected once a significant part of the flash can be reclaimed, or when the free space gets
+ * low and at least urgentFreeWords can be reclaimed. Garbage collection erases pages, so it isn't started for every
+ * deleted record, to limit flash wear.
+ * When not idle, garbage is only collected when the free space is so low that the next write is likely to fail.
+ */
+class GarbageCollectionPolicy {
+public:
+	/**
+	 * @param[in] idleFreeablePercent  When idle, collect when at least this percentage of the flash is freeable.
+	 * @param[in] idleFreeWords        When idle, collect when the largest free space is smaller than this.
+	 *                                 Should be smaller than the page size.
+	 * @param[in] urgentFreeWords      Always collect when the largest free space is smaller than this.
+	 */
+	GarbageCollectionPolicy(uint8_t idleFreeablePercent, uint32_t idleFreeWords, uint32_t urgentFreeWords)
+			: _idleFreeablePercent(idleFreeablePercent)
+			, _idleFreeWords(idleFreeWords)
+			, _urgentFreeWords(urgentFreeWords) {}
+
+	/**
+	 * Whether garbage collection should be started.
+	 *
+	 * @param[in] usage           Current flash usage.
+	 * @param[in] idle            Whether the device is idle: no connections, and no pending writes.
+	 */
+	bool shouldCollect(const storage_usage_t& usage, bool idle) const;
+
+private:
+	uint8_t _idleFreeablePercent;
+	uint32_t _idleFreeWords;
+	uint32_t _urgentFreeWords;
+};
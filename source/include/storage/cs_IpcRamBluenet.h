@@ -55,6 +55,25 @@ public:
 	 */
 	void updateMicroappData(uint8_t appIndex, const microapp_reboot_data_t& data);
 
+	/**
+	 * Whether warm boot data was handed over by the previous boot.
+	 *
+	 * The warm boot data is cleared from IPC ram on init, so that it's only used for a single boot.
+	 */
+	bool hasWarmBootData();
+
+	/**
+	 * Get the warm boot data.
+	 *
+	 * Don't forget to first check whether there is warm boot data.
+	 */
+	const bluenet_ipc_warm_boot_data_t& getWarmBootData();
+
+	/**
+	 * Write warm boot data to IPC ram, to be called right before an intentional reset.
+	 */
+	void storeWarmBootData(const bluenet_ipc_warm_boot_data_t& data);
+
 private:
 	//! Constructor, singleton, thus made private
 	IpcRamBluenet();
@@ -70,6 +89,14 @@ private:
 
 	bool _isValidOnBoot = false;
 
+	//! Warm boot data, read on init.
+	bluenet_ipc_data_payload_t _warmBootData;
+
+	bool _hasWarmBootData = false;
+
+	//! Read and clear the warm boot data.
+	void initWarmBootData();
+
 	//! Clear the cached data.
 	void clearData();
 
@@ -11,8 +11,11 @@
 #include <common/cs_Types.h>
 #include <drivers/cs_Storage.h>
 #include <drivers/cs_Timer.h>
+#include <events/cs_CompatibilityTick.h>
 #include <events/cs_EventListener.h>
 #include <protocol/cs_ErrorCodes.h>
+#include <storage/cs_StateJournal.h>
+#include <test/cs_TestAccess.h>
 
 #include <vector>
 
@@ -133,6 +136,7 @@ struct cs_id_list_t {
  *     - if present, copy FLASH value to RAM.
  *     - if not present, get default value, store default value in RAM.
  *   4. Copy RAM value to return value.
+ * All values in FLASH are already copied to RAM at init, see preload().
  *
  * Set procedure:
  *   1. Copy value to RAM.
@@ -141,8 +145,14 @@ struct cs_id_list_t {
  *   3. Write to storage.
  *     - If success, return.
  *     - If busy, add state type to queue, return.
+ *
+ * Small values that are written often, like the switch state, are not written to flash as a record each. Instead, the
+ * changes are batched in a journal record, written STATE_JOURNAL_FLUSH_INTERVAL_MS after the first change, see
+ * StateJournal. So the latest changes of those values can be lost at a reset, but they wear the flash a lot less.
  */
 class State : public BaseClass<>, EventListener {
+	friend class TestAccess<State>;
+
 public:
 	/**
 	 * Get a reference to the State object.
@@ -232,6 +242,7 @@ public:
 	 * Assumes persistence mode STRATEGY1.
 	 * Use this when you know a lot of sets of the same type may be done in a short time period.
 	 * Each time this function is called, the timeout is reset.
+	 * Journaled types are not delayed, as the journal already batches their changes, see StateJournal.
 	 *
 	 * @param[in] data            Data struct with state type, data, and size.
 	 * @param[in] delay           How long the delay should be, in seconds.
@@ -383,6 +394,16 @@ protected:
 	 */
 	cs_ret_code_t loadFromRam(cs_state_data_t& data);
 
+	/**
+	 * Adds a value to ram, read from flash, or the default value when it is not in flash.
+	 *
+	 * @param[in] type            State type.
+	 * @param[in] id              State id.
+	 * @param[out] index_in_ram   Index where the data is stored.
+	 * @return                    Return code.
+	 */
+	cs_ret_code_t loadToRam(const CS_TYPE& type, cs_state_id_t id, size16_t& index_in_ram);
+
 	/**
 	 * Adds a new state_data struct to ram.
 	 *
@@ -453,6 +474,38 @@ protected:
 
 	void delayedStoreTick();
 
+	/**
+	 * Every STORAGE_GC_CHECK_INTERVAL_MS, lets storage collect garbage when the flash usage asks for it.
+	 * To be called every EVT_TICK_SECOND.
+	 *
+	 * The device is considered idle when there are no connections, and no pending flash operations.
+	 */
+	void garbageCollectTick();
+
+	/**
+	 * Regularly writes the journaled changes, or continues compaction of the journal.
+	 */
+	void journalTick();
+
+	/**
+	 * Request the tick while there are queued flash operations, or journaled changes to write.
+	 */
+	void updateTickRequest();
+
+	/**
+	 * Write the journaled changes in a journal record. Starts compaction when the journal is full.
+	 *
+	 * @return ERR_BUSY           When the record has to be written again later.
+	 */
+	cs_ret_code_t flushJournal();
+
+	/**
+	 * Write all journaled values as normal records, then remove the journal records.
+	 *
+	 * @return ERR_BUSY           When compaction has to be continued later.
+	 */
+	cs_ret_code_t compactJournal();
+
 	/**
 	 * Stores state data structs with pointers to state data.
 	 */
@@ -472,6 +525,20 @@ protected:
 
 	bool _performingFactoryReset = false;
 
+	//! Number of BLE connections.
+	uint8_t _connectionCount     = 0;
+
+	//! Number of seconds since garbage collection was last checked.
+	uint16_t _gcCheckSeconds     = 0;
+
+	StateJournal _journal;
+
+	//! Number of ticks since the journal was last written.
+	uint16_t _journalFlushTicks  = 0;
+
+	//! Requested while delayedStoreTick() or journalTick() has work to do.
+	TickRequest _tickRequest;
+
 private:
 	//! State constructor, singleton, thus made private
 	State();
@@ -504,6 +571,24 @@ private:
 	 */
 	cs_ret_code_t getIdsFromFlash(const CS_TYPE& type, std::vector<cs_state_id_t>*& ids);
 
+	/**
+	 * Load all values in flash to ram, and cache the ids of the types with multiple ids.
+	 *
+	 * This iterates over storage once at init, instead of reading each type at its first get(), and getting the ids
+	 * of each type at its first getIds(). Values that are not in flash are still loaded at their first get().
+	 */
+	void preload();
+
+	/**
+	 * Apply the journal records that were preloaded, in order of sequence number, and start compaction of the journal.
+	 */
+	void replayJournal();
+
+	/**
+	 * Whether the list of IDs of this type is cached.
+	 */
+	bool hasIdsCache(const CS_TYPE& type);
+
 	/**
 	 * Add ID to list of cached IDs.
 	 *
@@ -0,0 +1,185 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <cfg/cs_Config.h>
+#include <common/cs_Types.h>
+#include <storage/cs_StateData.h>
+
+#include <vector>
+
+/**
+ * Keeps track of the state journal: small state values that change often, are not written to flash as a record each,
+ * but are batched in journal records instead.
+ *
+ * The changed values are written as entries in a single journal record, of type STATE_JOURNAL, one flush interval after
+ * the first change.
+ * A value is only written once per record, no matter how often it changed. A removed value is written as an entry
+ * without value. The records are written with increasing ids, and once there are STATE_JOURNAL_RECORD_COUNT records,
+ * the journal is compacted: all journaled values are written as normal records, after which the journal records are
+ * removed.
+ * At boot, the journal records are replayed in order of sequence number, and then compacted.
+ *
+ * Compaction writes a compaction marker after the journaled values, and before the journal records are removed. So when
+ * a reset interrupts the removal, the remaining journal records are not replayed over the compacted values.
+ *
+ * This class only holds the bookkeeping, State reads and writes the values.
+ */
+class StateJournal {
+public:
+	/**
+	 * Id of the compaction marker: a journal record without entries. Journal records with a lower sequence number than
+	 * the marker have been compacted.
+	 */
+	static constexpr cs_state_id_t COMPACTION_MARKER_ID = STATE_JOURNAL_RECORD_COUNT;
+
+	/**
+	 * Whether changes of this type are written to the journal, instead of as a record of its own.
+	 */
+	static bool isJournaled(const CS_TYPE& type);
+
+	/**
+	 * Append an entry to a journal record.
+	 *
+	 * @param[in,out] record      The record to append the entry to.
+	 * @param[in] data            Type, id, and value of the entry. Size 0 for a removed value.
+	 * @return                    False when the entry does not fit.
+	 */
+	static bool appendEntry(cs_state_journal_t& record, const cs_state_data_t& data);
+
+	/**
+	 * Get an entry of a journal record.
+	 *
+	 * @param[in] record          The record to get the entry from.
+	 * @param[in,out] offset      Offset of the entry in the record, set to the offset of the next entry.
+	 * @param[out] data           Type, id, and value of the entry. The value points into the record.
+	 * @return                    False when there are no more entries, or when the entry is invalid.
+	 */
+	static bool getEntry(cs_state_journal_t& record, uint8_t& offset, cs_state_data_t& data);
+
+	/**
+	 * Mark a value as changed, so that it will be written in the next journal record.
+	 */
+	void addChange(const CS_TYPE& type, cs_state_id_t id);
+
+	bool hasChanges() const { return !_changes.empty(); }
+
+	/**
+	 * Values that changed since the last journal record was written.
+	 */
+	const std::vector<cs_type_and_id_t>& getChanges() const { return _changes; }
+
+	/**
+	 * To be called when a journal record has been written.
+	 *
+	 * @param[in] entryCount      Number of changes, from the start of the list, that were written in the record.
+	 */
+	void onRecordWritten(uint8_t entryCount);
+
+	/**
+	 * To be called for each record that is replayed at boot.
+	 */
+	void onRecordReplayed(cs_state_id_t id, uint32_t sequenceNumber);
+
+	/**
+	 * To be called for the compaction marker at boot, before the records are replayed.
+	 */
+	void onCompactionMarkerReplayed(uint32_t sequenceNumber);
+
+	/**
+	 * Whether a record with given sequence number has been compacted, so that it should not be replayed.
+	 */
+	bool isCompacted(uint32_t sequenceNumber) const { return sequenceNumber < _compactedSequenceNumber; }
+
+	/**
+	 * Id of the next journal record.
+	 */
+	cs_state_id_t getNextRecordId() const { return _recordCount; }
+
+	uint32_t getNextSequenceNumber() const { return _sequenceNumber; }
+
+	/**
+	 * Whether all journal records have been written, so the journal has to be compacted.
+	 */
+	bool isFull() const { return _recordCount >= STATE_JOURNAL_RECORD_COUNT; }
+
+	/**
+	 * Start compaction: all journaled values, including the pending changes, have to be written as normal records.
+	 *
+	 * Values that change during compaction are written to the journal after compaction is done.
+	 */
+	void startCompaction();
+
+	bool isCompacting() const { return _compacting; }
+
+	/**
+	 * Values that have to be written as normal record, before the journal records can be removed.
+	 */
+	std::vector<cs_type_and_id_t>& getKeysToCompact() { return _keys; }
+
+	/**
+	 * Get the id of the next journal record to remove, in order of sequence number.
+	 *
+	 * @return                    False when all journal records have been removed.
+	 */
+	bool getNextRecordToRemove(cs_state_id_t& id) const;
+
+	/**
+	 * Whether the compaction marker has to be written, after the journaled values and before the records are removed.
+	 * The marker gets the next sequence number.
+	 */
+	bool needsCompactionMarker() const { return _compacting && !_compactionMarkerWritten && _recordCount != 0; }
+
+	void onCompactionMarkerWritten();
+
+	void onRecordRemoved();
+
+	/**
+	 * To be called when all journaled values have been written as normal records, and all journal records have been
+	 * removed.
+	 */
+	void onCompacted();
+
+	/**
+	 * Clear the journal, for example after a factory reset.
+	 */
+	void clear();
+
+private:
+	/**
+	 * Values that changed since the last journal record was written.
+	 */
+	std::vector<cs_type_and_id_t> _changes;
+
+	/**
+	 * Values that are in the journal records in flash.
+	 */
+	std::vector<cs_type_and_id_t> _keys;
+
+	/**
+	 * Number of journal records, records have ids 0 to count - 1.
+	 */
+	uint8_t _recordCount              = 0;
+
+	/**
+	 * Number of journal records that have been removed during compaction.
+	 */
+	uint8_t _removedRecordCount       = 0;
+
+	uint32_t _sequenceNumber          = 0;
+
+	/**
+	 * Sequence number of the compaction marker.
+	 */
+	uint32_t _compactedSequenceNumber = 0;
+
+	bool _compacting                  = false;
+
+	bool _compactionMarkerWritten     = false;
+
+	static void addKey(std::vector<cs_type_and_id_t>& keys, const CS_TYPE& type, cs_state_id_t id);
+};
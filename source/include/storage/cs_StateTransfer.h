@@ -0,0 +1,146 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <common/cs_Types.h>
+#include <protocol/cs_Packets.h>
+
+/**
+ * Exports and imports the persisted state values that can be set by the user, in bulk.
+ *
+ * This replaces a state get or set command per state type, when backing up, restoring, or copying the configuration
+ * of a Crownstone.
+ *
+ * The export is a stream of records: a state_record_header_t, followed by the value. The records are ordered by state
+ * type, then id. The stream is generated again for each chunk, so a chunk can be requested at any offset, and the
+ * export can be resumed after a disconnect. Each chunk comes with the size and CRC of the whole stream, so that a
+ * change of the state values during the export can be detected.
+ *
+ * The import takes a stream of the same format. The chunks have to be sent in order, and are kept in RAM until the
+ * whole stream is received. Then all records are checked, and only when they are all valid, they are all set at once.
+ * The current values are kept before anything is set, so that they can be set again when a record can't be set after
+ * all, for example when the flash is full.
+ */
+class StateTransfer {
+public:
+	static StateTransfer& getInstance() {
+		static StateTransfer instance;
+		return instance;
+	}
+
+	/**
+	 * Get a chunk of the export stream.
+	 *
+	 * @param[in] request         Offset of the chunk, and range of state types to export.
+	 * @param[in] accessLevel     Only state types that can be get and set with this access level are exported.
+	 * @param[out] header         Set to the size and CRC of the whole stream, and the offset of the chunk.
+	 * @param[out] chunk          Buffer to copy the chunk to. The length is set to the size of the chunk.
+	 * @return ERR_SUCCESS        The chunk is copied, it's empty when the offset is at the end of the stream.
+	 * @return ERR_WRONG_PARAMETER  The offset is beyond the end of the stream.
+	 */
+	cs_ret_code_t getExportChunk(
+			const state_export_packet_t& request,
+			const EncryptionAccessLevel accessLevel,
+			state_stream_header_t& header,
+			cs_data_t& chunk);
+
+	/**
+	 * Receive a chunk of an import stream.
+	 *
+	 * A chunk at offset 0 starts a new import, any other chunk should continue at the received size.
+	 * When the last chunk is received, the CRC is checked, and all records are set.
+	 *
+	 * @param[in] header          Size and CRC of the whole stream, and the offset of the chunk.
+	 * @param[in] chunk           The chunk.
+	 * @param[in] accessLevel     Access level required to set each state type of the import.
+	 * @param[out] receivedSize   Set to the number of bytes of the stream that have been received.
+	 * @return ERR_SUCCESS        The chunk is received, and when it was the last chunk: all records have been set.
+	 * @return ERR_WRONG_STATE    The offset is not at the received size, the chunk should be sent again from there.
+	 * @return ERR_WRONG_PAYLOAD_LENGTH  The chunk goes beyond the size of the stream.
+	 * @return ERR_NO_SPACE       The stream is too large.
+	 * @return ERR_MISMATCH       The CRC of the stream doesn't match.
+	 * @return                    Other codes when a record is invalid, or can't be set. Nothing has been set then, or
+	 *                            the previous values have been set again.
+	 */
+	cs_ret_code_t receiveImportChunk(
+			const state_stream_header_t& header,
+			cs_const_data_t chunk,
+			const EncryptionAccessLevel accessLevel,
+			uint32_t& receivedSize);
+
+private:
+	StateTransfer() {}
+
+	//! Import stream, allocated at the first chunk, freed when the import is done.
+	uint8_t* _importBuffer = nullptr;
+
+	uint32_t _importSize   = 0;
+
+	uint32_t _receivedSize = 0;
+
+	/**
+	 * Whether the state type is exported, and accepted in an import.
+	 */
+	bool isTransferable(const CS_TYPE& type, const EncryptionAccessLevel accessLevel);
+
+	/**
+	 * Add a record of the current state value to the export stream, and copy the part that overlaps the chunk.
+	 *
+	 * @param[in] type            State type.
+	 * @param[in] id              State id.
+	 * @param[in] chunkOffset     Offset of the chunk in the stream.
+	 * @param[in] chunk           Buffer of the chunk, with its full length.
+	 * @param[in,out] streamSize  Size of the stream so far.
+	 * @param[in,out] crc         CRC of the stream so far.
+	 */
+	void exportRecord(
+			const CS_TYPE& type,
+			cs_state_id_t id,
+			uint32_t chunkOffset,
+			cs_data_t& chunk,
+			uint32_t& streamSize,
+			uint32_t& crc);
+
+	/**
+	 * Check all records of the import stream.
+	 *
+	 * @param[in] accessLevel     Access level required to set each state type.
+	 * @param[out] rollbackSize   Set to the size required to keep the current value of each record.
+	 * @return                    Return code.
+	 */
+	cs_ret_code_t checkImport(const EncryptionAccessLevel accessLevel, uint32_t& rollbackSize);
+
+	/**
+	 * Set all records of the checked import stream.
+	 *
+	 * First the current value of each record is kept, then the records are set. When a record can't be set, the
+	 * kept values are set again.
+	 *
+	 * @param[in] rollbackSize    Size required to keep the current values, see checkImport().
+	 * @return                    Return code.
+	 */
+	cs_ret_code_t setImport(uint32_t rollbackSize);
+
+	/**
+	 * Keep the current value of a record, in the same format as the import stream.
+	 * A value that isn't stored is kept as a record of size 0.
+	 *
+	 * @param[in] recordHeader        Header of the record in the import stream.
+	 * @param[in] rollbackBuffer      Buffer to keep the value in.
+	 * @param[in,out] rollbackOffset  Offset in the buffer, set to the end of the kept record.
+	 * @return                        Return code.
+	 */
+	cs_ret_code_t backupRecord(
+			const state_record_header_t& recordHeader, uint8_t* rollbackBuffer, uint32_t& rollbackOffset);
+
+	/**
+	 * Set the kept values again, and remove the values that weren't stored.
+	 */
+	void rollbackImport(uint8_t* rollbackBuffer, uint32_t rollbackSize);
+
+	void clearImport();
+};
@@ -0,0 +1,128 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Index of the records in flash, sorted by record key, then by file id.
+ *
+ * Only one record is indexed per record key and file id. Since FDS always appends records, the last added record
+ * replaces an earlier one.
+ *
+ * RecordDesc is the record descriptor of FDS, it should have a record_id member.
+ * A template, so that the index can be tested without FDS.
+ *
+ * RAM: the entries are kept in a vector on the heap. On the nRF52, an entry takes 16 B (4 B for the keys, 12 B for the
+ * FDS descriptor). The vector doubles its capacity when it grows, so the index takes between 16 B and 32 B per
+ * record, see getHeapSize(). For example, 200 records take 3.2 kB to 6.4 kB of heap.
+ */
+template <class RecordDesc>
+class StorageIndex {
+public:
+	struct entry_t {
+		uint16_t recordKey;
+		uint16_t fileId;
+		RecordDesc recordDesc;
+	};
+
+	void clear() { _entries.clear(); }
+
+	uint16_t size() const { return _entries.size(); }
+
+	entry_t& operator[](uint16_t position) { return _entries[position]; }
+
+	/**
+	 * Get the position of the first entry with a record key and file id equal to or larger than the given ones.
+	 *
+	 * Binary search, as std::lower_bound would do.
+	 */
+	uint16_t getPosition(uint16_t recordKey, uint16_t fileId) const {
+		uint32_t key  = toKey(recordKey, fileId);
+		uint16_t low  = 0;
+		uint16_t high = _entries.size();
+		while (low < high) {
+			uint16_t middle = (low + high) / 2;
+			if (toKey(_entries[middle].recordKey, _entries[middle].fileId) < key) {
+				low = middle + 1;
+			}
+			else {
+				high = middle;
+			}
+		}
+		return low;
+	}
+
+	/**
+	 * Get the entry of given record key and file id, or nullptr when there is none.
+	 */
+	entry_t* find(uint16_t recordKey, uint16_t fileId) {
+		uint16_t position = getPosition(recordKey, fileId);
+		if (isAt(position, recordKey, fileId)) {
+			return &_entries[position];
+		}
+		return nullptr;
+	}
+
+	/**
+	 * Add a record, or replace the record with the same record key and file id.
+	 */
+	void add(uint16_t recordKey, uint16_t fileId, const RecordDesc& recordDesc) {
+		uint16_t position = getPosition(recordKey, fileId);
+		if (isAt(position, recordKey, fileId)) {
+			_entries[position].recordDesc = recordDesc;
+			return;
+		}
+		entry_t entry;
+		entry.recordKey  = recordKey;
+		entry.fileId     = fileId;
+		entry.recordDesc = recordDesc;
+		_entries.insert(_entries.begin() + position, entry);
+	}
+
+	/**
+	 * Remove a record, if it is the indexed record of its record key and file id.
+	 */
+	void remove(uint16_t recordKey, uint16_t fileId, uint32_t recordId) {
+		uint16_t position = getPosition(recordKey, fileId);
+		if (isAt(position, recordKey, fileId) && _entries[position].recordDesc.record_id == recordId) {
+			_entries.erase(_entries.begin() + position);
+		}
+	}
+
+	/**
+	 * Remove all records with given file id.
+	 */
+	void removeFile(uint16_t fileId) {
+		for (auto it = _entries.begin(); it != _entries.end();) {
+			if (it->fileId == fileId) {
+				it = _entries.erase(it);
+			}
+			else {
+				it++;
+			}
+		}
+	}
+
+	/**
+	 * Number of bytes the index allocated on the heap.
+	 */
+	size_t getHeapSize() const { return _entries.capacity() * sizeof(entry_t); }
+
+private:
+	std::vector<entry_t> _entries;
+
+	static uint32_t toKey(uint16_t recordKey, uint16_t fileId) {
+		return (static_cast<uint32_t>(recordKey) << 16) | fileId;
+	}
+
+	bool isAt(uint16_t position, uint16_t recordKey, uint16_t fileId) const {
+		return position < _entries.size() && _entries[position].recordKey == recordKey
+			   && _entries[position].fileId == fileId;
+	}
+};
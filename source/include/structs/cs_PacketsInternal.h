@@ -379,6 +379,8 @@ struct microapp_advertise_request_t {
 struct microapp_upload_internal_t {
 	microapp_upload_t header;
 	cs_data_t data;
+	// Whether the data is a chunk of a compressed binary, see LzDecompressor.
+	bool compressed = false;
 };
 
 struct microapp_message_internal_t {
@@ -0,0 +1,91 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Learns the current of the load at dimmer intensities, so that the current at a new intensity can be predicted.
+ *
+ * Measurements are kept in a small table, with a point per band of intensities.
+ * The current in between points is interpolated. Above the highest point, the current is extrapolated
+ * proportional to the intensity, which overestimates the current of typical (resistive and LED) loads.
+ */
+class DimmerLoadModel {
+public:
+	/**
+	 * Returned by predict() when nothing is known about the load at that intensity.
+	 */
+	static constexpr int32_t CURRENT_UNKNOWN = -1;
+
+	/**
+	 * Intensity range covered by a single point.
+	 */
+	static constexpr uint8_t BAND_SIZE       = 10;
+
+	static constexpr uint8_t POINT_COUNT     = 100 / BAND_SIZE + 1;
+
+	/**
+	 * Forget all measurements, for example when a different load is connected.
+	 */
+	void clear();
+
+	/**
+	 * Learn the current at an intensity.
+	 * Should only be called when the dimmer has settled at this intensity, and the relay is off.
+	 *
+	 * @param[in] intensity         Intensity of the dimmer: 1-100.
+	 * @param[in] currentMilliAmp   Measured RMS current.
+	 */
+	void learn(uint8_t intensity, int32_t currentMilliAmp);
+
+	/**
+	 * Predict the current at an intensity.
+	 *
+	 * @return The predicted RMS current in mA, or CURRENT_UNKNOWN.
+	 */
+	int32_t predict(uint8_t intensity) const;
+
+	/**
+	 * Get the step size with which the dimmer can fade to an intensity.
+	 *
+	 * The more headroom there is between the predicted current and the limit, the larger the steps,
+	 * so that the dimmer settles sooner. When the load is unknown, or close to the limit, minStepSize is used.
+	 *
+	 * @param[in] intensity         Intensity to fade to.
+	 * @param[in] limitMilliAmp     Max allowed current.
+	 * @param[in] minStepSize       Step size used when there's not much headroom.
+	 * @return                      Step size: minStepSize-100.
+	 */
+	uint8_t getStepSize(uint8_t intensity, int32_t limitMilliAmp, uint8_t minStepSize) const;
+
+private:
+	struct __attribute__((packed)) load_point_t {
+		/**
+		 * Intensity at which the current was measured, 0 when this point is not learned yet.
+		 */
+		uint8_t intensity        = 0;
+		uint16_t currentMilliAmp = 0;
+	};
+
+	load_point_t _points[POINT_COUNT];
+
+	/**
+	 * Discount of the exponential moving average, when the intensity was measured before: 1 / 2^AVERAGE_SHIFT.
+	 */
+	static constexpr uint8_t AVERAGE_SHIFT = 2;
+
+	/**
+	 * Get the index of the learned point with the highest intensity <= the given intensity, or -1.
+	 */
+	int8_t findPointBelow(uint8_t intensity) const;
+
+	/**
+	 * Get the index of the learned point with the lowest intensity >= the given intensity, or -1.
+	 */
+	int8_t findPointAbove(uint8_t intensity) const;
+};
@@ -9,7 +9,9 @@
 #include <common/cs_Types.h>
 #include <drivers/cs_Dimmer.h>
 #include <drivers/cs_Relay.h>
+#include <events/cs_CompatibilityTick.h>
 #include <events/cs_EventListener.h>
+#include <switch/cs_DimmerLoadModel.h>
 #include <third/std/function.h>
 
 /**
@@ -17,6 +19,7 @@
  * - Checks if dimmer circuit is powered.
  * - Handles hardware errors.
  * - Checks which hardware board can do what.
+ * - Predicts the current at a new dimmer intensity, to prevent triggering the softfuse.
  */
 class SafeSwitch : public EventListener {
 public:
@@ -49,6 +52,7 @@ public:
 	 *
 	 * @return     Error code: if not successful, check what the current state is.
 	 *             ERR_NOT_POWERED when the dimmer is not powered yet.
+	 *             ERR_UNSAFE when the predicted current at this intensity is too high for the dimmer.
 	 */
 	cs_ret_code_t setDimmer(uint8_t intensity, bool fade = true);
 
@@ -128,6 +132,26 @@ private:
 	 */
 	bool checkedDimmerPowerUsage    = false;
 
+	/**
+	 * Learned current of the load at dimmer intensities.
+	 */
+	DimmerLoadModel loadModel;
+
+	/**
+	 * Cached dimmer softfuse threshold.
+	 */
+	TYPIFY(CONFIG_SOFT_FUSE_CURRENT_THRESHOLD_DIMMER) dimmerCurrentThreshold;
+
+	/**
+	 * Counter that counts down from when the dimmer reached its intensity, until the current can be learned.
+	 */
+	uint32_t dimmerSettleCountDown  = DIMMER_LOAD_SETTLE_TIME_MS / TICK_INTERVAL_MS;
+
+	/**
+	 * Requested while one of the counters above has to count down.
+	 */
+	TickRequest tickRequest;
+
 	/**
 	 * Determines whether or not setDimmer and setRelay will have any effect.
 	 * (Will be set to false when GOING_TO_DFU event is set for example.)
@@ -219,6 +243,33 @@ private:
 
 	bool isSafeToDim(state_errors_t stateErrors);
 
+	/**
+	 * Max current that is allowed to be predicted at a dimmer intensity.
+	 */
+	int32_t getPredictedCurrentLimit();
+
+	/**
+	 * Whether the predicted current at the given intensity stays below the limit.
+	 * Returns true when the current can't be predicted yet.
+	 */
+	bool isPredictedSafeToDim(uint8_t intensity);
+
+	/**
+	 * Learn the load from a current measurement, if the dimmer has settled.
+	 * Turns the relay on instead of the dimmer, when the current gets close to the threshold.
+	 */
+	void handleCurrentMeasured(int32_t currentMilliAmp);
+
+	/**
+	 * Keep up whether the dimmer has settled.
+	 */
+	void updateDimmerSettled();
+
+	/**
+	 * Count down the counters, and release the tick request when there is nothing left to count down.
+	 */
+	void onTick();
+
 	bool isSafeToTurnRelayOn(state_errors_t stateErrors);
 
 	bool isSafeToTurnRelayOff(state_errors_t stateErrors);
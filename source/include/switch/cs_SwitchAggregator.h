@@ -14,6 +14,7 @@
 #include <structs/buffer/cs_CircularBuffer.h>
 #include <switch/cs_SmartSwitch.h>
 #include <test/cs_TestAccess.h>
+#include <util/cs_Coroutine.h>
 #include <optional>
 
 /**
@@ -61,8 +62,8 @@ private:
 	// Cache of previous time update.
 	uint32_t _lastTimestamp                     = 0;
 
-	//! Set on switchcraft event, then decremented each tick event until 0.
-	uint16_t _switchcraftDoubleTapCountdown     = 0;
+	//! Started on switchcraft event, a next switchcraft event is a double tap while it's started.
+	Coroutine _switchcraftDoubleTapRoutine;
 
 	//! Keeps up the switch value (1-100 from smart switch) of the last time it was on, before being turned off by
 	//! switchcraft.
@@ -75,7 +76,9 @@ private:
 	 * Unless that source overrules the current source.
 	 */
 	cmd_source_with_counter_t _source           = cmd_source_with_counter_t(CS_CMD_SOURCE_NONE);
-	uint32_t _ownerTimeoutCountdown             = 0;
+
+	//! The switch is claimed while started.
+	Coroutine _ownerTimeoutRoutine;
 
 	// Max number of switch commands to store in history.
 	const static uint8_t _maxSwitchHistoryItems = 10;
@@ -156,7 +159,7 @@ private:
 	uint8_t getStateIntentionSwitchcraft(uint8_t currentValue, bool doubleTap);
 
 	/**
-	 * EVT_TICK, STATE_TIME and EVT_TIME_SET events possibly trigger
+	 * EVT_TICK_SECOND, STATE_TIME and EVT_TIME_SET events possibly trigger
 	 * a new aggregated state. This handling function takes care of that.
 	 *
 	 * returns true when the event should be considered 'consumed'.
@@ -0,0 +1,127 @@
+/**
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Estimates the drift of the local clock with respect to the root clock.
+ *
+ * Each received root clock timestamp is stored together with the local time of reception.
+ * A linear regression over these samples gives the rate of the root clock relative to the local clock.
+ * This drift is then used to correct the local time that passed since the last synchronization.
+ *
+ * The regression averages out the jitter in message latency, so the estimate gets better with more samples,
+ * and with a larger time span between the samples.
+ */
+class ClockDriftEstimator {
+public:
+	/**
+	 * Number of samples to keep.
+	 */
+	static constexpr uint8_t SAMPLE_COUNT         = 8;
+
+	/**
+	 * Minimum number of samples before the drift is estimated.
+	 */
+	static constexpr uint8_t MIN_SAMPLE_COUNT     = 3;
+
+	/**
+	 * Minimum time span of the samples before the drift is estimated.
+	 */
+	static constexpr uint32_t MIN_SPAN_MS         = 10 * 60 * 1000;
+
+	/**
+	 * Drift is limited to this value, in parts per billion.
+	 *
+	 * Both the crystal and the calibrated RC oscillator should stay well within this.
+	 */
+	static constexpr int32_t MAX_DRIFT_PPB        = 1000 * 1000;
+
+	/**
+	 * When a sample deviates more than this from the expected root time,
+	 * the root clock is considered to have jumped, and all samples are discarded.
+	 */
+	static constexpr uint32_t MAX_DEVIATION_MS    = 5000;
+
+	/**
+	 * Discard all samples and the drift estimate.
+	 */
+	void reset();
+
+	/**
+	 * Add a sample.
+	 *
+	 * @param[in] localMs              Local time in ms, may overflow.
+	 * @param[in] rootMs               Time of the root clock in ms, at the same moment.
+	 */
+	void addSample(uint32_t localMs, uint64_t rootMs);
+
+	/**
+	 * Get the estimated drift in parts per billion: how much faster the root clock goes than the local clock.
+	 *
+	 * Returns 0 as long as there are not enough samples.
+	 */
+	int32_t getDriftPpb() const { return _driftPpb; }
+
+	/**
+	 * Get the number of samples.
+	 */
+	uint8_t getSampleCount() const { return _count; }
+
+	/**
+	 * Get the drift corrected time, for a given amount of local time passed since the last call to advance().
+	 *
+	 * Does not change the state, so it can be called often.
+	 */
+	uint32_t correct(uint32_t localMsPassed) const;
+
+	/**
+	 * Get the drift corrected time, for a given amount of local time passed since the last call to advance().
+	 *
+	 * Keeps up the sub millisecond part of the correction, so that it doesn't get lost when called often.
+	 */
+	uint32_t advance(uint32_t localMsPassed);
+
+	/**
+	 * To be called when the time is set, to discard the sub millisecond part of the correction.
+	 */
+	void clearRemainder() { _remainder = 0; }
+
+private:
+	struct sample_t {
+		uint32_t localMs;
+		uint64_t rootMs;
+	};
+
+	sample_t _samples[SAMPLE_COUNT];
+
+	/**
+	 * Number of stored samples.
+	 */
+	uint8_t _count     = 0;
+
+	/**
+	 * Index of the oldest sample.
+	 */
+	uint8_t _oldest    = 0;
+
+	int32_t _driftPpb  = 0;
+
+	/**
+	 * Sub millisecond part of the correction, in ms * 10^-9.
+	 */
+	int64_t _remainder = 0;
+
+	const sample_t& getSample(uint8_t index) const;
+
+	/**
+	 * Updates the drift estimate from the samples.
+	 */
+	void estimate();
+};
@@ -12,6 +12,7 @@
 #include <protocol/cs_Typedefs.h>
 #include <stdint.h>
 #include <test/cs_TestAccess.h>
+#include <time/cs_ClockDriftEstimator.h>
 #include <time/cs_Time.h>
 #include <time/cs_TimeOfDay.h>
 #include <time/cs_TimeSyncMessage.h>
@@ -45,6 +46,11 @@
  * For robustness, not only the root clock node, but all nodes will regularly send a time sync message.
  * It's up to the receiving node to device which clock is the root clock.
  * Not sure if this is necessary.
+ *
+ * Each node estimates the drift of its clock with respect to the root clock, from the received sync messages.
+ * The time between sync messages is corrected for this drift, so that the root clock can lengthen the period
+ * between sync messages. This period is sent along with the sync messages, so that all nodes use the same
+ * re-election timeout.
  */
 class SystemTime : public EventListener {
 	friend class TestAccess<SystemTime>;
@@ -116,6 +122,21 @@ public:
 	 */
 	static cs_ret_code_t setSunTimes(const sun_time_t& sunTimes, bool throttled = true);
 
+	/**
+	 * Restore the time that was handed over by the previous boot, on a warm boot.
+	 * Dispatches EVT_TIME_SET.
+	 *
+	 * Unlike setTime(), this doesn't claim to be root, nor is it sent to the mesh: the time of any sync message with
+	 * the same or a newer version is accepted.
+	 *
+	 * The duration of the reboot is added to the stamp: the time since the RTC started again, plus the estimated
+	 * duration of the bootloader, see WARM_BOOT_BOOTLOADER_DURATION_MS. So this should be called soon after boot,
+	 * before the RTC overflows.
+	 *
+	 * @param[in] stamp           The synchronized time stamp at the moment of reset.
+	 */
+	static void restoreTime(high_resolution_time_stamp_t stamp);
+
 private:
 	// ========================== Run time data and constants ============================
 	// state data
@@ -137,14 +158,17 @@ private:
 	// Sun time shouldn't differ more than 30 minutes.
 	static constexpr uint16_t THROTTLE_SET_SUN_TIMES_TICKS = (30 * 60 * 1000 / TICK_TIME_MS);
 
-	// timing features
-	static app_timer_t appTimerData;
-	static app_timer_id_t appTimerId;
+	// The tick may be delayed a bit, to be combined with other wake ups. Must keep the tick interval below 1 second.
+	static constexpr uint32_t TICK_ALLOWED_JITTER_MS       = 100;
 
-	static void scheduleNextTick();
+	/**
+	 * Calls tick() every TICK_TIME_MS.
+	 */
+	static Coroutine tickCoroutine;
 
 	/**
 	 * Must be called at least once per second to update upTimeSec.
+	 * Dispatches EVT_TICK_SECOND when upTimeSec increased, so that per second work doesn't need its own wake up.
 	 */
 	static void tick(void* unused);
 
@@ -158,14 +182,26 @@ private:
 	static constexpr uint32_t reboot_sync_timeout_ms();
 
 	/**
-	 * Time between sync messages from the root clock.
+	 * Base time between sync messages from the root clock.
 	 */
 	static constexpr uint32_t root_clock_update_period_ms();
 
 	/**
-	 * If no sync message has been received from the root clock for this time, a new root clock will be selected.
+	 * Max shift of the base time between sync messages.
+	 */
+	static constexpr uint8_t root_clock_max_period_shift();
+
+	/**
+	 * Time without sync message after which older firmware elects a new root clock.
+	 *
+	 * Older firmware doesn't use the period shift, so this is fixed.
 	 */
-	static constexpr uint32_t root_clock_reelection_timeout_ms();
+	static constexpr uint32_t root_clock_legacy_reelection_timeout_ms();
+
+	/**
+	 * Number of sync messages the root clock sends, before it doubles the period between sync messages.
+	 */
+	static constexpr uint8_t root_clock_sync_messages_per_period_step();
 
 	/**
 	 * Stone id to use for initialization.
@@ -216,6 +252,23 @@ private:
 	 */
 	static stone_id_t rootClockId;
 
+	/**
+	 * Drift of the local clock with respect to the root clock.
+	 */
+	static ClockDriftEstimator driftEstimator;
+
+	/**
+	 * Current period between sync messages, as shift of root_clock_update_period_ms().
+	 *
+	 * Determined by the root clock.
+	 */
+	static uint8_t syncPeriodShift;
+
+	/**
+	 * Number of sync messages sent by the root clock, since the last change of syncPeriodShift.
+	 */
+	static uint8_t syncMessagesSentAtPeriodShift;
+
 	static Coroutine syncTimeCoroutine;
 
 	// ------------------ Method definitions ------------------
@@ -224,6 +277,26 @@ private:
 
 	static uint8_t timeStampVersion();
 
+	/**
+	 * Time between sync messages from the root clock.
+	 */
+	static uint32_t rootClockUpdatePeriodMs();
+
+	/**
+	 * If no sync message has been received from the root clock for this time, a new root clock will be selected.
+	 */
+	static uint32_t rootClockReelectionTimeoutMs();
+
+	/**
+	 * Local time in ms, without any synchronization. Overflows every 49 days.
+	 */
+	static uint32_t uptimeMs(uint32_t rtcCount);
+
+	/**
+	 * Make this stone the root clock.
+	 */
+	static void becomeRootClock();
+
 	static void onTimeSyncMessageReceive(time_sync_message_t syncmessage);
 	static void setRootTimeStamp(high_resolution_time_stamp_t stamp, stone_id_t id, uint32_t rtcCount);
 
@@ -257,7 +330,7 @@ private:
 
 	/**
 	 * Returns true if onTimeSyncMessageReceive hasn't received any sync messages from a
-	 * clock authority in the last root_clock_reelection_timeout_ms milliseconds.
+	 * clock authority in the last rootClockReelectionTimeoutMs() milliseconds.
 	 */
 	static bool reelectionPeriodTimedOut();
 
@@ -25,5 +25,6 @@ struct __attribute__((__packed__)) high_resolution_time_stamp_t {
  */
 struct __attribute__((__packed__)) time_sync_message_t {
 	high_resolution_time_stamp_t stamp;
-	stone_id_t srcId;  // The stone ID of this time. Set to 0 to force using this timestamp.
+	stone_id_t srcId;         // The stone ID of this time. Set to 0 to force using this timestamp.
+	uint8_t periodShift = 0;  // Period between sync messages of the root clock, as shift of the base period.
 };
@@ -24,8 +24,11 @@ struct __attribute__((packed)) TrackedDevice {
 
 	// Bitmask to keep up which fields are set, with TrackedDeviceFields as bits.
 	uint8_t fieldsSet = 0;
-	uint8_t locationIdTTLMinutes;
-	uint8_t heartbeatTTLMinutes;
+
+	/**
+	 * The TTLs of the device, location and heartbeat are kept in TrackedDevices.
+	 * The TTL in the data is the value it was set to.
+	 */
 	internal_register_tracked_device_packet_t data;
 
 	device_id_t id();
@@ -37,7 +40,7 @@ struct __attribute__((packed)) TrackedDevice {
 	bool allFieldsSet();
 
 	void setAccessLevel(uint8_t accessLevel);
-	void setLocation(uint8_t locationId, uint8_t timeoutMinutes);
+	void setLocation(uint8_t locationId);
 	void setProfile(uint8_t profileId);
 	void setRssiOffset(int8_t rssiOffset);
 	void setFlags(uint8_t flags);
@@ -9,6 +9,7 @@
 #include <events/cs_EventListener.h>
 #include <tracking/cs_TrackedDevice.h>
 #include <util/cs_Store.h>
+#include <util/cs_TimingWheel.h>
 
 #include <cstdint>
 
@@ -58,11 +59,9 @@ public:
 	static const uint16_t HEARTBEAT_TTL_MINUTES_MAX = 60;
 
 private:
-	static const uint16_t TICKS_PER_SECOND  = (1000 / TICK_INTERVAL_MS);
-	static const uint16_t TICKS_PER_MINUTES = (60 * 1000 / TICK_INTERVAL_MS);
+	static const uint8_t SECONDS_PER_MINUTE = 60;
 
-	uint16_t ticksLeftSecond                = TICKS_PER_SECOND;
-	uint16_t ticksLeftMinute                = TICKS_PER_MINUTES;
+	uint8_t secondsLeftMinute               = SECONDS_PER_MINUTE;
 
 	/**
 	 * List of all tracked devices.
@@ -71,6 +70,14 @@ private:
 	 */
 	Store<TrackedDevice, MAX_TRACKED_DEVICES> _store;
 
+	/**
+	 * TTLs of the devices, ticks every minute.
+	 * The timer index is the index of the device in the store for the device TTL,
+	 * MAX_TRACKED_DEVICES plus that index for the location TTL,
+	 * and 2 * MAX_TRACKED_DEVICES plus that index for the heartbeat TTL.
+	 */
+	TimingWheel<3 * MAX_TRACKED_DEVICES> _timeouts;
+
 	/**
 	 * Whether there has been a successful sync of tracked devices.
 	 *
@@ -114,6 +121,31 @@ private:
 	 */
 	TrackedDevice* add();
 
+	/**
+	 * Returns the index of a device in the store.
+	 */
+	uint8_t getIndex(TrackedDevice& device);
+
+	/**
+	 * Set the TTL of the device.
+	 */
+	void setTTL(TrackedDevice& device, uint16_t ttlMinutes);
+
+	/**
+	 * Returns the number of minutes until the device times out.
+	 */
+	uint16_t getTTLMinutes(TrackedDevice& device);
+
+	/**
+	 * Set the location of the device, which is reset to 0 after the given number of minutes.
+	 */
+	void setLocation(TrackedDevice& device, uint8_t locationId, uint8_t ttlMinutes);
+
+	/**
+	 * Returns whether the heartbeat of the device hasn't timed out.
+	 */
+	bool hasHeartbeat(TrackedDevice& device);
+
 	cs_ret_code_t handleRegister(internal_register_tracked_device_packet_t& packet);
 	cs_ret_code_t handleUpdate(internal_update_tracked_device_packet_t& packet);
 	void handleMeshRegister(TYPIFY(EVT_MESH_TRACKED_DEVICE_REGISTER) & packet);
@@ -139,9 +171,9 @@ private:
 	/**
 	 * A minute has passed.
 	 *
-	 * Decrease TTL of all devices by 1.
-	 * Decrease location timeout of all device by 1.
-	 * Decrease heartbeat TTL.
+	 * Invalidate the devices of which the TTL expired.
+	 * Reset the location of the devices of which the location TTL expired.
+	 * Heartbeat TTLs simply expire.
 	 */
 	void tickMinute();
 
@@ -9,6 +9,7 @@
 
 #include <events/cs_EventListener.h>
 #include <protocol/cs_UartProtocol.h>
+#include <util/cs_Coroutine.h>
 
 /**
  * Class that:
@@ -121,10 +122,10 @@ private:
 	bool _isConnectionEncrypted          = false;
 
 	/**
-	 * Timeout (in tick events) set by heartbeat.
-	 * When this reaches 0, consider the connection te be dead.
+	 * Started with the timeout set by heartbeat.
+	 * When it runs, consider the connection te be dead.
 	 */
-	uint32_t _connectionTimeoutCountdown = 0;
+	Coroutine _connectionTimeoutRoutine;
 
 	/**
 	 * Session nonce used to decrypt incoming uart msgs.
@@ -142,12 +143,14 @@ private:
 	bool _sessionNonceValid                = false;
 
 	/**
-	 * Timeout (in tick events) set by the received session nonce.
-	 * When this reaches 0, consider the RX and TX session nonce to be invalid.
+	 * Started with the timeout set by the received session nonce.
+	 * When it runs, consider the RX and TX session nonce to be invalid.
 	 */
-	uint32_t _sessionNonceTimeoutCountdown = 0;
+	Coroutine _sessionNonceTimeoutRoutine;
 
-	void onTick();
+	void onConnectionTimeout();
+
+	void onSessionNonceTimeout();
 
 	void handleEvent(event_t& event);
 };
@@ -15,7 +15,7 @@
 #define UART_RX_BUFFER_SIZE 192
 #define UART_TX_BUFFER_SIZE 300
 #define UART_TX_ENCRYPTION_BUFFER_SIZE AES_BLOCK_SIZE
-//#define UART_TX_MAX_PAYLOAD_SIZE       500
+#define UART_TX_MAX_PAYLOAD_SIZE UART_TX_BUFFER_SIZE
 
 /**
  * Class that implements the binary UART protocol.
@@ -66,8 +66,10 @@ public:
 	 * Must be followed by 1 or more writeMsgPart(), followed by 1 writeMsgEnd().
 	 *
 	 * @param[in] opCode     OpCode of the msg.
-	 * @param[in] size       Size of the msg.
+	 * @param[in] size       Size of the msg, at most UART_TX_MAX_PAYLOAD_SIZE.
 	 * @param[in] encrypt    How to encrypt the msg.
+	 *
+	 * @return ERR_WRONG_PAYLOAD_LENGTH  When the msg is too large, nothing is written then.
 	 */
 	ret_code_t writeMsgStart(
 			UartOpcodeTx opCode,
@@ -6,31 +6,25 @@
  */
 #pragma once
 
-#include <drivers/cs_RTC.h>
-#include <drivers/cs_Timer.h>
-
+#include <cstdint>
 #include <functional>
 
-// coroutines
-// note: coroutine is currently built upon the event buss tickrate
-// which is set to about 10 ticks/s. (wishlist: use SystemTime instead.)
-
 /**
- * A coroutine essentially is a throttling mechanism: it takes
- * in a tick-event or tick count and executes its action when the
- * time (number of ticks) passed between the last call and the
- * current one is larger than the time the action reported the next
- * call needed to wait.
+ * A coroutine essentially is a throttling mechanism: it executes its action,
+ * and the value the action returns is the time to wait before the action is executed again.
+ *
+ * Coroutines are run by the CoroutineScheduler, which wakes up at the deadline of the first coroutine.
+ * So the owner of a coroutine doesn't have to listen for tick events.
  *
  * Example:
- *  uint32_t sayHi() { LOGd("hi"); return 42; }
- *	Coroutine hiSayer (sayHi);
+ *  uint32_t sayHi() { LOGd("hi"); return Coroutine::delayS(42); }
+ *	Coroutine hiSayer(sayHi);
+ *	hiSayer.start();
  *
- *	for (int i = 0; ; i++){
- *		hiSayer.onTick(i);
- *	}
+ * This will log "hi" once every 42 seconds.
  *
- * This will log "hi" only one in 42 calls.
+ * Work that doesn't have to be executed at an exact time should set an allowed jitter,
+ * so that the chip can wake up less often.
  *
  * Note that the return value of sayHi determines the delay, so that
  * a coroutine can dynamically determine if it needs to be called more
@@ -38,45 +32,56 @@
  *
  */
 class Coroutine {
-private:
-	uint32_t nextCallTickcount = 0;
-
 public:
 	typedef std::function<uint32_t(void)> Action;
 
-	// void function that returns the amount of tick events before it should be called again.
+	// function that returns the number of ms before it should be called again.
 	Action action;
 
+	/**
+	 * Time the action may be executed later than its deadline.
+	 * This allows the scheduler to execute it together with other coroutines, in a single wake up.
+	 */
+	uint32_t allowedJitterMs = 0;
+
 	Coroutine() = default;
-	Coroutine(Action a) : action(a) {}
+	Coroutine(Action a, uint32_t jitterMs = 0) : action(a), allowedJitterMs(jitterMs) {}
+	~Coroutine() { stop(); }
+
+	// The scheduler keeps a pointer to the coroutine.
+	Coroutine(const Coroutine&)            = delete;
+	Coroutine& operator=(const Coroutine&) = delete;
 
 	/**
-	 * To be called on tick event.
+	 * Execute the action after the given delay, and from then on with the delays the action returns.
+	 * When already started, the next execution is rescheduled.
 	 */
-	void onTick(uint32_t currentTickCount) {
-		// TODO: not doing roll-over checks here yet..
-		if (currentTickCount >= nextCallTickcount && action) {
-			auto ticksToWait  = action();
-			nextCallTickcount = currentTickCount + ticksToWait;
-		}
-	}
+	void start(uint32_t delayMs = 0);
 
 	/**
-	 * Convenience function replacing onTick().
-	 *
-	 * To be called on event.
+	 * Stop executing the action. May be called from the action itself.
 	 */
-	bool handleEvent(event_t& evt) {
-		if (evt.type == CS_TYPE::EVT_TICK) {
-			this->onTick(*reinterpret_cast<TYPIFY(EVT_TICK)*>(evt.data));
-			return true;
-		}
-		return false;
-	}
+	void stop();
 
-	uint32_t getNextCallTickCount() const { return nextCallTickcount; }
+	bool isStarted() const { return _heapIndex != NOT_SCHEDULED; }
 
-	static uint32_t delayMs(uint32_t ms) { return ms / TICK_INTERVAL_MS; }
+	static uint32_t delayMs(uint32_t ms) { return ms; }
 
 	static uint32_t delayS(uint32_t s) { return delayMs(s * 1000); }
+
+private:
+	friend class CoroutineScheduler;
+
+	static constexpr uint8_t NOT_SCHEDULED = 0xFF;
+	static constexpr uint8_t RUNNING       = 0xFE;
+
+	/**
+	 * Deadline in RTC ticks, relative to the clock of the scheduler.
+	 */
+	uint32_t _deadline                     = 0;
+
+	/**
+	 * Index in the heap of the scheduler, or NOT_SCHEDULED, or RUNNING while the action is executed.
+	 */
+	uint8_t _heapIndex                     = NOT_SCHEDULED;
 };
@@ -0,0 +1,151 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <drivers/cs_RTC.h>
+#include <drivers/cs_Timer.h>
+#include <test/cs_TestAccess.h>
+#include <util/cs_Coroutine.h>
+
+/**
+ * Runs the started coroutines at their deadline.
+ *
+ * Keeps up a min-heap of coroutine deadlines in RTC ticks, and a single shot app timer
+ * that is armed for the earliest deadline. So the chip doesn't have to wake up
+ * for coroutines that are not due, and delays have a resolution of an RTC tick.
+ *
+ * Coroutines with an allowed jitter are coalesced: the timer is armed for the earliest deadline plus jitter,
+ * and on wake up, all coroutines of which the deadline has passed are executed.
+ *
+ * The next deadline of a coroutine is counted from its previous deadline, so running late doesn't make it drift.
+ * To keep periodic coroutines in phase, the first deadline of a coroutine with an allowed jitter is rounded up
+ * to a multiple of the largest power of 2 number of ticks within that jitter.
+ *
+ * The RTC counter overflows every 512 seconds, so the scheduler keeps up its own 32 bit clock in RTC ticks,
+ * which it updates at least every half RTC overflow period. Deadlines are compared with roll-over of that clock.
+ */
+class CoroutineScheduler {
+	friend class TestAccess<CoroutineScheduler>;
+
+public:
+	static CoroutineScheduler& getInstance();
+
+	/**
+	 * Schedule a coroutine to be executed after a delay.
+	 * When already scheduled, the coroutine is rescheduled.
+	 */
+	void schedule(Coroutine& coroutine, uint32_t delayMs);
+
+	/**
+	 * Remove a coroutine from the schedule.
+	 */
+	void cancel(Coroutine& coroutine);
+
+	/**
+	 * Number of times the scheduler woke up to execute coroutines.
+	 */
+	uint32_t getWakeUpCount() const { return _wakeUpCount; }
+
+private:
+	CoroutineScheduler()                          = default;
+	CoroutineScheduler(CoroutineScheduler const&) = delete;
+	void operator=(CoroutineScheduler const&)     = delete;
+
+	/**
+	 * Max number of coroutines that can be started at the same time.
+	 */
+	static constexpr uint8_t MAX_COROUTINES       = 32;
+
+	/**
+	 * Max number of ticks to arm the timer for, so that the clock is updated before the RTC counter overflows.
+	 */
+	static constexpr uint32_t MAX_TIMER_TICKS     = MAX_RTC_COUNTER_VAL / 2;
+
+	/**
+	 * Max delay and max jitter, so that deadlines plus jitter can be compared with roll-over.
+	 */
+	static constexpr uint32_t MAX_DELAY_TICKS     = 0x3FFFFFFF;
+
+	static app_timer_t _appTimerData;
+	static app_timer_id_t _appTimerId;
+
+	bool _initialized                = false;
+
+	/**
+	 * Whether coroutines are being executed: the timer is armed once they are all done.
+	 */
+	bool _running                    = false;
+
+	/**
+	 * Number of RTC ticks passed since init.
+	 */
+	uint32_t _nowTicks               = 0;
+	uint32_t _rtcCountOfLastUpdate   = 0;
+
+	/**
+	 * Min-heap of scheduled coroutines, ordered by deadline.
+	 */
+	Coroutine* _heap[MAX_COROUTINES] = {};
+	uint8_t _heapSize                = 0;
+
+	uint32_t _wakeUpCount            = 0;
+
+	void init();
+
+	/**
+	 * Advance the clock with the RTC ticks passed since the last update.
+	 */
+	void updateNow();
+
+	/**
+	 * Execute all coroutines that are due, then arm the timer for the next deadline.
+	 */
+	void run();
+
+	/**
+	 * Set the deadline of a coroutine to a delay after the given clock value, and put it in the heap.
+	 * A deadline that has already passed is set to the delay after now instead.
+	 */
+	void setDeadline(Coroutine& coroutine, uint32_t fromTicks, uint32_t delayMs);
+
+	void startTimer();
+
+	/**
+	 * Returns the number of ticks from now until the first deadline, 0 when it's due.
+	 * The heap must not be empty.
+	 */
+	uint32_t ticksUntilFirstDeadline();
+
+	/**
+	 * Returns the number of ticks from now until the timer has to wake up:
+	 * the earliest deadline plus allowed jitter. The heap must not be empty.
+	 */
+	uint32_t ticksUntilWakeUp();
+
+	/**
+	 * Returns the given clock value, rounded up to a multiple of the largest power of 2 number of ticks within
+	 * the allowed jitter.
+	 */
+	static uint32_t alignToJitter(uint32_t ticks, uint32_t allowedJitterMs);
+
+	static void onTimeout(void* p_context);
+
+	/**
+	 * Whether tick count a is before b, taking roll-over into account.
+	 */
+	static bool isBefore(uint32_t a, uint32_t b) { return static_cast<int32_t>(a - b) < 0; }
+
+	/**
+	 * Converts ms to RTC ticks, rounded to the nearest tick, limited to MAX_DELAY_TICKS.
+	 */
+	static uint32_t msToTicks(uint32_t ms);
+
+	void setHeapEntry(uint8_t index, Coroutine* coroutine);
+	void siftUp(uint8_t index);
+	void siftDown(uint8_t index);
+	void removeFromHeap(uint8_t index);
+};
@@ -41,6 +41,16 @@
  */
 uint32_t Fletcher(const uint8_t* const data, const size_t len, uint32_t previousFletcherHash = 0);
 
+/**
+ * Combines Fletcher32 hashes of separately hashed data chunks.
+ *
+ * Given fletcherHash = Fletcher(data, len), this returns Fletcher(data, len, previousFletcherHash),
+ * without the need to go over the data again.
+ *
+ * The same padding rules as for Fletcher(...) apply: len is rounded up to a multiple of 2.
+ */
+uint32_t FletcherCombine(uint32_t previousFletcherHash, uint32_t fletcherHash, const size_t len);
+
 /**
  * @brief Calculates a djb2 hash of given data.
  *
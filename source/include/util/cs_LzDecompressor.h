@@ -0,0 +1,119 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <protocol/cs_ErrorCodes.h>
+#include <protocol/cs_Typedefs.h>
+
+#include <cstdint>
+
+/**
+ * Format of the compressed data: a sequence of tokens, each starting with a token byte.
+ *
+ * Token byte 0 - 127:   literal run. Followed by (token + 1) literal bytes.
+ * Token byte 128 - 255: match. Followed by the distance as uint16, little endian. Copies
+ *                       (token - 128 + LZ_MIN_MATCH_LENGTH) bytes, starting at distance bytes back in the output.
+ *                       Distance 0 is invalid. The match may overlap with the bytes it produces.
+ */
+constexpr uint8_t LZ_MATCH_FLAG          = 0x80;
+constexpr uint16_t LZ_MAX_LITERAL_LENGTH = 128;
+constexpr uint16_t LZ_MIN_MATCH_LENGTH   = 3;
+constexpr uint16_t LZ_MAX_MATCH_LENGTH   = 127 + LZ_MIN_MATCH_LENGTH;
+constexpr uint32_t LZ_MAX_MATCH_DISTANCE = 0xFFFF;
+
+/**
+ * Decompresses data, with a fixed and small amount of RAM.
+ *
+ * Decompression can be paused and resumed at any byte: the input can be given in parts, and decompression stops when
+ * the output buffer is full. The user then flushes the output buffer, for example by writing it to flash, after which
+ * decompression can continue.
+ *
+ * Instead of a window of recent output, matches are copied from the flushed output, so the flushed output has to
+ * stay readable. This is the case for flash, which is memory mapped.
+ */
+class LzDecompressor {
+public:
+	/**
+	 * Start decompressing a new stream.
+	 *
+	 * @param[in] flushedOutput   Where the flushed output can be read back.
+	 * @param[in] buffer          Buffer for the output, that has to be flushed when full.
+	 * @param[in] bufferSize      Size of the buffer.
+	 */
+	void init(const uint8_t* flushedOutput, uint8_t* buffer, uint16_t bufferSize);
+
+	/**
+	 * Decompress (a part of) the input.
+	 *
+	 * @param[in] input           Compressed data.
+	 * @param[in] inputSize       Size of the compressed data.
+	 * @param[out] consumedSize   How many bytes of the input have been decompressed.
+	 *
+	 * @return ERR_SUCCESS                  All input has been decompressed.
+	 * @return ERR_BUFFER_TOO_SMALL         The output buffer is full. Flush it, then call again with the remaining
+	 *                                      input.
+	 * @return ERR_INVALID_MESSAGE          A match refers to data before the start of the output.
+	 */
+	cs_ret_code_t decompress(const uint8_t* input, uint16_t inputSize, uint16_t& consumedSize);
+
+	/**
+	 * To be called when the output buffer has been flushed.
+	 */
+	void onBufferFlushed();
+
+	bool isBufferFull() const { return _bufferedSize == _bufferSize; }
+
+	/**
+	 * Size of the output in the buffer, that has not been flushed yet.
+	 */
+	uint16_t getBufferedSize() const { return _bufferedSize; }
+
+	/**
+	 * Size of the output that has been flushed.
+	 */
+	uint32_t getFlushedSize() const { return _flushedSize; }
+
+	/**
+	 * Total size of the output so far.
+	 */
+	uint32_t getOutputSize() const { return _flushedSize + _bufferedSize; }
+
+	/**
+	 * Whether the input ended in the middle of a token.
+	 */
+	bool isInToken() const { return _state != STATE_TOKEN; }
+
+private:
+	enum State : uint8_t {
+		STATE_TOKEN,
+		STATE_LITERAL,
+		STATE_DISTANCE_LOW,
+		STATE_DISTANCE_HIGH,
+		STATE_MATCH,
+	};
+
+	const uint8_t* _flushedOutput = nullptr;
+	uint8_t* _buffer              = nullptr;
+	uint16_t _bufferSize          = 0;
+	uint16_t _bufferedSize        = 0;
+	uint32_t _flushedSize         = 0;
+
+	State _state                  = STATE_TOKEN;
+
+	/**
+	 * Number of bytes left to output of the current literal run or match.
+	 */
+	uint16_t _remaining           = 0;
+
+	uint16_t _distance            = 0;
+
+	/**
+	 * Get a byte of the output, either from the flushed output, or from the buffer.
+	 */
+	uint8_t getOutput(uint32_t position) const;
+};
@@ -0,0 +1,212 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Hierarchical timing wheel: keeps up the deadlines of a fixed number of timers.
+ *
+ * Instead of decrementing a countdown in every record each tick, a component schedules a timer per record,
+ * and calls tick() at a regular interval. A tick only touches the timers that expire, and every
+ * 2^SlotBits ticks, the timers of one slot of a higher level, which are moved to a lower level.
+ * Scheduling and cancelling a timer takes constant time.
+ *
+ * Timers are identified by index, typically the index of the record in the store of the component.
+ * Deadlines further away than the range of the wheel (2^(SlotBits * Levels) ticks) are supported,
+ * they are moved around in the highest level until they are in range.
+ *
+ * @tparam TimerCount   Number of timers. Must be smaller than 0xFF.
+ * @tparam SlotBits     Number of bits of the slot index per level.
+ * @tparam Levels       Number of levels.
+ */
+template <uint8_t TimerCount, uint8_t SlotBits = 4, uint8_t Levels = 3>
+class TimingWheel {
+public:
+	static_assert(TimerCount < 0xFF, "Index 0xFF is used as invalid timer index");
+	static_assert(Levels > 0 && (Levels << SlotBits) < 0xFF, "Slot 0xFF is used as invalid slot");
+
+	TimingWheel() { clear(); }
+
+	/**
+	 * Cancel all timers.
+	 */
+	void clear() {
+		for (auto& head : _heads) {
+			head = NONE;
+		}
+		for (auto& timer : _timers) {
+			timer.slot = NONE;
+		}
+	}
+
+	/**
+	 * Number of ticks since construction.
+	 */
+	uint32_t now() const { return _now; }
+
+	/**
+	 * Schedule a timer to expire after a number of ticks.
+	 * When the timer was already scheduled, it is rescheduled.
+	 *
+	 * @param[in] index        Index of the timer.
+	 * @param[in] delayTicks   Number of ticks after which the timer expires, a delay of 0 is handled as 1.
+	 */
+	void schedule(uint8_t index, uint32_t delayTicks) {
+		cancel(index);
+		_timers[index].deadline = _now + (delayTicks == 0 ? 1 : delayTicks);
+		insert(index);
+	}
+
+	/**
+	 * Cancel a timer. Does nothing when the timer is not scheduled.
+	 */
+	void cancel(uint8_t index) {
+		if (isScheduled(index)) {
+			unlink(index);
+		}
+	}
+
+	bool isScheduled(uint8_t index) const { return _timers[index].slot != NONE; }
+
+	/**
+	 * Whether no timer is scheduled. The wheel doesn't have to be ticked then.
+	 */
+	bool isEmpty() const {
+		for (auto head : _heads) {
+			if (head != NONE) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Returns the number of ticks until the timer expires, or 0 when it's not scheduled.
+	 */
+	uint32_t remaining(uint8_t index) const { return isScheduled(index) ? _timers[index].deadline - _now : 0; }
+
+	/**
+	 * Advance the wheel by 1 tick, and call onExpire(index) for each timer that expires.
+	 *
+	 * The expired timer is no longer scheduled when onExpire is called,
+	 * onExpire may schedule or cancel any timer.
+	 */
+	template <class ExpireFunction>
+	void tick(ExpireFunction onExpire) {
+		_now++;
+
+		// Move timers of higher levels down, highest level first, so that they can end up in the current slot.
+		for (uint8_t level = Levels - 1; level > 0; --level) {
+			if ((_now & ((1u << (SlotBits * level)) - 1)) == 0) {
+				cascade(getSlot(level, _now));
+			}
+		}
+
+		uint8_t slot = getSlot(0, _now);
+		while (_heads[slot] != NONE) {
+			uint8_t index = _heads[slot];
+			unlink(index);
+			if (_timers[index].deadline != _now) {
+				// Deadline beyond the range of the wheel.
+				insert(index);
+				continue;
+			}
+			onExpire(index);
+		}
+	}
+
+private:
+	static constexpr uint8_t NONE       = 0xFF;
+	static constexpr uint8_t SLOT_COUNT = 1 << SlotBits;
+	static constexpr uint8_t SLOT_MASK  = SLOT_COUNT - 1;
+
+	struct wheel_timer_t {
+		uint32_t deadline;
+		uint8_t next;
+		uint8_t prev;
+		/**
+		 * Slot (level * SLOT_COUNT + slot index) this timer is in, NONE when not scheduled.
+		 */
+		uint8_t slot;
+	};
+
+	wheel_timer_t _timers[TimerCount];
+
+	/**
+	 * Index of the first timer in each slot.
+	 */
+	uint8_t _heads[Levels * SLOT_COUNT];
+
+	uint32_t _now = 0;
+
+	static uint8_t getSlot(uint8_t level, uint32_t ticks) {
+		return level * SLOT_COUNT + ((ticks >> (SlotBits * level)) & SLOT_MASK);
+	}
+
+	/**
+	 * Whether the ticks differ in any bit at or above the given bit.
+	 */
+	static bool differsFromBit(uint32_t ticksA, uint32_t ticksB, uint8_t bit) {
+		return bit < 32 && ((ticksA ^ ticksB) >> bit) != 0;
+	}
+
+	/**
+	 * Put a timer in the lowest level at which its deadline is in the same rotation as now.
+	 */
+	void insert(uint8_t index) {
+		uint32_t deadline = _timers[index].deadline;
+		uint8_t level     = 0;
+		while (level < Levels - 1 && differsFromBit(deadline, _now, SlotBits * (level + 1))) {
+			level++;
+		}
+		if (differsFromBit(deadline, _now, SlotBits * Levels) && ((deadline - _now) >> (SlotBits * Levels)) != 0) {
+			// Out of range: put it in the slot of the highest level that is reached last.
+			link(index, level * SLOT_COUNT + ((getSlot(level, _now) - 1) & SLOT_MASK));
+			return;
+		}
+		// The deadline may be in the next rotation of the highest level: that slot is reached in time as well.
+		link(index, getSlot(level, deadline));
+	}
+
+	void cascade(uint8_t slot) {
+		uint8_t index = _heads[slot];
+		_heads[slot]  = NONE;
+		while (index != NONE) {
+			uint8_t next        = _timers[index].next;
+			_timers[index].slot = NONE;
+			insert(index);
+			index = next;
+		}
+	}
+
+	void link(uint8_t index, uint8_t slot) {
+		wheel_timer_t& timer = _timers[index];
+		timer.slot           = slot;
+		timer.prev           = NONE;
+		timer.next           = _heads[slot];
+		if (timer.next != NONE) {
+			_timers[timer.next].prev = index;
+		}
+		_heads[slot] = index;
+	}
+
+	void unlink(uint8_t index) {
+		wheel_timer_t& timer = _timers[index];
+		if (timer.prev != NONE) {
+			_timers[timer.prev].next = timer.next;
+		}
+		else {
+			_heads[timer.slot] = timer.next;
+		}
+		if (timer.next != NONE) {
+			_timers[timer.next].prev = timer.prev;
+		}
+		timer.slot = NONE;
+	}
+};
@@ -82,19 +82,20 @@ inline void print_stack([[maybe_unused]] const std::string& msg) {
 	LOGd("%s %p", msg.c_str(), (uint8_t*)sp);
 }
 
+// The bit is shifted as T, so that these also work for bits above 31 of a 64 bit value.
 template <typename T>
 inline bool isBitSet(const T value, uint8_t bit) {
-	return value & (1 << bit);
+	return value & (static_cast<T>(1) << bit);
 }
 
 template <typename T>
 inline bool setBit(T& value, uint8_t bit) {
-	return value |= (1 << bit);
+	return value |= (static_cast<T>(1) << bit);
 }
 
 template <typename T>
 inline bool clearBit(T& value, uint8_t bit) {
-	return value &= ~(1 << bit);
+	return value &= ~(static_cast<T>(1) << bit);
 }
 
 /**
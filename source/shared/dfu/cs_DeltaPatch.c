@@ -0,0 +1,152 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <dfu/cs_DeltaPatch.h>
+#include <string.h>
+
+/**
+ * Read a varint from the patch.
+ *
+ * @return false when the varint doesn't fit in the patch, or is too large.
+ */
+static bool readVarint(cs_delta_patch_t* state, uint32_t* value) {
+	*value = 0;
+	for (uint8_t shift = 0; shift < 32; shift += 7) {
+		if (state->patchOffset >= state->patchSize) {
+			return false;
+		}
+		uint8_t byte = state->patch[state->patchOffset++];
+		*value |= (uint32_t)(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Get the index of the target page that is produced as given output page.
+ */
+static uint32_t getTargetPageIndex(const cs_delta_patch_t* state, uint32_t outputPageIndex) {
+	if (state->header.flags & CS_DELTA_PATCH_FLAG_BACKWARD) {
+		return state->pageCount - 1 - outputPageIndex;
+	}
+	return outputPageIndex;
+}
+
+/**
+ * Check whether the base image data can still be read, when the given target page is being produced.
+ */
+static bool isBaseAvailable(const cs_delta_patch_t* state, uint32_t targetPageIndex, uint32_t offset, uint32_t size) {
+	if (offset > state->header.baseSize || size > state->header.baseSize - offset) {
+		return false;
+	}
+	uint32_t pageStart = targetPageIndex * state->header.pageSize;
+	if (state->header.flags & CS_DELTA_PATCH_FLAG_BACKWARD) {
+		// Later pages have been overwritten already.
+		return offset + size <= pageStart + state->header.pageSize;
+	}
+	// Earlier pages have been overwritten already.
+	return offset >= pageStart;
+}
+
+enum DeltaPatchRetCode deltaPatchInit(
+		cs_delta_patch_t* state, const uint8_t* patch, uint32_t patchSize, const uint8_t* base, uint16_t pageSize) {
+	memset(state, 0, sizeof(*state));
+	if (patchSize < sizeof(cs_delta_patch_header_t)) {
+		return DELTA_PATCH_INVALID_HEADER;
+	}
+	memcpy(&state->header, patch, sizeof(state->header));
+	if (state->header.magic != CS_DELTA_PATCH_MAGIC || state->header.version != CS_DELTA_PATCH_VERSION
+		|| state->header.pageSize != pageSize || pageSize == 0) {
+		return DELTA_PATCH_INVALID_HEADER;
+	}
+	state->patch       = patch;
+	state->patchSize   = patchSize;
+	state->base        = base;
+	state->pageCount   = (state->header.targetSize + pageSize - 1) / pageSize;
+	state->patchOffset = sizeof(cs_delta_patch_header_t);
+	return DELTA_PATCH_SUCCESS;
+}
+
+enum DeltaPatchRetCode deltaPatchVerifyBase(const cs_delta_patch_t* state, uint32_t baseSize) {
+	if (baseSize != state->header.baseSize
+		|| deltaPatchCrc32(state->base, baseSize, 0) != state->header.baseCrc) {
+		return DELTA_PATCH_BASE_MISMATCH;
+	}
+	return DELTA_PATCH_SUCCESS;
+}
+
+enum DeltaPatchRetCode deltaPatchNextPage(
+		cs_delta_patch_t* state, uint8_t* buffer, uint32_t* targetOffset, uint32_t* size) {
+	if (state->outputPageCount >= state->pageCount) {
+		return DELTA_PATCH_DONE;
+	}
+	uint32_t targetPageIndex = getTargetPageIndex(state, state->outputPageCount);
+	uint32_t pageStart       = targetPageIndex * state->header.pageSize;
+	uint32_t pageSize        = state->header.pageSize;
+	if (state->header.targetSize - pageStart < pageSize) {
+		pageSize = state->header.targetSize - pageStart;
+	}
+
+	uint32_t bufferedSize = 0;
+	while (bufferedSize < pageSize) {
+		if (state->patchOffset >= state->patchSize) {
+			return DELTA_PATCH_INVALID_DATA;
+		}
+		uint8_t token = state->patch[state->patchOffset++];
+		if (token & CS_DELTA_PATCH_TOKEN_COPY) {
+			uint32_t length = (token & ~CS_DELTA_PATCH_TOKEN_COPY) + 1;
+			uint32_t value  = 0;
+			if (length == CS_DELTA_PATCH_MAX_LITERAL_LENGTH) {
+				if (!readVarint(state, &value)) {
+					return DELTA_PATCH_INVALID_DATA;
+				}
+				length += value;
+			}
+			if (!readVarint(state, &value)) {
+				return DELTA_PATCH_INVALID_DATA;
+			}
+			// Zigzag decoding.
+			int32_t delta   = (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+			uint32_t offset = state->baseCursor + delta;
+			if (length > pageSize - bufferedSize || !isBaseAvailable(state, targetPageIndex, offset, length)) {
+				return DELTA_PATCH_INVALID_DATA;
+			}
+			memcpy(buffer + bufferedSize, state->base + offset, length);
+			state->baseCursor = offset + length;
+			bufferedSize += length;
+		}
+		else {
+			uint32_t length = token + 1;
+			if (length > pageSize - bufferedSize || length > state->patchSize - state->patchOffset) {
+				return DELTA_PATCH_INVALID_DATA;
+			}
+			memcpy(buffer + bufferedSize, state->patch + state->patchOffset, length);
+			state->patchOffset += length;
+			state->baseCursor += length;
+			bufferedSize += length;
+		}
+	}
+
+	*targetOffset = pageStart;
+	*size         = pageSize;
+	state->outputPageCount++;
+	return DELTA_PATCH_SUCCESS;
+}
+
+uint32_t deltaPatchCrc32(const uint8_t* data, uint32_t size, uint32_t crc) {
+	// Bitwise implementation: slower than a table, but it doesn't cost flash or RAM.
+	crc = ~crc;
+	for (uint32_t i = 0; i < size; ++i) {
+		crc ^= data[i];
+		for (uint8_t bit = 0; bit < 8; ++bit) {
+			crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+		}
+	}
+	return ~crc;
+}
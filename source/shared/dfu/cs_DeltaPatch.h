@@ -0,0 +1,162 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * A delta patch describes a target image in terms of a base image, so that a firmware update only has to transfer
+ * the difference with the installed firmware.
+ *
+ * The patch is made to be applied in place: the target image is written page by page over the base image, so no
+ * second copy of the image is needed. Each target page is built in a RAM buffer of 1 page, before it is written.
+ * This means a page can only copy from the parts of the base image that have not been overwritten yet:
+ * - In forward order, target pages are written from the first to the last page, so a page can only copy from its
+ *   own page and later pages of the base image. This works best for images that shrink.
+ * - In backward order, target pages are written from the last to the first page, so a page can only copy from its
+ *   own page and earlier pages of the base image. This works best for images that grow.
+ *
+ * The patch starts with a cs_delta_patch_header_t, followed by the operations. The operations of each page
+ * produce exactly the data of that page, starting with the first target page to be written.
+ * Each operation starts with a token byte:
+ * - Token 0 - 127: literal. Followed by (token + 1) bytes that are copied to the target.
+ * - Token 128 - 255: copy from the base image. The length is ((token & 0x7F) + 1). When that is 128, it's followed by
+ *   a varint with the additional length. Then follows a zigzag varint with the offset in the base image, relative
+ *   to the base cursor.
+ *
+ * The base cursor is where the previous operation ended in the base image: a copy sets it to the end of the copied
+ * data, a literal advances it by the length of the literal. This way, the many small differences between two
+ * firmware versions only cost a literal, and the copy after it doesn't need an offset.
+ *
+ * Varints are unsigned LEB128: 7 bits per byte, least significant first, with the high bit set when more bytes
+ * follow.
+ */
+
+#define CS_DELTA_PATCH_MAGIC 0x50444343  // "CCDP" when read as bytes.
+#define CS_DELTA_PATCH_VERSION 1
+
+//! The target pages are written from the last to the first page.
+#define CS_DELTA_PATCH_FLAG_BACKWARD 0x01
+
+//! Token of a copy from the base image, the remaining bits are the length - 1.
+#define CS_DELTA_PATCH_TOKEN_COPY 0x80
+
+//! Maximum length of a literal.
+#define CS_DELTA_PATCH_MAX_LITERAL_LENGTH 128
+
+typedef struct __attribute__((packed)) {
+	uint32_t magic;
+	uint8_t version;
+	uint8_t flags;
+	// Size of a page, the patch can only be applied with this page size.
+	uint16_t pageSize;
+	uint32_t baseSize;
+	// CRC32 of the base image.
+	uint32_t baseCrc;
+	uint32_t targetSize;
+	// CRC32 of the target image.
+	uint32_t targetCrc;
+	// CRC32 of the target pages, in the order they are written.
+	uint32_t outputCrc;
+} cs_delta_patch_header_t;
+
+enum DeltaPatchRetCode {
+	DELTA_PATCH_SUCCESS        = 0,
+	// All target pages have been produced.
+	DELTA_PATCH_DONE           = 1,
+	DELTA_PATCH_INVALID_HEADER = 2,
+	// The base image is not the image this patch was made for.
+	DELTA_PATCH_BASE_MISMATCH  = 3,
+	// The patch is corrupt, or it refers to data that has been overwritten already.
+	DELTA_PATCH_INVALID_DATA   = 4,
+};
+
+/**
+ * State of applying a patch.
+ *
+ * The progress fields are all that changes while applying the patch. They can be stored after each page, so that
+ * applying can be resumed after a reset.
+ */
+typedef struct {
+	const uint8_t* patch;
+	uint32_t patchSize;
+	const uint8_t* base;
+	cs_delta_patch_header_t header;
+	uint32_t pageCount;
+
+	// Progress: number of target pages produced so far.
+	uint32_t outputPageCount;
+	// Progress: offset in the patch of the next operation.
+	uint32_t patchOffset;
+	// Progress: the base cursor.
+	uint32_t baseCursor;
+} cs_delta_patch_t;
+
+/**
+ * Start applying a patch.
+ *
+ * Only checks the header, use deltaPatchVerifyBase() to check the base image.
+ *
+ * @param[out] state     The state to initialize.
+ * @param[in] patch      The patch, has to stay readable while the patch is applied.
+ * @param[in] patchSize  Size of the patch.
+ * @param[in] base       The base image, has to stay readable while the patch is applied.
+ * @param[in] pageSize   The page size that will be used to write the target.
+ *
+ * @return DELTA_PATCH_SUCCESS          The header is valid.
+ * @return DELTA_PATCH_INVALID_HEADER   The header is invalid, of an unknown version, or for another page size.
+ */
+enum DeltaPatchRetCode deltaPatchInit(
+		cs_delta_patch_t* state, const uint8_t* patch, uint32_t patchSize, const uint8_t* base, uint16_t pageSize);
+
+/**
+ * Check whether the base image is the image the patch was made for.
+ *
+ * Can only be used before any target page has been written.
+ *
+ * @param[in] state      The state.
+ * @param[in] baseSize   Size of the installed base image.
+ *
+ * @return DELTA_PATCH_SUCCESS          The base image matches.
+ * @return DELTA_PATCH_BASE_MISMATCH    The base image differs.
+ */
+enum DeltaPatchRetCode deltaPatchVerifyBase(const cs_delta_patch_t* state, uint32_t baseSize);
+
+/**
+ * Produce the next target page.
+ *
+ * @param[in,out] state         The state.
+ * @param[out] buffer           Buffer for the page, of the page size.
+ * @param[out] targetOffset     Offset of the page in the target image.
+ * @param[out] size             Size of the page: the page size, or less for the last page of the image.
+ *
+ * @return DELTA_PATCH_SUCCESS          The page has been produced.
+ * @return DELTA_PATCH_DONE             There are no more pages.
+ * @return DELTA_PATCH_INVALID_DATA     The patch is invalid.
+ */
+enum DeltaPatchRetCode deltaPatchNextPage(
+		cs_delta_patch_t* state, uint8_t* buffer, uint32_t* targetOffset, uint32_t* size);
+
+/**
+ * Calculate the CRC32 of data, compatible with zlib and the nordic crc32_compute().
+ *
+ * @param[in] data       The data.
+ * @param[in] size       Size of the data.
+ * @param[in] crc        CRC of the previous data, or 0 to start.
+ * @return               The CRC.
+ */
+uint32_t deltaPatchCrc32(const uint8_t* data, uint32_t size, uint32_t crc);
+
+#ifdef __cplusplus
+}
+#endif
@@ -50,6 +50,8 @@ enum IpcIndex {
 	IPC_INDEX_BOOTLOADER_TO_BLUENET = 2,
 	// To communicate from bluenet towards bluenet, across reboots.
 	IPC_INDEX_BLUENET_TO_BLUENET    = 3,
+	// To hand over state from bluenet towards bluenet, across an intentional reset.
+	IPC_INDEX_WARM_BOOT             = 4,
 };
 
 enum IpcRetCode {
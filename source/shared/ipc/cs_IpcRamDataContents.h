@@ -20,6 +20,10 @@ extern "C" {
 #define BLUENET_IPC_BLUENET_REBOOT_DATA_MAJOR 1
 #define BLUENET_IPC_BLUENET_REBOOT_DATA_MINOR 1
 
+// Update when struct bluenet_ipc_warm_boot_data_t changes
+#define BLUENET_IPC_WARM_BOOT_DATA_MAJOR 1
+#define BLUENET_IPC_WARM_BOOT_DATA_MINOR 0
+
 enum BuildType {
 	BUILD_TYPE_RESERVED       = 0,
 	BUILD_TYPE_DEBUG          = 1,
@@ -97,6 +101,29 @@ typedef struct {
 
 } __attribute__((packed)) bluenet_ipc_bluenet_data_t;
 
+/**
+ * Data struct that is handed over from bluenet to bluenet, across an intentional reset.
+ *
+ * Only contains state that takes long to converge again after a reboot, or that may not have been written to flash
+ * yet. It is only valid for the first boot after the reset.
+ */
+typedef struct {
+	//! Major version of the data in this struct
+	uint8_t ipcDataMajor;
+	//! Minor version of the data in this struct
+	uint8_t ipcDataMinor;
+
+	//! Synchronized posix time at the moment of reset, in seconds.
+	uint32_t posixTime;
+	//! Milliseconds passed since posixTime.
+	uint16_t posixTimeMs;
+	//! Synchronization version of the time, 0 when the time was not set.
+	uint8_t timeVersion;
+
+	//! The switch state, as it may not have been written to flash yet.
+	uint8_t switchState;
+} __attribute__((packed)) bluenet_ipc_warm_boot_data_t;
+
 /**
  * Make data available as union.
  */
@@ -107,6 +134,8 @@ typedef union {
 	bluenet_ipc_bootloader_data_t bootloaderData;
 	// The data from bluenet to bluenet firmware
 	bluenet_ipc_bluenet_data_t bluenetRebootData;
+	// The data from bluenet to bluenet firmware, across an intentional reset
+	bluenet_ipc_warm_boot_data_t warmBootData;
 } __attribute__((packed)) bluenet_ipc_data_payload_t;
 
 #ifdef __cplusplus
@@ -8,6 +8,7 @@
 #include <behaviour/cs_Behaviour.h>
 #include <logging/cs_Logger.h>
 #include <time/cs_SystemTime.h>
+#include <util/cs_Math.h>
 #include <util/cs_WireFormat.h>
 
 Behaviour::Behaviour(
@@ -93,6 +94,11 @@ TimeOfDay Behaviour::until() const {
 	return behaviourAppliesUntil;
 }
 
+void Behaviour::updateCachedTimes() {
+	cachedFromSeconds  = behaviourAppliesFrom;
+	cachedUntilSeconds = behaviourAppliesUntil;
+}
+
 bool Behaviour::isValid(Time currenttime) {
 	bool isValidIntervalOverlapsMidnight = (from() >= until());
 
@@ -128,6 +134,24 @@ bool Behaviour::isValid(Time currenttime) {
 	}
 }
 
+uint32_t Behaviour::secondsUntilNextBoundary(Time currentTime) {
+	constexpr uint32_t secondsPerDay = 24 * 60 * 60;
+	uint32_t now                     = currentTime.timeOfDay();
+
+	// The day of week is checked too, so midnight is a boundary as well.
+	// The conflict resolution sees a behaviour that starts at this second as the one that started longest ago,
+	// and a second later as the one that started most recently, so the second after from() is a boundary as well.
+	uint32_t result      = secondsPerDay - now;
+	uint32_t fromSeconds = static_cast<uint32_t>(from());
+	for (uint32_t boundary : {fromSeconds, fromSeconds + 1, static_cast<uint32_t>(until())}) {
+		uint32_t secondsUntilBoundary = CsMath::mod(static_cast<int32_t>(boundary - now), secondsPerDay);
+		if (secondsUntilBoundary != 0 && secondsUntilBoundary < result) {
+			result = secondsUntilBoundary;
+		}
+	}
+	return result;
+}
+
 void Behaviour::print() {
 #if CS_SERIAL_NRF_LOG_ENABLED == 0
 	LOGd("Behaviour: type(%u) %02u:%02u:%02u - %02u:%02u:%02u %3u%%, days(0x%X) for profileId(%u) isValid(%u)",
@@ -35,9 +35,18 @@ int numberOfRooms(PresencePredicate predicate) {
 	return count;
 }
 
+uint16_t PresenceRelevanceRank(PresencePredicate predicate) {
+	// The condition is decisive, the number of rooms only breaks ties between equal room based conditions.
+	// Relevance is at least -1, and the number of rooms fits in the lower byte.
+	uint16_t rank = static_cast<uint16_t>(getRelevance(predicate._condition) + 1) << 8;
+	if (isRoomBased(predicate)) {
+		rank |= numberOfRooms(predicate);
+	}
+	return rank;
+}
+
 bool PresenceIsMoreRelevant(PresencePredicate lhs, PresencePredicate rhs) {
-	return getRelevance(lhs._condition) > getRelevance(rhs._condition)
-		   || (lhs._condition == rhs._condition && isRoomBased(lhs) && numberOfRooms(lhs) > numberOfRooms(rhs));
+	return PresenceRelevanceRank(lhs) > PresenceRelevanceRank(rhs);
 }
 
 // Warning: be careful about integer underflow in the subtraction. Changed the signature to
@@ -78,9 +87,10 @@ bool FromUntilIntervalIsMoreRelevantOrEqual(
 
 bool FromUntilIntervalIsMoreRelevantOrEqual(Behaviour* lhs, Behaviour* rhs, Time currentTime) {
 	return FromUntilIntervalIsMoreRelevantOrEqual(
-			lhs->from(), lhs->until(), rhs->from(), rhs->until(), currentTime.timeOfDay());
+			lhs->cachedFrom(), lhs->cachedUntil(), rhs->cachedFrom(), rhs->cachedUntil(), currentTime.timeOfDay());
 }
 
 bool FromUntilIntervalIsEqual(Behaviour* lhs, Behaviour* rhs) {
-	return lhs != nullptr && rhs != nullptr && lhs->from() == rhs->from() && lhs->until() == rhs->until();
+	return lhs != nullptr && rhs != nullptr && lhs->cachedFrom() == rhs->cachedFrom()
+		   && lhs->cachedUntil() == rhs->cachedUntil();
 }
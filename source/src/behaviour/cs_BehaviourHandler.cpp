@@ -17,6 +17,7 @@
 #include <test/cs_Test.h>
 #include <time/cs_SystemTime.h>
 #include <time/cs_TimeOfDay.h>
+#include <util/cs_Math.h>
 
 #define LOGBehaviourHandlerDebug LOGvv
 #define LOGBehaviourHandlerVerbose LOGvv
@@ -40,10 +41,26 @@ void BehaviourHandler::handleEvent(event_t& evt) {
 	switch (evt.type) {
 		case CS_TYPE::EVT_PRESENCE_MUTATION: {
 			LOGBehaviourHandlerDebug("Presence mutation event in BehaviourHandler");
+			invalidate();
 			update();
 			break;
 		}
 		case CS_TYPE::EVT_BEHAVIOURSTORE_MUTATION: {
+			invalidate();
+			update();
+			break;
+		}
+		case CS_TYPE::STATE_SUN_TIME: {
+			// The cached from/until of sun based behaviours have to be recomputed.
+			if (_behaviourStore != nullptr) {
+				_behaviourStore->updateCachedTimes();
+			}
+			invalidate();
+			update();
+			break;
+		}
+		case CS_TYPE::EVT_TIME_SET: {
+			invalidate();
 			update();
 			break;
 		}
@@ -100,16 +117,107 @@ bool BehaviourHandler::update() {
 			LOGBehaviourHandlerVerbose("Not updating, because presence data is missing");
 		}
 		else {
+			uint32_t upTime = SystemTime::up();
+			if (!evaluationIsDue(upTime, time, presence.value())) {
+				_skippedEvaluation = true;
+				_lastSkippedUpTime = upTime;
+				_lastSkippedTime   = time;
+				return true;
+			}
+			fastForwardBehaviours();
 			currentIntendedState = computeIntendedState(time, presence.value());
+			scheduleNextEvaluation(upTime, time, presence.value());
 		}
 	}
 
 	return true;
 }
 
+void BehaviourHandler::invalidate() {
+	fastForwardBehaviours();
+	_evaluationScheduled = false;
+}
+
+bool BehaviourHandler::evaluationIsDue(
+		uint32_t upTime, Time currentTime, PresenceStateDescription currentPresence) const {
+	if (!_evaluationScheduled || !currentTime.isValid()) {
+		return true;
+	}
+	if (!(currentPresence == _evaluatedPresence)) {
+		return true;
+	}
+	if (currentTime.timestamp() < _evaluatedTimestamp) {
+		// Time went backwards.
+		return true;
+	}
+	return currentTime.timestamp() >= _nextEvaluationTimestamp || upTime >= _nextEvaluationUpTime;
+}
+
+void BehaviourHandler::scheduleNextEvaluation(
+		uint32_t upTime, Time currentTime, PresenceStateDescription currentPresence) {
+	if (!currentTime.isValid() || _behaviourStore == nullptr) {
+		// Evaluate at every update.
+		_evaluationScheduled = false;
+		return;
+	}
+
+	uint32_t now               = currentTime.timestamp();
+	_evaluationScheduled       = true;
+	_evaluatedPresence         = currentPresence;
+	_evaluatedTimestamp        = now;
+	_nextEvaluationTimestamp   = UINT32_MAX;
+	_nextEvaluationUpTime      = UINT32_MAX;
+	_skippedEvaluation         = false;
+
+	for (uint8_t index = 0; index < BehaviourStore::MaxBehaviours; ++index) {
+		Behaviour* behaviour = _behaviourStore->getBehaviour(index);
+		if (behaviour == nullptr) {
+			continue;
+		}
+		uint32_t boundary        = now + behaviour->secondsUntilNextBoundary(currentTime);
+		_nextEvaluationTimestamp = CsMath::min(_nextEvaluationTimestamp, boundary);
+
+		SwitchBehaviour* switchBehaviour = _behaviourStore->getSwitchBehaviour(index);
+		if (switchBehaviour == nullptr) {
+			continue;
+		}
+		// A grace period ends one second after its end time. Grace ends in the past can be ignored:
+		// they belong to a behaviour that isn't evaluated at this time of day.
+		std::optional<uint32_t> graceEnd = switchBehaviour->gracePeriodEnd();
+		if (graceEnd && *graceEnd >= upTime) {
+			_nextEvaluationUpTime = CsMath::min(_nextEvaluationUpTime, *graceEnd + 1);
+		}
+
+		ExtendedSwitchBehaviour* extendedBehaviour = _behaviourStore->getExtendedSwitchBehaviour(index);
+		if (extendedBehaviour == nullptr) {
+			continue;
+		}
+		std::optional<uint32_t> extensionGraceEnd = extendedBehaviour->extensionGracePeriodEnd();
+		if (extensionGraceEnd && *extensionGraceEnd >= now) {
+			_nextEvaluationTimestamp = CsMath::min(_nextEvaluationTimestamp, *extensionGraceEnd + 1);
+		}
+	}
+	LOGBehaviourHandlerVerbose("Next evaluation at t=%u up=%u", _nextEvaluationTimestamp, _nextEvaluationUpTime);
+}
+
+void BehaviourHandler::fastForwardBehaviours() {
+	if (!_skippedEvaluation || _behaviourStore == nullptr) {
+		return;
+	}
+	_skippedEvaluation = false;
+
+	// Each skipped evaluation would have had the same outcome as the last evaluation,
+	// but it would have refreshed the presence timestamps of the behaviours.
+	for (uint8_t index = 0; index < BehaviourStore::MaxBehaviours; ++index) {
+		if (SwitchBehaviour* switchBehaviour = _behaviourStore->getSwitchBehaviour(index)) {
+			switchBehaviour->fastForward(_lastSkippedUpTime, _lastSkippedTime);
+		}
+	}
+}
+
 SwitchBehaviour* BehaviourHandler::validateSwitchBehaviour(
-		Behaviour* behaviour, Time currentTime, PresenceStateDescription currentPresence) const {
-	if (SwitchBehaviour* switchBehaviour = dynamic_cast<SwitchBehaviour*>(behaviour)) {
+		uint8_t index, Time currentTime, PresenceStateDescription currentPresence) const {
+	if (SwitchBehaviour* switchBehaviour = _behaviourStore->getSwitchBehaviour(index)) {
 		if (switchBehaviour->isValid(currentTime, currentPresence)) {
 			return switchBehaviour;
 		}
@@ -119,8 +227,8 @@ SwitchBehaviour* BehaviourHandler::validateSwitchBehaviour(
 }
 
 TwilightBehaviour* BehaviourHandler::validateTwilightBehaviour(
-		Behaviour* behaviour, Time currentTime, PresenceStateDescription currentPresence) const {
-	if (TwilightBehaviour* twilightBehaviour = dynamic_cast<TwilightBehaviour*>(behaviour)) {
+		uint8_t index, Time currentTime, PresenceStateDescription currentPresence) const {
+	if (TwilightBehaviour* twilightBehaviour = _behaviourStore->getTwilightBehaviour(index)) {
 		if (twilightBehaviour->isValid(currentTime)) {
 			return twilightBehaviour;
 		}
@@ -129,8 +237,8 @@ TwilightBehaviour* BehaviourHandler::validateTwilightBehaviour(
 	return nullptr;
 }
 
-bool BehaviourHandler::validateBehaviour(Behaviour* behaviour) const {
-	if (_presenceHandler == nullptr) {
+bool BehaviourHandler::validateBehaviour(uint8_t index) const {
+	if (_presenceHandler == nullptr || _behaviourStore == nullptr) {
 		return false;
 	}
 
@@ -141,8 +249,8 @@ bool BehaviourHandler::validateBehaviour(Behaviour* behaviour) const {
 		return false;
 	}
 
-	return validateSwitchBehaviour(behaviour, time, presence.value()) != nullptr
-		   || validateTwilightBehaviour(behaviour, time, presence.value()) != nullptr;
+	return validateSwitchBehaviour(index, time, presence.value()) != nullptr
+		   || validateTwilightBehaviour(index, time, presence.value()) != nullptr;
 }
 
 SwitchBehaviour* BehaviourHandler::resolveSwitchBehaviour(
@@ -151,9 +259,8 @@ SwitchBehaviour* BehaviourHandler::resolveSwitchBehaviour(
 
 	// 'best' meaning most relevant considering from/until time window.
 	SwitchBehaviour* currentBestSwitchBehaviour = nullptr;
-	for (auto candidateBehaviour : _behaviourStore->getActiveBehaviours()) {
-		SwitchBehaviour* candidateSwitchBehaviour =
-				validateSwitchBehaviour(candidateBehaviour, currentTime, currentPresence);
+	for (uint8_t index = 0; index < BehaviourStore::MaxBehaviours; ++index) {
+		SwitchBehaviour* candidateSwitchBehaviour = validateSwitchBehaviour(index, currentTime, currentPresence);
 
 		// check for failed transformation from right to left. If either
 		// current or candidate is nullptr, we can continue to the next candidate.
@@ -168,15 +275,15 @@ SwitchBehaviour* BehaviourHandler::resolveSwitchBehaviour(
 
 		// conflict resolve:
 
-		// presence first.
-		auto candidateCondition   = candidateSwitchBehaviour->currentPresencePredicate();
-		auto currentBestCondition = currentBestSwitchBehaviour->currentPresencePredicate();
+		// presence first, see PresenceIsMoreRelevant().
+		uint16_t candidateRank   = candidateSwitchBehaviour->currentPresenceRank();
+		uint16_t currentBestRank = currentBestSwitchBehaviour->currentPresenceRank();
 
-		if (PresenceIsMoreRelevant(candidateCondition, currentBestCondition)) {
+		if (candidateRank > currentBestRank) {
 			currentBestSwitchBehaviour = candidateSwitchBehaviour;
 			continue;
 		}
-		if (PresenceIsMoreRelevant(currentBestCondition, candidateCondition)) {
+		if (currentBestRank > candidateRank) {
 			// candidate lost.
 			continue;
 		}
@@ -235,6 +342,9 @@ void BehaviourHandler::handleGetBehaviourDebug(event_t& evt) {
 	}
 	behaviour_debug_t* behaviourDebug = (behaviour_debug_t*)(evt.result.buf.data);
 
+	// The behaviours are validated below, which changes their runtime values.
+	invalidate();
+
 	Time currentTime                  = SystemTime::now();
 	std::optional<PresenceStateDescription> currentPresence =
 			_presenceHandler == nullptr ? std::nullopt : _presenceHandler->getCurrentPresenceDescription();
@@ -292,8 +402,7 @@ void BehaviourHandler::handleGetBehaviourDebug(event_t& evt) {
 
 	if (checkBehaviours) {
 		for (uint8_t index = 0; index < behaviours.size(); ++index) {
-			if (SwitchBehaviour* switchbehave = dynamic_cast<SwitchBehaviour*>(behaviours[index])) {
-				// cast to switch behaviour succesful.
+			if (SwitchBehaviour* switchbehave = _behaviourStore->getSwitchBehaviour(index)) {
 				// note: this may also be an extendedswitchbehaviour - which is intended!
 				if (switchbehave->isValid(currentTime, currentPresence.value())) {
 					behaviourDebug->activeBehaviours |= (1 << index);
@@ -303,12 +412,11 @@ void BehaviourHandler::handleGetBehaviourDebug(event_t& evt) {
 				}
 			}
 
-			if (ExtendedSwitchBehaviour* extendedswitchbehave =
-						dynamic_cast<ExtendedSwitchBehaviour*>(behaviours[index])) {
+			if (ExtendedSwitchBehaviour* extendedswitchbehave = _behaviourStore->getExtendedSwitchBehaviour(index)) {
 				behaviourDebug->extensionActive |= extendedswitchbehave->extensionPeriodIsActive() ? (1 << index) : 0;
 			}
 
-			if (TwilightBehaviour* twilight = dynamic_cast<TwilightBehaviour*>(behaviours[index])) {
+			if (TwilightBehaviour* twilight = _behaviourStore->getTwilightBehaviour(index)) {
 				if (twilight->isValid(currentTime)) {
 					behaviourDebug->activeBehaviours |= (1 << index);
 				}
@@ -371,6 +479,7 @@ void BehaviourHandler::onBehaviourSettingsChange(behaviour_settings_t settings)
 	TEST_PUSH_B(this, _isActive);
 	UartHandler::getInstance().writeMsg(
 			UART_OPCODE_TX_MESH_SET_BEHAVIOUR_SETTINGS, reinterpret_cast<uint8_t*>(&settings), sizeof(settings));
+	invalidate();
 	update();
 }
 
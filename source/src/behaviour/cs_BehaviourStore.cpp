@@ -21,9 +21,9 @@
 
 // ======================= public interface ========================
 
-ErrorCodesGeneral BehaviourStore::addBehaviour(Behaviour* behaviour) {
+ErrorCodesGeneral BehaviourStore::addBehaviour(const Behaviour& behaviour) {
 	uint8_t index = findEmptyIndex();
-	if (index > MaxBehaviours) {
+	if (index >= MaxBehaviours) {
 		return ERR_NO_SPACE;
 	}
 	else {
@@ -31,12 +31,18 @@ ErrorCodesGeneral BehaviourStore::addBehaviour(Behaviour* behaviour) {
 	}
 }
 
-ErrorCodesGeneral BehaviourStore::replaceBehaviour(uint8_t index, Behaviour* behaviour) {
-	// This also checks the index.
+ErrorCodesGeneral BehaviourStore::replaceBehaviour(uint8_t index, const Behaviour& behaviour) {
+	if (getBehaviourSize(behaviour.getType()) == 0 || index >= MaxBehaviours) {
+		return ERR_WRONG_PARAMETER;
+	}
+	if (!hasSpace(behaviour.getType(), index)) {
+		return ERR_NO_SPACE;
+	}
 	auto retVal = removeBehaviour(index);
 	if (retVal == ERR_SUCCESS || retVal == ERR_SUCCESS_NO_CHANGE) {
-		assignBehaviour(index, behaviour);
-		storeUpdate(index, behaviour);
+		Behaviour* storedBehaviour = allocateBehaviour(behaviour);
+		assignBehaviour(index, storedBehaviour);
+		storeUpdate(index, storedBehaviour);
 	}
 	return retVal;
 }
@@ -45,6 +51,42 @@ Behaviour* BehaviourStore::getBehaviour(uint8_t index) {
 	return index < MaxBehaviours ? activeBehaviours[index] : nullptr;
 }
 
+SwitchBehaviour* BehaviourStore::getSwitchBehaviour(uint8_t index) {
+	Behaviour* behaviour = getBehaviour(index);
+	if (behaviour == nullptr) {
+		return nullptr;
+	}
+	switch (behaviour->getType()) {
+		case Behaviour::Type::Switch: return static_cast<SwitchBehaviour*>(behaviour);
+		case Behaviour::Type::Extended: return static_cast<ExtendedSwitchBehaviour*>(behaviour);
+		default: return nullptr;
+	}
+}
+
+ExtendedSwitchBehaviour* BehaviourStore::getExtendedSwitchBehaviour(uint8_t index) {
+	Behaviour* behaviour = getBehaviour(index);
+	if (behaviour == nullptr || behaviour->getType() != Behaviour::Type::Extended) {
+		return nullptr;
+	}
+	return static_cast<ExtendedSwitchBehaviour*>(behaviour);
+}
+
+TwilightBehaviour* BehaviourStore::getTwilightBehaviour(uint8_t index) {
+	Behaviour* behaviour = getBehaviour(index);
+	if (behaviour == nullptr || behaviour->getType() != Behaviour::Type::Twilight) {
+		return nullptr;
+	}
+	return static_cast<TwilightBehaviour*>(behaviour);
+}
+
+void BehaviourStore::updateCachedTimes() {
+	for (auto behaviour : activeBehaviours) {
+		if (behaviour != nullptr) {
+			behaviour->updateCachedTimes();
+		}
+	}
+}
+
 void BehaviourStore::handleEvent(event_t& evt) {
 	switch (evt.type) {
 		case CS_TYPE::CMD_ADD_BEHAVIOUR: {
@@ -111,7 +153,7 @@ BehaviourMutation BehaviourStore::handleSaveBehaviour(event_t& evt) {
 	// Fill return buffer if it's large enough.
 	if (evt.result.buf.data != nullptr && evt.result.buf.len >= sizeof(uint8_t) + sizeof(uint32_t)) {
 		*reinterpret_cast<uint8_t*>(evt.result.buf.data + 0)  = result_index;
-		*reinterpret_cast<uint32_t*>(evt.result.buf.data + 1) = calculateMasterHash();
+		*reinterpret_cast<uint32_t*>(evt.result.buf.data + 1) = getMasterHash();
 		evt.result.dataSize                                   = sizeof(uint8_t) + sizeof(uint32_t);
 	}
 
@@ -162,34 +204,87 @@ ErrorCodesGeneral BehaviourStore::checkSizeAndType(SwitchBehaviour::Type type, c
 	return ERR_SUCCESS;
 }
 
-Behaviour* BehaviourStore::allocateBehaviour(
-		uint8_t index, SwitchBehaviour::Type type, uint8_t* buf, cs_buffer_size_t bufSize) {
+Behaviour* BehaviourStore::allocateBehaviour(SwitchBehaviour::Type type, uint8_t* buf, cs_buffer_size_t bufSize) {
 	switch (type) {
 		case SwitchBehaviour::Type::Switch: {
 			LOGBehaviourStoreDebug("Allocating new SwitchBehaviour");
-			return new SwitchBehaviour(WireFormat::deserialize<SwitchBehaviour>(buf, bufSize));
+			return switchBehaviours.emplace(WireFormat::deserialize<SwitchBehaviour>(buf, bufSize));
 		}
 		case SwitchBehaviour::Type::Twilight: {
 			LOGBehaviourStoreDebug("Allocating new TwilightBehaviour");
-			return new TwilightBehaviour(WireFormat::deserialize<TwilightBehaviour>(buf, bufSize));
+			return twilightBehaviours.emplace(WireFormat::deserialize<TwilightBehaviour>(buf, bufSize));
 		}
 		case SwitchBehaviour::Type::Extended: {
 			LOGBehaviourStoreDebug("Allocating new ExtendedSwitchBehaviour");
-			return new ExtendedSwitchBehaviour(WireFormat::deserialize<ExtendedSwitchBehaviour>(buf, bufSize));
+			return extendedSwitchBehaviours.emplace(WireFormat::deserialize<ExtendedSwitchBehaviour>(buf, bufSize));
 		}
 		default: return nullptr;
 	}
 }
 
+Behaviour* BehaviourStore::allocateBehaviour(const Behaviour& behaviour) {
+	// The type tag determines the actual type of the behaviour.
+	switch (behaviour.getType()) {
+		case SwitchBehaviour::Type::Switch: {
+			return switchBehaviours.emplace(static_cast<const SwitchBehaviour&>(behaviour));
+		}
+		case SwitchBehaviour::Type::Twilight: {
+			return twilightBehaviours.emplace(static_cast<const TwilightBehaviour&>(behaviour));
+		}
+		case SwitchBehaviour::Type::Extended: {
+			return extendedSwitchBehaviours.emplace(static_cast<const ExtendedSwitchBehaviour&>(behaviour));
+		}
+		default: return nullptr;
+	}
+}
+
+void BehaviourStore::freeBehaviour(uint8_t index) {
+	Behaviour* behaviour = activeBehaviours[index];
+	if (behaviour == nullptr) {
+		return;
+	}
+	switch (behaviour->getType()) {
+		case SwitchBehaviour::Type::Switch: {
+			switchBehaviours.erase(static_cast<SwitchBehaviour*>(behaviour));
+			break;
+		}
+		case SwitchBehaviour::Type::Twilight: {
+			twilightBehaviours.erase(static_cast<TwilightBehaviour*>(behaviour));
+			break;
+		}
+		case SwitchBehaviour::Type::Extended: {
+			extendedSwitchBehaviours.erase(static_cast<ExtendedSwitchBehaviour*>(behaviour));
+			break;
+		}
+		default: break;
+	}
+	activeBehaviours[index] = nullptr;
+}
+
+bool BehaviourStore::hasSpace(SwitchBehaviour::Type type, uint8_t index) {
+	if (activeBehaviours[index] != nullptr && activeBehaviours[index]->getType() == type) {
+		// The place of the behaviour at this index will be reused.
+		return true;
+	}
+	switch (type) {
+		case SwitchBehaviour::Type::Switch: return !switchBehaviours.isFull();
+		case SwitchBehaviour::Type::Twilight: return !twilightBehaviours.isFull();
+		case SwitchBehaviour::Type::Extended: return !extendedSwitchBehaviours.isFull();
+		default: return false;
+	}
+}
+
 void BehaviourStore::assignBehaviour(uint8_t index, Behaviour* behaviour) {
-	// no need to delete previous entry, already checked for nullptr
+	// no need to remove previous entry, already checked for nullptr
 	activeBehaviours[index] = behaviour;
+	activeBehaviours[index]->updateCachedTimes();
+	updateMasterHash(index);
 	activeBehaviours[index]->print();
 }
 
 uint8_t BehaviourStore::findEmptyIndex() {
 	uint8_t emptyIndex = 0;
-	while (activeBehaviours[emptyIndex] != nullptr && emptyIndex < MaxBehaviours) {
+	while (emptyIndex < MaxBehaviours && activeBehaviours[emptyIndex] != nullptr) {
 		emptyIndex++;
 	}
 	return emptyIndex;
@@ -209,12 +304,12 @@ ErrorCodesGeneral BehaviourStore::addBehaviour(uint8_t* buf, cs_buffer_size_t bu
 
 	// find the first empty index.
 	uint8_t emptyIndex = findEmptyIndex();
-	if (emptyIndex >= MaxBehaviours) {
+	if (emptyIndex >= MaxBehaviours || !hasSpace(typ, emptyIndex)) {
 		return ERR_NO_SPACE;
 	}
 	LOGBehaviourStoreInfo("Add behaviour of type %u to index %u", typ, emptyIndex);
 
-	Behaviour* behaviour = allocateBehaviour(emptyIndex, typ, buf, bufSize);
+	Behaviour* behaviour = allocateBehaviour(typ, buf, bufSize);
 	assignBehaviour(emptyIndex, behaviour);
 	storeUpdate(emptyIndex, typ, buf, bufSize);
 	index = emptyIndex;
@@ -230,7 +325,7 @@ ErrorCodesGeneral BehaviourStore::replaceParameterValidation(event_t& evt, uint8
 	}
 
 	const uint8_t indexSize                  = sizeof(uint8_t);
-	TYPIFY(STATE_BEHAVIOUR_MASTER_HASH) hash = calculateMasterHash();
+	TYPIFY(STATE_BEHAVIOUR_MASTER_HASH) hash = getMasterHash();
 	State::getInstance().set(CS_TYPE::STATE_BEHAVIOUR_MASTER_HASH, &hash, sizeof(hash));
 
 	// check size
@@ -265,9 +360,14 @@ BehaviourMutation BehaviourStore::handleReplaceBehaviour(event_t& evt) {
 	LOGBehaviourStoreInfo("Replace behaviour at ind=%u, type=%u", index, static_cast<uint8_t>(type));
 
 	auto retCode = replaceParameterValidation(evt, index, type);
+	if (retCode == ERR_SUCCESS && !hasSpace(type, index)) {
+		LOGw("No space for behaviour of type %u", static_cast<uint8_t>(type));
+		retCode = ERR_NO_SPACE;
+	}
 	if (retCode == ERR_SUCCESS) {
-		Behaviour* behaviour = allocateBehaviour(index, type, dat + indexSize, evt.size - indexSize);
+		// The place in the pool may be reused, so remove the previous behaviour first.
 		removeBehaviour(index);
+		Behaviour* behaviour = allocateBehaviour(type, dat + indexSize, evt.size - indexSize);
 		assignBehaviour(index, behaviour);
 		storeUpdate(index, type, dat + indexSize, evt.size - indexSize);
 		resultingMutation = BehaviourMutation(index, BehaviourMutation::Mutation::UPDATE);
@@ -277,7 +377,7 @@ BehaviourMutation BehaviourStore::handleReplaceBehaviour(event_t& evt) {
 	// Fill return buffer if it's large enough.
 	if (evt.result.buf.data != nullptr && evt.result.buf.len >= sizeof(uint8_t) + sizeof(uint32_t)) {
 		evt.result.buf.data[0]                                              = index;
-		*reinterpret_cast<uint32_t*>(evt.result.buf.data + sizeof(uint8_t)) = calculateMasterHash();
+		*reinterpret_cast<uint32_t*>(evt.result.buf.data + sizeof(uint8_t)) = getMasterHash();
 		evt.result.dataSize                                                 = sizeof(uint8_t) + sizeof(uint32_t);
 	}
 
@@ -300,7 +400,7 @@ BehaviourMutation BehaviourStore::handleRemoveBehaviour(event_t& evt) {
 	// Fill return buffer if it's large enough.
 	if (evt.result.buf.data != nullptr && evt.result.buf.len >= sizeof(uint8_t) + sizeof(uint32_t)) {
 		evt.result.buf.data[0]                                              = index;
-		*reinterpret_cast<uint32_t*>(evt.result.buf.data + sizeof(uint8_t)) = calculateMasterHash();
+		*reinterpret_cast<uint32_t*>(evt.result.buf.data + sizeof(uint8_t)) = getMasterHash();
 		evt.result.dataSize                                                 = sizeof(uint8_t) + sizeof(uint32_t);
 	}
 
@@ -397,8 +497,8 @@ ErrorCodesGeneral BehaviourStore::removeBehaviour(uint8_t index) {
 	auto type = activeBehaviours[index]->getType();
 
 	LOGBehaviourStoreInfo("deleting behaviour #%u, type: %u", index, static_cast<uint32_t>(type));
-	delete activeBehaviours[index];
-	activeBehaviours[index] = nullptr;
+	freeBehaviour(index);
+	updateMasterHash(index);
 
 	switch (type) {
 		case Behaviour::Type::Switch: {
@@ -423,21 +523,33 @@ ErrorCodesGeneral BehaviourStore::removeBehaviour(uint8_t index) {
 	return ERR_SUCCESS;
 }
 
-uint32_t BehaviourStore::calculateMasterHash() {
-	uint32_t fletch = 0;
-	for (uint8_t i = 0; i < MaxBehaviours; i++) {
-		if (activeBehaviours[i]) {
-			// append index as uint16_t to hash data
-			fletch = Fletcher(&i, sizeof(i), fletch);  // Fletcher() will padd i to the correct width for us.
-			// append behaviour to hash data
-			fletch = Fletcher(activeBehaviours[i]->serialized().data(), activeBehaviours[i]->serializedSize(), fletch);
-		}
+void BehaviourStore::updateMasterHash(uint8_t index) {
+	size_t node = HashTreeLeaves + index;
+	if (activeBehaviours[index]) {
+		// hash index as uint16_t, Fletcher() will padd it to the correct width for us.
+		uint32_t fletch         = Fletcher(&index, sizeof(index));
+		// append behaviour to hash data
+		fletch                  = Fletcher(
+				activeBehaviours[index]->serialized().data(), activeBehaviours[index]->serializedSize(), fletch);
+		hashTree[node]          = fletch;
+		hashTreeWordCount[node] = (sizeof(uint16_t) + activeBehaviours[index]->serializedSize() + 1) / 2;
+	}
+	else {
+		hashTree[node]          = 0;
+		hashTreeWordCount[node] = 0;
+	}
+
+	// combine the hashes of the children, up to the root.
+	for (node /= 2; node > 0; node /= 2) {
+		size_t left             = 2 * node;
+		size_t right            = 2 * node + 1;
+		hashTree[node]          = FletcherCombine(hashTree[left], hashTree[right], 2 * hashTreeWordCount[right]);
+		hashTreeWordCount[node] = hashTreeWordCount[left] + hashTreeWordCount[right];
 	}
-	return fletch;
 }
 
 void BehaviourStore::storeMasterHash() {
-	TYPIFY(STATE_BEHAVIOUR_MASTER_HASH) hash = calculateMasterHash();
+	TYPIFY(STATE_BEHAVIOUR_MASTER_HASH) hash = getMasterHash();
 	LOGBehaviourStoreDebug("storeMasterHash %u", hash);
 	State::getInstance().set(CS_TYPE::STATE_BEHAVIOUR_MASTER_HASH, &hash, sizeof(hash));
 }
@@ -464,10 +576,17 @@ void BehaviourStore::LoadBehavioursFromMemory(CS_TYPE BehaviourCsType) {
 			if (retCode == ERR_SUCCESS) {
 				if (activeBehaviours[iter] != nullptr) {
 					LOGw("Overwrite ind=%u", iter);
-					delete activeBehaviours[iter];
+					freeBehaviour(iter);
+				}
+				Behaviour* behaviour = allocateBehaviour(WireFormat::deserialize<BehaviourType>(data_array, data_size));
+				if (behaviour == nullptr) {
+					LOGw("No space for ind=%u", iter);
+					updateMasterHash(iter);
+					continue;
 				}
-				activeBehaviours[iter] =
-						new BehaviourType(WireFormat::deserialize<BehaviourType>(data_array, data_size));
+				activeBehaviours[iter] = behaviour;
+				activeBehaviours[iter]->updateCachedTimes();
+				updateMasterHash(iter);
 				LOGBehaviourStoreInfo("Loaded behaviour at ind=%u:", iter);
 			}
 		}
@@ -5,13 +5,16 @@
  * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
  */
 
+#include <behaviour/cs_BehaviourConflictResolution.h>
 #include <behaviour/cs_ExtendedSwitchBehaviour.h>
 #include <logging/cs_Logger.h>
 #include <time/cs_SystemTime.h>
 #include <util/cs_WireFormat.h>
 
 ExtendedSwitchBehaviour::ExtendedSwitchBehaviour(SwitchBehaviour coreBehaviour, PresenceCondition extCondition)
-		: SwitchBehaviour(coreBehaviour), extensionCondition(extCondition) {
+		: SwitchBehaviour(coreBehaviour)
+		, extensionPresenceRank(PresenceRelevanceRank(extCondition.predicate))
+		, extensionCondition(extCondition) {
 	typ = Behaviour::Type::Extended;
 }
 
@@ -63,14 +66,21 @@ PresencePredicate ExtendedSwitchBehaviour::currentPresencePredicate() {
 	return extensionIsActive ? presenceCondition.predicate : extensionCondition.predicate;
 }
 
+uint16_t ExtendedSwitchBehaviour::currentPresenceRank() {
+	return extensionIsActive ? presenceRank : extensionPresenceRank;
+}
+
 bool ExtendedSwitchBehaviour::isValid(Time currentTime, PresenceStateDescription currentPresence) {
 	// implementation detail:
 	// SwitchBehaviour::isValid(PresenceStateDescription) caches the last valid presence timestamp.
 	// However, this must be recomputed in the extension anyway because the conditions may differ.
+	prevInRoomTimeStampUpdated           = false;
+	prevExtensionIsValidTimeStampUpdated = false;
 
 	if (SwitchBehaviour::isValid(currentTime)) {
 		// currenttime between from() and until()
-		extensionIsActive = SwitchBehaviour::isValid(currentPresence);
+		// The core presence condition applies here, whatever the previous result was.
+		extensionIsActive = presenceIsValid(currentPresence, presenceCondition.predicate);
 		return extensionIsActive;
 	}
 
@@ -81,13 +91,14 @@ bool ExtendedSwitchBehaviour::isValid(Time currentTime, PresenceStateDescription
 
 	if (extensionCondition.isTrue(currentPresence)) {
 		// in extension and presence match
-		prevExtensionIsValidTimeStamp = SystemTime::now();
+		prevExtensionIsValidTimeStamp        = SystemTime::now();
+		prevExtensionIsValidTimeStampUpdated = true;
 		return true;
 	}
 
 	if (prevExtensionIsValidTimeStamp) {
 		if (CsMath::Interval<uint32_t>(SystemTime::posix(), extensionCondition.timeOut, true)
-					.contains(prevExtensionIsValidTimeStamp->timestamp())) {
+					.ClosureContains(prevExtensionIsValidTimeStamp->timestamp())) {
 			// in extension and presence is invalid,
 			// but we're in the extension's grace period.
 			return true;
@@ -101,6 +112,20 @@ bool ExtendedSwitchBehaviour::isValid(Time currentTime, PresenceStateDescription
 	return false;
 }
 
+std::optional<uint32_t> ExtendedSwitchBehaviour::extensionGracePeriodEnd() {
+	if (!extensionIsActive || !prevExtensionIsValidTimeStamp || prevExtensionIsValidTimeStampUpdated) {
+		return {};
+	}
+	return prevExtensionIsValidTimeStamp->timestamp() + extensionCondition.timeOut;
+}
+
+void ExtendedSwitchBehaviour::fastForward(uint32_t upTime, Time currentTime) {
+	SwitchBehaviour::fastForward(upTime, currentTime);
+	if (prevExtensionIsValidTimeStampUpdated) {
+		prevExtensionIsValidTimeStamp = currentTime;
+	}
+}
+
 void ExtendedSwitchBehaviour::print() {
 	LOGd("## ExtendedSwitchBehaviour:");
 	SwitchBehaviour::print();
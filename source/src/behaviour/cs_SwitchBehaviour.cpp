@@ -5,6 +5,7 @@
  * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
  */
 
+#include <behaviour/cs_BehaviourConflictResolution.h>
 #include <behaviour/cs_SwitchBehaviour.h>
 #include <logging/cs_Logger.h>
 #include <time/cs_SystemTime.h>
@@ -23,11 +24,13 @@ SwitchBehaviour::SwitchBehaviour(
 		TimeOfDay until,
 		PresenceCondition presencecondition)
 		: Behaviour(Behaviour::Type::Switch, intensity, profileid, activeDaysOfWeek, from, until)
-		, presenceCondition(presencecondition) {}
+		, presenceCondition(presencecondition)
+		, presenceRank(PresenceRelevanceRank(presencecondition.predicate)) {}
 
 SwitchBehaviour::SwitchBehaviour(std::array<uint8_t, 1 + 26> arr)
 		: Behaviour(WireFormat::deserialize<Behaviour>(arr.data() + 0, 14))
-		, presenceCondition(WireFormat::deserialize<PresenceCondition>(arr.data() + 14, 13)) {}
+		, presenceCondition(WireFormat::deserialize<PresenceCondition>(arr.data() + 14, 13))
+		, presenceRank(PresenceRelevanceRank(presenceCondition.predicate)) {}
 
 SwitchBehaviour::SerializedDataType SwitchBehaviour::serialize() {
 	SerializedDataType result;
@@ -66,9 +69,23 @@ PresencePredicate SwitchBehaviour::currentPresencePredicate() {
 }
 
 bool SwitchBehaviour::isValid(Time currentTime, PresenceStateDescription currentPresence) {
+	prevInRoomTimeStampUpdated = false;
 	return isValid(currentTime) && isValid(currentPresence);
 }
 
+std::optional<uint32_t> SwitchBehaviour::gracePeriodEnd() {
+	if (!prevInRoomTimeStamp || prevInRoomTimeStampUpdated) {
+		return {};
+	}
+	return *prevInRoomTimeStamp + presenceCondition.timeOut;
+}
+
+void SwitchBehaviour::fastForward(uint32_t upTime, [[maybe_unused]] Time currentTime) {
+	if (prevInRoomTimeStampUpdated) {
+		prevInRoomTimeStamp = upTime;
+	}
+}
+
 bool SwitchBehaviour::gracePeriodForPresenceIsActive() {
 	if (prevInRoomTimeStamp) {
 		return CsMath::Interval(SystemTime::up(), presenceCondition.timeOut, true)
@@ -82,15 +99,21 @@ bool SwitchBehaviour::gracePeriodForPresenceIsActive() {
  * and have the BehaviourStore periodically update it.
  */
 bool SwitchBehaviour::isValid(PresenceStateDescription currentPresence) {
+	return presenceIsValid(currentPresence, currentPresencePredicate());
+}
+
+bool SwitchBehaviour::presenceIsValid(PresenceStateDescription currentPresence, PresencePredicate predicate) {
 	LOGBehaviour_V("isValid(presence) called");
-	if (!requiresPresence() && !requiresAbsence()) {
+	prevInRoomTimeStampUpdated = false;
+	if (!predicate.requiresPresence() && !predicate.requiresAbsence()) {
 		LOGBehaviour_V("vacuously true");
 		return true;
 	}
-	if (requiresPresence()) {
+	if (predicate.requiresPresence()) {
 		if (_isValid(currentPresence)) {
 			// 9-1-2020 TODO Bart @ Arend: this relies on isValid(presence) to be called often.
-			prevInRoomTimeStamp = SystemTime::up();
+			prevInRoomTimeStamp        = SystemTime::up();
+			prevInRoomTimeStampUpdated = true;
 			LOGBehaviour_V("return true");
 			return true;
 		}
@@ -120,11 +143,12 @@ bool SwitchBehaviour::isValid(PresenceStateDescription currentPresence) {
 		LOGBehaviour_V("return false");
 		return false;
 	}
-	if (requiresAbsence()) {
+	if (predicate.requiresAbsence()) {
 		bool notInRoom = _isValid(currentPresence);
 		if (!notInRoom) {
 			// 9-1-2020 TODO Bart @ Arend: this relies on isValid(presence) to be called often.
-			prevInRoomTimeStamp = SystemTime::up();
+			prevInRoomTimeStamp        = SystemTime::up();
+			prevInRoomTimeStampUpdated = true;
 		}
 		if (prevInRoomTimeStamp) {
 			//    		presenceCondition.timeOut = 20;
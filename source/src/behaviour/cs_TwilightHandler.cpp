@@ -34,10 +34,22 @@ cs_ret_code_t TwilightHandler::init() {
 void TwilightHandler::handleEvent(event_t& evt) {
 	switch (evt.type) {
 		case CS_TYPE::EVT_PRESENCE_MUTATION: {
+			invalidate();
 			update();
 			break;
 		}
-		case CS_TYPE::EVT_BEHAVIOURSTORE_MUTATION: {
+		case CS_TYPE::STATE_SUN_TIME: {
+			// The cached from/until of sun based behaviours have to be recomputed.
+			if (_behaviourStore != nullptr) {
+				_behaviourStore->updateCachedTimes();
+			}
+			invalidate();
+			update();
+			break;
+		}
+		case CS_TYPE::EVT_BEHAVIOURSTORE_MUTATION:
+		case CS_TYPE::EVT_TIME_SET: {
+			invalidate();
 			update();
 			break;
 		}
@@ -46,6 +58,7 @@ void TwilightHandler::handleEvent(event_t& evt) {
 			_isActive                      = settings->flags.enabled;
 			LOGTwilightHandlerDebug("TwilightHandler._isActive=%u", _isActive);
 			TEST_PUSH_B(this, _isActive);
+			invalidate();
 			update();
 			break;
 		}
@@ -57,8 +70,15 @@ void TwilightHandler::handleEvent(event_t& evt) {
 }
 
 bool TwilightHandler::update() {
-	Time time              = SystemTime::now();
+	Time time = SystemTime::now();
+	if (_evaluationScheduled && time.isValid() && time.timestamp() >= _evaluatedTimestamp
+		&& time.timestamp() < _nextEvaluationTimestamp) {
+		// The outcome can't have changed since the last evaluation.
+		return false;
+	}
+
 	auto nextIntendedState = computeIntendedState(time);
+	scheduleNextEvaluation(time);
 
 	bool valuechanged      = _currentIntendedState != nextIntendedState;
 	_currentIntendedState  = nextIntendedState;
@@ -67,6 +87,28 @@ bool TwilightHandler::update() {
 	return valuechanged;
 }
 
+void TwilightHandler::invalidate() {
+	_evaluationScheduled = false;
+}
+
+void TwilightHandler::scheduleNextEvaluation(Time currentTime) {
+	if (!currentTime.isValid() || _behaviourStore == nullptr) {
+		_evaluationScheduled = false;
+		return;
+	}
+
+	uint32_t now             = currentTime.timestamp();
+	_evaluationScheduled     = true;
+	_evaluatedTimestamp      = now;
+	_nextEvaluationTimestamp = UINT32_MAX;
+	for (uint8_t index = 0; index < BehaviourStore::MaxBehaviours; ++index) {
+		if (TwilightBehaviour* behaviour = _behaviourStore->getTwilightBehaviour(index)) {
+			uint32_t boundary        = now + behaviour->secondsUntilNextBoundary(currentTime);
+			_nextEvaluationTimestamp = CsMath::min(_nextEvaluationTimestamp, boundary);
+		}
+	}
+}
+
 std::optional<uint8_t> TwilightHandler::computeIntendedState(Time currentTime) {
 	if (!_isActive || !currentTime.isValid() || _behaviourStore == nullptr) {
 		return {};
@@ -78,13 +120,11 @@ std::optional<uint8_t> TwilightHandler::computeIntendedState(Time currentTime) {
 	uint8_t winningValue           = 0xFF;
 
 	// loop through all twilight behaviours searching for valid ones.
-	for (auto& b : _behaviourStore->getActiveBehaviours()) {
-		if (TwilightBehaviour* behaviour = dynamic_cast<TwilightBehaviour*>(b)) {
-			// cast to twilight behaviour succesful.
+	for (uint8_t index = 0; index < BehaviourStore::MaxBehaviours; ++index) {
+		if (TwilightBehaviour* behaviour = _behaviourStore->getTwilightBehaviour(index)) {
 			if (behaviour->isValid(currentTime)) {
-				// cache some values.
-				uint32_t candidateFromTimeOfDay  = behaviour->from();
-				uint32_t candidateUntilTimeOfDay = behaviour->until();
+				uint32_t candidateFromTimeOfDay  = behaviour->cachedFrom();
+				uint32_t candidateUntilTimeOfDay = behaviour->cachedUntil();
 
 				bool okToOverwriteWinningValue;
 
@@ -14,7 +14,11 @@
 #define LOGAdvertiserDebug LOGvv
 #define LOGAdvertiserVerbose LOGvv
 
-Advertiser::Advertiser() {
+Advertiser::Advertiser()
+		: _restartRoutine([this]() {
+			onRestart();
+			return Coroutine::delayS(0);
+		}) {
 	_stack                        = &(Stack::getInstance());
 	_advData.adv_data.p_data      = nullptr;
 	_advData.adv_data.len         = 0;
@@ -685,7 +689,7 @@ void Advertiser::onConnect(const ble_connected_t& connectedData) {
 		// may occur. The workaround is After pulling the event BLE_GAP_EVT_CONNECTED, pull events until sd_ble_evt_get
 		// returns NRF_ERROR_NOT_FOUND. This bug is present in all released SoftDevices since 6.0.0. Please let me know
 		// if you are satisfied with the workaround.
-		_startOnNextTick = true;
+		_restartRoutine.start(TICK_INTERVAL_MS);
 	}
 }
 
@@ -702,13 +706,10 @@ void Advertiser::onConnectOutgoing() {
 	}
 }
 
-void Advertiser::onTick() {
-	if (_startOnNextTick) {
-		_startOnNextTick = false;
-
-		if (_wantAdvertising) {
-			startAdvertising();
-		}
+void Advertiser::onRestart() {
+	_restartRoutine.stop();
+	if (_wantAdvertising) {
+		startAdvertising();
 	}
 }
 
@@ -769,10 +770,6 @@ void Advertiser::handleEvent(event_t& event) {
 			updateAdvertisementData();
 			break;
 		}
-		case CS_TYPE::EVT_TICK: {
-			onTick();
-			break;
-		}
 		default: {
 		}
 	}
@@ -34,6 +34,11 @@ cs_ret_code_t CrownstoneCentral::init() {
 	if (retCode != ERR_SUCCESS) {
 		return retCode;
 	}
+	_timeoutRoutine.action = [this]() {
+		_timeoutRoutine.stop();
+		onTimeout();
+		return Coroutine::delayS(0);
+	};
 	reset();
 	listen();
 	return ERR_SUCCESS;
@@ -225,11 +230,11 @@ bool CrownstoneCentral::isBusy() {
 }
 
 void CrownstoneCentral::startTimeoutTimer(uint16_t timeoutMs) {
-	_timeoutCountDown = timeoutMs / TICK_INTERVAL_MS;
+	_timeoutRoutine.start(timeoutMs);
 }
 
 void CrownstoneCentral::stopTimeoutTimer() {
-	_timeoutCountDown = 0;
+	_timeoutRoutine.stop();
 }
 
 void CrownstoneCentral::setStep(ConnectSteps step) {
@@ -765,14 +770,6 @@ void CrownstoneCentral::handleEvent(event_t& event) {
 			onMacAddress(*result);
 			break;
 		}
-		case CS_TYPE::EVT_TICK: {
-			if (_timeoutCountDown != 0) {
-				if (--_timeoutCountDown == 0) {
-					onTimeout();
-				}
-			}
-			break;
-		}
 		default: {
 			break;
 		}
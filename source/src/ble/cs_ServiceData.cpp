@@ -23,7 +23,13 @@
 //#define PRINT_DEBUG_EXTERNAL_DATA
 //#define PRINT_VERBOSE_EXTERNAL_DATA
 
-ServiceData::ServiceData() {
+ServiceData::ServiceData()
+		: _sendMeshStateRoutine([this]() {
+			sendMeshState(false);
+			return Coroutine::delayMs(
+					MESH_SEND_STATE_INTERVAL_MS
+					+ RNG::getInstance().getRandom8() * MESH_SEND_STATE_INTERVAL_MS_VARIATION / 255);
+		}) {
 	//	_stateErrors.asInt = 0;
 	// Initialize the service data
 	memset(_serviceData.array, 0, sizeof(_serviceData.array));
@@ -37,6 +43,7 @@ void ServiceData::init(uint8_t deviceType) {
 	_operationMode = getOperationMode(mode);
 
 	_externalStates.init();
+	_sendMeshStateRoutine.start(MESH_SEND_STATE_INTERVAL_MS);
 
 	// Init flags
 	_flags.asInt                = 0;
@@ -392,7 +399,7 @@ void ServiceData::handleEvent(event_t& event) {
 			updateSwitchState(state->asInt);
 			//			sendMeshState(true);
 			// Abuse the state update timeout.
-			_sendStateCountdown = 300 / TICK_INTERVAL_MS;
+			_sendMeshStateRoutine.start(300);
 			break;
 		}
 		case CS_TYPE::STATE_ACCUMULATED_ENERGY: {
@@ -443,15 +450,8 @@ void ServiceData::handleEvent(event_t& event) {
 			_flags.flags.behaviourOverridden = *reinterpret_cast<TYPIFY(EVT_BEHAVIOUR_OVERRIDDEN)*>(event.data);
 			break;
 		}
-		case CS_TYPE::EVT_TICK: {
-			TYPIFY(EVT_TICK) tickCount = *(TYPIFY(EVT_TICK)*)event.data;
-			_externalStates.tick(tickCount);
-			if (_sendStateCountdown-- == 0) {
-				uint32_t randMs = MESH_SEND_STATE_INTERVAL_MS
-								  + RNG::getInstance().getRandom8() * MESH_SEND_STATE_INTERVAL_MS_VARIATION / 255;
-				_sendStateCountdown = randMs / TICK_INTERVAL_MS;
-				sendMeshState(false);
-			}
+		case CS_TYPE::EVT_TICK_SECOND: {
+			_externalStates.tickSecond();
 			break;
 		}
 		case CS_TYPE::EVT_STATE_EXTERNAL_STONE: {
@@ -84,6 +84,7 @@ CS_TYPE toCsType(uint16_t type) {
 		case CS_TYPE::STATE_MICROAPP:
 		case CS_TYPE::STATE_SOFT_ON_SPEED:
 		case CS_TYPE::STATE_DEFAULT_DIM_VALUE:
+		case CS_TYPE::STATE_JOURNAL:
 		case CS_TYPE::STATE_HUB_MODE:
 		case CS_TYPE::STATE_UART_KEY:
 		case CS_TYPE::STATE_ASSET_FILTERS_VERSION:
@@ -141,6 +142,7 @@ CS_TYPE toCsType(uint16_t type) {
 		case CS_TYPE::EVT_CS_CENTRAL_READ_RESULT:
 		case CS_TYPE::EVT_CS_CENTRAL_WRITE_RESULT:
 		case CS_TYPE::EVT_BROWNOUT_IMPENDING:
+		case CS_TYPE::EVT_CURRENT_MEASURED:
 		case CS_TYPE::EVT_SESSION_DATA_SET:
 		case CS_TYPE::EVT_DIMMER_FORCED_OFF:
 		case CS_TYPE::EVT_SWITCH_FORCED_OFF:
@@ -150,6 +152,7 @@ CS_TYPE toCsType(uint16_t type) {
 		case CS_TYPE::EVT_DIMMER_TEMP_ABOVE_THRESHOLD:
 		case CS_TYPE::EVT_DIMMER_TEMP_OK:
 		case CS_TYPE::EVT_TICK:
+		case CS_TYPE::EVT_TICK_SECOND:
 		case CS_TYPE::EVT_TIME_SET:
 		case CS_TYPE::EVT_DIMMER_POWERED:
 		case CS_TYPE::CMD_DIMMING_ALLOWED:
@@ -249,6 +252,7 @@ CS_TYPE toCsType(uint16_t type) {
 		case CS_TYPE::EVT_MESH_TOPO_MAC_RESULT:
 		case CS_TYPE::CMD_MESH_TOPO_RESET:
 		case CS_TYPE::CMD_MESH_TOPO_GET_RSSI:
+		case CS_TYPE::CMD_MESH_TOPO_GET_MATRIX:
 		case CS_TYPE::EVT_TWI_INIT:
 		case CS_TYPE::EVT_TWI_WRITE:
 		case CS_TYPE::EVT_TWI_READ:
@@ -351,6 +355,7 @@ size16_t TypeSize(CS_TYPE const& type) {
 		case CS_TYPE::STATE_MICROAPP: return sizeof(TYPIFY(STATE_MICROAPP));
 		case CS_TYPE::STATE_SOFT_ON_SPEED: return sizeof(TYPIFY(STATE_SOFT_ON_SPEED));
 		case CS_TYPE::STATE_DEFAULT_DIM_VALUE: return sizeof(TYPIFY(STATE_DEFAULT_DIM_VALUE));
+		case CS_TYPE::STATE_JOURNAL: return sizeof(TYPIFY(STATE_JOURNAL));
 		case CS_TYPE::STATE_HUB_MODE: return sizeof(TYPIFY(STATE_HUB_MODE));
 		case CS_TYPE::STATE_UART_KEY: return ENCRYPTION_KEY_LENGTH;
 		case CS_TYPE::STATE_ASSET_FILTERS_VERSION: return sizeof(TYPIFY(STATE_ASSET_FILTERS_VERSION));
@@ -412,6 +417,7 @@ size16_t TypeSize(CS_TYPE const& type) {
 		case CS_TYPE::EVT_CS_CENTRAL_READ_RESULT: return sizeof(TYPIFY(EVT_CS_CENTRAL_READ_RESULT));
 		case CS_TYPE::EVT_CS_CENTRAL_WRITE_RESULT: return sizeof(TYPIFY(EVT_CS_CENTRAL_WRITE_RESULT));
 		case CS_TYPE::EVT_BROWNOUT_IMPENDING: return 0;
+		case CS_TYPE::EVT_CURRENT_MEASURED: return sizeof(TYPIFY(EVT_CURRENT_MEASURED));
 		case CS_TYPE::EVT_SESSION_DATA_SET: return sizeof(TYPIFY(EVT_SESSION_DATA_SET));
 		case CS_TYPE::EVT_DIMMER_FORCED_OFF: return 0;
 		case CS_TYPE::EVT_SWITCH_FORCED_OFF: return 0;
@@ -421,6 +427,7 @@ size16_t TypeSize(CS_TYPE const& type) {
 		case CS_TYPE::EVT_DIMMER_TEMP_ABOVE_THRESHOLD: return 0;
 		case CS_TYPE::EVT_DIMMER_TEMP_OK: return 0;
 		case CS_TYPE::EVT_TICK: return sizeof(uint32_t);
+		case CS_TYPE::EVT_TICK_SECOND: return sizeof(uint32_t);
 		case CS_TYPE::EVT_TIME_SET: return sizeof(uint32_t);
 		case CS_TYPE::EVT_DIMMER_POWERED: return sizeof(TYPIFY(EVT_DIMMER_POWERED));
 		case CS_TYPE::CMD_DIMMING_ALLOWED: return sizeof(TYPIFY(CMD_DIMMING_ALLOWED));
@@ -522,6 +529,7 @@ size16_t TypeSize(CS_TYPE const& type) {
 		case CS_TYPE::EVT_MESH_TOPO_MAC_RESULT: return sizeof(TYPIFY(EVT_MESH_TOPO_MAC_RESULT));
 		case CS_TYPE::CMD_MESH_TOPO_RESET: return 0;
 		case CS_TYPE::CMD_MESH_TOPO_GET_RSSI: return sizeof(TYPIFY(CMD_MESH_TOPO_GET_RSSI));
+		case CS_TYPE::CMD_MESH_TOPO_GET_MATRIX: return 0;
 		case CS_TYPE::EVT_TWI_INIT: return sizeof(TYPIFY(EVT_TWI_INIT));
 		case CS_TYPE::EVT_TWI_WRITE: return sizeof(TYPIFY(EVT_TWI_WRITE));
 		case CS_TYPE::EVT_TWI_READ: return sizeof(TYPIFY(EVT_TWI_READ));
@@ -654,6 +662,7 @@ bool hasMultipleIds(CS_TYPE const& type) {
 		case CS_TYPE::EVT_CS_CENTRAL_READ_RESULT:
 		case CS_TYPE::EVT_CS_CENTRAL_WRITE_RESULT:
 		case CS_TYPE::EVT_BROWNOUT_IMPENDING:
+		case CS_TYPE::EVT_CURRENT_MEASURED:
 		case CS_TYPE::EVT_SESSION_DATA_SET:
 		case CS_TYPE::EVT_DIMMER_FORCED_OFF:
 		case CS_TYPE::EVT_SWITCH_FORCED_OFF:
@@ -663,6 +672,7 @@ bool hasMultipleIds(CS_TYPE const& type) {
 		case CS_TYPE::EVT_DIMMER_TEMP_ABOVE_THRESHOLD:
 		case CS_TYPE::EVT_DIMMER_TEMP_OK:
 		case CS_TYPE::EVT_TICK:
+		case CS_TYPE::EVT_TICK_SECOND:
 		case CS_TYPE::EVT_TIME_SET:
 		case CS_TYPE::EVT_DIMMER_POWERED:
 		case CS_TYPE::CMD_DIMMING_ALLOWED:
@@ -762,6 +772,7 @@ bool hasMultipleIds(CS_TYPE const& type) {
 		case CS_TYPE::EVT_MESH_TOPO_MAC_RESULT:
 		case CS_TYPE::CMD_MESH_TOPO_RESET:
 		case CS_TYPE::CMD_MESH_TOPO_GET_RSSI:
+		case CS_TYPE::CMD_MESH_TOPO_GET_MATRIX:
 		case CS_TYPE::EVT_TWI_INIT:
 		case CS_TYPE::EVT_TWI_WRITE:
 		case CS_TYPE::EVT_TWI_READ:
@@ -773,6 +784,7 @@ bool hasMultipleIds(CS_TYPE const& type) {
 		case CS_TYPE::CMD_RESOLVE_ASYNC_CONTROL_COMMAND:
 		case CS_TYPE::CMD_SEND_ASYNC_RESULT_TO_BLE: return false;
 		case CS_TYPE::STATE_BEHAVIOUR_RULE:
+		case CS_TYPE::STATE_JOURNAL:
 		case CS_TYPE::STATE_TWILIGHT_RULE:
 		case CS_TYPE::STATE_EXTENDED_BEHAVIOUR_RULE:
 		case CS_TYPE::CONFIG_IBEACON_MAJOR:
@@ -868,6 +880,7 @@ bool removeOnFactoryReset(CS_TYPE const& type, cs_state_id_t id) {
 		case CS_TYPE::STATE_MICROAPP:
 		case CS_TYPE::STATE_SOFT_ON_SPEED:
 		case CS_TYPE::STATE_DEFAULT_DIM_VALUE:
+		case CS_TYPE::STATE_JOURNAL:
 		case CS_TYPE::STATE_HUB_MODE:
 		case CS_TYPE::STATE_UART_KEY:
 		case CS_TYPE::STATE_ASSET_FILTERS_VERSION:
@@ -925,6 +938,7 @@ bool removeOnFactoryReset(CS_TYPE const& type, cs_state_id_t id) {
 		case CS_TYPE::EVT_CS_CENTRAL_READ_RESULT:
 		case CS_TYPE::EVT_CS_CENTRAL_WRITE_RESULT:
 		case CS_TYPE::EVT_BROWNOUT_IMPENDING:
+		case CS_TYPE::EVT_CURRENT_MEASURED:
 		case CS_TYPE::EVT_SESSION_DATA_SET:
 		case CS_TYPE::EVT_DIMMER_FORCED_OFF:
 		case CS_TYPE::EVT_SWITCH_FORCED_OFF:
@@ -934,6 +948,7 @@ bool removeOnFactoryReset(CS_TYPE const& type, cs_state_id_t id) {
 		case CS_TYPE::EVT_DIMMER_TEMP_ABOVE_THRESHOLD:
 		case CS_TYPE::EVT_DIMMER_TEMP_OK:
 		case CS_TYPE::EVT_TICK:
+		case CS_TYPE::EVT_TICK_SECOND:
 		case CS_TYPE::EVT_TIME_SET:
 		case CS_TYPE::EVT_DIMMER_POWERED:
 		case CS_TYPE::CMD_DIMMING_ALLOWED:
@@ -1033,6 +1048,7 @@ bool removeOnFactoryReset(CS_TYPE const& type, cs_state_id_t id) {
 		case CS_TYPE::EVT_MESH_TOPO_MAC_RESULT:
 		case CS_TYPE::CMD_MESH_TOPO_RESET:
 		case CS_TYPE::CMD_MESH_TOPO_GET_RSSI:
+		case CS_TYPE::CMD_MESH_TOPO_GET_MATRIX:
 		case CS_TYPE::EVT_TWI_INIT:
 		case CS_TYPE::EVT_TWI_WRITE:
 		case CS_TYPE::EVT_TWI_READ:
@@ -1121,6 +1137,7 @@ EncryptionAccessLevel getUserAccessLevelSet(CS_TYPE const& type) {
 		case CS_TYPE::STATE_SUN_TIME:
 		case CS_TYPE::STATE_MESH_IV_INDEX:
 		case CS_TYPE::STATE_MESH_SEQ_NUMBER:
+		case CS_TYPE::STATE_JOURNAL:
 		case CS_TYPE::STATE_MESH_IV_INDEX_V5:
 		case CS_TYPE::STATE_MESH_SEQ_NUMBER_V5:
 		case CS_TYPE::STATE_MICROAPP:
@@ -1185,6 +1202,7 @@ EncryptionAccessLevel getUserAccessLevelSet(CS_TYPE const& type) {
 		case CS_TYPE::EVT_CS_CENTRAL_READ_RESULT:
 		case CS_TYPE::EVT_CS_CENTRAL_WRITE_RESULT:
 		case CS_TYPE::EVT_BROWNOUT_IMPENDING:
+		case CS_TYPE::EVT_CURRENT_MEASURED:
 		case CS_TYPE::EVT_CHIP_TEMP_ABOVE_THRESHOLD:
 		case CS_TYPE::EVT_CHIP_TEMP_OK:
 		case CS_TYPE::EVT_CURRENT_USAGE_ABOVE_THRESHOLD_DIMMER:
@@ -1224,6 +1242,7 @@ EncryptionAccessLevel getUserAccessLevelSet(CS_TYPE const& type) {
 		case CS_TYPE::EVT_SWITCH_FORCED_OFF:
 		case CS_TYPE::CMD_LOCK_SWITCH:
 		case CS_TYPE::EVT_TICK:
+		case CS_TYPE::EVT_TICK_SECOND:
 		case CS_TYPE::EVT_TIME_SET:
 		case CS_TYPE::CMD_ADD_BEHAVIOUR:
 		case CS_TYPE::CMD_REPLACE_BEHAVIOUR:
@@ -1287,6 +1306,7 @@ EncryptionAccessLevel getUserAccessLevelSet(CS_TYPE const& type) {
 		case CS_TYPE::EVT_MESH_TOPO_MAC_RESULT:
 		case CS_TYPE::CMD_MESH_TOPO_RESET:
 		case CS_TYPE::CMD_MESH_TOPO_GET_RSSI:
+		case CS_TYPE::CMD_MESH_TOPO_GET_MATRIX:
 		case CS_TYPE::EVT_TWI_INIT:
 		case CS_TYPE::EVT_TWI_WRITE:
 		case CS_TYPE::EVT_TWI_READ:
@@ -1378,6 +1398,7 @@ EncryptionAccessLevel getUserAccessLevelGet(CS_TYPE const& type) {
 		case CS_TYPE::CONFIG_KEY_LOCALIZATION:
 		case CS_TYPE::CONFIG_DO_NOT_USE:
 		case CS_TYPE::STATE_BEHAVIOUR_RULE:
+		case CS_TYPE::STATE_JOURNAL:
 		case CS_TYPE::STATE_TWILIGHT_RULE:
 		case CS_TYPE::STATE_EXTENDED_BEHAVIOUR_RULE:
 		case CS_TYPE::STATE_FACTORY_RESET:
@@ -1438,6 +1459,7 @@ EncryptionAccessLevel getUserAccessLevelGet(CS_TYPE const& type) {
 		case CS_TYPE::EVT_CS_CENTRAL_READ_RESULT:
 		case CS_TYPE::EVT_CS_CENTRAL_WRITE_RESULT:
 		case CS_TYPE::EVT_BROWNOUT_IMPENDING:
+		case CS_TYPE::EVT_CURRENT_MEASURED:
 		case CS_TYPE::EVT_CHIP_TEMP_ABOVE_THRESHOLD:
 		case CS_TYPE::EVT_CHIP_TEMP_OK:
 		case CS_TYPE::EVT_CURRENT_USAGE_ABOVE_THRESHOLD_DIMMER:
@@ -1477,6 +1499,7 @@ EncryptionAccessLevel getUserAccessLevelGet(CS_TYPE const& type) {
 		case CS_TYPE::EVT_SWITCH_FORCED_OFF:
 		case CS_TYPE::CMD_LOCK_SWITCH:
 		case CS_TYPE::EVT_TICK:
+		case CS_TYPE::EVT_TICK_SECOND:
 		case CS_TYPE::EVT_TIME_SET:
 		case CS_TYPE::CMD_ADD_BEHAVIOUR:
 		case CS_TYPE::CMD_REPLACE_BEHAVIOUR:
@@ -1540,6 +1563,7 @@ EncryptionAccessLevel getUserAccessLevelGet(CS_TYPE const& type) {
 		case CS_TYPE::EVT_MESH_TOPO_MAC_RESULT:
 		case CS_TYPE::CMD_MESH_TOPO_RESET:
 		case CS_TYPE::CMD_MESH_TOPO_GET_RSSI:
+		case CS_TYPE::CMD_MESH_TOPO_GET_MATRIX:
 		case CS_TYPE::EVT_TWI_INIT:
 		case CS_TYPE::EVT_TWI_WRITE:
 		case CS_TYPE::EVT_TWI_READ:
@@ -60,6 +60,7 @@
 #include <structs/buffer/cs_EncryptedBuffer.h>
 #include <time/cs_SystemTime.h>
 #include <uart/cs_UartHandler.h>
+#include <util/cs_CoroutineScheduler.h>
 #include <util/cs_Utils.h>
 
 extern "C" {
@@ -180,12 +181,31 @@ Crownstone::Crownstone(boards_config_t& board)
 		_memTest(board)
 		,
 #endif
-		_mainTimerId(NULL)
+		_watchdogRoutine(
+				[this]() {
+					kickWatchdog();
+					return Coroutine::delayMs(WATCHDOG_KICK_INTERVAL_MS);
+				},
+				WATCHDOG_KICK_JITTER_MS)
+		, _temperatureRoutine(
+				[this]() {
+					TYPIFY(STATE_TEMPERATURE) temperature = getTemperature();
+					_state->set(CS_TYPE::STATE_TEMPERATURE, &temperature, sizeof(temperature));
+					return Coroutine::delayMs(TEMPERATURE_STATE_INTERVAL_MS);
+				},
+				TEMPERATURE_STATE_JITTER_MS)
+		, _loadStatsRoutine(
+				[]() {
+					printLoadStats();
+					return Coroutine::delayMs(LOAD_STATS_INTERVAL_MS);
+				},
+				LOAD_STATS_JITTER_MS)
+		, _clearGpRegRetRoutine([this]() {
+			GpRegRet::clearAll();
+			_clearGpRegRetRoutine.stop();
+			return Coroutine::delayS(0);
+		})
 		, _operationMode(OperationMode::OPERATION_MODE_UNINITIALIZED) {
-	// TODO: can be replaced by: APP_TIMER_DEF(_mainTimerId); Though that makes _mainTimerId a static variable.
-	_mainTimerData = {{0}};
-	_mainTimerId   = &_mainTimerData;
-
 	// TODO (Anne @Arend). Yes, you can call this in constructor. All non-virtual member functions can be called as
 	// well.
 	this->listen();
@@ -267,10 +287,6 @@ void Crownstone::init1() {
 	configure();
 	LOG_FLUSH();
 
-	LOGi(FMT_CREATE "timer");
-	_timer->createSingleShot(_mainTimerId, (app_timer_timeout_handler_t)Crownstone::staticTick);
-	LOG_FLUSH();
-
 	LOGi(FMT_HEADER "mode");
 	switchMode(_operationMode);
 	LOG_FLUSH();
@@ -368,6 +384,12 @@ void Crownstone::initDrivers1() {
 		switchState.state.relay  = 1;
 		_state->set(CS_TYPE::STATE_SWITCH_STATE, &switchState, sizeof(switchState));
 	}
+	else if (IpcRamBluenet::getInstance().hasWarmBootData()) {
+		// The latest switch state may not have been written to flash before the reset.
+		TYPIFY(STATE_SWITCH_STATE) switchState;
+		switchState.asInt = IpcRamBluenet::getInstance().getWarmBootData().switchState;
+		_state->set(CS_TYPE::STATE_SWITCH_STATE, &switchState, sizeof(switchState));
+	}
 
 	LOGi(FMT_INIT "command handler");
 	_commandHandler->init(&_boardsConfig);
@@ -717,8 +739,19 @@ void Crownstone::startUp() {
 	}
 
 	// Start ticking main and services.
-	scheduleNextTick();
+	_watchdogRoutine.start();
+	_temperatureRoutine.start();
+	_loadStatsRoutine.start();
+	_clearGpRegRetRoutine.start(CS_CLEAR_GPREGRET_COUNTER_TIMEOUT_S * 1000);
 	_systemTime.init();
+	if (IpcRamBluenet::getInstance().hasWarmBootData()) {
+		const bluenet_ipc_warm_boot_data_t& warmBootData = IpcRamBluenet::getInstance().getWarmBootData();
+		high_resolution_time_stamp_t stamp;
+		stamp.posix_s  = warmBootData.posixTime;
+		stamp.posix_ms = warmBootData.posixTimeMs;
+		stamp.version  = warmBootData.timeVersion;
+		_systemTime.restoreTime(stamp);
+	}
 
 	// The rest we only execute if we are in normal operation.
 	// During other operation modes, most of the crownstone's functionality is disabled.
@@ -779,6 +812,7 @@ void Crownstone::startUp() {
 #if BUILD_MEM_USAGE_TEST == 1
 	if (_operationMode == OperationMode::OPERATION_MODE_NORMAL) {
 		_memTest.start();
+		_memTestTickRequest.request();
 	}
 #endif
 
@@ -795,37 +829,9 @@ void Crownstone::increaseResetCounter() {
 	_state->set(CS_TYPE::STATE_RESET_COUNTER, &resetCounter, sizeof(resetCounter));
 }
 
-void Crownstone::tick() {
+void Crownstone::kickWatchdog() {
 	updateHeapStats();
-	if (_tickCount % (60 * 1000 / TICK_INTERVAL_MS) == 0) {
-		printLoadStats();
-	}
-
-	if (_tickCount % (500 / TICK_INTERVAL_MS) == 0) {
-		TYPIFY(STATE_TEMPERATURE) temperature = getTemperature();
-		_state->set(CS_TYPE::STATE_TEMPERATURE, &temperature, sizeof(temperature));
-	}
-
-	if (!_clearedGpRegRetCount && _tickCount == (CS_CLEAR_GPREGRET_COUNTER_TIMEOUT_S * 1000 / TICK_INTERVAL_MS)) {
-		GpRegRet::clearAll();
-		_clearedGpRegRetCount = true;
-	}
-
-#if BUILD_MEM_USAGE_TEST == 1
-	_memTest.onTick();
-#endif
-
 	Watchdog::kick();
-
-	event_t event(CS_TYPE::EVT_TICK, &_tickCount, sizeof(_tickCount));
-	event.dispatch();
-	++_tickCount;
-
-	scheduleNextTick();
-}
-
-void Crownstone::scheduleNextTick() {
-	Timer::getInstance().start(_mainTimerId, MS_TO_TICKS(TICK_INTERVAL_MS), this);
 }
 
 void Crownstone::run() {
@@ -935,6 +941,12 @@ void Crownstone::handleEvent(event_t& event) {
 			event.result.returnCode = ERR_SUCCESS;
 			break;
 		}
+#if BUILD_MEM_USAGE_TEST == 1
+		case CS_TYPE::EVT_TICK: {
+			_memTest.onTick();
+			break;
+		}
+#endif
 		default: LOGnone("Event: $typeName(%u)", to_underlying_type(event.type));
 	}
 
@@ -981,6 +993,19 @@ void Crownstone::printLoadStats() {
 	__attribute__((unused)) uint16_t maxUsed     = app_sched_queue_utilization_get();
 	__attribute__((unused)) uint16_t currentFree = app_sched_queue_space_get();
 	LOGi("Scheduler current free=%u max used=%u", currentFree, maxUsed);
+
+	// Log number of timer wake ups, since the previous call.
+	static uint32_t prevWakeUpCount = 0;
+	uint32_t wakeUpCount            = CoroutineScheduler::getInstance().getWakeUpCount();
+	LOGi("Coroutine wake ups=%u", wakeUpCount - prevWakeUpCount);
+	prevWakeUpCount = wakeUpCount;
+
+	// Log timing of the dimmer value updates.
+	__attribute__((unused)) pwm_stats_t pwmStats = PWM::getInstance().getStats();
+	LOGi("PWM max latency=%u us missed periods=%u coalesced=%u",
+		 pwmStats.maxLatencyUs,
+		 pwmStats.missedPeriodCount,
+		 pwmStats.coalescedCount);
 }
 
 /*
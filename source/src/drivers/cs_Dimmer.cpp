@@ -95,17 +95,21 @@ void Dimmer::start() {
 }
 
 bool Dimmer::set(uint8_t intensity, bool fade) {
+	return set(intensity, fade, _softOnSpeed);
+}
+
+bool Dimmer::set(uint8_t intensity, bool fade, uint8_t fadeStepSize) {
 	if (!_hasDimmer) {
 		return false;
 	}
-	LOGd("set %u fade=%u", intensity, fade);
+	LOGd("set %u fade=%u stepSize=%u", intensity, fade, fadeStepSize);
 	assert(_initialized == true, "Not initialized");
 	if (!_enabled && intensity > 0) {
 		LOGd("Dimmer not enabled");
 		return false;
 	}
 
-	uint8_t speed = fade ? _softOnSpeed : 100;
+	uint8_t speed = fade ? fadeStepSize : 100;
 
 	TEST_PUSH_EXPR_D(this, "intensity", intensity);
 	PWM::getInstance().setValue(0, intensity, speed);
@@ -113,6 +117,17 @@ bool Dimmer::set(uint8_t intensity, bool fade) {
 	return true;
 }
 
+uint8_t Dimmer::getSoftOnSpeed() {
+	return _softOnSpeed;
+}
+
+uint8_t Dimmer::getCurrentIntensity() {
+	if (!_hasDimmer || !_initialized) {
+		return 0;
+	}
+	return PWM::getInstance().getValue(0);
+}
+
 void Dimmer::setSoftOnSpeed(uint8_t speed) {
 	if (!_hasDimmer) {
 		return;
@@ -28,6 +28,7 @@ Gpio::Gpio() : EventListener() {
  *
  * Interrupts are not put on the app scheduler, but instead pins are marked to have an interrupt.
  * Each tick, all pins are checked whether they are marked to have an interrupt. If so, EVT_GPIO_UPDATE is dispatched.
+ * The tick is only requested while any pin is configured to sense.
  */
 void Gpio::init(const boards_config_t& board) {
 
@@ -305,6 +306,16 @@ void Gpio::tick() {
 	}
 }
 
+void Gpio::updateTickRequest() {
+	for (uint8_t i = 0; i < TOTAL_PIN_COUNT; ++i) {
+		if (_pins[i].direction == GpioDirection::SENSE) {
+			_tickRequest.request();
+			return;
+		}
+	}
+	_tickRequest.release();
+}
+
 void Gpio::handleEvent(event_t& event) {
 	switch (event.type) {
 		case CS_TYPE::EVT_GPIO_INIT: {
@@ -313,6 +324,7 @@ void Gpio::handleEvent(event_t& event) {
 			GpioDirection direction    = (GpioDirection)gpio.direction;
 			GpioPullResistor pull      = (GpioPullResistor)gpio.pull;
 			event.result.returnCode    = configure(gpio.pinIndex, direction, pull, polarity);
+			updateTickRequest();
 			break;
 		}
 		case CS_TYPE::EVT_GPIO_WRITE: {
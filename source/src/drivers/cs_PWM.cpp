@@ -32,6 +32,12 @@
 #define ZERO_CROSSING_CHANNEL_IDX 3
 #define ZERO_CROSSING_CAPTURE_TASK NRF_TIMER_TASK_CAPTURE3
 
+// Timer channel to capture the timer counter in the period end interrupt.
+#define INTERRUPT_CHANNEL_IDX 2
+#define INTERRUPT_CAPTURE_TASK NRF_TIMER_TASK_CAPTURE2
+
+static_assert(CS_PWM_MAX_CHANNELS <= INTERRUPT_CHANNEL_IDX, "Timer channel is used by a PWM channel");
+
 // Set to true to enable gpio debug.
 #define PWM_GPIO_DEBUG false
 
@@ -97,6 +103,10 @@ uint32_t PWM::init(const pwm_config_t& config) {
 	_zeroCrossDeviationIntegral = 0;
 	_zeroCrossTicksDeviationAvg = 0;
 
+	for (auto& command : _commands) {
+		command.store(0);
+	}
+
 	PWM_TEST_PIN_INIT;
 
 	_initialized = true;
@@ -170,14 +180,6 @@ uint32_t PWM::start(bool onZeroCrossing) {
 	return ERR_SUCCESS;
 }
 
-void onTimerEnd(void* p_data, uint16_t len) {
-	PWM::getInstance().onPeriodEnd();
-}
-
-void PWM::onPeriodEnd() {
-	updateValues();
-}
-
 void PWM::start() {
 	PWM_TEST_PIN_TOGGLE;
 
@@ -202,7 +204,7 @@ void PWM::setValue(uint8_t channel, uint8_t newValue, uint8_t stepSize) {
 		return;
 	}
 
-	if (channel > CS_PWM_MAX_CHANNELS) {
+	if (channel >= CS_PWM_MAX_CHANNELS) {
 		LOGe("Invalid channel %u", channel);
 		return;
 	}
@@ -217,15 +219,30 @@ void PWM::setValue(uint8_t channel, uint8_t newValue, uint8_t stepSize) {
 		stepSize = 1;
 	}
 
-	// Simply store the target value, don't actually set it,
-	// that will be done by updateValues().
-	_targetValues[channel] = newValue;
-	_stepSize[channel]     = stepSize;
+	// Hand the value over to the interrupt, which sets the target value.
+	// A value that hasn't been taken yet is simply replaced: only the latest value matters.
+	uint32_t command = COMMAND_VALID | (stepSize << 8) | newValue;
+	if (_commands[channel].exchange(command) != 0) {
+		_coalescedCount++;
+	}
+}
 
-	// Unless value is 0 or 100 and speed 100
-	// In that case we can and should set the value immediately, as it might be for to safety.
-	if ((newValue == 0 || newValue == _maxValue) && stepSize >= _maxValue) {
-		setValue(channel, newValue);
+void PWM::takeCommands() {
+	for (uint8_t channel = 0; channel < _config.channelCount; ++channel) {
+		uint32_t command = _commands[channel].exchange(0);
+		if (command == 0) {
+			continue;
+		}
+		uint8_t newValue       = command & 0xFF;
+		uint8_t stepSize       = (command >> 8) & 0xFF;
+		_targetValues[channel] = newValue;
+		_stepSize[channel]     = stepSize;
+
+		// Unless value is 0 or 100 and speed 100
+		// In that case we can and should set the value immediately, as it might be for to safety.
+		if ((newValue == 0 || newValue == _maxValue) && stepSize >= _maxValue && _values[channel] != newValue) {
+			setValue(channel, newValue);
+		}
 	}
 }
 
@@ -240,7 +257,8 @@ void PWM::updateValues() {
 	}
 	_updateValuesCountdown = numPeriodsBeforeValueUpdate;
 
-	for (uint8_t channel = 0; channel < CS_PWM_MAX_CHANNELS; ++channel) {
+	// Step all channels, so that their compare values are written in the same period.
+	for (uint8_t channel = 0; channel < _config.channelCount; ++channel) {
 		int16_t diff = _targetValues[channel] - _values[channel];
 		int16_t inc  = 0;
 		if (diff > 0) {
@@ -255,10 +273,12 @@ void PWM::updateValues() {
 				inc = diff;
 			}
 		}
+		if (inc < 0 && _transitionChannelUsed) {
+			// There is only 1 transition channel, lower this value at the next update.
+			continue;
+		}
 		if (inc != 0) {
-			// Only 1 value can be set at a time.
 			setValue(channel, _values[channel] + inc);
-			return;
 		}
 	}
 }
@@ -289,9 +309,6 @@ void PWM::setValue(uint8_t channel, uint8_t newValue) {
 	_tickValues[channel]  = _maxTickVal * newValue / _maxValue;
 	LOGPwmDebug("Set PWM channel %u to %u ticks=%u", channel, newValue, _tickValues[channel]);
 
-	// Always disable the temporary PPI.
-	nrf_ppi_channel_disable(_ppiTransitionChannel);
-
 	switch (newValue) {
 		case 0:
 			// Simply disable the PPI that turns on the switch.
@@ -335,6 +352,7 @@ void PWM::setValue(uint8_t channel, uint8_t newValue) {
 										? getGpioteTaskSet(CS_PWM_GPIOTE_CHANNEL_START + channel)
 										: getGpioteTaskClear(CS_PWM_GPIOTE_CHANNEL_START + channel)));
 				nrf_ppi_channel_enable(_ppiTransitionChannel);
+				_transitionChannelUsed = true;
 
 				//				// Wait for transition to be done.
 				//				_transitionInProgress = true;
@@ -343,6 +361,12 @@ void PWM::setValue(uint8_t channel, uint8_t newValue) {
 			LOGPwmDebug("writeCC %u", _tickValues[channel]);
 			writeCC(channel, _tickValues[channel]);
 
+			// When the timer already passed the new compare value, the switch won't be turned off in this period,
+			// unless the transition channel does so.
+			if (captureCounter() >= _tickValues[channel] && !_transitionChannelUsed) {
+				_missedPeriodCount++;
+			}
+
 			// Enable turn off first, else turn on might happen before the turn off ppi is enabled.
 			nrf_ppi_channel_enable(_ppiChannelsOff[channel]);
 			nrf_ppi_channel_enable(_ppiChannelsOn[channel]);
@@ -362,6 +386,17 @@ uint8_t PWM::getValue(uint8_t channel) {
 	return _values[channel];
 }
 
+pwm_stats_t PWM::getStats() {
+	pwm_stats_t stats;
+	stats.maxLatencyUs = 0;
+	if (_maxTickVal != 0) {
+		stats.maxLatencyUs = static_cast<uint64_t>(_maxLatencyTicks) * _config.period_us / _maxTickVal;
+	}
+	stats.missedPeriodCount = _missedPeriodCount;
+	stats.coalescedCount    = _coalescedCount;
+	return stats;
+}
+
 void PWM::onZeroCrossingInterrupt() {
 	if (!_initialized) {
 		LOGe(FMT_NOT_INITIALIZED "PWM");
@@ -491,16 +526,22 @@ void PWM::_handleInterrupt() {
 	// At this point, the timer counter is close to 0.
 	// So we have about 10ms before the period compare event triggers again.
 	// This should be plenty of time to change the period value before it gets triggered.
+	uint32_t latencyTicks = captureCounter();
+	if (latencyTicks > _maxLatencyTicks) {
+		_maxLatencyTicks = latencyTicks;
+	}
 
 	// Set the new period value.
 	writeCC(PERIOD_CHANNEL_IDX, _adjustedMaxTickVal);
 
-	// Decouple from zero crossing interrupt
-	uint16_t schedulerSpace = app_sched_queue_space_get();
-	if (schedulerSpace > SCHED_QUEUE_SIZE - SCHEDULER_QUEUE_ALMOST_FULL) {
-		uint32_t errorCode = app_sched_event_put(nullptr, 0, onTimerEnd);
-		APP_ERROR_CHECK(errorCode);
-	}
+	// The transition channel is only needed in the period in which a value was lowered.
+	nrf_ppi_channel_disable(_ppiTransitionChannel);
+	_transitionChannelUsed = false;
+
+	// Set the new values here, instead of in the main thread, so that the compare values of all channels are written
+	// at the start of the period, and a busy main thread doesn't delay the fades.
+	takeCommands();
+	updateValues();
 
 	//	// Don't stop timer on end of period anymore, and start the timer again
 	//	nrf_timer_shorts_disable(CS_PWM_TIMER, PERIOD_SHORT_STOP_MASK);
@@ -548,6 +589,11 @@ void PWM::writeCC(uint8_t channelIdx, uint32_t ticks) {
 	nrf_timer_cc_write(CS_PWM_TIMER, getTimerChannel(channelIdx), ticks);
 }
 
+uint32_t PWM::captureCounter() {
+	nrf_timer_task_trigger(CS_PWM_TIMER, INTERRUPT_CAPTURE_TASK);
+	return nrf_timer_cc_read(CS_PWM_TIMER, getTimerChannel(INTERRUPT_CHANNEL_IDX));
+}
+
 uint32_t PWM::readCC(uint8_t channelIdx) {
 	return nrf_timer_cc_read(CS_PWM_TIMER, getTimerChannel(channelIdx));
 }
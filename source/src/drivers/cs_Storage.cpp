@@ -6,6 +6,7 @@
  */
 
 #include <common/cs_Handlers.h>
+#include <drivers/cs_RTC.h>
 #include <drivers/cs_Storage.h>
 #include <events/cs_EventDispatcher.h>
 #include <float.h>
@@ -99,27 +100,45 @@ cs_ret_code_t Storage::findNext(CS_TYPE type, cs_state_id_t& id) {
 	return retVal;
 }
 
+cs_ret_code_t Storage::findFirstOfAnyType(CS_TYPE& type, cs_state_id_t& id) {
+	if (!_initialized) {
+		LOGe(STR_ERR_NOT_INITIALIZED);
+		return ERR_NOT_INITIALIZED;
+	}
+	if (isBusy()) {
+		return ERR_BUSY;
+	}
+	initSearch();
+	_searchPosition = 0;
+	return findNextOfAnyType(type, id);
+}
+
+cs_ret_code_t Storage::findNextOfAnyType(CS_TYPE& type, cs_state_id_t& id) {
+	if (!_initialized) {
+		LOGe(STR_ERR_NOT_INITIALIZED);
+		return ERR_NOT_INITIALIZED;
+	}
+	if (_searchPosition >= _index.size()) {
+		return ERR_NOT_FOUND;
+	}
+	type = toCsType(_index[_searchPosition].recordKey);
+	id   = getStateId(_index[_searchPosition].fileId);
+	_searchPosition++;
+	return ERR_SUCCESS;
+}
+
 cs_ret_code_t Storage::findNextInternal(uint16_t recordKey, uint16_t& fileId) {
 	if (!isValidRecordKey(recordKey)) {
 		return ERR_WRONG_PARAMETER;
 	}
-	fds_record_desc_t recordDesc;
-	fds_flash_record_t flashRecord;
-	ret_code_t fdsRetCode;
-	while (fds_record_find_by_key(recordKey, &recordDesc, &_findToken) == NRF_SUCCESS) {
-		fdsRetCode = fds_record_open(&recordDesc, &flashRecord);
-		if (fdsRetCode == NRF_SUCCESS) {
-			fileId = flashRecord.p_header->file_id;
-			fds_record_close(&recordDesc);
-			return ERR_SUCCESS;
-		}
+	if (_searchPosition < _index.size() && _index[_searchPosition].recordKey == recordKey) {
+		fileId = _index[_searchPosition].fileId;
+		_searchPosition++;
+		return ERR_SUCCESS;
 	}
 	return ERR_NOT_FOUND;
 }
 
-/**
- * Iterate over all records, so that in case of duplicates, the last written record will be used to read.
- */
 cs_ret_code_t Storage::read(cs_state_data_t& stateData) {
 	if (!_initialized) {
 		LOGe(STR_ERR_NOT_INITIALIZED);
@@ -133,27 +152,7 @@ cs_ret_code_t Storage::read(cs_state_data_t& stateData) {
 	if (isBusy(recordKey)) {
 		return ERR_BUSY;
 	}
-	fds_record_desc_t recordDesc;
-	cs_ret_code_t csRetCode = ERR_NOT_FOUND;
-	bool done               = false;
-	LOGStorageDebug("Read record key=%u file=%u", recordKey, fileId);
-	initSearch();
-	while (fds_record_find(fileId, recordKey, &recordDesc, &_findToken) == NRF_SUCCESS) {
-		if (done) {
-			LOGe("Duplicate record key=%u file=%u addr=%p", recordKey, fileId, _findToken.p_addr);
-		}
-		csRetCode = readRecord(recordDesc, stateData.value, stateData.size, fileId);
-		if (csRetCode == ERR_SUCCESS) {
-			done = true;
-		}
-	}
-	if (done) {
-		return ERR_SUCCESS;
-	}
-	if (csRetCode == ERR_NOT_FOUND) {
-		LOGStorageDebug("Record not found");
-	}
-	return csRetCode;
+	return readInternal(recordKey, fileId, stateData.value, stateData.size);
 }
 
 cs_ret_code_t Storage::readV3ResetCounter(cs_state_data_t& stateData) {
@@ -175,27 +174,54 @@ cs_ret_code_t Storage::readV3ResetCounter(cs_state_data_t& stateData) {
 	if (isBusy(recordKey)) {
 		return ERR_BUSY;
 	}
+	return readInternal(recordKey, fileId, stateData.value, stateData.size);
+}
+
+cs_ret_code_t Storage::readInternal(uint16_t recordKey, uint16_t fileId, uint8_t* buf, uint16_t size) {
+	LOGStorageDebug("Read record key=%u file=%u", recordKey, fileId);
+	auto entry = _index.find(recordKey, fileId);
+	if (entry == nullptr) {
+		LOGStorageDebug("Record not found");
+		return ERR_NOT_FOUND;
+	}
+	cs_ret_code_t csRetCode = readRecord(entry->recordDesc, buf, size, fileId);
+	if (csRetCode == ERR_SUCCESS) {
+		return csRetCode;
+	}
+	// The last written record may be corrupt, for example after a power loss while writing, while an earlier one is
+	// still valid.
+	if (readDuplicate(recordKey, fileId, entry->recordDesc.record_id, buf, size) == ERR_SUCCESS) {
+		return ERR_SUCCESS;
+	}
+	return csRetCode;
+}
+
+/**
+ * Uses its own find token, so that it doesn't interfere with a search in progress.
+ */
+cs_ret_code_t Storage::readDuplicate(
+		uint16_t recordKey, uint16_t fileId, uint32_t skipRecordId, uint8_t* buf, uint16_t size) {
+	fds_find_token_t findToken;
+	memset(&findToken, 0x00, sizeof(findToken));
 	fds_record_desc_t recordDesc;
-	cs_ret_code_t csRetCode = ERR_NOT_FOUND;
-	bool done               = false;
-	LOGStorageDebug("Read record %u file=%u", recordKey, fileId);
-	initSearch();
-	while (fds_record_find(fileId, recordKey, &recordDesc, &_findToken) == NRF_SUCCESS) {
-		if (done) {
-			LOGe("Duplicate record key=%u file=%u addr=%p", recordKey, fileId, _findToken.p_addr);
+	fds_record_desc_t validRecordDesc;
+	bool found = false;
+	while (fds_record_find(fileId, recordKey, &recordDesc, &findToken) == NRF_SUCCESS) {
+		if (recordDesc.record_id == skipRecordId) {
+			continue;
 		}
-		csRetCode = readRecord(recordDesc, stateData.value, stateData.size, fileId);
-		if (csRetCode == ERR_SUCCESS) {
-			done = true;
+		uint16_t readFileId;
+		if (readRecord(recordDesc, buf, size, readFileId) == ERR_SUCCESS) {
+			validRecordDesc = recordDesc;
+			found           = true;
 		}
 	}
-	if (done) {
-		return ERR_SUCCESS;
-	}
-	if (csRetCode == ERR_NOT_FOUND) {
-		LOGStorageDebug("Record not found");
+	if (!found) {
+		return ERR_NOT_FOUND;
 	}
-	return csRetCode;
+	LOGw("Read duplicate record key=%u file=%u addr=%p", recordKey, fileId, validRecordDesc.p_record);
+	_index.add(recordKey, fileId, validRecordDesc);
+	return ERR_SUCCESS;
 }
 
 cs_ret_code_t Storage::readFirst(cs_state_data_t& stateData) {
@@ -243,18 +269,23 @@ cs_ret_code_t Storage::readNextInternal(uint16_t recordKey, uint16_t& fileId, ui
 	if (!isValidRecordKey(recordKey)) {
 		return ERR_WRONG_PARAMETER;
 	}
-	fds_record_desc_t recordDesc;
 	cs_ret_code_t csRetCode = ERR_NOT_FOUND;
-	while (fds_record_find_by_key(recordKey, &recordDesc, &_findToken) == NRF_SUCCESS) {
-		csRetCode = readRecord(recordDesc, buf, size, fileId);
+	while (_searchPosition < _index.size() && _index[_searchPosition].recordKey == recordKey) {
+		auto& entry = _index[_searchPosition];
+		_searchPosition++;
+		csRetCode = readRecord(entry.recordDesc, buf, size, fileId);
 		if (csRetCode == ERR_SUCCESS) {
 			return csRetCode;
 		}
+		if (readDuplicate(entry.recordKey, entry.fileId, entry.recordDesc.record_id, buf, size) == ERR_SUCCESS) {
+			fileId = entry.fileId;
+			return ERR_SUCCESS;
+		}
 	}
 	return csRetCode;
 }
 
-cs_ret_code_t Storage::readRecord(fds_record_desc_t recordDesc, uint8_t* buf, uint16_t size, uint16_t& fileId) {
+cs_ret_code_t Storage::readRecord(fds_record_desc_t& recordDesc, uint8_t* buf, uint16_t size, uint16_t& fileId) {
 	fds_flash_record_t flashRecord;
 	ret_code_t fdsRetCode = fds_record_open(&recordDesc, &flashRecord);
 	switch (fdsRetCode) {
@@ -340,6 +371,7 @@ ret_code_t Storage::writeInternal(const cs_state_data_t& stateData) {
 			break;
 		case FDS_ERR_NO_SPACE_IN_FLASH: {
 			LOGStorageInfo("Flash is full, start garbage collection");
+			_gcStats.flashFullCount++;
 			ret_code_t gcRetCode = garbageCollect();
 			if (gcRetCode == NRF_SUCCESS) {
 				fdsRetCode = FDS_ERR_BUSY;
@@ -551,10 +583,57 @@ ret_code_t Storage::garbageCollectInternal() {
 	else {
 		LOGStorageDebug("Started garbage collection");
 		_collectingGarbage = true;
+		_gcStartCount      = RTC::getCount();
 	}
 	return fdsRetCode;
 }
 
+cs_ret_code_t Storage::getUsage(storage_usage_t& usage) {
+	if (!_initialized) {
+		LOGe(STR_ERR_NOT_INITIALIZED);
+		return ERR_NOT_INITIALIZED;
+	}
+	fds_stat_t stat;
+	ret_code_t fdsRetCode = fds_stat(&stat);
+	if (fdsRetCode != NRF_SUCCESS) {
+		return getErrorCode(fdsRetCode);
+	}
+	// One page is reserved as swap page for garbage collection.
+	usage.totalWords       = (FDS_VIRTUAL_PAGES - 1) * FDS_VIRTUAL_PAGE_SIZE;
+	usage.usedWords        = stat.words_used;
+	usage.freeableWords    = stat.freeable_words;
+	usage.largestFreeWords = stat.largest_contig;
+	return ERR_SUCCESS;
+}
+
+/**
+ * Garbage collection can't be paused once started, but the SoftDevice already schedules the flash operations in
+ * between radio activity. So the policy only avoids starting garbage collection while the device is busy.
+ */
+cs_ret_code_t Storage::garbageCollectIfNeeded(bool idle) {
+	if (isBusy()) {
+		return ERR_BUSY;
+	}
+	storage_usage_t usage;
+	cs_ret_code_t retCode = getUsage(usage);
+	if (retCode != ERR_SUCCESS) {
+		return retCode;
+	}
+	if (app_sched_queue_space_get() < SCHED_QUEUE_SIZE / 2) {
+		idle = false;
+	}
+	if (!_gcPolicy.shouldCollect(usage, idle)) {
+		return ERR_NOT_AVAILABLE;
+	}
+	LOGStorageInfo(
+			"Collect garbage: idle=%u used=%u freeable=%u largestFree=%u words",
+			idle,
+			usage.usedWords,
+			usage.freeableWords,
+			usage.largestFreeWords);
+	return garbageCollect();
+}
+
 cs_ret_code_t Storage::eraseAllPages() {
 	LOGw("eraseAllPages");
 	if (_initialized || isErasingPages()) {
@@ -673,6 +752,7 @@ bool Storage::isValidFileId(uint16_t fileId) {
 void Storage::initSearch(CS_TYPE type) {
 	initSearch();
 	_currentSearchType = type;
+	_searchPosition    = _index.getPosition(to_underlying_type(type), 0);
 }
 
 void Storage::initSearch() {
@@ -683,22 +763,44 @@ void Storage::initSearch() {
 
 /**
  * Check if a record exists.
- * Warns when it's found multiple times, but doesn't delete them. That would require to make a copy of the first found
- * record_desc.
- * Returns the last found record.
+ * Duplicates are only checked for when building the index, in that case the last found record is returned.
  */
 ret_code_t Storage::exists(cs_file_id_t fileId, uint16_t recordKey, fds_record_desc_t& record_desc, bool& result) {
+	auto entry = _index.find(recordKey, fileId);
+	result     = (entry != nullptr);
+	if (result) {
+		record_desc = entry->recordDesc;
+	}
+	return ERR_SUCCESS;
+}
+
+void Storage::buildIndex() {
+	_index.clear();
+	fds_record_desc_t recordDesc;
+	fds_flash_record_t flashRecord;
+	uint16_t duplicateCount = 0;
 	initSearch();
-	result = false;
-	while (fds_record_find(fileId, recordKey, &record_desc, &_findToken) == NRF_SUCCESS) {
-		if (result) {
-			LOGe("Duplicate record key=%u file=%u addr=%p", recordKey, fileId, _findToken.p_addr);
+	while (fds_record_iterate(&recordDesc, &_findToken) == NRF_SUCCESS) {
+		ret_code_t fdsRetCode = fds_record_open(&recordDesc, &flashRecord);
+		if (fdsRetCode != NRF_SUCCESS) {
+			// Skip this record, like a read would.
+			LOGw("Failed to open record addr=%p err=%u", recordDesc.p_record, fdsRetCode);
+			continue;
+		}
+		uint16_t fileId    = flashRecord.p_header->file_id;
+		uint16_t recordKey = flashRecord.p_header->record_key;
+		if (fds_record_close(&recordDesc) != NRF_SUCCESS) {
+			// TODO: How to handle the close error? Maybe reboot?
+			LOGe("Error on closing record");
 		}
-		if (!result) {
-			result = true;
+		if (_index.find(recordKey, fileId) != nullptr) {
+			LOGe("Duplicate record key=%u file=%u addr=%p", recordKey, fileId, recordDesc.p_record);
+			duplicateCount++;
 		}
+		_index.add(recordKey, fileId, recordDesc);
 	}
-	return ERR_SUCCESS;
+	LOGStorageInit(
+			"Indexed %u records, duplicates=%u heap=%u B", _index.size(), duplicateCount, _index.getHeapSize());
 }
 
 void Storage::setBusy(uint16_t recordKey) {
@@ -789,6 +891,9 @@ void Storage::handleWriteEvent(fds_evt_t const* p_fds_evt) {
 	eventData.id   = getStateId(p_fds_evt->write.file_id);
 	switch (p_fds_evt->result) {
 		case NRF_SUCCESS: {
+			fds_record_desc_t recordDesc;
+			fds_descriptor_from_rec_id(&recordDesc, p_fds_evt->write.record_id);
+			_index.add(p_fds_evt->write.record_key, p_fds_evt->write.file_id, recordDesc);
 			LOGStorageWrite(
 					"Write done, key=%u file=%u type=%u id=%u",
 					p_fds_evt->del.record_key,
@@ -821,6 +926,7 @@ void Storage::handleRemoveRecordEvent(fds_evt_t const* p_fds_evt) {
 	eventData.id   = getStateId(p_fds_evt->del.file_id);
 	switch (p_fds_evt->result) {
 		case NRF_SUCCESS: {
+			_index.remove(p_fds_evt->del.record_key, p_fds_evt->del.file_id, p_fds_evt->del.record_id);
 			LOGStorageInfo(
 					"Remove done, key=%u file=%u type=%u id=%u",
 					p_fds_evt->del.record_key,
@@ -855,6 +961,7 @@ void Storage::handleRemoveFileEvent(fds_evt_t const* p_fds_evt) {
 	cs_state_id_t id = getStateId(p_fds_evt->write.file_id);
 	switch (p_fds_evt->result) {
 		case NRF_SUCCESS: {
+			_index.removeFile(p_fds_evt->del.file_id);
 			LOGStorageInfo("Remove file done, file=%u id=%u", p_fds_evt->del.file_id, id);
 			event_t event(CS_TYPE::EVT_STORAGE_REMOVE_ALL_TYPES_WITH_ID_DONE, &id, sizeof(id));
 			EventDispatcher::getInstance().dispatch(event);
@@ -872,6 +979,9 @@ void Storage::handleRemoveFileEvent(fds_evt_t const* p_fds_evt) {
 	}
 }
 
+/**
+ * The index doesn't have to be updated: FDS looks up moved records when their descriptor is used.
+ */
 void Storage::handleGarbageCollectionEvent(fds_evt_t const* p_fds_evt) {
 	_collectingGarbage = false;
 	switch (p_fds_evt->result) {
@@ -883,6 +993,13 @@ void Storage::handleGarbageCollectionEvent(fds_evt_t const* p_fds_evt) {
 				EventDispatcher::getInstance().dispatch(resetEvent);
 				return;
 			} else {
+				uint32_t durationMs = RTC::msPassedSince(_gcStartCount);
+				_gcStats.count++;
+				_gcStats.lastDurationMs = durationMs;
+				if (durationMs > _gcStats.maxDurationMs) {
+					_gcStats.maxDurationMs = durationMs;
+				}
+				LOGStorageInfo("Garbage collection took %u ms", durationMs);
 				event_t event(CS_TYPE::EVT_STORAGE_GC_DONE);
 				EventDispatcher::getInstance().dispatch(event);
 				return;
@@ -920,6 +1037,7 @@ void Storage::handleFileStorageEvent(fds_evt_t const* p_fds_evt) {
 		case FDS_EVT_INIT: {
 			if (p_fds_evt->result == NRF_SUCCESS) {
 				LOGStorageInit("Storage initialized");
+				buildIndex();
 				_initialized = true;
 				event_t event(CS_TYPE::EVT_STORAGE_INITIALIZED);
 				EventDispatcher::getInstance().dispatch(event);
@@ -0,0 +1,54 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <events/cs_CompatibilityTick.h>
+#include <events/cs_Event.h>
+
+CompatibilityTick& CompatibilityTick::getInstance() {
+	static CompatibilityTick instance;
+	return instance;
+}
+
+CompatibilityTick::CompatibilityTick()
+		: _tickRoutine(
+				[this]() {
+					tick();
+					return Coroutine::delayMs(TICK_INTERVAL_MS);
+				},
+				TICK_JITTER_MS) {}
+
+void CompatibilityTick::addRequest() {
+	if (_requestCount++ == 0) {
+		_tickRoutine.start(TICK_INTERVAL_MS);
+	}
+}
+
+void CompatibilityTick::removeRequest() {
+	if (--_requestCount == 0) {
+		_tickRoutine.stop();
+	}
+}
+
+void CompatibilityTick::tick() {
+	event_t event(CS_TYPE::EVT_TICK, &_tickCount, sizeof(_tickCount));
+	event.dispatch();
+	++_tickCount;
+}
+
+void TickRequest::request() {
+	if (!_requested) {
+		_requested = true;
+		CompatibilityTick::getInstance().addRequest();
+	}
+}
+
+void TickRequest::release() {
+	if (_requested) {
+		_requested = false;
+		CompatibilityTick::getInstance().removeRequest();
+	}
+}
@@ -65,8 +65,8 @@ void AssetFilterStore::handleEvent(event_t& evt) {
 			handleGetFilterSummariesCommand(evt.result);
 			break;
 		}
-		case CS_TYPE::EVT_TICK: {
-			onTick();
+		case CS_TYPE::EVT_TICK_SECOND: {
+			onTickSecond();
 			break;
 		}
 		default: break;
@@ -386,7 +386,7 @@ void AssetFilterStore::handleGetFilterSummariesCommand(cs_result_t& result) {
 	result.returnCode = ERR_SUCCESS;
 }
 
-void AssetFilterStore::onTick() {
+void AssetFilterStore::onTickSecond() {
 	if (_modificationInProgressCountdown) {
 		_modificationInProgressCountdown--;
 		if (_modificationInProgressCountdown == 0) {
@@ -407,7 +407,7 @@ bool AssetFilterStore::isReady() {
 
 void AssetFilterStore::startInProgress() {
 	LOGAssetFilterDebug("startInProgress");
-	_modificationInProgressCountdown = 1000 * MODIFICATION_IN_PROGRESS_TIMEOUT_SECONDS / TICK_INTERVAL_MS;
+	_modificationInProgressCountdown = MODIFICATION_IN_PROGRESS_TIMEOUT_SECONDS;
 	_masterVersion                   = 0;
 	sendInProgressStatus();
 }
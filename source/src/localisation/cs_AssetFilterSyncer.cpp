@@ -5,21 +5,39 @@
  * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
  */
 
+#include <drivers/cs_RNG.h>
 #include <events/cs_Event.h>
 #include <localisation/cs_AssetFilterStore.h>
 #include <localisation/cs_AssetFilterSyncer.h>
 #include <protocol/cs_ErrorCodes.h>
 #include <util/cs_Lollipop.h>
 #include <util/cs_Math.h>
+#include <util/cs_Utils.h>
 
 #define LOGAssetFilterSyncerInfo LOGi
 #define LOGAssetFilterSyncerDebug LOGvv
 #define LOGAssetFilterSyncerVerbose LOGvv
 
+static_assert(
+		AssetFilterStore::MAX_FILTER_IDS <= 8 * sizeof(cs_mesh_model_msg_asset_filter_chunk_header_t::filterIdBitmask),
+		"Filter ID bitmask is too small");
+
+AssetFilterSyncer::AssetFilterSyncer()
+		: _trickleRoutine([this]() {
+			onTrickleTimer();
+			return Coroutine::delayMs(_trickleIntervalMs - _trickleSendAtMs);
+		})
+		, _meshRequestTimeoutRoutine([this]() {
+			_meshRequestTimeoutRoutine.stop();
+			onMeshRequestTimeout();
+			return Coroutine::delayS(0);
+		}) {}
+
 cs_ret_code_t AssetFilterSyncer::init() {
-	_store = getComponent<AssetFilterStore>();
+	_store             = getComponent<AssetFilterStore>();
 
-	sendVersionAtLowInterval();
+	_trickleIntervalMs = VERSION_BROADCAST_LOW_INTERVAL_SECONDS * 1000;
+	startTrickleInterval();
 	listen();
 
 	return ERR_SUCCESS;
@@ -34,6 +52,10 @@ void AssetFilterSyncer::sendVersion(bool reliable) {
 		LOGAssetFilterSyncerDebug("Store is in progress: don't send version");
 		return;
 	}
+	if (_step == SyncStep::MESH_DOWNLOAD) {
+		LOGAssetFilterSyncerDebug("Downloading filters: don't send version");
+		return;
+	}
 	uint16_t masterVersion = _store->getMasterVersion();
 	uint32_t masterCrc     = _store->getMasterCrc();
 	LOGAssetFilterSyncerDebug("sendVersion reliable=%u version=%u crc=%u", reliable, masterVersion, masterCrc);
@@ -63,14 +85,33 @@ cs_ret_code_t AssetFilterSyncer::onVersion(stone_id_t stoneId, cs_mesh_model_msg
 	VersionCompare compare = compareToMyVersion(packet.protocol, packet.masterVersion, packet.masterCrc);
 	switch (compare) {
 		case VersionCompare::OLDER: {
-			// The stone has an older version: sync it.
-			syncFilters(stoneId);
+			// The stone has an older version: make sure it hears our version soon, so it can download the filters
+			// from us over the mesh. If it keeps advertising the older version, connect and sync it instead.
+			resetTrickleTimer();
+			if (stoneId == _olderStoneId) {
+				_olderStoneVersionCount++;
+			}
+			else {
+				_olderStoneId           = stoneId;
+				_olderStoneVersionCount = 1;
+			}
+			if (_olderStoneVersionCount >= MESH_SYNC_FALLBACK_VERSION_COUNT) {
+				_olderStoneVersionCount = 0;
+				syncFilters(stoneId);
+			}
 			break;
 		}
 		case VersionCompare::NEWER: {
-			// The stone has a newer version: inform it that we should be synced.
-			// Should not be reliable, as we currently get a call to onVersion each for each repeat.
-			sendVersion(false);
+			// The stone has a newer version: download the filters from it.
+			resetTrickleTimer();
+			startMeshDownload(stoneId, packet.masterVersion, packet.masterCrc);
+			break;
+		}
+		case VersionCompare::EQUAL: {
+			_trickleConsistentCount++;
+			if (stoneId == _olderStoneId) {
+				_olderStoneVersionCount = 0;
+			}
 			break;
 		}
 		default: {
@@ -129,11 +170,11 @@ void AssetFilterSyncer::setStep(SyncStep step) {
 
 void AssetFilterSyncer::reset() {
 	LOGAssetFilterSyncerDebug("Reset");
-	if (_step > SyncStep::CONNECT && _step != SyncStep::DISCONNECT) {
+	if (_step > SyncStep::CONNECT && _step < SyncStep::DISCONNECT) {
 		disconnect();
 	}
 	setStep(SyncStep::NONE);
-	sendVersionAtLowInterval();
+	resetTrickleTimer();
 }
 
 void AssetFilterSyncer::syncFilters(stone_id_t stoneId) {
@@ -314,7 +355,289 @@ void AssetFilterSyncer::done() {
 	LOGAssetFilterSyncerInfo("Done uploading master version %u", _store->getMasterVersion());
 	// Send out version again, so the next crownstone with an old version can send their version, which makes us connect
 	// to that crownstone.
-	sendVersionAtLowInterval();
+	resetTrickleTimer();
+}
+
+void AssetFilterSyncer::startMeshDownload(stone_id_t stoneId, uint16_t masterVersion, uint32_t masterCrc) {
+	if (_step != SyncStep::NONE) {
+		return;
+	}
+	if (_store->isInProgress()) {
+		LOGAssetFilterSyncerDebug("Store is in progress");
+		return;
+	}
+	if (stoneId == _meshFailedSourceId && masterVersion == _meshFailedVersion
+		&& _meshFailedCount >= MESH_DOWNLOAD_MAX_ATTEMPTS) {
+		// The stone probably doesn't serve chunks: let it connect to us instead.
+		LOGAssetFilterSyncerDebug("Download from stoneId=%u failed before: send version instead", stoneId);
+		sendVersion(false);
+		return;
+	}
+	LOGAssetFilterSyncerInfo("Download filters from stoneId=%u version=%u", stoneId, masterVersion);
+	_meshSourceId                = stoneId;
+	_meshMasterVersion           = masterVersion;
+	_meshMasterCrc               = masterCrc;
+	_meshFilterIdBitmask         = 0;
+	_meshFilterIdBitmaskReceived = false;
+	_meshFilterId                = 0;
+	_meshChunkStartIndex         = 0;
+	_meshRequestRetries          = 0;
+	setStep(SyncStep::MESH_DOWNLOAD);
+	requestMeshChunk();
+}
+
+void AssetFilterSyncer::requestMeshChunk() {
+	LOGAssetFilterSyncerVerbose(
+			"requestMeshChunk filterId=%u chunkStartIndex=%u retries=%u",
+			_meshFilterId,
+			_meshChunkStartIndex,
+			_meshRequestRetries);
+	cs_mesh_model_msg_asset_filter_chunk_request_t request = {
+			.protocol        = ASSET_FILTER_CMD_PROTOCOL_VERSION,
+			.masterVersion   = _meshMasterVersion,
+			.filterId        = _meshFilterId,
+			.chunkStartIndex = _meshChunkStartIndex};
+
+	cs_mesh_msg_t meshMsg;
+	meshMsg.type                    = CS_MESH_MODEL_TYPE_ASSET_FILTER_CHUNK_REQUEST;
+	meshMsg.flags.flags.broadcast   = false;
+	meshMsg.flags.flags.acked       = true;
+	meshMsg.flags.flags.useKnownIds = false;
+	meshMsg.flags.flags.doNotRelay  = true;
+	meshMsg.reliability             = 3;  // Low timeout, we expect a chunk quickly.
+	meshMsg.urgency                 = CS_MESH_URGENCY_LOW;
+	meshMsg.idCount                 = 1;
+	meshMsg.targetIds               = &_meshSourceId;
+	meshMsg.payload                 = reinterpret_cast<uint8_t*>(&request);
+	meshMsg.size                    = sizeof(request);
+
+	event_t event(CS_TYPE::CMD_SEND_MESH_MSG, &meshMsg, sizeof(meshMsg));
+	event.dispatch();
+	if (event.result.returnCode != ERR_SUCCESS) {
+		LOGAssetFilterSyncerInfo("Failed to send chunk request: retCode=%u", event.result.returnCode);
+		// Will be retried on timeout.
+	}
+	_meshRequestTimeoutRoutine.start(MESH_CHUNK_REQUEST_TIMEOUT_SECONDS * 1000);
+}
+
+bool AssetFilterSyncer::hasFilter(uint8_t filterId, uint32_t filterCrc) {
+	std::optional<uint8_t> index = _store->findFilterIndex(filterId);
+	if (!index.has_value()) {
+		return false;
+	}
+	AssetFilter filter = _store->getFilter(index.value());
+	return filter.runtimedata()->flags.flags.committed && filter.runtimedata()->flags.flags.crcCalculated
+		   && filter.runtimedata()->crc == filterCrc;
+}
+
+void AssetFilterSyncer::removeFiltersNotInMeshDownload() {
+	uint8_t filterIdsToRemove[AssetFilterStore::MAX_FILTER_IDS];
+	uint8_t removeCount = 0;
+	for (uint8_t i = 0; i < _store->getFilterCount(); ++i) {
+		uint8_t filterId = _store->getFilter(i).runtimedata()->filterId;
+		if (!CsUtils::isBitSet(_meshFilterIdBitmask, filterId)) {
+			filterIdsToRemove[removeCount++] = filterId;
+		}
+	}
+
+	for (uint8_t i = 0; i < removeCount; ++i) {
+		LOGAssetFilterSyncerVerbose("Remove filterId=%u", filterIdsToRemove[i]);
+		TYPIFY(CMD_REMOVE_FILTER) removeCmd = {
+				.protocolVersion = ASSET_FILTER_CMD_PROTOCOL_VERSION, .filterId = filterIdsToRemove[i]};
+		event_t event(CS_TYPE::CMD_REMOVE_FILTER, &removeCmd, sizeof(removeCmd));
+		event.dispatch();
+	}
+}
+
+void AssetFilterSyncer::commitMeshDownload() {
+	LOGAssetFilterSyncerDebug("commitMeshDownload");
+	TYPIFY(CMD_COMMIT_FILTER_CHANGES) commitCmd = {
+			.protocolVersion = ASSET_FILTER_CMD_PROTOCOL_VERSION,
+			.masterVersion   = _meshMasterVersion,
+			.masterCrc       = _meshMasterCrc};
+
+	// Set the step before the commit, as the commit will dispatch events.
+	setStep(SyncStep::NONE);
+	event_t event(CS_TYPE::CMD_COMMIT_FILTER_CHANGES, &commitCmd, sizeof(commitCmd));
+	event.dispatch();
+	if (event.result.returnCode != ERR_SUCCESS) {
+		LOGw("Commit of downloaded filters failed: retCode=%u", event.result.returnCode);
+		onMeshDownloadFailed();
+		return;
+	}
+	LOGAssetFilterSyncerInfo("Done downloading master version %u", _meshMasterVersion);
+	_meshFailedCount = 0;
+	resetTrickleTimer();
+}
+
+void AssetFilterSyncer::onMeshDownloadFailed() {
+	if (_meshSourceId == _meshFailedSourceId && _meshMasterVersion == _meshFailedVersion) {
+		_meshFailedCount++;
+	}
+	else {
+		_meshFailedSourceId = _meshSourceId;
+		_meshFailedVersion  = _meshMasterVersion;
+		_meshFailedCount    = 1;
+	}
+	LOGAssetFilterSyncerInfo(
+			"Download from stoneId=%u failed %u times in a row", _meshFailedSourceId, _meshFailedCount);
+	reset();
+}
+
+cs_ret_code_t AssetFilterSyncer::onMeshChunkRequest(
+		stone_id_t stoneId, cs_mesh_model_msg_asset_filter_chunk_request_t& packet) {
+	LOGAssetFilterSyncerVerbose(
+			"onMeshChunkRequest stoneId=%u version=%u filterId=%u chunkStartIndex=%u",
+			stoneId,
+			packet.masterVersion,
+			packet.filterId,
+			packet.chunkStartIndex);
+	if (packet.protocol != ASSET_FILTER_CMD_PROTOCOL_VERSION) {
+		return ERR_PROTOCOL_UNSUPPORTED;
+	}
+	if (_store->isInProgress() || _store->getMasterVersion() == 0
+		|| _store->getMasterVersion() != packet.masterVersion) {
+		LOGAssetFilterSyncerDebug("Can't serve version %u", packet.masterVersion);
+		return ERR_WRONG_STATE;
+	}
+
+	uint8_t msg[sizeof(cs_mesh_model_msg_asset_filter_chunk_header_t) + MAX_MESH_ASSET_FILTER_CHUNK_SIZE];
+	auto header             = reinterpret_cast<cs_mesh_model_msg_asset_filter_chunk_header_t*>(msg);
+	header->protocol        = ASSET_FILTER_CMD_PROTOCOL_VERSION;
+	header->masterVersion   = _store->getMasterVersion();
+	header->filterIdBitmask = 0;
+	header->filterId        = packet.filterId;
+	header->totalSize       = 0;
+	header->filterCrc       = 0;
+	header->chunkStartIndex = packet.chunkStartIndex;
+	uint16_t chunkSize      = 0;
+
+	// Filters are sorted by filter ID, so the first match is the first filter with an ID equal or larger.
+	bool found              = false;
+	for (uint8_t i = 0; i < _store->getFilterCount(); ++i) {
+		AssetFilter filter = _store->getFilter(i);
+		uint8_t filterId   = filter.runtimedata()->filterId;
+		CsUtils::setBit(header->filterIdBitmask, filterId);
+		if (found || filterId < packet.filterId) {
+			continue;
+		}
+		if (packet.chunkStartIndex != 0 && filterId != packet.filterId) {
+			return ERR_WRONG_PARAMETER;
+		}
+		found                     = true;
+		uint16_t filterDataLength = filter.filterdata().length();
+		if (packet.chunkStartIndex >= filterDataLength) {
+			return ERR_WRONG_PARAMETER;
+		}
+		header->filterId  = filterId;
+		header->totalSize = filterDataLength;
+		header->filterCrc = filter.runtimedata()->crc;
+		chunkSize         = CsMath::min(MAX_MESH_ASSET_FILTER_CHUNK_SIZE, filterDataLength - packet.chunkStartIndex);
+		memcpy(msg + sizeof(*header), filter.filterdata()._data + packet.chunkStartIndex, chunkSize);
+	}
+
+	cs_mesh_msg_t meshMsg;
+	meshMsg.type                    = CS_MESH_MODEL_TYPE_ASSET_FILTER_CHUNK;
+	meshMsg.flags.flags.broadcast   = false;
+	meshMsg.flags.flags.acked       = true;
+	meshMsg.flags.flags.useKnownIds = false;
+	meshMsg.flags.flags.doNotRelay  = true;
+	meshMsg.reliability             = 3;
+	meshMsg.urgency                 = CS_MESH_URGENCY_LOW;
+	meshMsg.idCount                 = 1;
+	meshMsg.targetIds               = &stoneId;
+	meshMsg.payload                 = msg;
+	meshMsg.size                    = sizeof(*header) + chunkSize;
+
+	event_t event(CS_TYPE::CMD_SEND_MESH_MSG, &meshMsg, sizeof(meshMsg));
+	event.dispatch();
+	return event.result.returnCode;
+}
+
+cs_ret_code_t AssetFilterSyncer::onMeshChunk(stone_id_t stoneId, cs_data_t& payload) {
+	if (_step != SyncStep::MESH_DOWNLOAD || stoneId != _meshSourceId) {
+		return ERR_WRONG_STATE;
+	}
+	auto header        = reinterpret_cast<cs_mesh_model_msg_asset_filter_chunk_header_t*>(payload.data);
+	uint16_t chunkSize = payload.len - sizeof(*header);
+	LOGAssetFilterSyncerVerbose(
+			"onMeshChunk filterId=%u totalSize=%u chunkStartIndex=%u chunkSize=%u",
+			header->filterId,
+			header->totalSize,
+			header->chunkStartIndex,
+			chunkSize);
+
+	if (header->protocol != ASSET_FILTER_CMD_PROTOCOL_VERSION || header->masterVersion != _meshMasterVersion
+		|| header->chunkStartIndex != _meshChunkStartIndex) {
+		// Probably a reply to an older request.
+		return ERR_WRONG_PARAMETER;
+	}
+
+	if (!_meshFilterIdBitmaskReceived) {
+		_meshFilterIdBitmask         = header->filterIdBitmask;
+		_meshFilterIdBitmaskReceived = true;
+		removeFiltersNotInMeshDownload();
+	}
+
+	if (header->totalSize == 0) {
+		// No more filters.
+		commitMeshDownload();
+		return ERR_SUCCESS;
+	}
+
+	bool validFilterId =
+			(_meshChunkStartIndex == 0) ? (header->filterId >= _meshFilterId) : (header->filterId == _meshFilterId);
+	if (!validFilterId || chunkSize == 0 || header->chunkStartIndex + chunkSize > header->totalSize) {
+		onMeshDownloadFailed();
+		return ERR_WRONG_PARAMETER;
+	}
+
+	_meshRequestRetries = 0;
+	_meshFilterId       = header->filterId;
+	if (header->chunkStartIndex == 0 && hasFilter(header->filterId, header->filterCrc)) {
+		// We already have this filter, skip the remaining chunks.
+		LOGAssetFilterSyncerVerbose("CRC match, skip filterId=%u", header->filterId);
+		_meshChunkStartIndex = header->totalSize;
+	}
+	else {
+		cs_ret_code_t retCode = uploadMeshChunk(*header, payload.data + sizeof(*header), chunkSize);
+		if (retCode != ERR_SUCCESS) {
+			onMeshDownloadFailed();
+			return retCode;
+		}
+		_meshChunkStartIndex = header->chunkStartIndex + chunkSize;
+	}
+
+	if (_meshChunkStartIndex == header->totalSize) {
+		// Filter complete, continue with the next filter ID, if any.
+		_meshChunkStartIndex = 0;
+		_meshFilterId++;
+		if ((_meshFilterId >= 8 * sizeof(_meshFilterIdBitmask)) || (_meshFilterIdBitmask >> _meshFilterId) == 0) {
+			commitMeshDownload();
+			return ERR_SUCCESS;
+		}
+	}
+	requestMeshChunk();
+	return ERR_SUCCESS;
+}
+
+cs_ret_code_t AssetFilterSyncer::uploadMeshChunk(
+		const cs_mesh_model_msg_asset_filter_chunk_header_t& header, const uint8_t* chunk, uint16_t chunkSize) {
+	uint8_t uploadBuf[sizeof(asset_filter_cmd_upload_filter_t) + MAX_MESH_ASSET_FILTER_CHUNK_SIZE];
+	auto uploadCmd             = reinterpret_cast<asset_filter_cmd_upload_filter_t*>(uploadBuf);
+	uploadCmd->protocolVersion = ASSET_FILTER_CMD_PROTOCOL_VERSION;
+	uploadCmd->filterId        = header.filterId;
+	uploadCmd->chunkStartIndex = header.chunkStartIndex;
+	uploadCmd->totalSize       = header.totalSize;
+	uploadCmd->chunkSize       = chunkSize;
+	memcpy(uploadCmd->chunk, chunk, chunkSize);
+
+	event_t event(CS_TYPE::CMD_UPLOAD_FILTER, uploadBuf, sizeof(asset_filter_cmd_upload_filter_t) + chunkSize);
+	event.dispatch();
+	if (event.result.returnCode != ERR_SUCCESS) {
+		LOGw("Upload of downloaded chunk failed: retCode=%u", event.result.returnCode);
+	}
+	return event.result.returnCode;
 }
 
 void AssetFilterSyncer::onConnectResult(cs_ret_code_t retCode) {
@@ -477,38 +800,60 @@ void AssetFilterSyncer::onFilterSummaries(cs_data_t& payload) {
 
 void AssetFilterSyncer::onModificationInProgress(bool inProgress) {
 	LOGAssetFilterSyncerDebug("onModificationInProgress %u", inProgress);
+	if (_step == SyncStep::MESH_DOWNLOAD) {
+		// We're the one modifying the filters, a failed download is handled by the request timeout and the commit.
+		return;
+	}
 	if (inProgress && _step != SyncStep::NONE) {
 		// Abort the current upload.
 		reset();
 	}
 }
 
-void AssetFilterSyncer::sendVersionAtLowInterval() {
-	_sendVersionAtLowIntervalCountdown = VERSION_BROADCAST_INTERVAL_RESET_SECONDS * 1000 / TICK_INTERVAL_MS;
+void AssetFilterSyncer::resetTrickleTimer() {
+	uint32_t minIntervalMs = VERSION_BROADCAST_LOW_INTERVAL_SECONDS * 1000;
+	if (_trickleIntervalMs == minIntervalMs) {
+		return;
+	}
+	_trickleIntervalMs = minIntervalMs;
+	startTrickleInterval();
+}
 
-	// Clamp the countdown: leave current countdown as it is, but it should be at most the low interval.
-	_sendVersionCountdown =
-			CsMath::min(_sendVersionCountdown, VERSION_BROADCAST_LOW_INTERVAL_SECONDS * 1000 / TICK_INTERVAL_MS);
-	LOGAssetFilterSyncerDebug("sendVersionAtLowInterval sendVersionCountdown=%u", _sendVersionCountdown);
+void AssetFilterSyncer::startTrickleInterval() {
+	uint32_t halfInterval   = _trickleIntervalMs / 2;
+	_trickleSendAtPassed    = false;
+	_trickleConsistentCount = 0;
+	_trickleSendAtMs        = halfInterval + RNG::getInstance().getRandom16() % CsMath::max(halfInterval, 1U);
+	LOGAssetFilterSyncerDebug("startTrickleInterval interval=%u sendAt=%u", _trickleIntervalMs, _trickleSendAtMs);
+	_trickleRoutine.start(_trickleSendAtMs);
 }
 
-void AssetFilterSyncer::onTick(uint32_t tickCount) {
-	// Decrement timers.
-	if (_sendVersionAtLowIntervalCountdown != 0) {
-		_sendVersionAtLowIntervalCountdown--;
-	}
-	if (_sendVersionCountdown != 0) {
-		_sendVersionCountdown--;
+void AssetFilterSyncer::onTrickleTimer() {
+	if (!_trickleSendAtPassed) {
+		_trickleSendAtPassed = true;
+		if (_trickleConsistentCount < VERSION_BROADCAST_REDUNDANCY) {
+			sendVersion(false);
+		}
+		else {
+			LOGAssetFilterSyncerDebug("Suppress version broadcast");
+		}
+		return;
 	}
+	_trickleIntervalMs = CsMath::min(2 * _trickleIntervalMs, VERSION_BROADCAST_NORMAL_INTERVAL_SECONDS * 1000U);
+	startTrickleInterval();
+}
 
-	if (_sendVersionCountdown == 0) {
-		// Send our version.
-		bool isInLowIntervalMode = _sendVersionAtLowIntervalCountdown == 0;
-
-		_sendVersionCountdown    = isInLowIntervalMode
-										   ? VERSION_BROADCAST_NORMAL_INTERVAL_SECONDS * 1000 / TICK_INTERVAL_MS
-										   : VERSION_BROADCAST_LOW_INTERVAL_SECONDS * 1000 / TICK_INTERVAL_MS;
-		sendVersion(false);
+void AssetFilterSyncer::onMeshRequestTimeout() {
+	if (_step != SyncStep::MESH_DOWNLOAD) {
+		return;
+	}
+	if (_meshRequestRetries >= MESH_CHUNK_REQUEST_MAX_RETRIES) {
+		LOGAssetFilterSyncerInfo("Download from stoneId=%u timed out", _meshSourceId);
+		onMeshDownloadFailed();
+	}
+	else {
+		_meshRequestRetries++;
+		requestMeshChunk();
 	}
 }
 
@@ -521,10 +866,17 @@ void AssetFilterSyncer::handleEvent(event_t& event) {
 				auto packet             = meshMsg->getPacket<CS_MESH_MODEL_TYPE_ASSET_FILTER_VERSION>();
 				event.result.returnCode = onVersion(meshMsg->srcStoneId, packet);
 			}
+			if (meshMsg->type == CS_MESH_MODEL_TYPE_ASSET_FILTER_CHUNK_REQUEST && meshMsg->isMaybeRelayed == false) {
+				auto packet             = meshMsg->getPacket<CS_MESH_MODEL_TYPE_ASSET_FILTER_CHUNK_REQUEST>();
+				event.result.returnCode = onMeshChunkRequest(meshMsg->srcStoneId, packet);
+			}
+			if (meshMsg->type == CS_MESH_MODEL_TYPE_ASSET_FILTER_CHUNK && meshMsg->isMaybeRelayed == false) {
+				event.result.returnCode = onMeshChunk(meshMsg->srcStoneId, meshMsg->msg);
+			}
 			break;
 		}
 		case CS_TYPE::EVT_FILTERS_UPDATED: {
-			sendVersionAtLowInterval();
+			resetTrickleTimer();
 			break;
 		}
 		case CS_TYPE::EVT_FILTER_MODIFICATION: {
@@ -546,11 +898,6 @@ void AssetFilterSyncer::handleEvent(event_t& event) {
 			onDisconnect();
 			break;
 		}
-		case CS_TYPE::EVT_TICK: {
-			auto tickCount = CS_TYPE_CAST(EVT_TICK, event.data);
-			onTick(*tickCount);
-			break;
-		}
 		default: break;
 	}
 }
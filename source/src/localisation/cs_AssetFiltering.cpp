@@ -93,11 +93,6 @@ cs_ret_code_t AssetFiltering::initInternal() {
 		return retCode;
 	}
 
-	// TODO: move these constants or tie the forwarder up with the store so that they
-	// can decide how fast to tick and trottle
-	_assetForwarder->setThrottleCountdownBumpTicks(
-			_assetStore->throttlingBumpMsToTicks(_assetForwarder->MIN_THROTTLED_ADVERTISEMENT_PERIOD_MS));
-
 	listen();
 	return ERR_SUCCESS;
 }
@@ -215,7 +210,7 @@ void AssetFiltering::handleAcceptedAssetOutputMac(uint8_t filterId, AssetFilter
 	asset_record_t* assetRecord = _assetStore->handleAcceptedAsset(asset, assetId);
 
 	// throttle if the record currently exists and requires it.
-	bool throttle               = (assetRecord != nullptr) && (assetRecord->isThrottled());
+	bool throttle               = (assetRecord != nullptr) && (_assetStore->isThrottled(*assetRecord));
 
 	if (!throttle) {
 		_assetForwarder->sendAssetMacToMesh(assetRecord, asset);
@@ -226,7 +221,7 @@ void AssetFiltering::handleAcceptedAssetOutputMac(uint8_t filterId, AssetFilter
 				assetId.data[0],
 				assetId.data[1],
 				assetId.data[2],
-				assetRecord->throttlingCountdown);
+				_assetStore->getThrottlingCountdown(*assetRecord));
 	}
 }
 
@@ -237,7 +232,7 @@ void AssetFiltering::handleAcceptedAssetOutputAssetId(
 	asset_record_t* assetRecord = _assetStore->handleAcceptedAsset(asset, assetId);
 
 	// throttle if the record currently exists and requires it.
-	bool throttle               = (assetRecord != nullptr) && (assetRecord->isThrottled());
+	bool throttle               = (assetRecord != nullptr) && (_assetStore->isThrottled(*assetRecord));
 
 	if (!throttle) {
 		uint8_t filterBitmask = 0;
@@ -250,7 +245,7 @@ void AssetFiltering::handleAcceptedAssetOutputAssetId(
 				assetId.data[0],
 				assetId.data[1],
 				assetId.data[2],
-				assetRecord->throttlingCountdown);
+				_assetStore->getThrottlingCountdown(*assetRecord));
 	}
 }
 
@@ -261,7 +256,7 @@ void AssetFiltering::handleAcceptedAssetOutputAssetIdNearest(
 	asset_record_t* assetRecord = _assetStore->handleAcceptedAsset(asset, assetId);
 
 	// throttle if the record currently exists and requires it.
-	bool throttle               = (assetRecord != nullptr) && (assetRecord->isThrottled());
+	bool throttle               = (assetRecord != nullptr) && (_assetStore->isThrottled(*assetRecord));
 
 	if (!throttle) {
 		uint8_t filterBitmask = 0;
@@ -279,7 +274,7 @@ void AssetFiltering::handleAcceptedAssetOutputAssetIdNearest(
 				assetId.data[0],
 				assetId.data[1],
 				assetId.data[2],
-				assetRecord->throttlingCountdown);
+				_assetStore->getThrottlingCountdown(*assetRecord));
 	}
 #endif
 }
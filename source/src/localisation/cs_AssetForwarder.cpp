@@ -5,7 +5,9 @@
  * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
  */
 
+#include <cstdlib>
 #include <localisation/cs_AssetForwarder.h>
+#include <localisation/cs_AssetStore.h>
 #include <logging/cs_Logger.h>
 #include <mesh/cs_MeshMsgEvent.h>
 #include <protocol/cs_Packets.h>
@@ -15,9 +17,30 @@
 
 #define LOGAssetForwarderDebug LOGvv
 
+// The throttling countdowns of asset records are ticked every tick.
+static_assert(AssetStore::THROTTLE_COUNTER_PERIOD_MS == TICK_INTERVAL_MS);
+
+AssetForwarder::AssetForwarder()
+		: _rateController(ASSET_MESH_BUDGET_MSGS_PER_MINUTE, TICK_INTERVAL_MS)
+		, _rateControllerRoutine([this]() {
+			_rateController.tick();
+			if (_rateController.isSteady()) {
+				_rateControllerRoutine.stop();
+			}
+			return Coroutine::delayMs(TICK_INTERVAL_MS);
+		}) {}
+
 cs_ret_code_t AssetForwarder::init() {
 	State::getInstance().get(CS_TYPE::CONFIG_CROWNSTONE_ID, &_myStoneId, sizeof(_myStoneId));
+
+	_assetStore = getComponent<AssetStore>();
+	if (_assetStore == nullptr) {
+		return ERR_NOT_FOUND;
+	}
+
 	clearOutbox();
+	// Fill the token bucket.
+	startRateController();
 	listen();
 	return ERR_SUCCESS;
 }
@@ -60,10 +83,6 @@ AssetForwarder::outbox_msg_t* AssetForwarder::findSimilar(outbox_msg_t& outMsg)
 	return nullptr;
 }
 
-void AssetForwarder::setThrottleCountdownBumpTicks(uint8_t ticks) {
-	_throttleCountdownBumpTicks = ticks;
-}
-
 // ------------- message management -------------
 
 bool AssetForwarder::sendAssetMacToMesh(asset_record_t* record, const scanned_device_t& asset) {
@@ -91,6 +110,7 @@ bool AssetForwarder::sendAssetIdToMesh(
 	outMsg.idMsg.rssi          = asset.rssi;
 	outMsg.idMsg.channel       = compressChannel(asset.channel);
 	outMsg.idMsg.reserved      = 0;
+	outMsg.idMsg.counter       = 0;
 	outMsg.idMsg.filterBitmask = filterBitmask;
 
 	return addToOutbox(outMsg);
@@ -128,7 +148,7 @@ bool AssetForwarder::dispatchOutboxMessage(outbox_msg_t& outMsg) {
 	}
 
 	if (outMsg.record != nullptr) {
-		outMsg.record->addThrottlingCountdown(_throttleCountdownBumpTicks);
+		_assetStore->addThrottlingCountdown(*outMsg.record, AssetRateController::MIN_REPORT_INTERVAL_TICKS);
 	}
 
 	// forward message over uart (e.g. hub dongle directly receives asset advertisement)
@@ -138,6 +158,12 @@ bool AssetForwarder::dispatchOutboxMessage(outbox_msg_t& outMsg) {
 			break;
 		}
 		case CS_MESH_MODEL_TYPE_ASSET_INFO_ID: {
+			// Let the receivers tell copies of this report apart from a new report with the same content.
+			_reportCounter++;
+			if (_reportCounter == 0) {
+				_reportCounter++;
+			}
+			outMsg.idMsg.counter = _reportCounter;
 			forwardAssetToUart(outMsg.idMsg, _myStoneId);
 			break;
 		}
@@ -147,6 +173,31 @@ bool AssetForwarder::dispatchOutboxMessage(outbox_msg_t& outMsg) {
 		}
 	}
 
+	// Only the mesh is rate limited.
+	if (outMsg.record != nullptr && _assetStore->isMeshThrottled(*outMsg.record)) {
+		return false;
+	}
+
+	// Without record, the asset is considered to be moving.
+	uint8_t rssiDelta = 0xFF;
+	if (outMsg.record != nullptr) {
+		rssiDelta = std::abs(outMsg.record->myRssi.getRssi() - outMsg.record->lastReportedRssi);
+	}
+
+	uint16_t throttleTicks;
+	bool allowed = _rateController.requestReport(rssiDelta, throttleTicks);
+	startRateController();
+	if (outMsg.record != nullptr) {
+		_assetStore->setMeshThrottlingCountdown(*outMsg.record, throttleTicks);
+	}
+	if (!allowed) {
+		LOGAssetForwarderDebug("Rate limited");
+		return false;
+	}
+	if (outMsg.record != nullptr) {
+		outMsg.record->lastReportedRssi = outMsg.record->myRssi.getRssi();
+	}
+
 	LOGAssetForwarderDebug("dispatched outbox message");
 
 	cs_mesh_msg_t msgWrapper;
@@ -158,6 +209,7 @@ bool AssetForwarder::dispatchOutboxMessage(outbox_msg_t& outMsg) {
 
 	event_t meshMsgEvt(CS_TYPE::CMD_SEND_MESH_MSG, &msgWrapper, sizeof(msgWrapper));
 	meshMsgEvt.dispatch();
+	_rateController.onReportSent(meshMsgEvt.result.returnCode == ERR_BUSY);
 
 	return true;
 }
@@ -198,11 +250,15 @@ void AssetForwarder::handleEvent(event_t& event) {
 			switch (meshMsg->type) {
 				case CS_MESH_MODEL_TYPE_ASSET_INFO_MAC: {
 					forwardAssetToUart(meshMsg->getPacket<CS_MESH_MODEL_TYPE_ASSET_INFO_MAC>(), meshMsg->srcStoneId);
+					_rateController.onReportReceived();
+					startRateController();
 					event.result.returnCode = ERR_SUCCESS;
 					break;
 				}
 				case CS_MESH_MODEL_TYPE_ASSET_INFO_ID: {
 					forwardAssetToUart(meshMsg->getPacket<CS_MESH_MODEL_TYPE_ASSET_INFO_ID>(), meshMsg->srcStoneId);
+					_rateController.onReportReceived();
+					startRateController();
 					event.result.returnCode = ERR_SUCCESS;
 					break;
 				}
@@ -216,6 +272,12 @@ void AssetForwarder::handleEvent(event_t& event) {
 	}
 }
 
+void AssetForwarder::startRateController() {
+	if (!_rateControllerRoutine.isStarted()) {
+		_rateControllerRoutine.start(TICK_INTERVAL_MS);
+	}
+}
+
 void AssetForwarder::forwardAssetToUart(
 		const cs_mesh_model_msg_asset_report_mac_t& assetMsg, stone_id_t seenByStoneId) {
 	LOGAssetForwarderDebug(
@@ -0,0 +1,93 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <localisation/cs_AssetRateController.h>
+#include <util/cs_Math.h>
+
+AssetRateController::AssetRateController(uint16_t budgetPerMinute, uint16_t tickIntervalMs)
+		: _ticksPerMinute(60 * 1000 / tickIntervalMs) {
+	setBudget(budgetPerMinute);
+	_rate = _budget;
+}
+
+void AssetRateController::setBudget(uint16_t budgetPerMinute) {
+	_budget = CsMath::max(static_cast<uint32_t>(budgetPerMinute) * WINDOW_TICKS / _ticksPerMinute, MIN_RATE);
+	_rate   = CsMath::min(_rate, _budget);
+}
+
+bool AssetRateController::requestReport(uint8_t rssiDelta, uint16_t& intervalTicks) {
+	if (_tokens < WINDOW_TICKS) {
+		// Try again soon.
+		_windowDeniedCount++;
+		intervalTicks = MIN_REPORT_INTERVAL_TICKS;
+		return false;
+	}
+	_tokens -= WINDOW_TICKS;
+
+	intervalTicks = _reportIntervalTicks;
+	if (rssiDelta < MOVING_RSSI_DELTA) {
+		intervalTicks = CsMath::min(intervalTicks * STABLE_INTERVAL_MULTIPLIER, MAX_REPORT_INTERVAL_TICKS);
+	}
+	return true;
+}
+
+void AssetRateController::onReportSent(bool queueFull) {
+	if (queueFull) {
+		_windowQueueFull = true;
+		return;
+	}
+	_windowSentCount++;
+}
+
+void AssetRateController::onReportReceived() {
+	_windowReceivedCount++;
+}
+
+void AssetRateController::tick() {
+	// Allow a burst of at most 1 window worth of reports.
+	_tokens = CsMath::min(_tokens + _rate, static_cast<uint32_t>(_rate) * WINDOW_TICKS);
+
+	_windowTicks++;
+	if (_windowTicks >= WINDOW_TICKS) {
+		onWindowEnd();
+	}
+}
+
+bool AssetRateController::isSteady() const {
+	return _tokens == static_cast<uint32_t>(_rate) * WINDOW_TICKS && _rate == _budget
+		   && _reportIntervalTicks == MIN_REPORT_INTERVAL_TICKS && _windowSentCount == 0 && _windowReceivedCount == 0
+		   && _windowDeniedCount == 0 && !_windowQueueFull;
+}
+
+void AssetRateController::onWindowEnd() {
+	uint32_t total = _windowSentCount + _windowReceivedCount;
+
+	// Additive increase, multiplicative decrease of the send rate.
+	if (_windowQueueFull || total > _budget) {
+		_rate = CsMath::max(_rate / 2, MIN_RATE);
+	}
+	else {
+		_rate = CsMath::min(_rate + RATE_INCREASE_STEP, _budget);
+	}
+
+	// Spread the reports over the assets: back off when reports had to be denied.
+	if (_windowDeniedCount > 0) {
+		_reportIntervalTicks = CsMath::min(_reportIntervalTicks * 2, MAX_REPORT_INTERVAL_TICKS);
+	}
+	else if (_reportIntervalTicks > MIN_REPORT_INTERVAL_TICKS + REPORT_INTERVAL_STEP_TICKS) {
+		_reportIntervalTicks -= REPORT_INTERVAL_STEP_TICKS;
+	}
+	else {
+		_reportIntervalTicks = MIN_REPORT_INTERVAL_TICKS;
+	}
+
+	_windowTicks         = 0;
+	_windowSentCount     = 0;
+	_windowReceivedCount = 0;
+	_windowDeniedCount   = 0;
+	_windowQueueFull     = false;
+}
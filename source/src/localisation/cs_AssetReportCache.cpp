@@ -0,0 +1,59 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <localisation/cs_AssetReportCache.h>
+
+bool AssetReportCache::contains(const cs_mesh_model_msg_asset_report_id_t& report, stone_id_t reporter) const {
+	if (report.counter == 0) {
+		return false;
+	}
+	for (auto& entry : _entries) {
+		if (entry.ticksLeft != 0 && entry.reporterId == reporter && entry.counter == report.counter
+			&& entry.assetId == report.id) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void AssetReportCache::add(const cs_mesh_model_msg_asset_report_id_t& report, stone_id_t reporter) {
+	if (report.counter == 0) {
+		return;
+	}
+	auto& entry      = _entries[_nextIndex];
+	entry.assetId    = report.id;
+	entry.reporterId = reporter;
+	entry.counter    = report.counter;
+	entry.ticksLeft  = TIMEOUT_TICKS;
+	_nextIndex       = (_nextIndex + 1) % SIZE;
+}
+
+void AssetReportCache::countLookup(bool hit) {
+	if (hit) {
+		_hitCount++;
+	}
+	else {
+		_missCount++;
+	}
+}
+
+void AssetReportCache::onTick() {
+	for (auto& entry : _entries) {
+		if (entry.ticksLeft != 0) {
+			entry.ticksLeft--;
+		}
+	}
+}
+
+bool AssetReportCache::isEmpty() const {
+	for (auto& entry : _entries) {
+		if (entry.ticksLeft != 0) {
+			return false;
+		}
+	}
+	return true;
+}
@@ -15,33 +15,45 @@
 #define LOGAssetStoreVerbose LOGvv
 
 AssetStore::AssetStore()
-		: updateLastReceivedCounterRoutine([this]() {
-			incrementLastReceivedCounters();
-			return Coroutine::delayMs(LAST_RECEIVED_COUNTER_PERIOD_MS);
-		})
-		, updateLastSentCounterRoutine([this]() {
-			decrementThrottlingCounters();
-			return Coroutine::delayMs(THROTTLE_COUNTER_PERIOD_MS);
-		})
+		: updateLastReceivedCounterRoutine(
+				[this]() {
+					tickTimeouts();
+					if (_timeouts.isEmpty()) {
+						updateLastReceivedCounterRoutine.stop();
+					}
+					return Coroutine::delayMs(LAST_RECEIVED_COUNTER_PERIOD_MS);
+				},
+				LAST_RECEIVED_COUNTER_JITTER_MS)
+		, updateLastSentCounterRoutine(
+				[this]() {
+					// Expired countdowns are simply no longer scheduled.
+					_throttles.tick([](uint8_t) {});
+					if (_throttles.isEmpty()) {
+						updateLastSentCounterRoutine.stop();
+					}
+					return Coroutine::delayMs(THROTTLE_COUNTER_PERIOD_MS);
+				},
+				THROTTLE_COUNTER_JITTER_MS)
 
 {}
 
 cs_ret_code_t AssetStore::init() {
 	LOGAssetStoreInfo("Init: using buffer of %u B", sizeof(_store));
 	_store.clear();
+	_timeouts.clear();
+	_throttles.clear();
 	listen();
 
 	return ERR_SUCCESS;
 }
 
 void AssetStore::handleEvent(event_t& event) {
-	updateLastReceivedCounterRoutine.handleEvent(event);
-	updateLastSentCounterRoutine.handleEvent(event);
-
 	switch (event.type) {
 		case CS_TYPE::EVT_FILTERS_UPDATED: {
 			LOGAssetStoreDebug("resetRecords");
 			_store.clear();
+			_timeouts.clear();
+			_throttles.clear();
 			break;
 		}
 		default: {
@@ -54,8 +66,11 @@ asset_record_t* AssetStore::handleAcceptedAsset(const scanned_device_t& asset, c
 	LOGAssetStoreVerbose("handleAcceptedAsset id=%02X:%02X:%02X", assetId.data[0], assetId.data[1], assetId.data[2]);
 	asset_record_t* record = getOrCreateRecord(assetId);
 	if (record != nullptr) {
-		record->myRssi              = rssi_and_channel_t(asset.rssi, asset.channel);
-		record->lastReceivedCounter = 0;
+		record->myRssi = rssi_and_channel_t(asset.rssi, asset.channel);
+		_timeouts.schedule(getIndex(*record), LAST_RECEIVED_TIMEOUT_THRESHOLD_S);
+		if (!updateLastReceivedCounterRoutine.isStarted()) {
+			updateLastReceivedCounterRoutine.start(LAST_RECEIVED_COUNTER_PERIOD_MS);
+		}
 	}
 	else {
 		LOGAssetStoreDebug(
@@ -75,13 +90,14 @@ asset_record_t* AssetStore::getOrCreateRecord(const asset_id_t& id) {
 		// record found, or empty space was newly occupied.
 		rec->empty();
 		rec->assetId = id;
+		clearThrottling(getIndex(*rec));
 		return rec;
 	}
 
-	// Last option, overwrite oldest record.
+	// Last option, overwrite oldest record: the one that times out first.
 	asset_record_t* oldestRecord = _store.begin();
 	for (asset_record_t* record = _store.begin(); record != _store.end(); record++) {
-		if (record->lastReceivedCounter > oldestRecord->lastReceivedCounter) {
+		if (_timeouts.remaining(getIndex(*record)) < _timeouts.remaining(getIndex(*oldestRecord))) {
 			oldestRecord = record;
 		}
 	}
@@ -94,9 +110,60 @@ asset_record_t* AssetStore::getOrCreateRecord(const asset_id_t& id) {
 
 	oldestRecord->empty();
 	oldestRecord->assetId = id;
+	clearThrottling(getIndex(*oldestRecord));
 	return oldestRecord;
 }
 
+uint8_t AssetStore::getIndex(asset_record_t& record) {
+	return &record - _store.begin();
+}
+
+uint8_t AssetStore::getLastReceivedCounter(asset_record_t& record) {
+	return LAST_RECEIVED_TIMEOUT_THRESHOLD_S - _timeouts.remaining(getIndex(record));
+}
+
+bool AssetStore::isThrottled(asset_record_t& record) {
+	return _throttles.isScheduled(getIndex(record));
+}
+
+uint16_t AssetStore::getThrottlingCountdown(asset_record_t& record) {
+	return _throttles.remaining(getIndex(record));
+}
+
+void AssetStore::addThrottlingCountdown(asset_record_t& record, uint16_t ticks) {
+	uint8_t index = getIndex(record);
+	uint32_t sum  = _throttles.remaining(index) + ticks;
+	if (sum != 0) {
+		scheduleThrottling(index, std::min<uint32_t>(sum, MAX_THROTTLE_TICKS));
+	}
+}
+
+bool AssetStore::isMeshThrottled(asset_record_t& record) {
+	return _throttles.isScheduled(MAX_RECORDS + getIndex(record));
+}
+
+void AssetStore::setMeshThrottlingCountdown(asset_record_t& record, uint16_t ticks) {
+	uint8_t index = MAX_RECORDS + getIndex(record);
+	if (ticks == 0) {
+		_throttles.cancel(index);
+	}
+	else {
+		scheduleThrottling(index, std::min(ticks, MAX_THROTTLE_TICKS));
+	}
+}
+
+void AssetStore::scheduleThrottling(uint8_t index, uint16_t ticks) {
+	_throttles.schedule(index, ticks);
+	if (!updateLastSentCounterRoutine.isStarted()) {
+		updateLastSentCounterRoutine.start(THROTTLE_COUNTER_PERIOD_MS);
+	}
+}
+
+void AssetStore::clearThrottling(uint8_t index) {
+	_throttles.cancel(index);
+	_throttles.cancel(MAX_RECORDS + index);
+}
+
 void AssetStore::addThrottlingBump(asset_record_t& record, uint16_t timeToNextThrottleOpenMs) {
 
 	LOGAssetStoreVerbose(
@@ -104,7 +171,7 @@ void AssetStore::addThrottlingBump(asset_record_t& record, uint16_t timeToNextTh
 			throttlingBumpMsToTicks(timeToNextThrottleOpenMs),
 			timeToNextThrottleOpenMs);
 
-	record.addThrottlingCountdown(throttlingBumpMsToTicks(timeToNextThrottleOpenMs));
+	addThrottlingCountdown(record, throttlingBumpMsToTicks(timeToNextThrottleOpenMs));
 }
 
 uint16_t AssetStore::throttlingBumpMsToTicks(uint16_t timeToNextThrottleOpenMs) {
@@ -115,37 +182,12 @@ uint16_t AssetStore::throttlingBumpMsToTicks(uint16_t timeToNextThrottleOpenMs)
 	return ticksRoundedUp;
 }
 
-void AssetStore::incrementLastReceivedCounters() {
-	for (auto& record : _store) {
-		if (!record.isValid()) {
-			// skip invalid records
-			continue;
-		}
-
-		if (record.lastReceivedCounter < 0xFF) {
-			record.lastReceivedCounter++;
-		}
-
-		if (record.lastReceivedCounter >= LAST_RECEIVED_TIMEOUT_THRESHOLD_S) {
-			LOGAssetStoreDebug(
-					"Asset timed out. %02X:%02X:%02X",
-					record.assetId.data[0],
-					record.assetId.data[1],
-					record.assetId.data[2]);
-			record.invalidate();
-		}
-	}
-}
-
-void AssetStore::decrementThrottlingCounters() {
-	for (auto& record : _store) {
-		if (!record.isValid()) {
-			// skip invalid records
-			continue;
-		}
-
-		if (record.throttlingCountdown > 0) {
-			record.throttlingCountdown--;
-		}
-	}
+void AssetStore::tickTimeouts() {
+	_timeouts.tick([this](uint8_t index) {
+		asset_record_t& record = _store.begin()[index];
+		LOGAssetStoreDebug(
+				"Asset timed out. %02X:%02X:%02X", record.assetId.data[0], record.assetId.data[1], record.assetId.data[2]);
+		record.invalidate();
+		clearThrottling(index);
+	});
 }
@@ -6,16 +6,25 @@
  */
 
 #include <ble/cs_Nordic.h>
+#include <drivers/cs_Serial.h>
 #include <localisation/cs_MeshTopology.h>
 #include <protocol/cs_RssiAndChannel.h>
 #include <storage/cs_State.h>
 #include <uart/cs_UartHandler.h>
+#include <util/cs_Math.h>
 #include <util/cs_Utils.h>
 
+#include <cstdlib>
+#include <cstring>
+
 #define LOGMeshTopologyInfo LOGi
 #define LOGMeshTopologyDebug LOGvv
 #define LOGMeshTopologyVerbose LOGvv
 
+// Maximum number of links in a single mesh topology UART message.
+constexpr uint8_t MAX_UART_LINKS_PER_MSG =
+		(UART_TX_MAX_PAYLOAD_SIZE - sizeof(mesh_topology_matrix_header_uart_t)) / sizeof(mesh_topology_link_uart_t);
+
 cs_ret_code_t MeshTopology::init() {
 
 	State::getInstance().get(CS_TYPE::CONFIG_CROWNSTONE_ID, &_myId, sizeof(_myId));
@@ -24,9 +33,17 @@ cs_ret_code_t MeshTopology::init() {
 	if (_neighbours == nullptr) {
 		return ERR_NO_SPACE;
 	}
+	_neighbourIndex = new (std::nothrow) uint8_t[NEIGHBOUR_INDEX_SIZE];
+	if (_neighbourIndex == nullptr) {
+		return ERR_NO_SPACE;
+	}
 	reset();
 	listen();
 
+	if constexpr (TripwireResearch) {
+		_tripwireTickRequest.request();
+	}
+
 #if BUILD_MESH_TOPOLOGY_RESEARCH == 1
 	_research.init();
 #endif
@@ -39,11 +56,20 @@ void MeshTopology::reset() {
 
 	// Remove stored neighbours.
 	_neighbourCount        = 0;
+	_pendingRemovalCount   = 0;
+	_linkCount             = 0;
+	_timeouts.clear();
+	rebuildIndex();
 
 	// Let everyone first send a noop, and then the first result.
 	_sendNoopCountdown     = 1;
 	_sendCountdown         = 2;
+	_sendLegacyCountdown   = 2;
 	_fastIntervalCountdown = FAST_INTERVAL_TIMEOUT_SECONDS;
+
+	// Wait for an old message from a crownstone that doesn't send the digest.
+	_legacySenderMinutesAgo = LEGACY_TIMEOUT_MINUTES;
+	memset(_digestSenders, 0, sizeof(_digestSenders));
 }
 
 cs_ret_code_t MeshTopology::getMacAddress(stone_id_t stoneId) {
@@ -90,7 +116,10 @@ void MeshTopology::add(stone_id_t id, int8_t rssi, uint8_t channel) {
 	if (index == INDEX_NOT_FOUND) {
 		if (_neighbourCount < MAX_NEIGHBOURS) {
 			clearNeighbourRssi(_neighbours[_neighbourCount]);
+			_neighbours[_neighbourCount].reportedRssi = {};
 			updateNeighbour(_neighbours[_neighbourCount], id, rssi, channel);
+			_timeouts.schedule(_neighbourCount, TIMEOUT_SECONDS);
+			addToIndex(_neighbourCount);
 			_neighbourCount++;
 		}
 		else {
@@ -99,6 +128,7 @@ void MeshTopology::add(stone_id_t id, int8_t rssi, uint8_t channel) {
 	}
 	else {
 		updateNeighbour(_neighbours[index], id, rssi, channel);
+		_timeouts.schedule(index, TIMEOUT_SECONDS);
 	}
 }
 
@@ -119,7 +149,10 @@ void MeshTopology::updateNeighbour(neighbour_node_t& node, stone_id_t id, int8_t
 			break;
 		}
 	}
-	node.lastSeenSecondsAgo = 0;
+}
+
+uint8_t MeshTopology::getLastSeenSecondsAgo(uint8_t index) {
+	return TIMEOUT_SECONDS - _timeouts.remaining(index);
 }
 
 
@@ -130,14 +163,76 @@ void MeshTopology::clearNeighbourRssi(neighbour_node_t& node) {
 }
 
 uint8_t MeshTopology::find(stone_id_t id) {
-	for (uint8_t index = 0; index < _neighbourCount; ++index) {
+	// Stone IDs are usually assigned incrementally, so the ID itself makes a good hash.
+	uint8_t bucket = id & (NEIGHBOUR_INDEX_SIZE - 1);
+	for (uint8_t probe = 0; probe < NEIGHBOUR_INDEX_SIZE; ++probe) {
+		uint8_t index = _neighbourIndex[bucket];
+		if (index == INDEX_NOT_FOUND) {
+			return INDEX_NOT_FOUND;
+		}
 		if (_neighbours[index].id == id) {
 			return index;
 		}
+		bucket = (bucket + 1) & (NEIGHBOUR_INDEX_SIZE - 1);
 	}
 	return INDEX_NOT_FOUND;
 }
 
+void MeshTopology::addToIndex(uint8_t index) {
+	// The index is larger than the list, so there is always an empty bucket.
+	uint8_t bucket = _neighbours[index].id & (NEIGHBOUR_INDEX_SIZE - 1);
+	while (_neighbourIndex[bucket] != INDEX_NOT_FOUND) {
+		bucket = (bucket + 1) & (NEIGHBOUR_INDEX_SIZE - 1);
+	}
+	_neighbourIndex[bucket] = index;
+}
+
+void MeshTopology::rebuildIndex() {
+	memset(_neighbourIndex, INDEX_NOT_FOUND, NEIGHBOUR_INDEX_SIZE);
+	for (uint8_t index = 0; index < _neighbourCount; ++index) {
+		addToIndex(index);
+	}
+}
+
+uint8_t MeshTopology::quantiseRssi(int8_t rssi) {
+	if (rssi == RSSI_INIT) {
+		return 0;
+	}
+	// Valid values are 1 to 31, as 0 is reserved for no data.
+	return CsMath::clamp((rssi - RSSI_QUANTISATION_MIN) / RSSI_QUANTISATION_STEP + 1, 1, 31);
+}
+
+int8_t MeshTopology::dequantiseRssi(uint8_t quantisedRssi) {
+	if (quantisedRssi == 0) {
+		return RSSI_INIT;
+	}
+	return RSSI_QUANTISATION_MIN + (quantisedRssi - 1) * RSSI_QUANTISATION_STEP;
+}
+
+cs_mesh_model_quantised_rssi_t MeshTopology::getQuantisedRssi(const neighbour_node_t& node) {
+	cs_mesh_model_quantised_rssi_t quantised;
+	quantised.channel37 = quantiseRssi(node.rssiChannel37);
+	quantised.channel38 = quantiseRssi(node.rssiChannel38);
+	quantised.channel39 = quantiseRssi(node.rssiChannel39);
+	quantised.reserved  = 0;
+	return quantised;
+}
+
+bool MeshTopology::hasChanged(const neighbour_node_t& node) {
+	cs_mesh_model_quantised_rssi_t current = getQuantisedRssi(node);
+	uint8_t currentValues[]                = {current.channel37, current.channel38, current.channel39};
+	uint8_t reportedValues[] = {node.reportedRssi.channel37, node.reportedRssi.channel38, node.reportedRssi.channel39};
+	for (uint8_t i = 0; i < MESH_TOPOLOGY_CHANNEL_COUNT; ++i) {
+		if ((currentValues[i] == 0) != (reportedValues[i] == 0)) {
+			return true;
+		}
+		if (std::abs(currentValues[i] - reportedValues[i]) >= DIGEST_RSSI_THRESHOLD) {
+			return true;
+		}
+	}
+	return false;
+}
+
 void MeshTopology::getRssi(stone_id_t stoneId, cs_result_t& result) {
 	uint8_t index = find(stoneId);
 	if (index == INDEX_NOT_FOUND) {
@@ -182,53 +277,122 @@ void MeshTopology::sendNoop() {
 	event.dispatch();
 }
 
-void MeshTopology::sendNext() {
-	if (_neighbourCount == 0) {
-		// Nothing to send.
-		return;
+bool MeshTopology::sendDigest(bool refresh) {
+	cs_mesh_model_msg_neighbour_rssi_digest_t digest = {};
+	uint8_t linkCount                                = 0;
+
+	// Lost neighbours first.
+	while (_pendingRemovalCount > 0 && linkCount < MESH_NEIGHBOUR_RSSI_DIGEST_LINK_COUNT) {
+		_pendingRemovalCount--;
+		digest.links[linkCount].neighbourId = _pendingRemovals[_pendingRemovalCount];
+		linkCount++;
 	}
 
-	// Make sure index is valid.
-	if (_nextSendIndex >= _neighbourCount) {
-		_nextSendIndex = 0;
+	// Then the neighbours with changed RSSI.
+	for (uint8_t i = 0; i < _neighbourCount && linkCount < MESH_NEIGHBOUR_RSSI_DIGEST_LINK_COUNT; ++i) {
+		if (hasChanged(_neighbours[i])) {
+			_neighbours[i].reportedRssi         = getQuantisedRssi(_neighbours[i]);
+			digest.links[linkCount].neighbourId = _neighbours[i].id;
+			digest.links[linkCount].rssi        = _neighbours[i].reportedRssi;
+			linkCount++;
+		}
 	}
 
-	auto& node = _neighbours[_nextSendIndex];
-	LOGMeshTopologyDebug(
-			"sendNextMeshMessage index=%u id=%u lastSeenSecondsAgo=%u",
-			_nextSendIndex,
-			node.id,
-			node.lastSeenSecondsAgo);
+	// Fill up with the next neighbours in the list.
+	for (uint8_t i = 0; refresh && i < _neighbourCount && linkCount < MESH_NEIGHBOUR_RSSI_DIGEST_LINK_COUNT; ++i) {
+		if (_nextSendIndex >= _neighbourCount) {
+			_nextSendIndex = 0;
+		}
+		auto& node = _neighbours[_nextSendIndex];
+		_nextSendIndex++;
+		bool alreadyAdded = false;
+		for (uint8_t j = 0; j < linkCount; ++j) {
+			alreadyAdded |= (digest.links[j].neighbourId == node.id);
+		}
+		if (alreadyAdded) {
+			continue;
+		}
+		node.reportedRssi                   = getQuantisedRssi(node);
+		digest.links[linkCount].neighbourId = node.id;
+		digest.links[linkCount].rssi        = node.reportedRssi;
+		linkCount++;
+	}
 
-	cs_mesh_model_msg_neighbour_rssi_t meshPayload = sendNeighbourMessageOverMesh(node);
+	if (linkCount == 0) {
+		return false;
+	}
+	digest.counter = _msgCount++;
+	LOGMeshTopologyDebug(
+			"sendDigest refresh=%u id=%u id=%u", refresh, digest.links[0].neighbourId, digest.links[1].neighbourId);
 
 	TYPIFY(CMD_SEND_MESH_MSG) meshMsg;
-	meshMsg.type = CS_MESH_MODEL_TYPE_NEIGHBOUR_RSSI;
-	meshMsg.reliability = CS_MESH_RELIABILITY_LOWEST;
-	meshMsg.urgency = CS_MESH_URGENCY_LOW;
+	meshMsg.type                   = CS_MESH_MODEL_TYPE_NEIGHBOUR_RSSI_DIGEST;
+	meshMsg.reliability            = CS_MESH_RELIABILITY_LOWEST;
+	meshMsg.urgency                = CS_MESH_URGENCY_LOW;
 	meshMsg.flags.flags.doNotRelay = false;
-	meshMsg.payload = reinterpret_cast<uint8_t*>(&meshPayload);
-	meshMsg.size = sizeof(meshPayload);
+	meshMsg.payload                = reinterpret_cast<uint8_t*>(&digest);
+	meshMsg.size                   = sizeof(digest);
 
 	event_t event(CS_TYPE::CMD_SEND_MESH_MSG, &meshMsg, sizeof(meshMsg));
 	event.dispatch();
 
-	// Also send over UART.
-	sendRssiToUart(_myId, meshPayload);
+	// Also send over UART, with the unquantised RSSI.
+	for (uint8_t i = 0; i < linkCount; ++i) {
+		cs_mesh_model_msg_neighbour_rssi_t packet = {
+				.type               = 0,
+				.neighbourId        = digest.links[i].neighbourId,
+				.rssiChannel37      = RSSI_INIT,
+				.rssiChannel38      = RSSI_INIT,
+				.rssiChannel39      = RSSI_INIT,
+				.lastSeenSecondsAgo = 0,
+				.counter            = digest.counter};
+		uint8_t index = find(packet.neighbourId);
+		if (index != INDEX_NOT_FOUND) {
+			packet.rssiChannel37      = _neighbours[index].rssiChannel37;
+			packet.rssiChannel38      = _neighbours[index].rssiChannel38;
+			packet.rssiChannel39      = _neighbours[index].rssiChannel39;
+			packet.lastSeenSecondsAgo = getLastSeenSecondsAgo(index);
+		}
+		sendRssiToUart(_myId, packet);
+	}
+	return true;
+}
+
+void MeshTopology::sendLegacyNext() {
+	if (_neighbourCount == 0) {
+		// Nothing to send.
+		return;
+	}
+
+	// Make sure index is valid.
+	if (_nextLegacySendIndex >= _neighbourCount) {
+		_nextLegacySendIndex = 0;
+	}
+
+	LOGMeshTopologyDebug("sendLegacyNext index=%u id=%u", _nextLegacySendIndex, _neighbours[_nextLegacySendIndex].id);
+	sendNeighbourMessageOverMesh(_neighbours[_nextLegacySendIndex], getLastSeenSecondsAgo(_nextLegacySendIndex));
 
 	// Send next item in the list next time.
-	_nextSendIndex++;
+	_nextLegacySendIndex++;
+}
+
+bool MeshTopology::legacyIsNeeded() {
+	return _legacySenderMinutesAgo < LEGACY_TIMEOUT_MINUTES;
 }
 
+bool MeshTopology::isDigestSender(stone_id_t id) {
+	return (_digestSenders[id / 32] >> (id % 32)) & 1;
+}
 
-cs_mesh_model_msg_neighbour_rssi_t MeshTopology::sendNeighbourMessageOverMesh(neighbour_node_t& node) {
+cs_mesh_model_msg_neighbour_rssi_t MeshTopology::sendNeighbourMessageOverMesh(
+		neighbour_node_t& node, uint8_t lastSeenSecondsAgo) {
 	cs_mesh_model_msg_neighbour_rssi_t meshPayload = {
 				.type = 0,
 				.neighbourId = node.id,
 				.rssiChannel37 = node.rssiChannel37,
 				.rssiChannel38 = node.rssiChannel38,
 				.rssiChannel39 = node.rssiChannel39,
-				.lastSeenSecondsAgo = node.lastSeenSecondsAgo,
+				.lastSeenSecondsAgo = lastSeenSecondsAgo,
 				.counter = _msgCount++
 		};
 
@@ -262,8 +426,141 @@ void MeshTopology::sendRssiToUart(stone_id_t receiverId, cs_mesh_model_msg_neigh
 }
 
 void MeshTopology::onNeighbourRssi(stone_id_t id, cs_mesh_model_msg_neighbour_rssi_t& packet) {
+	if (isDigestSender(id)) {
+		// The same link is received via the digest.
+		return;
+	}
+	// The sender has older firmware, so keep sending the old message for it to forward.
+	_legacySenderMinutesAgo = 0;
+
 	// Send to UART.
 	sendRssiToUart(id, packet);
+
+	// Crownstones with older firmware only send this message, so keep the link as if it came from a digest.
+	cs_mesh_model_neighbour_rssi_link_t link;
+	link.neighbourId    = packet.neighbourId;
+	link.rssi.channel37 = quantiseRssi(packet.rssiChannel37);
+	link.rssi.channel38 = quantiseRssi(packet.rssiChannel38);
+	link.rssi.channel39 = quantiseRssi(packet.rssiChannel39);
+	link.rssi.reserved  = 0;
+	updateLink(id, link);
+}
+
+void MeshTopology::onNeighbourRssiDigest(stone_id_t id, cs_mesh_model_msg_neighbour_rssi_digest_t& packet) {
+	_digestSenders[id / 32] |= (1u << (id % 32));
+	for (auto& link : packet.links) {
+		if (link.neighbourId == 0) {
+			continue;
+		}
+		// Send to UART in the same format as the single neighbour message.
+		cs_mesh_model_msg_neighbour_rssi_t neighbourPacket = {
+				.type               = 0,
+				.neighbourId        = link.neighbourId,
+				.rssiChannel37      = dequantiseRssi(link.rssi.channel37),
+				.rssiChannel38      = dequantiseRssi(link.rssi.channel38),
+				.rssiChannel39      = dequantiseRssi(link.rssi.channel39),
+				.lastSeenSecondsAgo = 0,
+				.counter            = packet.counter};
+		sendRssiToUart(id, neighbourPacket);
+		updateLink(id, link);
+	}
+}
+
+void MeshTopology::updateLink(stone_id_t receiverId, const cs_mesh_model_neighbour_rssi_link_t& link) {
+	if (_links == nullptr) {
+		// Only the node that is connected to a hub needs to keep the links.
+		if (serial_get_state() != SERIAL_ENABLE_RX_AND_TX) {
+			return;
+		}
+		_links = new (std::nothrow) link_t[MAX_LINKS];
+		if (_links == nullptr) {
+			LOGw("Can't allocate links");
+			return;
+		}
+		_linkCount = 0;
+	}
+
+	bool remove = (link.rssi.channel37 == 0 && link.rssi.channel38 == 0 && link.rssi.channel39 == 0);
+	for (uint16_t i = 0; i < _linkCount; ++i) {
+		if (_links[i].receiverId == receiverId && _links[i].senderId == link.neighbourId) {
+			if (remove) {
+				// Order is irrelevant, so simply move the last link to this spot.
+				_linkCount--;
+				_links[i] = _links[_linkCount];
+				return;
+			}
+			_links[i].rssi                 = link.rssi;
+			_links[i].lastUpdateMinutesAgo = 0;
+			return;
+		}
+	}
+	if (remove) {
+		return;
+	}
+	if (_linkCount >= MAX_LINKS) {
+		LOGw("Can't add link %u - %u", receiverId, link.neighbourId);
+		return;
+	}
+	_links[_linkCount].receiverId           = receiverId;
+	_links[_linkCount].senderId             = link.neighbourId;
+	_links[_linkCount].rssi                 = link.rssi;
+	_links[_linkCount].lastUpdateMinutesAgo = 0;
+	_linkCount++;
+}
+
+mesh_topology_link_uart_t MeshTopology::getUartLink(uint16_t index) {
+	// Our own neighbours first, with the unquantised RSSI.
+	if (index < _neighbourCount) {
+		return mesh_topology_link_uart_t{
+				.receiverId           = _myId,
+				.senderId             = _neighbours[index].id,
+				.rssiChannel37        = _neighbours[index].rssiChannel37,
+				.rssiChannel38        = _neighbours[index].rssiChannel38,
+				.rssiChannel39        = _neighbours[index].rssiChannel39,
+				.lastUpdateMinutesAgo = static_cast<uint8_t>(getLastSeenSecondsAgo(index) / 60)};
+	}
+
+	// Then the links between other crownstones.
+	link_t& link = _links[index - _neighbourCount];
+	return mesh_topology_link_uart_t{
+			.receiverId           = link.receiverId,
+			.senderId             = link.senderId,
+			.rssiChannel37        = dequantiseRssi(link.rssi.channel37),
+			.rssiChannel38        = dequantiseRssi(link.rssi.channel38),
+			.rssiChannel39        = dequantiseRssi(link.rssi.channel39),
+			.lastUpdateMinutesAgo = link.lastUpdateMinutesAgo};
+}
+
+cs_ret_code_t MeshTopology::sendMatrixToUart() {
+	uint16_t totalLinkCount = _neighbourCount + _linkCount;
+	LOGMeshTopologyInfo("sendMatrixToUart linkCount=%u", totalLinkCount);
+
+	// Always send at least 1 message, so that an empty topology is sent as well.
+	UartHandler& uart  = UartHandler::getInstance();
+	uint16_t linkIndex = 0;
+	do {
+		mesh_topology_matrix_header_uart_t header;
+		header.totalLinkCount = totalLinkCount;
+		header.firstLinkIndex = linkIndex;
+		header.linkCount      = std::min(totalLinkCount - linkIndex, static_cast<int>(MAX_UART_LINKS_PER_MSG));
+
+		uint16_t size         = sizeof(header) + header.linkCount * sizeof(mesh_topology_link_uart_t);
+		cs_ret_code_t retCode = uart.writeMsgStart(UART_OPCODE_TX_MESH_TOPOLOGY, size);
+		if (retCode != ERR_SUCCESS) {
+			return retCode;
+		}
+		uart.writeMsgPart(UART_OPCODE_TX_MESH_TOPOLOGY, reinterpret_cast<uint8_t*>(&header), sizeof(header));
+		for (uint8_t i = 0; i < header.linkCount; ++i) {
+			mesh_topology_link_uart_t uartLink = getUartLink(linkIndex);
+			uart.writeMsgPart(UART_OPCODE_TX_MESH_TOPOLOGY, reinterpret_cast<uint8_t*>(&uartLink), sizeof(uartLink));
+			linkIndex++;
+		}
+		retCode = uart.writeMsgEnd(UART_OPCODE_TX_MESH_TOPOLOGY);
+		if (retCode != ERR_SUCCESS) {
+			return retCode;
+		}
+	} while (linkIndex < totalLinkCount);
+	return ERR_SUCCESS;
 }
 
 cs_ret_code_t MeshTopology::onStoneMacMsg(MeshMsgEvent& meshMsg) {
@@ -324,6 +621,10 @@ void MeshTopology::onMeshMsg(MeshMsgEvent& packet, cs_result_t& result) {
 		cs_mesh_model_msg_neighbour_rssi_t payload = packet.getPacket<CS_MESH_MODEL_TYPE_NEIGHBOUR_RSSI>();
 		onNeighbourRssi(packet.srcStoneId, payload);
 	}
+	if (packet.type == CS_MESH_MODEL_TYPE_NEIGHBOUR_RSSI_DIGEST) {
+		cs_mesh_model_msg_neighbour_rssi_digest_t payload = packet.getPacket<CS_MESH_MODEL_TYPE_NEIGHBOUR_RSSI_DIGEST>();
+		onNeighbourRssiDigest(packet.srcStoneId, payload);
+	}
 
 	if (packet.isMaybeRelayed) {
 		return;
@@ -338,7 +639,7 @@ void MeshTopology::onMeshMsg(MeshMsgEvent& packet, cs_result_t& result) {
 			neighbour_node_t node = {};
 			clearNeighbourRssi(node);
 			updateNeighbour(node, packet.srcStoneId, packet.rssi, packet.channel);
-			sendNeighbourMessageOverMesh(node);
+			sendNeighbourMessageOverMesh(node, 0);
 		}
 	}
 
@@ -349,43 +650,75 @@ void MeshTopology::onMeshMsg(MeshMsgEvent& packet, cs_result_t& result) {
 void MeshTopology::onTickSecond() {
 	LOGMeshTopologyVerbose("onTickSecond nextSendIndex=%u", _nextSendIndex);
 	print();
-	[[maybe_unused]] bool change = false;
-	for (uint8_t i = 0; i < _neighbourCount; /**/) {
-		_neighbours[i].lastSeenSecondsAgo++;
-		if (_neighbours[i].lastSeenSecondsAgo == TIMEOUT_SECONDS) {
-			change = true;
-			// Remove item, by shifting all items after this item.
-			_neighbourCount--;
-			for (uint8_t j = i; j < _neighbourCount; ++j) {
-				_neighbours[j] = _neighbours[j + 1];
-			}
-			// Also change shift the next send index.
-			if (_nextSendIndex > i) {
-				_nextSendIndex--;
-			}
-		}
-		else {
-			i++;
+	bool change = false;
+	_timeouts.tick([&](uint8_t index) {
+		change         = true;
+		// Let the others know this neighbour is lost, if we told them about it.
+		auto& reported = _neighbours[index].reportedRssi;
+		if ((reported.channel37 != 0 || reported.channel38 != 0 || reported.channel39 != 0)
+			&& _pendingRemovalCount < MAX_PENDING_REMOVALS) {
+			_pendingRemovals[_pendingRemovalCount++] = _neighbours[index].id;
 		}
-	}
+		// Mark for removal.
+		_neighbours[index].id = 0;
+	});
 	if (change) {
+		removeTimedOutNeighbours();
+		rebuildIndex();
 		LOGMeshTopologyVerbose("Result: nextSendIndex=%u", _nextSendIndex);
 		print();
 	}
 
+	if (_minuteCountdown != 0) {
+		_minuteCountdown--;
+	}
+	if (_minuteCountdown == 0) {
+		_minuteCountdown = 60;
+		if (_legacySenderMinutesAgo < LEGACY_TIMEOUT_MINUTES) {
+			_legacySenderMinutesAgo++;
+		}
+		for (uint16_t i = 0; i < _linkCount; /**/) {
+			_links[i].lastUpdateMinutesAgo++;
+			if (_links[i].lastUpdateMinutesAgo >= LINK_TIMEOUT_MINUTES) {
+				_linkCount--;
+				_links[i] = _links[_linkCount];
+			}
+			else {
+				i++;
+			}
+		}
+	}
+
 	if (_sendCountdown != 0) {
 		_sendCountdown--;
 	}
 	if (_sendCountdown == 0) {
-		sendNext();
+		sendDigest(true);
 		// Even if we end up setting sendCountdown to 0, the next message will be sent next onTickSecond.
-		if (_fastIntervalCountdown) {
-			_sendCountdown = SEND_INTERVAL_SECONDS_PER_NEIGHBOUR_FAST / std::max(_neighbourCount, (uint8_t)1);
+		uint16_t interval = _fastIntervalCountdown ? SEND_INTERVAL_SECONDS_PER_NEIGHBOUR_FAST
+												   : SEND_INTERVAL_SECONDS_PER_NEIGHBOUR;
+		_sendCountdown    = interval * MESH_NEIGHBOUR_RSSI_DIGEST_LINK_COUNT / std::max(_neighbourCount, (uint8_t)1);
+		LOGMeshTopologyVerbose("sendCountdown=%u", _sendCountdown);
+	}
+	else {
+		if (_sendDeltaCountdown != 0) {
+			_sendDeltaCountdown--;
 		}
-		else {
-			_sendCountdown = SEND_INTERVAL_SECONDS_PER_NEIGHBOUR / std::max(_neighbourCount, (uint8_t)1);
+		if (_sendDeltaCountdown == 0 && sendDigest(false)) {
+			_sendDeltaCountdown = DIGEST_DELTA_INTERVAL_SECONDS;
+		}
+	}
+
+	if (legacyIsNeeded()) {
+		if (_sendLegacyCountdown != 0) {
+			_sendLegacyCountdown--;
+		}
+		if (_sendLegacyCountdown == 0) {
+			sendLegacyNext();
+			uint16_t interval    = _fastIntervalCountdown ? SEND_INTERVAL_SECONDS_PER_NEIGHBOUR_FAST
+															 : SEND_INTERVAL_SECONDS_PER_NEIGHBOUR;
+			_sendLegacyCountdown = interval / std::max(_neighbourCount, (uint8_t)1);
 		}
-		LOGMeshTopologyVerbose("sendCountdown=%u", _sendCountdown);
 	}
 
 	if (_sendNoopCountdown != 0) {
@@ -402,6 +735,35 @@ void MeshTopology::onTickSecond() {
 	}
 }
 
+void MeshTopology::removeTimedOutNeighbours() {
+	uint8_t count               = 0;
+	uint8_t nextSendIndex       = _nextSendIndex;
+	uint8_t nextLegacySendIndex = _nextLegacySendIndex;
+	for (uint8_t i = 0; i < _neighbourCount; ++i) {
+		if (_neighbours[i].id == 0) {
+			// Also shift the next send index.
+			if (_nextSendIndex > i) {
+				nextSendIndex--;
+			}
+			if (_nextLegacySendIndex > i) {
+				nextLegacySendIndex--;
+			}
+			continue;
+		}
+		if (count != i) {
+			// Move the item, together with its timeout.
+			_neighbours[count]    = _neighbours[i];
+			uint32_t timeoutTicks = _timeouts.remaining(i);
+			_timeouts.cancel(i);
+			_timeouts.schedule(count, timeoutTicks);
+		}
+		count++;
+	}
+	_neighbourCount      = count;
+	_nextSendIndex       = nextSendIndex;
+	_nextLegacySendIndex = nextLegacySendIndex;
+}
+
 void MeshTopology::print() {
 	for (uint8_t i = 0; i < _neighbourCount; ++i) {
 		LOGMeshTopologyVerbose(
@@ -411,7 +773,7 @@ void MeshTopology::print() {
 				_neighbours[i].rssiChannel37,
 				_neighbours[i].rssiChannel38,
 				_neighbours[i].rssiChannel39,
-				_neighbours[i].lastSeenSecondsAgo);
+				getLastSeenSecondsAgo(i));
 	}
 }
 
@@ -422,12 +784,11 @@ void MeshTopology::handleEvent(event_t& evt) {
 			onMeshMsg(*packet, evt.result);
 			break;
 		}
+		case CS_TYPE::EVT_TICK_SECOND: {
+			onTickSecond();
+			break;
+		}
 		case CS_TYPE::EVT_TICK: {
-			auto packet = CS_TYPE_CAST(EVT_TICK, evt.data);
-			if (*packet % (1000 / TICK_INTERVAL_MS) == 0) {
-				onTickSecond();
-			}
-
 			if constexpr(TripwireResearch) {
 				LOGMeshTopologyVerbose("send a noop for tripwire");
 				sendNoop();
@@ -450,6 +811,10 @@ void MeshTopology::handleEvent(event_t& evt) {
 			getRssi(*packet, evt.result);
 			break;
 		}
+		case CS_TYPE::CMD_MESH_TOPO_GET_MATRIX: {
+			evt.result.returnCode = sendMatrixToUart();
+			break;
+		}
 		default: break;
 	}
 }
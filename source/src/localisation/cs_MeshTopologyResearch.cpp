@@ -32,6 +32,7 @@ void MeshTopologyResearch::init() {
 	boot_sequence_finished             = false;
 	last_stone_id_broadcasted_in_burst = 0;
 
+	flushRoutine.start();
 	listen();
 }
 
@@ -254,10 +255,6 @@ void MeshTopologyResearch::receiveMeshMsgEvent(MeshMsgEvent& mesh_msg_evt) {
 }
 
 void MeshTopologyResearch::handleEvent(event_t& evt) {
-	if (flushRoutine.handleEvent(evt)) {
-		return;
-	}
-
 	if (evt.type == CS_TYPE::EVT_RECV_MESH_MSG) {
 		auto& meshMsgEvent = *CS_TYPE_CAST(EVT_RECV_MESH_MSG, evt.getData());
 
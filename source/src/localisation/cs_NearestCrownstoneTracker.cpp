@@ -48,6 +48,14 @@ void NearestCrownstoneTracker::handleEvent(event_t& evt) {
 			handleMeshMsgEvent(evt);
 			break;
 		}
+		case CS_TYPE::EVT_TICK: {
+			onTick();
+			break;
+		}
+		case CS_TYPE::EVT_TICK_SECOND: {
+			onTickSecond(*CS_TYPE_CAST(EVT_TICK_SECOND, evt.data));
+			break;
+		}
 		default: {
 			break;
 		}
@@ -61,7 +69,22 @@ void NearestCrownstoneTracker::handleMeshMsgEvent(event_t& evt) {
 	if (meshMsgEvent->type == CS_MESH_MODEL_TYPE_ASSET_INFO_ID) {
 		LOGNearestCrownstoneTrackerVerbose("NearestCrownstone received REPORT_ASSET_ID");
 
-		onReceiveAssetReport(meshMsgEvent->getPacket<CS_MESH_MODEL_TYPE_ASSET_INFO_ID>(), meshMsgEvent->srcAddress);
+		auto report = meshMsgEvent->getPacket<CS_MESH_MODEL_TYPE_ASSET_INFO_ID>();
+		if (meshMsgEvent->srcStoneId == _myStoneId) {
+			LOGNearestCrownstoneTrackerVerbose("Ignore our own report");
+			evt.result = ERR_SUCCESS;
+			return;
+		}
+		bool duplicate = _reportCache.contains(report, meshMsgEvent->srcStoneId);
+		_reportCache.countLookup(duplicate);
+		if (duplicate) {
+			LOGNearestCrownstoneTrackerVerbose("Ignore duplicate report");
+			evt.result = ERR_SUCCESS;
+			return;
+		}
+		_reportCache.add(report, meshMsgEvent->srcStoneId);
+		_reportCacheTickRequest.request();
+		onReceiveAssetReport(report, meshMsgEvent->srcStoneId);
 
 		evt.result = ERR_SUCCESS;
 	}
@@ -100,7 +123,7 @@ bool NearestCrownstoneTracker::onReceiveAssetAdvertisement(cs_mesh_model_msg_ass
 			rssi_and_channel_float_t(record.nearestRssi)
 					.fallOff(
 							RSSI_FALL_OFF_RATE_DB_PER_S,
-							record.lastReceivedCounter * 1e-3f * AssetStore::LAST_RECEIVED_COUNTER_PERIOD_MS);
+							_assetStore->getLastReceivedCounter(record) * 1e-3f * AssetStore::LAST_RECEIVED_COUNTER_PERIOD_MS);
 
 	if (record.nearestStoneId == 0) {
 		LOGNearestCrownstoneTrackerDebug("First time this asset was seen, consider us nearest.");
@@ -151,10 +174,10 @@ void NearestCrownstoneTracker::onReceiveAssetReport(
 			rssi_and_channel_float_t(record.nearestRssi)
 					.fallOff(
 							RSSI_FALL_OFF_RATE_DB_PER_S,
-							record.lastReceivedCounter * 1e-3f * AssetStore::LAST_RECEIVED_COUNTER_PERIOD_MS);
+							_assetStore->getLastReceivedCounter(record) * 1e-3f * AssetStore::LAST_RECEIVED_COUNTER_PERIOD_MS);
 	auto recordedPersonalRssiWithFallOff = record.myRssi.fallOff(
 			RSSI_FALL_OFF_RATE_DB_PER_S,
-			record.lastReceivedCounter * 1e-3f * AssetStore::LAST_RECEIVED_COUNTER_PERIOD_MS);
+			_assetStore->getLastReceivedCounter(record) * 1e-3f * AssetStore::LAST_RECEIVED_COUNTER_PERIOD_MS);
 
 	if (reporter == record.nearestStoneId) {
 		LOGNearestCrownstoneTrackerVerbose("Received an update from the winner.");
@@ -239,14 +262,14 @@ asset_record_t* NearestCrownstoneTracker::getRecordFiltered(const asset_id_t& as
 	}
 
 	if constexpr (FILTER_STRATEGY == FilterStrategy::TIME_OUT) {
-		if (record->lastReceivedCounter >= LAST_RECEIVED_TIMEOUT_THRESHOLD) {
+		if (_assetStore->getLastReceivedCounter(*record) >= LAST_RECEIVED_TIMEOUT_THRESHOLD) {
 			LOGd("ignored old record for nearest crownstone algorithm.");
 			return nullptr;
 		}
 	}
 	else if constexpr (FILTER_STRATEGY == FilterStrategy::RSSI_FALL_OFF) {
 		auto correctedRssi = record->myRssi.getRssi()
-							 - (record->lastReceivedCounter * RSSI_FALL_OFF_RATE_DB_PER_S * 1000)
+							 - (_assetStore->getLastReceivedCounter(*record) * RSSI_FALL_OFF_RATE_DB_PER_S * 1000)
 									   / AssetStore::LAST_RECEIVED_COUNTER_PERIOD_MS;
 
 		if (correctedRssi < RSSI_CUT_OFF_THRESHOLD) {
@@ -256,3 +279,17 @@ asset_record_t* NearestCrownstoneTracker::getRecordFiltered(const asset_id_t& as
 
 	return record;
 }
+
+void NearestCrownstoneTracker::onTick() {
+	_reportCache.onTick();
+	if (_reportCache.isEmpty()) {
+		_reportCacheTickRequest.release();
+	}
+}
+
+void NearestCrownstoneTracker::onTickSecond(uint32_t upTime) {
+	if (upTime % REPORT_CACHE_LOG_INTERVAL_SECONDS == 0) {
+		LOGNearestCrownstoneTrackerDebug(
+				"Report cache hits=%u misses=%u", _reportCache.getHitCount(), _reportCache.getMissCount());
+	}
+}
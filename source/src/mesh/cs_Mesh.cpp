@@ -18,7 +18,15 @@
 //#include <util/cs_BleError.h>
 //#include <util/cs_Utils.h>
 
-Mesh::Mesh() {
+Mesh::Mesh()
+		: _syncRetryRoutine([this]() {
+			onSyncRetry();
+			return Coroutine::delayMs(MESH_SYNC_RETRY_INTERVAL_MS);
+		})
+		, _syncGiveUpRoutine([this]() {
+			onSyncGiveUp();
+			return Coroutine::delayS(0);
+		}) {
 	_core = &(MeshCore::getInstance());
 }
 
@@ -56,6 +64,16 @@ cs_ret_code_t Mesh::init(const boards_config_t& board) {
 
 	_msgSender.listen();
 	this->listen();
+
+#if MESH_MODEL_TEST_MSG != 0
+	_testMsgRoutine.action = [&]() {
+		if (_core->getUnicastAddress() == 2) {
+			_msgSender.sendTestMsg();
+		}
+		return Coroutine::delayMs(MESH_MODEL_TEST_MSG == 1 ? 100 : 1000);
+	};
+	_testMsgRoutine.start();
+#endif
 	return retCode;
 }
 
@@ -126,11 +144,6 @@ void Mesh::stopAdvertising() {
 
 void Mesh::handleEvent(event_t& event) {
 	switch (event.type) {
-		case CS_TYPE::EVT_TICK: {
-			TYPIFY(EVT_TICK) tickCount = *((TYPIFY(EVT_TICK)*)event.data);
-			onTick(tickCount);
-			break;
-		}
 		case CS_TYPE::CMD_ENABLE_MESH: {
 #if BUILD_MESHING == 1
 			_enabled = *(TYPIFY(CMD_ENABLE_MESH)*)event.data;
@@ -163,61 +176,39 @@ void Mesh::handleEvent(event_t& event) {
 	}
 }
 
-void Mesh::onTick(uint32_t tickCount) {
-	if (tickCount % (500 / TICK_INTERVAL_MS) == 0) {
-		if (Stack::getInstance().isScanning()) {
-			//				Stack::getInstance().stopScanning();
-		}
-		else {
-			//				Stack::getInstance().startScanning();
-		}
+void Mesh::onSyncRetry() {
+	_synced = !requestSync();
+	if (_synced) {
+		_syncRetryRoutine.stop();
+		_syncGiveUpRoutine.stop();
 	}
+}
+
+void Mesh::onSyncGiveUp() {
+	_syncRetryRoutine.stop();
+	_syncGiveUpRoutine.stop();
+
+	// Do one last check, internally to see if the previous requestSync succeeded.
+	// but don't send anything over the mesh. Our chance has passed.
+	_synced = !requestSync(false);
 
 	if (!_synced) {
-		if (_syncCountdown) {
-			--_syncCountdown;
-		}
-		else {
-			_synced        = !requestSync();
-			_syncCountdown = MESH_SYNC_RETRY_INTERVAL_MS / TICK_INTERVAL_MS;
-		}
-		if (_syncFailedCountdown) {
-			if (--_syncFailedCountdown == 0) {
-				// Do one last check, internally to see if the previous requestSync succeeded.
-				// but don't send anything over the mesh. Our chance has passed.
-				_synced = !requestSync(false);
-
-				if (!_synced) {
-					LOGi("Sync failed");
-					event_t syncFailEvent(CS_TYPE::EVT_MESH_SYNC_FAILED);
-					syncFailEvent.dispatch();
-
-					// yes, we know that sync failed, we're just misusing the _synced variable.
-					// (setting it to true will prevent any further sync requests.)
-					_synced = true;
-				}
-			}
-		}
-	}
-#if MESH_MODEL_TEST_MSG == 1
-	if (_core->getUnicastAddress() == 2 && tickCount % (100 / TICK_INTERVAL_MS) == 0) {
-		_msgSender.sendTestMsg();
-	}
-#elif MESH_MODEL_TEST_MSG == 2
-	if (_core->getUnicastAddress() == 2 && tickCount % (1000 / TICK_INTERVAL_MS) == 0) {
-		_msgSender.sendTestMsg();
+		LOGi("Sync failed");
+		event_t syncFailEvent(CS_TYPE::EVT_MESH_SYNC_FAILED);
+		syncFailEvent.dispatch();
+
+		// yes, we know that sync failed, we're just misusing the _synced variable.
+		// (setting it to true will prevent any further sync requests.)
+		_synced = true;
 	}
-#endif
-	_modelMulticast.tick(tickCount);
-	_modelMulticastAcked.tick(tickCount);
-	_modelMulticastNeighbours.tick(tickCount);
-	_modelUnicast.tick(tickCount);
 }
 
 void Mesh::startSync() {
-	_synced              = !requestSync();
-	_syncCountdown       = MESH_SYNC_RETRY_INTERVAL_MS / TICK_INTERVAL_MS;
-	_syncFailedCountdown = MESH_SYNC_GIVE_UP_MS / TICK_INTERVAL_MS;
+	_synced = !requestSync();
+	if (!_synced) {
+		_syncRetryRoutine.start(MESH_SYNC_RETRY_INTERVAL_MS);
+		_syncGiveUpRoutine.start(MESH_SYNC_GIVE_UP_MS);
+	}
 }
 
 bool Mesh::requestSync(bool propagateSyncMessageOverMesh) {
@@ -48,6 +48,7 @@ void MeshAdvertiser::init() {
 			}
 		}
 	}
+	updateTickRequest();
 
 	listen();
 }
@@ -196,6 +197,7 @@ void MeshAdvertiser::setConfigEntry(uint8_t id, ibeacon_config_id_packet_t& conf
 	_ibeaconInterval[id] = config;
 	cs_state_data_t stateData(CS_TYPE::STATE_IBEACON_CONFIG_ID, id, (uint8_t*)&config, sizeof(config));
 	State::getInstance().set(stateData);
+	updateTickRequest();
 }
 
 void MeshAdvertiser::clearConfigEntry(uint8_t id) {
@@ -203,6 +205,17 @@ void MeshAdvertiser::clearConfigEntry(uint8_t id) {
 	_ibeaconInterval[id].interval  = 0;
 	_ibeaconInterval[id].timestamp = 0;
 	State::getInstance().remove(CS_TYPE::STATE_IBEACON_CONFIG_ID, id);
+	updateTickRequest();
+}
+
+void MeshAdvertiser::updateTickRequest() {
+	for (uint8_t i = 0; i < num_ibeacon_config_ids; ++i) {
+		if (_ibeaconInterval[i].timestamp != 0 || _ibeaconInterval[i].interval != 0) {
+			_tickRequest.request();
+			return;
+		}
+	}
+	_tickRequest.release();
 }
 
 void MeshAdvertiser::handleTime(uint32_t now) {
@@ -673,9 +673,9 @@ void MeshCore::handleEvent(event_t& event) {
 			factoryReset();
 			break;
 		}
-		case CS_TYPE::EVT_TICK: {
-			TYPIFY(EVT_TICK) tickCount = *((TYPIFY(EVT_TICK)*)event.data);
-			if (tickCount % (10 * 1000 / TICK_INTERVAL_MS) == 0) {
+		case CS_TYPE::EVT_TICK_SECOND: {
+			TYPIFY(EVT_TICK_SECOND) upTime = *CS_TYPE_CAST(EVT_TICK_SECOND, event.data);
+			if (upTime % 10 == 0) {
 				[[maybe_unused]] const scanner_stats_t* stats = scanner_stats_get();
 				LOGMeshDebug(
 						"Scanner stats: success=%u crcFail=%u lenFail=%u memFail=%u",
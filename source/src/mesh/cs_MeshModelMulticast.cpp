@@ -32,6 +32,13 @@ void MeshModelMulticast::registerMsgHandler(const callback_msg_t& closure) {
 
 void MeshModelMulticast::init(uint16_t modelId) {
 	assert(_msgCallback != nullptr, "Callback not set");
+	_processQueueRoutine.action = [&]() {
+		processQueue();
+		if (getNextItemInQueue(false) == -1) {
+			_processQueueRoutine.stop();
+		}
+		return Coroutine::delayMs(MESH_MODEL_QUEUE_PROCESS_INTERVAL_MS);
+	};
 	uint32_t retVal;
 	access_model_add_params_t accessParams;
 	accessParams.model_id.company_id = CROWNSTONE_COMPANY_ID;
@@ -168,9 +175,10 @@ cs_ret_code_t MeshModelMulticast::addToQueue(MeshUtil::cs_mesh_queue_item_t& ite
 			LOGMeshModelVerbose("added to ind=%u", index);
 			_queueIndexNext = index;
 
-			// TODO: immediately start sending from queue.
-			// sendMsgFromQueue can keep up how many msgs have been sent this tick, so it knows how many can still be
-			// sent.
+			// Start sending from queue, outside of this call.
+			if (!_processQueueRoutine.isStarted()) {
+				_processQueueRoutine.start();
+			}
 			return ERR_SUCCESS;
 		}
 	}
@@ -250,9 +258,3 @@ void MeshModelMulticast::processQueue() {
 		}
 	}
 }
-
-void MeshModelMulticast::tick(uint32_t tickCount) {
-	if (tickCount % (MESH_MODEL_QUEUE_PROCESS_INTERVAL_MS / TICK_INTERVAL_MS) == 0) {
-		processQueue();
-	}
-}
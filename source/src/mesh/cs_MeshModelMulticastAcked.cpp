@@ -37,6 +37,13 @@ void MeshModelMulticastAcked::registerMsgHandler(const callback_msg_t& closure)
 
 void MeshModelMulticastAcked::init(uint16_t modelId) {
 	assert(_msgCallback != nullptr, "Callback not set");
+	_processQueueRoutine.action = [&]() {
+		processQueue();
+		if (_queueIndexInProgress == QUEUE_INDEX_NONE && getNextItemInQueue(false) == -1) {
+			_processQueueRoutine.stop();
+		}
+		return Coroutine::delayMs(MESH_MODEL_ACKED_RETRY_INTERVAL_MS);
+	};
 	uint32_t retVal;
 	access_model_add_params_t accessParams;
 	accessParams.model_id.company_id = CROWNSTONE_COMPANY_ID;
@@ -280,6 +287,9 @@ cs_ret_code_t MeshModelMulticastAcked::addToQueue(MeshUtil::cs_mesh_queue_item_t
 
 			// If queue was empty, we can start sending this item.
 			sendMsgFromQueue();
+			if (!_processQueueRoutine.isStarted()) {
+				_processQueueRoutine.start(MESH_MODEL_ACKED_RETRY_INTERVAL_MS);
+			}
 			return ERR_SUCCESS;
 		}
 	}
@@ -461,10 +471,3 @@ void MeshModelMulticastAcked::processQueue() {
 	retryMsg();
 	sendMsgFromQueue();
 }
-
-void MeshModelMulticastAcked::tick(uint32_t tickCount) {
-	// Process only at retry interval.
-	if (tickCount % (MESH_MODEL_ACKED_RETRY_INTERVAL_MS / TICK_INTERVAL_MS) == 0) {
-		processQueue();
-	}
-}
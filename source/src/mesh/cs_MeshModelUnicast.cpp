@@ -44,6 +44,13 @@ void MeshModelUnicast::registerMsgHandler(const callback_msg_t& closure) {
 
 void MeshModelUnicast::init(uint16_t modelId) {
 	assert(_msgCallback != nullptr, "Callback not set");
+	_processQueueRoutine.action = [&]() {
+		processQueue();
+		if (_queueIndexInProgress == QUEUE_INDEX_NONE && getNextItemInQueue(false) == -1) {
+			_processQueueRoutine.stop();
+		}
+		return Coroutine::delayMs(MESH_MODEL_QUEUE_PROCESS_INTERVAL_MS);
+	};
 	uint32_t retVal;
 	access_model_add_params_t accessParams;
 	accessParams.model_id.company_id = CROWNSTONE_COMPANY_ID;
@@ -410,6 +417,9 @@ cs_ret_code_t MeshModelUnicast::addToQueue(MeshUtil::cs_mesh_queue_item_t& item)
 
 			// If queue was empty, we can start sending this item.
 			sendMsgFromQueue();
+			if (!_processQueueRoutine.isStarted()) {
+				_processQueueRoutine.start(MESH_MODEL_QUEUE_PROCESS_INTERVAL_MS);
+			}
 			return ERR_SUCCESS;
 		}
 	}
@@ -503,9 +513,3 @@ bool MeshModelUnicast::sendMsgFromQueue() {
 void MeshModelUnicast::processQueue() {
 	sendMsgFromQueue();
 }
-
-void MeshModelUnicast::tick(uint32_t tickCount) {
-	if (tickCount % (MESH_MODEL_QUEUE_PROCESS_INTERVAL_MS / TICK_INTERVAL_MS) == 0) {
-		processQueue();
-	}
-}
@@ -145,6 +145,15 @@ void MeshMsgHandler::handleMsg(MeshMsgEvent& msg) {
 		case CS_MESH_MODEL_TYPE_NEIGHBOUR_RSSI: {
 			break;
 		}
+		case CS_MESH_MODEL_TYPE_NEIGHBOUR_RSSI_DIGEST: {
+			break;
+		}
+		case CS_MESH_MODEL_TYPE_ASSET_FILTER_CHUNK_REQUEST: {
+			break;
+		}
+		case CS_MESH_MODEL_TYPE_ASSET_FILTER_CHUNK: {
+			break;
+		}
 		case CS_MESH_MODEL_TYPE_CTRL_CMD: {
 			handleControlCommand(msg);
 			// Return instead of break, as this function already sets the reply.
@@ -230,6 +239,7 @@ cs_ret_code_t MeshMsgHandler::handleTimeSync(MeshMsgEvent& msg) {
 	eventData.stamp.posix_s  = packet->posix_s;
 	eventData.stamp.posix_ms = packet->posix_ms;
 	eventData.stamp.version  = packet->version;
+	eventData.periodShift    = packet->periodShift;
 	if (packet->overrideRoot) {
 		eventData.srcId = 0;
 	}
@@ -99,6 +99,7 @@ void Microapp::loadApps() {
 		storeState(index);
 		startApp(index);
 	}
+	updateTickRequest();
 }
 
 void Microapp::updateStateFromOperatingData(uint8_t index) {
@@ -212,6 +213,8 @@ cs_ret_code_t Microapp::startApp(uint8_t index) {
 				_states[index].failedFunction);
 		return ERR_UNSAFE;
 	}
+	// The app can run, so it has to be called every tick.
+	_tickRequest.request();
 	if (_started[index]) {
 		return ERR_SUCCESS;
 	}
@@ -291,6 +294,21 @@ void Microapp::tick() {
 		// We can just try to resume all the time, as it will just return BUSY otherwise.
 		resumeFactoryReset();
 	}
+	updateTickRequest();
+}
+
+void Microapp::updateTickRequest() {
+	if (_factoryResetMode && _currentMicroappIndex != MICROAPP_INDEX_NONE) {
+		_tickRequest.request();
+		return;
+	}
+	for (uint8_t i = 0; i < g_MICROAPP_COUNT; ++i) {
+		if (canRunApp(i)) {
+			_tickRequest.request();
+			return;
+		}
+	}
+	_tickRequest.release();
 }
 
 cs_ret_code_t Microapp::handleGetInfo(cs_result_t& result) {
@@ -334,9 +352,15 @@ cs_ret_code_t Microapp::handleUpload(microapp_upload_internal_t* packet) {
 	resetState(index);
 
 	MicroappStorage& storage = MicroappStorage::getInstance();
-	// CAREFUL: This assumes the data stays in ram during the write.
-	retCode =
-			storage.writeChunk(packet->header.header.index, packet->header.offset, packet->data.data, packet->data.len);
+	// CAREFUL: A compressed chunk is assumed to stay in ram during the decompression, uncompressed chunks are copied.
+	if (packet->compressed) {
+		retCode = storage.writeCompressedChunk(
+				packet->header.header.index, packet->header.offset, packet->data.data, packet->data.len);
+	}
+	else {
+		retCode = storage.writeChunk(
+				packet->header.header.index, packet->header.offset, packet->data.data, packet->data.len);
+	}
 
 	switch (retCode) {
 		case ERR_SUCCESS:
@@ -388,7 +412,7 @@ cs_ret_code_t Microapp::handleRemove(microapp_ctrl_header_t* packet) {
 	MicroappController::getInstance().clear(index);
 
 	MicroappStorage& storage = MicroappStorage::getInstance();
-	retCode                  = storage.erase(index);
+	retCode                  = storage.eraseHeader(index);
 	switch (retCode) {
 		case ERR_SUCCESS:
 		case ERR_WAIT_FOR_SUCCESS:
@@ -476,7 +500,9 @@ cs_ret_code_t Microapp::factoryReset() {
 		return ERR_WRONG_MODE;
 	}
 	_currentMicroappIndex = 0;
-	return resumeFactoryReset();
+	cs_ret_code_t retCode = resumeFactoryReset();
+	updateTickRequest();
+	return retCode;
 }
 
 cs_ret_code_t Microapp::resumeFactoryReset() {
@@ -12,6 +12,7 @@
 #include <cfg/cs_Config.h>
 #include <common/cs_Types.h>
 #include <cs_MemoryLayout.h>
+#include <drivers/cs_RTC.h>
 #include <drivers/cs_Storage.h>
 #include <events/cs_EventDispatcher.h>
 #include <ipc/cs_IpcRamData.h>
@@ -66,7 +67,7 @@ NRF_FSTORAGE_DEF(nrf_fstorage_t fStorage) = {
 };
 #pragma GCC diagnostic pop
 
-MicroappStorage::MicroappStorage() {}
+MicroappStorage::MicroappStorage() : _uploadQueue(*this) {}
 
 cs_ret_code_t MicroappStorage::init() {
 	uint32_t nrfCode;
@@ -89,22 +90,63 @@ cs_ret_code_t MicroappStorage::init() {
 }
 
 cs_ret_code_t MicroappStorage::erase(uint8_t appIndex) {
-	if (_writing) {
+	if (isBusy()) {
 		return ERR_BUSY;
 	}
 
-	if (isErased(appIndex)) {
+	// A microapp is usually much smaller than its storage space, so only erase up to the last page in use.
+	uint32_t flashAddress = fStorage.start_addr + appIndex * MICROAPP_MAX_SIZE;
+	uint8_t pageCount     = 0;
+	for (uint8_t page = 0; page < MICROAPP_MAX_SIZE / CS_FLASH_PAGE_SIZE; ++page) {
+		if (!isErased(flashAddress + page * CS_FLASH_PAGE_SIZE, CS_FLASH_PAGE_SIZE)) {
+			pageCount = page + 1;
+		}
+	}
+	return erasePages(appIndex, pageCount);
+}
+
+cs_ret_code_t MicroappStorage::eraseHeader(uint8_t appIndex) {
+	if (isBusy()) {
+		return ERR_BUSY;
+	}
+	return erasePages(appIndex, isErased(appIndex) ? 0 : 1);
+}
+
+cs_ret_code_t MicroappStorage::erasePages(uint8_t appIndex, uint8_t pageCount) {
+	if (isBusy()) {
+		return ERR_BUSY;
+	}
+
+	// An upload of this app has to start over.
+	if (appIndex == _uploadAppIndex) {
+		_uploadQueue.stop();
+		_uploadAppIndex = MICROAPP_INDEX_NONE;
+	}
+	if (appIndex == _compressedAppIndex) {
+		_compressedAppIndex = MICROAPP_INDEX_NONE;
+	}
+
+	if (pageCount == 0) {
 		return ERR_SUCCESS;
 	}
 
 	uint32_t flashAddress = fStorage.start_addr + appIndex * MICROAPP_MAX_SIZE;
-	LOGMicroappInfo("erase addr=0x%08X size=%u", flashAddress, MICROAPP_MAX_SIZE / CS_FLASH_PAGE_SIZE);
-	uint32_t nrfCode = nrf_fstorage_erase(&fStorage, flashAddress, MICROAPP_MAX_SIZE / CS_FLASH_PAGE_SIZE, nullptr);
+	LOGMicroappInfo("erase addr=0x%08X pages=%u", flashAddress, pageCount);
+	cs_ret_code_t retCode = startErase(flashAddress, pageCount, nullptr);
+	if (retCode != ERR_SUCCESS) {
+		return retCode;
+	}
+	_writing = true;
+	return ERR_WAIT_FOR_SUCCESS;
+}
+
+cs_ret_code_t MicroappStorage::startErase(uint32_t flashAddress, uint8_t pageCount, void* context) {
+	uint32_t nrfCode = nrf_fstorage_erase(&fStorage, flashAddress, pageCount, context);
 	switch (nrfCode) {
 		case NRF_SUCCESS: {
-			break;
+			return ERR_SUCCESS;
 		}
-		case NRFX_ERROR_NO_MEM: {
+		case NRF_ERROR_NO_MEM: {
 			return ERR_BUSY;
 		}
 		default: {
@@ -112,78 +154,190 @@ cs_ret_code_t MicroappStorage::erase(uint8_t appIndex) {
 			return ERR_UNSPECIFIED;
 		}
 	}
-	_writing = true;
-	return ERR_WAIT_FOR_SUCCESS;
+}
+
+bool MicroappStorage::isBusy() {
+	return _writing || _uploadQueue.getQueuedOperationCount() != 0 || _compressedQueuedEraseCount != 0;
 }
 
 cs_ret_code_t MicroappStorage::writeChunk(uint8_t appIndex, uint16_t offset, const uint8_t* data, uint16_t size) {
-	uint32_t flashAddress = fStorage.start_addr + appIndex * MICROAPP_MAX_SIZE + offset;
-	LOGMicroappInfo("Write chunk at 0x%08X of size %u", flashAddress, size);
+	LOGMicroappInfo("Write chunk of app %u at offset %u of size %u", appIndex, offset, size);
+	cs_ret_code_t retCode;
+	if (offset == 0) {
+		if (isBusy()) {
+			LOGw("Busy writing");
+			return ERR_BUSY;
+		}
+		_compressedAppIndex = MICROAPP_INDEX_NONE;
+		_uploadAppIndex     = appIndex;
+		retCode             = _uploadQueue.start();
+		if (retCode != ERR_SUCCESS) {
+			LOGw("Failed to start upload: retCode=%u", retCode);
+			_uploadAppIndex = MICROAPP_INDEX_NONE;
+			return retCode;
+		}
+		_uploadStartRtcCount = RTC::getCount();
+		_uploadSize          = 0;
+	}
 
-	if (offset + size > MICROAPP_MAX_SIZE) {
-		return ERR_NO_SPACE;
+	if (appIndex != _uploadAppIndex || !_uploadQueue.isNextChunk(offset)) {
+		LOGw("Expected the next chunk of an upload");
+		return ERR_WRONG_STATE;
 	}
 
-	if (size % 4 != 0) {
-		LOGw("Chunk size must be multiple of 4B, size=%u", size);
-		return ERR_WRONG_PAYLOAD_LENGTH;
+	// The chunk is copied, so the result can be returned before it has been written.
+	_compressedUpload = false;
+	retCode           = _uploadQueue.writeChunk(offset, data, size);
+	switch (retCode) {
+		case ERR_SUCCESS:
+		case ERR_WAIT_FOR_SUCCESS: {
+			_uploadSize += size;
+			break;
+		}
+		default: {
+			LOGw("Failed to write chunk: retCode=%u", retCode);
+		}
 	}
+	return retCode;
+}
 
-	if (!isErased(flashAddress, size)) {
-		LOGw("Chunk is not erased");
-		return ERR_WRITE_DISABLED;
+cs_ret_code_t MicroappStorage::writeCompressedChunk(
+		uint8_t appIndex, uint16_t offset, const uint8_t* data, uint16_t size) {
+	LOGMicroappInfo("Write compressed chunk of app %u at offset %u of size %u", appIndex, offset, size);
+	if (isBusy()) {
+		// The write buffer is in use.
+		LOGw("Busy writing");
+		return ERR_BUSY;
 	}
 
-	// Write chunk in even smaller chunks of MICROAPP_STORAGE_BUF_SIZE.
-	// TODO: This could be avoided if `data` would be word aligned,
-	// which we could do by making sure the control command payload is word aligned.
-	_chunkData         = data;
-	_chunkSize         = size;
-	_chunkWritten      = 0;
-	_chunkFlashAddress = flashAddress;
+	if (offset == 0) {
+		// Only the first page has to be erased, the other pages are erased before they're written.
+		if (!isErased(appIndex)) {
+			LOGw("App %u is not erased", appIndex);
+			return ERR_WRITE_DISABLED;
+		}
+		_uploadQueue.stop();
+		_uploadAppIndex = MICROAPP_INDEX_NONE;
+
+		// Matches are copied from the decompressed data that has been written already, which can be read directly
+		// from flash.
+		const uint8_t* appFlash =
+				reinterpret_cast<const uint8_t*>(fStorage.start_addr + appIndex * MICROAPP_MAX_SIZE);
+		_decompressor.init(appFlash, _writeBuffer, sizeof(_writeBuffer));
+		_compressedAppIndex        = appIndex;
+		_compressedOffset          = 0;
+		_decompressedSize          = 0;
+		_compressedErasedPageCount = 1;
+		_compressedEraseResult     = ERR_SUCCESS;
+		_uploadStartRtcCount       = RTC::getCount();
+		_uploadSize                = 0;
+	}
 
-	return writeNextChunkPart();
+	if (appIndex != _compressedAppIndex || offset != _compressedOffset) {
+		LOGw("Expected chunk of app %u at offset %u", _compressedAppIndex, _compressedOffset);
+		return ERR_WRONG_STATE;
+	}
+
+	_compressedUpload   = true;
+	_compressedData     = data;
+	_compressedDataSize = size;
+	_compressedOffset += size;
+	_uploadSize += size;
+
+	cs_ret_code_t retCode = decompressChunk();
+	if (retCode != ERR_SUCCESS && retCode != ERR_WAIT_FOR_SUCCESS) {
+		// The upload has to start over.
+		_compressedAppIndex = MICROAPP_INDEX_NONE;
+	}
+	return retCode;
 }
 
-cs_ret_code_t MicroappStorage::writeNextChunkPart() {
-	LOGMicroappDebug("writeNextChunkPart _chunkSize=%u _chunkWritten=%u", _chunkSize, _chunkWritten);
-	cs_ret_code_t retCode;
+cs_ret_code_t MicroappStorage::decompressChunk() {
+	uint16_t consumedSize = 0;
+	cs_ret_code_t retCode = _decompressor.decompress(_compressedData, _compressedDataSize, consumedSize);
+	_compressedData += consumedSize;
+	_compressedDataSize -= consumedSize;
+	if (retCode != ERR_SUCCESS && retCode != ERR_BUFFER_TOO_SMALL) {
+		LOGw("Failed to decompress: retCode=%u", retCode);
+		return retCode;
+	}
 
-	// Check if done.
-	if (_chunkWritten >= _chunkSize) {
-		LOGMicroappInfo("Done");
-		return ERR_SUCCESS;
+	if (_decompressedSize == 0 && _decompressor.getOutputSize() >= sizeof(microapp_binary_header_t)) {
+		// The write buffer is larger than the header, so the header is at the start of the write buffer.
+		microapp_binary_header_t* header = reinterpret_cast<microapp_binary_header_t*>(_writeBuffer);
+		LOGMicroappInfo("Decompressed size=%u", header->size);
+		if (header->size < sizeof(microapp_binary_header_t) || header->size > MICROAPP_MAX_SIZE) {
+			LOGw("Invalid size: %u", header->size);
+			return ERR_NO_SPACE;
+		}
+		_decompressedSize = header->size;
 	}
 
-	// Write part of the chunk.
-	// Copy to _buffer, so that the data is aligned.
-	uint16_t writeSize = std::min((int)MICROAPP_STORAGE_BUF_SIZE, _chunkSize - _chunkWritten);
-	memcpy(_writeBuffer, _chunkData + _chunkWritten, writeSize);
-	retCode = write(_chunkFlashAddress + _chunkWritten, _writeBuffer, writeSize);
-	_chunkWritten += writeSize;
+	bool complete = (_decompressedSize != 0 && _decompressor.getOutputSize() >= _decompressedSize);
+	if (complete && _decompressor.getOutputSize() > _decompressedSize) {
+		LOGw("Decompressed data is larger than size=%u", _decompressedSize);
+		return ERR_NO_SPACE;
+	}
+
+	if (retCode == ERR_BUFFER_TOO_SMALL || (complete && _decompressor.getBufferedSize() > 0)) {
+		return writeDecompressed();
+	}
+	return ERR_SUCCESS;
+}
+
+cs_ret_code_t MicroappStorage::writeDecompressed() {
+	// Only the last part can be smaller than the write buffer, so this is always word aligned.
+	uint32_t offset       = _decompressor.getFlushedSize();
+	uint32_t flashAddress = fStorage.start_addr + _compressedAppIndex * MICROAPP_MAX_SIZE + offset;
+	uint16_t bufferedSize = _decompressor.getBufferedSize();
+	uint16_t size         = CS_ROUND_UP_TO_MULTIPLE_OF_POWER_OF_2(bufferedSize, 4);
+	memset(_writeBuffer + bufferedSize, 0xFF, size - bufferedSize);
+
+	cs_ret_code_t retCode = eraseCompressedPagesUpTo((offset + size - 1) / CS_FLASH_PAGE_SIZE);
+	if (retCode != ERR_SUCCESS) {
+		return retCode;
+	}
 
+	retCode = startWrite(flashAddress, _writeBuffer, size, nullptr);
 	if (retCode != ERR_SUCCESS) {
-		LOGw("Failed to start write to flash, dispatch event with result %u", retCode);
+		LOGw("Failed to start write to flash: retCode=%u", retCode);
 		return retCode;
 	}
+	_writing = true;
+
+	// Erase the next page while the decompressed data of the current page is written.
+	uint8_t appPageCount = (_decompressedSize + CS_FLASH_PAGE_SIZE - 1) / CS_FLASH_PAGE_SIZE;
+	if (_compressedErasedPageCount < appPageCount) {
+		eraseCompressedPagesUpTo(_compressedErasedPageCount);
+	}
 	return ERR_WAIT_FOR_SUCCESS;
 }
 
-cs_ret_code_t MicroappStorage::write(uint32_t flashAddress, const uint8_t* data, uint16_t size) {
+cs_ret_code_t MicroappStorage::eraseCompressedPagesUpTo(uint8_t page) {
+	uint32_t appAddress = fStorage.start_addr + _compressedAppIndex * MICROAPP_MAX_SIZE;
+	while (_compressedErasedPageCount <= page) {
+		uint32_t pageAddress = appAddress + _compressedErasedPageCount * CS_FLASH_PAGE_SIZE;
+		if (!isErased(pageAddress, CS_FLASH_PAGE_SIZE)) {
+			cs_ret_code_t retCode = startErase(pageAddress, 1, &_decompressor);
+			if (retCode != ERR_SUCCESS) {
+				return retCode;
+			}
+			_compressedQueuedEraseCount++;
+		}
+		_compressedErasedPageCount++;
+	}
+	return ERR_SUCCESS;
+}
+
+cs_ret_code_t MicroappStorage::startWrite(uint32_t flashAddress, const uint8_t* data, uint16_t size, void* context) {
 	LOGMicroappDebug("write %u bytes from 0x%X to 0x%08X", size, data, flashAddress);
 	_logArray(LOGMicroappVerboseLevel, true, data, size);
-	// Only allow 1 write to flash at a time.
-	if (_writing) {
-		LOGw("Busy writing");
-		return ERR_BUSY;
-	}
 
 	// Write will only work if the flashAddress, and data pointer are word aligned, and when size is word sized.
-	uint32_t nrfCode = nrf_fstorage_write(&fStorage, flashAddress, data, size, nullptr);
+	uint32_t nrfCode = nrf_fstorage_write(&fStorage, flashAddress, data, size, context);
 	switch (nrfCode) {
 		case NRF_SUCCESS: {
 			LOGMicroappDebug("Success");
-			_writing = true;
 			return ERR_SUCCESS;
 		}
 		case NRF_ERROR_NO_MEM: {
@@ -208,35 +362,33 @@ cs_ret_code_t MicroappStorage::write(uint32_t flashAddress, const uint8_t* data,
 void MicroappStorage::onFlashWritten(cs_ret_code_t retCode) {
 	LOGMicroappDebug("onFlashWritten retCode=%u", retCode);
 	if (retCode != ERR_SUCCESS) {
-		resetChunkVars();
 		LOGw("Failed to complete write to flash, dispatch event with result %u", retCode);
-
-		TYPIFY(CMD_RESOLVE_ASYNC_CONTROL_COMMAND) result(CTRL_CMD_MICROAPP_UPLOAD, retCode);
-		event_t eventResult(CS_TYPE::CMD_RESOLVE_ASYNC_CONTROL_COMMAND, &result, sizeof(result));
-		eventResult.dispatch();
 	}
-
-	retCode = writeNextChunkPart();
-	if (retCode == ERR_WAIT_FOR_SUCCESS) {
-		// Wait for next written event.
-		return;
+	if (_compressedUpload) {
+		if (retCode == ERR_SUCCESS) {
+			// The erases that were queued before this write are done as well.
+			retCode                = _compressedEraseResult;
+			_compressedEraseResult = ERR_SUCCESS;
+		}
+		if (retCode == ERR_SUCCESS) {
+			_decompressor.onBufferFlushed();
+			retCode = decompressChunk();
+			if (retCode == ERR_WAIT_FOR_SUCCESS) {
+				// Resolve once the rest of the chunk has been written.
+				return;
+			}
+		}
+		if (retCode != ERR_SUCCESS) {
+			// The upload has to start over.
+			_compressedAppIndex = MICROAPP_INDEX_NONE;
+		}
 	}
-
-	// Write is done or there was an error.
-	resetChunkVars();
-	TYPIFY(CMD_RESOLVE_ASYNC_CONTROL_COMMAND) result(CTRL_CMD_MICROAPP_UPLOAD, retCode);
+	CommandHandlerTypes commandType = _compressedUpload ? CTRL_CMD_MICROAPP_UPLOAD_LZ : CTRL_CMD_MICROAPP_UPLOAD;
+	TYPIFY(CMD_RESOLVE_ASYNC_CONTROL_COMMAND) result(commandType, retCode);
 	event_t eventResult(CS_TYPE::CMD_RESOLVE_ASYNC_CONTROL_COMMAND, &result, sizeof(result));
 	eventResult.dispatch();
 }
 
-void MicroappStorage::resetChunkVars() {
-	LOGMicroappDebug("resetChunkVars");
-	_chunkData         = nullptr;
-	_chunkSize         = 0;
-	_chunkWritten      = 0;
-	_chunkFlashAddress = 0;
-}
-
 void MicroappStorage::getAppHeader(uint8_t appIndex, microapp_binary_header_t& header) {
 	LOGMicroappDebug("Get app header");
 	const uint32_t addr = fStorage.start_addr + appIndex * MICROAPP_MAX_SIZE;
@@ -261,7 +413,22 @@ uint32_t MicroappStorage::getStartInstructionAddress(uint8_t appIndex) {
 
 bool MicroappStorage::isErased(uint8_t appIndex) {
 	const uint32_t addr = fStorage.start_addr + appIndex * MICROAPP_MAX_SIZE;
-	return isErased(addr, MICROAPP_MAX_SIZE);
+	return isErased(addr, CS_FLASH_PAGE_SIZE);
+}
+
+bool MicroappStorage::isPageErased(uint8_t page) {
+	return isErased(fStorage.start_addr + _uploadAppIndex * MICROAPP_MAX_SIZE + page * CS_FLASH_PAGE_SIZE,
+					CS_FLASH_PAGE_SIZE);
+}
+
+cs_ret_code_t MicroappStorage::queueErase(uint8_t page) {
+	uint32_t flashAddress = fStorage.start_addr + _uploadAppIndex * MICROAPP_MAX_SIZE + page * CS_FLASH_PAGE_SIZE;
+	return startErase(flashAddress, 1, &_uploadQueue);
+}
+
+cs_ret_code_t MicroappStorage::queueWrite(uint16_t offset, const uint8_t* data, uint16_t size) {
+	uint32_t flashAddress = fStorage.start_addr + _uploadAppIndex * MICROAPP_MAX_SIZE + offset;
+	return startWrite(flashAddress, data, size, &_uploadQueue);
 }
 
 bool MicroappStorage::isErased(uint32_t flashAddress, uint16_t size) {
@@ -294,6 +461,15 @@ bool MicroappStorage::isErased(uint32_t flashAddress, uint16_t size) {
 
 cs_ret_code_t MicroappStorage::validateApp(uint8_t appIndex) {
 	LOGMicroappInfo("Validate app %u", appIndex);
+	if (appIndex == _uploadAppIndex && _uploadQueue.getQueuedOperationCount() != 0) {
+		LOGw("Chunks are still being written");
+		return ERR_BUSY;
+	}
+	if (_uploadSize != 0) {
+		LOGMicroappInfo(
+				"Uploaded %u bytes in %u ms", _uploadSize, RTC::differenceMs(RTC::getCount(), _uploadStartRtcCount));
+		_uploadSize = 0;
+	}
 
 	microapp_binary_header_t header;
 	getAppHeader(appIndex, header);
@@ -374,8 +550,8 @@ void MicroappStorage::printHeader(uint8_t logLevel, microapp_binary_header_t& he
 }
 
 /**
- * Return result of fstorage operation to sender. We only send this event after fstorage returns to pace the
- * incoming messages. In this way it is also possible to resend a particular chunk.
+ * Return result of fstorage operation to sender. The upload queue paces the incoming messages by the number of queued
+ * chunks, the other operations only send this event after fstorage returns.
  */
 void MicroappStorage::handleFileStorageEvent(nrf_fstorage_evt_t* evt) {
 	cs_ret_code_t retCode = ERR_SUCCESS;
@@ -393,12 +569,28 @@ void MicroappStorage::handleFileStorageEvent(nrf_fstorage_evt_t* evt) {
 		case NRF_FSTORAGE_EVT_WRITE_RESULT: {
 			LOGMicroappDebug("Write result addr=0x%08X len=%u src=0x%X", evt->addr, evt->len, evt->p_src);
 			_logArray(LOGMicroappVerboseLevel, true, (const uint8_t*)(evt->p_src), evt->len);
+			if (evt->p_param == &_uploadQueue) {
+				resolveUploadQueueResult(_uploadQueue.onWriteDone(retCode));
+				break;
+			}
 			_writing = false;
 			onFlashWritten(retCode);
 			break;
 		}
 		case NRF_FSTORAGE_EVT_ERASE_RESULT: {
 			LOGMicroappInfo("Flash erase result=%u addr=0x%08X len=%u", evt->result, evt->addr, evt->len);
+			if (evt->p_param == &_uploadQueue) {
+				resolveUploadQueueResult(_uploadQueue.onEraseDone(retCode));
+				break;
+			}
+			if (evt->p_param == &_decompressor) {
+				// The result is returned after the write that follows.
+				_compressedQueuedEraseCount--;
+				if (retCode != ERR_SUCCESS && _compressedEraseResult == ERR_SUCCESS) {
+					_compressedEraseResult = retCode;
+				}
+				break;
+			}
 			_writing = false;
 			TYPIFY(CMD_RESOLVE_ASYNC_CONTROL_COMMAND) result(CTRL_CMD_MICROAPP_REMOVE, retCode);
 			event_t eventResult(CS_TYPE::CMD_RESOLVE_ASYNC_CONTROL_COMMAND, &result, sizeof(result));
@@ -408,3 +600,12 @@ void MicroappStorage::handleFileStorageEvent(nrf_fstorage_evt_t* evt) {
 		default: break;
 	}
 }
+
+void MicroappStorage::resolveUploadQueueResult(cs_ret_code_t retCode) {
+	if (retCode == ERR_WAIT_FOR_SUCCESS) {
+		return;
+	}
+	TYPIFY(CMD_RESOLVE_ASYNC_CONTROL_COMMAND) result(CTRL_CMD_MICROAPP_UPLOAD, retCode);
+	event_t eventResult(CS_TYPE::CMD_RESOLVE_ASYNC_CONTROL_COMMAND, &result, sizeof(result));
+	eventResult.dispatch();
+}
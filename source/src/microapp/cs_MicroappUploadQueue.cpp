@@ -0,0 +1,166 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <logging/cs_Logger.h>
+#include <microapp/cs_MicroappUploadQueue.h>
+
+#include <cstring>
+
+#define LOGMicroappUploadDebug LOGvv
+
+MicroappUploadQueue::MicroappUploadQueue(MicroappUploadFlash& flash) : _flash(flash) {}
+
+cs_ret_code_t MicroappUploadQueue::start() {
+	if (_queuedOperationCount != 0) {
+		return ERR_BUSY;
+	}
+	// Only the first page has to be erased: that's where the header is, so the app can't be running.
+	if (!_flash.isPageErased(0)) {
+		return ERR_WRITE_DISABLED;
+	}
+	_started          = true;
+	_nextOffset       = 0;
+	_appSize          = 0;
+	_erasedPageCount  = 1;
+	_queuedChunkCount = 0;
+	_nextChunkBuffer  = 0;
+	_flashResult      = ERR_SUCCESS;
+	_pendingResult    = PendingResult::NONE;
+	return ERR_SUCCESS;
+}
+
+void MicroappUploadQueue::stop() {
+	_started       = false;
+	_pendingResult = PendingResult::NONE;
+}
+
+cs_ret_code_t MicroappUploadQueue::writeChunk(uint16_t offset, const uint8_t* data, uint16_t size) {
+	LOGMicroappUploadDebug("writeChunk offset=%u size=%u", offset, size);
+	if (!isNextChunk(offset)) {
+		return ERR_WRONG_STATE;
+	}
+	if (_pendingResult != PendingResult::NONE) {
+		return ERR_BUSY;
+	}
+	if (_flashResult != ERR_SUCCESS) {
+		LOGw("Flash operation failed: result=%u", _flashResult);
+		stop();
+		return _flashResult;
+	}
+	if (size == 0 || size % 4 != 0 || size > MICROAPP_UPLOAD_MAX_CHUNK_SIZE) {
+		return ERR_WRONG_PAYLOAD_LENGTH;
+	}
+	if (offset + size > MICROAPP_MAX_SIZE) {
+		return ERR_NO_SPACE;
+	}
+
+	cs_ret_code_t retCode = erasePagesUpTo((offset + size - 1) / CS_FLASH_PAGE_SIZE);
+	if (retCode != ERR_SUCCESS) {
+		return retCode;
+	}
+
+	// The data has to stay valid until it's written, while the result is returned before that.
+	uint8_t* buffer = _chunkBuffers[_nextChunkBuffer];
+	memcpy(buffer, data, size);
+	retCode = _flash.queueWrite(offset, buffer, size);
+	if (retCode != ERR_SUCCESS) {
+		return retCode;
+	}
+	_queuedOperationCount++;
+	_queuedChunkCount++;
+	_nextChunkBuffer = (_nextChunkBuffer + 1) % CHUNK_BUFFER_COUNT;
+	_nextOffset += size;
+
+	if (offset == 0 && size >= sizeof(microapp_binary_header_t)) {
+		const microapp_binary_header_t* header = reinterpret_cast<const microapp_binary_header_t*>(buffer);
+		if (header->size >= sizeof(microapp_binary_header_t) && header->size <= MICROAPP_MAX_SIZE) {
+			_appSize = header->size;
+		}
+	}
+
+	// Erase the next page of the app while the chunks of the current page are sent. When the queue is full, this is
+	// tried again with the next chunk.
+	uint8_t appPageCount = (_appSize + CS_FLASH_PAGE_SIZE - 1) / CS_FLASH_PAGE_SIZE;
+	if (_erasedPageCount < appPageCount) {
+		erasePagesUpTo(_erasedPageCount);
+	}
+
+	if (_appSize == 0 || _nextOffset >= _appSize) {
+		// The last chunk, or the end is unknown: the app can be validated once everything has been written.
+		_pendingResult = PendingResult::ALL_DONE;
+		return ERR_WAIT_FOR_SUCCESS;
+	}
+	if (_queuedChunkCount == CHUNK_BUFFER_COUNT) {
+		_pendingResult = PendingResult::CHUNK_BUFFER_FREE;
+		return ERR_WAIT_FOR_SUCCESS;
+	}
+	return ERR_SUCCESS;
+}
+
+cs_ret_code_t MicroappUploadQueue::onWriteDone(cs_ret_code_t result) {
+	if (_queuedChunkCount != 0) {
+		_queuedChunkCount--;
+	}
+	return onOperationDone(result);
+}
+
+cs_ret_code_t MicroappUploadQueue::onEraseDone(cs_ret_code_t result) {
+	return onOperationDone(result);
+}
+
+cs_ret_code_t MicroappUploadQueue::onOperationDone(cs_ret_code_t result) {
+	LOGMicroappUploadDebug("onOperationDone result=%u queued=%u", result, _queuedOperationCount);
+	if (_queuedOperationCount != 0) {
+		_queuedOperationCount--;
+	}
+	if (result != ERR_SUCCESS && _flashResult == ERR_SUCCESS) {
+		_flashResult = result;
+	}
+
+	switch (_pendingResult) {
+		case PendingResult::NONE: {
+			return ERR_WAIT_FOR_SUCCESS;
+		}
+		case PendingResult::CHUNK_BUFFER_FREE: {
+			if (_queuedChunkCount == CHUNK_BUFFER_COUNT && _flashResult == ERR_SUCCESS) {
+				// An erase was done, the chunks are still queued.
+				return ERR_WAIT_FOR_SUCCESS;
+			}
+			break;
+		}
+		case PendingResult::ALL_DONE: {
+			if (_queuedOperationCount != 0) {
+				return ERR_WAIT_FOR_SUCCESS;
+			}
+			break;
+		}
+	}
+
+	_pendingResult = PendingResult::NONE;
+	result         = _flashResult;
+	if (result != ERR_SUCCESS) {
+		// The failure is reported now.
+		_flashResult = ERR_SUCCESS;
+		stop();
+	}
+	return result;
+}
+
+cs_ret_code_t MicroappUploadQueue::erasePagesUpTo(uint8_t page) {
+	while (_erasedPageCount <= page) {
+		if (!_flash.isPageErased(_erasedPageCount)) {
+			LOGMicroappUploadDebug("Erase page %u", _erasedPageCount);
+			cs_ret_code_t retCode = _flash.queueErase(_erasedPageCount);
+			if (retCode != ERR_SUCCESS) {
+				return retCode;
+			}
+			_queuedOperationCount++;
+		}
+		_erasedPageCount++;
+	}
+	return ERR_SUCCESS;
+}
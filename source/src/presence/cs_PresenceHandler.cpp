@@ -17,7 +17,7 @@
 //#define PRESENCE_HANDLER_TESTING_CODE
 
 PresenceHandler::PresenceHandler() {
-	_store.clear();
+	clearRecords();
 }
 
 PresenceHandler::~PresenceHandler() {
@@ -113,11 +113,8 @@ void PresenceHandler::handleEvent(event_t& event) {
 			event.result.returnCode = ERR_SUCCESS;
 			return;
 		}
-		case CS_TYPE::EVT_TICK: {
-			TYPIFY(EVT_TICK)* tickCount = reinterpret_cast<TYPIFY(EVT_TICK)*>(event.data);
-			if (*tickCount % (1000 / TICK_INTERVAL_MS) == 0) {
-				tickSecond();
-			}
+		case CS_TYPE::EVT_TICK_SECOND: {
+			tickSecond();
 			return;
 		}
 		default: return;
@@ -170,7 +167,7 @@ PresenceMutation PresenceHandler::handleProfileLocation(ProfileLocation profileL
 		if (prevdescription.value_or(0) != 0) {
 			// sphere exit
 			LOGi("resetRecords");
-			_store.clear();
+			clearRecords();
 			return PresenceMutation::LastUserExitSphere;
 		}
 
@@ -178,7 +175,6 @@ PresenceMutation PresenceHandler::handleProfileLocation(ProfileLocation profileL
 	}
 #endif
 
-	uint8_t meshCountdown  = 0;
 	bool newLocation       = true;
 
 	PresenceRecord* record = _store.getOrAdd(profileLocation);
@@ -189,25 +185,25 @@ PresenceMutation PresenceHandler::handleProfileLocation(ProfileLocation profileL
 	else if (!record->isValid()) {
 		// Invalid record was found in the store, clean up and use that one.
 		*record = PresenceRecord(profileLocation);
+		addLocationRecord(profileLocation.location);
 	}
 	else {
 		// Record already exists for this profile location.
-		newLocation                     = false;
-
-		// Reset the timeout countdown.
-		record->timeoutCountdownSeconds = PRESENCE_TIMEOUT_SECONDS;
-		meshCountdown                   = record->meshSendCountdownSeconds;
+		newLocation = false;
 	}
 
-	// When record is new, or the old record mesh send countdown was 0: send profile location over the mesh.
-	if (meshCountdown == 0) {
+	// Reset the timeout.
+	_timeouts.schedule(getIndex(record), PRESENCE_TIMEOUT_SECONDS);
+
+	// When record is new, or the mesh send throttle has passed: send profile location over the mesh.
+	if (newLocation || isMeshSendAllowed(record)) {
 		if (forwardToMesh) {
 			sendMeshMessage(profileLocation);
 		}
-		meshCountdown = PRESENCE_MESH_SEND_THROTTLE_SECONDS
-						+ (RNG::getInstance().getRandom8() % PRESENCE_MESH_SEND_THROTTLE_SECONDS_VARIATION);
+		uint8_t throttleSeconds = PRESENCE_MESH_SEND_THROTTLE_SECONDS
+								  + (RNG::getInstance().getRandom8() % PRESENCE_MESH_SEND_THROTTLE_SECONDS_VARIATION);
+		record->meshSendSecond  = static_cast<uint8_t>(_timeouts.now()) + throttleSeconds;
 	}
-	record->meshSendCountdownSeconds = meshCountdown;
 
 	if (newLocation) {
 		dispatchPresenceChangeEvent(PresenceChange::PROFILE_LOCATION_ENTER, profileLocation);
@@ -286,33 +282,44 @@ std::optional<PresenceStateDescription> PresenceHandler::getCurrentPresenceDescr
 		LOGPresenceHandlerDebug("Presence is uncertain after boot");
 		return {};
 	}
-	PresenceStateDescription presence;
-	for (auto presenceRecord : _store) {
-		if (!presenceRecord.isValid()) {
-			continue;
-		}
-		presence.setLocation(presenceRecord.profileLocation.location);
+	return PresenceStateDescription(_occupiedLocationsBitmask);
+}
+
+void PresenceHandler::addLocationRecord(uint8_t location) {
+	if (_locationRecordCount[location]++ == 0) {
+		CsUtils::setBit(_occupiedLocationsBitmask, location);
+	}
+}
+
+void PresenceHandler::removeLocationRecord(uint8_t location) {
+	if (_locationRecordCount[location] == 0) {
+		LOGe("No records for location %u", location);
+		return;
+	}
+	if (--_locationRecordCount[location] == 0) {
+		CsUtils::clearBit(_occupiedLocationsBitmask, location);
 	}
-	return presence;
+}
+
+void PresenceHandler::clearRecords() {
+	_store.clear();
+	_timeouts.clear();
+	memset(_locationRecordCount, 0, sizeof(_locationRecordCount));
+	_occupiedLocationsBitmask = 0;
 }
 
 void PresenceHandler::tickSecond() {
 	auto prevDescription = getCurrentPresenceDescription();
 
-	for (auto& presenceRecord : _store) {
-		if (presenceRecord.isValid() && presenceRecord.timeoutCountdownSeconds != 0) {
-			presenceRecord.timeoutCountdownSeconds--;
-			if (presenceRecord.timeoutCountdownSeconds == 0) {
-				LOGi("Timeout: profile=%u location=%u",
-					 presenceRecord.profileLocation.profile,
-					 presenceRecord.profileLocation.location);
-				dispatchPresenceChangeEvent(PresenceChange::PROFILE_LOCATION_EXIT, presenceRecord.profileLocation);
-			}
-			else {
-				CsMath::Decrease(presenceRecord.meshSendCountdownSeconds);
-			}
-		}
-	}
+	_timeouts.tick([this](uint8_t index) {
+		PresenceRecord& presenceRecord = _store._records[index];
+		LOGi("Timeout: profile=%u location=%u",
+			 presenceRecord.profileLocation.profile,
+			 presenceRecord.profileLocation.location);
+		presenceRecord.invalidate();
+		removeLocationRecord(presenceRecord.profileLocation.location);
+		dispatchPresenceChangeEvent(PresenceChange::PROFILE_LOCATION_EXIT, presenceRecord.profileLocation);
+	});
 
 	auto nextDescription = getCurrentPresenceDescription();
 	auto mutation        = getMutationType(prevDescription, nextDescription);
@@ -328,16 +335,29 @@ void PresenceHandler::tickSecond() {
 	}
 }
 
+uint8_t PresenceHandler::getIndex(PresenceRecord* record) {
+	return record - _store.begin();
+}
+
+bool PresenceHandler::isMeshSendAllowed(PresenceRecord* record) {
+	uint8_t secondsPassed = static_cast<uint8_t>(_timeouts.now()) - record->meshSendSecond;
+	return static_cast<int8_t>(secondsPassed) >= 0;
+}
+
 PresenceHandler::PresenceRecord* PresenceHandler::clearOldestRecord(ProfileLocation profileLocation) {
-	// Last option, overwrite oldest record.
+	// Last option, overwrite oldest record: the one that times out first.
 	auto oldestRecord = _store.begin();
 	for (auto record = _store.begin(); record != _store.end(); record++) {
-		if (record->timeoutCountdownSeconds < oldestRecord->timeoutCountdownSeconds) {
+		if (_timeouts.remaining(getIndex(record)) < _timeouts.remaining(getIndex(oldestRecord))) {
 			oldestRecord = record;
 		}
 	}
 
 	LOGPresenceHandlerDebug("Overwriting oldest presence record");
+	if (oldestRecord->isValid()) {
+		removeLocationRecord(oldestRecord->profileLocation.location);
+	}
 	*oldestRecord = PresenceRecord(profileLocation);
+	addLocationRecord(profileLocation.location);
 	return oldestRecord;
 }
@@ -222,6 +222,7 @@ bool CommandAdvHandler::claim(
 		memcpy(_claims[index].encryptedData, encryptedData.data, CMD_ADC_ENCRYPTED_DATA_SIZE);
 		_claims[index].encryptedRC5 = encryptedRC5;
 		_claims[index].decryptedRC5 = decryptedRC5;
+		_tickRequest.request();
 		return true;
 	}
 	LOGCommandAdvDebug("No more claim spots");
@@ -229,11 +230,16 @@ bool CommandAdvHandler::claim(
 }
 
 void CommandAdvHandler::tickClaims() {
+	bool claimed = false;
 	for (int i = 0; i < CMD_ADV_MAX_CLAIM_COUNT; ++i) {
 		if (_claims[i].timeoutCounter) {
 			--_claims[i].timeoutCounter;
+			claimed |= (_claims[i].timeoutCounter != 0);
 		}
 	}
+	if (!claimed) {
+		_tickRequest.release();
+	}
 }
 
 bool CommandAdvHandler::handleEncryptedCommandPayload(
@@ -21,13 +21,40 @@
 #include <processing/cs_Setup.h>
 #include <processing/cs_TemperatureGuard.h>
 #include <protocol/mesh/cs_MeshModelPacketHelper.h>
+#include <storage/cs_IpcRamBluenet.h>
 #include <storage/cs_State.h>
+#include <storage/cs_StateTransfer.h>
 #include <time/cs_SystemTime.h>
 #include <uart/cs_UartHandler.h>
 #include <util/cs_WireFormat.h>
 
 #define LOGCommandHandlerDebug LOGnone
 
+/**
+ * Hand over state to the next boot, so that it doesn't have to converge again.
+ *
+ * Not done when going into, or coming out of, factory reset mode: that should start with a clean state.
+ */
+void storeWarmBootData() {
+	TYPIFY(STATE_OPERATION_MODE) mode;
+	State::getInstance().get(CS_TYPE::STATE_OPERATION_MODE, &mode, sizeof(mode));
+	if (getOperationMode(mode) == OperationMode::OPERATION_MODE_FACTORY_RESET) {
+		return;
+	}
+
+	bluenet_ipc_warm_boot_data_t warmBootData;
+	high_resolution_time_stamp_t stamp = SystemTime::getSynchronizedStamp();
+	warmBootData.posixTime             = stamp.posix_s;
+	warmBootData.posixTimeMs           = stamp.posix_ms;
+	warmBootData.timeVersion           = stamp.version;
+
+	TYPIFY(STATE_SWITCH_STATE) switchState;
+	State::getInstance().get(CS_TYPE::STATE_SWITCH_STATE, &switchState, sizeof(switchState));
+	warmBootData.switchState = switchState.asInt;
+
+	IpcRamBluenet::getInstance().storeWarmBootData(warmBootData);
+}
+
 void reset(void* p_context) {
 
 	uint8_t cmd = *(uint8_t*)p_context;
@@ -36,6 +63,7 @@ void reset(void* p_context) {
 		case CS_RESET_CODE_SOFT_RESET: {
 			LOGi(MSG_RESET);
 			GpRegRet::setCounter(CS_GPREGRET_COUNTER_SOFT_RESET);
+			storeWarmBootData();
 			break;
 		}
 		case CS_RESET_CODE_GO_TO_DFU_MODE: {
@@ -48,7 +76,15 @@ void reset(void* p_context) {
 	sd_nvic_SystemReset();
 }
 
-CommandHandler::CommandHandler() : _resetTimerId(nullptr), _boardConfig(nullptr) {
+CommandHandler::CommandHandler()
+		: _resetTimerId(nullptr)
+		, _boardConfig(nullptr)
+		, _asyncCommandTimeoutRoutine([this]() {
+			LOGw("Async command timed out: type=%u", _awaitingCommandResult.type);
+			_awaitingCommandResult.type = CTRL_CMD_NONE;
+			_asyncCommandTimeoutRoutine.stop();
+			return Coroutine::delayS(0);
+		}) {
 	_resetTimerData = {{0}};
 	_resetTimerId   = &_resetTimerData;
 }
@@ -83,9 +119,9 @@ void CommandHandler::handleCommand(
 
 	_handleCommand(protocolVersion, type, commandData, source, accessLevel, result);
 	if (result.returnCode == ERR_WAIT_FOR_SUCCESS) {
-		_awaitingCommandResult.type             = type;
-		_awaitingCommandResult.source           = source;
-		_awaitingCommandResult.timeoutCountdown = ASYNC_COMMAND_TIMEOUT_MS / TICK_INTERVAL_MS;
+		_awaitingCommandResult.type   = type;
+		_awaitingCommandResult.source = source;
+		_asyncCommandTimeoutRoutine.start(ASYNC_COMMAND_TIMEOUT_MS);
 	}
 }
 
@@ -123,8 +159,8 @@ void CommandHandler::resolveAsyncCommand(cs_async_result_t* result) {
 		}
 	}
 	// Reset the await.
-	_awaitingCommandResult.type             = CTRL_CMD_NONE;
-	_awaitingCommandResult.timeoutCountdown = 0;
+	_awaitingCommandResult.type = CTRL_CMD_NONE;
+	_asyncCommandTimeoutRoutine.stop();
 }
 
 void CommandHandler::_handleCommand(
@@ -182,11 +218,14 @@ void CommandHandler::_handleCommand(
 		case CTRL_CMD_HUB_DATA: return handleCmdHubData(commandData, accessLevel, result);
 		case CTRL_CMD_STATE_GET: return handleCmdStateGet(commandData, accessLevel, result);
 		case CTRL_CMD_STATE_SET: return handleCmdStateSet(commandData, accessLevel, result);
+		case CTRL_CMD_STATE_EXPORT: return handleCmdStateExport(commandData, accessLevel, result);
+		case CTRL_CMD_STATE_IMPORT: return handleCmdStateImport(commandData, accessLevel, result);
 		case CTRL_CMD_REGISTER_TRACKED_DEVICE: return handleCmdRegisterTrackedDevice(commandData, accessLevel, result);
 		case CTRL_CMD_TRACKED_DEVICE_HEARTBEAT:
 			return handleCmdTrackedDeviceHeartbeat(commandData, accessLevel, result);
 		case CTRL_CMD_GET_UPTIME: return handleCmdGetUptime(commandData, accessLevel, result);
 		case CTRL_CMD_MICROAPP_UPLOAD: return handleCmdMicroappUpload(commandData, accessLevel, result);
+		case CTRL_CMD_MICROAPP_UPLOAD_LZ: return handleCmdMicroappUpload(commandData, accessLevel, result, true);
 		case CTRL_CMD_MICROAPP_MESSAGE: return handleCmdMicroappMessage(commandData, accessLevel, result);
 		// cases handled by dispatchEventForCommand:
 		case CTRL_CMD_SET_TIME: return dispatchEventForCommand(CS_TYPE::CMD_SET_TIME, commandData, source, result);
@@ -244,6 +283,8 @@ void CommandHandler::_handleCommand(
 			return dispatchEventForCommand(CS_TYPE::CMD_GET_FILTER_SUMMARIES, commandData, source, result);
 		case CTRL_CMD_RESET_MESH_TOPOLOGY:
 			return dispatchEventForCommand(CS_TYPE::CMD_MESH_TOPO_RESET, commandData, source, result);
+		case CTRL_CMD_GET_MESH_TOPOLOGY:
+			return dispatchEventForCommand(CS_TYPE::CMD_MESH_TOPO_GET_MATRIX, commandData, source, result);
 
 		case CTRL_CMD_NONE: [[fallthrough]];
 		case CTRL_CMD_UNKNOWN: result.returnCode = ERR_UNKNOWN_TYPE; return;
@@ -569,6 +610,50 @@ void CommandHandler::handleCmdStateSet(
 	}
 }
 
+void CommandHandler::handleCmdStateExport(
+		cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t& result) {
+	LOGi(STR_HANDLE_COMMAND "state export");
+
+	if (commandData.len != sizeof(state_export_packet_t)) {
+		LOGe(FMT_WRONG_PAYLOAD_LENGTH, commandData.len, sizeof(state_export_packet_t));
+		result.returnCode = ERR_WRONG_PAYLOAD_LENGTH;
+		return;
+	}
+
+	if (result.buf.len < sizeof(state_stream_header_t)) {
+		result.returnCode = ERR_BUFFER_TOO_SMALL;
+		return;
+	}
+
+	state_export_packet_t* request = reinterpret_cast<state_export_packet_t*>(commandData.data);
+	state_stream_header_t header;
+	cs_data_t chunk(result.buf.data + sizeof(header), result.buf.len - sizeof(header));
+	result.returnCode = StateTransfer::getInstance().getExportChunk(*request, accessLevel, header, chunk);
+	memcpy(result.buf.data, &header, sizeof(header));
+	result.dataSize = sizeof(header) + chunk.len;
+}
+
+void CommandHandler::handleCmdStateImport(
+		cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t& result) {
+	LOGi(STR_HANDLE_COMMAND "state import");
+
+	if (commandData.len < sizeof(state_stream_header_t)) {
+		LOGe(FMT_WRONG_PAYLOAD_LENGTH, commandData.len, sizeof(state_stream_header_t));
+		result.returnCode = ERR_WRONG_PAYLOAD_LENGTH;
+		return;
+	}
+
+	state_stream_header_t* header = reinterpret_cast<state_stream_header_t*>(commandData.data);
+	cs_const_data_t chunk(commandData.data + sizeof(*header), commandData.len - sizeof(*header));
+	uint32_t receivedSize = 0;
+	result.returnCode    = StateTransfer::getInstance().receiveImportChunk(*header, chunk, accessLevel, receivedSize);
+
+	if (result.buf.len >= sizeof(receivedSize)) {
+		memcpy(result.buf.data, &receivedSize, sizeof(receivedSize));
+		result.dataSize = sizeof(receivedSize);
+	}
+}
+
 void CommandHandler::handleCmdSetSunTime(
 		cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t& result) {
 	LOGCommandHandlerDebug(STR_HANDLE_COMMAND "set sun time");
@@ -1041,8 +1126,8 @@ void CommandHandler::handleCmdGetUptime(
 }
 
 void CommandHandler::handleCmdMicroappUpload(
-		cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t& result) {
-	LOGi(STR_HANDLE_COMMAND "microapp upload");
+		cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t& result, bool compressed) {
+	LOGi(STR_HANDLE_COMMAND "microapp upload compressed=%u", compressed);
 	if (commandData.len < sizeof(microapp_upload_t)) {
 		LOGe(FMT_WRONG_PAYLOAD_LENGTH, commandData.len, sizeof(microapp_upload_t));
 		result.returnCode = ERR_WRONG_PAYLOAD_LENGTH;
@@ -1050,9 +1135,10 @@ void CommandHandler::handleCmdMicroappUpload(
 	}
 
 	TYPIFY(CMD_MICROAPP_UPLOAD) evtData;
-	evtData.header    = *reinterpret_cast<microapp_upload_t*>(commandData.data);
-	evtData.data.len  = commandData.len - sizeof(evtData.header);
-	evtData.data.data = commandData.data + sizeof(evtData.header);
+	evtData.header     = *reinterpret_cast<microapp_upload_t*>(commandData.data);
+	evtData.data.len   = commandData.len - sizeof(evtData.header);
+	evtData.data.data  = commandData.data + sizeof(evtData.header);
+	evtData.compressed = compressed;
 	event_t event(CS_TYPE::CMD_MICROAPP_UPLOAD, &evtData, sizeof(evtData), result);
 	event.dispatch();
 	result.returnCode = event.result.returnCode;
@@ -1109,6 +1195,8 @@ EncryptionAccessLevel CommandHandler::getRequiredAccessLevel(const CommandHandle
 		case CTRL_CMD_MESH_COMMAND:
 		case CTRL_CMD_STATE_GET:
 		case CTRL_CMD_STATE_SET:
+		case CTRL_CMD_STATE_EXPORT:
+		case CTRL_CMD_STATE_IMPORT:
 		case CTRL_CMD_GET_TIME:
 		case CTRL_CMD_REGISTER_TRACKED_DEVICE:
 		case CTRL_CMD_TRACKED_DEVICE_HEARTBEAT: return BASIC;
@@ -1143,6 +1231,7 @@ EncryptionAccessLevel CommandHandler::getRequiredAccessLevel(const CommandHandle
 		case CTRL_CMD_GET_RAM_STATS:
 		case CTRL_CMD_MICROAPP_GET_INFO:
 		case CTRL_CMD_MICROAPP_UPLOAD:
+		case CTRL_CMD_MICROAPP_UPLOAD_LZ:
 		case CTRL_CMD_MICROAPP_VALIDATE:
 		case CTRL_CMD_MICROAPP_REMOVE:
 		case CTRL_CMD_MICROAPP_ENABLE:
@@ -1153,7 +1242,8 @@ EncryptionAccessLevel CommandHandler::getRequiredAccessLevel(const CommandHandle
 		case CTRL_CMD_FILTER_REMOVE:
 		case CTRL_CMD_FILTER_COMMIT:
 		case CTRL_CMD_FILTER_GET_SUMMARIES:
-		case CTRL_CMD_RESET_MESH_TOPOLOGY: return ADMIN;
+		case CTRL_CMD_RESET_MESH_TOPOLOGY:
+		case CTRL_CMD_GET_MESH_TOPOLOGY: return ADMIN;
 		case CTRL_CMD_NONE:
 		case CTRL_CMD_UNKNOWN: return NOT_SET;
 	}
@@ -1206,15 +1296,6 @@ void CommandHandler::handleEvent(event_t& event) {
 			resolveAsyncCommand(result);
 			break;
 		}
-		case CS_TYPE::EVT_TICK: {
-			if (_awaitingCommandResult.timeoutCountdown) {
-				if (--_awaitingCommandResult.timeoutCountdown == 0) {
-					LOGw("Async command timed out: type=%u", _awaitingCommandResult.type);
-					_awaitingCommandResult.type = CTRL_CMD_NONE;
-				}
-			}
-			break;
-		}
 		default: {
 		}
 	}
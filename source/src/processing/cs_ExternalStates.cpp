@@ -15,15 +15,11 @@
 //#include <cstring> // For calloc
 
 /**
- * Interval at which the timeout counter is decreased.
+ * Interval at which the timeout counter is decreased: every EVT_TICK_SECOND.
  */
 #define EXTERNAL_STATE_COUNT_INTERVAL_MS 1000
 #define EXTERNAL_STATE_TIMEOUT_COUNT_START (EXTERNAL_STATE_TIMEOUT_MS / EXTERNAL_STATE_COUNT_INTERVAL_MS)
 
-#if TICK_INTERVAL_MS > EXTERNAL_STATE_COUNT_INTERVAL_MS
-#error "TICK_INTERVAL_MS must not be larger than EXTERNAL_STATE_COUNT_INTERVAL_MS"
-#endif
-
 #if EXTERNAL_STATE_TIMEOUT_COUNT_START == 0
 #error "EXTERNAL_STATE_TIMEOUT_MS is too small, or EXTERNAL_STATE_COUNT_INTERVAL_MS is too large"
 #endif
@@ -148,12 +144,10 @@ int8_t ExternalStates::getRssi(stone_id_t id) {
 	return rssi;
 }
 
-void ExternalStates::tick(TYPIFY(EVT_TICK) tickCount) {
-	if (tickCount % (EXTERNAL_STATE_COUNT_INTERVAL_MS / TICK_INTERVAL_MS) == 0) {
-		for (int i = 0; i < EXTERNAL_STATE_LIST_COUNT; ++i) {
-			if (_states[i].timeoutCount) {
-				_states[i].timeoutCount--;
-			}
+void ExternalStates::tickSecond() {
+	for (int i = 0; i < EXTERNAL_STATE_LIST_COUNT; ++i) {
+		if (_states[i].timeoutCount) {
+			_states[i].timeoutCount--;
 		}
 	}
 }
@@ -314,12 +314,9 @@ void PowerSampling::handleEvent(event_t& event) {
 			RecognizeSwitch::getInstance().configure(threshold);
 			break;
 		}
-		case CS_TYPE::EVT_TICK: {
-			auto tickCount = *CS_TYPE_CAST(EVT_TICK, event.data);
-			if (tickCount % 10 == 0) {
-				// Reset every second.
-				_bufSkipCount = 0;
-			}
+		case CS_TYPE::EVT_TICK_SECOND: {
+			// Reset every second.
+			_bufSkipCount = 0;
 			if (_calibratePowerZeroCountDown) {
 				--_calibratePowerZeroCountDown;
 			}
@@ -838,6 +835,14 @@ bool PowerSampling::calculatePower(adc_buffer_id_t bufIndex) {
 	//	if (_zeroCurrentInitialized && _zeroVoltageInitialized) {
 	if (_zeroVoltageCount > 200 && _zeroCurrentCount > 200) {
 		checkSoftfuse(currentRmsMA, filteredCurrentRmsMedianMA, voltageRmsMilliVolt, bufIndex);
+
+		// Let the switch learn the current of the load.
+		if (--_currentMeasuredEventCountdown == 0) {
+			_currentMeasuredEventCountdown               = CURRENT_MEASURED_EVENT_INTERVAL;
+			TYPIFY(EVT_CURRENT_MEASURED) currentMilliAmp = filteredCurrentRmsMedianMA;
+			event_t event(CS_TYPE::EVT_CURRENT_MEASURED, &currentMilliAmp, sizeof(currentMilliAmp));
+			EventDispatcher::getInstance().dispatch(event);
+		}
 	}
 
 	/////////////////////////////////////////////////////////
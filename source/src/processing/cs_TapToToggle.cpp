@@ -81,6 +81,7 @@ void TapToToggle::handleBackgroundAdvertisement(adv_background_parsed_t* adv) {
 
 	uint8_t prevScore = list[index].score;
 	list[index].score += scoreIncrement;
+	_tickRequest.request();
 	if (list[index].score > scoreMax) {
 		list[index].score = scoreMax;
 	}
@@ -95,15 +96,24 @@ void TapToToggle::handleBackgroundAdvertisement(adv_background_parsed_t* adv) {
 }
 
 void TapToToggle::tick() {
+	if (!_tickRequest.isRequested()) {
+		return;
+	}
+	bool active = false;
 	for (uint8_t i = 0; i < T2T_LIST_COUNT; ++i) {
 		if (list[i].score) {
 			list[i].score--;
+			active |= (list[i].score != 0);
 		}
 	}
 	if (timeoutCounter) {
 		timeoutCounter--;
+		active |= (timeoutCounter != 0);
 	}
 	LOGT2Tv("scores=%u %u %u", list[0].score, list[1].score, list[2].score);
+	if (!active) {
+		_tickRequest.release();
+	}
 }
 
 void TapToToggle::handleEvent(event_t& event) {
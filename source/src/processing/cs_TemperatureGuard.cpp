@@ -9,10 +9,15 @@
 #include <processing/cs_TemperatureGuard.h>
 #include <storage/cs_State.h>
 
-TemperatureGuard::TemperatureGuard() : _appTimerId(NULL), _maxChipTemp(g_MAX_CHIP_TEMPERATURE), _comp(NULL) {
-	_appTimerData = {{0}};
-	_appTimerId   = &_appTimerData;
-}
+TemperatureGuard::TemperatureGuard()
+		: _tickRoutine(
+				[this]() {
+					tick();
+					return Coroutine::delayMs(1000 / TEMPERATURE_UPDATE_FREQUENCY);
+				},
+				TEMPERATURE_UPDATE_ALLOWED_JITTER_MS)
+		, _maxChipTemp(g_MAX_CHIP_TEMPERATURE)
+		, _comp(NULL) {}
 
 // This callback is decoupled from interrupt
 void comp_event_callback(CompEvent_t event) {
@@ -24,8 +29,6 @@ void TemperatureGuard::init(const boards_config_t& boardConfig) {
 
 	_dimmerTempInverted = boardConfig.flags.dimmerTempInverted;
 
-	Timer::getInstance().createSingleShot(_appTimerId, (app_timer_timeout_handler_t)TemperatureGuard::staticTick);
-
 	_comp = &COMP::getInstance();
 	TYPIFY(CONFIG_PWM_TEMP_VOLTAGE_THRESHOLD_UP) pwmTempThresholdUp;
 	TYPIFY(CONFIG_PWM_TEMP_VOLTAGE_THRESHOLD_DOWN) pwmTempThresholdDown;
@@ -104,19 +107,13 @@ void TemperatureGuard::tick() {
 		EventDispatcher::getInstance().dispatch(event);
 		_lastPwmTempEvent = curEvent;
 	}
-
-	scheduleNextTick();
-}
-
-void TemperatureGuard::scheduleNextTick() {
-	Timer::getInstance().start(_appTimerId, HZ_TO_TICKS(TEMPERATURE_UPDATE_FREQUENCY), this);
 }
 
 void TemperatureGuard::start() {
-	Timer::getInstance().start(_appTimerId, HZ_TO_TICKS(TEMPERATURE_UPDATE_FREQUENCY), this);
+	_tickRoutine.start(1000 / TEMPERATURE_UPDATE_FREQUENCY);
 	_comp->start(COMP_EVENT_BOTH);
 }
 
 void TemperatureGuard::stop() {
-	Timer::getInstance().stop(_appTimerId);
+	_tickRoutine.stop();
 }
@@ -64,7 +64,15 @@ bool isValidMeshPayload(cs_mesh_model_msg_type_t type, uint8_t* payload, size16_
 		case CS_MESH_MODEL_TYPE_ASSET_INFO_MAC: return payloadSize == sizeof(cs_mesh_model_msg_asset_report_mac_t);
 		case CS_MESH_MODEL_TYPE_ASSET_INFO_ID: return payloadSize == sizeof(cs_mesh_model_msg_asset_report_id_t);
 		case CS_MESH_MODEL_TYPE_NEIGHBOUR_RSSI: return payloadSize == sizeof(cs_mesh_model_msg_neighbour_rssi_t);
+		case CS_MESH_MODEL_TYPE_NEIGHBOUR_RSSI_DIGEST:
+			return payloadSize == sizeof(cs_mesh_model_msg_neighbour_rssi_digest_t);
 		case CS_MESH_MODEL_TYPE_CTRL_CMD: return payloadSize >= sizeof(cs_mesh_model_msg_ctrl_cmd_header_t);
+		case CS_MESH_MODEL_TYPE_ASSET_FILTER_CHUNK_REQUEST:
+			return payloadSize == sizeof(cs_mesh_model_msg_asset_filter_chunk_request_t);
+		case CS_MESH_MODEL_TYPE_ASSET_FILTER_CHUNK:
+			return payloadSize >= sizeof(cs_mesh_model_msg_asset_filter_chunk_header_t)
+				   && payloadSize <= sizeof(cs_mesh_model_msg_asset_filter_chunk_header_t)
+											 + MAX_MESH_ASSET_FILTER_CHUNK_SIZE;
 
 		case CS_MESH_MODEL_TYPE_MICROAPP: return true;
 		case CS_MESH_MODEL_TYPE_UNKNOWN: return false;
@@ -0,0 +1,27 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <storage/cs_GarbageCollectionPolicy.h>
+
+bool GarbageCollectionPolicy::shouldCollect(const storage_usage_t& usage, bool idle) const {
+	if (usage.freeableWords == 0) {
+		// Nothing to gain.
+		return false;
+	}
+	if (usage.largestFreeWords < _urgentFreeWords) {
+		return true;
+	}
+	if (!idle) {
+		return false;
+	}
+	if (usage.largestFreeWords < _idleFreeWords) {
+		// Only when it frees a meaningful amount, else the flash wears out when it's filled with valid records.
+		return usage.freeableWords >= _urgentFreeWords;
+	}
+	return static_cast<uint64_t>(usage.freeableWords) * 100
+		   >= static_cast<uint64_t>(usage.totalWords) * _idleFreeablePercent;
+}
@@ -23,6 +23,8 @@ IpcRamBluenet& IpcRamBluenet::getInstance() {
 }
 
 void IpcRamBluenet::init() {
+	initWarmBootData();
+
 	// Get bluenet data from IPC ram.
 	uint8_t ipcDataSize = 0;
 
@@ -97,6 +99,53 @@ void IpcRamBluenet::updateMicroappData(uint8_t appIndex, const microapp_reboot_d
 	printData();
 }
 
+void IpcRamBluenet::initWarmBootData() {
+	uint8_t ipcDataSize = 0;
+	IpcRetCode ipcCode  = getRamData(IPC_INDEX_WARM_BOOT, _warmBootData.raw, &ipcDataSize, sizeof(_warmBootData.raw));
+
+	// Only use the data once: a later reset, for example by the watchdog, is not a warm boot.
+	clearRamData(IPC_INDEX_WARM_BOOT);
+
+	if (ipcCode != IPC_RET_SUCCESS) {
+		LogIpcRamBluenetDebug("No warm boot data: ipcCode=%i", ipcCode);
+		return;
+	}
+	if (_warmBootData.warmBootData.ipcDataMajor != BLUENET_IPC_WARM_BOOT_DATA_MAJOR) {
+		LogIpcRamBluenetInfo(
+				"Different warm boot data major version: major=%u expected=%u",
+				_warmBootData.warmBootData.ipcDataMajor,
+				BLUENET_IPC_WARM_BOOT_DATA_MAJOR);
+		return;
+	}
+	LogIpcRamBluenetInfo(
+			"Loaded warm boot data: posix=%u version=%u switchState=%u",
+			_warmBootData.warmBootData.posixTime,
+			_warmBootData.warmBootData.timeVersion,
+			_warmBootData.warmBootData.switchState);
+	_hasWarmBootData = true;
+}
+
+bool IpcRamBluenet::hasWarmBootData() {
+	return _hasWarmBootData;
+}
+
+const bluenet_ipc_warm_boot_data_t& IpcRamBluenet::getWarmBootData() {
+	return _warmBootData.warmBootData;
+}
+
+void IpcRamBluenet::storeWarmBootData(const bluenet_ipc_warm_boot_data_t& data) {
+	bluenet_ipc_data_payload_t ipcData;
+	memset(ipcData.raw, 0, sizeof(ipcData.raw));
+	ipcData.warmBootData              = data;
+	ipcData.warmBootData.ipcDataMajor = BLUENET_IPC_WARM_BOOT_DATA_MAJOR;
+	ipcData.warmBootData.ipcDataMinor = BLUENET_IPC_WARM_BOOT_DATA_MINOR;
+
+	IpcRetCode ipcCode = setRamData(IPC_INDEX_WARM_BOOT, ipcData.raw, sizeof(ipcData.warmBootData));
+	if (ipcCode != IPC_RET_SUCCESS) {
+		LOGw("Failed to set warm boot data: ipcCode=%i", ipcCode);
+	}
+}
+
 void IpcRamBluenet::printData() {
 	_log(LogLevelIpcRamBluenetVerbose, true, "Bluenet IPC data:");
 	_log(LogLevelIpcRamBluenetVerbose,
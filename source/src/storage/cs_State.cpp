@@ -10,6 +10,7 @@
 
 #include <cfg/cs_Config.h>
 #include <common/cs_Types.h>
+#include <drivers/cs_RTC.h>
 #include <drivers/cs_Storage.h>
 #include <events/cs_Event.h>
 #include <events/cs_EventDispatcher.h>
@@ -63,6 +64,112 @@ void State::init(boards_config_t* boardsConfig) {
 	_storage->setErrorCallback(storageErrorCallback);
 	EventDispatcher::getInstance().addListener(this);
 	setInitialized();
+	preload();
+	replayJournal();
+	updateTickRequest();
+}
+
+/**
+ * Since all values in flash are iterated over, the lists of ids are complete.
+ * An empty list is created at the first id of a type, addToRam() adds the ids to it.
+ */
+void State::preload() {
+	uint32_t startTicks   = RTC::getCount();
+	uint16_t loadCount    = 0;
+	CS_TYPE type          = CS_TYPE::CONFIG_DO_NOT_USE;
+	cs_state_id_t id      = 0;
+	cs_ret_code_t retCode = _storage->findFirstOfAnyType(type, id);
+	while (retCode == ERR_SUCCESS) {
+		if (TypeSize(type) != 0 && DefaultLocation(type) == PersistenceMode::FLASH
+			&& (id == 0 || hasMultipleIds(type))) {
+			if (hasMultipleIds(type) && !hasIdsCache(type)) {
+				std::vector<cs_state_id_t>* ids = new std::vector<cs_state_id_t>();
+				_idsCache.push_back(cs_id_list_t(type, ids));
+			}
+			size16_t index_in_ram;
+			if (findInRam(type, id, index_in_ram) != ERR_SUCCESS) {
+				loadToRam(type, id, index_in_ram);
+				loadCount++;
+			}
+		}
+		retCode = _storage->findNextOfAnyType(type, id);
+	}
+	if (retCode != ERR_NOT_FOUND) {
+		LOGw("Preload stopped: retCode=%u", retCode);
+	}
+	LOGi("Preloaded %u values in %u ms", loadCount, RTC::msPassedSince(startTicks));
+}
+
+/**
+ * The journal records are only needed in RAM to replay them.
+ * The journal is compacted once writes to flash are started, so that the replayed values are not lost when the
+ * journal records are reused.
+ */
+void State::replayJournal() {
+	std::vector<cs_state_data_t> records;
+	bool hasCompactionMarker = false;
+	for (auto& ram_data : _ram_data_register) {
+		if (ram_data.type == CS_TYPE::STATE_JOURNAL && ram_data.size == sizeof(TYPIFY(STATE_JOURNAL))) {
+			if (ram_data.id == StateJournal::COMPACTION_MARKER_ID) {
+				_journal.onCompactionMarkerReplayed(
+						reinterpret_cast<TYPIFY(STATE_JOURNAL)*>(ram_data.value)->sequenceNumber);
+				hasCompactionMarker = true;
+			}
+			else {
+				records.push_back(ram_data);
+			}
+		}
+	}
+	if (hasCompactionMarker) {
+		removeFromRam(CS_TYPE::STATE_JOURNAL, StateJournal::COMPACTION_MARKER_ID);
+	}
+	if (records.empty()) {
+		return;
+	}
+	std::sort(records.begin(), records.end(), [](const cs_state_data_t& a, const cs_state_data_t& b) {
+		return reinterpret_cast<TYPIFY(STATE_JOURNAL)*>(a.value)->sequenceNumber
+			   < reinterpret_cast<TYPIFY(STATE_JOURNAL)*>(b.value)->sequenceNumber;
+	});
+
+	uint16_t entryCount          = 0;
+	uint8_t compactedRecordCount = 0;
+	for (auto& recordData : records) {
+		TYPIFY(STATE_JOURNAL)* record = reinterpret_cast<TYPIFY(STATE_JOURNAL)*>(recordData.value);
+		_journal.onRecordReplayed(recordData.id, record->sequenceNumber);
+		if (_journal.isCompacted(record->sequenceNumber)) {
+			// A reset interrupted the removal of the record, its values are in flash as normal records already.
+			compactedRecordCount++;
+			continue;
+		}
+		uint8_t offset = 0;
+		cs_state_data_t entry;
+		while (StateJournal::getEntry(*record, offset, entry)) {
+			if (!StateJournal::isJournaled(entry.type) || (entry.id != 0 && !hasMultipleIds(entry.type))
+				|| (entry.size != 0 && entry.size != TypeSize(entry.type))) {
+				LOGw("Invalid journal entry type=%u id=%u size=%u",
+					 to_underlying_type(entry.type),
+					 entry.id,
+					 entry.size);
+				continue;
+			}
+			if (entry.size == 0) {
+				removeFromRam(entry.type, entry.id);
+			}
+			else {
+				storeInRam(entry);
+			}
+			_journal.addChange(entry.type, entry.id);
+			entryCount++;
+		}
+	}
+	for (auto& recordData : records) {
+		removeFromRam(CS_TYPE::STATE_JOURNAL, recordData.id);
+	}
+	_journal.startCompaction();
+	LOGi("Replayed %u journal entries of %u records, skipped %u compacted records",
+		 entryCount,
+		 records.size(),
+		 compactedRecordCount);
 }
 
 cs_ret_code_t State::get(const CS_TYPE type, void* value, size16_t size) {
@@ -151,42 +258,14 @@ cs_ret_code_t State::get(cs_state_data_t& data, const PersistenceMode mode) {
 				return ERR_SUCCESS;
 			}
 			// Else we're going to add a new type to the ram data.
-			cs_state_data_t& ram_data = addToRam(type, id, typeSize);
-
-			// See if we need to check flash.
-			if (DefaultLocation(type) == PersistenceMode::RAM) {
-				LOGd("Load default: $typeName(%u)", ram_data.type);
-				ret_code = getDefaultValue(ram_data);
-				if (ret_code != ERR_SUCCESS) {
-					return ret_code;
-				}
-			}
-			else {
-				ret_code = _storage->read(ram_data);
-
-				// Temp code, to retain old reset counter.
-				if (ram_data.type == CS_TYPE::STATE_RESET_COUNTER && ret_code == ERR_NOT_FOUND) {
-					LOGi("Load old reset counter");
-					ret_code = _storage->readV3ResetCounter(ram_data);
-				}
-
-				switch (ret_code) {
-					case ERR_SUCCESS: {
-						break;
-					}
-					case ERR_NOT_FOUND:
-					default: {
-						LOGd("Load default: $typeName(%u)", ram_data.type);
-						ret_code = getDefaultValue(ram_data);
-						if (ret_code != ERR_SUCCESS) {
-							return ret_code;
-						}
-						break;
-					}
-				}
+			size16_t index_in_ram;
+			ret_code = loadToRam(type, id, index_in_ram);
+			if (ret_code != ERR_SUCCESS) {
+				return ret_code;
 			}
 			// Finally, copy data from ram to user data.
-			data.size = ram_data.size;
+			cs_state_data_t& ram_data = _ram_data_register[index_in_ram];
+			data.size                 = ram_data.size;
 			memcpy(data.value, ram_data.value, ram_data.size);
 			break;
 		}
@@ -194,6 +273,45 @@ cs_ret_code_t State::get(cs_state_data_t& data, const PersistenceMode mode) {
 	return ret_code;
 }
 
+cs_ret_code_t State::loadToRam(const CS_TYPE& type, cs_state_id_t id, size16_t& index_in_ram) {
+	cs_ret_code_t ret_code    = ERR_NOT_FOUND;
+	cs_state_data_t& ram_data = addToRam(type, id, TypeSize(type));
+	index_in_ram              = _ram_data_register.size() - 1;
+
+	// See if we need to check flash.
+	if (DefaultLocation(type) == PersistenceMode::RAM) {
+		LOGd("Load default: $typeName(%u)", ram_data.type);
+		return getDefaultValue(ram_data);
+	}
+
+	// A journaled value that is not in ram has been removed, but the record in flash may only be removed by compaction.
+	if (StateJournal::isJournaled(type) && _journal.isCompacting()) {
+		LOGd("Load default: $typeName(%u)", ram_data.type);
+		return getDefaultValue(ram_data);
+	}
+
+	ret_code = _storage->read(ram_data);
+
+	// Temp code, to retain old reset counter.
+	if (ram_data.type == CS_TYPE::STATE_RESET_COUNTER && ret_code == ERR_NOT_FOUND) {
+		LOGi("Load old reset counter");
+		ret_code = _storage->readV3ResetCounter(ram_data);
+	}
+
+	switch (ret_code) {
+		case ERR_SUCCESS: {
+			break;
+		}
+		case ERR_NOT_FOUND:
+		default: {
+			LOGd("Load default: $typeName(%u)", ram_data.type);
+			ret_code = getDefaultValue(ram_data);
+			break;
+		}
+	}
+	return ret_code;
+}
+
 /**
  * There are three modes:
  *   RAM: store item in volatile memory
@@ -221,7 +339,8 @@ cs_ret_code_t State::setInternal(const cs_state_data_t& data, const PersistenceM
 		LOGw("Expected type size is zero, wrong type (%u)?", data.type);
 		return ERR_UNKNOWN_TYPE;
 	}
-	if (data.size < typeSize) {
+	// Values of variable size, like the name, can be smaller than the type size.
+	if (data.size < typeSize && verifySizeForSet(data) != ERR_SUCCESS) {
 		LOGw("Type size is different (%u rather than %u).", data.size, typeSize);
 		return ERR_BUFFER_TOO_SMALL;
 	}
@@ -396,8 +515,11 @@ cs_ret_code_t State::storeInRam(const cs_state_data_t& data, size16_t& index_in_
 		LOGStateDebug("found previous value in RAM, updating it.");
 		cs_state_data_t& ram_data = _ram_data_register[index_in_ram];
 		if (ram_data.size != data.size) {
-			LOGe("Should not happen: ram_data.size=%u data.size=%u", ram_data.size, data.size);
-			assert(false, "See last error message");
+			// Only values of variable size, like the name, can change size.
+			if (verifySizeForSet(data) != ERR_SUCCESS) {
+				LOGe("Should not happen: ram_data.size=%u data.size=%u", ram_data.size, data.size);
+				assert(false, "See last error message");
+			}
 
 			free(ram_data.value);
 			ram_data.size = data.size;
@@ -482,6 +604,12 @@ cs_ret_code_t State::storeInFlash(size16_t& index_in_ram) {
 		return ERR_WRITE_NOT_ALLOWED;
 	}
 	cs_state_data_t ram_data = _ram_data_register[index_in_ram];
+	if (StateJournal::isJournaled(ram_data.type)) {
+		// Written with the next journal record.
+		_journal.addChange(ram_data.type, ram_data.id);
+		updateTickRequest();
+		return ERR_SUCCESS;
+	}
 	LOGStateDebug(
 			"Storage write type=%u size=%u data=%p [0x%X, ...]",
 			ram_data.type,
@@ -503,6 +631,11 @@ cs_ret_code_t State::removeFromFlash(const CS_TYPE& type, const cs_state_id_t id
 		return ERR_WRONG_STATE;
 	}
 	LOGd("removeFromFlash type=%u id=%u", to_underlying_type(type), id);
+	if (StateJournal::isJournaled(type)) {
+		// The value may also be in the journal records, so it has to be removed there as well.
+		_journal.addChange(type, id);
+		updateTickRequest();
+	}
 	cs_ret_code_t ret_code = _storage->remove(type, id);
 	switch (ret_code) {
 		case ERR_SUCCESS:
@@ -648,6 +781,15 @@ cs_ret_code_t State::getIdsFromFlash(const CS_TYPE& type, std::vector<cs_state_i
  *   - If so, check if given ID is in that list.
  *     - If not, add the ID to the list.
  */
+bool State::hasIdsCache(const CS_TYPE& type) {
+	for (auto typeIter = _idsCache.begin(); typeIter < _idsCache.end(); typeIter++) {
+		if (typeIter->type == type) {
+			return true;
+		}
+	}
+	return false;
+}
+
 cs_ret_code_t State::addId(const CS_TYPE& type, cs_state_id_t id) {
 	for (auto typeIter = _idsCache.begin(); typeIter < _idsCache.end(); typeIter++) {
 		if (typeIter->type == type) {
@@ -699,6 +841,7 @@ cs_ret_code_t State::setThrottled(const cs_state_data_t& data, uint32_t periodSe
 
 /**
  * Always first store to ram, use set() for this so that data struct is already validated.
+ * Journaled values are not delayed any further, so that they are not written later than a delayed value was before.
  * Check if type is already queued. If so, overwrite the counter, so that the write to storage is pushed forward in
  * time, thus avoiding multiple writes to storage.
  */
@@ -706,6 +849,10 @@ cs_ret_code_t State::setDelayed(const cs_state_data_t& data, uint8_t delaySecond
 	if (delaySeconds == 0) {
 		return ERR_WRONG_PARAMETER;
 	}
+	if (StateJournal::isJournaled(data.type)) {
+		// The journal already batches the changes, and is flushed within STATE_JOURNAL_FLUSH_INTERVAL_MS.
+		return set(data);
+	}
 	cs_ret_code_t ret_code = set(data, PersistenceMode::RAM);
 	if (ret_code != ERR_SUCCESS) {
 		return ret_code;
@@ -785,6 +932,7 @@ cs_ret_code_t State::addToQueue(
 		_store_queue.push_back(item);
 	}
 	LOGStateDebug("queue is now of size %u", _store_queue.size());
+	updateTickRequest();
 	return ERR_SUCCESS;
 }
 
@@ -866,6 +1014,161 @@ void State::delayedStoreTick() {
 	}
 }
 
+void State::garbageCollectTick() {
+	if (++_gcCheckSeconds < STORAGE_GC_CHECK_INTERVAL_MS / 1000) {
+		return;
+	}
+	_gcCheckSeconds = 0;
+	if (!_startedWritingToFlash || _performingFactoryReset) {
+		return;
+	}
+	bool idle = _connectionCount == 0 && _store_queue.empty() && !_journal.hasChanges();
+	_storage->garbageCollectIfNeeded(idle);
+}
+
+void State::updateTickRequest() {
+	if (!_store_queue.empty() || _journal.hasChanges() || _journal.isCompacting()) {
+		_tickRequest.request();
+	}
+	else {
+		_tickRequest.release();
+	}
+}
+
+/**
+ * The journal is flushed STATE_JOURNAL_FLUSH_INTERVAL_MS after the first change that is not written yet.
+ * Compaction is continued every tick, until it's done.
+ */
+void State::journalTick() {
+	if (!_journal.isCompacting()) {
+		if (!_journal.hasChanges()) {
+			_journalFlushTicks = 0;
+			return;
+		}
+		if (++_journalFlushTicks < STATE_JOURNAL_FLUSH_INTERVAL_MS / TICK_INTERVAL_MS) {
+			return;
+		}
+	}
+	if (!_startedWritingToFlash || _performingFactoryReset) {
+		return;
+	}
+	cs_ret_code_t retCode = _journal.isCompacting() ? compactJournal() : flushJournal();
+	if (retCode != ERR_BUSY) {
+		_journalFlushTicks = 0;
+	}
+}
+
+/**
+ * A removed value is written as entry without value.
+ * The record is kept in ram until it's written, and removed from ram at EVT_STORAGE_WRITE_DONE.
+ */
+cs_ret_code_t State::flushJournal() {
+	if (!_journal.hasChanges()) {
+		return ERR_SUCCESS;
+	}
+	if (_journal.isFull()) {
+		_journal.startCompaction();
+		return compactJournal();
+	}
+	TYPIFY(STATE_JOURNAL) record;
+	record.sequenceNumber = _journal.getNextSequenceNumber();
+	record.size           = 0;
+	uint8_t entryCount    = 0;
+	size16_t index_in_ram;
+	for (auto& change : _journal.getChanges()) {
+		cs_state_data_t entry(change.type, change.id, nullptr, 0);
+		if (findInRam(change.type, change.id, index_in_ram) == ERR_SUCCESS) {
+			entry = _ram_data_register[index_in_ram];
+		}
+		if (!StateJournal::appendEntry(record, entry)) {
+			// Written with the next record.
+			break;
+		}
+		entryCount++;
+	}
+
+	cs_state_data_t data(
+			CS_TYPE::STATE_JOURNAL,
+			_journal.getNextRecordId(),
+			reinterpret_cast<uint8_t*>(&record),
+			sizeof(record));
+	storeInRam(data, index_in_ram);
+	cs_ret_code_t retCode = _storage->write(_ram_data_register[index_in_ram]);
+	if (retCode != ERR_SUCCESS) {
+		LOGStateDebug("Failed to write journal: retCode=%u", retCode);
+		return retCode;
+	}
+	LOGStateDebug("Journal record id=%u entries=%u", data.id, entryCount);
+	_journal.onRecordWritten(entryCount);
+	return ERR_SUCCESS;
+}
+
+/**
+ * Storage handles operations in order, so the journal records are only removed after the values and the compaction
+ * marker have been written. A reset before the marker is written loses at most the changes that were not in a journal
+ * record yet, like a reset before a flush does.
+ */
+cs_ret_code_t State::compactJournal() {
+	cs_ret_code_t retCode;
+	std::vector<cs_type_and_id_t>& keys = _journal.getKeysToCompact();
+	while (!keys.empty()) {
+		cs_type_and_id_t key = keys.back();
+		size16_t index_in_ram;
+		if (findInRam(key.type, key.id, index_in_ram) == ERR_SUCCESS) {
+			retCode = _storage->write(_ram_data_register[index_in_ram]);
+		}
+		else {
+			retCode = _storage->remove(key.type, key.id);
+			if (retCode == ERR_NOT_FOUND) {
+				retCode = ERR_SUCCESS;
+			}
+		}
+		if (retCode == ERR_BUSY) {
+			return ERR_BUSY;
+		}
+		if (retCode != ERR_SUCCESS) {
+			LOGw("Failed to compact type=%u id=%u retCode=%u", to_underlying_type(key.type), key.id, retCode);
+		}
+		keys.pop_back();
+	}
+
+	if (_journal.needsCompactionMarker()) {
+		TYPIFY(STATE_JOURNAL) marker;
+		marker.sequenceNumber = _journal.getNextSequenceNumber();
+		marker.size           = 0;
+		cs_state_data_t data(
+				CS_TYPE::STATE_JOURNAL,
+				StateJournal::COMPACTION_MARKER_ID,
+				reinterpret_cast<uint8_t*>(&marker),
+				sizeof(marker));
+		size16_t index_in_ram;
+		storeInRam(data, index_in_ram);
+		retCode = _storage->write(_ram_data_register[index_in_ram]);
+		if (retCode == ERR_BUSY) {
+			return ERR_BUSY;
+		}
+		if (retCode != ERR_SUCCESS) {
+			LOGw("Failed to write compaction marker retCode=%u", retCode);
+		}
+		_journal.onCompactionMarkerWritten();
+	}
+
+	cs_state_id_t id;
+	while (_journal.getNextRecordToRemove(id)) {
+		retCode = _storage->remove(CS_TYPE::STATE_JOURNAL, id);
+		if (retCode == ERR_BUSY) {
+			return ERR_BUSY;
+		}
+		if (retCode != ERR_SUCCESS && retCode != ERR_NOT_FOUND) {
+			LOGw("Failed to remove journal id=%u retCode=%u", id, retCode);
+		}
+		_journal.onRecordRemoved();
+	}
+	_journal.onCompacted();
+	LOGi("Compacted journal");
+	return ERR_SUCCESS;
+}
+
 void State::startWritesToFlash() {
 	LOGd("startWritesToFlash");
 	_startedWritingToFlash = true;
@@ -877,6 +1180,8 @@ void State::factoryReset() {
 
 	// Clear queue, to remove any pending writes.
 	_store_queue.clear();
+	_journal.clear();
+	_journalFlushTicks = 0;
 
 	cs_ret_code_t retCode = ERR_BUSY;
 	if (_startedWritingToFlash) {
@@ -951,7 +1256,34 @@ void State::handleStorageError(cs_storage_operation_t operation, CS_TYPE type, c
 
 void State::handleEvent(event_t& event) {
 	switch (event.type) {
-		case CS_TYPE::EVT_TICK: delayedStoreTick(); break;
+		case CS_TYPE::EVT_TICK: {
+			delayedStoreTick();
+			journalTick();
+			updateTickRequest();
+			break;
+		}
+		case CS_TYPE::EVT_TICK_SECOND: {
+			garbageCollectTick();
+			break;
+		}
+		case CS_TYPE::EVT_STORAGE_WRITE_DONE: {
+			TYPIFY(EVT_STORAGE_WRITE_DONE)* eventData = reinterpret_cast<TYPIFY(EVT_STORAGE_WRITE_DONE)*>(event.data);
+			if (eventData->type == CS_TYPE::STATE_JOURNAL) {
+				// The journal record is only kept in ram until it's written.
+				removeFromRam(eventData->type, eventData->id);
+			}
+			break;
+		}
+		case CS_TYPE::EVT_BLE_CONNECT: {
+			_connectionCount++;
+			break;
+		}
+		case CS_TYPE::EVT_BLE_DISCONNECT: {
+			if (_connectionCount > 0) {
+				_connectionCount--;
+			}
+			break;
+		}
 		case CS_TYPE::CMD_FACTORY_RESET: {
 			factoryReset();
 			break;
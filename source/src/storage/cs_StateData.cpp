@@ -182,6 +182,7 @@ cs_ret_code_t getDefault(cs_state_data_t& data, const boards_config_t& boardsCon
 		case CS_TYPE::CONFIG_CURRENT_LIMIT: return ERR_NOT_IMPLEMENTED;
 		case CS_TYPE::CONFIG_DO_NOT_USE: return ERR_NOT_AVAILABLE;
 		case CS_TYPE::STATE_BEHAVIOUR_RULE: return ERR_NOT_AVAILABLE;
+		case CS_TYPE::STATE_JOURNAL: return ERR_NOT_AVAILABLE;
 		case CS_TYPE::STATE_TWILIGHT_RULE: return ERR_NOT_AVAILABLE;
 		case CS_TYPE::STATE_EXTENDED_BEHAVIOUR_RULE: return ERR_NOT_AVAILABLE;
 		case CS_TYPE::STATE_BEHAVIOUR_SETTINGS:
@@ -277,6 +278,7 @@ cs_ret_code_t getDefault(cs_state_data_t& data, const boards_config_t& boardsCon
 		case CS_TYPE::EVT_CS_CENTRAL_READ_RESULT:
 		case CS_TYPE::EVT_CS_CENTRAL_WRITE_RESULT:
 		case CS_TYPE::EVT_BROWNOUT_IMPENDING:
+		case CS_TYPE::EVT_CURRENT_MEASURED:
 		case CS_TYPE::EVT_CHIP_TEMP_ABOVE_THRESHOLD:
 		case CS_TYPE::EVT_CHIP_TEMP_OK:
 		case CS_TYPE::EVT_CURRENT_USAGE_ABOVE_THRESHOLD_DIMMER:
@@ -316,6 +318,7 @@ cs_ret_code_t getDefault(cs_state_data_t& data, const boards_config_t& boardsCon
 		case CS_TYPE::EVT_SWITCH_FORCED_OFF:
 		case CS_TYPE::CMD_LOCK_SWITCH:
 		case CS_TYPE::EVT_TICK:
+		case CS_TYPE::EVT_TICK_SECOND:
 		case CS_TYPE::EVT_TIME_SET:
 		case CS_TYPE::CMD_ADD_BEHAVIOUR:
 		case CS_TYPE::CMD_REPLACE_BEHAVIOUR:
@@ -379,6 +382,7 @@ cs_ret_code_t getDefault(cs_state_data_t& data, const boards_config_t& boardsCon
 		case CS_TYPE::EVT_MESH_TOPO_MAC_RESULT:
 		case CS_TYPE::CMD_MESH_TOPO_RESET:
 		case CS_TYPE::CMD_MESH_TOPO_GET_RSSI:
+		case CS_TYPE::CMD_MESH_TOPO_GET_MATRIX:
 		case CS_TYPE::EVT_TWI_INIT:
 		case CS_TYPE::EVT_TWI_WRITE:
 		case CS_TYPE::EVT_TWI_READ:
@@ -448,6 +452,7 @@ PersistenceMode DefaultLocation(CS_TYPE const& type) {
 		case CS_TYPE::STATE_OPERATION_MODE:
 		case CS_TYPE::STATE_SWITCH_STATE:
 		case CS_TYPE::STATE_BEHAVIOUR_RULE:
+		case CS_TYPE::STATE_JOURNAL:
 		case CS_TYPE::STATE_TWILIGHT_RULE:
 		case CS_TYPE::STATE_EXTENDED_BEHAVIOUR_RULE:
 		case CS_TYPE::STATE_BEHAVIOUR_SETTINGS:
@@ -524,6 +529,7 @@ PersistenceMode DefaultLocation(CS_TYPE const& type) {
 		case CS_TYPE::EVT_CS_CENTRAL_READ_RESULT:
 		case CS_TYPE::EVT_CS_CENTRAL_WRITE_RESULT:
 		case CS_TYPE::EVT_BROWNOUT_IMPENDING:
+		case CS_TYPE::EVT_CURRENT_MEASURED:
 		case CS_TYPE::EVT_SESSION_DATA_SET:
 		case CS_TYPE::EVT_DIMMER_FORCED_OFF:
 		case CS_TYPE::EVT_SWITCH_FORCED_OFF:
@@ -533,6 +539,7 @@ PersistenceMode DefaultLocation(CS_TYPE const& type) {
 		case CS_TYPE::EVT_DIMMER_TEMP_ABOVE_THRESHOLD:
 		case CS_TYPE::EVT_DIMMER_TEMP_OK:
 		case CS_TYPE::EVT_TICK:
+		case CS_TYPE::EVT_TICK_SECOND:
 		case CS_TYPE::EVT_TIME_SET:
 		case CS_TYPE::EVT_DIMMER_POWERED:
 		case CS_TYPE::CMD_DIMMING_ALLOWED:
@@ -632,6 +639,7 @@ PersistenceMode DefaultLocation(CS_TYPE const& type) {
 		case CS_TYPE::EVT_MESH_TOPO_MAC_RESULT:
 		case CS_TYPE::CMD_MESH_TOPO_RESET:
 		case CS_TYPE::CMD_MESH_TOPO_GET_RSSI:
+		case CS_TYPE::CMD_MESH_TOPO_GET_MATRIX:
 		case CS_TYPE::EVT_TWI_INIT:
 		case CS_TYPE::EVT_TWI_WRITE:
 		case CS_TYPE::EVT_TWI_READ:
@@ -0,0 +1,152 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <storage/cs_StateJournal.h>
+
+#include <algorithm>
+#include <cstring>
+
+static_assert(
+		2 * sizeof(cs_state_journal_entry_header_t) + sizeof(TYPIFY(STATE_SWITCH_STATE))
+						+ sizeof(TYPIFY(STATE_SUN_TIME))
+				<= CS_STATE_JOURNAL_ENTRIES_SIZE,
+		"Journaled types don't fit in a journal record.");
+
+/**
+ * Only small values that are written often, and that are fine to lose the latest flush interval of.
+ * A journal record should fit an entry of each journaled type.
+ */
+bool StateJournal::isJournaled(const CS_TYPE& type) {
+	switch (type) {
+		case CS_TYPE::STATE_SWITCH_STATE: return true;
+		default: return false;
+	}
+}
+
+bool StateJournal::appendEntry(cs_state_journal_t& record, const cs_state_data_t& data) {
+	cs_state_journal_entry_header_t header;
+	if (record.size + sizeof(header) + data.size > sizeof(record.entries)) {
+		return false;
+	}
+	header.type = to_underlying_type(data.type);
+	header.id   = data.id;
+	header.size = data.size;
+	memcpy(record.entries + record.size, &header, sizeof(header));
+	record.size += sizeof(header);
+	memcpy(record.entries + record.size, data.value, data.size);
+	record.size += data.size;
+	return true;
+}
+
+bool StateJournal::getEntry(cs_state_journal_t& record, uint8_t& offset, cs_state_data_t& data) {
+	cs_state_journal_entry_header_t header;
+	if (record.size > sizeof(record.entries) || offset + sizeof(header) > record.size) {
+		return false;
+	}
+	memcpy(&header, record.entries + offset, sizeof(header));
+	offset += sizeof(header);
+	if (offset + header.size > record.size) {
+		return false;
+	}
+	data.type  = toCsType(header.type);
+	data.id    = header.id;
+	data.size  = header.size;
+	data.value = record.entries + offset;
+	offset += header.size;
+	return true;
+}
+
+void StateJournal::addChange(const CS_TYPE& type, cs_state_id_t id) {
+	addKey(_changes, type, id);
+}
+
+void StateJournal::onRecordWritten(uint8_t entryCount) {
+	for (uint8_t i = 0; i < entryCount && i < _changes.size(); ++i) {
+		addKey(_keys, _changes[i].type, _changes[i].id);
+	}
+	_changes.erase(_changes.begin(), _changes.begin() + std::min<size_t>(entryCount, _changes.size()));
+	_recordCount++;
+	_sequenceNumber++;
+}
+
+void StateJournal::onRecordReplayed(cs_state_id_t id, uint32_t sequenceNumber) {
+	if (id >= _recordCount) {
+		_recordCount = id + 1;
+	}
+	if (sequenceNumber >= _sequenceNumber) {
+		_sequenceNumber = sequenceNumber + 1;
+	}
+}
+
+void StateJournal::onCompactionMarkerReplayed(uint32_t sequenceNumber) {
+	_compactedSequenceNumber = sequenceNumber;
+	if (sequenceNumber > _sequenceNumber) {
+		_sequenceNumber = sequenceNumber;
+	}
+}
+
+void StateJournal::startCompaction() {
+	for (auto& change : _changes) {
+		addKey(_keys, change.type, change.id);
+	}
+	_changes.clear();
+	_removedRecordCount      = 0;
+	_compacting              = true;
+	_compactionMarkerWritten = false;
+}
+
+/**
+ * Records are written with increasing ids, so they're removed in that order. When the removal is interrupted by a
+ * reboot, the remaining records are the most recent ones.
+ */
+bool StateJournal::getNextRecordToRemove(cs_state_id_t& id) const {
+	if (_removedRecordCount >= _recordCount) {
+		return false;
+	}
+	id = _removedRecordCount;
+	return true;
+}
+
+/**
+ * All records have a lower sequence number than the marker, and the records written after compaction a higher or
+ * equal one.
+ */
+void StateJournal::onCompactionMarkerWritten() {
+	_compactedSequenceNumber = _sequenceNumber;
+	_compactionMarkerWritten = true;
+}
+
+void StateJournal::onRecordRemoved() {
+	_removedRecordCount++;
+}
+
+void StateJournal::onCompacted() {
+	_keys.clear();
+	_recordCount        = 0;
+	_removedRecordCount = 0;
+	_compacting         = false;
+}
+
+void StateJournal::clear() {
+	_changes.clear();
+	_keys.clear();
+	_recordCount             = 0;
+	_removedRecordCount      = 0;
+	_sequenceNumber          = 0;
+	_compactedSequenceNumber = 0;
+	_compacting              = false;
+	_compactionMarkerWritten = false;
+}
+
+void StateJournal::addKey(std::vector<cs_type_and_id_t>& keys, const CS_TYPE& type, cs_state_id_t id) {
+	for (auto& key : keys) {
+		if (key.type == type && key.id == id) {
+			return;
+		}
+	}
+	keys.push_back(cs_type_and_id_t{type, id});
+}
@@ -0,0 +1,341 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <cfg/cs_Config.h>
+#include <encryption/cs_KeysAndAccess.h>
+#include <logging/cs_Logger.h>
+#include <storage/cs_State.h>
+#include <storage/cs_StateTransfer.h>
+#include <util/cs_Crc32.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#define LOGStateTransferDebug LOGvv
+
+cs_ret_code_t StateTransfer::getExportChunk(
+		const state_export_packet_t& request,
+		const EncryptionAccessLevel accessLevel,
+		state_stream_header_t& header,
+		cs_data_t& chunk) {
+	LOGStateTransferDebug(
+			"getExportChunk offset=%u types=%u-%u", request.offset, request.typeStart, request.typeEnd);
+	uint32_t streamSize = 0;
+	uint32_t crc        = 0;
+	for (uint32_t typeNr = request.typeStart; typeNr <= request.typeEnd && typeNr < InternalBase; ++typeNr) {
+		CS_TYPE type = toCsType(typeNr);
+		if (!isTransferable(type, accessLevel)) {
+			continue;
+		}
+		exportRecord(type, 0, request.offset, chunk, streamSize, crc);
+		if (!hasMultipleIds(type)) {
+			continue;
+		}
+		std::vector<cs_state_id_t>* ids = nullptr;
+		if (State::getInstance().getIds(type, ids) != ERR_SUCCESS) {
+			continue;
+		}
+		for (auto id : *ids) {
+			if (id != 0) {
+				exportRecord(type, id, request.offset, chunk, streamSize, crc);
+			}
+		}
+	}
+
+	header.totalSize = streamSize;
+	header.crc       = crc;
+	header.offset    = request.offset;
+	if (request.offset > streamSize) {
+		LOGw("Offset %u is beyond the export size %u", request.offset, streamSize);
+		chunk.len = 0;
+		return ERR_WRONG_PARAMETER;
+	}
+	chunk.len = std::min<uint32_t>(chunk.len, streamSize - request.offset);
+	return ERR_SUCCESS;
+}
+
+void StateTransfer::exportRecord(
+		const CS_TYPE& type,
+		cs_state_id_t id,
+		uint32_t chunkOffset,
+		cs_data_t& chunk,
+		uint32_t& streamSize,
+		uint32_t& crc) {
+	// The value size is sent as uint8, see isTransferable().
+	uint8_t record[sizeof(state_record_header_t) + UINT8_MAX];
+	cs_state_data_t data(type, id, record + sizeof(state_record_header_t), UINT8_MAX);
+	cs_ret_code_t retCode = State::getInstance().get(data);
+	if (retCode != ERR_SUCCESS) {
+		// Not part of the export.
+		LOGd("Failed to get type=%u id=%u retCode=%u", to_underlying_type(type), id, retCode);
+		return;
+	}
+	state_record_header_t recordHeader;
+	recordHeader.stateType = to_underlying_type(type);
+	recordHeader.stateId   = id;
+	recordHeader.size      = data.size;
+	memcpy(record, &recordHeader, sizeof(recordHeader));
+	uint32_t recordSize = sizeof(recordHeader) + data.size;
+	crc                 = crc32(record, recordSize, &crc);
+
+	// Copy the part of the record that overlaps with the chunk.
+	uint32_t start      = std::max(streamSize, chunkOffset);
+	uint32_t end        = std::min(streamSize + recordSize, chunkOffset + chunk.len);
+	if (start < end) {
+		memcpy(chunk.data + start - chunkOffset, record + start - streamSize, end - start);
+	}
+	streamSize += recordSize;
+}
+
+cs_ret_code_t StateTransfer::receiveImportChunk(
+		const state_stream_header_t& header,
+		cs_const_data_t chunk,
+		const EncryptionAccessLevel accessLevel,
+		uint32_t& receivedSize) {
+	LOGStateTransferDebug("receiveImportChunk offset=%u size=%u total=%u", header.offset, chunk.len, header.totalSize);
+	if (header.offset == 0) {
+		clearImport();
+		if (header.totalSize > STATE_IMPORT_MAX_SIZE) {
+			LOGw("Import size %u too large", header.totalSize);
+			receivedSize = 0;
+			return ERR_NO_SPACE;
+		}
+		if (header.totalSize != 0) {
+			_importBuffer = (uint8_t*)malloc(header.totalSize);
+			if (_importBuffer == nullptr) {
+				receivedSize = 0;
+				return ERR_NO_SPACE;
+			}
+		}
+		_importSize = header.totalSize;
+	}
+	else if (_importBuffer == nullptr || header.offset != _receivedSize || header.totalSize != _importSize) {
+		LOGw("Expected offset %u of %u, got offset %u of %u",
+			 _receivedSize,
+			 _importSize,
+			 header.offset,
+			 header.totalSize);
+		receivedSize = _receivedSize;
+		return ERR_WRONG_STATE;
+	}
+
+	if (chunk.len > _importSize - _receivedSize) {
+		clearImport();
+		receivedSize = 0;
+		return ERR_WRONG_PAYLOAD_LENGTH;
+	}
+	if (chunk.len != 0) {
+		memcpy(_importBuffer + _receivedSize, chunk.data, chunk.len);
+	}
+	_receivedSize += chunk.len;
+	receivedSize = _receivedSize;
+	if (_receivedSize < _importSize) {
+		return ERR_SUCCESS;
+	}
+
+	// Whole stream received: check everything before anything is set.
+	uint32_t crc          = 0;
+	crc                   = crc32(_importBuffer, _importSize, &crc);
+	cs_ret_code_t retCode = ERR_MISMATCH;
+	if (crc != header.crc) {
+		LOGw("Import CRC mismatch: crc=%u expected=%u", crc, header.crc);
+	}
+	else {
+		uint32_t rollbackSize = 0;
+		retCode               = checkImport(accessLevel, rollbackSize);
+		if (retCode == ERR_SUCCESS) {
+			retCode = setImport(rollbackSize);
+		}
+	}
+	clearImport();
+	return retCode;
+}
+
+cs_ret_code_t StateTransfer::checkImport(const EncryptionAccessLevel accessLevel, uint32_t& rollbackSize) {
+	uint32_t offset = 0;
+	rollbackSize    = 0;
+	while (offset < _importSize) {
+		state_record_header_t recordHeader;
+		if (_importSize - offset < sizeof(recordHeader)) {
+			return ERR_WRONG_PAYLOAD_LENGTH;
+		}
+		memcpy(&recordHeader, _importBuffer + offset, sizeof(recordHeader));
+		offset += sizeof(recordHeader);
+		if (recordHeader.size > _importSize - offset) {
+			return ERR_WRONG_PAYLOAD_LENGTH;
+		}
+
+		CS_TYPE type = toCsType(recordHeader.stateType);
+		if (!isTransferable(type, accessLevel)) {
+			LOGw("Type %u can't be imported", recordHeader.stateType);
+			return ERR_NO_ACCESS;
+		}
+		if (recordHeader.stateId != 0 && !hasMultipleIds(type)) {
+			LOGw("Type %u can't have multiple IDs", recordHeader.stateType);
+			return ERR_WRONG_PARAMETER;
+		}
+		cs_state_data_t data(type, recordHeader.stateId, _importBuffer + offset, recordHeader.size);
+		cs_ret_code_t retCode = State::getInstance().verifySizeForSet(data);
+		if (retCode != ERR_SUCCESS) {
+			return retCode;
+		}
+		offset += recordHeader.size;
+		rollbackSize += sizeof(recordHeader) + TypeSize(type);
+	}
+	return ERR_SUCCESS;
+}
+
+cs_ret_code_t StateTransfer::setImport(uint32_t rollbackSize) {
+	State& state            = State::getInstance();
+	uint8_t* rollbackBuffer = nullptr;
+	if (rollbackSize != 0) {
+		rollbackBuffer = (uint8_t*)malloc(rollbackSize);
+		if (rollbackBuffer == nullptr) {
+			return ERR_NO_SPACE;
+		}
+	}
+
+	// Stage: keep the current value of each record, before anything is set.
+	uint32_t offset         = 0;
+	uint32_t rollbackOffset = 0;
+	while (offset < _importSize) {
+		state_record_header_t recordHeader;
+		memcpy(&recordHeader, _importBuffer + offset, sizeof(recordHeader));
+		offset += sizeof(recordHeader) + recordHeader.size;
+
+		cs_ret_code_t retCode = backupRecord(recordHeader, rollbackBuffer, rollbackOffset);
+		if (retCode != ERR_SUCCESS) {
+			LOGw("Failed to get type=%u id=%u retCode=%u", recordHeader.stateType, recordHeader.stateId, retCode);
+			free(rollbackBuffer);
+			return retCode;
+		}
+	}
+
+	// Commit: set each record. When one fails, set the kept values again, including that of the failed record, as
+	// it may have been set in RAM already.
+	cs_ret_code_t retCode = ERR_SUCCESS;
+	offset                = 0;
+	rollbackOffset        = 0;
+	while (offset < _importSize) {
+		state_record_header_t recordHeader;
+		memcpy(&recordHeader, _importBuffer + offset, sizeof(recordHeader));
+		cs_state_data_t data(
+				toCsType(recordHeader.stateType),
+				recordHeader.stateId,
+				_importBuffer + offset + sizeof(recordHeader),
+				recordHeader.size);
+		offset += sizeof(recordHeader) + recordHeader.size;
+
+		state_record_header_t rollbackHeader;
+		memcpy(&rollbackHeader, rollbackBuffer + rollbackOffset, sizeof(rollbackHeader));
+		rollbackOffset += sizeof(rollbackHeader) + rollbackHeader.size;
+
+		retCode = state.set(data);
+		if (retCode != ERR_SUCCESS && retCode != ERR_SUCCESS_NO_CHANGE) {
+			LOGw("Failed to import type=%u id=%u retCode=%u, rolling back",
+				 recordHeader.stateType,
+				 recordHeader.stateId,
+				 retCode);
+			rollbackImport(rollbackBuffer, rollbackOffset);
+			break;
+		}
+		retCode = ERR_SUCCESS;
+	}
+	free(rollbackBuffer);
+	return retCode;
+}
+
+cs_ret_code_t StateTransfer::backupRecord(
+		const state_record_header_t& recordHeader, uint8_t* rollbackBuffer, uint32_t& rollbackOffset) {
+	CS_TYPE type = toCsType(recordHeader.stateType);
+	State& state = State::getInstance();
+
+	// A value with an id other than 0 that isn't stored yet, has to be removed on roll back. This is marked by size 0.
+	bool stored = (recordHeader.stateId == 0);
+	if (!stored) {
+		std::vector<cs_state_id_t>* ids = nullptr;
+		cs_ret_code_t retCode           = state.getIds(type, ids);
+		if (retCode != ERR_SUCCESS) {
+			return retCode;
+		}
+		stored = std::find(ids->begin(), ids->end(), recordHeader.stateId) != ids->end();
+	}
+
+	state_record_header_t rollbackHeader = recordHeader;
+	rollbackHeader.size                  = 0;
+	if (stored) {
+		cs_state_data_t data(
+				type,
+				recordHeader.stateId,
+				rollbackBuffer + rollbackOffset + sizeof(rollbackHeader),
+				TypeSize(type));
+		cs_ret_code_t retCode = state.get(data);
+		if (retCode != ERR_SUCCESS) {
+			return retCode;
+		}
+		rollbackHeader.size = data.size;
+	}
+	memcpy(rollbackBuffer + rollbackOffset, &rollbackHeader, sizeof(rollbackHeader));
+	rollbackOffset += sizeof(rollbackHeader) + rollbackHeader.size;
+	return ERR_SUCCESS;
+}
+
+void StateTransfer::rollbackImport(uint8_t* rollbackBuffer, uint32_t rollbackSize) {
+	State& state    = State::getInstance();
+	uint32_t offset = 0;
+	while (offset < rollbackSize) {
+		state_record_header_t rollbackHeader;
+		memcpy(&rollbackHeader, rollbackBuffer + offset, sizeof(rollbackHeader));
+		offset += sizeof(rollbackHeader);
+
+		// The values were all kept before anything was set, so the order doesn't matter, even for duplicate records.
+		CS_TYPE type = toCsType(rollbackHeader.stateType);
+		cs_ret_code_t retCode;
+		if (rollbackHeader.size == 0) {
+			retCode = state.remove(type, rollbackHeader.stateId);
+		}
+		else {
+			cs_state_data_t data(type, rollbackHeader.stateId, rollbackBuffer + offset, rollbackHeader.size);
+			retCode = state.set(data);
+		}
+		switch (retCode) {
+			case ERR_SUCCESS:
+			case ERR_SUCCESS_NO_CHANGE:
+			case ERR_NOT_FOUND: break;
+			default:
+				LOGe("Failed to roll back type=%u id=%u retCode=%u",
+					 rollbackHeader.stateType,
+					 rollbackHeader.stateId,
+					 retCode);
+		}
+		offset += rollbackHeader.size;
+	}
+}
+
+bool StateTransfer::isTransferable(const CS_TYPE& type, const EncryptionAccessLevel accessLevel) {
+	size16_t typeSize = TypeSize(type);
+	if (typeSize == 0 || typeSize > UINT8_MAX || DefaultLocation(type) != PersistenceMode::FLASH) {
+		return false;
+	}
+	// Only state types that the user can both get and set, allowAccess() doesn't check this when encryption is
+	// disabled.
+	EncryptionAccessLevel getLevel = getUserAccessLevelGet(type);
+	EncryptionAccessLevel setLevel = getUserAccessLevelSet(type);
+	if (getLevel == NO_ONE || getLevel == NOT_SET || setLevel == NO_ONE || setLevel == NOT_SET) {
+		return false;
+	}
+	KeysAndAccess& keysAndAccess = KeysAndAccess::getInstance();
+	return keysAndAccess.allowAccess(getLevel, accessLevel) && keysAndAccess.allowAccess(setLevel, accessLevel);
+}
+
+void StateTransfer::clearImport() {
+	free(_importBuffer);
+	_importBuffer = nullptr;
+	_importSize   = 0;
+	_receivedSize = 0;
+}
@@ -0,0 +1,98 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <switch/cs_DimmerLoadModel.h>
+
+void DimmerLoadModel::clear() {
+	for (auto& point : _points) {
+		point = load_point_t();
+	}
+}
+
+void DimmerLoadModel::learn(uint8_t intensity, int32_t currentMilliAmp) {
+	if (intensity == 0 || intensity > 100) {
+		return;
+	}
+	if (currentMilliAmp < 0) {
+		currentMilliAmp = 0;
+	}
+	if (currentMilliAmp > 0xFFFF) {
+		currentMilliAmp = 0xFFFF;
+	}
+
+	load_point_t& point = _points[(intensity + BAND_SIZE / 2) / BAND_SIZE];
+	if (point.intensity == intensity) {
+		// Same intensity as before: average out the measurement noise.
+		int32_t diff = currentMilliAmp - point.currentMilliAmp;
+		point.currentMilliAmp += diff / (1 << AVERAGE_SHIFT);
+		return;
+	}
+	point.intensity       = intensity;
+	point.currentMilliAmp = currentMilliAmp;
+}
+
+int32_t DimmerLoadModel::predict(uint8_t intensity) const {
+	if (intensity == 0) {
+		return 0;
+	}
+	int8_t below = findPointBelow(intensity);
+	int8_t above = findPointAbove(intensity);
+
+	if (below >= 0 && above >= 0) {
+		const load_point_t& low  = _points[below];
+		const load_point_t& high = _points[above];
+		if (low.intensity == high.intensity) {
+			return low.currentMilliAmp;
+		}
+		return low.currentMilliAmp
+			   + (static_cast<int32_t>(high.currentMilliAmp) - low.currentMilliAmp) * (intensity - low.intensity)
+						 / (high.intensity - low.intensity);
+	}
+	if (below >= 0) {
+		// Extrapolate proportional to the intensity.
+		return static_cast<int32_t>(_points[below].currentMilliAmp) * intensity / _points[below].intensity;
+	}
+	if (above >= 0) {
+		// Assume the current doesn't increase when the intensity decreases.
+		return _points[above].currentMilliAmp;
+	}
+	return CURRENT_UNKNOWN;
+}
+
+uint8_t DimmerLoadModel::getStepSize(uint8_t intensity, int32_t limitMilliAmp, uint8_t minStepSize) const {
+	int32_t predicted = predict(intensity);
+	if (predicted == CURRENT_UNKNOWN || 2 * predicted >= limitMilliAmp) {
+		return minStepSize;
+	}
+	if (predicted == 0) {
+		return 100;
+	}
+	int32_t stepSize = minStepSize * limitMilliAmp / (2 * predicted);
+	if (stepSize > 100) {
+		return 100;
+	}
+	return stepSize;
+}
+
+int8_t DimmerLoadModel::findPointBelow(uint8_t intensity) const {
+	int8_t found = -1;
+	for (int8_t i = 0; i < POINT_COUNT; ++i) {
+		if (_points[i].intensity != 0 && _points[i].intensity <= intensity) {
+			found = i;
+		}
+	}
+	return found;
+}
+
+int8_t DimmerLoadModel::findPointAbove(uint8_t intensity) const {
+	for (int8_t i = 0; i < POINT_COUNT; ++i) {
+		if (_points[i].intensity != 0 && _points[i].intensity >= intensity) {
+			return i;
+		}
+	}
+	return -1;
+}
@@ -37,7 +37,11 @@ void SafeSwitch::init(const boards_config_t& board) {
 	State::getInstance().get(CS_TYPE::STATE_OPERATION_MODE, &mode, sizeof(mode));
 	operationMode = getOperationMode(mode);
 
+	State::getInstance().get(
+			CS_TYPE::CONFIG_SOFT_FUSE_CURRENT_THRESHOLD_DIMMER, &dimmerCurrentThreshold, sizeof(dimmerCurrentThreshold));
+
 	listen();
+	tickRequest.request();
 }
 
 void SafeSwitch::start() {
@@ -96,6 +100,11 @@ cs_ret_code_t SafeSwitch::setRelayUnchecked(bool value) {
 	currentState.state.relay = value;
 	relayHasBeenSetBefore    = true;
 
+	if (!value) {
+		// The dimmer may have to settle again.
+		tickRequest.request();
+	}
+
 	return ERR_SUCCESS;
 }
 
@@ -112,6 +121,9 @@ cs_ret_code_t SafeSwitch::setDimmer(uint8_t intensity, bool fade) {
 		if (!isSafeToDim(stateErrors)) {
 			return ERR_UNSAFE;
 		}
+		if (!isPredictedSafeToDim(intensity)) {
+			return ERR_UNSAFE;
+		}
 		if (!dimmerPowered) {
 			cs_ret_code_t retCode = startDimmerPowerCheck(intensity, fade);
 			if (retCode != ERR_SUCCESS) {
@@ -128,8 +140,10 @@ cs_ret_code_t SafeSwitch::setDimmerUnchecked(uint8_t intensity, bool fade) {
 	if (currentState.state.dimmer == intensity) {
 		return ERR_SUCCESS;
 	}
-	if (dimmer.set(intensity, fade)) {
+	uint8_t stepSize = loadModel.getStepSize(intensity, getPredictedCurrentLimit(), dimmer.getSoftOnSpeed());
+	if (dimmer.set(intensity, fade, stepSize)) {
 		currentState.state.dimmer = intensity;
+		tickRequest.request();
 		return ERR_SUCCESS;
 	}
 
@@ -157,6 +171,7 @@ cs_ret_code_t SafeSwitch::startDimmerPowerCheck(uint8_t intensity, bool fade) {
 
 	if (dimmerCheckCountDown == 0) {
 		dimmerCheckCountDown = DIMMER_BOOT_CHECK_DELAY_MS / TICK_INTERVAL_MS;
+		tickRequest.request();
 	}
 	return ERR_SUCCESS;
 }
@@ -247,6 +262,9 @@ void SafeSwitch::forceRelayOnAndDimmerOff() {
 
 	sendUnexpectedStateUpdate();
 
+	// The learned load didn't prevent this, so don't trust it anymore.
+	loadModel.clear();
+
 	// Disable dimming, as it's likely that dimming shouldn't be allowed for this device.
 	TYPIFY(CONFIG_DIMMING_ALLOWED) dimmingEnabled = 0;
 	State::getInstance().set(CS_TYPE::CONFIG_DIMMING_ALLOWED, &dimmingEnabled, sizeof(dimmingEnabled));
@@ -305,6 +323,78 @@ bool SafeSwitch::isSafeToDim(state_errors_t stateErrors) {
 	return !hasDimmerError(stateErrors) && !isSwitchOverLoaded(stateErrors);
 }
 
+// ======================== Load prediction ===========================
+
+int32_t SafeSwitch::getPredictedCurrentLimit() {
+	return static_cast<int32_t>(dimmerCurrentThreshold) * DIMMER_PREDICTED_CURRENT_MAX_PERCENT / 100;
+}
+
+bool SafeSwitch::isPredictedSafeToDim(uint8_t intensity) {
+	int32_t predictedCurrent = loadModel.predict(intensity);
+	if (predictedCurrent > getPredictedCurrentLimit()) {
+		LOGw("Predicted current at intensity %u is %i mA, threshold is %u mA",
+			 intensity,
+			 predictedCurrent,
+			 dimmerCurrentThreshold);
+		return false;
+	}
+	return true;
+}
+
+void SafeSwitch::updateDimmerSettled() {
+	if (dimmer.getCurrentIntensity() != currentState.state.dimmer || currentState.state.relay) {
+		dimmerSettleCountDown = DIMMER_LOAD_SETTLE_TIME_MS / TICK_INTERVAL_MS;
+		return;
+	}
+	if (dimmerSettleCountDown) {
+		--dimmerSettleCountDown;
+	}
+}
+
+void SafeSwitch::onTick() {
+	if (dimmerPowerUpCountDown && --dimmerPowerUpCountDown == 0) {
+		dimmerPoweredUp();
+	}
+	if (dimmerCheckCountDown && --dimmerCheckCountDown == 0) {
+		checkDimmerPower();
+	}
+	updateDimmerSettled();
+
+	// The dimmer doesn't settle while the relay is on, but then it doesn't matter either.
+	bool settled = (dimmerSettleCountDown == 0) || currentState.state.relay;
+	if (dimmerPowerUpCountDown == 0 && dimmerCheckCountDown == 0 && settled) {
+		tickRequest.release();
+	}
+}
+
+void SafeSwitch::handleCurrentMeasured(int32_t currentMilliAmp) {
+	// Only the current through the dimmer says something about the load at that intensity.
+	if (!dimmerPowered || currentState.state.relay || currentState.state.dimmer == 0) {
+		return;
+	}
+
+	if (currentMilliAmp > getPredictedCurrentLimit()) {
+		// The load was unknown, or changed: while fading, the current got close to the threshold.
+		// Turn the relay on instead, before the softfuse is triggered and dimming is disabled.
+		uint8_t intensity = dimmer.getCurrentIntensity();
+		LOGw("Current %i mA at intensity %u is close to the threshold", currentMilliAmp, intensity);
+		if (!isSafeToTurnRelayOn(getErrorState())) {
+			return;
+		}
+		loadModel.learn(intensity, currentMilliAmp);
+		setRelayUnchecked(true);
+		setDimmerUnchecked(0, false);
+		sendUnexpectedStateUpdate();
+		return;
+	}
+
+	if (dimmerSettleCountDown) {
+		return;
+	}
+	LOGSafeSwitch("learn intensity=%u current=%i mA", currentState.state.dimmer, currentMilliAmp);
+	loadModel.learn(currentState.state.dimmer, currentMilliAmp);
+}
+
 bool SafeSwitch::isWarmBoot() {
 	uint32_t resetReason;
 	event_t event(CS_TYPE::CMD_GET_RESET_REASON);
@@ -391,13 +481,12 @@ void SafeSwitch::handleEvent(event_t& evt) {
 	switch (evt.type) {
 		case CS_TYPE::EVT_GOING_TO_DFU: goingToDfu(); break;
 		case CS_TYPE::CMD_FACTORY_RESET: factoryReset(); break;
-		case CS_TYPE::EVT_TICK:
-			if (dimmerPowerUpCountDown && --dimmerPowerUpCountDown == 0) {
-				dimmerPoweredUp();
-			}
-			if (dimmerCheckCountDown && --dimmerCheckCountDown == 0) {
-				checkDimmerPower();
-			}
+		case CS_TYPE::EVT_TICK: onTick(); break;
+		case CS_TYPE::EVT_CURRENT_MEASURED:
+			handleCurrentMeasured(*reinterpret_cast<TYPIFY(EVT_CURRENT_MEASURED)*>(evt.data));
+			break;
+		case CS_TYPE::CONFIG_SOFT_FUSE_CURRENT_THRESHOLD_DIMMER:
+			dimmerCurrentThreshold = *reinterpret_cast<TYPIFY(CONFIG_SOFT_FUSE_CURRENT_THRESHOLD_DIMMER)*>(evt.data);
 			break;
 		case CS_TYPE::EVT_CURRENT_USAGE_ABOVE_THRESHOLD_DIMMER:
 		case CS_TYPE::EVT_DIMMER_TEMP_ABOVE_THRESHOLD:
@@ -22,7 +22,16 @@
 
 // ========================= Public ========================
 
-SwitchAggregator::SwitchAggregator() : _switchHistory(_maxSwitchHistoryItems) {}
+SwitchAggregator::SwitchAggregator()
+		: _switchcraftDoubleTapRoutine([this]() {
+			_switchcraftDoubleTapRoutine.stop();
+			return Coroutine::delayS(0);
+		})
+		, _ownerTimeoutRoutine([this]() {
+			_ownerTimeoutRoutine.stop();
+			return Coroutine::delayS(0);
+		})
+		, _switchHistory(_maxSwitchHistoryItems) {}
 
 void SwitchAggregator::init(const boards_config_t& board) {
 	LOGi("init");
@@ -188,6 +197,10 @@ bool SwitchAggregator::handleBehaviourEvents(event_t& event) {
 		case CS_TYPE::EVT_BEHAVIOURSTORE_MUTATION: {
 			BehaviourMutation* mutation = static_cast<TYPIFY(EVT_BEHAVIOURSTORE_MUTATION)*>(event.data);
 
+			// This event is handled before the behaviour handlers get it, make sure they don't skip evaluation.
+			_behaviourHandler.invalidate();
+			_twilightHandler.invalidate();
+
 			if(_behaviourStore == nullptr) {
 				LOGw("_behaviourStore is null in switchaggregator");
 				if(mutation->_mutation != BehaviourMutation::NONE) {
@@ -206,9 +219,7 @@ bool SwitchAggregator::handleBehaviourEvents(event_t& event) {
 
 				case BehaviourMutation::ADD:
 				case BehaviourMutation::UPDATE: {
-					auto behaviourPtr = _behaviourStore->getBehaviour(mutation->_index);
-
-					if(_behaviourHandler.validateBehaviour(behaviourPtr)){
+					if(_behaviourHandler.validateBehaviour(mutation->_index)){
 						LOGSwitchAggregatorDebug(
 								"Event Mutation::ADD/UPDATE received for valid behaviour. Clearing override and updating.");
 						_overrideState.reset();
@@ -262,19 +273,10 @@ bool SwitchAggregator::handleSwitchAggregatorCommand(event_t& event) {
 
 bool SwitchAggregator::handleTimingEvents(event_t& event) {
 	switch (event.type) {
-		case CS_TYPE::EVT_TICK: {
+		case CS_TYPE::EVT_TICK_SECOND: {
 			printStates(__LINE__);
-			// decrement until 0
-			if (_ownerTimeoutCountdown) {
-				_ownerTimeoutCountdown--;
-			}
-
-			if (_switchcraftDoubleTapCountdown) {
-				_switchcraftDoubleTapCountdown--;
-			}
 
-			// Execute code following this if statement, only once a second.
-			// But since we poll every tick, we are pretty close to the moment the posix seconds increase.
+			// Execute code following this if statement, only when the posix seconds increased.
 			uint32_t timestamp = SystemTime::posix();
 			if (timestamp == _lastTimestamp) {
 				break;
@@ -469,7 +471,7 @@ bool SwitchAggregator::registerSwitchcraftEvent(uint8_t currentValue) {
 	}
 
 	bool doubleTap = false;
-	if (_switchcraftDoubleTapCountdown) {
+	if (_switchcraftDoubleTapRoutine.isStarted()) {
 		// TODO: cache this value?
 		TYPIFY(STATE_SWITCHCRAFT_DOUBLE_TAP_ENABLED) doubleTapEnabled;
 		State::getInstance().get(
@@ -481,10 +483,10 @@ bool SwitchAggregator::registerSwitchcraftEvent(uint8_t currentValue) {
 	}
 	if (doubleTap) {
 		// Double tap happened now, so next tap should not be a double tap.
-		_switchcraftDoubleTapCountdown = 0;
+		_switchcraftDoubleTapRoutine.stop();
 	}
 	else {
-		_switchcraftDoubleTapCountdown = SWITCHCRAFT_DOUBLE_TAP_TIMEOUT_MS / TICK_INTERVAL_MS;
+		_switchcraftDoubleTapRoutine.start(SWITCHCRAFT_DOUBLE_TAP_TIMEOUT_MS);
 	}
 
 	if (doubleTap && _lastSwitchcraftOnValue == 0) {
@@ -599,10 +601,10 @@ bool SwitchAggregator::checkAndSetOwner(const cmd_source_with_counter_t& source)
 		return true;
 	}
 
-	if (_ownerTimeoutCountdown == 0) {
+	if (!_ownerTimeoutRoutine.isStarted()) {
 		// Switch isn't claimed yet.
-		_source                = source;
-		_ownerTimeoutCountdown = SWITCH_CLAIM_TIME_MS / TICK_INTERVAL_MS;
+		_source = source;
+		_ownerTimeoutRoutine.start(SWITCH_CLAIM_TIME_MS);
 		return true;
 	}
 
@@ -618,8 +620,8 @@ bool SwitchAggregator::checkAndSetOwner(const cmd_source_with_counter_t& source)
 		return false;
 	}
 
-	_source                = source;
-	_ownerTimeoutCountdown = SWITCH_CLAIM_TIME_MS / TICK_INTERVAL_MS;
+	_source = source;
+	_ownerTimeoutRoutine.start(SWITCH_CLAIM_TIME_MS);
 	return true;
 }
 
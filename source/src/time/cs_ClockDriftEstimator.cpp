@@ -0,0 +1,96 @@
+/**
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <time/cs_ClockDriftEstimator.h>
+#include <util/cs_Math.h>
+
+namespace {
+constexpr int64_t PPB = 1000 * 1000 * 1000;
+}
+
+void ClockDriftEstimator::reset() {
+	_count     = 0;
+	_oldest    = 0;
+	_driftPpb  = 0;
+	_remainder = 0;
+}
+
+const ClockDriftEstimator::sample_t& ClockDriftEstimator::getSample(uint8_t index) const {
+	return _samples[(_oldest + index) % SAMPLE_COUNT];
+}
+
+void ClockDriftEstimator::addSample(uint32_t localMs, uint64_t rootMs) {
+	if (_count > 0) {
+		// Check if the sample matches the current estimate.
+		const sample_t& newest = getSample(_count - 1);
+		uint32_t localMsPassed = localMs - newest.localMs;
+		uint64_t expectedMs    = newest.rootMs + correct(localMsPassed);
+		uint64_t deviationMs   = (rootMs > expectedMs) ? rootMs - expectedMs : expectedMs - rootMs;
+		if (deviationMs > MAX_DEVIATION_MS) {
+			reset();
+		}
+	}
+
+	if (_count < SAMPLE_COUNT) {
+		_samples[(_oldest + _count) % SAMPLE_COUNT] = {localMs, rootMs};
+		_count++;
+	}
+	else {
+		_samples[_oldest] = {localMs, rootMs};
+		_oldest           = (_oldest + 1) % SAMPLE_COUNT;
+	}
+	estimate();
+}
+
+void ClockDriftEstimator::estimate() {
+	const sample_t& first = getSample(0);
+	uint32_t spanMs       = getSample(_count - 1).localMs - first.localMs;
+	if (_count < MIN_SAMPLE_COUNT || spanMs < MIN_SPAN_MS) {
+		_driftPpb = 0;
+		return;
+	}
+
+	// Least squares fit of y = a + b * x, where:
+	//   x = local time passed since the first sample.
+	//   y = difference between root time passed and local time passed since the first sample.
+	// The slope b is the drift.
+	// Values are relative to the first sample, so they fit in integers without losing precision.
+	int64_t sumX  = 0;
+	int64_t sumY  = 0;
+	int64_t sumXX = 0;
+	int64_t sumXY = 0;
+	for (uint8_t i = 0; i < _count; ++i) {
+		const sample_t& sample = getSample(i);
+		int64_t x              = sample.localMs - first.localMs;
+		int64_t y              = static_cast<int64_t>(sample.rootMs - first.rootMs) - x;
+		sumX += x;
+		sumY += y;
+		sumXX += x * x;
+		sumXY += x * y;
+	}
+	int64_t numerator   = _count * sumXY - sumX * sumY;
+	int64_t denominator = _count * sumXX - sumX * sumX;
+	if (denominator <= 0) {
+		_driftPpb = 0;
+		return;
+	}
+	float drift = static_cast<float>(numerator) / static_cast<float>(denominator) * PPB;
+	_driftPpb   = static_cast<int32_t>(CsMath::clamp(drift, -MAX_DRIFT_PPB, MAX_DRIFT_PPB));
+}
+
+uint32_t ClockDriftEstimator::correct(uint32_t localMsPassed) const {
+	// Division truncates towards 0, so the correction is never larger than the time passed.
+	int64_t correction = (_remainder + static_cast<int64_t>(localMsPassed) * _driftPpb) / PPB;
+	return localMsPassed + correction;
+}
+
+uint32_t ClockDriftEstimator::advance(uint32_t localMsPassed) {
+	int64_t correctionPpb = _remainder + static_cast<int64_t>(localMsPassed) * _driftPpb;
+	int64_t correction    = correctionPpb / PPB;
+	_remainder            = correctionPpb - correction * PPB;
+	return localMsPassed + correction;
+}
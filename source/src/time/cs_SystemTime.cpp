@@ -17,6 +17,7 @@
 #include <time/cs_TimeOfDay.h>
 #include <time/cs_TimeSyncMessage.h>
 #include <util/cs_Lollipop.h>
+#include <util/cs_Math.h>
 
 #define LOGSystemTimeInfo LOGd
 #define LOGSystemTimeDebug LOGnone
@@ -52,12 +53,17 @@ uint32_t SystemTime::rtcCountOfLastRootTimeUpdate = 0;
 uint32_t SystemTime::uptimeOfLastTimeSyncMessage  = 0;
 stone_id_t SystemTime::rootClockId                = stone_id_init();
 stone_id_t SystemTime::myId                       = stone_id_init();
+ClockDriftEstimator SystemTime::driftEstimator;
+uint8_t SystemTime::syncPeriodShift               = 0;
+uint8_t SystemTime::syncMessagesSentAtPeriodShift = 0;
 Coroutine SystemTime::syncTimeCoroutine;
 Coroutine SystemTime::debugSyncTimeCoroutine;
-
-// driver details
-app_timer_t SystemTime::appTimerData  = {{0}};
-app_timer_id_t SystemTime::appTimerId = &appTimerData;
+Coroutine SystemTime::tickCoroutine(
+		[]() {
+			tick(nullptr);
+			return Coroutine::delayMs(TICK_TIME_MS);
+		},
+		TICK_ALLOWED_JITTER_MS);
 
 // ====================== Constants ======================
 
@@ -75,13 +81,22 @@ constexpr uint32_t SystemTime::root_clock_update_period_ms() {
 #endif  // DEBUG_SYSTEM_TIME
 }
 
-constexpr uint32_t SystemTime::root_clock_reelection_timeout_ms() {
-	// Chances of missing 10 messages should be low.
-	// From a test: 57% of msgs received, with a network of 2 nodes at 0.5m distance.
-	// So chance of missing 10 msgs would be: 0.43^10 = 0.0002
+constexpr uint8_t SystemTime::root_clock_max_period_shift() {
+	// 2 times the base period.
+	// Older firmware doesn't know the period shift: it always elects a new root after 10 base periods without sync
+	// message. With a longer period, it would get too few sync messages in that time.
+	return 1;
+}
+
+constexpr uint32_t SystemTime::root_clock_legacy_reelection_timeout_ms() {
 	return 10 * root_clock_update_period_ms();
 }
 
+constexpr uint8_t SystemTime::root_clock_sync_messages_per_period_step() {
+	// Give the other nodes enough samples to estimate their drift first.
+	return ClockDriftEstimator::MIN_SAMPLE_COUNT;
+}
+
 constexpr stone_id_t SystemTime::stone_id_init() {
 	// The largest value an id can be, which makes it accept any other stone id as root id.
 	return 0xFF;
@@ -110,17 +125,16 @@ void SystemTime::init() {
 	initDebug();
 
 	syncTimeCoroutine.action = []() { return syncTimeCoroutineAction(); };
+	syncTimeCoroutine.start();
 
 	State::getInstance().get(CS_TYPE::CONFIG_CROWNSTONE_ID, &myId, sizeof(myId));
 
-	Timer::getInstance().createSingleShot(appTimerId, static_cast<app_timer_timeout_handler_t>(&SystemTime::tick));
-
 	// Start the root clock, but accept clock of other IDs.
 	uint32_t rtcCount             = RTC::getCount();
 	rtcCountOfLastSecondIncrement = rtcCount;
 	setRootTimeStamp(high_resolution_time_stamp_t(), stone_id_init(), rtcCount);
 
-	scheduleNextTick();
+	tickCoroutine.start(TICK_TIME_MS);
 }
 
 // ======================== Utility functions ========================
@@ -146,12 +160,12 @@ uint32_t SystemTime::up() {
 	return upTimeSec;
 }
 
-// ======================== timing driver stuff ========================
-
-void SystemTime::scheduleNextTick() {
-	Timer::getInstance().start(appTimerId, MS_TO_TICKS(TICK_TIME_MS), nullptr);
+uint32_t SystemTime::uptimeMs(uint32_t rtcCount) {
+	return upTimeSec * 1000 + RTC::differenceMs(rtcCount, rtcCountOfLastSecondIncrement);
 }
 
+// ======================== timing driver stuff ========================
+
 void SystemTime::tick(void*) {
 	// Work with the same RTC count in all this code.
 	uint32_t rtcCount = RTC::getCount();
@@ -160,10 +174,12 @@ void SystemTime::tick(void*) {
 		updateRootTimeStamp(rtcCount);
 	}
 
+	bool secondPassed = false;
 	if (RTC::difference(rtcCount, rtcCountOfLastSecondIncrement) >= RTC::msToTicks(1000)) {
 		// At least 1 second has passed!
 		rtcCountOfLastSecondIncrement += RTC::msToTicks(1000);
 		upTimeSec += 1;
+		secondPassed = true;
 	}
 
 	if (throttleSetTimeCountdownTicks) {
@@ -173,7 +189,11 @@ void SystemTime::tick(void*) {
 		--throttleSetSunTimesCountdownTicks;
 	}
 
-	scheduleNextTick();
+	if (secondPassed) {
+		TYPIFY(EVT_TICK_SECOND) uptime = upTimeSec;
+		event_t event(CS_TYPE::EVT_TICK_SECOND, &uptime, sizeof(uptime));
+		event.dispatch();
+	}
 }
 
 // ======================== Setters ========================
@@ -210,6 +230,9 @@ cs_ret_code_t SystemTime::setTime(uint32_t time, bool throttled, bool sendToMesh
 	// It enforces the synchronization among crownstones because all nodes,
 	// even the true root clock, will update their local time.
 	setRootTimeStamp(stamp, 0, rtcCount);
+	driftEstimator.reset();
+	syncPeriodShift               = 0;
+	syncMessagesSentAtPeriodShift = 0;
 
 	if (sendToMesh) {
 		// Send more reliable message.
@@ -250,12 +273,27 @@ cs_ret_code_t SystemTime::setSunTimes(const sun_time_t& sunTimes, bool throttled
 	}
 }
 
+void SystemTime::restoreTime(high_resolution_time_stamp_t stamp) {
+	if (stamp.version < timestamp_version_min_valid()) {
+		return;
+	}
+	// The RTC restarted during the reboot: the time since it started, plus the time the bootloader took, has passed
+	// since the stamp was taken.
+	uint32_t rebootMs = RTC::ticksToMs(RTC::getCount()) + WARM_BOOT_BOOTLOADER_DURATION_MS;
+	uint64_t posixMs  = static_cast<uint64_t>(stamp.posix_s) * 1000 + stamp.posix_ms + rebootMs;
+	stamp.posix_s     = posixMs / 1000;
+	stamp.posix_ms    = posixMs % 1000;
+	LOGi("Restore time to %u, version=%u, reboot took %u ms", stamp.posix_s, stamp.version, rebootMs);
+	uint32_t prevtime = posix();
+	setRootTimeStamp(stamp, stone_id_init(), RTC::getCount());
+
+	event_t event(CS_TYPE::EVT_TIME_SET, &prevtime, sizeof(prevtime));
+	event.dispatch();
+}
+
 // ======================== Events ========================
 
 void SystemTime::handleEvent(event_t& event) {
-	syncTimeCoroutine.handleEvent(event);
-	debugSyncTimeCoroutine.handleEvent(event);
-
 	switch (event.type) {
 		case CS_TYPE::CMD_SET_TIME: {
 			LOGSystemTimeInfo(
@@ -320,6 +358,21 @@ uint8_t SystemTime::timeStampVersion() {
 	return rootTime.version;
 }
 
+uint32_t SystemTime::rootClockUpdatePeriodMs() {
+	return root_clock_update_period_ms() << syncPeriodShift;
+}
+
+uint32_t SystemTime::rootClockReelectionTimeoutMs() {
+	// Chances of missing 10 messages should be low.
+	// From a test: 57% of msgs received, with a network of 2 nodes at 0.5m distance.
+	// So chance of missing 10 msgs would be: 0.43^10 = 0.0002
+	// Older firmware should still get at least 5 sync messages from us: 0.43^5 = 0.015
+	static_assert(
+			5 * (root_clock_update_period_ms() << root_clock_max_period_shift())
+			<= root_clock_legacy_reelection_timeout_ms());
+	return 10 * rootClockUpdatePeriodMs();
+}
+
 void SystemTime::setRootTimeStamp(high_resolution_time_stamp_t stamp, stone_id_t id, uint32_t rtcCount) {
 	LOGSystemTimeDebug(
 			"setRootTimeStamp, posix=%u ms=%u version=%u id=%u", stamp.posix_s, stamp.posix_ms, stamp.version, id);
@@ -327,10 +380,11 @@ void SystemTime::setRootTimeStamp(high_resolution_time_stamp_t stamp, stone_id_t
 	rootClockId                  = id;
 	rootTime                     = stamp;
 	rtcCountOfLastRootTimeUpdate = rtcCount;
+	driftEstimator.clearRemainder();
 }
 
 void SystemTime::updateRootTimeStamp(uint32_t rtcCount) {
-	uint32_t msPassed         = RTC::differenceMs(rtcCount, rtcCountOfLastRootTimeUpdate);
+	uint32_t msPassed         = driftEstimator.advance(RTC::differenceMs(rtcCount, rtcCountOfLastRootTimeUpdate));
 
 	// Clock should go msPassed forward, this can be multiple seconds.
 	uint32_t secondsIncrement = (rootTime.posix_ms + msPassed) / 1000;
@@ -343,7 +397,7 @@ void SystemTime::updateRootTimeStamp(uint32_t rtcCount) {
 }
 
 high_resolution_time_stamp_t SystemTime::getSynchronizedStamp() {
-	uint32_t msPassed = RTC::msPassedSince(rtcCountOfLastRootTimeUpdate);
+	uint32_t msPassed = driftEstimator.correct(RTC::msPassedSince(rtcCountOfLastRootTimeUpdate));
 
 	// Don't update the root clock, as this function can be called many times,
 	// which would add up imprecision to the root clock.
@@ -361,14 +415,31 @@ high_resolution_time_stamp_t SystemTime::getSynchronizedStamp() {
 uint32_t SystemTime::syncTimeCoroutineAction() {
 	LOGSystemTimeDebug("syncTimeCoroutineAction");
 
-	if (reelectionPeriodTimedOut()) {
+	if (rootClockId != myId && reelectionPeriodTimedOut()) {
 		LOGSystemTimeDebug("reelectionPeriodTimedOut");
-		rootClockId = myId;
+		becomeRootClock();
 	}
 
 	auto stamp = getSynchronizedStamp();
 	sendTimeSyncMessage(stamp, myId);
-	return Coroutine::delayMs(root_clock_update_period_ms());
+
+	if (rootClockId == myId && syncPeriodShift < root_clock_max_period_shift()) {
+		syncMessagesSentAtPeriodShift++;
+		if (syncMessagesSentAtPeriodShift >= root_clock_sync_messages_per_period_step()) {
+			syncPeriodShift++;
+			syncMessagesSentAtPeriodShift = 0;
+			LOGSystemTimeDebug("Sync period increased to %u ms", rootClockUpdatePeriodMs());
+		}
+	}
+	return Coroutine::delayMs(rootClockUpdatePeriodMs());
+}
+
+void SystemTime::becomeRootClock() {
+	rootClockId = myId;
+	// The root clock doesn't drift by definition.
+	driftEstimator.reset();
+	syncPeriodShift               = 0;
+	syncMessagesSentAtPeriodShift = 0;
 }
 
 void SystemTime::onTimeSyncMessageReceive(time_sync_message_t syncMessage) {
@@ -378,6 +449,9 @@ void SystemTime::onTimeSyncMessageReceive(time_sync_message_t syncMessage) {
 	bool versionIsEqual = rootTime.version == syncMessage.stamp.version;
 
 	if (versionIsNewer || (versionIsEqual && isRootClock(syncMessage.srcId))) {
+		// Only samples of the same clock can be used to estimate the drift.
+		bool isSameClock = versionIsEqual && syncMessage.srcId == rootClockId && syncMessage.srcId != 0;
+
 		// sync message wins authority on the clock values.
 		setRootTimeStamp(syncMessage.stamp, syncMessage.srcId, rtcCount);
 		uptimeOfLastTimeSyncMessage = upTimeSec;
@@ -386,11 +460,22 @@ void SystemTime::onTimeSyncMessageReceive(time_sync_message_t syncMessage) {
 		// So this is a good time to consider ourselves to be the root clock.
 		if (meIsRootClock()) {
 			LOGSystemTimeDebug("Set me as root: myId=%u rootClockId=%u", myId, rootClockId);
-			rootClockId = myId;
+			becomeRootClock();
+		}
+		else {
+			if (!isSameClock) {
+				driftEstimator.reset();
+			}
+			uint64_t rootMs = static_cast<uint64_t>(syncMessage.stamp.posix_s) * 1000 + syncMessage.stamp.posix_ms;
+			driftEstimator.addSample(uptimeMs(rtcCount), rootMs);
+			// Older firmware doesn't initialize these bits, so limit what we accept.
+			syncPeriodShift = CsMath::min(syncMessage.periodShift, root_clock_max_period_shift());
+			LOGSystemTimeDebug(
+					"drift=%i ppb samples=%u", driftEstimator.getDriftPpb(), driftEstimator.getSampleCount());
 		}
 
 		// TODO: could postpone reelection if coroutine interface would be improved
-		// sync_routine.reschedule(root_clock_reelection_timeout_ms);
+		// sync_routine.reschedule(rootClockReelectionTimeoutMs());
 
 		// TODO: send SYNC_TIME_JUMP event in case of a big difference in time.
 		// That way components can react appropriately.
@@ -421,6 +506,7 @@ void SystemTime::sendTimeSyncMessage(high_resolution_time_stamp_t stamp, stone_i
 	timeSyncMsg.posix_ms     = stamp.posix_ms;
 	timeSyncMsg.version      = stamp.version;
 	timeSyncMsg.overrideRoot = (id == 0);
+	timeSyncMsg.periodShift  = syncPeriodShift;
 
 	LOGSystemTimeDebug(
 			"sendTimeSyncMessage s=%u ms=%u version=%u override=%d",
@@ -459,7 +545,7 @@ bool SystemTime::meIsRootClock() {
 }
 
 bool SystemTime::reelectionPeriodTimedOut() {
-	return root_clock_reelection_timeout_ms() / 1000 <= upTimeSec - uptimeOfLastTimeSyncMessage;
+	return rootClockReelectionTimeoutMs() / 1000 <= upTimeSec - uptimeOfLastTimeSyncMessage;
 }
 
 bool SystemTime::rebootTimedOut() {
@@ -489,6 +575,7 @@ void SystemTime::initDebug() {
 		publishSyncMessageForTesting();
 		return Coroutine::delayMs(debugSyncTimeMessagePeriodMs());
 	};
+	debugSyncTimeCoroutine.start();
 #endif  // DEBUG_SYSTEM_TIME
 }
 
@@ -30,10 +30,9 @@ void TrackedDevice::setAccessLevel(uint8_t accessLevel) {
 	CsUtils::setBit(fieldsSet, BIT_POS_ACCESS_LEVEL);
 }
 
-void TrackedDevice::setLocation(uint8_t locationId, uint8_t timeoutMinutes) {
+void TrackedDevice::setLocation(uint8_t locationId) {
 	data.data.locationId = locationId;
 	CsUtils::setBit(fieldsSet, BIT_POS_LOCATION);
-	locationIdTTLMinutes = timeoutMinutes;
 }
 
 void TrackedDevice::setProfile(uint8_t profileId) {
@@ -28,7 +28,7 @@ void TrackedDevices::print(TrackedDevice& device) {
 			device.data.data.locationId,
 			device.data.data.rssiOffset,
 			device.data.data.flags.asInt,
-			device.data.data.timeToLiveMinutes,
+			getTTLMinutes(device),
 			device.data.data.deviceToken[0],
 			device.data.data.deviceToken[1],
 			device.data.data.deviceToken[2]);
@@ -38,7 +38,7 @@ void TrackedDevices::print(TrackedDevice& device) {
 TrackedDevices::TrackedDevices() {}
 
 void TrackedDevices::init() {
-	LOGi("Init. Using %u bytes of RAM.", sizeof(_store));
+	LOGi("Init. Using %u bytes of RAM.", sizeof(_store) + sizeof(_timeouts));
 	EventDispatcher::getInstance().addListener(this);
 }
 
@@ -61,12 +61,12 @@ cs_ret_code_t TrackedDevices::handleRegister(internal_register_tracked_device_pa
 		return ERR_ALREADY_EXISTS;
 	}
 	device->setAccessLevel(packet.accessLevel);
-	device->setLocation(packet.data.locationId, LOCATION_ID_TTL_MINUTES);
+	setLocation(*device, packet.data.locationId, LOCATION_ID_TTL_MINUTES);
 	device->setProfile(packet.data.profileId);
 	device->setRssiOffset(packet.data.rssiOffset);
 	device->setFlags(packet.data.flags.asInt);
 	device->setDevicetoken(packet.data.deviceToken, sizeof(packet.data.deviceToken));
-	device->setTTL(packet.data.timeToLiveMinutes);
+	setTTL(*device, packet.data.timeToLiveMinutes);
 	sendRegisterToMesh(*device);
 	sendTokenToMesh(*device);
 	print(*device);
@@ -85,7 +85,7 @@ void TrackedDevices::handleMeshRegister(TYPIFY(EVT_MESH_TRACKED_DEVICE_REGISTER)
 		return;
 	}
 	// Access has been checked by sending crownstone.
-	device->setLocation(packet.locationId, LOCATION_ID_TTL_MINUTES);
+	setLocation(*device, packet.locationId, LOCATION_ID_TTL_MINUTES);
 	device->setProfile(packet.profileId);
 	device->setRssiOffset(packet.rssiOffset);
 	device->setFlags(packet.flags);
@@ -105,7 +105,7 @@ void TrackedDevices::handleMeshToken(TYPIFY(EVT_MESH_TRACKED_DEVICE_TOKEN) & pac
 		return;
 	}
 	device->setDevicetoken(packet.deviceToken, sizeof(packet.deviceToken));
-	device->setTTL(packet.ttlMinutes);
+	setTTL(*device, packet.ttlMinutes);
 	print(*device);
 	checkSynced();
 }
@@ -126,7 +126,7 @@ void TrackedDevices::handleScannedDevice(adv_background_parsed_v1_t& packet) {
 		LOGTrackedDevicesVerbose("not all fields set id=%u", device->data.data.deviceId);
 		return;
 	}
-	device->locationIdTTLMinutes = LOCATION_ID_TTL_MINUTES;
+	_timeouts.schedule(MAX_TRACKED_DEVICES + getIndex(*device), LOCATION_ID_TTL_MINUTES);
 
 	sendBackgroundAdv(*device, packet.macAddress, packet.rssi);
 }
@@ -187,11 +187,16 @@ cs_ret_code_t TrackedDevices::handleHeartbeat(
 		LOGd("Invalid heartbeat TTL %u", ttlMinutes);
 		return ERR_WRONG_PARAMETER;
 	}
-	device.data.data.locationId = locationId;
-	device.heartbeatTTLMinutes  = ttlMinutes;
+	uint8_t heartbeatIndex = 2 * MAX_TRACKED_DEVICES + getIndex(device);
+	if (ttlMinutes == 0) {
+		_timeouts.cancel(heartbeatIndex);
+	}
+	else {
+		_timeouts.schedule(heartbeatIndex, ttlMinutes);
+	}
 
 	// Make sure the location ID doesn't timeout before the heartbeat times out.
-	device.locationIdTTLMinutes = std::max(ttlMinutes, LOCATION_ID_TTL_MINUTES);
+	setLocation(device, locationId, std::max(ttlMinutes, LOCATION_ID_TTL_MINUTES));
 
 	sendHeartbeatLocation(device, fromMesh, false);
 	return ERR_SUCCESS;
@@ -208,6 +213,12 @@ TrackedDevice* TrackedDevices::findOrAdd(device_id_t deviceId) {
 		return nullptr;
 	}
 	device->data.data.deviceId = deviceId;
+
+	// A device of which the TTL is never set times out at the next minute tick.
+	uint8_t index              = getIndex(*device);
+	_timeouts.schedule(index, 0);
+	_timeouts.cancel(MAX_TRACKED_DEVICES + index);
+	_timeouts.cancel(2 * MAX_TRACKED_DEVICES + index);
 	return device;
 }
 
@@ -253,7 +264,7 @@ TrackedDevice* TrackedDevices::add() {
 		return incomplete;
 	}
 
-	if (auto lowestTtlRecord = _store.getMin([](auto device) { return device.data.data.timeToLiveMinutes; })) {
+	if (auto lowestTtlRecord = _store.getMin([this](auto& device) { return getTTLMinutes(device); })) {
 		LOGTrackedDevicesDebug("Use spot of lowest ttl record");
 		lowestTtlRecord->invalidate();
 		return lowestTtlRecord;
@@ -264,6 +275,28 @@ TrackedDevice* TrackedDevices::add() {
 	return nullptr;
 }
 
+uint8_t TrackedDevices::getIndex(TrackedDevice& device) {
+	return &device - _store.begin();
+}
+
+void TrackedDevices::setTTL(TrackedDevice& device, uint16_t ttlMinutes) {
+	device.setTTL(ttlMinutes);
+	_timeouts.schedule(getIndex(device), ttlMinutes);
+}
+
+uint16_t TrackedDevices::getTTLMinutes(TrackedDevice& device) {
+	return _timeouts.remaining(getIndex(device));
+}
+
+void TrackedDevices::setLocation(TrackedDevice& device, uint8_t locationId, uint8_t ttlMinutes) {
+	device.setLocation(locationId);
+	_timeouts.schedule(MAX_TRACKED_DEVICES + getIndex(device), ttlMinutes);
+}
+
+bool TrackedDevices::hasHeartbeat(TrackedDevice& device) {
+	return _timeouts.isScheduled(2 * MAX_TRACKED_DEVICES + getIndex(device));
+}
+
 bool TrackedDevices::hasAccess(TrackedDevice& device, uint8_t accessLevel) {
 	if (CsUtils::isBitSet(device.fieldsSet, BIT_POS_ACCESS_LEVEL)
 		&& (!KeysAndAccess::getInstance().allowAccess(
@@ -310,26 +343,22 @@ void TrackedDevices::checkSynced() {
 
 void TrackedDevices::tickMinute() {
 	LOGTrackedDevicesDebug("tickMinute");
-	for (auto& device : _store) {
-		if (!device.isValid()) {
-			continue;
+	_timeouts.tick([this](uint8_t index) {
+		if (index >= 2 * MAX_TRACKED_DEVICES) {
+			// Heartbeat timed out.
+			return;
 		}
-
-		if (CsMath::Decrease(device.locationIdTTLMinutes) == 0) {
+		if (index >= MAX_TRACKED_DEVICES) {
 			// Location timed out.
-			device.data.data.locationId = 0;
+			_store.begin()[index - MAX_TRACKED_DEVICES].data.data.locationId = 0;
+			return;
 		}
-
-		if (CsMath::DecreaseMember(device.data.data, &register_tracked_device_packet_t::timeToLiveMinutes) == 0) {
-			// Always check if device is timed out, as it might be that the TTL was never set.
-			LOGTrackedDevicesDebug("Timed out id=%u", device.data.data.deviceId);
-			device.invalidate();
-		}
-
-		CsMath::Decrease(device.heartbeatTTLMinutes);
-
-		print(device);
-	}
+		TrackedDevice& device = _store.begin()[index];
+		LOGTrackedDevicesDebug("Timed out id=%u", device.data.data.deviceId);
+		device.invalidate();
+		_timeouts.cancel(MAX_TRACKED_DEVICES + index);
+		_timeouts.cancel(2 * MAX_TRACKED_DEVICES + index);
+	});
 }
 
 void TrackedDevices::tickSecond() {
@@ -340,7 +369,7 @@ void TrackedDevices::tickSecond() {
 		if (!device.allFieldsSet()) {
 			continue;
 		}
-		if (device.heartbeatTTLMinutes != 0) {
+		if (hasHeartbeat(device)) {
 			sendHeartbeatLocation(device, false, true);
 		}
 	}
@@ -388,7 +417,7 @@ void TrackedDevices::sendHeartbeatToMesh(TrackedDevice& device) {
 	TYPIFY(CMD_SEND_MESH_MSG_TRACKED_DEVICE_HEARTBEAT) meshMsg;
 	meshMsg.deviceId   = device.data.data.deviceId;
 	meshMsg.locationId = device.data.data.locationId;
-	meshMsg.ttlMinutes = device.heartbeatTTLMinutes;
+	meshMsg.ttlMinutes = _timeouts.remaining(2 * MAX_TRACKED_DEVICES + getIndex(device));
 	event_t event(CS_TYPE::CMD_SEND_MESH_MSG_TRACKED_DEVICE_HEARTBEAT, &meshMsg, sizeof(meshMsg));
 	event.dispatch();
 }
@@ -411,7 +440,7 @@ void TrackedDevices::sendTokenToMesh(TrackedDevice& device) {
 	TYPIFY(CMD_SEND_MESH_MSG_TRACKED_DEVICE_TOKEN) eventData;
 	eventData.deviceId = device.data.data.deviceId;
 	memcpy(eventData.deviceToken, device.data.data.deviceToken, sizeof(device.data.data.deviceToken));
-	eventData.ttlMinutes = device.data.data.timeToLiveMinutes;
+	eventData.ttlMinutes = getTTLMinutes(device);
 	event_t event(CS_TYPE::CMD_SEND_MESH_MSG_TRACKED_DEVICE_TOKEN, &eventData, sizeof(eventData));
 	event.dispatch();
 }
@@ -492,15 +521,12 @@ void TrackedDevices::handleEvent(event_t& event) {
 			handleScannedDevice(*data);
 			break;
 		}
-		case CS_TYPE::EVT_TICK: {
-			if (--ticksLeftMinute == 0) {
-				ticksLeftMinute = TICKS_PER_MINUTES;
+		case CS_TYPE::EVT_TICK_SECOND: {
+			if (--secondsLeftMinute == 0) {
+				secondsLeftMinute = SECONDS_PER_MINUTE;
 				tickMinute();
 			}
-			if (--ticksLeftSecond == 0) {
-				ticksLeftSecond = TICKS_PER_SECOND;
-				tickSecond();
-			}
+			tickSecond();
 			break;
 		}
 		case CS_TYPE::EVT_MESH_SYNC_REQUEST_OUTGOING: {
@@ -13,7 +13,15 @@
 
 #define LOGUartconnectionDebug LOGnone
 
-UartConnection::UartConnection() {}
+UartConnection::UartConnection()
+		: _connectionTimeoutRoutine([this]() {
+			onConnectionTimeout();
+			return Coroutine::delayS(0);
+		})
+		, _sessionNonceTimeoutRoutine([this]() {
+			onSessionNonceTimeout();
+			return Coroutine::delayS(0);
+		}) {}
 
 void UartConnection::init() {
 	// Init status flags.
@@ -74,9 +82,14 @@ void UartConnection::onUserStatus(const uart_msg_status_user_t& status) {
 
 void UartConnection::onHeartBeat(uint16_t timeoutSeconds, bool encrypted) {
 	LOGUartconnectionDebug("Heartbeat timeout=%u", timeoutSeconds);
-	_isConnectionAlive            = true;
-	_isConnectionEncrypted        = encrypted;
-	_connectionTimeoutCountdown   = timeoutSeconds * (1000 / TICK_INTERVAL_MS);
+	_isConnectionAlive     = true;
+	_isConnectionEncrypted = encrypted;
+	if (timeoutSeconds == 0) {
+		_connectionTimeoutRoutine.stop();
+	}
+	else {
+		_connectionTimeoutRoutine.start(Coroutine::delayS(timeoutSeconds));
+	}
 
 	// Reply with a heartbeat, which is only encrypted if the received heartbeat is encrypted.
 	UartProtocol::Encrypt encrypt = encrypted ? UartProtocol::ENCRYPT_OR_FAIL : UartProtocol::Encrypt::ENCRYPT_NEVER;
@@ -91,8 +104,13 @@ void UartConnection::onSessionNonce(const uart_msg_session_nonce_t& sessionNonce
 			sessionNonce.sessionNonce[1],
 			sessionNonce.sessionNonce[SESSION_NONCE_LENGTH - 1]);
 	memcpy(_sessionNonceRx, sessionNonce.sessionNonce, SESSION_NONCE_LENGTH);
-	_sessionNonceValid            = true;
-	_sessionNonceTimeoutCountdown = sessionNonce.timeoutMinutes * 60 * (1000 / TICK_INTERVAL_MS);
+	_sessionNonceValid = true;
+	if (sessionNonce.timeoutMinutes == 0) {
+		_sessionNonceTimeoutRoutine.stop();
+	}
+	else {
+		_sessionNonceTimeoutRoutine.start(Coroutine::delayS(sessionNonce.timeoutMinutes * 60));
+	}
 
 	// Refresh our own session nonce.
 	RNG::fillBuffer(_sessionNonceTx, sizeof(_sessionNonceTx));
@@ -123,29 +141,22 @@ cs_ret_code_t UartConnection::getSessionNonceRx(cs_data_t data) {
 	return ERR_SUCCESS;
 }
 
-void UartConnection::onTick() {
-	if (_connectionTimeoutCountdown) {
-		--_connectionTimeoutCountdown;
-		if (_connectionTimeoutCountdown == 0) {
-			LOGi("Connection timed out");
-			// No heartbeat received within timeout: connection died.
-			_isConnectionAlive     = false;
-			_isConnectionEncrypted = false;
-		}
-	}
+void UartConnection::onConnectionTimeout() {
+	_connectionTimeoutRoutine.stop();
+	LOGi("Connection timed out");
+	// No heartbeat received within timeout: connection died.
+	_isConnectionAlive     = false;
+	_isConnectionEncrypted = false;
+}
 
-	if (_sessionNonceTimeoutCountdown) {
-		--_sessionNonceTimeoutCountdown;
-		if (_sessionNonceTimeoutCountdown == 0) {
-			LOGi("Session nonce timed out");
-			_sessionNonceValid = false;
-		}
-	}
+void UartConnection::onSessionNonceTimeout() {
+	_sessionNonceTimeoutRoutine.stop();
+	LOGi("Session nonce timed out");
+	_sessionNonceValid = false;
 }
 
 void UartConnection::handleEvent(event_t& event) {
 	switch (event.type) {
-		case CS_TYPE::EVT_TICK: onTick(); break;
 		case CS_TYPE::STATE_HUB_MODE: {
 			TYPIFY(STATE_HUB_MODE)* hubMode = reinterpret_cast<TYPIFY(STATE_HUB_MODE)*>(event.data);
 			_status.flags.flags.hubMode     = (*hubMode != 0);
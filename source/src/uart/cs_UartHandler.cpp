@@ -104,9 +104,9 @@ ret_code_t UartHandler::writeMsg(UartOpcodeTx opCode) {
 }
 
 ret_code_t UartHandler::writeMsgStart(UartOpcodeTx opCode, uint16_t size, UartProtocol::Encrypt encrypt) {
-	//	if (size > UART_TX_MAX_PAYLOAD_SIZE) {
-	//		return;
-	//	}
+	if (size > UART_TX_MAX_PAYLOAD_SIZE) {
+		return ERR_WRONG_PAYLOAD_LENGTH;
+	}
 
 	uart_msg_header_t uartMsgHeader;
 	uartMsgHeader.type   = opCode;
@@ -0,0 +1,232 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <logging/cs_Logger.h>
+#include <util/cs_CoroutineScheduler.h>
+
+#define LOGCoroutineSchedulerDebug LOGvv
+
+app_timer_t CoroutineScheduler::_appTimerData  = {{0}};
+app_timer_id_t CoroutineScheduler::_appTimerId = &_appTimerData;
+
+void Coroutine::start(uint32_t delayMs) {
+	CoroutineScheduler::getInstance().schedule(*this, delayMs);
+}
+
+void Coroutine::stop() {
+	CoroutineScheduler::getInstance().cancel(*this);
+}
+
+CoroutineScheduler& CoroutineScheduler::getInstance() {
+	static CoroutineScheduler instance;
+	return instance;
+}
+
+void CoroutineScheduler::init() {
+	Timer::getInstance().createSingleShot(_appTimerId, static_cast<app_timer_timeout_handler_t>(&onTimeout));
+	_rtcCountOfLastUpdate = RTC::getCount();
+	_initialized          = true;
+}
+
+void CoroutineScheduler::schedule(Coroutine& coroutine, uint32_t delayMs) {
+	if (!_initialized) {
+		init();
+	}
+	updateNow();
+	setDeadline(coroutine, _nowTicks, delayMs);
+	coroutine._deadline = alignToJitter(coroutine._deadline, coroutine.allowedJitterMs);
+	if (coroutine._heapIndex < _heapSize) {
+		siftDown(coroutine._heapIndex);
+	}
+}
+
+void CoroutineScheduler::setDeadline(Coroutine& coroutine, uint32_t fromTicks, uint32_t delayMs) {
+	// Execute at least 1 tick later, so that a coroutine that returns 0 doesn't keep the scheduler busy.
+	uint32_t delayTicks = msToTicks(delayMs);
+	if (delayTicks < 1) {
+		delayTicks = 1;
+	}
+	coroutine._deadline = fromTicks + delayTicks;
+
+	// When the coroutine ran so late that the next deadline passed as well, continue from now instead of catching up.
+	if (!isBefore(_nowTicks, coroutine._deadline)) {
+		coroutine._deadline = _nowTicks + delayTicks;
+	}
+
+	if (coroutine._heapIndex < _heapSize) {
+		siftUp(coroutine._heapIndex);
+		siftDown(coroutine._heapIndex);
+	}
+	else {
+		if (_heapSize == MAX_COROUTINES) {
+			LOGe("Too many coroutines");
+			return;
+		}
+		setHeapEntry(_heapSize, &coroutine);
+		_heapSize++;
+		siftUp(_heapSize - 1);
+	}
+	LOGCoroutineSchedulerDebug("schedule delayMs=%u heapSize=%u", delayMs, _heapSize);
+
+	if (!_running) {
+		startTimer();
+	}
+}
+
+void CoroutineScheduler::cancel(Coroutine& coroutine) {
+	if (coroutine._heapIndex < _heapSize) {
+		removeFromHeap(coroutine._heapIndex);
+		if (!_running) {
+			startTimer();
+		}
+	}
+	coroutine._heapIndex = Coroutine::NOT_SCHEDULED;
+}
+
+void CoroutineScheduler::updateNow() {
+	uint32_t rtcCount     = RTC::getCount();
+	_nowTicks += RTC::difference(rtcCount, _rtcCountOfLastUpdate);
+	_rtcCountOfLastUpdate = rtcCount;
+}
+
+void CoroutineScheduler::onTimeout([[maybe_unused]] void* p_context) {
+	getInstance().run();
+}
+
+void CoroutineScheduler::run() {
+	_running = true;
+	_wakeUpCount++;
+	updateNow();
+	while (_heapSize > 0 && !isBefore(_nowTicks, _heap[0]->_deadline)) {
+		Coroutine* coroutine = _heap[0];
+		uint32_t deadline    = coroutine->_deadline;
+		removeFromHeap(0);
+		coroutine->_heapIndex = Coroutine::RUNNING;
+
+		uint32_t delayMs      = coroutine->action ? coroutine->action() : 0;
+
+		// The action may have stopped or restarted its own coroutine.
+		if (coroutine->_heapIndex == Coroutine::RUNNING) {
+			coroutine->_heapIndex = Coroutine::NOT_SCHEDULED;
+			if (coroutine->action) {
+				// Count the delay from the deadline, so that running late, for example within the allowed jitter,
+				// doesn't shift the following executions.
+				updateNow();
+				setDeadline(*coroutine, deadline, delayMs);
+			}
+		}
+	}
+	_running = false;
+	startTimer();
+}
+
+void CoroutineScheduler::startTimer() {
+	if (_heapSize == 0) {
+		Timer::getInstance().stop(_appTimerId);
+		return;
+	}
+	updateNow();
+	uint32_t ticks = ticksUntilWakeUp();
+	if (ticks < APP_TIMER_MIN_TIMEOUT_TICKS) {
+		ticks = APP_TIMER_MIN_TIMEOUT_TICKS;
+	}
+	if (ticks > MAX_TIMER_TICKS) {
+		// Wake up before the RTC counter overflows, run() then only updates the clock.
+		ticks = MAX_TIMER_TICKS;
+	}
+	Timer::getInstance().reset(_appTimerId, ticks, nullptr);
+}
+
+uint32_t CoroutineScheduler::ticksUntilFirstDeadline() {
+	if (isBefore(_nowTicks, _heap[0]->_deadline)) {
+		return _heap[0]->_deadline - _nowTicks;
+	}
+	return 0;
+}
+
+uint32_t CoroutineScheduler::ticksUntilWakeUp() {
+	// The heap is small, so simply check all coroutines.
+	uint32_t ticks = MAX_DELAY_TICKS;
+	for (uint8_t i = 0; i < _heapSize; ++i) {
+		uint32_t latest = _heap[i]->_deadline + msToTicks(_heap[i]->allowedJitterMs);
+		if (!isBefore(_nowTicks, latest)) {
+			return 0;
+		}
+		if (latest - _nowTicks < ticks) {
+			ticks = latest - _nowTicks;
+		}
+	}
+	return ticks;
+}
+
+uint32_t CoroutineScheduler::alignToJitter(uint32_t ticks, uint32_t allowedJitterMs) {
+	uint32_t jitterTicks = msToTicks(allowedJitterMs);
+	uint32_t alignment   = 1;
+	while (alignment * 2 <= jitterTicks + 1) {
+		alignment *= 2;
+	}
+	// The clock rolls over at a multiple of the alignment.
+	return (ticks + alignment - 1) & ~(alignment - 1);
+}
+
+uint32_t CoroutineScheduler::msToTicks(uint32_t ms) {
+	// Round to the nearest tick, so that periodic deadlines drift as little as possible.
+	uint64_t ticks = (static_cast<uint64_t>(ms) * RTC_CLOCK_FREQ + 500) / 1000;
+	if (ticks > MAX_DELAY_TICKS) {
+		return MAX_DELAY_TICKS;
+	}
+	return static_cast<uint32_t>(ticks);
+}
+
+void CoroutineScheduler::setHeapEntry(uint8_t index, Coroutine* coroutine) {
+	_heap[index]          = coroutine;
+	coroutine->_heapIndex = index;
+}
+
+void CoroutineScheduler::siftUp(uint8_t index) {
+	Coroutine* coroutine = _heap[index];
+	while (index > 0) {
+		uint8_t parent = (index - 1) / 2;
+		if (!isBefore(coroutine->_deadline, _heap[parent]->_deadline)) {
+			break;
+		}
+		setHeapEntry(index, _heap[parent]);
+		index = parent;
+	}
+	setHeapEntry(index, coroutine);
+}
+
+void CoroutineScheduler::siftDown(uint8_t index) {
+	Coroutine* coroutine = _heap[index];
+	while (true) {
+		uint8_t child = 2 * index + 1;
+		if (child >= _heapSize) {
+			break;
+		}
+		if (child + 1 < _heapSize && isBefore(_heap[child + 1]->_deadline, _heap[child]->_deadline)) {
+			child++;
+		}
+		if (!isBefore(_heap[child]->_deadline, coroutine->_deadline)) {
+			break;
+		}
+		setHeapEntry(index, _heap[child]);
+		index = child;
+	}
+	setHeapEntry(index, coroutine);
+}
+
+void CoroutineScheduler::removeFromHeap(uint8_t index) {
+	Coroutine* removed = _heap[index];
+	_heapSize--;
+	if (index < _heapSize) {
+		setHeapEntry(index, _heap[_heapSize]);
+		siftUp(index);
+		siftDown(index);
+	}
+	_heap[_heapSize]    = nullptr;
+	removed->_heapIndex = Coroutine::NOT_SCHEDULED;
+}
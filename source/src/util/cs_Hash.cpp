@@ -55,3 +55,15 @@ uint32_t Fletcher(const uint8_t* const data8, const size_t len, uint32_t previou
 
 	return (c1 << 16 | c0);
 }
+
+uint32_t FletcherCombine(uint32_t previousFletcherHash, uint32_t fletcherHash, const size_t len) {
+	// Starting from (c0, c1) instead of (0, 0), every data word adds c0 once more to c1.
+	uint32_t c0        = previousFletcherHash >> 0 * 8 & 0xffff;
+	uint32_t c1        = previousFletcherHash >> 2 * 8 & 0xffff;
+	uint32_t wordCount = ((len + 1) / 2) % 0xffff;
+
+	// No overflow: c1 < 2 * 0xffff + 0xfffe * 0xfffe < 2^32.
+	c1                 = (c1 + (fletcherHash >> 2 * 8 & 0xffff) + wordCount * c0) % 0xffff;
+	c0                 = (c0 + (fletcherHash >> 0 * 8 & 0xffff)) % 0xffff;
+	return (c1 << 16 | c0);
+}
@@ -0,0 +1,96 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <util/cs_LzDecompressor.h>
+
+void LzDecompressor::init(const uint8_t* flushedOutput, uint8_t* buffer, uint16_t bufferSize) {
+	_flushedOutput = flushedOutput;
+	_buffer        = buffer;
+	_bufferSize    = bufferSize;
+	_bufferedSize  = 0;
+	_flushedSize   = 0;
+	_state         = STATE_TOKEN;
+	_remaining     = 0;
+	_distance      = 0;
+}
+
+cs_ret_code_t LzDecompressor::decompress(const uint8_t* input, uint16_t inputSize, uint16_t& consumedSize) {
+	consumedSize = 0;
+	while (true) {
+		if (_state == STATE_MATCH) {
+			// Copying a match doesn't consume input.
+			while (_remaining > 0 && !isBufferFull()) {
+				_buffer[_bufferedSize] = getOutput(getOutputSize() - _distance);
+				_bufferedSize++;
+				_remaining--;
+			}
+			if (_remaining > 0) {
+				return ERR_BUFFER_TOO_SMALL;
+			}
+			_state = STATE_TOKEN;
+		}
+
+		if (consumedSize == inputSize) {
+			return ERR_SUCCESS;
+		}
+
+		switch (_state) {
+			case STATE_TOKEN: {
+				uint8_t token = input[consumedSize++];
+				if (token & LZ_MATCH_FLAG) {
+					_remaining = (token & ~LZ_MATCH_FLAG) + LZ_MIN_MATCH_LENGTH;
+					_state     = STATE_DISTANCE_LOW;
+				}
+				else {
+					_remaining = token + 1;
+					_state     = STATE_LITERAL;
+				}
+				break;
+			}
+			case STATE_LITERAL: {
+				if (isBufferFull()) {
+					return ERR_BUFFER_TOO_SMALL;
+				}
+				_buffer[_bufferedSize++] = input[consumedSize++];
+				_remaining--;
+				if (_remaining == 0) {
+					_state = STATE_TOKEN;
+				}
+				break;
+			}
+			case STATE_DISTANCE_LOW: {
+				_distance = input[consumedSize++];
+				_state    = STATE_DISTANCE_HIGH;
+				break;
+			}
+			case STATE_DISTANCE_HIGH: {
+				_distance |= input[consumedSize++] << 8;
+				if (_distance == 0 || _distance > getOutputSize()) {
+					return ERR_INVALID_MESSAGE;
+				}
+				_state = STATE_MATCH;
+				break;
+			}
+			case STATE_MATCH: {
+				// Handled above.
+				break;
+			}
+		}
+	}
+}
+
+void LzDecompressor::onBufferFlushed() {
+	_flushedSize += _bufferedSize;
+	_bufferedSize = 0;
+}
+
+uint8_t LzDecompressor::getOutput(uint32_t position) const {
+	if (position < _flushedSize) {
+		return _flushedOutput[position];
+	}
+	return _buffer[position - _flushedSize];
+}